@@ -0,0 +1,231 @@
+/////////////////////////////////////////////////////////////////////////////
+// NxWidgets/UnitTests/CTextBench/ctextbench_main.cxx
+//
+//   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include <apps/benchtime.h>
+
+#include "cglyphcache.hxx"
+#include "singletons.hxx"
+#include "ctextbenchtest.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+static FAR const char *g_options[] =
+{
+  "Azuki bean",
+  "Black-eyed pea",
+  "Chickpea",
+  "Common bean",
+  "Fava bean",
+  "Garbanzo",
+  "Green bean",
+  "Horse gram",
+  "Lentil",
+  "Lima Bean",
+  "Mung bean",
+  "Pea",
+  "Peanut",
+  "Pigeon pea",
+  "Runner bean",
+  "Soybean"
+};
+#define NOPTIONS (sizeof(g_options)/sizeof(FAR const char *))
+
+static FAR const char g_text[] =
+  "The quick brown fox jumps over the lazy dog.\n"
+  "Pack my box with five dozen liquor jugs.\n"
+  "How vexingly quick daft zebras jump!\n"
+  "Sphinx of black quartz, judge my vow.\n"
+  "The five boxing wizards jump quickly.\n"
+  "0123456789 +-*/=<>()[]{}\n";
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+// Suppress name-mangling
+
+extern "C" int ctextbench_main(int argc, char *argv[]);
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Functions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Name: timeRedraws
+/////////////////////////////////////////////////////////////////////////////
+
+static void timeRedraws(CNxWidget *widget, FAR const char *name)
+{
+  uint32_t total   = 0;
+  uint32_t fastest = UINT32_MAX;
+
+  // The first redraw is not timed.  It fills the glyph cache.
+
+  widget->redraw();
+
+  for (int i = 0; i < CONFIG_CTEXTBENCH_NREDRAWS; i++)
+    {
+      uint32_t start   = benchtime_now();
+      widget->redraw();
+      uint32_t elapsed = benchtime_now() - start;
+
+      total += elapsed;
+      if (elapsed < fastest)
+        {
+          fastest = elapsed;
+        }
+    }
+
+  message("%s: %lu " BENCHTIME_UNITS " per redraw (average), %lu (fastest)\n",
+          name, (unsigned long)(total / CONFIG_CTEXTBENCH_NREDRAWS),
+          (unsigned long)fastest);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Functions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Name: ctextbench_main
+/////////////////////////////////////////////////////////////////////////////
+
+int ctextbench_main(int argc, char *argv[])
+{
+  benchtime_initialize();
+
+  // Create an instance of the text benchmark
+
+  message("ctextbench_main: Create CTextBenchTest instance\n");
+  CTextBenchTest *test = new CTextBenchTest();
+
+  // Connect the NX server
+
+  message("ctextbench_main: Connect the CTextBenchTest instance to the NX server\n");
+  if (!test->connect())
+    {
+      message("ctextbench_main: Failed to connect the CTextBenchTest instance to the NX server\n");
+      delete test;
+      return 1;
+    }
+
+  // Create a window to draw into
+
+  message("ctextbench_main: Create a Window\n");
+  if (!test->createWindow())
+    {
+      message("ctextbench_main: Failed to create a window\n");
+      delete test;
+      return 1;
+    }
+
+  // Create a listbox with a few options, one of them selected
+
+  CListBox *listbox = test->createListBox();
+  if (!listbox)
+    {
+      message("ctextbench_main: Failed to create a listbox\n");
+      delete test;
+      return 1;
+    }
+
+  for (unsigned int i = 0; i < NOPTIONS; i++)
+    {
+      listbox->addOption(g_options[i], i);
+    }
+
+  listbox->selectOption(1);
+
+  // Create a multi-line text box
+
+  CMultiLineTextBox *textbox = test->createTextBox(CNxString(g_text));
+  if (!textbox)
+    {
+      message("ctextbench_main: Failed to create a text box\n");
+      delete listbox;
+      delete test;
+      return 1;
+    }
+
+  listbox->enableDrawing();
+  textbox->enableDrawing();
+
+  // Time the redraws
+
+  timeRedraws(listbox, "CListBox");
+  timeRedraws(textbox, "CMultiLineTextBox");
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  message("Glyph cache: %lu hits, %lu misses, %lu bytes\n",
+          (unsigned long)g_glyphCache->getHits(),
+          (unsigned long)g_glyphCache->getMisses(),
+          (unsigned long)g_glyphCache->getSize());
+#endif
+
+  // Clean up and exit.  The text box is deleted along with the widget
+  // control when the test disconnects.  Flush the results first:  the
+  // disconnect may block until the listener thread receives another event.
+
+  message("ctextbench_main: Clean-up and exit\n");
+  fflush(stdout);
+  delete listbox;
+  delete test;
+  return 0;
+}
@@ -0,0 +1,229 @@
+/////////////////////////////////////////////////////////////////////////////
+// NxWidgets/UnitTests/CTextBench/ctextbenchtest.cxx
+//
+//   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <cerrno>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxconfig.hxx"
+#include "crect.hxx"
+#include "cnxwindow.hxx"
+#include "ctextbenchtest.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Classes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Private Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// CTextBenchTest Method Implementations
+/////////////////////////////////////////////////////////////////////////////
+
+// CTextBenchTest Constructor
+
+CTextBenchTest::CTextBenchTest()
+{
+  // Initialize state data
+
+  m_widgetControl = (CWidgetControl *)NULL;
+  m_window        = (CNxWindow *)NULL;
+}
+
+// CTextBenchTest Descriptor
+
+CTextBenchTest::~CTextBenchTest(void)
+{
+  disconnect();
+}
+
+// Connect to the NX server
+
+bool CTextBenchTest::connect(void)
+{
+  // Connect to the server
+
+  bool nxConnected = CNxServer::connect();
+  if (nxConnected)
+    {
+      // Set the background color
+
+      if (!setBackgroundColor(CONFIG_CTEXTBENCH_BGCOLOR))
+        {
+          message("CTextBenchTest::connect: setBackgroundColor failed\n");
+        }
+    }
+
+  return nxConnected;
+}
+
+// Disconnect from the NX server
+
+void CTextBenchTest::disconnect(void)
+{
+  // Close the window
+
+  if (m_window)
+    {
+      delete m_window;
+      m_window = (CNxWindow *)NULL;
+    }
+
+  // Free the widget control instance
+
+  if (m_widgetControl)
+    {
+      delete m_widgetControl;
+      m_widgetControl = (CWidgetControl *)NULL;
+    }
+
+  // And disconnect from the server
+
+  CNxServer::disconnect();
+}
+
+// Create a window that covers the whole display
+
+bool CTextBenchTest::createWindow(void)
+{
+  // Initialize the widget control using the default style
+
+  m_widgetControl = new CWidgetControl((CWidgetStyle *)NULL);
+
+  // Get an (uninitialized) instance of a raw window as a class that
+  // derives from INxWindow.
+
+  m_window = createRawWindow(m_widgetControl);
+  if (!m_window)
+    {
+      message("CTextBenchTest::createWindow: Failed to create CNxWindow instance\n");
+      disconnect();
+      return false;
+    }
+
+  // Open (and initialize) the window
+
+  bool success = m_window->open();
+  if (!success)
+    {
+      message("CTextBenchTest::createWindow: Failed to open the window\n");
+      disconnect();
+      return false;
+    }
+
+  // The bounding box of the window is the size of the display.  Make the
+  // window cover all of it.
+
+  CRect rect = m_widgetControl->getWindowBoundingBox();
+  rect.getSize(m_windowSize);
+
+  struct nxgl_point_s pos;
+  pos.x = 0;
+  pos.y = 0;
+
+  if (!m_window->setPosition(&pos) || !m_window->setSize(&m_windowSize))
+    {
+      message("CTextBenchTest::createWindow: Failed to size the window\n");
+      disconnect();
+      return false;
+    }
+
+  // Wait until the server reports the new size.  Otherwise the position
+  // callbacks could still be pending when the timing starts (or, worse,
+  // when the window is closed).
+
+  struct nxgl_size_s size;
+  (void)m_widgetControl->getWindowSize(&size);
+  return true;
+}
+
+// Create a listbox that covers the left half of the window
+
+CListBox *CTextBenchTest::createListBox(void)
+{
+  // Create the listbox
+
+  CListBox *listbox = new CListBox(m_widgetControl, 0, 0,
+                                   m_windowSize.w >> 1, m_windowSize.h);
+  if (!listbox)
+    {
+      message("CTextBenchTest::createListBox: Failed to create CListBox\n");
+    }
+
+  return listbox;
+}
+
+// Create a multi-line text box that covers the right half of the window
+
+CMultiLineTextBox *CTextBenchTest::createTextBox(const CNxString &text)
+{
+  // Create the text box
+
+  nxgl_coord_t halfWidth = m_windowSize.w >> 1;
+  CMultiLineTextBox *textbox =
+    new CMultiLineTextBox(m_widgetControl, halfWidth, 0,
+                          m_windowSize.w - halfWidth, m_windowSize.h, text, 0);
+  if (!textbox)
+    {
+      message("CTextBenchTest::createTextBox: Failed to create CMultiLineTextBox\n");
+    }
+
+  return textbox;
+}
@@ -0,0 +1,136 @@
+/////////////////////////////////////////////////////////////////////////////
+// NxWidgets/UnitTests/CTextBench/ctextbenchtest.hxx
+//
+//   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+//   Author: Gregory Nutt <gnutt@nuttx.org>
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in
+//    the documentation and/or other materials provided with the
+//    distribution.
+// 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+//    me be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+// OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+// AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef __UNITTESTS_CTEXTBENCH_CTEXTBENCHTEST_HXX
+#define __UNITTESTS_CTEXTBENCH_CTEXTBENCHTEST_HXX
+
+/////////////////////////////////////////////////////////////////////////////
+// Included Files
+/////////////////////////////////////////////////////////////////////////////
+
+#include <nuttx/config.h>
+
+#include <nuttx/init.h>
+#include <cstdio>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+
+#include "nxconfig.hxx"
+#include "cwidgetcontrol.hxx"
+#include "ccallback.hxx"
+#include "cnxwindow.hxx"
+#include "cnxserver.hxx"
+#include "clistbox.hxx"
+#include "cmultilinetextbox.hxx"
+
+/////////////////////////////////////////////////////////////////////////////
+// Definitions
+/////////////////////////////////////////////////////////////////////////////
+// Configuration ////////////////////////////////////////////////////////////
+
+#ifndef CONFIG_HAVE_CXX
+#  error "CONFIG_HAVE_CXX must be defined"
+#endif
+
+#ifndef CONFIG_CTEXTBENCH_BGCOLOR
+#  define CONFIG_CTEXTBENCH_BGCOLOR CONFIG_NXWIDGETS_DEFAULT_BACKGROUNDCOLOR
+#endif
+
+// The number of timed redraws of each widget
+
+#ifndef CONFIG_CTEXTBENCH_NREDRAWS
+#  define CONFIG_CTEXTBENCH_NREDRAWS 50
+#endif
+
+// If debug is enabled, use the debug function, syslog() instead
+// of printf() so that the output is synchronized.
+
+#ifdef CONFIG_DEBUG
+#  define message lowsyslog
+#else
+#  define message printf
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Classes
+/////////////////////////////////////////////////////////////////////////////
+
+using namespace NXWidgets;
+
+class CTextBenchTest : public CNxServer
+{
+private:
+  CWidgetControl    *m_widgetControl;  // The controlling widget for the window
+  CNxWindow         *m_window;         // Raw window instance
+  struct nxgl_size_s m_windowSize;     // The size of the window
+
+public:
+  // Constructor/destructors
+
+  CTextBenchTest(void);
+  ~CTextBenchTest(void);
+
+  // Initializer/unitializer.  These methods encapsulate the basic steps for
+  // starting and stopping the NX server
+
+  bool connect(void);
+  void disconnect(void);
+
+  // Create a window that covers the whole display.  A raw window is used
+  // because its handle is known as soon as it has been opened.
+
+  bool createWindow(void);
+
+  // Create a listbox that covers the left half of the window
+
+  CListBox *createListBox(void);
+
+  // Create a multi-line text box that covers the right half of the window
+
+  CMultiLineTextBox *createTextBox(const CNxString &text);
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Data
+/////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////
+// Public Function Prototypes
+/////////////////////////////////////////////////////////////////////////////
+
+#endif // __UNITTESTS_CTEXTBENCH_CTEXTBENCHTEST_HXX
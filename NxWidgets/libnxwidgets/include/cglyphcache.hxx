@@ -0,0 +1,237 @@
+/****************************************************************************
+ * NxWidgets/libnxwidgets/include/cglyphcache.hxx
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+ *    me be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_CGLYPHCACHE_HXX
+#define __INCLUDE_CGLYPHCACHE_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+ 
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxconfig.hxx"
+#include "cbitmap.hxx"
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  class CNxFont;
+
+  /**
+   * One rendered glyph in the glyph cache.  The glyph is identified by
+   * its font, character code, text color, background color, and pixel
+   * depth.  The pixel data follows the structure in the same allocation.
+   */
+
+  struct SGlyphCacheEntry
+  {
+    FAR struct SGlyphCacheEntry *hashNext; /**< Next glyph in the same bucket */
+    FAR struct SGlyphCacheEntry *lruPrev;  /**< Next more recently used glyph */
+    FAR struct SGlyphCacheEntry *lruNext;  /**< Next less recently used glyph */
+    size_t                       size;     /**< Size of the allocation */
+    enum nx_fontid_e             fontId;   /**< The font ID */
+    nxgl_mxpixel_t               color;    /**< The text color */
+    nxgl_mxpixel_t               background; /**< The background color */
+    nxwidget_char_t              letter;   /**< The character code */
+    struct SBitmap               bitmap;   /**< The rendered glyph */
+  };
+
+  /**
+   * A size-bounded cache of glyphs that have already been rendered with a
+   * given font, text color and background color.  The cache is shared by all
+   * graphics ports (see g_glyphCache).  Glyphs are found through a small
+   * hash table; when the cache is full, the least recently used glyphs are
+   * discarded.
+   *
+   * The cache must be locked while a glyph returned by getGlyph() is in
+   * use:  Another thread could otherwise discard it.
+   */
+
+  class CGlyphCache
+  {
+  private:
+    sem_t                        m_sem;      /**< Protects the cache */
+    FAR struct SGlyphCacheEntry *m_buckets[CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS];
+    FAR struct SGlyphCacheEntry *m_lruHead;  /**< Most recently used glyph */
+    FAR struct SGlyphCacheEntry *m_lruTail;  /**< Least recently used glyph */
+    size_t                       m_size;     /**< Bytes allocated for glyphs */
+    uint32_t                     m_hits;     /**< Number of glyphs found */
+    uint32_t                     m_misses;   /**< Number of glyphs rendered */
+
+    /**
+     * Return the hash bucket of a glyph.
+     *
+     * @param fontId The font ID.
+     * @param letter The character code.
+     * @param color The text color.
+     * @param background The background color.
+     * @return The index of the hash bucket.
+     */
+
+    static unsigned int hash(enum nx_fontid_e fontId, nxwidget_char_t letter,
+                             nxgl_mxpixel_t color, nxgl_mxpixel_t background);
+
+    /**
+     * Move a glyph to the most recently used end of the LRU list.
+     *
+     * @param entry The glyph to move.
+     */
+
+    void touch(FAR struct SGlyphCacheEntry *entry);
+
+    /**
+     * Remove a glyph from the cache and free it.
+     *
+     * @param entry The glyph to remove.
+     */
+
+    void discard(FAR struct SGlyphCacheEntry *entry);
+
+    /**
+     * Copy constructor is private to prevent usage.
+     */
+
+    inline CGlyphCache(const CGlyphCache &cache) { }
+
+  public:
+
+    /**
+     * Constructor.
+     */
+
+    CGlyphCache(void);
+
+    /**
+     * Destructor.  Frees all cached glyphs.
+     */
+
+    ~CGlyphCache(void);
+
+    /**
+     * Lock the cache.  The cache must be locked around calls to getGlyph()
+     * and for as long as the returned bitmap is in use.
+     */
+
+    void lock(void);
+
+    /**
+     * Unlock the cache.
+     */
+
+    inline void unlock(void)
+    {
+      (void)sem_post(&m_sem);
+    }
+
+    /**
+     * Return the rendered glyph for a character, rendering it and adding
+     * it to the cache if necessary.  The glyph is as wide as the character
+     * (including its X offset) and as high as the font.  The cache must be
+     * locked.
+     *
+     * @param font The font to render with.  The current font color is used
+     *   as the text color.
+     * @param letter The character to render.
+     * @param background The background color.
+     * @return The rendered glyph or NULL if it could not be cached.
+     */
+
+    FAR const struct SBitmap *getGlyph(CNxFont *font, nxwidget_char_t letter,
+                                       nxgl_mxpixel_t background);
+
+    /**
+     * Discard all cached glyphs.
+     */
+
+    void flush(void);
+
+    /**
+     * Get the number of glyphs found in the cache.
+     *
+     * @return The number of cache hits.
+     */
+
+    inline const uint32_t getHits(void) const
+    {
+      return m_hits;
+    }
+
+    /**
+     * Get the number of glyphs that had to be rendered.
+     *
+     * @return The number of cache misses.
+     */
+
+    inline const uint32_t getMisses(void) const
+    {
+      return m_misses;
+    }
+
+    /**
+     * Get the amount of memory used by cached glyphs.
+     *
+     * @return The size of the cache in bytes.
+     */
+
+    inline const size_t getSize(void) const
+    {
+      return m_size;
+    }
+  };
+}
+
+#endif // __cplusplus
+#endif // CONFIG_NXWIDGETS_GLYPHCACHE
+#endif // __INCLUDE_CGLYPHCACHE_HXX
@@ -96,6 +96,17 @@ namespace NXWidgets
 
     ~CNxFont() { }
 
+    /**
+     * Gets the ID of the font.
+     *
+     * @return The font ID.
+     */
+
+    inline const enum nx_fontid_e getFontId() const
+    {
+      return m_fontId;
+    }
+
     /**
      * Checks if supplied character is blank in the current font.
      *
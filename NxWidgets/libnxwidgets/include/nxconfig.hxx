@@ -96,6 +96,12 @@
  *   The smallest BPP configuration supported by NX.
  * CONFIG_NXWIDGETS_SIZEOFCHAR - Size of character {1 or 2 bytes}.  Default
  *   Determined by CONFIG_NXWIDGETS_SIZEOFCHAR
+ * CONFIG_NXWIDGETS_GLYPHCACHE - Keep a shared cache of rendered font glyphs
+ *   so that text drawn on a known background color is not rendered again.
+ * CONFIG_NXWIDGETS_GLYPHCACHE_SIZE - The maximum size of the glyph cache in
+ *   bytes.  Default: 8192
+ * CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS - The number of hash buckets in the
+ *   glyph cache (a power of two).  Default: 32
  *
  * NXWidget Default Values
  *
@@ -336,6 +342,22 @@
 #  error "Unsupported character width (CONFIG_NXWIDGETS_SIZEOFCHAR)"
 #endif
 
+/* Glyph cache */
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+#  ifndef CONFIG_NXWIDGETS_GLYPHCACHE_SIZE
+#    define CONFIG_NXWIDGETS_GLYPHCACHE_SIZE 8192
+#  endif
+
+#  ifndef CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS
+#    define CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS 32
+#  endif
+
+#  if (CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS & (CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS - 1)) != 0
+#    error "CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS must be a power of two"
+#  endif
+#endif
+
 /* NXWidget Default Values **************************************************/
 /**
  * Default font ID
@@ -99,6 +99,7 @@ namespace NXWidgets
 
   class CWidgetStyle;
   class CNxString;
+  class CGlyphCache;
 
   /**
    * Global singleton instances
@@ -107,6 +108,9 @@ namespace NXWidgets
   extern CWidgetStyle        *g_defaultWidgetStyle; /**< The default widget style */
   extern CNxString           *g_nullString;         /**< The reusable empty string */
   extern TNxArray<CNxTimer*> *g_nxTimers;           /**< An array of all timers */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  extern CGlyphCache         *g_glyphCache;         /**< The shared glyph cache */
+#endif
 
   /**
    * Setup misc singleton instances.
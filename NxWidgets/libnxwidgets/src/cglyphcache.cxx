@@ -0,0 +1,356 @@
+/****************************************************************************
+ * NxWidgets/libnxwidgets/src/cglyphcache.cxx
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX, NxWidgets, nor the names of its contributors
+ *    me be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+ 
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <cerrno>
+#include <cassert>
+#include <debug.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxconfig.hxx"
+#include "cnxfont.hxx"
+#include "cbitmap.hxx"
+#include "cglyphcache.hxx"
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * CGlyphCache Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.
+ */
+
+CGlyphCache::CGlyphCache(void)
+{
+  sem_init(&m_sem, 0, 1);
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS; i++)
+    {
+      m_buckets[i] = (FAR struct SGlyphCacheEntry *)NULL;
+    }
+
+  m_lruHead = (FAR struct SGlyphCacheEntry *)NULL;
+  m_lruTail = (FAR struct SGlyphCacheEntry *)NULL;
+  m_size    = 0;
+  m_hits    = 0;
+  m_misses  = 0;
+}
+
+/**
+ * Destructor.  Frees all cached glyphs.
+ */
+
+CGlyphCache::~CGlyphCache(void)
+{
+  flush();
+  sem_destroy(&m_sem);
+}
+
+/**
+ * Lock the cache.  The cache must be locked around calls to getGlyph()
+ * and for as long as the returned bitmap is in use.
+ */
+
+void CGlyphCache::lock(void)
+{
+  while (sem_wait(&m_sem) < 0)
+    {
+      // The only expected error is EINTR (wait interrupted by a signal)
+
+      DEBUGASSERT(errno == EINTR);
+    }
+}
+
+/**
+ * Return the rendered glyph for a character, rendering it and adding
+ * it to the cache if necessary.  The glyph is as wide as the character
+ * (including its X offset) and as high as the font.  The cache must be
+ * locked.
+ *
+ * @param font The font to render with.  The current font color is used
+ *   as the text color.
+ * @param letter The character to render.
+ * @param background The background color.
+ * @return The rendered glyph or NULL if it could not be cached.
+ */
+
+FAR const struct SBitmap *CGlyphCache::getGlyph(CNxFont *font,
+                                                nxwidget_char_t letter,
+                                                nxgl_mxpixel_t background)
+{
+  enum nx_fontid_e fontId = font->getFontId();
+  nxgl_mxpixel_t   color  = font->getColor();
+  unsigned int     index  = hash(fontId, letter, color, background);
+
+  // Is the glyph already in the cache?
+
+  FAR struct SGlyphCacheEntry *entry;
+  for (entry = m_buckets[index]; entry; entry = entry->hashNext)
+    {
+      if (entry->letter == letter && entry->fontId == fontId &&
+          entry->color == color && entry->background == background)
+        {
+          touch(entry);
+          m_hits++;
+          return &entry->bitmap;
+        }
+    }
+
+  m_misses++;
+
+  // No.. Get the size of the glyph.  Spaces have width, but no height.
+
+  struct nx_fontmetric_s metrics;
+  font->getCharMetrics(letter, &metrics);
+
+  nxgl_coord_t width  = (nxgl_coord_t)(metrics.width + metrics.xoffset);
+  nxgl_coord_t height = (nxgl_coord_t)font->getHeight();
+  uint16_t     stride = (width * CONFIG_NXWIDGETS_BPP + 7) >> 3;
+  size_t       size   = sizeof(struct SGlyphCacheEntry) + stride * height;
+
+  if (size > CONFIG_NXWIDGETS_GLYPHCACHE_SIZE)
+    {
+      return (FAR const struct SBitmap *)NULL;
+    }
+
+  // Discard the least recently used glyphs until there is room
+
+  while (m_size + size > CONFIG_NXWIDGETS_GLYPHCACHE_SIZE)
+    {
+      discard(m_lruTail);
+    }
+
+  // The pixel data follows the entry in the same allocation
+
+  FAR uint8_t *mem = new uint8_t[size];
+  if (!mem)
+    {
+      return (FAR const struct SBitmap *)NULL;
+    }
+
+  entry                = (FAR struct SGlyphCacheEntry *)mem;
+  entry->size          = size;
+  entry->fontId        = fontId;
+  entry->color         = color;
+  entry->background    = background;
+  entry->letter        = letter;
+  entry->bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
+  entry->bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
+  entry->bitmap.width  = width;
+  entry->bitmap.height = height;
+  entry->bitmap.stride = stride;
+  entry->bitmap.data   = (FAR const void *)&mem[sizeof(struct SGlyphCacheEntry)];
+
+  // Set the glyph memory to the background color, then render the glyph
+  // over it
+
+  FAR uint8_t *row = &mem[sizeof(struct SGlyphCacheEntry)];
+  for (nxgl_coord_t y = 0; y < height; y++, row += stride)
+    {
+#if CONFIG_NXWIDGETS_BPP == 24
+      FAR uint8_t *bmPtr = row;
+      for (nxgl_coord_t x = 0; x < width; x++)
+        {
+          *bmPtr++ = (uint8_t)background;
+          *bmPtr++ = (uint8_t)(background >> 8);
+          *bmPtr++ = (uint8_t)(background >> 16);
+        }
+#else
+      FAR nxwidget_pixel_t *bmPtr = (FAR nxwidget_pixel_t *)row;
+      for (nxgl_coord_t x = 0; x < width; x++)
+        {
+          *bmPtr++ = (nxwidget_pixel_t)background;
+        }
+#endif
+    }
+
+  font->drawChar(&entry->bitmap, letter);
+
+  // Add the glyph to its hash bucket and to the head of the LRU list
+
+  entry->hashNext  = m_buckets[index];
+  m_buckets[index] = entry;
+
+  entry->lruPrev   = (FAR struct SGlyphCacheEntry *)NULL;
+  entry->lruNext   = m_lruHead;
+  if (m_lruHead)
+    {
+      m_lruHead->lruPrev = entry;
+    }
+  else
+    {
+      m_lruTail = entry;
+    }
+
+  m_lruHead = entry;
+  m_size   += size;
+  return &entry->bitmap;
+}
+
+/**
+ * Discard all cached glyphs.
+ */
+
+void CGlyphCache::flush(void)
+{
+  while (m_lruTail)
+    {
+      discard(m_lruTail);
+    }
+}
+
+/**
+ * Return the hash bucket of a glyph.
+ *
+ * @param fontId The font ID.
+ * @param letter The character code.
+ * @param color The text color.
+ * @param background The background color.
+ * @return The index of the hash bucket.
+ */
+
+unsigned int CGlyphCache::hash(enum nx_fontid_e fontId, nxwidget_char_t letter,
+                               nxgl_mxpixel_t color, nxgl_mxpixel_t background)
+{
+  // Consecutive characters of the same font and colors fall into
+  // consecutive buckets
+
+  uint32_t value = (uint32_t)fontId;
+  value = value * 31 + (uint32_t)color;
+  value = value * 31 + (uint32_t)background;
+  value = value * 31 + (uint32_t)letter;
+
+  return (unsigned int)(value & (CONFIG_NXWIDGETS_GLYPHCACHE_NBUCKETS - 1));
+}
+
+/**
+ * Move a glyph to the most recently used end of the LRU list.
+ *
+ * @param entry The glyph to move.
+ */
+
+void CGlyphCache::touch(FAR struct SGlyphCacheEntry *entry)
+{
+  if (entry != m_lruHead)
+    {
+      // Remove the glyph from its current position.  It is not the head,
+      // so it has a previous entry.
+
+      entry->lruPrev->lruNext = entry->lruNext;
+      if (entry->lruNext)
+        {
+          entry->lruNext->lruPrev = entry->lruPrev;
+        }
+      else
+        {
+          m_lruTail = entry->lruPrev;
+        }
+
+      // And put it at the head of the list
+
+      entry->lruPrev     = (FAR struct SGlyphCacheEntry *)NULL;
+      entry->lruNext     = m_lruHead;
+      m_lruHead->lruPrev = entry;
+      m_lruHead          = entry;
+    }
+}
+
+/**
+ * Remove a glyph from the cache and free it.
+ *
+ * @param entry The glyph to remove.
+ */
+
+void CGlyphCache::discard(FAR struct SGlyphCacheEntry *entry)
+{
+  // Remove the glyph from its hash bucket
+
+  unsigned int index = hash(entry->fontId, entry->letter,
+                            entry->color, entry->background);
+
+  FAR struct SGlyphCacheEntry **link = &m_buckets[index];
+  while (*link != entry)
+    {
+      link = &(*link)->hashNext;
+    }
+
+  *link = entry->hashNext;
+
+  // Remove the glyph from the LRU list
+
+  if (entry->lruPrev)
+    {
+      entry->lruPrev->lruNext = entry->lruNext;
+    }
+  else
+    {
+      m_lruHead = entry->lruNext;
+    }
+
+  if (entry->lruNext)
+    {
+      entry->lruNext->lruPrev = entry->lruPrev;
+    }
+  else
+    {
+      m_lruTail = entry->lruPrev;
+    }
+
+  // And free it
+
+  m_size -= entry->size;
+  delete [] (FAR uint8_t *)entry;
+}
+
+#endif // CONFIG_NXWIDGETS_GLYPHCACHE
@@ -90,6 +90,7 @@
 #include "cgraphicsport.hxx"
 #include "cwidgetstyle.hxx"
 #include "cbitmap.hxx"
+#include "cglyphcache.hxx"
 #include "singletons.hxx"
 
 /****************************************************************************
@@ -728,13 +729,14 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
     }
 #endif
     
-  // Allocate a bit of memory to hold the largest rendered font
+  // The glyph memory is large enough to hold the largest rendered font.
+  // It is allocated when the first glyph has to be rendered here.
 
   unsigned int bmWidth   = ((unsigned int)font->getMaxWidth() * CONFIG_NXWIDGETS_BPP + 7) >> 3;
   unsigned int bmHeight  = (unsigned int)font->getHeight();
 
   unsigned int glyphSize =  bmWidth * bmHeight;
-  FAR uint8_t  *glyph    =  new uint8_t[glyphSize];
+  FAR uint8_t  *glyph    =  (FAR uint8_t *)NULL;
 
   // Get the bounding rectangle in NX form
 
@@ -746,7 +748,7 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
   struct SBitmap bitmap;
   bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
   bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
-  bitmap.data   = (FAR const nxgl_mxpixel_t*)glyph;
+  bitmap.data   = (FAR const nxgl_mxpixel_t*)NULL;
 
   // Loop for each letter in the sub-string
 
@@ -769,12 +771,6 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
       if (metrics.height > 0 || !transparent)
         {
-          // Set the current, effective size of the bitmap
-
-          bitmap.width  = fontWidth;
-          bitmap.height = bmHeight;
-          bitmap.stride = (fontWidth * bitmap.bpp + 7) >> 3;
-
           // Describe the destination of the font as a bounding box
 
           struct nxgl_rect_s dest;
@@ -793,38 +789,84 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
 
           if (!nxgl_nullrect(&intersection))
             {
-              // If we have been given a background color, use it to fill the array.
-              // Otherwise initialize the bitmap memory by reading from the display.
-              // The font renderer always renders the fonts on a transparent background.
-              
-              if (!transparent)
+              bool drawn = false;
+
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+              // If we have been given a background color, then the rendered
+              // glyph can be copied from the glyph cache.  The cache stays
+              // locked until the glyph is on the display.
+
+              if (!transparent && g_glyphCache)
                 {
-                  // Set the glyph memory to the background color
+                  g_glyphCache->lock();
 
-                  nxwidget_pixel_t *bmPtr   = (nxwidget_pixel_t *)bitmap.data;
-                  unsigned int      npixels = fontWidth * bmHeight;
-                  for (unsigned int j = 0; j < npixels; j++)
+                  FAR const struct SBitmap *cached =
+                    g_glyphCache->getGlyph(font, letter, background);
+
+                  if (cached)
                     {
-                      *bmPtr++ = background;
+                      if (!m_pNxWnd->bitmap(&intersection, cached->data,
+                                            pos, cached->stride))
+                        {
+                          gvdbg("nx_bitmapwindow failed: %d\n", errno);
+                        }
+
+                      drawn = true;
                     }
+
+                  g_glyphCache->unlock();
                 }
-              else
+#endif
+
+              if (!drawn)
                 {
-                  // Read the current contents of the destination into the glyph memory
+                  // Allocate the glyph memory on first use
 
-                  m_pNxWnd->getRectangle(&dest, &bitmap);
-                }
+                  if (!glyph)
+                    {
+                      glyph       = new uint8_t[glyphSize];
+                      bitmap.data = (FAR const nxgl_mxpixel_t*)glyph;
+                    }
 
-              // Render the font into the initialized bitmap
+                  // Set the current, effective size of the bitmap
 
-              font->drawChar(&bitmap, letter);
+                  bitmap.width  = fontWidth;
+                  bitmap.height = bmHeight;
+                  bitmap.stride = (fontWidth * bitmap.bpp + 7) >> 3;
 
-              // Then put the font on the display
+                  // If we have been given a background color, use it to fill the array.
+                  // Otherwise initialize the bitmap memory by reading from the display.
+                  // The font renderer always renders the fonts on a transparent background.
 
-              if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)bitmap.data,
-                                   pos, bitmap.stride))
-                {
-                  gvdbg("nx_bitmapwindow failed: %d\n", errno);
+                  if (!transparent)
+                    {
+                      // Set the glyph memory to the background color
+
+                      nxwidget_pixel_t *bmPtr   = (nxwidget_pixel_t *)bitmap.data;
+                      unsigned int      npixels = fontWidth * bmHeight;
+                      for (unsigned int j = 0; j < npixels; j++)
+                        {
+                          *bmPtr++ = background;
+                        }
+                    }
+                  else
+                    {
+                      // Read the current contents of the destination into the glyph memory
+
+                      m_pNxWnd->getRectangle(&dest, &bitmap);
+                    }
+
+                  // Render the font into the initialized bitmap
+
+                  font->drawChar(&bitmap, letter);
+
+                  // Then put the font on the display
+
+                  if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)bitmap.data,
+                                       pos, bitmap.stride))
+                    {
+                      gvdbg("nx_bitmapwindow failed: %d\n", errno);
+                    }
                 }
             }
         }
@@ -834,7 +876,10 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
       pos->x += fontWidth;
     }
 
-  delete glyph;
+  if (glyph)
+    {
+      delete [] glyph;
+    }
 }
 
 /**
@@ -517,7 +517,8 @@ void CListBox::drawContents(CGraphicsPort *port)
                                    item->getSelectedBackColor());
             }
     
-          // Draw text
+          // Draw text.  The background color of the option is known, so
+          // the text need not be drawn transparently.
 
           struct nxgl_point_s pos;
           pos.x = rect.getX() + m_optionPadding;
@@ -527,13 +528,15 @@ void CListBox::drawContents(CGraphicsPort *port)
             {
               port->drawText(&pos, &rect, getFont(), item->getText(), 0,
                              item->getText().getLength(),
-                             item->getSelectedTextColor());
+                             item->getSelectedTextColor(),
+                             item->getSelectedBackColor());
             }
           else
             {
               port->drawText(&pos, &rect, getFont(), item->getText(), 0,
                              item->getText().getLength(),
-                             getDisabledTextColor());
+                             getDisabledTextColor(),
+                             item->getSelectedBackColor());
            }
         }
       else
@@ -546,7 +549,8 @@ void CListBox::drawContents(CGraphicsPort *port)
                                    item->getNormalBackColor());
             }
 
-          // Draw text
+          // Draw text.  The background color of the option is known, so
+          // the text need not be drawn transparently.
 
           struct nxgl_point_s pos;
           pos.x = rect.getX() + m_optionPadding;
@@ -556,13 +560,15 @@ void CListBox::drawContents(CGraphicsPort *port)
             {
               port->drawText(&pos, &rect, getFont(), item->getText(), 0,
                              item->getText().getLength(),
-                             item->getNormalTextColor());
+                             item->getNormalTextColor(),
+                             item->getNormalBackColor());
             }
           else
             {
               port->drawText(&pos, &rect, getFont(), item->getText(), 0,
                              item->getText().getLength(),
-                             getDisabledTextColor());
+                             getDisabledTextColor(),
+                             item->getNormalBackColor());
             }
         }
 
@@ -1277,8 +1277,11 @@ void CMultiLineTextBox::drawRow(CGraphicsPort *port, int row)
       textColor = getEnabledTextColor();
     }
 
-  // And draw the text using the selected color
+  // And draw the text using the selected color.  drawBorder() has
+  // already filled the background, so the text need not be drawn
+  // transparently.
 
   port->drawText(&pos, &rect, m_text->getFont(), *m_text,
-                 m_text->getLineStartIndex(row), rowLength, textColor);
+                 m_text->getLineStartIndex(row), rowLength, textColor,
+                 getBackgroundColor());
 }
@@ -84,6 +84,7 @@
 #include "cnxstring.hxx"
 #include "cwidgetstyle.hxx"
 #include "cnxfont.hxx"
+#include "cglyphcache.hxx"
 #include "singletons.hxx"
 
 /****************************************************************************
@@ -99,6 +100,9 @@ using namespace NXWidgets;
 CWidgetStyle        *NXWidgets::g_defaultWidgetStyle; /**< The default widget style */
 CNxString           *NXWidgets::g_nullString;         /**< The reusable empty string */
 TNxArray<CNxTimer*> *NXWidgets::g_nxTimers;           /**< An array of all timers */
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+CGlyphCache         *NXWidgets::g_glyphCache;         /**< The shared glyph cache */
+#endif
 
 /****************************************************************************
  * Method Implementations
@@ -160,6 +164,15 @@ void NXWidgets::instantiateSingletons(void)
       g_nxTimers = new TNxArray<CNxTimer*>();
     }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Create the cache of rendered glyphs
+
+  if (!g_glyphCache)
+    {
+      g_glyphCache = new CGlyphCache();
+    }
+
+#endif
   sched_unlock();
 }
 
@@ -198,5 +211,15 @@ void NXWidgets::freeSingletons(void)
       g_nxTimers = (TNxArray<CNxTimer*> *)NULL;
     }
 
+#ifdef CONFIG_NXWIDGETS_GLYPHCACHE
+  // Free the glyph cache
+
+  if (g_glyphCache)
+    {
+      delete g_glyphCache;
+      g_glyphCache = (CGlyphCache *)NULL;
+    }
+#endif
+
 }
 
@@ -0,0 +1,388 @@
+/****************************************************************************
+ * examples/bchbench/bchbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+
+#ifdef CONFIG_ARCH_SIM
+#  include <arch/arch.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_BCHBENCH_NSECTORS
+#  define CONFIG_EXAMPLES_BCHBENCH_NSECTORS 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE
+#  define CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE 512
+#endif
+
+#ifndef CONFIG_BCH_NSECTORS
+#  define CONFIG_BCH_NSECTORS 1
+#endif
+
+#ifndef CONFIG_BCH_READAHEAD
+#  define CONFIG_BCH_READAHEAD 0
+#endif
+
+#define NSECTORS    CONFIG_EXAMPLES_BCHBENCH_NSECTORS
+#define SECTORSIZE  CONFIG_EXAMPLES_BCHBENCH_SECTORSIZE
+#define DEVSIZE     (NSECTORS * SECTORSIZE)
+#define MAXCHUNK    2048
+
+#define BLOCKDEV    "/dev/bchbench_blk"
+#define CHARDEV     "/dev/bchbench"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bchbench_dev_s
+{
+  FAR uint8_t *storage;   /* The RAM backing the block device */
+  unsigned int nreads;    /* Number of read() calls */
+  unsigned int nwrites;   /* Number of write() calls */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     bchbench_open(FAR struct inode *inode);
+static int     bchbench_close(FAR struct inode *inode);
+static ssize_t bchbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors);
+static ssize_t bchbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     bchbench_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  bchbench_open,     /* open     */
+  bchbench_close,    /* close    */
+  bchbench_read,     /* read     */
+  bchbench_write,    /* write    */
+  bchbench_geometry, /* geometry */
+  NULL               /* ioctl    */
+};
+
+/* The transfer sizes used by the benchmark.  Whole sectors bypass the BCH
+ * cache;  the others exercise it.
+ */
+
+static const size_t g_chunks[] = { 32, 100, 500, SECTORSIZE, 1500 };
+
+static struct bchbench_dev_s g_dev;
+static uint8_t g_chunk[MAXCHUNK];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Block driver methods for the counting RAM disk */
+
+static int bchbench_open(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static int bchbench_close(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static ssize_t bchbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors)
+{
+  FAR struct bchbench_dev_s *dev = (FAR struct bchbench_dev_s *)inode->i_private;
+
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(buffer, &dev->storage[start_sector * SECTORSIZE],
+         nsectors * SECTORSIZE);
+  dev->nreads++;
+  return nsectors;
+}
+
+static ssize_t bchbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  FAR struct bchbench_dev_s *dev = (FAR struct bchbench_dev_s *)inode->i_private;
+
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(&dev->storage[start_sector * SECTORSIZE], buffer,
+         nsectors * SECTORSIZE);
+  dev->nwrites++;
+  return nsectors;
+}
+
+static int bchbench_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  memset(geometry, 0, sizeof(struct geometry));
+  geometry->geo_available    = true;
+  geometry->geo_writeenabled = true;
+  geometry->geo_nsectors     = NSECTORS;
+  geometry->geo_sectorsize   = SECTORSIZE;
+  return OK;
+}
+
+/* Microsecond time stamps.  On the simulator, use the host's clock so that
+ * the result does not depend on the simulated timer.
+ */
+
+static uint32_t bchbench_usec(void)
+{
+#ifdef CONFIG_ARCH_SIM
+  return (uint32_t)(up_hostnsec() / 1000);
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* The expected content of the device at a byte offset */
+
+static inline uint8_t bchbench_pattern(off_t offset, int pass)
+{
+  return (uint8_t)((offset >> 8) + offset + pass);
+}
+
+/* Print one result line */
+
+static void bchbench_report(FAR const char *what, size_t chunk,
+                            uint32_t elapsed, unsigned int nreads,
+                            unsigned int nwrites)
+{
+  uint32_t kbps;
+  uint32_t rdops;
+  uint32_t wrops;
+
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  /* KiB/s and operations per KiB (times 1000) */
+
+  kbps  = (uint32_t)(((uint64_t)DEVSIZE * 1000000 / 1024) / elapsed);
+  rdops = (uint32_t)((uint64_t)nreads * 1024 * 1000 / DEVSIZE);
+  wrops = (uint32_t)((uint64_t)nwrites * 1024 * 1000 / DEVSIZE);
+
+  printf("  %-5s %5lu  %8lu  %3lu.%03lu  %3lu.%03lu\n", what,
+         (unsigned long)chunk, (unsigned long)kbps,
+         (unsigned long)(rdops / 1000), (unsigned long)(rdops % 1000),
+         (unsigned long)(wrops / 1000), (unsigned long)(wrops % 1000));
+}
+
+/* Stream the whole device through the character driver in one direction */
+
+static int bchbench_stream(int fd, size_t chunk, bool writing, int pass)
+{
+  off_t offset = 0;
+  uint32_t start;
+  uint32_t elapsed;
+  ssize_t nbytes;
+  size_t len;
+  size_t i;
+  int errors = 0;
+
+  if (lseek(fd, 0, SEEK_SET) != 0)
+    {
+      printf("bchbench: lseek failed: %d\n", errno);
+      return -1;
+    }
+
+  g_dev.nreads  = 0;
+  g_dev.nwrites = 0;
+  start = bchbench_usec();
+
+  while (offset < DEVSIZE)
+    {
+      len = chunk;
+      if (offset + len > DEVSIZE)
+        {
+          len = DEVSIZE - offset;
+        }
+
+      if (writing)
+        {
+          for (i = 0; i < len; i++)
+            {
+              g_chunk[i] = bchbench_pattern(offset + i, pass);
+            }
+
+          nbytes = write(fd, g_chunk, len);
+        }
+      else
+        {
+          nbytes = read(fd, g_chunk, len);
+          for (i = 0; i < (size_t)nbytes; i++)
+            {
+              if (g_chunk[i] != bchbench_pattern(offset + i, pass))
+                {
+                  errors++;
+                }
+            }
+        }
+
+      if (nbytes != (ssize_t)len)
+        {
+          printf("bchbench: transfer at %ld failed: %ld\n",
+                 (long)offset, (long)nbytes);
+          return -1;
+        }
+
+      offset += len;
+    }
+
+  elapsed = bchbench_usec() - start;
+  bchbench_report(writing ? "write" : "read", chunk, elapsed,
+                  g_dev.nreads, g_dev.nwrites);
+
+  if (errors > 0)
+    {
+      printf("bchbench: ERROR: %d bytes miscompared\n", errors);
+      return -1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * bchbench_main
+ ****************************************************************************/
+
+int bchbench_main(int argc, char *argv[])
+{
+  int ret = EXIT_FAILURE;
+  int fd;
+  int i;
+
+  g_dev.storage = (FAR uint8_t *)malloc(DEVSIZE);
+  if (!g_dev.storage)
+    {
+      printf("bchbench: failed to allocate %d bytes\n", DEVSIZE);
+      return EXIT_FAILURE;
+    }
+
+  memset(g_dev.storage, 0, DEVSIZE);
+
+  if (register_blockdriver(BLOCKDEV, &g_bops, 0, &g_dev) < 0)
+    {
+      printf("bchbench: register_blockdriver failed\n");
+      goto errout_with_storage;
+    }
+
+  if (bchdev_register(BLOCKDEV, CHARDEV, false) < 0)
+    {
+      printf("bchbench: bchdev_register failed\n");
+      goto errout_with_blockdev;
+    }
+
+  fd = open(CHARDEV, O_RDWR);
+  if (fd < 0)
+    {
+      printf("bchbench: open %s failed: %d\n", CHARDEV, errno);
+      goto errout_with_chardev;
+    }
+
+  printf("\nBCH benchmark: %d KiB device, %d cached sectors, "
+         "%d read-ahead\n", DEVSIZE / 1024, CONFIG_BCH_NSECTORS,
+         CONFIG_BCH_READAHEAD);
+  printf("  %-5s %5s  %8s  %7s  %7s\n",
+         "", "chunk", "KiB/s", "rd/KiB", "wr/KiB");
+
+  for (i = 0; i < sizeof(g_chunks) / sizeof(g_chunks[0]); i++)
+    {
+      if (bchbench_stream(fd, g_chunks[i], true, i) < 0 ||
+          bchbench_stream(fd, g_chunks[i], false, i) < 0)
+        {
+          goto errout_with_fd;
+        }
+    }
+
+  ret = EXIT_SUCCESS;
+
+errout_with_fd:
+  close(fd);
+errout_with_chardev:
+  (void)bchdev_unregister(CHARDEV);
+errout_with_blockdev:
+  (void)unregister_blockdriver(BLOCKDEV);
+errout_with_storage:
+  free(g_dev.storage);
+  return ret;
+}
@@ -0,0 +1,330 @@
+/****************************************************************************
+ * examples/chksumbench/chksumbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <nuttx/net/uip/uip-arch.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_CHKSUMBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_CHKSUMBENCH_MAXSIZE 1024
+#endif
+
+#ifndef CONFIG_EXAMPLES_CHKSUMBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_CHKSUMBENCH_NLOOPS 100
+#endif
+
+#define MAXSIZE     CONFIG_EXAMPLES_CHKSUMBENCH_MAXSIZE
+#define NLOOPS      CONFIG_EXAMPLES_CHKSUMBENCH_NLOOPS
+
+/* The correctness test uses every length below MAXLEN at every alignment
+ * below MAXALIGN (of both buffers for the copy).
+ */
+
+#define MAXALIGN    8
+#define MAXLEN      80
+
+#if MAXSIZE > MAXLEN
+#  define BUFSIZE   (MAXSIZE + MAXALIGN)
+#else
+#  define BUFSIZE   (MAXLEN + MAXALIGN)
+#endif
+
+#define MAXERRORS   10
+
+/* Each measurement is repeated NBATCHES times and the shortest time is
+ * reported.  That discards the batches that were interrupted.
+ */
+
+#define NBATCHES    5
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The buffers are aligned to 16 bytes at run time */
+
+static uint8_t g_srcraw[BUFSIZE + 16];
+static uint8_t g_destraw[BUFSIZE + 16];
+static FAR uint8_t *g_src;
+static FAR uint8_t *g_dest;
+
+static int g_nerrors;
+static volatile uint16_t g_sink;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Byte-at-a-time one's complement sum of big-endian words, the reference
+ * for the test.  Returned in host byte order.
+ */
+
+static uint16_t chksumbench_reference(FAR const uint8_t *src, size_t len)
+{
+  uint32_t sum = 0;
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    {
+      sum += (i & 1) ? src[i] : (uint32_t)src[i] << 8;
+      sum  = (sum & 0xffff) + (sum >> 16);
+    }
+
+  return (uint16_t)sum;
+}
+
+static void chksumbench_error(FAR const char *what, int align, size_t len,
+                              uint16_t sum, uint16_t expected)
+{
+  if (g_nerrors < MAXERRORS)
+    {
+      printf("chksumbench: %s failed: alignment %d, length %lu, "
+             "sum %04x, expected %04x\n", what, align, (unsigned long)len,
+             sum, expected);
+    }
+
+  g_nerrors++;
+}
+
+/****************************************************************************
+ * Name: chksumbench_test
+ *
+ * Description:
+ *   Check uip_chksum() against the reference for every length and
+ *   alignment, for random bytes and for bytes that are all 0xff (which has
+ *   the most carries).  Check that uip_copychksum() returns the same sum
+ *   and copies exactly the requested bytes for every length and every
+ *   alignment of both buffers.
+ *
+ ****************************************************************************/
+
+static void chksumbench_test(void)
+{
+  FAR uint8_t *src;
+  FAR uint8_t *dest;
+  uint16_t expected;
+  uint16_t sum;
+  size_t len;
+  size_t i;
+  int salign;
+  int dalign;
+  int pass;
+
+  for (pass = 0; pass < 2; pass++)
+    {
+      for (i = 0; i < BUFSIZE; i++)
+        {
+          g_src[i] = pass == 0 ? (uint8_t)rand() : 0xff;
+        }
+
+      for (salign = 0; salign < MAXALIGN; salign++)
+        {
+          for (len = 0; len < MAXLEN; len++)
+            {
+              src      = g_src + salign;
+              expected = chksumbench_reference(src, len);
+              sum      = ntohs(uip_chksum((FAR uint16_t *)src, len));
+              if (sum != expected)
+                {
+                  chksumbench_error("uip_chksum", salign, len, sum,
+                                    expected);
+                }
+
+              for (dalign = 0; dalign < MAXALIGN; dalign++)
+                {
+                  dest = g_dest + dalign;
+                  memset(g_dest, 0x5a, BUFSIZE);
+
+                  sum = uip_copychksum(dest, src, len);
+                  if (sum != expected)
+                    {
+                      chksumbench_error("uip_copychksum", salign * 10 +
+                                        dalign, len, sum, expected);
+                    }
+
+                  if (memcmp(dest, src, len) != 0 ||
+                      (dalign > 0 && dest[-1] != 0x5a) ||
+                      dest[len] != 0x5a)
+                    {
+                      chksumbench_error("uip_copychksum copy",
+                                        salign * 10 + dalign, len, 0, 0);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: chksumbench_time
+ *
+ * Description:
+ *   Return the shortest time taken by NLOOPS calls to uip_chksum(), to
+ *   memcpy() and uip_chksum(), or to uip_copychksum() on 'len' bytes in
+ *   NBATCHES attempts.
+ *
+ ****************************************************************************/
+
+enum chksumbench_op_e
+{
+  CHKSUM = 0,
+  MEMCPY_CHKSUM,
+  COPYCHKSUM
+};
+
+static uint32_t chksumbench_time(enum chksumbench_op_e op, size_t len)
+{
+  uint32_t shortest = UINT32_MAX;
+  uint32_t elapsed;
+  uint32_t start;
+  int batch;
+  int i;
+
+  for (batch = 0; batch < NBATCHES; batch++)
+    {
+      start = benchtime_now();
+      for (i = 0; i < NLOOPS; i++)
+        {
+          switch (op)
+            {
+            case CHKSUM:
+              g_sink = uip_chksum((FAR uint16_t *)g_src, len);
+              break;
+
+            case MEMCPY_CHKSUM:
+              memcpy(g_dest, g_src, len);
+              g_sink = uip_chksum((FAR uint16_t *)g_dest, len);
+              break;
+
+            case COPYCHKSUM:
+              g_sink = uip_copychksum(g_dest, g_src, len);
+              break;
+            }
+        }
+
+      elapsed = benchtime_now() - start;
+      if (elapsed < shortest)
+        {
+          shortest = elapsed;
+        }
+    }
+
+  return shortest;
+}
+
+/* Print the bytes per time unit with two decimal places, followed by the
+ * average time of one call.
+ */
+
+static void chksumbench_print(size_t len, uint32_t elapsed)
+{
+  unsigned long percall = (unsigned long)elapsed / NLOOPS;
+  unsigned long rate;
+
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  rate = (unsigned long)((uint64_t)len * NLOOPS * 100 / elapsed);
+  printf("  %6lu.%02lu (%6lu)", rate / 100, rate % 100, percall);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * chksumbench_main
+ ****************************************************************************/
+
+int chksumbench_main(int argc, char *argv[])
+{
+  size_t size;
+
+  benchtime_initialize();
+
+  g_src     = (FAR uint8_t *)(((uintptr_t)g_srcraw + 15) & ~(uintptr_t)15);
+  g_dest    = (FAR uint8_t *)(((uintptr_t)g_destraw + 15) & ~(uintptr_t)15);
+  g_nerrors = 0;
+
+  printf("\nInternet checksum test:\n");
+
+  chksumbench_test();
+  if (g_nerrors > 0)
+    {
+      printf("chksumbench: %d errors\n", g_nerrors);
+      return EXIT_FAILURE;
+    }
+
+  printf("  PASSED\n");
+
+  for (size = 0; size < BUFSIZE; size++)
+    {
+      g_src[size] = (uint8_t)rand();
+    }
+
+  printf("\nInternet checksum benchmark, %d calls, bytes per %s "
+         "(average %s per call):\n", NLOOPS, BENCHTIME_UNIT, BENCHTIME_UNITS);
+  printf("  %6s  %18s  %18s  %18s\n",
+         "size", "uip_chksum", "memcpy+chksum", "uip_copychksum");
+
+  for (size = 16; size <= MAXSIZE; size <<= 2)
+    {
+      printf("  %6lu", (unsigned long)size);
+      chksumbench_print(size, chksumbench_time(CHKSUM, size));
+      chksumbench_print(size, chksumbench_time(MEMCPY_CHKSUM, size));
+      chksumbench_print(size, chksumbench_time(COPYCHKSUM, size));
+      printf("\n");
+    }
+
+  return EXIT_SUCCESS;
+}
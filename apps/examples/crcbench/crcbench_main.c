@@ -0,0 +1,300 @@
+/****************************************************************************
+ * examples/crcbench/crcbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <crc32.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_CRCBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_CRCBENCH_MAXSIZE 16384
+#endif
+
+#ifndef CONFIG_EXAMPLES_CRCBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_CRCBENCH_NLOOPS 100
+#endif
+
+#define MAXSIZE     CONFIG_EXAMPLES_CRCBENCH_MAXSIZE
+#define NLOOPS      CONFIG_EXAMPLES_CRCBENCH_NLOOPS
+
+/* The correctness test uses every length below MAXLEN at every alignment
+ * below MAXALIGN.  The buffer must also hold SPLITSIZE bytes for the test
+ * of calculations done in two parts.
+ */
+
+#define MAXALIGN    8
+#define MAXLEN      80
+#define SPLITSIZE   256
+
+#if MAXSIZE > SPLITSIZE
+#  define BUFSIZE   (MAXSIZE + MAXALIGN)
+#else
+#  define BUFSIZE   (SPLITSIZE + MAXALIGN)
+#endif
+
+#define MAXERRORS   10
+
+/* Each measurement is repeated NBATCHES times and the shortest time is
+ * reported.  That discards the batches that were interrupted.
+ */
+
+#define NBATCHES    5
+
+/* The CRC of "123456789" with the initial value zero (as computed by
+ * crc32()) and with the usual initial value and final inversion.
+ */
+
+#define CHECK_STRING "123456789"
+#define CHECK_CRC    0x2dfd2d88
+#define CHECK_CRCINV 0xcbf43926
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The buffer is aligned to 16 bytes at run time */
+
+static uint8_t g_raw[BUFSIZE + 16];
+static FAR uint8_t *g_buffer;
+
+static int g_nerrors;
+static volatile uint32_t g_sink;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Bit-at-a-time CRC with the same polynomial, the reference for the test */
+
+static uint32_t crcbench_reference(FAR const uint8_t *src, size_t len,
+                                   uint32_t crc)
+{
+  int bit;
+
+  while (len-- > 0)
+    {
+      crc ^= *src++;
+      for (bit = 0; bit < 8; bit++)
+        {
+          crc = (crc >> 1) ^ ((crc & 1) ? 0xedb88320 : 0);
+        }
+    }
+
+  return crc;
+}
+
+static void crcbench_error(FAR const char *what, int align, size_t len,
+                           uint32_t crc, uint32_t expected)
+{
+  if (g_nerrors < MAXERRORS)
+    {
+      printf("crcbench: %s failed: alignment %d, length %lu, "
+             "CRC %08lx, expected %08lx\n", what, align, (unsigned long)len,
+             (unsigned long)crc, (unsigned long)expected);
+    }
+
+  g_nerrors++;
+}
+
+/****************************************************************************
+ * Name: crcbench_test
+ *
+ * Description:
+ *   Check crc32() and crc32part() against the reference for the check
+ *   string, for every length and alignment with initial values of zero and
+ *   all ones, and for a buffer processed in two parts split at every
+ *   position.
+ *
+ ****************************************************************************/
+
+static void crcbench_test(void)
+{
+  static const uint32_t initial[2] = { 0, 0xffffffff };
+  FAR uint8_t *src;
+  uint32_t expected;
+  uint32_t crc;
+  size_t len;
+  size_t i;
+  int align;
+
+  crc = crc32((FAR const uint8_t *)CHECK_STRING, strlen(CHECK_STRING));
+  if (crc != CHECK_CRC)
+    {
+      crcbench_error("crc32", 0, strlen(CHECK_STRING), crc, CHECK_CRC);
+    }
+
+  crc = ~crc32part((FAR const uint8_t *)CHECK_STRING, strlen(CHECK_STRING),
+                   0xffffffff);
+  if (crc != CHECK_CRCINV)
+    {
+      crcbench_error("crc32part", 0, strlen(CHECK_STRING), crc,
+                     CHECK_CRCINV);
+    }
+
+  for (i = 0; i < BUFSIZE; i++)
+    {
+      g_buffer[i] = (uint8_t)rand();
+    }
+
+  for (align = 0; align < MAXALIGN; align++)
+    {
+      for (len = 0; len < MAXLEN; len++)
+        {
+          src = g_buffer + align;
+          for (i = 0; i < 2; i++)
+            {
+              expected = crcbench_reference(src, len, initial[i]);
+              crc      = crc32part(src, len, initial[i]);
+              if (crc != expected)
+                {
+                  crcbench_error("crc32part", align, len, crc, expected);
+                }
+            }
+        }
+    }
+
+  expected = crcbench_reference(g_buffer, SPLITSIZE, 0);
+  for (len = 0; len <= SPLITSIZE; len++)
+    {
+      crc = crc32part(g_buffer + len, SPLITSIZE - len,
+                      crc32(g_buffer, len));
+      if (crc != expected)
+        {
+          crcbench_error("split", 0, len, crc, expected);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: crcbench_time
+ *
+ * Description:
+ *   Return the shortest time taken by NLOOPS calls to crc32part() on 'len'
+ *   bytes in NBATCHES attempts.
+ *
+ ****************************************************************************/
+
+static uint32_t crcbench_time(FAR const uint8_t *src, size_t len)
+{
+  uint32_t shortest = UINT32_MAX;
+  uint32_t elapsed;
+  uint32_t start;
+  int batch;
+  int i;
+
+  g_sink = crc32part(src, len, 0);
+
+  for (batch = 0; batch < NBATCHES; batch++)
+    {
+      start = benchtime_now();
+      for (i = 0; i < NLOOPS; i++)
+        {
+          g_sink = crc32part(src, len, g_sink);
+        }
+
+      elapsed = benchtime_now() - start;
+      if (elapsed < shortest)
+        {
+          shortest = elapsed;
+        }
+    }
+
+  return shortest;
+}
+
+/* Print the average time of one call and per byte with two decimal
+ * places.
+ */
+
+static void crcbench_print(size_t len, uint32_t elapsed)
+{
+  unsigned long percall = (unsigned long)elapsed / NLOOPS;
+  unsigned long perbyte = percall * 100 / len;
+
+  printf("  %6lu  %10lu  %6lu.%02lu\n", (unsigned long)len, percall,
+         perbyte / 100, perbyte % 100);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * crcbench_main
+ ****************************************************************************/
+
+int crcbench_main(int argc, char *argv[])
+{
+  size_t size;
+
+  benchtime_initialize();
+
+  g_buffer  = (FAR uint8_t *)(((uintptr_t)g_raw + 15) & ~(uintptr_t)15);
+  g_nerrors = 0;
+
+  printf("\nCRC32 test:\n");
+
+  crcbench_test();
+  if (g_nerrors > 0)
+    {
+      printf("crcbench: %d errors\n", g_nerrors);
+      return EXIT_FAILURE;
+    }
+
+  printf("  PASSED\n");
+
+  printf("\nCRC32 benchmark, %d calls, average %s:\n", NLOOPS, BENCHTIME_UNITS);
+  printf("  %6s  %10s  %9s\n", "size", "per call", "per byte");
+
+  for (size = 16; size <= MAXSIZE; size <<= 3)
+    {
+      crcbench_print(size, crcbench_time(g_buffer, size));
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,481 @@
+/****************************************************************************
+ * examples/demuxbench/demuxbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <errno.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <nuttx/net/uip/uip.h>
+#include <nuttx/net/uip/uip-arch.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_DEMUXBENCH_NCONNS
+#  define CONFIG_EXAMPLES_DEMUXBENCH_NCONNS 15
+#endif
+
+#ifndef CONFIG_EXAMPLES_DEMUXBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_DEMUXBENCH_NLOOPS 1000
+#endif
+
+#define NCONNS      CONFIG_EXAMPLES_DEMUXBENCH_NCONNS
+#define NLOOPS      CONFIG_EXAMPLES_DEMUXBENCH_NLOOPS
+
+/* The packets appear to come from port REMOTE_PORT + n on 10.0.0.2 and are
+ * sent to 10.0.0.1.  TCP connections are accepted on TCP_PORT and UDP
+ * socket n is bound to UDP_PORT + n.
+ */
+
+#define LOCAL_IPADDR  HTONL(0x0a000001)
+#define REMOTE_IPADDR HTONL(0x0a000002)
+#define REMOTE_PORT   20000
+#define TCP_PORT      5471
+#define UDP_PORT      5472
+
+#define TCPBUF ((struct uip_tcpip_hdr *)&g_dev.d_buf[UIP_LLH_LEN])
+#define UDPBUF ((struct uip_udpip_hdr *)&g_dev.d_buf[UIP_LLH_LEN])
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The packets are passed to uIP through this device structure, which is
+ * not registered with the network.  Responses are left in its buffer.
+ */
+
+static struct uip_driver_s g_dev;
+#ifdef CONFIG_NET_MULTIBUFFER
+static uint8_t g_pktbuf[CONFIG_NET_BUFSIZE + CONFIG_NET_GUARDSIZE];
+#endif
+
+/* The next sequence number expected by each TCP connection */
+
+static uint32_t g_ackno[NCONNS];
+
+/* The UDP sockets and the threads that wait on them */
+
+static int g_udpsd[NCONNS];
+static pthread_t g_receiver[NCONNS];
+static volatile bool g_done;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void demuxbench_put32(FAR uint8_t *dest, uint32_t value)
+{
+  dest[0] = value >> 24;
+  dest[1] = value >> 16;
+  dest[2] = value >> 8;
+  dest[3] = value;
+}
+
+static uint32_t demuxbench_get32(FAR const uint8_t *src)
+{
+  return (uint32_t)src[0] << 24 | (uint32_t)src[1] << 16 |
+         (uint32_t)src[2] << 8 | (uint32_t)src[3];
+}
+
+/****************************************************************************
+ * Name: demuxbench_tcppacket and demuxbench_udppacket
+ *
+ * Description:
+ *   Build a TCP segment without data or a one byte UDP datagram from
+ *   remote port REMOTE_PORT + ndx in the device buffer.
+ *
+ ****************************************************************************/
+
+static void demuxbench_tcppacket(int ndx, uint32_t seqno, uint32_t ackno,
+                                 uint8_t flags)
+{
+  FAR struct uip_tcpip_hdr *pbuf = TCPBUF;
+  in_addr_t srcipaddr  = REMOTE_IPADDR;
+  in_addr_t destipaddr = LOCAL_IPADDR;
+
+  memset(pbuf, 0, UIP_IPTCPH_LEN);
+  pbuf->vhl         = 0x45;
+  pbuf->len[1]      = UIP_IPTCPH_LEN;
+  pbuf->ttl         = 64;
+  pbuf->proto       = UIP_PROTO_TCP;
+  memcpy(pbuf->srcipaddr, &srcipaddr, sizeof(in_addr_t));
+  memcpy(pbuf->destipaddr, &destipaddr, sizeof(in_addr_t));
+  pbuf->ipchksum    = ~(uip_ipchksum(&g_dev));
+
+  pbuf->srcport     = HTONS(REMOTE_PORT + ndx);
+  pbuf->destport    = HTONS(TCP_PORT);
+  demuxbench_put32(pbuf->seqno, seqno);
+  demuxbench_put32(pbuf->ackno, ackno);
+  pbuf->tcpoffset   = (UIP_TCPH_LEN / 4) << 4;
+  pbuf->flags       = flags;
+  pbuf->wnd[0]      = CONFIG_NET_RECEIVE_WINDOW >> 8;
+  pbuf->wnd[1]      = CONFIG_NET_RECEIVE_WINDOW & 0xff;
+  pbuf->tcpchksum   = ~(uip_tcpchksum(&g_dev));
+
+  g_dev.d_len       = UIP_LLH_LEN + UIP_IPTCPH_LEN;
+}
+
+static void demuxbench_udppacket(int ndx)
+{
+  FAR struct uip_udpip_hdr *pbuf = UDPBUF;
+  in_addr_t srcipaddr  = REMOTE_IPADDR;
+  in_addr_t destipaddr = LOCAL_IPADDR;
+
+  memset(pbuf, 0, UIP_IPUDPH_LEN + 1);
+  pbuf->vhl         = 0x45;
+  pbuf->len[1]      = UIP_IPUDPH_LEN + 1;
+  pbuf->ttl         = 64;
+  pbuf->proto       = UIP_PROTO_UDP;
+  memcpy(pbuf->srcipaddr, &srcipaddr, sizeof(in_addr_t));
+  memcpy(pbuf->destipaddr, &destipaddr, sizeof(in_addr_t));
+  pbuf->ipchksum    = ~(uip_ipchksum(&g_dev));
+
+  /* A zero UDP checksum means that there is no checksum */
+
+  pbuf->srcport     = HTONS(REMOTE_PORT + ndx);
+  pbuf->destport    = HTONS(UDP_PORT + ndx);
+  pbuf->udplen      = HTONS(UIP_UDPH_LEN + 1);
+
+  g_dev.d_len       = UIP_LLH_LEN + UIP_IPUDPH_LEN + 1;
+}
+
+/****************************************************************************
+ * Name: demuxbench_input
+ *
+ * Description:
+ *   Pass the packet in the device buffer to uIP as a network driver would
+ *   and return the time that uip_input() took.
+ *
+ ****************************************************************************/
+
+static uint32_t demuxbench_input(void)
+{
+  uip_lock_t flags;
+  uint32_t start;
+  uint32_t elapsed;
+
+  flags   = uip_lock();
+  start   = benchtime_now();
+  uip_input(&g_dev);
+  elapsed = benchtime_now() - start;
+  uip_unlock(flags);
+
+  return elapsed;
+}
+
+/****************************************************************************
+ * Name: demuxbench_tcpconnect
+ *
+ * Description:
+ *   Open TCP connection 'ndx' by sending a SYN to the listening socket and
+ *   acknowledging the SYNACK.  The connection then waits in the listen
+ *   backlog.
+ *
+ ****************************************************************************/
+
+static int demuxbench_tcpconnect(int ndx)
+{
+  demuxbench_tcppacket(ndx, 0, 0, TCP_SYN);
+  (void)demuxbench_input();
+
+  if (g_dev.d_len == 0 || TCPBUF->flags != (TCP_SYN | TCP_ACK))
+    {
+      printf("demuxbench: TCP connection %d was not accepted\n", ndx);
+      return ERROR;
+    }
+
+  g_ackno[ndx] = demuxbench_get32(TCPBUF->seqno) + 1;
+
+  demuxbench_tcppacket(ndx, 1, g_ackno[ndx], TCP_ACK);
+  (void)demuxbench_input();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: demuxbench_receiver
+ *
+ * Description:
+ *   Wait for datagrams on one UDP socket until the benchmark is done.  This
+ *   thread runs at a lower priority than the benchmark so that it is
+ *   waiting in recv() whenever the benchmark runs.
+ *
+ ****************************************************************************/
+
+static FAR void *demuxbench_receiver(FAR void *arg)
+{
+  int sd = (int)((intptr_t)arg);
+  char ch;
+
+  while (!g_done)
+    {
+      (void)recv(sd, &ch, 1, 0);
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: demuxbench_udpopen
+ *
+ * Description:
+ *   Bind UDP socket 'ndx' to port UDP_PORT + ndx and start a thread that
+ *   receives on it.
+ *
+ ****************************************************************************/
+
+static int demuxbench_udpopen(int ndx)
+{
+  struct sched_param param;
+  struct sockaddr_in addr;
+  pthread_attr_t attr;
+  int ret;
+
+  g_udpsd[ndx] = socket(PF_INET, SOCK_DGRAM, 0);
+  if (g_udpsd[ndx] < 0)
+    {
+      printf("demuxbench: socket failed: %d\n", errno);
+      return ERROR;
+    }
+
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = HTONS(UDP_PORT + ndx);
+  addr.sin_addr.s_addr = HTONL(INADDR_ANY);
+
+  if (bind(g_udpsd[ndx], (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+      printf("demuxbench: bind failed: %d\n", errno);
+      close(g_udpsd[ndx]);
+      return ERROR;
+    }
+
+  (void)pthread_attr_init(&attr);
+  param.sched_priority = SCHED_PRIORITY_DEFAULT - 10;
+  (void)pthread_attr_setschedparam(&attr, &param);
+
+  ret = pthread_create(&g_receiver[ndx], &attr, demuxbench_receiver,
+                       (pthread_addr_t)((intptr_t)g_udpsd[ndx]));
+  if (ret != 0)
+    {
+      printf("demuxbench: pthread_create failed: %d\n", ret);
+      close(g_udpsd[ndx]);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: demuxbench_tcprun and demuxbench_udprun
+ *
+ * Description:
+ *   Send NLOOPS packets, spread evenly over the first 'nconns' connections,
+ *   and return the average time that uip_input() took for one packet.
+ *
+ ****************************************************************************/
+
+static uint32_t demuxbench_tcprun(int nconns)
+{
+  uint32_t elapsed = 0;
+  int ndx;
+  int i;
+
+  for (i = 0; i < NLOOPS; i++)
+    {
+      /* A duplicate ACK is matched to its connection and then dropped */
+
+      ndx = i % nconns;
+      demuxbench_tcppacket(ndx, 1, g_ackno[ndx], TCP_ACK);
+      elapsed += demuxbench_input();
+
+      if (g_dev.d_len != 0)
+        {
+          printf("demuxbench: unexpected response on TCP connection %d\n",
+                 ndx);
+          return 0;
+        }
+    }
+
+  return elapsed / NLOOPS;
+}
+
+static uint32_t demuxbench_udprun(int nconns)
+{
+  uint32_t elapsed = 0;
+  int i;
+
+  /* Let the receiver threads get back into recv() */
+
+  usleep(100*1000);
+
+  for (i = 0; i < NLOOPS; i++)
+    {
+      /* The first datagram on each socket is received.  The rest are
+       * matched to the socket and dropped.
+       */
+
+      demuxbench_udppacket(i % nconns);
+      elapsed += demuxbench_input();
+    }
+
+  return elapsed / NLOOPS;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * demuxbench_main
+ ****************************************************************************/
+
+int demuxbench_main(int argc, char *argv[])
+{
+  struct sockaddr_in addr;
+  uint32_t ttcp;
+  uint32_t tudp;
+  int listensd;
+  int nconns;
+  int maxconns;
+  int ret = EXIT_SUCCESS;
+  int i;
+
+  benchtime_initialize();
+
+#ifdef CONFIG_NET_MULTIBUFFER
+  g_dev.d_buf    = g_pktbuf;
+#endif
+  g_dev.d_ipaddr = LOCAL_IPADDR;
+  g_done         = false;
+
+  /* Create the TCP socket that accepts connections into its backlog */
+
+  listensd = socket(PF_INET, SOCK_STREAM, 0);
+  if (listensd < 0)
+    {
+      printf("demuxbench: socket failed: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = HTONS(TCP_PORT);
+  addr.sin_addr.s_addr = HTONL(INADDR_ANY);
+
+  if (bind(listensd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      listen(listensd, NCONNS) < 0)
+    {
+      printf("demuxbench: bind/listen failed: %d\n", errno);
+      close(listensd);
+      return EXIT_FAILURE;
+    }
+
+  printf("\nuip_input() time with N connections, times in %s:\n",
+         BENCHTIME_UNITS);
+  printf("  %6s  %8s  %8s\n", "N", "TCP", "UDP");
+
+  /* Add connections and sockets and time each packet type */
+
+  maxconns = 0;
+  for (nconns = 1; ; nconns <<= 1)
+    {
+      if (nconns > NCONNS)
+        {
+          nconns = NCONNS;
+        }
+
+      for (; maxconns < nconns; maxconns++)
+        {
+          if (demuxbench_tcpconnect(maxconns) != OK ||
+              demuxbench_udpopen(maxconns) != OK)
+            {
+              ret = EXIT_FAILURE;
+              goto errout;
+            }
+        }
+
+      ttcp = demuxbench_tcprun(nconns);
+      tudp = demuxbench_udprun(nconns);
+
+      printf("  %6d  %8lu  %8lu\n", nconns,
+             (unsigned long)ttcp, (unsigned long)tudp);
+
+      if (nconns == NCONNS)
+        {
+          break;
+        }
+    }
+
+errout:
+
+  /* Wake up the receiver threads with one more datagram each and wait for
+   * them to exit.  Closing the listening socket frees the TCP connections
+   * in its backlog.
+   */
+
+  g_done = true;
+  for (i = 0; i < maxconns; i++)
+    {
+      demuxbench_udppacket(i);
+      (void)demuxbench_input();
+    }
+
+  for (i = 0; i < maxconns; i++)
+    {
+      (void)pthread_join(g_receiver[i], NULL);
+      close(g_udpsd[i]);
+    }
+
+  close(listensd);
+  return ret;
+}
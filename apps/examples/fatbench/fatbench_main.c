@@ -0,0 +1,641 @@
+/****************************************************************************
+ * examples/fatbench/fatbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/statfs.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/mkfatfs.h>
+
+#ifdef CONFIG_ARCH_SIM
+#  include <arch/arch.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_NSECTORS
+#  define CONFIG_EXAMPLES_FATBENCH_NSECTORS 16384
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_NRECORDS
+#  define CONFIG_EXAMPLES_FATBENCH_NRECORDS 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_RECSIZE
+#  define CONFIG_EXAMPLES_FATBENCH_RECSIZE 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_FATBENCH_SYNCINTERVAL
+#  define CONFIG_EXAMPLES_FATBENCH_SYNCINTERVAL 16
+#endif
+
+#ifndef CONFIG_FAT_CACHESECTORS
+#  define CONFIG_FAT_CACHESECTORS 1
+#endif
+
+#ifdef CONFIG_FAT_FREEBITMAP
+#  define FREEBITMAP "yes"
+#else
+#  define FREEBITMAP "no"
+#endif
+
+#define NSECTORS    CONFIG_EXAMPLES_FATBENCH_NSECTORS
+#define NRECORDS    CONFIG_EXAMPLES_FATBENCH_NRECORDS
+#define RECSIZE     CONFIG_EXAMPLES_FATBENCH_RECSIZE
+#define SECTORSIZE  512
+#define DEVSIZE     (NSECTORS * SECTORSIZE)
+
+/* The free space is fragmented by writing NFRAGFILES files one cluster at a
+ * time in turn, then deleting every other file.
+ */
+
+#define NFRAGFILES  16
+
+/* Two files of STREAMSIZE bytes are written in turn with STREAMCHUNK byte
+ * writes.
+ */
+
+#define STREAMSIZE  (DEVSIZE / 16)
+#define STREAMCHUNK 4096
+
+#define BLOCKDEV    "/dev/fatbench"
+#define MOUNTPT     "/mnt/fatbench"
+#define LOGFILE     MOUNTPT "/log.txt"
+#define FILLFILE    MOUNTPT "/fill.dat"
+#define STREAMFILE  MOUNTPT "/stream%d.dat"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct fatbench_dev_s
+{
+  unsigned int nreads;    /* Number of read() calls */
+  unsigned int nwrites;   /* Number of write() calls */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int     fatbench_open(FAR struct inode *inode);
+static int     fatbench_close(FAR struct inode *inode);
+static ssize_t fatbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors);
+static ssize_t fatbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     fatbench_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  fatbench_open,     /* open     */
+  fatbench_close,    /* close    */
+  fatbench_read,     /* read     */
+  fatbench_write,    /* write    */
+  fatbench_geometry, /* geometry */
+  NULL               /* ioctl    */
+};
+
+static struct fatbench_dev_s g_dev;
+static uint8_t g_storage[DEVSIZE];
+static uint8_t g_buffer[STREAMCHUNK];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Block driver methods for the counting RAM disk */
+
+static int fatbench_open(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static int fatbench_close(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static ssize_t fatbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors)
+{
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(buffer, &g_storage[start_sector * SECTORSIZE],
+         nsectors * SECTORSIZE);
+  g_dev.nreads++;
+  return nsectors;
+}
+
+static ssize_t fatbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(&g_storage[start_sector * SECTORSIZE], buffer,
+         nsectors * SECTORSIZE);
+  g_dev.nwrites++;
+  return nsectors;
+}
+
+static int fatbench_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  memset(geometry, 0, sizeof(struct geometry));
+  geometry->geo_available    = true;
+  geometry->geo_writeenabled = true;
+  geometry->geo_nsectors     = NSECTORS;
+  geometry->geo_sectorsize   = SECTORSIZE;
+  return OK;
+}
+
+/* Microsecond time stamps.  On the simulator, use the host's clock so that
+ * the result does not depend on the simulated timer.
+ */
+
+static uint32_t fatbench_usec(void)
+{
+#ifdef CONFIG_ARCH_SIM
+  return (uint32_t)(up_hostnsec() / 1000);
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* Measurement helpers */
+
+static uint32_t fatbench_start(void)
+{
+  g_dev.nreads  = 0;
+  g_dev.nwrites = 0;
+  return fatbench_usec();
+}
+
+static void fatbench_report(FAR const char *what, uint32_t start)
+{
+  printf("  %-20s %9lu %8u %8u\n", what,
+         (unsigned long)(fatbench_usec() - start),
+         g_dev.nreads, g_dev.nwrites);
+}
+
+/* The content of log record n */
+
+static void fatbench_record(FAR char *record, int n)
+{
+  memset(record, 'a' + n % 26, RECSIZE);
+  snprintf(record, RECSIZE, "%08d", n);
+  record[8] = ' ';
+  record[RECSIZE - 1] = '\n';
+}
+
+static int fatbench_mount(void)
+{
+  if (mount(BLOCKDEV, MOUNTPT, "vfat", 0, NULL) < 0)
+    {
+      printf("fatbench: mount failed: %d\n", errno);
+      return -1;
+    }
+
+  return 0;
+}
+
+/* Fill part of the volume with one file, then fragment the free space that
+ * follows it.  The surviving fragment files are later read back.
+ */
+
+static int fatbench_fragment(size_t clustsize, off_t fillsize)
+{
+  char path[32];
+  off_t offset;
+  int fds[NFRAGFILES];
+  int round;
+  int fd;
+  int i;
+
+  fd = open(FILLFILE, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", FILLFILE, errno);
+      return -1;
+    }
+
+  memset(g_buffer, 0xa5, sizeof(g_buffer));
+  for (offset = 0; offset < fillsize; offset += sizeof(g_buffer))
+    {
+      if (write(fd, g_buffer, sizeof(g_buffer)) != sizeof(g_buffer))
+        {
+          printf("fatbench: write %s failed: %d\n", FILLFILE, errno);
+          close(fd);
+          return -1;
+        }
+    }
+
+  close(fd);
+
+  for (i = 0; i < NFRAGFILES; i++)
+    {
+      snprintf(path, sizeof(path), MOUNTPT "/frag%02d", i);
+      fds[i] = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fds[i] < 0)
+        {
+          printf("fatbench: open %s failed: %d\n", path, errno);
+          while (--i >= 0)
+            {
+              close(fds[i]);
+            }
+
+          return -1;
+        }
+    }
+
+  for (round = 0; round < 32; round++)
+    {
+      for (i = 0; i < NFRAGFILES; i++)
+        {
+          memset(g_buffer, i, clustsize);
+          (void)write(fds[i], g_buffer, clustsize);
+        }
+    }
+
+  for (i = 0; i < NFRAGFILES; i++)
+    {
+      close(fds[i]);
+      if ((i & 1) == 0)
+        {
+          snprintf(path, sizeof(path), MOUNTPT "/frag%02d", i);
+          (void)unlink(path);
+        }
+    }
+
+  return 0;
+}
+
+/* Append the log records, synchronizing every SYNCINTERVAL records */
+
+static int fatbench_log(void)
+{
+  char record[RECSIZE];
+  int fd;
+  int n;
+
+  fd = open(LOGFILE, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", LOGFILE, errno);
+      return -1;
+    }
+
+  for (n = 0; n < NRECORDS; n++)
+    {
+      fatbench_record(record, n);
+      if (write(fd, record, RECSIZE) != RECSIZE)
+        {
+          printf("fatbench: log write %d failed: %d\n", n, errno);
+          close(fd);
+          return -1;
+        }
+
+      if ((n + 1) % CONFIG_EXAMPLES_FATBENCH_SYNCINTERVAL == 0)
+        {
+          (void)fsync(fd);
+        }
+    }
+
+  close(fd);
+  return 0;
+}
+
+/* Write two files in turn with large writes.  The first file reserves its
+ * space in advance if FIOC_RESERVE is supported.
+ */
+
+static int fatbench_stream(void)
+{
+  char path[32];
+  off_t offset;
+  int fds[2];
+  int i;
+
+  for (i = 0; i < 2; i++)
+    {
+      snprintf(path, sizeof(path), STREAMFILE, i);
+      fds[i] = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fds[i] < 0)
+        {
+          printf("fatbench: open %s failed: %d\n", path, errno);
+          if (i > 0)
+            {
+              close(fds[0]);
+            }
+
+          return -1;
+        }
+    }
+
+#ifdef FIOC_RESERVE
+  (void)ioctl(fds[0], FIOC_RESERVE, (unsigned long)STREAMSIZE);
+#endif
+
+  for (offset = 0; offset < STREAMSIZE; offset += STREAMCHUNK)
+    {
+      for (i = 0; i < 2; i++)
+        {
+          memset(g_buffer, (uint8_t)(offset / STREAMCHUNK + i), STREAMCHUNK);
+          if (write(fds[i], g_buffer, STREAMCHUNK) != STREAMCHUNK)
+            {
+              printf("fatbench: stream write failed: %d\n", errno);
+              close(fds[0]);
+              close(fds[1]);
+              return -1;
+            }
+        }
+    }
+
+  close(fds[0]);
+  close(fds[1]);
+  return 0;
+}
+
+/* Verify the log file, the surviving fragment files and the streams */
+
+static int fatbench_verify(size_t clustsize)
+{
+  char expected[RECSIZE];
+  char record[RECSIZE];
+  char path[32];
+  int errors = 0;
+  int fd;
+  int n;
+  int i;
+
+  fd = open(LOGFILE, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("fatbench: open %s failed: %d\n", LOGFILE, errno);
+      return -1;
+    }
+
+  for (n = 0; n < NRECORDS; n++)
+    {
+      fatbench_record(expected, n);
+      if (read(fd, record, RECSIZE) != RECSIZE ||
+          memcmp(record, expected, RECSIZE) != 0)
+        {
+          errors++;
+        }
+    }
+
+  close(fd);
+
+  for (i = 1; i < NFRAGFILES; i += 2)
+    {
+      snprintf(path, sizeof(path), MOUNTPT "/frag%02d", i);
+      fd = open(path, O_RDONLY);
+      if (fd < 0)
+        {
+          errors++;
+          continue;
+        }
+
+      for (n = 0; n < 32; n++)
+        {
+          memset(expected, i, RECSIZE);
+          if (read(fd, g_buffer, clustsize) != clustsize ||
+              memcmp(g_buffer, expected, RECSIZE) != 0)
+            {
+              errors++;
+            }
+        }
+
+      close(fd);
+    }
+
+  for (i = 0; i < 2; i++)
+    {
+      snprintf(path, sizeof(path), STREAMFILE, i);
+      fd = open(path, O_RDONLY);
+      if (fd < 0)
+        {
+          errors++;
+          continue;
+        }
+
+      for (n = 0; n < STREAMSIZE / STREAMCHUNK; n++)
+        {
+          memset(expected, (uint8_t)(n + i), RECSIZE);
+          if (read(fd, g_buffer, STREAMCHUNK) != STREAMCHUNK ||
+              memcmp(&g_buffer[STREAMCHUNK - RECSIZE], expected, RECSIZE) != 0)
+            {
+              errors++;
+            }
+        }
+
+      close(fd);
+    }
+
+  if (errors > 0)
+    {
+      printf("fatbench: ERROR: %d records or clusters miscompared\n", errors);
+      return -1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * fatbench_main
+ ****************************************************************************/
+
+int fatbench_main(int argc, char *argv[])
+{
+  struct fat_format_s fmt = FAT_FORMAT_INITIALIZER;
+  struct statfs buf;
+  uint32_t elapsed;
+  uint32_t start;
+  size_t clustsize;
+  int ret = EXIT_FAILURE;
+
+  if (register_blockdriver(BLOCKDEV, &g_bops, 0, &g_dev) < 0)
+    {
+      printf("fatbench: register_blockdriver failed\n");
+      return EXIT_FAILURE;
+    }
+
+  /* Format the volume with one sector per cluster */
+
+  fmt.ff_clustshift = 0;
+  if (mkfatfs(BLOCKDEV, &fmt) < 0)
+    {
+      printf("fatbench: mkfatfs failed: %d\n", errno);
+      goto errout_with_blockdev;
+    }
+
+  if (fatbench_mount() < 0)
+    {
+      goto errout_with_blockdev;
+    }
+
+  if (statfs(MOUNTPT, &buf) < 0)
+    {
+      printf("fatbench: statfs failed: %d\n", errno);
+      goto errout_with_mount;
+    }
+
+  clustsize = buf.f_bsize;
+  printf("\nFAT benchmark: %d KiB volume, %lu clusters of %lu bytes\n",
+         DEVSIZE / 1024, (unsigned long)buf.f_blocks,
+         (unsigned long)clustsize);
+  printf("  %d cached sectors, free cluster bitmap: %s\n",
+         CONFIG_FAT_CACHESECTORS, FREEBITMAP);
+  printf("  %-20s %9s %8s %8s\n", "", "usec", "reads", "writes");
+
+  /* Use half of the volume, then fragment the space after it */
+
+  start = fatbench_start();
+  if (fatbench_fragment(clustsize, (off_t)(DEVSIZE / 2)) < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  fatbench_report("fill and fragment", start);
+
+  /* Re-mount so that nothing is remembered, then append to the log */
+
+  (void)umount(MOUNTPT);
+  if (fatbench_mount() < 0)
+    {
+      goto errout_with_blockdev;
+    }
+
+  start = fatbench_start();
+  if (fatbench_log() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  fatbench_report("append log", start);
+
+  start = fatbench_start();
+  if (fatbench_stream() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  elapsed = fatbench_usec() - start;
+  fatbench_report("stream 2 files", start);
+  printf("  %-20s %9lu KiB/s\n", "",
+         (unsigned long)((uint64_t)2 * STREAMSIZE * 1000000 / 1024 /
+                         (elapsed ? elapsed : 1)));
+
+  /* Re-mount and measure the first and the second statfs() */
+
+  (void)umount(MOUNTPT);
+  if (fatbench_mount() < 0)
+    {
+      goto errout_with_blockdev;
+    }
+
+  start = fatbench_start();
+  if (statfs(MOUNTPT, &buf) < 0)
+    {
+      printf("fatbench: statfs failed: %d\n", errno);
+      goto errout_with_mount;
+    }
+
+  fatbench_report("first statfs", start);
+
+  start = fatbench_start();
+  (void)statfs(MOUNTPT, &buf);
+  fatbench_report("second statfs", start);
+  printf("  %lu clusters free\n", (unsigned long)buf.f_bfree);
+
+  /* Check that everything written can be read back */
+
+  if (fatbench_verify(clustsize) < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  printf("  verified\n");
+  ret = EXIT_SUCCESS;
+
+errout_with_mount:
+  (void)umount(MOUNTPT);
+errout_with_blockdev:
+  (void)unregister_blockdriver(BLOCKDEV);
+  return ret;
+}
@@ -0,0 +1,504 @@
+/****************************************************************************
+ * examples/ftlbench/ftlbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/mount.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/mtd.h>
+#include <nuttx/fs/mkfatfs.h>
+
+#ifdef CONFIG_ARCH_SIM
+#  include <arch/arch.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* This must exactly match the default configuration in drivers/mtd/rammtd.c */
+
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#  define CONFIG_RAMMTD_ERASESIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_NEBLOCKS
+#  define CONFIG_EXAMPLES_FTLBENCH_NEBLOCKS 128
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_NFILES
+#  define CONFIG_EXAMPLES_FTLBENCH_NFILES 16
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_FILESIZE
+#  define CONFIG_EXAMPLES_FTLBENCH_FILESIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_NRECORDS
+#  define CONFIG_EXAMPLES_FTLBENCH_NRECORDS 1024
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_RECSIZE
+#  define CONFIG_EXAMPLES_FTLBENCH_RECSIZE 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_SYNCINTERVAL
+#  define CONFIG_EXAMPLES_FTLBENCH_SYNCINTERVAL 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_FTLBENCH_MINOR
+#  define CONFIG_EXAMPLES_FTLBENCH_MINOR 1
+#endif
+
+#ifdef CONFIG_FTL_WRITEBACK
+#  ifndef CONFIG_FTL_WRITEBACK_NBLOCKS
+#    define CONFIG_FTL_WRITEBACK_NBLOCKS 1
+#  endif
+#  define WBBLOCKS CONFIG_FTL_WRITEBACK_NBLOCKS
+#else
+#  define WBBLOCKS 0
+#endif
+
+#define NEBLOCKS    CONFIG_EXAMPLES_FTLBENCH_NEBLOCKS
+#define FLASHSIZE   (CONFIG_RAMMTD_ERASESIZE * NEBLOCKS)
+#define NFILES      CONFIG_EXAMPLES_FTLBENCH_NFILES
+#define FILESIZE    CONFIG_EXAMPLES_FTLBENCH_FILESIZE
+#define NRECORDS    CONFIG_EXAMPLES_FTLBENCH_NRECORDS
+#define RECSIZE     CONFIG_EXAMPLES_FTLBENCH_RECSIZE
+#define NFILERECS   ((FILESIZE + RECSIZE - 1) / RECSIZE)
+
+#define MINOR       CONFIG_EXAMPLES_FTLBENCH_MINOR
+#define DEVFORMAT   "/dev/mtdblock%d"
+#define MOUNTPT     "/mnt/ftlbench"
+#define FILEFORMAT  MOUNTPT "/file%02d.dat"
+#define LOGFILE     MOUNTPT "/log.txt"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The benchmark MTD sits between the FTL and the RAM MTD driver and counts
+ * the operations that the FTL performs on the FLASH.
+ */
+
+struct ftlbench_mtd_s
+{
+  struct mtd_dev_s mtd;          /* Our MTD interface (must be first) */
+  FAR struct mtd_dev_s *lower;   /* The RAM MTD driver */
+  uint32_t nreads;               /* Number of read and bread calls */
+  uint32_t nwrites;              /* Number of write and bwrite calls */
+  uint32_t nerases;              /* Number of erase blocks erased */
+  uint32_t maxerase;             /* Most erases of any one erase block */
+  uint32_t erasecount[NEBLOCKS]; /* Number of erases per erase block */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_simflash[FLASHSIZE];
+static struct ftlbench_mtd_s g_benchmtd;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Microsecond time stamps.  On the simulator, use the host's clock so that
+ * the result does not depend on the simulated timer.
+ */
+
+static uint32_t ftlbench_usec(void)
+{
+#ifdef CONFIG_ARCH_SIM
+  return (uint32_t)(up_hostnsec() / 1000);
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* The counting MTD methods */
+
+static int ftlbench_erase(FAR struct mtd_dev_s *dev, off_t startblock,
+                          size_t nblocks)
+{
+  FAR struct ftlbench_mtd_s *priv = (FAR struct ftlbench_mtd_s *)dev;
+  size_t i;
+
+  for (i = 0; i < nblocks && startblock + i < NEBLOCKS; i++)
+    {
+      if (++priv->erasecount[startblock + i] > priv->maxerase)
+        {
+          priv->maxerase = priv->erasecount[startblock + i];
+        }
+    }
+
+  priv->nerases += nblocks;
+  return MTD_ERASE(priv->lower, startblock, nblocks);
+}
+
+static ssize_t ftlbench_bread(FAR struct mtd_dev_s *dev, off_t startblock,
+                              size_t nblocks, FAR uint8_t *buffer)
+{
+  FAR struct ftlbench_mtd_s *priv = (FAR struct ftlbench_mtd_s *)dev;
+
+  priv->nreads++;
+  return MTD_BREAD(priv->lower, startblock, nblocks, buffer);
+}
+
+static ssize_t ftlbench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
+                               size_t nblocks, FAR const uint8_t *buffer)
+{
+  FAR struct ftlbench_mtd_s *priv = (FAR struct ftlbench_mtd_s *)dev;
+
+  priv->nwrites++;
+  return MTD_BWRITE(priv->lower, startblock, nblocks, buffer);
+}
+
+static ssize_t ftlbench_read(FAR struct mtd_dev_s *dev, off_t offset,
+                             size_t nbytes, FAR uint8_t *buffer)
+{
+  FAR struct ftlbench_mtd_s *priv = (FAR struct ftlbench_mtd_s *)dev;
+
+  priv->nreads++;
+  return MTD_READ(priv->lower, offset, nbytes, buffer);
+}
+
+static int ftlbench_ioctl(FAR struct mtd_dev_s *dev, int cmd,
+                          unsigned long arg)
+{
+  FAR struct ftlbench_mtd_s *priv = (FAR struct ftlbench_mtd_s *)dev;
+
+  return MTD_IOCTL(priv->lower, cmd, arg);
+}
+
+/* Measurement helpers */
+
+static uint32_t ftlbench_start(void)
+{
+  g_benchmtd.nreads   = 0;
+  g_benchmtd.nwrites  = 0;
+  g_benchmtd.nerases  = 0;
+  g_benchmtd.maxerase = 0;
+  memset(g_benchmtd.erasecount, 0, sizeof(g_benchmtd.erasecount));
+  return ftlbench_usec();
+}
+
+static void ftlbench_report(FAR const char *what, uint32_t start,
+                            uint32_t nbytes)
+{
+  uint32_t elapsed = ftlbench_usec() - start;
+
+  printf("  %-16s %9lu %7lu %7lu %7lu %7lu %7lu\n", what,
+         (unsigned long)elapsed,
+         (unsigned long)(elapsed > 0 ?
+                         (uint64_t)nbytes * 1000000 / 1024 / elapsed : 0),
+         (unsigned long)g_benchmtd.nreads,
+         (unsigned long)g_benchmtd.nwrites,
+         (unsigned long)g_benchmtd.nerases,
+         (unsigned long)g_benchmtd.maxerase);
+}
+
+/* The content of record n of file f (the log is file NFILES) */
+
+static void ftlbench_record(FAR char *record, int f, int n)
+{
+  memset(record, 'a' + (f + n) % 26, RECSIZE);
+  snprintf(record, RECSIZE, "%02d:%06d", f, n);
+  record[9] = ' ';
+  record[RECSIZE - 1] = '\n';
+}
+
+static int ftlbench_mount(FAR const char *devname)
+{
+  if (mount(devname, MOUNTPT, "vfat", 0, NULL) < 0)
+    {
+      printf("ftlbench: mount failed: %d\n", errno);
+      return -1;
+    }
+
+  return 0;
+}
+
+/* Create the files, each with small writes */
+
+static int ftlbench_files(void)
+{
+  char record[RECSIZE];
+  char path[32];
+  int fd;
+  int f;
+  int n;
+
+  for (f = 0; f < NFILES; f++)
+    {
+      snprintf(path, sizeof(path), FILEFORMAT, f);
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("ftlbench: open %s failed: %d\n", path, errno);
+          return -1;
+        }
+
+      for (n = 0; n < NFILERECS; n++)
+        {
+          ftlbench_record(record, f, n);
+          if (write(fd, record, RECSIZE) != RECSIZE)
+            {
+              printf("ftlbench: write %s failed: %d\n", path, errno);
+              close(fd);
+              return -1;
+            }
+        }
+
+      close(fd);
+    }
+
+  return 0;
+}
+
+/* Append the log records, synchronizing every SYNCINTERVAL records */
+
+static int ftlbench_log(void)
+{
+  char record[RECSIZE];
+  int fd;
+  int n;
+
+  fd = open(LOGFILE, O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      printf("ftlbench: open %s failed: %d\n", LOGFILE, errno);
+      return -1;
+    }
+
+  for (n = 0; n < NRECORDS; n++)
+    {
+      ftlbench_record(record, NFILES, n);
+      if (write(fd, record, RECSIZE) != RECSIZE)
+        {
+          printf("ftlbench: log write %d failed: %d\n", n, errno);
+          close(fd);
+          return -1;
+        }
+
+      if ((n + 1) % CONFIG_EXAMPLES_FTLBENCH_SYNCINTERVAL == 0)
+        {
+          (void)fsync(fd);
+        }
+    }
+
+  close(fd);
+  return 0;
+}
+
+/* Read back and verify one file */
+
+static int ftlbench_verifyfile(FAR const char *path, int f, int nrecords)
+{
+  char expected[RECSIZE];
+  char record[RECSIZE];
+  int errors = 0;
+  int fd;
+  int n;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("ftlbench: open %s failed: %d\n", path, errno);
+      return 1;
+    }
+
+  for (n = 0; n < nrecords; n++)
+    {
+      ftlbench_record(expected, f, n);
+      if (read(fd, record, RECSIZE) != RECSIZE ||
+          memcmp(record, expected, RECSIZE) != 0)
+        {
+          errors++;
+        }
+    }
+
+  close(fd);
+  return errors;
+}
+
+static int ftlbench_verify(void)
+{
+  char path[32];
+  int errors;
+  int f;
+
+  errors = ftlbench_verifyfile(LOGFILE, NFILES, NRECORDS);
+  for (f = 0; f < NFILES; f++)
+    {
+      snprintf(path, sizeof(path), FILEFORMAT, f);
+      errors += ftlbench_verifyfile(path, f, NFILERECS);
+    }
+
+  if (errors > 0)
+    {
+      printf("ftlbench: ERROR: %d records miscompared\n", errors);
+      return -1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * ftlbench_main
+ ****************************************************************************/
+
+int ftlbench_main(int argc, char *argv[])
+{
+  struct fat_format_s fmt = FAT_FORMAT_INITIALIZER;
+  char devname[16];
+  uint32_t start;
+  int ret;
+
+  printf("\nFTL benchmark: %d erase blocks of %d bytes, "
+         "%d cached erase blocks\n",
+         NEBLOCKS, CONFIG_RAMMTD_ERASESIZE, WBBLOCKS);
+
+  /* Create the RAM MTD device and put the counting MTD on top of it */
+
+  g_benchmtd.lower = rammtd_initialize(g_simflash, FLASHSIZE);
+  if (!g_benchmtd.lower)
+    {
+      printf("ftlbench: Failed to create the RAM MTD device\n");
+      return EXIT_FAILURE;
+    }
+
+  g_benchmtd.mtd.erase  = ftlbench_erase;
+  g_benchmtd.mtd.bread  = ftlbench_bread;
+  g_benchmtd.mtd.bwrite = ftlbench_bwrite;
+  g_benchmtd.mtd.read   = ftlbench_read;
+  g_benchmtd.mtd.ioctl  = ftlbench_ioctl;
+
+  /* Provide the FTL block driver on the MTD device, format it and mount
+   * it.
+   */
+
+  ret = ftl_initialize(MINOR, &g_benchmtd.mtd);
+  if (ret < 0)
+    {
+      printf("ftlbench: ftl_initialize failed: %d\n", ret);
+      return EXIT_FAILURE;
+    }
+
+  snprintf(devname, sizeof(devname), DEVFORMAT, MINOR);
+
+  start = ftlbench_start();
+  if (mkfatfs(devname, &fmt) < 0)
+    {
+      printf("ftlbench: mkfatfs failed: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  printf("  %-16s %9s %7s %7s %7s %7s %7s\n",
+         "", "usec", "KiB/s", "reads", "writes", "erases", "max");
+  ftlbench_report("mkfatfs", start, 0);
+
+  if (ftlbench_mount(devname) < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  /* Create the files, then append to the log */
+
+  start = ftlbench_start();
+  if (ftlbench_files() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  ftlbench_report("create files", start, NFILES * NFILERECS * RECSIZE);
+
+  start = ftlbench_start();
+  if (ftlbench_log() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  ftlbench_report("append log", start, NRECORDS * RECSIZE);
+
+  /* Un-mounting writes back anything that is still cached */
+
+  start = ftlbench_start();
+  (void)umount(MOUNTPT);
+  ftlbench_report("umount", start, 0);
+
+  /* Re-mount and verify what is on the FLASH */
+
+  if (ftlbench_mount(devname) < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  ret = ftlbench_verify();
+  (void)umount(MOUNTPT);
+
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  printf("ftlbench: Verified %d files and %d log records\n",
+         NFILES, NRECORDS);
+  return EXIT_SUCCESS;
+
+errout_with_mount:
+  (void)umount(MOUNTPT);
+  return EXIT_FAILURE;
+}
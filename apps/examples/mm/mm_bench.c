@@ -0,0 +1,246 @@
+/****************************************************************************
+ * examples/mm/mm_bench.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apps/benchtime.h>
+
+#include "mm_bench.h"
+
+#ifdef CONFIG_EXAMPLES_MM_BENCH
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_NSLOTS
+#  define CONFIG_EXAMPLES_MM_BENCH_NSLOTS 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_NOPS
+#  define CONFIG_EXAMPLES_MM_BENCH_NOPS 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_MM_BENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_MM_BENCH_MAXSIZE 2048
+#endif
+
+#define NSLOTS  CONFIG_EXAMPLES_MM_BENCH_NSLOTS
+#define NOPS    CONFIG_EXAMPLES_MM_BENCH_NOPS
+#define MAXSIZE CONFIG_EXAMPLES_MM_BENCH_MAXSIZE
+
+#ifdef CONFIG_MM_TLSF
+#  define ENGINE_NAME "TLSF"
+#else
+#  define ENGINE_NAME "sorted free list"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR void *g_slots[NSLOTS];
+static uint32_t  g_malloc_time[NOPS];
+static uint32_t  g_free_time[NOPS];
+static uint32_t  g_seed;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* A private pseudo-random number generator so that both heap engines see
+ * exactly the same sequence of requests.
+ */
+
+static uint32_t bench_random(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+/* Mostly small requests with an occasional large one */
+
+static size_t bench_size(void)
+{
+  uint32_t value = bench_random();
+
+  if ((value & 3) != 0)
+    {
+      return (value >> 2) % 128 + 1;
+    }
+
+  return (value >> 2) % MAXSIZE + 1;
+}
+
+static int bench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t va = *(FAR const uint32_t *)a;
+  uint32_t vb = *(FAR const uint32_t *)b;
+
+  return va < vb ? -1 : (va > vb ? 1 : 0);
+}
+
+static void bench_report(FAR const char *name, FAR uint32_t *samples, int n)
+{
+  uint64_t total = 0;
+  int i;
+
+  if (n <= 0)
+    {
+      printf("  %-6s: no samples\n", name);
+      return;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      total += samples[i];
+    }
+
+  qsort(samples, n, sizeof(uint32_t), bench_compare);
+
+  printf("  %-6s: %5d ops  mean %6lu  p99 %6lu  max %6lu %s\n",
+         name, n, (unsigned long)(total / n),
+         (unsigned long)samples[(n * 99) / 100],
+         (unsigned long)samples[n - 1], BENCHTIME_UNITS);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_benchmark
+ *
+ * Description:
+ *   Fragment the heap with a mix of small and large allocations, then time
+ *   each of NOPS randomly interleaved malloc() and free() calls and report
+ *   the mean, 99th percentile, and worst-case times of each.
+ *
+ ****************************************************************************/
+
+void mm_benchmark(void)
+{
+  struct mallinfo info;
+  uint32_t start;
+  uint32_t elapsed;
+  int nmallocs = 0;
+  int nfrees   = 0;
+  int nfailed  = 0;
+  int i;
+
+  printf("\nHeap latency benchmark (%s):\n", ENGINE_NAME);
+
+  benchtime_initialize();
+
+  /* Fill every slot, then free every other one to fragment the heap */
+
+  g_seed = 1;
+  for (i = 0; i < NSLOTS; i++)
+    {
+      g_slots[i] = malloc(bench_size());
+    }
+
+  for (i = 0; i < NSLOTS; i += 2)
+    {
+      free(g_slots[i]);
+      g_slots[i] = NULL;
+    }
+
+  info = mallinfo();
+  printf("  Fragmented: %d free chunks, %lu bytes free, largest %lu\n",
+         info.ordblks, (unsigned long)info.fordblks,
+         (unsigned long)info.mxordblk);
+
+  /* Now time a random mix of allocations and frees */
+
+  for (i = 0; i < NOPS; i++)
+    {
+      int slot = bench_random() % NSLOTS;
+
+      if (g_slots[slot])
+        {
+          start = benchtime_now();
+          free(g_slots[slot]);
+          elapsed = benchtime_now() - start;
+
+          g_slots[slot] = NULL;
+          g_free_time[nfrees++] = elapsed;
+        }
+      else
+        {
+          size_t size = bench_size();
+
+          start = benchtime_now();
+          g_slots[slot] = malloc(size);
+          elapsed = benchtime_now() - start;
+
+          if (g_slots[slot])
+            {
+              g_malloc_time[nmallocs++] = elapsed;
+            }
+          else
+            {
+              nfailed++;
+            }
+        }
+    }
+
+  /* Clean up */
+
+  for (i = 0; i < NSLOTS; i++)
+    {
+      free(g_slots[i]);
+      g_slots[i] = NULL;
+    }
+
+  bench_report("malloc", g_malloc_time, nmallocs);
+  bench_report("free", g_free_time, nfrees);
+
+  if (nfailed > 0)
+    {
+      printf("  %d allocations failed\n", nfailed);
+    }
+}
+
+#endif /* CONFIG_EXAMPLES_MM_BENCH */
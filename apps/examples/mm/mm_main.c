@@ -41,6 +41,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "mm_bench.h"
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -295,6 +297,12 @@ int mm_main(int argc, char *argv[])
 
   do_frees(allocs, alloc_sizes, random1, NTEST_ALLOCS);
 
+#ifdef CONFIG_EXAMPLES_MM_BENCH
+  /* Measure malloc/free latencies on a fragmented heap */
+
+  mm_benchmark();
+#endif
+
   printf("TEST COMPLETE\n");
   return 0;
 }
@@ -0,0 +1,389 @@
+/****************************************************************************
+ * examples/mqbench/mqbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <mqueue.h>
+#include <errno.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_MAXMSGSIZE
+#  define CONFIG_EXAMPLES_MQBENCH_MAXMSGSIZE 1024
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_NMSGS
+#  define CONFIG_EXAMPLES_MQBENCH_NMSGS 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_MQBENCH_NLOOPS 1000
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_CLOCKMHZ
+#  define CONFIG_EXAMPLES_MQBENCH_CLOCKMHZ 0
+#endif
+
+#ifndef CONFIG_EXAMPLES_MQBENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_MQBENCH_STACKSIZE 2048
+#endif
+
+#define MAXMSGSIZE    CONFIG_EXAMPLES_MQBENCH_MAXMSGSIZE
+#define NMSGS         CONFIG_EXAMPLES_MQBENCH_NMSGS
+#define NLOOPS        CONFIG_EXAMPLES_MQBENCH_NLOOPS
+#define STACKSIZE     CONFIG_EXAMPLES_MQBENCH_STACKSIZE
+#define MQNAME        "/mqbench"
+
+/* Rates are per second when the time stamps are in microseconds or the
+ * cycle counter frequency is known.
+ */
+
+#if defined(BENCHTIME_CYCLES) && CONFIG_EXAMPLES_MQBENCH_CLOCKMHZ == 0
+#  define RATE_UNITS "Mcycles"
+#else
+#  define RATE_UNITS "second"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_readysem;           /* Posted when the receiver is ready */
+static sem_t g_donesem;            /* Posted when the receiver is done */
+
+static size_t g_msgsize;           /* Size of the messages being sent */
+static bool g_zerocopy;            /* Use the zero-copy interfaces */
+static volatile uint32_t g_endtime;  /* Time stamp after the last message */
+static int g_nerrors;              /* Messages received out of order */
+
+static uint8_t g_txbuffer[MAXMSGSIZE];
+static uint8_t g_rxbuffer[MAXMSGSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Fill in message 'seq' as the sender and check it as the receiver.  The
+ * message holds its sequence number followed by the low byte of the
+ * sequence number in every remaining byte.
+ */
+
+static void mqbench_fill(FAR uint8_t *buffer, uint32_t seq)
+{
+  memcpy(buffer, &seq, sizeof(uint32_t));
+  memset(buffer + sizeof(uint32_t), (uint8_t)seq,
+         g_msgsize - sizeof(uint32_t));
+}
+
+static void mqbench_check(FAR const uint8_t *buffer, ssize_t nbytes,
+                          uint32_t seq)
+{
+  uint32_t rxseq;
+
+  memcpy(&rxseq, buffer, sizeof(uint32_t));
+  if (nbytes != g_msgsize || rxseq != seq ||
+      buffer[nbytes - 1] != (uint8_t)seq)
+    {
+      g_nerrors++;
+    }
+}
+
+/* The receiving task */
+
+static int mqbench_receiver(int argc, char *argv[])
+{
+  FAR void *buffer;
+  ssize_t nbytes;
+  mqd_t mqd;
+  uint32_t seq;
+
+  mqd = mq_open(MQNAME, O_RDONLY);
+  if (mqd == (mqd_t)-1)
+    {
+      printf("mqbench: receiver mq_open failed: %d\n", errno);
+      g_nerrors = NLOOPS;
+      sem_post(&g_readysem);
+      sem_post(&g_donesem);
+      return EXIT_FAILURE;
+    }
+
+  sem_post(&g_readysem);
+
+  for (seq = 0; seq < NLOOPS; seq++)
+    {
+      if (g_zerocopy)
+        {
+          do
+            {
+              nbytes = mq_receivebuffer(mqd, &buffer, NULL);
+            }
+          while (nbytes < 0 && errno == EINTR);
+
+          if (nbytes < 0)
+            {
+              g_nerrors++;
+              break;
+            }
+
+          mqbench_check((FAR const uint8_t *)buffer, nbytes, seq);
+          mq_releasebuffer(mqd, buffer);
+        }
+      else
+        {
+          do
+            {
+              nbytes = mq_receive(mqd, g_rxbuffer, MAXMSGSIZE, NULL);
+            }
+          while (nbytes < 0 && errno == EINTR);
+
+          if (nbytes < 0)
+            {
+              g_nerrors++;
+              break;
+            }
+
+          mqbench_check(g_rxbuffer, nbytes, seq);
+        }
+    }
+
+  g_endtime = benchtime_now();
+  mq_close(mqd);
+  sem_post(&g_donesem);
+  return EXIT_SUCCESS;
+}
+
+/****************************************************************************
+ * Name: mqbench_run
+ *
+ * Description:
+ *   Send NLOOPS messages of g_msgsize bytes to the receiving task and
+ *   return the time taken until the receiver has received the last one.
+ *
+ ****************************************************************************/
+
+static int mqbench_run(int priority, FAR uint32_t *elapsed)
+{
+  struct mq_attr attr;
+  FAR void *buffer;
+  uint32_t start;
+  uint32_t seq;
+  mqd_t mqd;
+  int ret = 0;
+
+  attr.mq_maxmsg  = NMSGS;
+  attr.mq_msgsize = g_msgsize;
+  attr.mq_flags   = g_zerocopy ? MQ_ZEROCOPY : 0;
+
+  mqd = mq_open(MQNAME, O_WRONLY|O_CREAT, 0666, &attr);
+  if (mqd == (mqd_t)-1)
+    {
+      printf("mqbench: mq_open failed: %d\n", errno);
+      return -1;
+    }
+
+  /* The receiver has the same priority so that the two tasks take turns
+   * when the message queue becomes full or empty.
+   */
+
+  g_nerrors = 0;
+  if (TASK_CREATE("mqreceiver", priority, STACKSIZE, mqbench_receiver,
+                  NULL) < 0)
+    {
+      printf("mqbench: Failed to create the receiver\n");
+      ret = -1;
+      goto errout;
+    }
+
+  while (sem_wait(&g_readysem) < 0);
+  if (g_nerrors > 0)
+    {
+      while (sem_wait(&g_donesem) < 0);
+      ret = -1;
+      goto errout;
+    }
+
+  start = benchtime_now();
+  for (seq = 0; seq < NLOOPS; seq++)
+    {
+      if (g_zerocopy)
+        {
+          buffer = mq_getbuffer(mqd);
+          if (!buffer)
+            {
+              printf("mqbench: mq_getbuffer failed: %d\n", errno);
+              ret = -1;
+              break;
+            }
+
+          mqbench_fill((FAR uint8_t *)buffer, seq);
+          if (mq_sendbuffer(mqd, buffer, g_msgsize, 0) < 0)
+            {
+              printf("mqbench: mq_sendbuffer failed: %d\n", errno);
+              mq_releasebuffer(mqd, buffer);
+              ret = -1;
+              break;
+            }
+        }
+      else
+        {
+          mqbench_fill(g_txbuffer, seq);
+          if (mq_send(mqd, g_txbuffer, g_msgsize, 0) < 0)
+            {
+              printf("mqbench: mq_send failed: %d\n", errno);
+              ret = -1;
+              break;
+            }
+        }
+    }
+
+  /* A failed sender leaves the receiver waiting; it is not recovered */
+
+  if (ret == 0)
+    {
+      while (sem_wait(&g_donesem) < 0);
+      *elapsed = g_endtime - start;
+      if (g_nerrors > 0)
+        {
+          printf("mqbench: %d bad messages\n", g_nerrors);
+          ret = -1;
+        }
+    }
+
+errout:
+  mq_close(mqd);
+  mq_unlink(MQNAME);
+  return ret;
+}
+
+/* Print the message and byte rates for one measurement */
+
+static void mqbench_rates(uint32_t elapsed)
+{
+  unsigned long msgrate;
+
+#if defined(BENCHTIME_CYCLES) && CONFIG_EXAMPLES_MQBENCH_CLOCKMHZ > 0
+  elapsed /= CONFIG_EXAMPLES_MQBENCH_CLOCKMHZ;
+#endif
+
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  msgrate = (unsigned long)NLOOPS * 1000000 / elapsed;
+  printf("  %10lu %12lu", msgrate, msgrate * (unsigned long)g_msgsize);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * mqbench_main
+ ****************************************************************************/
+
+int mqbench_main(int argc, char *argv[])
+{
+  struct sched_param param;
+  uint32_t copytime;
+  uint32_t zctime;
+  size_t msgsize;
+
+  benchtime_initialize();
+
+  sem_init(&g_readysem, 0, 0);
+  sem_init(&g_donesem, 0, 0);
+
+  (void)sched_getparam(0, &param);
+
+  printf("\nMessage queue benchmark, %d messages, queue depth %d, "
+         "rates per %s:\n", NLOOPS, NMSGS, RATE_UNITS);
+  printf("  %6s  %10s %12s  %10s %12s\n",
+         "size", "copy msgs", "copy bytes", "zc msgs", "zc bytes");
+
+  for (msgsize = 16; msgsize <= MAXMSGSIZE; msgsize <<= 2)
+    {
+      g_msgsize = msgsize;
+      printf("  %6lu", (unsigned long)msgsize);
+
+      /* Messages larger than CONFIG_MQ_MAXMSGSIZE only fit in a message
+       * queue with its own message pool.
+       */
+
+      if (msgsize <= CONFIG_MQ_MAXMSGSIZE)
+        {
+          g_zerocopy = false;
+          if (mqbench_run(param.sched_priority, &copytime) < 0)
+            {
+              break;
+            }
+
+          mqbench_rates(copytime);
+        }
+      else
+        {
+          printf("  %10s %12s", "-", "-");
+        }
+
+      g_zerocopy = true;
+      if (mqbench_run(param.sched_priority, &zctime) < 0)
+        {
+          break;
+        }
+
+      mqbench_rates(zctime);
+      printf("\n");
+    }
+
+  sem_destroy(&g_readysem);
+  sem_destroy(&g_donesem);
+  return EXIT_SUCCESS;
+}
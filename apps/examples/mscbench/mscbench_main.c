@@ -0,0 +1,896 @@
+/****************************************************************************
+ * examples/mscbench/mscbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/scsi.h>
+#include <nuttx/usb/usb.h>
+#include <nuttx/usb/usbdev.h>
+#include <nuttx/usb/storage.h>
+#include <nuttx/usb/usbmsc.h>
+
+#include <arch/arch.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MSCBENCH_NSECTORS
+#  define CONFIG_EXAMPLES_MSCBENCH_NSECTORS 1024
+#endif
+
+#ifndef CONFIG_EXAMPLES_MSCBENCH_XFRSECTORS
+#  define CONFIG_EXAMPLES_MSCBENCH_XFRSECTORS 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_MSCBENCH_NPASSES
+#  define CONFIG_EXAMPLES_MSCBENCH_NPASSES 8
+#endif
+
+#ifndef CONFIG_EXAMPLES_MSCBENCH_CALLDELAY
+#  define CONFIG_EXAMPLES_MSCBENCH_CALLDELAY 0
+#endif
+
+#ifndef CONFIG_USBMSC_EP0MAXPACKET
+#  define CONFIG_USBMSC_EP0MAXPACKET 64
+#endif
+
+#ifndef CONFIG_USBMSC_NRDREQS
+#  define CONFIG_USBMSC_NRDREQS 4
+#endif
+
+#ifndef CONFIG_USBMSC_IOSECTORS
+#  define CONFIG_USBMSC_IOSECTORS 1
+#endif
+
+#define SECTORSIZE  512
+#define NSECTORS    CONFIG_EXAMPLES_MSCBENCH_NSECTORS
+#define XFRSECTORS  CONFIG_EXAMPLES_MSCBENCH_XFRSECTORS
+#define XFRSIZE     (XFRSECTORS * SECTORSIZE)
+#define NPASSES     CONFIG_EXAMPLES_MSCBENCH_NPASSES
+#define CALLDELAY   CONFIG_EXAMPLES_MSCBENCH_CALLDELAY
+
+#if NSECTORS % XFRSECTORS != 0
+#  error "CONFIG_EXAMPLES_MSCBENCH_NSECTORS must be a multiple of CONFIG_EXAMPLES_MSCBENCH_XFRSECTORS"
+#endif
+
+#define BLOCKDEV    "/dev/mscbench"
+
+#ifndef MIN
+#  define MIN(a,b)  ((a) < (b) ? (a) : (b))
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The RAM disk exported as LUN 0 */
+
+struct mscbench_disk_s
+{
+  FAR uint8_t *storage;     /* The RAM backing the disk */
+  unsigned int nreads;      /* Number of read() calls */
+  unsigned int nwrites;     /* Number of write() calls */
+};
+
+/* The state of the simulated USB host */
+
+struct mscbench_host_s
+{
+  FAR struct usbdevclass_driver_s *driver; /* The bound class driver */
+
+  /* Bulk OUT requests submitted by the class driver and not yet filled */
+
+  FAR struct usbdev_req_s *outreqs[CONFIG_USBMSC_NRDREQS];
+  uint8_t outhead;          /* Index of the oldest request in outreqs[] */
+  uint8_t noutreqs;         /* Number of requests in outreqs[] */
+
+  /* Data still to be sent to the device:  first the CBW, then outlen bytes
+   * at outdata.
+   */
+
+  bool cbwpending;
+  uint8_t cbw[USBMSC_CBW_SIZEOF];
+  FAR const uint8_t *outdata;
+  size_t outlen;
+
+  /* Space for data still expected from the device, then the CSW */
+
+  FAR uint8_t *indata;
+  size_t inlen;
+  uint8_t csw[USBMSC_CSW_SIZEOF];
+
+  sem_t cswsem;             /* Posted when the CSW has been received */
+  sem_t ep0sem;             /* Posted when a control response has been sent */
+  uint32_t tag;             /* Tag of the last CBW */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* RAM disk */
+
+static int     mscbench_open(FAR struct inode *inode);
+static int     mscbench_close(FAR struct inode *inode);
+static ssize_t mscbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors);
+static ssize_t mscbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors);
+static int     mscbench_geometry(FAR struct inode *inode,
+                                 FAR struct geometry *geometry);
+
+/* Loopback USB device controller */
+
+static int     mscbench_epconfigure(FAR struct usbdev_ep_s *ep,
+                                    FAR const struct usb_epdesc_s *desc,
+                                    bool last);
+static int     mscbench_epdisable(FAR struct usbdev_ep_s *ep);
+static FAR struct usbdev_req_s *mscbench_epallocreq(FAR struct usbdev_ep_s *ep);
+static void    mscbench_epfreereq(FAR struct usbdev_ep_s *ep,
+                                  FAR struct usbdev_req_s *req);
+#ifdef CONFIG_USBDEV_DMA
+static FAR void *mscbench_epallocbuffer(FAR struct usbdev_ep_s *ep,
+                                        uint16_t nbytes);
+static void    mscbench_epfreebuffer(FAR struct usbdev_ep_s *ep,
+                                     FAR void *buf);
+#endif
+static int     mscbench_epsubmit(FAR struct usbdev_ep_s *ep,
+                                 FAR struct usbdev_req_s *req);
+static int     mscbench_epcancel(FAR struct usbdev_ep_s *ep,
+                                 FAR struct usbdev_req_s *req);
+static int     mscbench_epstall(FAR struct usbdev_ep_s *ep, bool resume);
+
+static FAR struct usbdev_ep_s *mscbench_allocep(FAR struct usbdev_s *dev,
+                                                uint8_t epphy, bool in,
+                                                uint8_t eptype);
+static void    mscbench_freeep(FAR struct usbdev_s *dev,
+                               FAR struct usbdev_ep_s *ep);
+static int     mscbench_getframe(FAR struct usbdev_s *dev);
+static int     mscbench_wakeup(FAR struct usbdev_s *dev);
+static int     mscbench_selfpowered(FAR struct usbdev_s *dev, bool selfpowered);
+static int     mscbench_pullup(FAR struct usbdev_s *dev, bool enable);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct block_operations g_bops =
+{
+  mscbench_open,     /* open     */
+  mscbench_close,    /* close    */
+  mscbench_read,     /* read     */
+  mscbench_write,    /* write    */
+  mscbench_geometry, /* geometry */
+  NULL               /* ioctl    */
+};
+
+static const struct usbdev_epops_s g_epops =
+{
+  mscbench_epconfigure,   /* configure */
+  mscbench_epdisable,     /* disable */
+  mscbench_epallocreq,    /* allocreq */
+  mscbench_epfreereq,     /* freereq */
+#ifdef CONFIG_USBDEV_DMA
+  mscbench_epallocbuffer, /* allocbuffer */
+  mscbench_epfreebuffer,  /* freebuffer */
+#endif
+  mscbench_epsubmit,      /* submit */
+  mscbench_epcancel,      /* cancel */
+  mscbench_epstall        /* stall */
+};
+
+static const struct usbdev_ops_s g_devops =
+{
+  mscbench_allocep,       /* allocep */
+  mscbench_freeep,        /* freeep */
+  mscbench_getframe,      /* getframe */
+  mscbench_wakeup,        /* wakeup */
+  mscbench_selfpowered,   /* selfpowered */
+  mscbench_pullup,        /* pullup */
+  NULL                    /* ioctl */
+};
+
+static struct usbdev_ep_s g_ep0 =
+{
+  &g_epops, 0, CONFIG_USBMSC_EP0MAXPACKET, NULL
+};
+
+static struct usbdev_ep_s g_epbulkin =
+{
+  &g_epops, 0, 64, NULL
+};
+
+static struct usbdev_ep_s g_epbulkout =
+{
+  &g_epops, 0, 64, NULL
+};
+
+static struct usbdev_s g_usbdev =
+{
+  &g_devops, &g_ep0, USB_SPEED_FULL, 0
+};
+
+static struct mscbench_disk_s g_disk;
+static struct mscbench_host_s g_host;
+static uint8_t g_xfrbuf[XFRSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Nanosecond time stamps from the host clock */
+
+static inline uint64_t mscbench_nsec(void)
+{
+  return up_hostnsec();
+}
+
+/* Stand in for the per-command overhead of real media */
+
+static void mscbench_calldelay(void)
+{
+#if CALLDELAY > 0
+  uint64_t start = mscbench_nsec();
+
+  while (mscbench_nsec() - start < (uint64_t)CALLDELAY * 1000)
+    {
+    }
+#endif
+}
+
+/* Block driver methods for the RAM disk */
+
+static int mscbench_open(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static int mscbench_close(FAR struct inode *inode)
+{
+  return OK;
+}
+
+static ssize_t mscbench_read(FAR struct inode *inode, FAR unsigned char *buffer,
+                             size_t start_sector, unsigned int nsectors)
+{
+  FAR struct mscbench_disk_s *disk = (FAR struct mscbench_disk_s *)inode->i_private;
+
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  mscbench_calldelay();
+  memcpy(buffer, &disk->storage[start_sector * SECTORSIZE],
+         nsectors * SECTORSIZE);
+  disk->nreads++;
+  return nsectors;
+}
+
+static ssize_t mscbench_write(FAR struct inode *inode,
+                              FAR const unsigned char *buffer,
+                              size_t start_sector, unsigned int nsectors)
+{
+  FAR struct mscbench_disk_s *disk = (FAR struct mscbench_disk_s *)inode->i_private;
+
+  if (start_sector + nsectors > NSECTORS)
+    {
+      return -EINVAL;
+    }
+
+  mscbench_calldelay();
+  memcpy(&disk->storage[start_sector * SECTORSIZE], buffer,
+         nsectors * SECTORSIZE);
+  disk->nwrites++;
+  return nsectors;
+}
+
+static int mscbench_geometry(FAR struct inode *inode,
+                             FAR struct geometry *geometry)
+{
+  memset(geometry, 0, sizeof(struct geometry));
+  geometry->geo_available    = true;
+  geometry->geo_writeenabled = true;
+  geometry->geo_nsectors     = NSECTORS;
+  geometry->geo_sectorsize   = SECTORSIZE;
+  return OK;
+}
+
+/* Fill bulk OUT requests with the data that the host has to send:  first
+ * the CBW as a transfer of its own, then the data of the command.  This is
+ * what a real controller does in its interrupt handler, so the scheduler is
+ * locked until all of the completions have been delivered.
+ */
+
+static void mscbench_pump(void)
+{
+  FAR struct usbdev_req_s *req;
+  size_t nbytes;
+
+  sched_lock();
+  while (g_host.noutreqs > 0 && (g_host.cbwpending || g_host.outlen > 0))
+    {
+      req = g_host.outreqs[g_host.outhead];
+      g_host.outhead = (g_host.outhead + 1) % CONFIG_USBMSC_NRDREQS;
+      g_host.noutreqs--;
+
+      if (g_host.cbwpending)
+        {
+          memcpy(req->buf, g_host.cbw, USBMSC_CBW_SIZEOF);
+          req->xfrd         = USBMSC_CBW_SIZEOF;
+          g_host.cbwpending = false;
+        }
+      else
+        {
+          nbytes = MIN(g_host.outlen, req->len);
+          memcpy(req->buf, g_host.outdata, nbytes);
+          req->xfrd       = nbytes;
+          g_host.outdata += nbytes;
+          g_host.outlen  -= nbytes;
+        }
+
+      req->result = OK;
+      req->callback(&g_epbulkout, req);
+    }
+
+  sched_unlock();
+}
+
+/* Endpoint methods of the loopback controller */
+
+static int mscbench_epconfigure(FAR struct usbdev_ep_s *ep,
+                                FAR const struct usb_epdesc_s *desc,
+                                bool last)
+{
+  return OK;
+}
+
+static int mscbench_epdisable(FAR struct usbdev_ep_s *ep)
+{
+  FAR struct usbdev_req_s *req;
+
+  /* Return the pending bulk OUT requests to the class driver */
+
+  sched_lock();
+  while (ep == &g_epbulkout && g_host.noutreqs > 0)
+    {
+      req = g_host.outreqs[g_host.outhead];
+      g_host.outhead = (g_host.outhead + 1) % CONFIG_USBMSC_NRDREQS;
+      g_host.noutreqs--;
+
+      req->result = -ESHUTDOWN;
+      req->callback(ep, req);
+    }
+
+  sched_unlock();
+  return OK;
+}
+
+static FAR struct usbdev_req_s *mscbench_epallocreq(FAR struct usbdev_ep_s *ep)
+{
+  return (FAR struct usbdev_req_s *)zalloc(sizeof(struct usbdev_req_s));
+}
+
+static void mscbench_epfreereq(FAR struct usbdev_ep_s *ep,
+                               FAR struct usbdev_req_s *req)
+{
+  free(req);
+}
+
+#ifdef CONFIG_USBDEV_DMA
+static FAR void *mscbench_epallocbuffer(FAR struct usbdev_ep_s *ep,
+                                        uint16_t nbytes)
+{
+  return malloc(nbytes);
+}
+
+static void mscbench_epfreebuffer(FAR struct usbdev_ep_s *ep, FAR void *buf)
+{
+  free(buf);
+}
+#endif
+
+static int mscbench_epsubmit(FAR struct usbdev_ep_s *ep,
+                             FAR struct usbdev_req_s *req)
+{
+  bool csw = false;
+  size_t nbytes;
+  int index;
+
+  req->xfrd   = 0;
+  req->result = OK;
+
+  if (ep == &g_epbulkout)
+    {
+      /* Hold the request until the host has something to send */
+
+      if (g_host.noutreqs >= CONFIG_USBMSC_NRDREQS)
+        {
+          return -EBUSY;
+        }
+
+      sched_lock();
+      index = (g_host.outhead + g_host.noutreqs) % CONFIG_USBMSC_NRDREQS;
+      g_host.outreqs[index] = req;
+      g_host.noutreqs++;
+      sched_unlock();
+
+      mscbench_pump();
+      return OK;
+    }
+
+  /* IN and control transfers complete at once.  Bulk IN data goes to the
+   * command's buffer until that is full;  after that comes the CSW.
+   */
+
+  if (ep == &g_epbulkin)
+    {
+      if (g_host.inlen > 0)
+        {
+          nbytes = MIN(g_host.inlen, req->len);
+          memcpy(g_host.indata, req->buf, nbytes);
+          g_host.indata += nbytes;
+          g_host.inlen  -= nbytes;
+        }
+      else if (req->len == USBMSC_CSW_SIZEOF)
+        {
+          memcpy(g_host.csw, req->buf, USBMSC_CSW_SIZEOF);
+          csw = true;
+        }
+    }
+
+  req->xfrd = req->len;
+  req->callback(ep, req);
+
+  if (csw)
+    {
+      sem_post(&g_host.cswsem);
+    }
+  else if (ep == &g_ep0)
+    {
+      sem_post(&g_host.ep0sem);
+    }
+
+  return OK;
+}
+
+static int mscbench_epcancel(FAR struct usbdev_ep_s *ep,
+                             FAR struct usbdev_req_s *req)
+{
+  return OK;
+}
+
+static int mscbench_epstall(FAR struct usbdev_ep_s *ep, bool resume)
+{
+  if (!resume)
+    {
+      printf("mscbench: endpoint %p stalled\n", ep);
+    }
+
+  return OK;
+}
+
+/* Device methods of the loopback controller */
+
+static FAR struct usbdev_ep_s *mscbench_allocep(FAR struct usbdev_s *dev,
+                                                uint8_t epphy, bool in,
+                                                uint8_t eptype)
+{
+  FAR struct usbdev_ep_s *ep = in ? &g_epbulkin : &g_epbulkout;
+
+  ep->eplog = epphy;
+  return ep;
+}
+
+static void mscbench_freeep(FAR struct usbdev_s *dev,
+                            FAR struct usbdev_ep_s *ep)
+{
+}
+
+static int mscbench_getframe(FAR struct usbdev_s *dev)
+{
+  return 0;
+}
+
+static int mscbench_wakeup(FAR struct usbdev_s *dev)
+{
+  return OK;
+}
+
+static int mscbench_selfpowered(FAR struct usbdev_s *dev, bool selfpowered)
+{
+  return OK;
+}
+
+static int mscbench_pullup(FAR struct usbdev_s *dev, bool enable)
+{
+  return OK;
+}
+
+/* Wait up to two seconds for a semaphore */
+
+static int mscbench_wait(FAR sem_t *sem)
+{
+  struct timespec abstime;
+
+  (void)clock_gettime(CLOCK_REALTIME, &abstime);
+  abstime.tv_sec += 2;
+  return sem_timedwait(sem, &abstime);
+}
+
+/* Little- and big-endian stores */
+
+static void mscbench_putle32(FAR uint8_t *dest, uint32_t val)
+{
+  dest[0] = (uint8_t)val;
+  dest[1] = (uint8_t)(val >> 8);
+  dest[2] = (uint8_t)(val >> 16);
+  dest[3] = (uint8_t)(val >> 24);
+}
+
+static uint32_t mscbench_getle32(FAR const uint8_t *src)
+{
+  return (uint32_t)src[0] | (uint32_t)src[1] << 8 |
+         (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24;
+}
+
+static void mscbench_putbe32(FAR uint8_t *dest, uint32_t val)
+{
+  dest[0] = (uint8_t)(val >> 24);
+  dest[1] = (uint8_t)(val >> 16);
+  dest[2] = (uint8_t)(val >> 8);
+  dest[3] = (uint8_t)val;
+}
+
+/* Select the device configuration, as the host does during enumeration */
+
+static int mscbench_setconfig(void)
+{
+  struct usb_ctrlreq_s ctrl;
+  int ret;
+
+  memset(&ctrl, 0, sizeof(struct usb_ctrlreq_s));
+  ctrl.type     = USB_REQ_TYPE_STANDARD | USB_REQ_RECIPIENT_DEVICE;
+  ctrl.req      = USB_REQ_SETCONFIGURATION;
+  ctrl.value[0] = 1;
+
+  ret = CLASS_SETUP(g_host.driver, &g_usbdev, &ctrl, NULL, 0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  return mscbench_wait(&g_host.ep0sem);
+}
+
+/* Run one TEST UNIT READY, READ(10), or WRITE(10) command to completion */
+
+static int mscbench_command(uint8_t opcode, uint32_t lba,
+                            FAR uint8_t *buffer)
+{
+  FAR struct usbmsc_cbw_s *cbw = (FAR struct usbmsc_cbw_s *)g_host.cbw;
+  FAR struct usbmsc_csw_s *csw = (FAR struct usbmsc_csw_s *)g_host.csw;
+  size_t xfrsize = (opcode == SCSI_CMD_TESTUNITREADY) ? 0 : XFRSIZE;
+
+  /* Build the CBW */
+
+  memset(cbw, 0, USBMSC_CBW_SIZEOF);
+  mscbench_putle32(cbw->signature, USBMSC_CBW_SIGNATURE);
+  mscbench_putle32(cbw->tag, ++g_host.tag);
+  mscbench_putle32(cbw->datlen, xfrsize);
+  cbw->cdb[0] = opcode;
+
+  if (opcode == SCSI_CMD_TESTUNITREADY)
+    {
+      cbw->cdblen = SCSICMD_TESTUNITREADY_SIZEOF;
+    }
+  else
+    {
+      cbw->flags  = (opcode == SCSI_CMD_READ10) ? USBMSC_CBWFLAG_IN : 0;
+      cbw->cdblen = SCSICMD_READ10_SIZEOF;
+      mscbench_putbe32(&cbw->cdb[2], lba);
+      cbw->cdb[7] = (uint8_t)(XFRSECTORS >> 8);
+      cbw->cdb[8] = (uint8_t)XFRSECTORS;
+    }
+
+  /* Queue the CBW and the data for the device, or make room for the data
+   * from the device.
+   */
+
+  sched_lock();
+  if (opcode == SCSI_CMD_READ10)
+    {
+      g_host.indata  = buffer;
+      g_host.inlen   = xfrsize;
+    }
+  else
+    {
+      g_host.outdata = buffer;
+      g_host.outlen  = xfrsize;
+    }
+
+  memset(csw, 0, USBMSC_CSW_SIZEOF);
+  g_host.cbwpending = true;
+  sched_unlock();
+
+  mscbench_pump();
+
+  /* And wait for the status */
+
+  if (mscbench_wait(&g_host.cswsem) < 0)
+    {
+      printf("mscbench: no status for command %02x at %lu\n",
+             opcode, (unsigned long)lba);
+      return -ETIMEDOUT;
+    }
+
+  if (mscbench_getle32(csw->signature) != USBMSC_CSW_SIGNATURE ||
+      mscbench_getle32(csw->tag) != g_host.tag ||
+      csw->status != USBMSC_CSWSTATUS_PASS ||
+      mscbench_getle32(csw->residue) != 0 ||
+      g_host.inlen != 0 || g_host.outlen != 0)
+    {
+      printf("mscbench: command %02x at %lu failed: status %d residue %lu\n",
+             opcode, (unsigned long)lba, csw->status,
+             (unsigned long)mscbench_getle32(csw->residue));
+      return -EIO;
+    }
+
+  return OK;
+}
+
+/* The expected content of a sector */
+
+static inline uint8_t mscbench_pattern(uint32_t sector, int offset, int pass)
+{
+  return (uint8_t)(sector * 7 + offset + pass);
+}
+
+/* Print one result line */
+
+static void mscbench_report(FAR const char *what, uint64_t elapsed,
+                            unsigned int ncalls)
+{
+  uint32_t ncmds = NPASSES * (NSECTORS / XFRSECTORS);
+  uint32_t rate;
+  uint32_t calls;
+
+  /* MB/s (times 100) is bytes per microsecond (times 100) */
+
+  elapsed /= 1000;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  rate  = (uint32_t)((uint64_t)NPASSES * NSECTORS * SECTORSIZE * 100 / elapsed);
+  calls = (uint32_t)((uint64_t)ncalls * 100 / ncmds);
+
+  printf("  %-5s  %5lu.%02lu  %5lu.%02lu\n", what,
+         (unsigned long)(rate / 100), (unsigned long)(rate % 100),
+         (unsigned long)(calls / 100), (unsigned long)(calls % 100));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: usbdev_register and usbdev_unregister
+ *
+ * Description:
+ *   The simulator has no USB device controller;  these take the place of
+ *   its driver and bind the class driver to the loopback controller.
+ *
+ ****************************************************************************/
+
+int usbdev_register(FAR struct usbdevclass_driver_s *driver)
+{
+  if (g_host.driver != NULL)
+    {
+      return -EBUSY;
+    }
+
+  g_host.driver = driver;
+  return CLASS_BIND(driver, &g_usbdev);
+}
+
+int usbdev_unregister(FAR struct usbdevclass_driver_s *driver)
+{
+  if (driver != g_host.driver)
+    {
+      return -EINVAL;
+    }
+
+  CLASS_DISCONNECT(driver, &g_usbdev);
+  CLASS_UNBIND(driver, &g_usbdev);
+  g_host.driver = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * mscbench_main
+ ****************************************************************************/
+
+int mscbench_main(int argc, char *argv[])
+{
+  FAR void *handle = NULL;
+  uint64_t twrite = 0;
+  uint64_t tread = 0;
+  uint64_t start;
+  unsigned int nwrites = 0;
+  unsigned int nreads = 0;
+  uint32_t sector;
+  int ret = EXIT_FAILURE;
+  int pass;
+  int i;
+
+  g_disk.storage = (FAR uint8_t *)zalloc(NSECTORS * SECTORSIZE);
+  if (!g_disk.storage)
+    {
+      printf("mscbench: failed to allocate the RAM disk\n");
+      return EXIT_FAILURE;
+    }
+
+  if (register_blockdriver(BLOCKDEV, &g_bops, 0, &g_disk) < 0)
+    {
+      printf("mscbench: register_blockdriver failed\n");
+      goto errout_with_storage;
+    }
+
+  memset(&g_host, 0, sizeof(struct mscbench_host_s));
+  sem_init(&g_host.cswsem, 0, 0);
+  sem_init(&g_host.ep0sem, 0, 0);
+
+  /* Export the RAM disk and configure the device */
+
+  if (usbmsc_configure(1, &handle) < 0 ||
+      usbmsc_bindlun(handle, BLOCKDEV, 0, 0, 0, false) < 0 ||
+      usbmsc_exportluns(handle) < 0)
+    {
+      printf("mscbench: failed to export the RAM disk\n");
+      goto errout_with_msc;
+    }
+
+  /* A real host takes some time to enumerate the device;  let the worker
+   * thread reach its event loop before the configuration is selected.
+   */
+
+  usleep(100 * 1000);
+
+  if (mscbench_setconfig() < 0)
+    {
+      printf("mscbench: SET CONFIGURATION failed\n");
+      goto errout_with_msc;
+    }
+
+  /* Like a real host, check that the unit is ready before using it */
+
+  if (mscbench_command(SCSI_CMD_TESTUNITREADY, 0, NULL) < 0)
+    {
+      goto errout_with_msc;
+    }
+
+  /* Write the whole disk and read it back, NPASSES times */
+
+  for (pass = 0; pass < NPASSES; pass++)
+    {
+      for (sector = 0; sector < NSECTORS; sector += XFRSECTORS)
+        {
+          for (i = 0; i < XFRSIZE; i++)
+            {
+              g_xfrbuf[i] = mscbench_pattern(sector + i / SECTORSIZE,
+                                             i % SECTORSIZE, pass);
+            }
+
+          g_disk.nwrites = 0;
+          start = mscbench_nsec();
+          if (mscbench_command(SCSI_CMD_WRITE10, sector, g_xfrbuf) < 0)
+            {
+              goto errout_with_msc;
+            }
+
+          twrite  += mscbench_nsec() - start;
+          nwrites += g_disk.nwrites;
+        }
+
+      for (sector = 0; sector < NSECTORS; sector += XFRSECTORS)
+        {
+          memset(g_xfrbuf, 0, XFRSIZE);
+
+          g_disk.nreads = 0;
+          start = mscbench_nsec();
+          if (mscbench_command(SCSI_CMD_READ10, sector, g_xfrbuf) < 0)
+            {
+              goto errout_with_msc;
+            }
+
+          tread  += mscbench_nsec() - start;
+          nreads += g_disk.nreads;
+
+          for (i = 0; i < XFRSIZE; i++)
+            {
+              if (g_xfrbuf[i] != mscbench_pattern(sector + i / SECTORSIZE,
+                                                  i % SECTORSIZE, pass))
+                {
+                  printf("mscbench: ERROR: data at sector %lu offset %d "
+                         "miscompared\n", (unsigned long)sector, i);
+                  goto errout_with_msc;
+                }
+            }
+        }
+    }
+
+  printf("\nUSB mass storage benchmark: %d KiB disk, %d sectors per "
+         "command, %d per media call\n", NSECTORS * SECTORSIZE / 1024,
+         XFRSECTORS, CONFIG_USBMSC_IOSECTORS);
+  printf("  %-5s  %8s  %8s\n", "", "MB/s", "calls/cmd");
+  mscbench_report("write", twrite, nwrites);
+  mscbench_report("read", tread, nreads);
+  ret = EXIT_SUCCESS;
+
+errout_with_msc:
+  if (handle)
+    {
+      usbmsc_uninitialize(handle);
+    }
+
+  sem_destroy(&g_host.cswsem);
+  sem_destroy(&g_host.ep0sem);
+  (void)unregister_blockdriver(BLOCKDEV);
+errout_with_storage:
+  free(g_disk.storage);
+  return ret;
+}
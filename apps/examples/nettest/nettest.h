@@ -85,6 +85,12 @@
 #define PORTNO     5471
 #define SENDSIZE   4096
 
+/* In the performance test, the client sends this many bytes */
+
+#ifndef CONFIG_EXAMPLES_NETTEST_PERFSIZE
+#  define CONFIG_EXAMPLES_NETTEST_PERFSIZE 1048576
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
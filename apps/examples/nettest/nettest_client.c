@@ -38,6 +38,7 @@
  ****************************************************************************/
 
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 #include <stdio.h>
@@ -56,7 +57,12 @@ void send_client(void)
 {
   struct sockaddr_in myaddr;
   char *outbuf;
-#ifndef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
+#ifdef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
+  struct timeval start;
+  struct timeval end;
+  unsigned long totalbytessent;
+  unsigned long elapsed;
+#else
   char *inbuf;
 #endif
   int sockfd;
@@ -122,9 +128,17 @@ void send_client(void)
     }
 
 #ifdef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
-  /* Then send messages forever */
+  /* Then send a fixed amount of data and close the connection.  The time
+   * includes the close because, with TCP write buffering, send() returns
+   * before the data is acknowledged and close() waits for the rest.
+   */
+
+  message("client: Sending %d bytes\n", CONFIG_EXAMPLES_NETTEST_PERFSIZE);
 
-  for (;;)
+  totalbytessent = 0;
+  gettimeofday(&start, NULL);
+
+  while (totalbytessent < CONFIG_EXAMPLES_NETTEST_PERFSIZE)
     {
       nbytessent = send(sockfd, outbuf, SENDSIZE, 0);
       if (nbytessent < 0)
@@ -138,8 +152,27 @@ void send_client(void)
                   nbytessent, SENDSIZE);
           goto errout_with_socket;
         }
-      message("Sent %d bytes\n", nbytessent);
+
+      totalbytessent += nbytessent;
     }
+
+  close(sockfd);
+  gettimeofday(&end, NULL);
+
+  elapsed = (end.tv_sec - start.tv_sec) * 1000 +
+            (end.tv_usec - start.tv_usec) / 1000;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  message("client: Sent %lu bytes in %lu msec: %lu bytes/sec\n",
+          totalbytessent, elapsed,
+          (totalbytessent / elapsed) * 1000 +
+          ((totalbytessent % elapsed) * 1000) / elapsed);
+
+  free(outbuf);
+  return;
 #else
   /* Then send and receive one message */
 
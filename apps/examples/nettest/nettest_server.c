@@ -39,6 +39,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <netinet/in.h>
 
 #include <stdio.h>
@@ -63,7 +64,12 @@ void recv_server(void)
   int acceptsd;
   socklen_t addrlen;
   int nbytesread;
-#ifndef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
+#ifdef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
+  struct timeval start;
+  struct timeval end;
+  unsigned long totalbytesread;
+  unsigned long elapsed;
+#else
   int totalbytesread;
   int nbytessent;
   int ch;
@@ -144,7 +150,10 @@ void recv_server(void)
 #endif
 
 #ifdef CONFIG_EXAMPLES_NETTEST_PERFORMANCE
-  /* Then receive data forever */
+  /* Then receive data until the client closes the connection */
+
+  totalbytesread = 0;
+  gettimeofday(&start, NULL);
 
   for (;;)
     {
@@ -156,11 +165,35 @@ void recv_server(void)
         }
       else if (nbytesread == 0)
         {
-          message("server: The client broke the connection\n");
-          goto errout_with_acceptsd;
+          break;
         }
-      message("Received %d bytes\n", nbytesread);
+
+      totalbytesread += nbytesread;
     }
+
+  gettimeofday(&end, NULL);
+
+  elapsed = (end.tv_sec - start.tv_sec) * 1000 +
+            (end.tv_usec - start.tv_usec) / 1000;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  message("server: Received %lu bytes in %lu msec: %lu bytes/sec\n",
+          totalbytesread, elapsed,
+          (totalbytesread / elapsed) * 1000 +
+          ((totalbytesread % elapsed) * 1000) / elapsed);
+
+  if (totalbytesread != CONFIG_EXAMPLES_NETTEST_PERFSIZE)
+    {
+      message("server: Expected %d bytes\n", CONFIG_EXAMPLES_NETTEST_PERFSIZE);
+    }
+
+  close(listensd);
+  close(acceptsd);
+  free(buffer);
+  return;
 #else
   /* Receive canned message */
 
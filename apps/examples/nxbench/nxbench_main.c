@@ -0,0 +1,610 @@
+/****************************************************************************
+ * examples/nxbench/nxbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxglib.h>
+
+#ifdef CONFIG_NX_LCDDRIVER
+#  include <nuttx/lcd/lcd.h>
+#else
+#  include <nuttx/fb.h>
+#endif
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NX_MULTIUSER
+#  error "The NX redraw benchmark requires CONFIG_NX_MULTIUSER"
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_VPLANE
+#  define CONFIG_EXAMPLES_NXBENCH_VPLANE 0
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_DEVNO
+#  define CONFIG_EXAMPLES_NXBENCH_DEVNO 0
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_BPP
+#  define CONFIG_EXAMPLES_NXBENCH_BPP 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_NFRAMES
+#  define CONFIG_EXAMPLES_NXBENCH_NFRAMES 100
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_NXBENCH_STACKSIZE 2048
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_SERVERPRIO
+#  define CONFIG_EXAMPLES_NXBENCH_SERVERPRIO 120
+#endif
+
+#define BPP         CONFIG_EXAMPLES_NXBENCH_BPP
+#define NFRAMES     CONFIG_EXAMPLES_NXBENCH_NFRAMES
+
+#if BPP >= 32
+#  define COLORMASK 0xffffffff
+#else
+#  define COLORMASK ((1ul << BPP) - 1)
+#endif
+
+/* Each redraw paints NWINDOWS overlapping windows.  Each window gets a
+ * background, then a grid of NROWS x NCOLS buttons (a border and a face),
+ * then a label bitmap on each button.
+ */
+
+#define NWINDOWS    3
+#define NROWS       3
+#define NCOLS       2
+#define MARGIN      4
+#define BORDER      2
+#define LABELHEIGHT 8
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void nxbench_redraw(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
+                           bool more, FAR void *arg);
+static void nxbench_position(NXWINDOW hwnd, FAR const struct nxgl_size_s *size,
+                             FAR const struct nxgl_point_s *pos,
+                             FAR const struct nxgl_rect_s *bounds,
+                             FAR void *arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct nx_callback_s g_nxbenchcb =
+{
+  nxbench_redraw,   /* redraw */
+  nxbench_position  /* position */
+#ifdef CONFIG_NX_MOUSE
+  , NULL            /* mousein */
+#endif
+#ifdef CONFIG_NX_KBD
+  , NULL            /* kbdin */
+#endif
+};
+
+static NXHANDLE g_hnx;
+static NXWINDOW g_hwnd[NWINDOWS];
+static struct nxgl_size_s g_wndsize;
+static struct nxgl_size_s g_dispsize;
+
+/* The benchmark waits for the reply to nx_getposition() to know that the
+ * server has processed everything sent before it.
+ */
+
+static int g_nrequests;
+static volatile int g_nreports;
+
+/* The source image of the button labels */
+
+static FAR uint8_t *g_label;
+static unsigned int g_labelstride;
+
+/* With an LCD, the benchmark sits between NX and the LCD driver and counts
+ * the runs sent to the LCD.
+ */
+
+#ifdef CONFIG_NX_LCDDRIVER
+static FAR struct lcd_dev_s *g_lcd;
+static struct lcd_dev_s g_benchlcd;
+static int (*g_putrun)(fb_coord_t row, fb_coord_t col,
+                       FAR const uint8_t *buffer, size_t npixels);
+static volatile uint32_t g_nruns;
+static volatile uint32_t g_npixels;
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_redraw
+ ****************************************************************************/
+
+static void nxbench_redraw(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
+                           bool more, FAR void *arg)
+{
+  /* Nothing to do.  Every window is redrawn on each frame anyway. */
+}
+
+/****************************************************************************
+ * Name: nxbench_position
+ ****************************************************************************/
+
+static void nxbench_position(NXWINDOW hwnd, FAR const struct nxgl_size_s *size,
+                             FAR const struct nxgl_point_s *pos,
+                             FAR const struct nxgl_rect_s *bounds,
+                             FAR void *arg)
+{
+  g_dispsize.w = bounds->pt2.x + 1;
+  g_dispsize.h = bounds->pt2.y + 1;
+  g_nreports++;
+}
+
+/****************************************************************************
+ * Name: nxbench_putrun, nxbench_getvideoinfo, nxbench_getplaneinfo
+ *
+ * Description:
+ *   LCD methods that pass through to the real LCD driver and count the
+ *   runs written.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_LCDDRIVER
+static int nxbench_putrun(fb_coord_t row, fb_coord_t col,
+                          FAR const uint8_t *buffer, size_t npixels)
+{
+  g_nruns++;
+  g_npixels += npixels;
+  return g_putrun(row, col, buffer, npixels);
+}
+
+static int nxbench_getvideoinfo(FAR struct lcd_dev_s *dev,
+                                FAR struct fb_videoinfo_s *vinfo)
+{
+  return g_lcd->getvideoinfo(g_lcd, vinfo);
+}
+
+static int nxbench_getplaneinfo(FAR struct lcd_dev_s *dev,
+                                unsigned int planeno,
+                                FAR struct lcd_planeinfo_s *pinfo)
+{
+  int ret = g_lcd->getplaneinfo(g_lcd, planeno, pinfo);
+  if (ret >= 0)
+    {
+      g_putrun      = pinfo->putrun;
+      pinfo->putrun = nxbench_putrun;
+    }
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxbench_server
+ ****************************************************************************/
+
+static int nxbench_server(int argc, char *argv[])
+{
+  FAR NX_DRIVERTYPE *dev;
+  int ret;
+
+#ifdef CONFIG_NX_LCDDRIVER
+  ret = up_lcdinitialize();
+  if (ret < 0)
+    {
+      printf("nxbench_server: up_lcdinitialize failed: %d\n", -ret);
+      return EXIT_FAILURE;
+    }
+
+  g_lcd = up_lcdgetdev(CONFIG_EXAMPLES_NXBENCH_DEVNO);
+  if (!g_lcd)
+    {
+      printf("nxbench_server: up_lcdgetdev failed, devno=%d\n",
+             CONFIG_EXAMPLES_NXBENCH_DEVNO);
+      return EXIT_FAILURE;
+    }
+
+  (void)g_lcd->setpower(g_lcd, CONFIG_LCD_MAXPOWER);
+
+  /* Give NX the counting LCD instead of the real one */
+
+  memcpy(&g_benchlcd, g_lcd, sizeof(struct lcd_dev_s));
+  g_benchlcd.getvideoinfo = nxbench_getvideoinfo;
+  g_benchlcd.getplaneinfo = nxbench_getplaneinfo;
+  dev = &g_benchlcd;
+#else
+  ret = up_fbinitialize();
+  if (ret < 0)
+    {
+      printf("nxbench_server: up_fbinitialize failed: %d\n", -ret);
+      return EXIT_FAILURE;
+    }
+
+  dev = up_fbgetvplane(CONFIG_EXAMPLES_NXBENCH_VPLANE);
+  if (!dev)
+    {
+      printf("nxbench_server: up_fbgetvplane failed, vplane=%d\n",
+             CONFIG_EXAMPLES_NXBENCH_VPLANE);
+      return EXIT_FAILURE;
+    }
+#endif
+
+  /* Then run the server.  This does not return unless there is an error. */
+
+  ret = nx_run(dev);
+  printf("nxbench_server: nx_run returned: %d\n", errno);
+  return EXIT_FAILURE;
+}
+
+/****************************************************************************
+ * Name: nxbench_sync
+ *
+ * Description:
+ *   Wait until the server has processed every message sent so far
+ *
+ ****************************************************************************/
+
+static int nxbench_sync(void)
+{
+  int ret;
+
+  ret = nx_getposition(g_hwnd[0]);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  g_nrequests++;
+  while (g_nreports < g_nrequests)
+    {
+      ret = nx_eventhandler(g_hnx);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+#ifndef CONFIG_NX_BLOCKING
+      if (g_nreports < g_nrequests)
+        {
+          usleep(1000);
+        }
+#endif
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbench_drawwindow
+ ****************************************************************************/
+
+static int nxbench_drawwindow(NXWINDOW hwnd, int frame)
+{
+  nxgl_mxpixel_t color[CONFIG_NX_NPLANES];
+  FAR const void *src[CONFIG_NX_NPLANES];
+  struct nxgl_rect_s rect;
+  struct nxgl_rect_s face;
+  struct nxgl_rect_s label;
+  struct nxgl_point_s origin;
+  nxgl_coord_t width;
+  nxgl_coord_t height;
+  int row;
+  int col;
+  int ret;
+
+  /* The window background */
+
+  rect.pt1.x = 0;
+  rect.pt1.y = 0;
+  rect.pt2.x = g_wndsize.w - 1;
+  rect.pt2.y = g_wndsize.h - 1;
+
+  color[0] = (0x30303030 + frame) & COLORMASK;
+  ret = nx_fill(hwnd, &rect, color);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Then the buttons */
+
+  width  = (g_wndsize.w - (NCOLS + 1) * MARGIN) / NCOLS;
+  height = (g_wndsize.h - (NROWS + 1) * MARGIN) / NROWS;
+  src[0] = g_label;
+
+  for (row = 0; row < NROWS; row++)
+    {
+      for (col = 0; col < NCOLS; col++)
+        {
+          rect.pt1.x = MARGIN + col * (width + MARGIN);
+          rect.pt1.y = MARGIN + row * (height + MARGIN);
+          rect.pt2.x = rect.pt1.x + width - 1;
+          rect.pt2.y = rect.pt1.y + height - 1;
+
+          color[0] = 0x10101010 & COLORMASK;
+          ret = nx_fill(hwnd, &rect, color);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          face.pt1.x = rect.pt1.x + BORDER;
+          face.pt1.y = rect.pt1.y + BORDER;
+          face.pt2.x = rect.pt2.x - BORDER;
+          face.pt2.y = rect.pt2.y - BORDER;
+
+          color[0] = (0xc0c0c0c0 - frame - row - col) & COLORMASK;
+          ret = nx_fill(hwnd, &face, color);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          label.pt1.x = face.pt1.x + MARGIN;
+          label.pt1.y = face.pt1.y + (height - 2 * BORDER - LABELHEIGHT) / 2;
+          label.pt2.x = face.pt2.x - MARGIN;
+          label.pt2.y = label.pt1.y + LABELHEIGHT - 1;
+
+          origin.x = label.pt1.x - ((frame + row) & 7);
+          origin.y = label.pt1.y;
+
+          ret = nx_bitmap(hwnd, &label, src, &origin, g_labelstride);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * nxbench_main
+ ****************************************************************************/
+
+int nxbench_main(int argc, char *argv[])
+{
+  struct nxgl_point_s pos;
+  uint64_t total;
+  uint32_t start;
+  uint32_t best;
+  uint32_t elapsed;
+  pid_t server;
+  int frame;
+  int ret;
+  int i;
+
+  benchtime_initialize();
+
+  /* Start the server and connect to it */
+
+  server = task_create("NX Server", CONFIG_EXAMPLES_NXBENCH_SERVERPRIO,
+                       CONFIG_EXAMPLES_NXBENCH_STACKSIZE, nxbench_server,
+                       NULL);
+  if (server < 0)
+    {
+      printf("nxbench_main: Failed to create the server: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  sleep(1);
+
+  g_hnx = nx_connect();
+  if (!g_hnx)
+    {
+      printf("nxbench_main: nx_connect failed: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  /* Open the windows.  The server reports the position of each new window
+   * and, with it, the size of the display.
+   */
+
+  for (i = 0; i < NWINDOWS; i++)
+    {
+      g_hwnd[i] = nx_openwindow(g_hnx, &g_nxbenchcb, NULL);
+      if (!g_hwnd[i])
+        {
+          printf("nxbench_main: nx_openwindow failed: %d\n", errno);
+          goto errout;
+        }
+
+      g_nrequests++;
+    }
+
+  ret = nxbench_sync();
+  if (ret < 0)
+    {
+      goto errout_with_errno;
+    }
+
+  /* Each window covers 5/8 of the display and is offset by 1/8 from the one
+   * below it, so they overlap like a stack of dialogs.
+   */
+
+  g_wndsize.w = g_dispsize.w * 5 / 8;
+  g_wndsize.h = g_dispsize.h * 5 / 8;
+
+  for (i = 0; i < NWINDOWS; i++)
+    {
+      pos.x = i * g_dispsize.w / 8;
+      pos.y = i * g_dispsize.h / 8;
+
+      if (nx_setsize(g_hwnd[i], &g_wndsize) < 0 ||
+          nx_setposition(g_hwnd[i], &pos) < 0)
+        {
+          goto errout_with_errno;
+        }
+
+      g_nrequests += 2;
+    }
+
+  /* The label image is a pattern of vertical stripes as wide as the
+   * display.
+   */
+
+  g_labelstride = (g_dispsize.w * BPP + 7) >> 3;
+  g_label = (FAR uint8_t *)malloc(g_labelstride * LABELHEIGHT);
+  if (!g_label)
+    {
+      printf("nxbench_main: Failed to allocate the label image\n");
+      goto errout;
+    }
+
+  for (i = 0; i < g_labelstride * LABELHEIGHT; i++)
+    {
+      g_label[i] = (i & 4) ? 0xff : 0x00;
+    }
+
+  ret = nxbench_sync();
+  if (ret < 0)
+    {
+      goto errout_with_errno;
+    }
+
+  printf("Display %dx%d, %d windows of %dx%d, %d redraws\n",
+         g_dispsize.w, g_dispsize.h, NWINDOWS, g_wndsize.w, g_wndsize.h,
+         NFRAMES);
+
+  /* Redraw everything NFRAMES times.  Each redraw is complete when the
+   * reply to nx_getposition() arrives.
+   */
+
+#ifdef CONFIG_NX_LCDDRIVER
+  g_nruns   = 0;
+  g_npixels = 0;
+#endif
+
+  total = 0;
+  best  = UINT32_MAX;
+
+  for (frame = 0; frame < NFRAMES; frame++)
+    {
+      start = benchtime_now();
+
+      for (i = 0; i < NWINDOWS; i++)
+        {
+          ret = nxbench_drawwindow(g_hwnd[i], frame);
+          if (ret < 0)
+            {
+              goto errout_with_errno;
+            }
+        }
+
+#ifdef CONFIG_NX_DAMAGE
+      ret = nx_flush(g_hnx);
+      if (ret < 0)
+        {
+          goto errout_with_errno;
+        }
+#endif
+
+      ret = nxbench_sync();
+      if (ret < 0)
+        {
+          goto errout_with_errno;
+        }
+
+      elapsed = benchtime_now() - start;
+      total  += elapsed;
+      if (elapsed < best)
+        {
+          best = elapsed;
+        }
+    }
+
+  printf("Time per redraw: %lu %s (average), %lu %s (fastest)\n",
+         (unsigned long)(total / NFRAMES), BENCHTIME_UNITS,
+         (unsigned long)best, BENCHTIME_UNITS);
+#ifndef BENCHTIME_CYCLES
+  if (total > 0)
+    {
+      printf("Redraws per second: %lu\n",
+             (unsigned long)((uint64_t)NFRAMES * 1000000 / total));
+    }
+#endif
+#ifdef CONFIG_NX_LCDDRIVER
+  printf("LCD runs per redraw: %lu, pixels per redraw: %lu\n",
+         (unsigned long)(g_nruns / NFRAMES),
+         (unsigned long)(g_npixels / NFRAMES));
+#endif
+
+  free(g_label);
+  for (i = 0; i < NWINDOWS; i++)
+    {
+      (void)nx_closewindow(g_hwnd[i]);
+    }
+
+  nx_disconnect(g_hnx);
+  return EXIT_SUCCESS;
+
+errout_with_errno:
+  printf("nxbench_main: NX request failed: %d\n", errno);
+errout:
+  free(g_label);
+  nx_disconnect(g_hnx);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,591 @@
+/****************************************************************************
+ * examples/nxffsbench/nxffsbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/mtd.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/fs/nxffs.h>
+
+#ifdef CONFIG_ARCH_SIM
+#  include <arch/arch.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* This must exactly match the default configuration in drivers/mtd/rammtd.c */
+
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#  define CONFIG_RAMMTD_ERASESIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXFFSBENCH_NEBLOCKS
+#  define CONFIG_EXAMPLES_NXFFSBENCH_NEBLOCKS 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXFFSBENCH_NFILES
+#  define CONFIG_EXAMPLES_NXFFSBENCH_NFILES 2000
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXFFSBENCH_NREWRITES
+#  define CONFIG_EXAMPLES_NXFFSBENCH_NREWRITES 1000
+#endif
+
+#ifdef CONFIG_NXFFS_INDEX
+#  define INODEINDEX "yes"
+#else
+#  define INODEINDEX "no"
+#endif
+
+#if defined(CONFIG_NXFFS_BGPACK)
+#  define PACKING "background"
+#elif defined(CONFIG_EXAMPLES_NXFFSBENCH_IDLEPACK)
+#  define PACKING "idle"
+#else
+#  define PACKING "on write"
+#endif
+
+#define FLASHSIZE   (CONFIG_RAMMTD_ERASESIZE * CONFIG_EXAMPLES_NXFFSBENCH_NEBLOCKS)
+#define NFILES      CONFIG_EXAMPLES_NXFFSBENCH_NFILES
+#define DATASIZE    16
+
+#define MOUNTPT     "/mnt/nxffsbench"
+#define FILENAME    MOUNTPT "/file%05d"
+#define MISSINGNAME MOUNTPT "/none%05d"
+#define LOGNAME     MOUNTPT "/log%02d"
+
+/* The rewrite phase rewrites NLOGS files of LOGSIZE bytes in turn and
+ * sleeps for IDLEUSEC between rewrites.
+ */
+
+#define NREWRITES   CONFIG_EXAMPLES_NXFFSBENCH_NREWRITES
+#define NLOGS       32
+#define LOGSIZE     512
+#define IDLEUSEC    1000
+
+/* Every DELINTERVAL'th file is deleted before the measurements */
+
+#define DELINTERVAL 4
+#define DELETED(n)  (((n) % DELINTERVAL) == 0)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_simflash[FLASHSIZE];
+static uint32_t g_latency[NREWRITES];
+static char g_logdata[LOGSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Microsecond time stamps.  On the simulator, use the host's clock so that
+ * the result does not depend on the simulated timer.
+ */
+
+static uint32_t nxffsbench_usec(void)
+{
+#ifdef CONFIG_ARCH_SIM
+  return (uint32_t)(up_hostnsec() / 1000);
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+#endif
+}
+
+static void nxffsbench_report(FAR const char *what, uint32_t elapsed,
+                              int nops)
+{
+  printf("  %-20s %10lu %9lu\n", what, (unsigned long)elapsed,
+         (unsigned long)(nops > 0 ? elapsed / nops : 0));
+}
+
+/* The content of file n */
+
+static void nxffsbench_data(FAR char *data, int n)
+{
+  memset(data, 'a' + n % 26, DATASIZE);
+  snprintf(data, DATASIZE, "%08d", n);
+}
+
+/* Create all of the files, then delete some of them */
+
+static int nxffsbench_create(void)
+{
+  char path[32];
+  char data[DATASIZE];
+  uint32_t start;
+  int fd;
+  int n;
+
+  start = nxffsbench_usec();
+  for (n = 0; n < NFILES; n++)
+    {
+      snprintf(path, sizeof(path), FILENAME, n);
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("nxffsbench: open %s failed: %d\n", path, errno);
+          return -1;
+        }
+
+      nxffsbench_data(data, n);
+      if (write(fd, data, DATASIZE) != DATASIZE)
+        {
+          printf("nxffsbench: write %s failed: %d\n", path, errno);
+          close(fd);
+          return -1;
+        }
+
+      close(fd);
+    }
+
+  nxffsbench_report("create", nxffsbench_usec() - start, NFILES);
+
+  start = nxffsbench_usec();
+  for (n = 0; n < NFILES; n += DELINTERVAL)
+    {
+      snprintf(path, sizeof(path), FILENAME, n);
+      if (unlink(path) < 0)
+        {
+          printf("nxffsbench: unlink %s failed: %d\n", path, errno);
+          return -1;
+        }
+    }
+
+  nxffsbench_report("unlink", nxffsbench_usec() - start,
+                    (NFILES + DELINTERVAL - 1) / DELINTERVAL);
+  return 0;
+}
+
+/* Open and read back every file that was not deleted.  Only the time spent
+ * in open() is measured.  Returns the number of errors.
+ */
+
+static int nxffsbench_open(FAR const char *what)
+{
+  char path[32];
+  char expected[DATASIZE];
+  char data[DATASIZE];
+  uint32_t elapsed = 0;
+  uint32_t start;
+  int errors = 0;
+  int nops = 0;
+  int fd;
+  int n;
+
+  for (n = 0; n < NFILES; n++)
+    {
+      if (DELETED(n))
+        {
+          continue;
+        }
+
+      snprintf(path, sizeof(path), FILENAME, n);
+      start    = nxffsbench_usec();
+      fd       = open(path, O_RDONLY);
+      elapsed += nxffsbench_usec() - start;
+      nops++;
+
+      if (fd < 0)
+        {
+          errors++;
+          continue;
+        }
+
+      nxffsbench_data(expected, n);
+      if (read(fd, data, DATASIZE) != DATASIZE ||
+          memcmp(data, expected, DATASIZE) != 0)
+        {
+          errors++;
+        }
+
+      close(fd);
+    }
+
+  nxffsbench_report(what, elapsed, nops);
+  return errors;
+}
+
+/* stat() every file that exists, then the deleted files and some names
+ * that never existed.  Returns the number of errors.
+ */
+
+static int nxffsbench_stat(void)
+{
+  struct stat buf;
+  char path[32];
+  uint32_t start;
+  int errors = 0;
+  int nops = 0;
+  int ret;
+  int n;
+
+  start = nxffsbench_usec();
+  for (n = 0; n < NFILES; n++)
+    {
+      if (!DELETED(n))
+        {
+          snprintf(path, sizeof(path), FILENAME, n);
+          if (stat(path, &buf) < 0 || buf.st_size != DATASIZE)
+            {
+              errors++;
+            }
+
+          nops++;
+        }
+    }
+
+  nxffsbench_report("stat", nxffsbench_usec() - start, nops);
+
+  start = nxffsbench_usec();
+  nops  = 0;
+  for (n = 0; n < NFILES; n += DELINTERVAL)
+    {
+      snprintf(path, sizeof(path), FILENAME, n);
+      ret = stat(path, &buf);
+      if (ret == 0 || errno != ENOENT)
+        {
+          errors++;
+        }
+
+      snprintf(path, sizeof(path), MISSINGNAME, n);
+      ret = stat(path, &buf);
+      if (ret == 0 || errno != ENOENT)
+        {
+          errors++;
+        }
+
+      nops += 2;
+    }
+
+  nxffsbench_report("stat missing", nxffsbench_usec() - start, nops);
+  return errors;
+}
+
+/* Pack the volume so that the deleted inodes are removed */
+
+static int nxffsbench_pack(void)
+{
+  char path[32];
+  uint32_t start;
+  int ret;
+  int fd;
+
+  snprintf(path, sizeof(path), FILENAME, 1);
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      printf("nxffsbench: open %s failed: %d\n", path, errno);
+      return -1;
+    }
+
+  start = nxffsbench_usec();
+  ret   = ioctl(fd, FIOC_OPTIMIZE, 0);
+  nxffsbench_report("pack", nxffsbench_usec() - start, 1);
+  close(fd);
+
+  if (ret < 0)
+    {
+      printf("nxffsbench: FIOC_OPTIMIZE failed: %d\n", errno);
+      return -1;
+    }
+
+  return 0;
+}
+
+/* Sort the latencies */
+
+static int nxffsbench_compare(FAR const void *a, FAR const void *b)
+{
+  uint32_t la = *(FAR const uint32_t *)a;
+  uint32_t lb = *(FAR const uint32_t *)b;
+
+  return la < lb ? -1 : la > lb ? 1 : 0;
+}
+
+/* Rewrite the log files in turn, measuring the time from open() through
+ * close() of each rewrite, then report the distribution of those times.
+ * The volume fills up with the old versions of the files and must be
+ * packed from time to time.
+ */
+
+static int nxffsbench_rewrite(void)
+{
+  static const uint32_t limits[] = { 100, 1000, 10000, 100000 };
+  char path[32];
+  uint32_t total = 0;
+  uint32_t start;
+  int counts[5];
+  int fd;
+  int n;
+  int i;
+#ifdef CONFIG_EXAMPLES_NXFFSBENCH_IDLEPACK
+  int packfd;
+  int ret;
+
+  /* Packing ioctls may be sent through any file on the volume that is
+   * not being written.
+   */
+
+  snprintf(path, sizeof(path), FILENAME, 1);
+  packfd = open(path, O_RDONLY);
+  if (packfd < 0)
+    {
+      printf("nxffsbench: open %s failed: %d\n", path, errno);
+      return -1;
+    }
+#endif
+
+  for (n = 0; n < NREWRITES; n++)
+    {
+      snprintf(path, sizeof(path), LOGNAME, n % NLOGS);
+      memset(g_logdata, 'A' + n % 26, LOGSIZE);
+      snprintf(g_logdata, LOGSIZE, "%08d", n);
+
+      start = nxffsbench_usec();
+      fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (fd < 0)
+        {
+          printf("nxffsbench: open %s failed: %d\n", path, errno);
+          goto errout;
+        }
+
+      if (write(fd, g_logdata, LOGSIZE) != LOGSIZE)
+        {
+          printf("nxffsbench: write %s failed: %d\n", path, errno);
+          close(fd);
+          goto errout;
+        }
+
+      close(fd);
+      g_latency[n] = nxffsbench_usec() - start;
+      total += g_latency[n];
+
+      /* Leave some idle time */
+
+#ifdef CONFIG_EXAMPLES_NXFFSBENCH_IDLEPACK
+      /* Pack one step at a time while there is idle time left */
+
+      start = nxffsbench_usec();
+      do
+        {
+          ret = ioctl(packfd, FIOC_PACKSTEP, 0);
+          if (ret < 0)
+            {
+              printf("nxffsbench: FIOC_PACKSTEP failed: %d\n", errno);
+              goto errout;
+            }
+        }
+      while (ret > 0 && nxffsbench_usec() - start < IDLEUSEC);
+#endif
+
+      usleep(IDLEUSEC);
+    }
+
+#ifdef CONFIG_EXAMPLES_NXFFSBENCH_IDLEPACK
+  close(packfd);
+#endif
+  nxffsbench_report("rewrite", total, NREWRITES);
+
+  /* Report the distribution */
+
+  memset(counts, 0, sizeof(counts));
+  for (n = 0; n < NREWRITES; n++)
+    {
+      for (i = 0; i < 4 && g_latency[n] >= limits[i]; i++);
+      counts[i]++;
+    }
+
+  qsort(g_latency, NREWRITES, sizeof(uint32_t), nxffsbench_compare);
+  printf("  rewrite latency usec: p50 %lu p90 %lu p99 %lu max %lu\n",
+         (unsigned long)g_latency[NREWRITES / 2],
+         (unsigned long)g_latency[NREWRITES * 9 / 10],
+         (unsigned long)g_latency[NREWRITES * 99 / 100],
+         (unsigned long)g_latency[NREWRITES - 1]);
+  printf("  rewrites <100us %d <1ms %d <10ms %d <100ms %d >=100ms %d\n",
+         counts[0], counts[1], counts[2], counts[3], counts[4]);
+  return 0;
+
+errout:
+#ifdef CONFIG_EXAMPLES_NXFFSBENCH_IDLEPACK
+  close(packfd);
+#endif
+  return -1;
+}
+
+/* Read back the last version of each log file.  Returns the number of
+ * errors.
+ */
+
+static int nxffsbench_verifylogs(void)
+{
+  char path[32];
+  char data[LOGSIZE];
+  int errors = 0;
+  int fd;
+  int n;
+
+  for (n = NREWRITES - NLOGS; n < NREWRITES; n++)
+    {
+      if (n < 0)
+        {
+          continue;
+        }
+
+      snprintf(path, sizeof(path), LOGNAME, n % NLOGS);
+      memset(g_logdata, 'A' + n % 26, LOGSIZE);
+      snprintf(g_logdata, LOGSIZE, "%08d", n);
+
+      fd = open(path, O_RDONLY);
+      if (fd < 0)
+        {
+          errors++;
+          continue;
+        }
+
+      if (read(fd, data, LOGSIZE) != LOGSIZE ||
+          memcmp(data, g_logdata, LOGSIZE) != 0)
+        {
+          errors++;
+        }
+
+      close(fd);
+    }
+
+  return errors;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffsbench_main
+ ****************************************************************************/
+
+int nxffsbench_main(int argc, char *argv[])
+{
+  FAR struct mtd_dev_s *mtd;
+  uint32_t start;
+  int errors;
+  int ret;
+
+  /* Create a RAM MTD device and provide NXFFS on it */
+
+  mtd = rammtd_initialize(g_simflash, FLASHSIZE);
+  if (!mtd)
+    {
+      printf("nxffsbench: Failed to create the RAM MTD device\n");
+      return EXIT_FAILURE;
+    }
+
+  start = nxffsbench_usec();
+  ret   = nxffs_initialize(mtd);
+  if (ret < 0)
+    {
+      printf("nxffsbench: nxffs_initialize failed: %d\n", -ret);
+      return EXIT_FAILURE;
+    }
+
+  if (mount(NULL, MOUNTPT, "nxffs", 0, NULL) < 0)
+    {
+      printf("nxffsbench: mount failed: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  printf("\nNXFFS benchmark: %d byte FLASH, %d files, inode index: %s, "
+         "packing: %s\n", FLASHSIZE, NFILES, INODEINDEX, PACKING);
+  printf("  %-20s %10s %9s\n", "", "usec", "usec/op");
+  nxffsbench_report("initialize", nxffsbench_usec() - start, 1);
+
+  if (nxffsbench_create() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  errors  = nxffsbench_open("open");
+  errors += nxffsbench_stat();
+
+  if (nxffsbench_pack() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  errors += nxffsbench_open("open after pack");
+
+  if (nxffsbench_rewrite() < 0)
+    {
+      goto errout_with_mount;
+    }
+
+  errors += nxffsbench_verifylogs();
+  errors += nxffsbench_open("open after rewrite");
+  if (errors > 0)
+    {
+      printf("nxffsbench: ERROR: %d files miscompared\n", errors);
+      goto errout_with_mount;
+    }
+
+  printf("  verified\n");
+  (void)umount(MOUNTPT);
+  return EXIT_SUCCESS;
+
+errout_with_mount:
+  (void)umount(MOUNTPT);
+  return EXIT_FAILURE;
+}
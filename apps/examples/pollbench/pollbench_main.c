@@ -0,0 +1,318 @@
+/****************************************************************************
+ * examples/pollbench/pollbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/time.h>
+#include <sys/select.h>
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_POLLBENCH_NPIPES
+#  define CONFIG_EXAMPLES_POLLBENCH_NPIPES 31
+#endif
+
+#ifndef CONFIG_EXAMPLES_POLLBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_POLLBENCH_NLOOPS 1000
+#endif
+
+#define NPIPES      CONFIG_EXAMPLES_POLLBENCH_NPIPES
+#define NLOOPS      CONFIG_EXAMPLES_POLLBENCH_NLOOPS
+#define NEVENTS     4
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A method of waiting for the active pipe */
+
+typedef int (*pollbench_wait_t)(int npipes);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Pipe 0 is the active pipe; the others never have data */
+
+static int g_rdfd[NPIPES + 1];
+static int g_wrfd[NPIPES + 1];
+
+static struct pollfd g_pollset[NPIPES + 1];
+static int g_epfd;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Wait with poll().  The pollfd array is set up once but poll() sets up
+ * and tears down every descriptor on each call.
+ */
+
+static int pollbench_poll(int npipes)
+{
+  int ret = poll(g_pollset, npipes + 1, 1000);
+  return (ret == 1 && g_pollset[0].revents == POLLIN) ? OK : ERROR;
+}
+
+/* Wait with select().  The descriptor set must be rebuilt for each call. */
+
+static int pollbench_select(int npipes)
+{
+  struct timeval tv;
+  fd_set rdset;
+  int maxfd = 0;
+  int ret;
+  int i;
+
+  FD_ZERO(&rdset);
+  for (i = 0; i <= npipes; i++)
+    {
+      FD_SET(g_rdfd[i], &rdset);
+      if (g_rdfd[i] > maxfd)
+        {
+          maxfd = g_rdfd[i];
+        }
+    }
+
+  tv.tv_sec  = 1;
+  tv.tv_usec = 0;
+
+  ret = select(maxfd + 1, &rdset, NULL, NULL, &tv);
+  return (ret == 1 && FD_ISSET(g_rdfd[0], &rdset)) ? OK : ERROR;
+}
+
+/* Wait with epoll_wait() */
+
+static int pollbench_epoll(int npipes)
+{
+  struct epoll_event events[NEVENTS];
+  int ret;
+
+  ret = epoll_wait(g_epfd, events, NEVENTS, 1000);
+  return (ret == 1 && events[0].data.fd == g_rdfd[0] &&
+          events[0].events == EPOLLIN) ? OK : ERROR;
+}
+
+/****************************************************************************
+ * Name: pollbench_run
+ *
+ * Description:
+ *   Make the active pipe readable, wait for it with the given method, and
+ *   empty it again, NLOOPS times.  Return the average time of one wait, or
+ *   0 on failure.
+ *
+ ****************************************************************************/
+
+static uint32_t pollbench_run(pollbench_wait_t waitfn, int npipes)
+{
+  uint32_t elapsed = 0;
+  uint32_t start;
+  char ch = 0;
+  int i;
+
+  for (i = 0; i < NLOOPS; i++)
+    {
+      if (write(g_wrfd[0], &ch, 1) != 1)
+        {
+          printf("pollbench: write failed: %d\n", errno);
+          return 0;
+        }
+
+      start = benchtime_now();
+      if (waitfn(npipes) != OK)
+        {
+          printf("pollbench: wait %d with %d pipes failed\n", i, npipes);
+          return 0;
+        }
+
+      elapsed += benchtime_now() - start;
+
+      if (read(g_rdfd[0], &ch, 1) != 1)
+        {
+          printf("pollbench: read failed: %d\n", errno);
+          return 0;
+        }
+    }
+
+  return elapsed / NLOOPS;
+}
+
+/****************************************************************************
+ * Name: pollbench_epollset
+ *
+ * Description:
+ *   Create the epoll interest set with the read ends of the active pipe
+ *   and of 'npipes' idle pipes.
+ *
+ ****************************************************************************/
+
+static int pollbench_epollset(int npipes, uint32_t mode)
+{
+  struct epoll_event ev;
+  int i;
+
+  g_epfd = epoll_create(npipes + 1);
+  if (g_epfd < 0)
+    {
+      printf("pollbench: epoll_create failed: %d\n", errno);
+      return ERROR;
+    }
+
+  for (i = 0; i <= npipes; i++)
+    {
+      ev.events  = EPOLLIN | mode;
+      ev.data.fd = g_rdfd[i];
+      if (epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_rdfd[i], &ev) < 0)
+        {
+          printf("pollbench: epoll_ctl failed: %d\n", errno);
+          close(g_epfd);
+          return ERROR;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * pollbench_main
+ ****************************************************************************/
+
+int pollbench_main(int argc, char *argv[])
+{
+  uint32_t tpoll;
+  uint32_t tselect;
+  uint32_t tlevel;
+  uint32_t tedge;
+  int npipes;
+  int maxpipes;
+  int fd[2];
+  int i;
+
+  benchtime_initialize();
+
+  /* Create the active pipe and as many idle pipes as possible */
+
+  for (maxpipes = -1; maxpipes < NPIPES; maxpipes++)
+    {
+      if (pipe(fd) < 0)
+        {
+          break;
+        }
+
+      g_rdfd[maxpipes + 1] = fd[0];
+      g_wrfd[maxpipes + 1] = fd[1];
+
+      g_pollset[maxpipes + 1].fd     = fd[0];
+      g_pollset[maxpipes + 1].events = POLLIN;
+    }
+
+  if (maxpipes < 0)
+    {
+      printf("pollbench: pipe failed: %d\n", errno);
+      return EXIT_FAILURE;
+    }
+
+  if (maxpipes < NPIPES)
+    {
+      printf("pollbench: Could only create %d idle pipes\n", maxpipes);
+    }
+
+  printf("\nWait for 1 of N+1 pipes, times in %s:\n", BENCHTIME_UNITS);
+  printf("  %6s  %8s  %8s  %8s  %8s\n",
+         "N", "poll", "select", "epoll", "epollet");
+
+  for (npipes = 0; ; npipes = npipes ? npipes << 1 : 1)
+    {
+      if (npipes > maxpipes)
+        {
+          npipes = maxpipes;
+        }
+
+      tpoll   = pollbench_run(pollbench_poll, npipes);
+      tselect = pollbench_run(pollbench_select, npipes);
+
+      tlevel = 0;
+      if (pollbench_epollset(npipes, 0) == OK)
+        {
+          tlevel = pollbench_run(pollbench_epoll, npipes);
+          close(g_epfd);
+        }
+
+      tedge = 0;
+      if (pollbench_epollset(npipes, EPOLLET) == OK)
+        {
+          tedge = pollbench_run(pollbench_epoll, npipes);
+          close(g_epfd);
+        }
+
+      printf("  %6d  %8lu  %8lu  %8lu  %8lu\n", npipes,
+             (unsigned long)tpoll, (unsigned long)tselect,
+             (unsigned long)tlevel, (unsigned long)tedge);
+
+      if (npipes == maxpipes)
+        {
+          break;
+        }
+    }
+
+  for (i = 0; i <= maxpipes; i++)
+    {
+      close(g_rdfd[i]);
+      close(g_wrfd[i]);
+    }
+
+  return EXIT_SUCCESS;
+}
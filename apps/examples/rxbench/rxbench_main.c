@@ -0,0 +1,529 @@
+/****************************************************************************
+ * examples/rxbench/rxbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include <nuttx/net/uip/uip.h>
+#include <nuttx/net/uip/uip-arch.h>
+#include <nuttx/net/iob.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_RXBENCH_NPACKETS
+#  define CONFIG_EXAMPLES_RXBENCH_NPACKETS 16
+#endif
+
+#ifndef CONFIG_EXAMPLES_RXBENCH_PKTSIZE
+#  define CONFIG_EXAMPLES_RXBENCH_PKTSIZE 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_RXBENCH_READSIZE
+#  define CONFIG_EXAMPLES_RXBENCH_READSIZE 100
+#endif
+
+#define NPACKETS    CONFIG_EXAMPLES_RXBENCH_NPACKETS
+#define PKTSIZE     CONFIG_EXAMPLES_RXBENCH_PKTSIZE
+#define READSIZE    CONFIG_EXAMPLES_RXBENCH_READSIZE
+
+#if UIP_LLH_LEN + UIP_IPTCPH_LEN + PKTSIZE > CONFIG_NET_BUFSIZE
+#  error "CONFIG_EXAMPLES_RXBENCH_PKTSIZE does not fit in CONFIG_NET_BUFSIZE"
+#endif
+
+/* The packets appear to come from REMOTE_PORT on 10.0.0.2 and are sent to
+ * 10.0.0.1.
+ */
+
+#define LOCAL_IPADDR  HTONL(0x0a000001)
+#define REMOTE_IPADDR HTONL(0x0a000002)
+#define REMOTE_PORT   20000
+#define TCP_PORT      5473
+#define UDP_PORT      5474
+
+#define TCPBUF ((struct uip_tcpip_hdr *)&g_dev.d_buf[UIP_LLH_LEN])
+#define UDPBUF ((struct uip_udpip_hdr *)&g_dev.d_buf[UIP_LLH_LEN])
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The packets are passed to uIP through this device structure, which is
+ * not registered with the network.  Responses are left in its buffer.
+ */
+
+static struct uip_driver_s g_dev;
+#ifdef CONFIG_NET_MULTIBUFFER
+static uint8_t g_pktbuf[CONFIG_NET_BUFSIZE + CONFIG_NET_GUARDSIZE];
+#endif
+
+/* The receive buffer */
+
+static uint8_t g_rxbuf[PKTSIZE];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void rxbench_put32(FAR uint8_t *dest, uint32_t value)
+{
+  dest[0] = value >> 24;
+  dest[1] = value >> 16;
+  dest[2] = value >> 8;
+  dest[3] = value;
+}
+
+static uint32_t rxbench_get32(FAR const uint8_t *src)
+{
+  return (uint32_t)src[0] << 24 | (uint32_t)src[1] << 16 |
+         (uint32_t)src[2] << 8 | (uint32_t)src[3];
+}
+
+/* The value of byte 'ndx' of the TCP stream or of UDP datagram 'ndx' */
+
+static inline uint8_t rxbench_byte(uint32_t ndx)
+{
+  return (uint8_t)(ndx ^ (ndx >> 8) ^ 0x5a);
+}
+
+/****************************************************************************
+ * Name: rxbench_tcppacket and rxbench_udppacket
+ *
+ * Description:
+ *   Build a TCP segment that carries 'len' bytes of the stream beginning
+ *   at stream offset 'seqno' - 1, or UDP datagram 'ndx', in the device
+ *   buffer.
+ *
+ ****************************************************************************/
+
+static void rxbench_tcppacket(uint32_t seqno, uint32_t ackno, uint8_t flags,
+                              int len)
+{
+  FAR struct uip_tcpip_hdr *pbuf = TCPBUF;
+  FAR uint8_t *data = (FAR uint8_t *)pbuf + UIP_IPTCPH_LEN;
+  in_addr_t srcipaddr  = REMOTE_IPADDR;
+  in_addr_t destipaddr = LOCAL_IPADDR;
+  int i;
+
+  memset(pbuf, 0, UIP_IPTCPH_LEN);
+  pbuf->vhl         = 0x45;
+  pbuf->len[0]      = (UIP_IPTCPH_LEN + len) >> 8;
+  pbuf->len[1]      = (UIP_IPTCPH_LEN + len) & 0xff;
+  pbuf->ttl         = 64;
+  pbuf->proto       = UIP_PROTO_TCP;
+  memcpy(pbuf->srcipaddr, &srcipaddr, sizeof(in_addr_t));
+  memcpy(pbuf->destipaddr, &destipaddr, sizeof(in_addr_t));
+  pbuf->ipchksum    = ~(uip_ipchksum(&g_dev));
+
+  for (i = 0; i < len; i++)
+    {
+      data[i] = rxbench_byte(seqno - 1 + i);
+    }
+
+  pbuf->srcport     = HTONS(REMOTE_PORT);
+  pbuf->destport    = HTONS(TCP_PORT);
+  rxbench_put32(pbuf->seqno, seqno);
+  rxbench_put32(pbuf->ackno, ackno);
+  pbuf->tcpoffset   = (UIP_TCPH_LEN / 4) << 4;
+  pbuf->flags       = flags;
+  pbuf->wnd[0]      = CONFIG_NET_RECEIVE_WINDOW >> 8;
+  pbuf->wnd[1]      = CONFIG_NET_RECEIVE_WINDOW & 0xff;
+  pbuf->tcpchksum   = ~(uip_tcpchksum(&g_dev));
+
+  g_dev.d_len       = UIP_LLH_LEN + UIP_IPTCPH_LEN + len;
+}
+
+static void rxbench_udppacket(int ndx)
+{
+  FAR struct uip_udpip_hdr *pbuf = UDPBUF;
+  FAR uint8_t *data = (FAR uint8_t *)pbuf + UIP_IPUDPH_LEN;
+  in_addr_t srcipaddr  = REMOTE_IPADDR;
+  in_addr_t destipaddr = LOCAL_IPADDR;
+
+  memset(pbuf, 0, UIP_IPUDPH_LEN);
+  pbuf->vhl         = 0x45;
+  pbuf->len[0]      = (UIP_IPUDPH_LEN + PKTSIZE) >> 8;
+  pbuf->len[1]      = (UIP_IPUDPH_LEN + PKTSIZE) & 0xff;
+  pbuf->ttl         = 64;
+  pbuf->proto       = UIP_PROTO_UDP;
+  memcpy(pbuf->srcipaddr, &srcipaddr, sizeof(in_addr_t));
+  memcpy(pbuf->destipaddr, &destipaddr, sizeof(in_addr_t));
+  pbuf->ipchksum    = ~(uip_ipchksum(&g_dev));
+
+  memset(data, rxbench_byte(ndx), PKTSIZE);
+
+  /* A zero UDP checksum means that there is no checksum */
+
+  pbuf->srcport     = HTONS(REMOTE_PORT);
+  pbuf->destport    = HTONS(UDP_PORT);
+  pbuf->udplen      = HTONS(UIP_UDPH_LEN + PKTSIZE);
+
+  g_dev.d_len       = UIP_LLH_LEN + UIP_IPUDPH_LEN + PKTSIZE;
+}
+
+/****************************************************************************
+ * Name: rxbench_input
+ *
+ * Description:
+ *   Pass the packet in the device buffer to uIP as a network driver would
+ *   and return the time that uip_input() took.  With CONFIG_NET_IOB, the
+ *   packet is first copied into a chain of I/O buffers, as if the driver
+ *   had received it there, and passed to uIP with uip_iobreceive().  The
+ *   time then includes uip_iobreceive() and uip_iobrelease().
+ *
+ ****************************************************************************/
+
+static uint32_t rxbench_input(void)
+{
+  uip_lock_t flags;
+  uint32_t start;
+  uint32_t elapsed;
+#ifdef CONFIG_NET_IOB
+  FAR struct iob_s *iob;
+
+  iob = iob_alloc();
+  if (iob && iob_copyin(iob, g_dev.d_buf, g_dev.d_len, 0) < 0)
+    {
+      iob_free_chain(iob);
+      iob = NULL;
+    }
+#endif
+
+  flags   = uip_lock();
+  start   = benchtime_now();
+#ifdef CONFIG_NET_IOB
+  if (iob && uip_iobreceive(&g_dev, iob) < 0)
+    {
+      iob_free_chain(iob);
+    }
+#endif
+  uip_input(&g_dev);
+#ifdef CONFIG_NET_IOB
+  uip_iobrelease(&g_dev);
+#endif
+  elapsed = benchtime_now() - start;
+  uip_unlock(flags);
+
+  return elapsed;
+}
+
+/****************************************************************************
+ * Name: rxbench_settimeout
+ *
+ * Description:
+ *   Make recv() on the socket give up after 200 milliseconds so that the
+ *   benchmark can tell when everything that was buffered has been read.
+ *
+ ****************************************************************************/
+
+static int rxbench_settimeout(int sd)
+{
+  struct timeval tv;
+
+  tv.tv_sec  = 0;
+  tv.tv_usec = 200*1000;
+
+  if (setsockopt(sd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0)
+    {
+      printf("rxbench: setsockopt failed: %d\n", errno);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rxbench_udp
+ *
+ * Description:
+ *   Send NPACKETS datagrams to a bound UDP socket while no one is receiving
+ *   and then read back as many as were kept.
+ *
+ ****************************************************************************/
+
+static int rxbench_udp(void)
+{
+  struct sockaddr_in addr;
+  uint32_t tinput = 0;
+  uint32_t trecv  = 0;
+  uint32_t start;
+  ssize_t nbytes;
+  int nrecvd;
+  int sd;
+  int i;
+
+  sd = socket(PF_INET, SOCK_DGRAM, 0);
+  if (sd < 0)
+    {
+      printf("rxbench: socket failed: %d\n", errno);
+      return ERROR;
+    }
+
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = HTONS(UDP_PORT);
+  addr.sin_addr.s_addr = HTONL(INADDR_ANY);
+
+  if (bind(sd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      rxbench_settimeout(sd) < 0)
+    {
+      printf("rxbench: bind failed: %d\n", errno);
+      close(sd);
+      return ERROR;
+    }
+
+  /* Send the burst of datagrams */
+
+  for (i = 0; i < NPACKETS; i++)
+    {
+      rxbench_udppacket(i);
+      tinput += rxbench_input();
+    }
+
+  /* Then read back everything that was kept.  The datagrams must arrive in
+   * order, but some may have been dropped.
+   */
+
+  for (nrecvd = 0, i = 0; ; nrecvd++, i++)
+    {
+      start  = benchtime_now();
+      nbytes = recv(sd, g_rxbuf, PKTSIZE, 0);
+      if (nbytes < 0)
+        {
+          break;
+        }
+
+      trecv += benchtime_now() - start;
+
+      while (i < NPACKETS && g_rxbuf[0] != rxbench_byte(i))
+        {
+          i++;
+        }
+
+      if (nbytes != PKTSIZE || i >= NPACKETS ||
+          g_rxbuf[PKTSIZE-1] != rxbench_byte(i))
+        {
+          printf("rxbench: UDP datagram %d is bad\n", nrecvd);
+          close(sd);
+          return ERROR;
+        }
+    }
+
+  printf("  UDP: %2d of %2d datagrams received, uip_input %6lu, "
+         "recv %6lu\n", nrecvd, NPACKETS, (unsigned long)(tinput / NPACKETS),
+         nrecvd ? (unsigned long)(trecv / nrecvd) : 0ul);
+
+  close(sd);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rxbench_tcp
+ *
+ * Description:
+ *   Open a TCP connection, send NPACKETS segments while no one is receiving,
+ *   and then read back everything that was acknowledged, READSIZE bytes
+ *   at a time.
+ *
+ ****************************************************************************/
+
+static int rxbench_tcp(void)
+{
+  struct sockaddr_in addr;
+  uint32_t tinput = 0;
+  uint32_t trecv  = 0;
+  uint32_t seqno;
+  uint32_t ackno;
+  uint32_t start;
+  ssize_t nbytes;
+  size_t total;
+  size_t acked;
+  int ncalls;
+  int nacked;
+  int listensd;
+  int sd;
+  int ret = ERROR;
+  int i;
+
+  listensd = socket(PF_INET, SOCK_STREAM, 0);
+  if (listensd < 0)
+    {
+      printf("rxbench: socket failed: %d\n", errno);
+      return ERROR;
+    }
+
+  addr.sin_family      = AF_INET;
+  addr.sin_port        = HTONS(TCP_PORT);
+  addr.sin_addr.s_addr = HTONL(INADDR_ANY);
+
+  if (bind(listensd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+      listen(listensd, 1) < 0)
+    {
+      printf("rxbench: bind/listen failed: %d\n", errno);
+      goto errout_with_listensd;
+    }
+
+  /* Open the connection.  It waits in the listen backlog until accept() */
+
+  rxbench_tcppacket(0, 0, TCP_SYN, 0);
+  (void)rxbench_input();
+
+  if (g_dev.d_len == 0 || TCPBUF->flags != (TCP_SYN | TCP_ACK))
+    {
+      printf("rxbench: TCP connection was not accepted\n");
+      goto errout_with_listensd;
+    }
+
+  ackno = rxbench_get32(TCPBUF->seqno) + 1;
+  rxbench_tcppacket(1, ackno, TCP_ACK, 0);
+  (void)rxbench_input();
+
+  sd = accept(listensd, NULL, NULL);
+  if (sd < 0 || rxbench_settimeout(sd) < 0)
+    {
+      printf("rxbench: accept failed: %d\n", errno);
+      goto errout_with_listensd;
+    }
+
+  /* Send the burst of segments.  A segment that cannot be buffered is not
+   * acknowledged, and every segment after it is then out of order.
+   */
+
+  seqno = 1;
+  for (nacked = 0, i = 0; i < NPACKETS; i++)
+    {
+      rxbench_tcppacket(seqno, ackno, TCP_ACK | TCP_PSH, PKTSIZE);
+      tinput += rxbench_input();
+
+      if (g_dev.d_len > 0 &&
+          rxbench_get32(TCPBUF->ackno) == seqno + PKTSIZE)
+        {
+          seqno += PKTSIZE;
+          nacked++;
+        }
+    }
+
+  /* Then read back all of the acknowledged data */
+
+  acked = nacked * PKTSIZE;
+  for (total = 0, ncalls = 0; total < acked; ncalls++)
+    {
+      start  = benchtime_now();
+      nbytes = recv(sd, g_rxbuf, READSIZE, 0);
+      if (nbytes <= 0)
+        {
+          printf("rxbench: recv failed after %lu bytes: %d\n",
+                 (unsigned long)total, errno);
+          goto errout_with_sd;
+        }
+
+      trecv += benchtime_now() - start;
+
+      for (i = 0; i < nbytes; i++)
+        {
+          if (g_rxbuf[i] != rxbench_byte(total + i))
+            {
+              printf("rxbench: TCP data is bad at offset %lu\n",
+                     (unsigned long)(total + i));
+              goto errout_with_sd;
+            }
+        }
+
+      total += nbytes;
+    }
+
+  printf("  TCP: %2d of %2d segments received,   uip_input %6lu, "
+         "recv %6lu\n", nacked, NPACKETS, (unsigned long)(tinput / NPACKETS),
+         ncalls ? (unsigned long)(trecv / ncalls) : 0ul);
+  ret = OK;
+
+errout_with_sd:
+
+  /* Reset the connection so that close() does not wait for the peer */
+
+  rxbench_tcppacket(seqno, ackno, TCP_RST | TCP_ACK, 0);
+  (void)rxbench_input();
+  close(sd);
+
+errout_with_listensd:
+  close(listensd);
+  return ret;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * rxbench_main
+ ****************************************************************************/
+
+int rxbench_main(int argc, char *argv[])
+{
+  benchtime_initialize();
+
+#ifdef CONFIG_NET_MULTIBUFFER
+  g_dev.d_buf    = g_pktbuf;
+#endif
+  g_dev.d_ipaddr = LOCAL_IPADDR;
+
+  printf("\nBursts of %d packets of %d bytes, times per call in %s:\n",
+         NPACKETS, PKTSIZE, BENCHTIME_UNITS);
+
+  if (rxbench_udp() != OK || rxbench_tcp() != OK)
+    {
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
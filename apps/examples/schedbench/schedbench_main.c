@@ -0,0 +1,329 @@
+/****************************************************************************
+ * examples/schedbench/schedbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sched.h>
+#include <semaphore.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SCHEDBENCH_NTASKS
+#  define CONFIG_EXAMPLES_SCHEDBENCH_NTASKS 32
+#endif
+
+#ifndef CONFIG_EXAMPLES_SCHEDBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_SCHEDBENCH_NLOOPS 1000
+#endif
+
+#ifndef CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY
+#  define CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY 100
+#endif
+
+#ifndef CONFIG_EXAMPLES_SCHEDBENCH_STACKSIZE
+#  define CONFIG_EXAMPLES_SCHEDBENCH_STACKSIZE 2048
+#endif
+
+#define NTASKS        CONFIG_EXAMPLES_SCHEDBENCH_NTASKS
+#define NLOOPS        CONFIG_EXAMPLES_SCHEDBENCH_NLOOPS
+#define STACKSIZE     CONFIG_EXAMPLES_SCHEDBENCH_STACKSIZE
+
+/* The yielding tasks run at the lowest priority so that they only run when
+ * the benchmark waits for them.  The awakened task runs above the benchmark
+ * so that it preempts the benchmark as soon as it is awakened, and the
+ * waiting tasks run above the awakened task so that they stand in front of
+ * it in the list of tasks waiting for a semaphore.
+ */
+
+#define YIELD_PRIORITY  CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY
+#define MAIN_PRIORITY   (CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY + 10)
+#define WAKE_PRIORITY   (CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY + 20)
+#define WAIT_PRIORITY   (CONFIG_EXAMPLES_SCHEDBENCH_PRIORITY + 30)
+
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+#  define LIST_NAME "priority bitmap"
+#else
+#  define LIST_NAME "list search"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static sem_t g_startsem;           /* Releases the yielding tasks */
+static sem_t g_donesem;            /* Posted by each task when it is done */
+static sem_t g_waitsem;            /* The waiting tasks wait here */
+static sem_t g_wakesem;            /* The awakened task waits here */
+
+static volatile uint32_t g_posttime;  /* Time stamp taken before sem_post() */
+static uint32_t g_latency;            /* Sum of the wake-up latencies */
+static uint32_t g_maxlatency;         /* Largest wake-up latency */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* The yielding task.  All of the yielding tasks have the same priority so
+ * that each sched_yield() puts the caller behind all of the others.
+ */
+
+static int schedbench_yielder(int argc, char *argv[])
+{
+  int i;
+
+  while (sem_wait(&g_startsem) < 0);
+
+  for (i = 0; i < NLOOPS; i++)
+    {
+      (void)sched_yield();
+    }
+
+  sem_post(&g_donesem);
+  return 0;
+}
+
+/* The waiting task.  It waits until the end of the measurement. */
+
+static int schedbench_waiter(int argc, char *argv[])
+{
+  while (sem_wait(&g_waitsem) < 0);
+  return 0;
+}
+
+/* The awakened task.  It measures the time since the benchmark posted the
+ * semaphore, then waits again behind all of the waiting tasks.
+ */
+
+static int schedbench_wakee(int argc, char *argv[])
+{
+  uint32_t elapsed;
+  int i;
+
+  for (i = 0; i < NLOOPS; i++)
+    {
+      while (sem_wait(&g_wakesem) < 0);
+
+      elapsed = benchtime_now() - g_posttime;
+      g_latency += elapsed;
+      if (elapsed > g_maxlatency)
+        {
+          g_maxlatency = elapsed;
+        }
+    }
+
+  sem_post(&g_donesem);
+  return 0;
+}
+
+static int schedbench_create(FAR const char *name, int priority,
+                             main_t entry)
+{
+  int pid = TASK_CREATE(name, priority, STACKSIZE, entry, NULL);
+  if (pid < 0)
+    {
+      printf("schedbench: Failed to create %s; increase "
+             "CONFIG_MAX_TASKS\n", name);
+    }
+
+  return pid;
+}
+
+/****************************************************************************
+ * Name: schedbench_yield
+ *
+ * Description:
+ *   Return the average time taken by one sched_yield() with 'ntasks'
+ *   ready-to-run tasks of the same priority.
+ *
+ ****************************************************************************/
+
+static int schedbench_yield(int ntasks, FAR uint32_t *average)
+{
+  uint32_t start;
+  int i;
+
+  for (i = 0; i < ntasks; i++)
+    {
+      if (schedbench_create("yielder", YIELD_PRIORITY,
+                            schedbench_yielder) < 0)
+        {
+          return -1;
+        }
+    }
+
+  /* The tasks run when this task waits for them */
+
+  start = benchtime_now();
+  for (i = 0; i < ntasks; i++)
+    {
+      sem_post(&g_startsem);
+    }
+
+  for (i = 0; i < ntasks; i++)
+    {
+      while (sem_wait(&g_donesem) < 0);
+    }
+
+  *average = (benchtime_now() - start) / (ntasks * NLOOPS);
+  return 0;
+}
+
+/****************************************************************************
+ * Name: schedbench_wakeup
+ *
+ * Description:
+ *   Wake up a higher priority task with sem_post() while 'ntasks' tasks of
+ *   even higher priority wait for a semaphore.  Return the average time
+ *   until the awakened task runs and the average time until the awakened
+ *   task has waited again and this task runs again.
+ *
+ ****************************************************************************/
+
+static int schedbench_wakeup(int ntasks, FAR uint32_t *average,
+                             FAR uint32_t *roundtrip)
+{
+  uint32_t start;
+  int i;
+
+  /* The waiting tasks run and wait as soon as they are created */
+
+  for (i = 0; i < ntasks; i++)
+    {
+      if (schedbench_create("waiter", WAIT_PRIORITY, schedbench_waiter) < 0)
+        {
+          return -1;
+        }
+    }
+
+  g_latency    = 0;
+  g_maxlatency = 0;
+
+  if (schedbench_create("wakee", WAKE_PRIORITY, schedbench_wakee) < 0)
+    {
+      return -1;
+    }
+
+  start = benchtime_now();
+  for (i = 0; i < NLOOPS; i++)
+    {
+      g_posttime = benchtime_now();
+      sem_post(&g_wakesem);
+    }
+
+  *roundtrip = (benchtime_now() - start) / NLOOPS;
+  *average   = g_latency / NLOOPS;
+
+  /* Release the waiting tasks */
+
+  while (sem_wait(&g_donesem) < 0);
+  for (i = 0; i < ntasks; i++)
+    {
+      sem_post(&g_waitsem);
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * schedbench_main
+ ****************************************************************************/
+
+int schedbench_main(int argc, char *argv[])
+{
+  struct sched_param param;
+  uint32_t yield;
+  uint32_t wakeup;
+  uint32_t roundtrip;
+  int ntasks;
+
+  benchtime_initialize();
+
+  sem_init(&g_startsem, 0, 0);
+  sem_init(&g_donesem, 0, 0);
+  sem_init(&g_waitsem, 0, 0);
+  sem_init(&g_wakesem, 0, 0);
+
+  param.sched_priority = MAIN_PRIORITY;
+  if (sched_setparam(0, &param) < 0)
+    {
+      printf("schedbench: sched_setparam failed\n");
+      return EXIT_FAILURE;
+    }
+
+  printf("\nScheduler benchmark (%s), times in %s:\n",
+         LIST_NAME, BENCHTIME_UNITS);
+  printf("  %6s  %8s  %8s %8s  %9s\n",
+         "tasks", "yield", "wakeup", "max", "roundtrip");
+
+  for (ntasks = 1; ntasks <= NTASKS; ntasks <<= 1)
+    {
+      if (schedbench_yield(ntasks, &yield) < 0 ||
+          schedbench_wakeup(ntasks, &wakeup, &roundtrip) < 0)
+        {
+          break;
+        }
+
+      printf("  %6d  %8lu  %8lu %8lu  %9lu\n", ntasks,
+             (unsigned long)yield, (unsigned long)wakeup,
+             (unsigned long)g_maxlatency, (unsigned long)roundtrip);
+
+      /* Let the lower priority tasks that have finished exit */
+
+      usleep(100*1000);
+    }
+
+  sem_destroy(&g_startsem);
+  sem_destroy(&g_donesem);
+  sem_destroy(&g_waitsem);
+  sem_destroy(&g_wakesem);
+  return EXIT_SUCCESS;
+}
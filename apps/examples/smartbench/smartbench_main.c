@@ -0,0 +1,584 @@
+/****************************************************************************
+ * examples/smartbench/smartbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/mtd.h>
+#include <nuttx/smart.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/ioctl.h>
+
+#ifdef CONFIG_ARCH_SIM
+#  include <arch/arch.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* This must exactly match the default configuration in drivers/mtd/rammtd.c */
+
+#ifndef CONFIG_RAMMTD_ERASESIZE
+#  define CONFIG_RAMMTD_ERASESIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS
+#  define CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_NWRITES
+#  define CONFIG_EXAMPLES_SMARTBENCH_NWRITES 5000
+#endif
+
+#ifndef CONFIG_EXAMPLES_SMARTBENCH_MINOR
+#  define CONFIG_EXAMPLES_SMARTBENCH_MINOR 1
+#endif
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+#  define FREEMAP "yes"
+#else
+#  define FREEMAP "no"
+#endif
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+#  define WEARLEVEL "yes"
+#else
+#  define WEARLEVEL "no"
+#endif
+
+#define NEBLOCKS    CONFIG_EXAMPLES_SMARTBENCH_NEBLOCKS
+#define FLASHSIZE   (CONFIG_RAMMTD_ERASESIZE * NEBLOCKS)
+#define NWRITES     CONFIG_EXAMPLES_SMARTBENCH_NWRITES
+
+#define MINOR       CONFIG_EXAMPLES_SMARTBENCH_MINOR
+#define DEVFORMAT   "/dev/smart%d"
+
+/* One half of the sectors is written once and never again (cold data) and
+ * one sector in HOTDIV is rewritten over and over (hot data).
+ */
+
+#define COLDDIV     2
+#define HOTDIV      16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The benchmark MTD sits between SMART and the RAM MTD driver and counts
+ * the operations that SMART performs on the FLASH.
+ */
+
+struct smartbench_mtd_s
+{
+  struct mtd_dev_s mtd;          /* Our MTD interface (must be first) */
+  FAR struct mtd_dev_s *lower;   /* The RAM MTD driver */
+  uint32_t nreads;               /* Number of read and bread calls */
+  uint32_t nwrites;              /* Number of write and bwrite calls */
+  uint32_t nerases;              /* Number of erase blocks erased */
+  uint32_t erasecount[NEBLOCKS]; /* Number of erases per erase block */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t g_simflash[FLASHSIZE];
+static struct smartbench_mtd_s g_benchmtd;
+
+static struct smart_format_s g_fmt;
+static FAR uint16_t *g_sectors;      /* The logical sectors written */
+static FAR uint16_t *g_generation;   /* The number of rewrites of each */
+static FAR uint8_t *g_buffer;
+static FAR uint8_t *g_expect;
+static int g_ncold;                  /* The first g_ncold sectors are cold */
+static int g_nhot;                   /* The next g_nhot sectors are hot */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Microsecond time stamps.  On the simulator, use the host's clock so that
+ * the result does not depend on the simulated timer.
+ */
+
+static uint32_t smartbench_usec(void)
+{
+#ifdef CONFIG_ARCH_SIM
+  return (uint32_t)(up_hostnsec() / 1000);
+#else
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_REALTIME, &ts);
+  return (uint32_t)ts.tv_sec * 1000000 + (uint32_t)ts.tv_nsec / 1000;
+#endif
+}
+
+/* The counting MTD methods */
+
+static int smartbench_erase(FAR struct mtd_dev_s *dev, off_t startblock,
+                            size_t nblocks)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+  size_t i;
+
+  for (i = 0; i < nblocks && startblock + i < NEBLOCKS; i++)
+    {
+      priv->erasecount[startblock + i]++;
+    }
+
+  priv->nerases += nblocks;
+  return MTD_ERASE(priv->lower, startblock, nblocks);
+}
+
+static ssize_t smartbench_bread(FAR struct mtd_dev_s *dev, off_t startblock,
+                                size_t nblocks, FAR uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+
+  priv->nreads++;
+  return MTD_BREAD(priv->lower, startblock, nblocks, buffer);
+}
+
+static ssize_t smartbench_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
+                                 size_t nblocks, FAR const uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+
+  priv->nwrites++;
+  return MTD_BWRITE(priv->lower, startblock, nblocks, buffer);
+}
+
+static ssize_t smartbench_read(FAR struct mtd_dev_s *dev, off_t offset,
+                               size_t nbytes, FAR uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+
+  priv->nreads++;
+  return MTD_READ(priv->lower, offset, nbytes, buffer);
+}
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+static ssize_t smartbench_write(FAR struct mtd_dev_s *dev, off_t offset,
+                                size_t nbytes, FAR const uint8_t *buffer)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+
+  priv->nwrites++;
+  return priv->lower->write(priv->lower, offset, nbytes, buffer);
+}
+#endif
+
+static int smartbench_ioctl(FAR struct mtd_dev_s *dev, int cmd,
+                            unsigned long arg)
+{
+  FAR struct smartbench_mtd_s *priv = (FAR struct smartbench_mtd_s *)dev;
+
+  return MTD_IOCTL(priv->lower, cmd, arg);
+}
+
+/* Reset the operation counters */
+
+static void smartbench_reset(void)
+{
+  g_benchmtd.nreads  = 0;
+  g_benchmtd.nwrites = 0;
+  g_benchmtd.nerases = 0;
+  memset(g_benchmtd.erasecount, 0, sizeof(g_benchmtd.erasecount));
+}
+
+/* The content of a sector.  The pattern depends on the generation so that
+ * every rewrite has to clear bits that were programmed before and the
+ * sector has to be relocated.
+ */
+
+static void smartbench_data(FAR uint8_t *data, int len, int sector,
+                            int generation)
+{
+  int i;
+
+  for (i = 0; i < len; i++)
+    {
+      data[i] = (uint8_t)(sector * 7 + generation * 13 + i);
+    }
+}
+
+static void smartbench_erasereport(void)
+{
+  uint32_t minerase = UINT32_MAX;
+  uint32_t maxerase = 0;
+  uint32_t total = 0;
+  uint32_t hist[5];
+  uint32_t count;
+  int i;
+
+  for (i = 0; i < NEBLOCKS; i++)
+    {
+      count = g_benchmtd.erasecount[i];
+      total += count;
+      if (count < minerase)
+        {
+          minerase = count;
+        }
+
+      if (count > maxerase)
+        {
+          maxerase = count;
+        }
+    }
+
+  /* Show how the blocks are spread between the least and the most erased
+   * block in five bins.
+   */
+
+  memset(hist, 0, sizeof(hist));
+  for (i = 0; i < NEBLOCKS; i++)
+    {
+      count = g_benchmtd.erasecount[i];
+      if (maxerase > minerase)
+        {
+          hist[(count - minerase) * 4 / (maxerase - minerase)]++;
+        }
+      else
+        {
+          hist[0]++;
+        }
+    }
+
+  printf("  Erases:              %10lu\n", (unsigned long)total);
+  printf("  Erases per block:    %10lu min %lu max %lu.%02lu mean\n",
+         (unsigned long)minerase, (unsigned long)maxerase,
+         (unsigned long)(total / NEBLOCKS),
+         (unsigned long)((total % NEBLOCKS) * 100 / NEBLOCKS));
+  printf("  Blocks by erases:    %lu %lu %lu %lu %lu (min..max)\n",
+         (unsigned long)hist[0], (unsigned long)hist[1],
+         (unsigned long)hist[2], (unsigned long)hist[3],
+         (unsigned long)hist[4]);
+}
+
+/* Rewrite randomly selected hot sectors */
+
+static int smartbench_rewrite(FAR struct inode *inode, int nwrites,
+                              FAR uint32_t *elapsed)
+{
+  struct smart_read_write_s req;
+  uint32_t start;
+  int ret;
+  int i;
+  int n;
+
+  *elapsed = 0;
+  for (n = 0; n < nwrites; n++)
+    {
+      i = g_ncold + rand() % g_nhot;
+      g_generation[i]++;
+
+      smartbench_data(g_buffer, g_fmt.availbytes, g_sectors[i],
+                      g_generation[i]);
+      req.logsector = g_sectors[i];
+      req.offset    = 0;
+      req.count     = g_fmt.availbytes;
+      req.buffer    = g_buffer;
+
+      start = smartbench_usec();
+      ret = inode->u.i_bops->ioctl(inode, BIOC_WRITESECT,
+                                   (unsigned long)&req);
+      *elapsed += smartbench_usec() - start;
+
+      if (ret < 0)
+        {
+          printf("smartbench: Failed to rewrite sector %d: %d\n",
+                 g_sectors[i], ret);
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/* Verify every sector, including the cold sectors that may have been moved
+ * by the garbage collection or by wear leveling.
+ */
+
+static int smartbench_verify(FAR struct inode *inode)
+{
+  struct smart_read_write_s req;
+  int ret;
+  int i;
+
+  for (i = 0; i < g_ncold + g_nhot; i++)
+    {
+      smartbench_data(g_expect, g_fmt.availbytes, g_sectors[i],
+                      g_generation[i]);
+      memset(g_buffer, 0, g_fmt.availbytes);
+      req.logsector = g_sectors[i];
+      req.offset    = 0;
+      req.count     = g_fmt.availbytes;
+      req.buffer    = g_buffer;
+
+      ret = inode->u.i_bops->ioctl(inode, BIOC_READSECT,
+                                   (unsigned long)&req);
+      if (ret < 0 || memcmp(g_buffer, g_expect, g_fmt.availbytes) != 0)
+        {
+          printf("smartbench: ERROR: sector %d miscompares: %d\n",
+                 g_sectors[i], ret);
+          return -EIO;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: smartbench_main
+ ****************************************************************************/
+
+int smartbench_main(int argc, char *argv[])
+{
+  FAR struct inode *inode;
+  struct smart_read_write_s req;
+  char devname[16];
+  uint32_t elapsed;
+  uint32_t nreads;
+  int nsectors;
+  int ret;
+  int i;
+
+  printf("smartbench: %d erase blocks of %d bytes, free map: %s, "
+         "wear leveling: %s\n",
+         NEBLOCKS, CONFIG_RAMMTD_ERASESIZE, FREEMAP, WEARLEVEL);
+
+  /* Create the RAM MTD device and put the counting MTD on top of it */
+
+  g_benchmtd.lower = rammtd_initialize(g_simflash, FLASHSIZE);
+  if (!g_benchmtd.lower)
+    {
+      printf("smartbench: Failed to create the RAM MTD device\n");
+      return 1;
+    }
+
+  g_benchmtd.mtd.erase  = smartbench_erase;
+  g_benchmtd.mtd.bread  = smartbench_bread;
+  g_benchmtd.mtd.bwrite = smartbench_bwrite;
+  g_benchmtd.mtd.read   = smartbench_read;
+#ifdef CONFIG_MTD_BYTE_WRITE
+  g_benchmtd.mtd.write  = g_benchmtd.lower->write ? smartbench_write : NULL;
+#endif
+  g_benchmtd.mtd.ioctl  = smartbench_ioctl;
+
+  /* Provide SMART on the MTD device and low-level format it */
+
+  ret = smart_initialize(MINOR, &g_benchmtd.mtd, NULL);
+  if (ret < 0)
+    {
+      printf("smartbench: smart_initialize failed: %d\n", ret);
+      return 1;
+    }
+
+  snprintf(devname, sizeof(devname), DEVFORMAT, MINOR);
+  ret = open_blockdriver(devname, 0, &inode);
+  if (ret < 0)
+    {
+      printf("smartbench: Failed to open %s: %d\n", devname, ret);
+      return 1;
+    }
+
+  ret = inode->u.i_bops->ioctl(inode, BIOC_LLFORMAT, 1);
+  if (ret >= 0)
+    {
+      ret = inode->u.i_bops->ioctl(inode, BIOC_GETFORMAT,
+                                   (unsigned long)&g_fmt);
+    }
+
+  if (ret < 0)
+    {
+      printf("smartbench: Failed to format %s: %d\n", devname, ret);
+      goto errout_with_driver;
+    }
+
+  nsectors = g_fmt.nsectors;
+  g_ncold  = nsectors / COLDDIV;
+  g_nhot   = nsectors / HOTDIV;
+
+  printf("  Sector size:         %10d\n", g_fmt.sectorsize);
+  printf("  Sectors:             %10d\n", nsectors);
+  printf("  Cold sectors:        %10d\n", g_ncold);
+  printf("  Hot sectors:         %10d\n", g_nhot);
+
+  g_sectors    = (FAR uint16_t *)malloc((g_ncold + g_nhot) * sizeof(uint16_t));
+  g_generation = (FAR uint16_t *)malloc((g_ncold + g_nhot) * sizeof(uint16_t));
+  g_buffer     = (FAR uint8_t *)malloc(g_fmt.availbytes);
+  g_expect     = (FAR uint8_t *)malloc(g_fmt.availbytes);
+  if (!g_sectors || !g_generation || !g_buffer || !g_expect)
+    {
+      printf("smartbench: Failed to allocate buffers\n");
+      ret = -ENOMEM;
+      goto errout_with_buffers;
+    }
+
+  /* Allocate and write the cold sectors, then the hot sectors */
+
+  for (i = 0; i < g_ncold + g_nhot; i++)
+    {
+      ret = inode->u.i_bops->ioctl(inode, BIOC_ALLOCSECT,
+                                   (unsigned long)-1);
+      if (ret < 0)
+        {
+          printf("smartbench: Failed to allocate sector %d: %d\n", i, ret);
+          goto errout_with_buffers;
+        }
+
+      g_sectors[i]    = (uint16_t)ret;
+      g_generation[i] = 0;
+
+      smartbench_data(g_buffer, g_fmt.availbytes, g_sectors[i], 0);
+      req.logsector = g_sectors[i];
+      req.offset    = 0;
+      req.count     = g_fmt.availbytes;
+      req.buffer    = g_buffer;
+
+      ret = inode->u.i_bops->ioctl(inode, BIOC_WRITESECT,
+                                   (unsigned long)&req);
+      if (ret < 0)
+        {
+          printf("smartbench: Failed to write sector %d: %d\n",
+                 g_sectors[i], ret);
+          goto errout_with_buffers;
+        }
+    }
+
+  /* Now rewrite the hot sectors and measure */
+
+  srand(0x5a3c);
+  smartbench_reset();
+
+  ret = smartbench_rewrite(inode, NWRITES, &elapsed);
+  if (ret < 0)
+    {
+      goto errout_with_buffers;
+    }
+
+  nreads = g_benchmtd.nreads;
+  printf("  Rewrites:            %10d\n", NWRITES);
+  printf("  Time (usec):         %10lu\n", (unsigned long)elapsed);
+  printf("  Writes per second:   %10lu\n",
+         (unsigned long)(elapsed > 0 ?
+                         (uint64_t)NWRITES * 1000000 / elapsed : 0));
+  printf("  FLASH reads/write:   %10lu.%02lu\n",
+         (unsigned long)(nreads / NWRITES),
+         (unsigned long)((nreads % NWRITES) * 100 / NWRITES));
+  printf("  FLASH writes/write:  %10lu.%02lu\n",
+         (unsigned long)(g_benchmtd.nwrites / NWRITES),
+         (unsigned long)((g_benchmtd.nwrites % NWRITES) * 100 / NWRITES));
+  smartbench_erasereport();
+
+  ret = smartbench_verify(inode);
+  if (ret < 0)
+    {
+      goto errout_with_buffers;
+    }
+
+  printf("  All sectors verified\n");
+  (void)close_blockdriver(inode);
+  inode = NULL;
+
+  /* Provide a second SMART device on the same FLASH.  It scans the FLASH
+   * and so rebuilds its sector map (and free sector index) from the sector
+   * headers.  Verify and rewrite through it.
+   */
+
+  ret = smart_initialize(MINOR + 1, &g_benchmtd.mtd, NULL);
+  if (ret < 0)
+    {
+      printf("smartbench: smart_initialize failed: %d\n", ret);
+      goto errout_with_buffers;
+    }
+
+  snprintf(devname, sizeof(devname), DEVFORMAT, MINOR + 1);
+  ret = open_blockdriver(devname, 0, &inode);
+  if (ret < 0)
+    {
+      printf("smartbench: Failed to open %s: %d\n", devname, ret);
+      goto errout_with_buffers;
+    }
+
+  ret = smartbench_verify(inode);
+  if (ret >= 0)
+    {
+      ret = smartbench_rewrite(inode, NWRITES / 4, &elapsed);
+    }
+
+  if (ret >= 0)
+    {
+      ret = smartbench_verify(inode);
+    }
+
+  if (ret < 0)
+    {
+      goto errout_with_buffers;
+    }
+
+  printf("  All sectors verified after a rescan\n");
+  ret = OK;
+
+errout_with_buffers:
+  free(g_sectors);
+  free(g_generation);
+  free(g_buffer);
+  free(g_expect);
+
+errout_with_driver:
+  if (inode)
+    {
+      (void)close_blockdriver(inode);
+    }
+
+  return ret < 0 ? 1 : 0;
+}
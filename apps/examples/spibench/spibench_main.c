@@ -0,0 +1,443 @@
+/****************************************************************************
+ * examples/spibench/spibench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/spi.h>
+
+#include <arch/irq.h>
+#include <arch/arch.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_SPIBENCH_NSENSORS
+#  define CONFIG_EXAMPLES_SPIBENCH_NSENSORS 4
+#endif
+
+#ifndef CONFIG_EXAMPLES_SPIBENCH_NREGS
+#  define CONFIG_EXAMPLES_SPIBENCH_NREGS 6
+#endif
+
+#ifndef CONFIG_EXAMPLES_SPIBENCH_NROUNDS
+#  define CONFIG_EXAMPLES_SPIBENCH_NROUNDS 1000
+#endif
+
+#ifndef CONFIG_EXAMPLES_SPIBENCH_FREQUENCY
+#  define CONFIG_EXAMPLES_SPIBENCH_FREQUENCY 8000000
+#endif
+
+#define NSENSORS    CONFIG_EXAMPLES_SPIBENCH_NSENSORS
+#define NREGS       CONFIG_EXAMPLES_SPIBENCH_NREGS
+#define NROUNDS     CONFIG_EXAMPLES_SPIBENCH_NROUNDS
+#define FREQUENCY   CONFIG_EXAMPLES_SPIBENCH_FREQUENCY
+
+#if NSENSORS < 1 || NSENSORS > 10
+#  error "CONFIG_EXAMPLES_SPIBENCH_NSENSORS out of range"
+#endif
+
+#if NREGS < 1 || NREGS > 127
+#  error "CONFIG_EXAMPLES_SPIBENCH_NREGS out of range"
+#endif
+
+/* The simulated sensors:  the first byte after select is a command, bit 7
+ * selects a read and bits 0-6 hold the first register address.  Register
+ * 'r' of the device with SPI ID 'd' holds the value (d << 4) + r.
+ */
+
+#define CMD_READ            0x80
+#define SENSOR_DEVID(n)     ((enum spi_dev_e)((n) + 1))
+#define SENSOR_VALUE(n,r)   ((uint8_t)((SENSOR_DEVID(n) << 4) + (r)))
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One sensor:  its read command, the buffer for its registers, and the two
+ * queued transactions (command and data) that read it.
+ */
+
+struct spibench_sensor_s
+{
+  uint8_t cmd;
+  uint8_t data[NREGS];
+  struct spi_trans_s trans[2];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static FAR struct spi_dev_s *g_spi;
+static struct spibench_sensor_s g_sensors[NSENSORS];
+static sem_t g_donesem;
+
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+static uint64_t g_idlestart;          /* Time that IDLE last ran, or 0 */
+static volatile uint64_t g_idletime;  /* Total time spent in IDLE */
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Nanosecond time stamps from the host clock */
+
+static inline uint64_t spibench_nsec(void)
+{
+  return up_hostnsec();
+}
+
+/* Total time spent in the IDLE thread so far */
+
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+static uint64_t spibench_idletime(void)
+{
+  irqstate_t flags;
+  uint64_t idle;
+
+  flags = irqsave();
+  idle  = g_idletime;
+  irqrestore(flags);
+  return idle;
+}
+#endif
+
+/* Read every sensor with the blocking calls, as a driver would do from its
+ * polling thread.
+ */
+
+static int spibench_blocking(void)
+{
+  FAR struct spibench_sensor_s *sensor;
+  int i;
+
+  for (i = 0; i < NSENSORS; i++)
+    {
+      sensor = &g_sensors[i];
+
+      SPI_LOCK(g_spi, true);
+      (void)SPI_SETFREQUENCY(g_spi, FREQUENCY);
+      SPI_SETMODE(g_spi, SPIDEV_MODE0);
+      SPI_SETBITS(g_spi, 8);
+
+      SPI_SELECT(g_spi, SENSOR_DEVID(i), true);
+      SPI_EXCHANGE(g_spi, &sensor->cmd, NULL, 1);
+      SPI_EXCHANGE(g_spi, NULL, sensor->data, NREGS);
+      SPI_SELECT(g_spi, SENSOR_DEVID(i), false);
+      SPI_LOCK(g_spi, false);
+    }
+
+  return OK;
+}
+
+/* Called by the queue when the last transaction of a round completes */
+
+static void spibench_callback(FAR struct spi_trans_s *trans)
+{
+  sem_post(&g_donesem);
+}
+
+/* Read every sensor with one list of queued transactions */
+
+static int spibench_queued(FAR struct spi_queue_s *queue)
+{
+  FAR struct spi_trans_s *trans;
+  int ret;
+  int i;
+
+  ret = spi_queue_submit(queue, &g_sensors[0].trans[0]);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  while (sem_wait(&g_donesem) < 0)
+    {
+      DEBUGASSERT(errno == EINTR);
+    }
+
+  for (i = 0; i < NSENSORS; i++)
+    {
+      trans = g_sensors[i].trans;
+      if (trans[0].result < 0)
+        {
+          return trans[0].result;
+        }
+
+      if (trans[1].result < 0)
+        {
+          return trans[1].result;
+        }
+    }
+
+  return OK;
+}
+
+/* Set up the queued transactions:  for each sensor, the command with the
+ * chip select held, then the data.  All are linked into one list.
+ */
+
+static void spibench_setup(void)
+{
+  FAR struct spibench_sensor_s *sensor;
+  FAR struct spi_trans_s *trans;
+  int i;
+
+  memset(g_sensors, 0, sizeof(g_sensors));
+  for (i = 0; i < NSENSORS; i++)
+    {
+      sensor      = &g_sensors[i];
+      sensor->cmd = CMD_READ | 0;
+
+      trans            = &sensor->trans[0];
+      trans->flink     = &sensor->trans[1];
+      trans->devid     = SENSOR_DEVID(i);
+      trans->mode      = SPIDEV_MODE0;
+      trans->nbits     = 8;
+      trans->flags     = SPI_TRANSFLAG_KEEPCS;
+      trans->frequency = FREQUENCY;
+      trans->txbuffer  = &sensor->cmd;
+      trans->nwords    = 1;
+
+      trans            = &sensor->trans[1];
+      trans->flink     = i + 1 < NSENSORS ? &g_sensors[i + 1].trans[0] : NULL;
+      trans->devid     = SENSOR_DEVID(i);
+      trans->mode      = SPIDEV_MODE0;
+      trans->nbits     = 8;
+      trans->frequency = FREQUENCY;
+      trans->rxbuffer  = sensor->data;
+      trans->nwords    = NREGS;
+    }
+
+  g_sensors[NSENSORS - 1].trans[1].callback = spibench_callback;
+}
+
+/* Check the register values read in the last round, then clear them for
+ * the next round.
+ */
+
+static int spibench_check(void)
+{
+  int i;
+  int r;
+
+  for (i = 0; i < NSENSORS; i++)
+    {
+      for (r = 0; r < NREGS; r++)
+        {
+          if (g_sensors[i].data[r] != SENSOR_VALUE(i, r))
+            {
+              printf("spibench: ERROR: sensor %d register %d: "
+                     "%02x, expected %02x\n", i, r,
+                     g_sensors[i].data[r], SENSOR_VALUE(i, r));
+              return -EIO;
+            }
+        }
+
+      memset(g_sensors[i].data, 0, NREGS);
+    }
+
+  return OK;
+}
+
+/* Run NROUNDS rounds with one method and print the result line */
+
+static int spibench_measure(FAR const char *what,
+                            FAR struct spi_queue_s *queue)
+{
+  uint64_t start;
+  uint64_t elapsed;
+  uint32_t rate;
+  uint32_t usec;
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+  uint64_t idle;
+  uint32_t load;
+#endif
+  int ret;
+  int n;
+
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+  idle  = spibench_idletime();
+#endif
+  start = spibench_nsec();
+
+  for (n = 0; n < NROUNDS; n++)
+    {
+      ret = queue ? spibench_queued(queue) : spibench_blocking();
+      if (ret < 0)
+        {
+          printf("spibench: %s round %d failed: %d\n", what, n, ret);
+          return ret;
+        }
+
+      ret = spibench_check();
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  elapsed = spibench_nsec() - start;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  /* Sensor reads per second, and microseconds (times 100) per read */
+
+  rate = (uint32_t)((uint64_t)NROUNDS * NSENSORS * 1000000000 / elapsed);
+  usec = (uint32_t)(elapsed / 10 / (NROUNDS * NSENSORS));
+
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+  idle = spibench_idletime() - idle;
+  load = idle < elapsed ? (uint32_t)(100 - idle * 100 / elapsed) : 0;
+
+  printf("  %-8s  %8lu  %5lu.%02lu  %3lu%%\n", what, (unsigned long)rate,
+         (unsigned long)(usec / 100), (unsigned long)(usec % 100),
+         (unsigned long)load);
+#else
+  printf("  %-8s  %8lu  %5lu.%02lu\n", what, (unsigned long)rate,
+         (unsigned long)(usec / 100), (unsigned long)(usec % 100));
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_note_start, sched_note_stop, and sched_note_switch
+ *
+ * Description:
+ *   Scheduler instrumentation hooks.  These add up the time that the IDLE
+ *   thread (PID 0) runs;  the CPU use is the part of the elapsed time that
+ *   is not IDLE time.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+void sched_note_start(FAR struct tcb_s *tcb)
+{
+}
+
+void sched_note_stop(FAR struct tcb_s *tcb)
+{
+}
+
+void sched_note_switch(FAR struct tcb_s *pFromTcb, FAR struct tcb_s *pToTcb)
+{
+  uint64_t now = spibench_nsec();
+
+  if (pFromTcb->pid == 0 && g_idlestart != 0)
+    {
+      g_idletime += now - g_idlestart;
+    }
+
+  g_idlestart = pToTcb->pid == 0 ? now : 0;
+}
+#endif
+
+/****************************************************************************
+ * spibench_main
+ ****************************************************************************/
+
+int spibench_main(int argc, char *argv[])
+{
+  FAR struct spi_queue_s *queue;
+  int ret = EXIT_FAILURE;
+
+  g_spi = up_spiinitialize(0);
+  if (!g_spi)
+    {
+      printf("spibench: up_spiinitialize failed\n");
+      return EXIT_FAILURE;
+    }
+
+  queue = spi_queue_initialize(g_spi);
+  if (!queue)
+    {
+      printf("spibench: spi_queue_initialize failed\n");
+      return EXIT_FAILURE;
+    }
+
+  sem_init(&g_donesem, 0, 0);
+  spibench_setup();
+
+  printf("\nSPI sensor polling benchmark: %d sensors, %d registers each, "
+         "%lu Hz, %s lower half\n", NSENSORS, NREGS, (unsigned long)FREQUENCY,
+         g_spi->ops->chain ? "chained" : "exchange-only");
+#ifdef CONFIG_EXAMPLES_SPIBENCH_CPULOAD
+  printf("  %-8s  %8s  %8s  %4s\n", "", "reads/s", "us/read", "CPU");
+#else
+  printf("  %-8s  %8s  %8s\n", "", "reads/s", "us/read");
+#endif
+
+  if (spibench_measure("blocking", NULL) == OK &&
+      spibench_measure("queued", queue) == OK)
+    {
+      ret = EXIT_SUCCESS;
+    }
+
+  /* The worker may still be finishing the last round */
+
+  while (spi_queue_uninitialize(queue) == -EBUSY)
+    {
+      usleep(1000);
+    }
+
+  sem_destroy(&g_donesem);
+  return ret;
+}
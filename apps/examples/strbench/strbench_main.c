@@ -0,0 +1,779 @@
+/****************************************************************************
+ * examples/strbench/strbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_STRBENCH_MAXSIZE
+#  define CONFIG_EXAMPLES_STRBENCH_MAXSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_STRBENCH_NLOOPS
+#  define CONFIG_EXAMPLES_STRBENCH_NLOOPS 1000
+#endif
+
+#define MAXSIZE     CONFIG_EXAMPLES_STRBENCH_MAXSIZE
+#define NLOOPS      CONFIG_EXAMPLES_STRBENCH_NLOOPS
+
+/* The correctness tests use every length below MAXLEN at every alignment
+ * below MAXALIGN, with GUARD bytes on either side that must not change.
+ * The overlapping memmove() tests use every source and destination offset
+ * below MAXSHIFT in the same buffer.
+ */
+
+#define MAXALIGN    8
+#define MAXLEN      72
+#define MAXSHIFT    24
+#define GUARD       16
+#define TESTSIZE    (GUARD + MAXSHIFT + MAXLEN + GUARD)
+
+#define BUFSIZE     (MAXSIZE + TESTSIZE)
+#define MAXERRORS   10
+
+/* Each measurement is repeated NBATCHES times and the shortest time is
+ * reported.  That discards the batches that were interrupted.
+ */
+
+#define NBATCHES    5
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One function under test:  It operates on the 'n' bytes at 'p1' and, for
+ * the functions with two operands, 'p2'.
+ */
+
+typedef uintptr_t (*strbench_func_t)(FAR uint8_t *p1, FAR uint8_t *p2,
+                                     size_t n);
+
+struct strbench_func_s
+{
+  FAR const char *name;
+  strbench_func_t libc;      /* Calls the C library function */
+  strbench_func_t bytewise;  /* Byte-at-a-time version */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static uintptr_t libc_memcpy(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_memmove(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_memset(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_memcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_memchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_strlen(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_strchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t libc_strcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+
+static uintptr_t bytewise_memcpy(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_memset(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_memcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_memchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_strlen(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_strchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+static uintptr_t bytewise_strcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The benchmark searches for a byte that is not there and compares equal
+ * strings, so every function processes all of the bytes.
+ */
+
+static const struct strbench_func_s g_funcs[] =
+{
+  { "memcpy",  libc_memcpy,  bytewise_memcpy },
+  { "memmove", libc_memmove, bytewise_memcpy },
+  { "memset",  libc_memset,  bytewise_memset },
+  { "memcmp",  libc_memcmp,  bytewise_memcmp },
+  { "memchr",  libc_memchr,  bytewise_memchr },
+  { "strlen",  libc_strlen,  bytewise_strlen },
+  { "strchr",  libc_strchr,  bytewise_strchr },
+  { "strcmp",  libc_strcmp,  bytewise_strcmp },
+};
+
+#define NFUNCS (sizeof(g_funcs) / sizeof(struct strbench_func_s))
+
+/* Buffers.  These are aligned to 16 bytes at run time. */
+
+static uint8_t g_raw1[BUFSIZE + 16];
+static uint8_t g_raw2[BUFSIZE + 16];
+static uint8_t g_expect[BUFSIZE];
+
+static FAR uint8_t *g_buf1;
+static FAR uint8_t *g_buf2;
+
+static int g_nerrors;
+static volatile uintptr_t g_sink;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* The functions under test, called through a common prototype */
+
+static uintptr_t libc_memcpy(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)memcpy(p1, p2, n);
+}
+
+static uintptr_t libc_memmove(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)memmove(p1, p2, n);
+}
+
+static uintptr_t libc_memset(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)memset(p1, 'a', n);
+}
+
+static uintptr_t libc_memcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)memcmp(p1, p2, n);
+}
+
+static uintptr_t libc_memchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)memchr(p1, 'z', n);
+}
+
+static uintptr_t libc_strlen(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)strlen((FAR const char *)p1);
+}
+
+static uintptr_t libc_strchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)strchr((FAR const char *)p1, 'z');
+}
+
+static uintptr_t libc_strcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  return (uintptr_t)strcmp((FAR const char *)p1, (FAR const char *)p2);
+}
+
+/* Byte-at-a-time versions.  These are the reference for the correctness
+ * tests and the baseline for the benchmark.
+ */
+
+static uintptr_t bytewise_memcpy(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  FAR uint8_t *dest = p1;
+
+  while (n-- > 0)
+    {
+      *p1++ = *p2++;
+    }
+
+  return (uintptr_t)dest;
+}
+
+static uintptr_t bytewise_memset(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  FAR uint8_t *dest = p1;
+
+  while (n-- > 0)
+    {
+      *p1++ = 'a';
+    }
+
+  return (uintptr_t)dest;
+}
+
+static uintptr_t bytewise_memcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  for (; n > 0; p1++, p2++, n--)
+    {
+      if (*p1 != *p2)
+        {
+          return *p1 < *p2 ? (uintptr_t)-1 : 1;
+        }
+    }
+
+  return 0;
+}
+
+static uintptr_t bytewise_memchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  for (; n > 0; p1++, n--)
+    {
+      if (*p1 == 'z')
+        {
+          return (uintptr_t)p1;
+        }
+    }
+
+  return 0;
+}
+
+static uintptr_t bytewise_strlen(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  FAR uint8_t *s = p1;
+
+  while (*s != '\0')
+    {
+      s++;
+    }
+
+  return (uintptr_t)(s - p1);
+}
+
+static uintptr_t bytewise_strchr(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  for (; ; p1++)
+    {
+      if (*p1 == 'z')
+        {
+          return (uintptr_t)p1;
+        }
+
+      if (*p1 == '\0')
+        {
+          return 0;
+        }
+    }
+}
+
+static uintptr_t bytewise_strcmp(FAR uint8_t *p1, FAR uint8_t *p2, size_t n)
+{
+  while (*p1 == *p2 && *p1 != '\0')
+    {
+      p1++;
+      p2++;
+    }
+
+  return (uintptr_t)((int)*p1 - (int)*p2);
+}
+
+/* Return the sign of a comparison result */
+
+static int strbench_sign(int result)
+{
+  return result < 0 ? -1 : result > 0 ? 1 : 0;
+}
+
+/* Fill 'n' bytes with a pattern of non-zero bytes, both below and above
+ * 0x80.  Any 'avoid' byte is replaced so that it does not occur.
+ */
+
+static void strbench_fill(FAR uint8_t *buffer, size_t n, unsigned int seed,
+                          uint8_t avoid)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      buffer[i] = (uint8_t)((i * 37 + seed) % 255 + 1);
+      if (buffer[i] == avoid)
+        {
+          buffer[i] ^= 1;
+        }
+    }
+}
+
+static void strbench_error(FAR const char *name, int align1, int align2,
+                           size_t len, int pos)
+{
+  if (g_nerrors < MAXERRORS)
+    {
+      printf("strbench: %s failed: alignment %d/%d, length %lu, "
+             "position %d\n", name, align1, align2, (unsigned long)len, pos);
+    }
+
+  g_nerrors++;
+}
+
+/* Check that 'buffer' still holds the expected 'n' bytes */
+
+static bool strbench_verify(FAR const uint8_t *buffer, size_t n)
+{
+  size_t i;
+
+  for (i = 0; i < n; i++)
+    {
+      if (buffer[i] != g_expect[i])
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: strbench_testcopy
+ *
+ * Description:
+ *   Test memcpy(), memmove(), and memset() for all lengths and alignments.
+ *   The bytes around the destination must not change.
+ *
+ ****************************************************************************/
+
+static void strbench_testcopy(void)
+{
+  FAR uint8_t *dest;
+  FAR uint8_t *src;
+  FAR void *ret;
+  size_t len;
+  size_t i;
+  int a1;
+  int a2;
+  int c;
+
+  for (a1 = 0; a1 < MAXALIGN; a1++)
+    {
+      for (a2 = 0; a2 < MAXALIGN; a2++)
+        {
+          for (len = 0; len < MAXLEN; len++)
+            {
+              src  = g_buf2 + GUARD + a2;
+              dest = g_buf1 + GUARD + a1;
+
+              strbench_fill(g_buf2, TESTSIZE, len, 0);
+              strbench_fill(g_buf1, TESTSIZE, len + 100, 0);
+              bytewise_memcpy(g_expect, g_buf1, TESTSIZE);
+              bytewise_memcpy(g_expect + GUARD + a1, src, len);
+
+              ret = memcpy(dest, src, len);
+              if (ret != dest || !strbench_verify(g_buf1, TESTSIZE))
+                {
+                  strbench_error("memcpy", a1, a2, len, -1);
+                }
+
+              strbench_fill(g_buf1, TESTSIZE, len + 100, 0);
+              ret = memmove(dest, src, len);
+              if (ret != dest || !strbench_verify(g_buf1, TESTSIZE))
+                {
+                  strbench_error("memmove", a1, a2, len, -1);
+                }
+            }
+        }
+
+      /* memset() with a zero and with a non-zero byte */
+
+      for (len = 0; len < MAXLEN; len++)
+        {
+          for (c = 0; c < 0x100; c += 0xa5)
+            {
+              dest = g_buf1 + GUARD + a1;
+
+              strbench_fill(g_buf1, TESTSIZE, len, 0);
+              bytewise_memcpy(g_expect, g_buf1, TESTSIZE);
+              for (i = 0; i < len; i++)
+                {
+                  g_expect[GUARD + a1 + i] = (uint8_t)c;
+                }
+
+              ret = memset(dest, c, len);
+              if (ret != dest || !strbench_verify(g_buf1, TESTSIZE))
+                {
+                  strbench_error("memset", a1, 0, len, c);
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: strbench_testmove
+ *
+ * Description:
+ *   Test memmove() between overlapping regions at all distances below
+ *   MAXSHIFT, in both directions.
+ *
+ ****************************************************************************/
+
+static void strbench_testmove(void)
+{
+  FAR uint8_t *dest;
+  FAR uint8_t *src;
+  uint8_t tmp[MAXLEN];
+  size_t len;
+  int s1;
+  int s2;
+
+  for (s1 = 0; s1 < MAXSHIFT; s1++)
+    {
+      for (s2 = 0; s2 < MAXSHIFT; s2++)
+        {
+          for (len = 0; len < MAXLEN; len++)
+            {
+              dest = g_buf1 + GUARD + s1;
+              src  = g_buf1 + GUARD + s2;
+
+              strbench_fill(g_buf1, TESTSIZE, len, 0);
+              bytewise_memcpy(g_expect, g_buf1, TESTSIZE);
+              bytewise_memcpy(tmp, src, len);
+              bytewise_memcpy(g_expect + GUARD + s1, tmp, len);
+
+              if (memmove(dest, src, len) != dest ||
+                  !strbench_verify(g_buf1, TESTSIZE))
+                {
+                  strbench_error("memmove", s1, s2, len, -1);
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: strbench_testcompare
+ *
+ * Description:
+ *   Test memcmp() and strcmp() for all lengths and alignments, with the
+ *   first difference at every position (or none).  The differing byte is
+ *   above 0x80 in one of the operands or, for strcmp(), the end of the
+ *   second string.  Bytes after the end must not be examined.
+ *
+ ****************************************************************************/
+
+static void strbench_testcompare(void)
+{
+  FAR uint8_t *p1;
+  FAR uint8_t *p2;
+  size_t len;
+  int pos;
+  int a1;
+  int a2;
+  int expected;
+  int result;
+
+  for (a1 = 0; a1 < MAXALIGN; a1++)
+    {
+      for (a2 = 0; a2 < MAXALIGN; a2++)
+        {
+          for (len = 0; len < MAXLEN; len++)
+            {
+              for (pos = -1; pos < (int)len; pos++)
+                {
+                  p1 = g_buf1 + GUARD + a1;
+                  p2 = g_buf2 + GUARD + a2;
+
+                  /* The operands are equal up to 'pos' and differ after
+                   * 'len'.
+                   */
+
+                  strbench_fill(p1, len + 1, len, 0);
+                  bytewise_memcpy(p2, p1, len);
+                  p2[len] = p1[len] ^ 0x40;
+                  if (pos >= 0)
+                    {
+                      p2[pos] ^= 0x80;
+                      if (p2[pos] == 0)
+                        {
+                          p2[pos] = 0x7f;
+                        }
+                    }
+
+                  expected = (int)bytewise_memcmp(p1, p2, len);
+                  result   = memcmp(p1, p2, len);
+                  if (strbench_sign(result) != strbench_sign(expected))
+                    {
+                      strbench_error("memcmp", a1, a2, len, pos);
+                    }
+
+                  /* As strings of 'len' bytes */
+
+                  p1[len] = '\0';
+                  p2[len] = '\0';
+                  p1[len + 1] = 1;
+                  p2[len + 1] = 2;
+
+                  expected = (int)bytewise_strcmp(p1, p2, len);
+                  result   = strcmp((FAR const char *)p1,
+                                    (FAR const char *)p2);
+                  if (strbench_sign(result) != strbench_sign(expected))
+                    {
+                      strbench_error("strcmp", a1, a2, len, pos);
+                    }
+
+                  /* With the second string ending at 'pos' */
+
+                  if (pos >= 0)
+                    {
+                      p2[pos] = '\0';
+                      result  = strcmp((FAR const char *)p1,
+                                       (FAR const char *)p2);
+                      if (result <= 0)
+                        {
+                          strbench_error("strcmp", a1, a2, len, pos);
+                        }
+
+                      result  = strcmp((FAR const char *)p2,
+                                       (FAR const char *)p1);
+                      if (result >= 0)
+                        {
+                          strbench_error("strcmp", a2, a1, len, pos);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: strbench_testsearch
+ *
+ * Description:
+ *   Test memchr(), strlen(), and strchr() for all lengths and alignments,
+ *   with the byte searched for at every position (or nowhere).  The byte
+ *   also occurs just after the end.
+ *
+ ****************************************************************************/
+
+static void strbench_testsearch(void)
+{
+  static const uint8_t targets[] = { 0x00, 0x41, 0x80, 0xff };
+  FAR uint8_t *s;
+  FAR void *expected;
+  FAR void *result;
+  uint8_t target;
+  size_t len;
+  int pos;
+  int align;
+  int i;
+
+  for (align = 0; align < MAXALIGN; align++)
+    {
+      for (len = 0; len < MAXLEN; len++)
+        {
+          s = g_buf1 + GUARD + align;
+
+          /* strlen() and strchr() for the terminating null byte.  There is
+           * a null byte just before the string.
+           */
+
+          strbench_fill(g_buf1, TESTSIZE, len, 0);
+          s[-1]  = '\0';
+          s[len] = '\0';
+
+          if (strlen((FAR const char *)s) != len)
+            {
+              strbench_error("strlen", align, 0, len, -1);
+            }
+
+          if (strchr((FAR const char *)s, '\0') != (FAR char *)s + len)
+            {
+              strbench_error("strchr", align, 0, len, -1);
+            }
+
+          for (i = 0; i < sizeof(targets); i++)
+            {
+              target = targets[i];
+              for (pos = -1; pos < (int)len; pos++)
+                {
+                  strbench_fill(g_buf1, TESTSIZE, len, target);
+                  s[len] = target;
+                  expected = NULL;
+                  if (pos >= 0)
+                    {
+                      s[pos]   = target;
+                      expected = s + pos;
+                    }
+
+                  /* Bits above the low eight are ignored */
+
+                  result = memchr(s, target | 0x100, len);
+                  if (result != expected)
+                    {
+                      strbench_error("memchr", align, target, len, pos);
+                    }
+
+                  if (target == 0)
+                    {
+                      continue;
+                    }
+
+                  /* As a string of 'len' bytes followed by 'target' */
+
+                  s[len]     = '\0';
+                  s[len + 1] = target;
+
+                  result = strchr((FAR const char *)s, (char)target);
+                  if (result != expected)
+                    {
+                      strbench_error("strchr", align, target, len, pos);
+                    }
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: strbench_time
+ *
+ * Description:
+ *   Return the shortest time taken by NLOOPS calls to 'func' in NBATCHES
+ *   attempts.
+ *
+ ****************************************************************************/
+
+static uint32_t strbench_time(strbench_func_t func, FAR uint8_t *p1,
+                              FAR uint8_t *p2, size_t n)
+{
+  uint32_t shortest = UINT32_MAX;
+  uint32_t elapsed;
+  uint32_t start;
+  int batch;
+  int i;
+
+  g_sink = func(p1, p2, n);
+
+  for (batch = 0; batch < NBATCHES; batch++)
+    {
+      start = benchtime_now();
+      for (i = 0; i < NLOOPS; i++)
+        {
+          g_sink = func(p1, p2, n);
+        }
+
+      elapsed = benchtime_now() - start;
+      if (elapsed < shortest)
+        {
+          shortest = elapsed;
+        }
+    }
+
+  return shortest;
+}
+
+/* Print the average time of one call with one decimal place */
+
+static void strbench_print(uint32_t elapsed)
+{
+  unsigned long avg10 = (unsigned long)elapsed * 10 / NLOOPS;
+
+  printf(" %8lu.%lu", avg10 / 10, avg10 % 10);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * strbench_main
+ ****************************************************************************/
+
+int strbench_main(int argc, char *argv[])
+{
+  FAR const struct strbench_func_s *func;
+  FAR uint8_t *p1;
+  FAR uint8_t *p2;
+  size_t size;
+  int offset;
+  int i;
+
+  benchtime_initialize();
+
+  g_buf1 = (FAR uint8_t *)(((uintptr_t)g_raw1 + 15) & ~(uintptr_t)15);
+  g_buf2 = (FAR uint8_t *)(((uintptr_t)g_raw2 + 15) & ~(uintptr_t)15);
+  g_nerrors = 0;
+
+  printf("\nString function test:\n");
+
+  strbench_testcopy();
+  strbench_testmove();
+  strbench_testcompare();
+  strbench_testsearch();
+
+  if (g_nerrors > 0)
+    {
+      printf("strbench: %d errors\n", g_nerrors);
+      return EXIT_FAILURE;
+    }
+
+  printf("  PASSED\n");
+
+  /* Time each function on equal strings of 'size - 1' bytes that do not
+   * contain the byte searched for.  The unaligned case offsets the two
+   * operands differently.
+   */
+
+  printf("\nString function benchmark, %d calls, average %s per call:\n",
+         NLOOPS, BENCHTIME_UNITS);
+  printf("  %-8s %6s  %10s %10s  %10s %10s\n", "", "",
+         "aligned", "", "unaligned", "");
+  printf("  %-8s %6s  %10s %10s  %10s %10s\n", "function", "size",
+         "libc", "bytewise", "libc", "bytewise");
+
+  for (i = 0; i < NFUNCS; i++)
+    {
+      func = &g_funcs[i];
+      for (size = 16; size <= MAXSIZE; size <<= 4)
+        {
+          printf("  %-8s %6lu ", func->name, (unsigned long)size);
+
+          for (offset = 0; offset < 2; offset++)
+            {
+              p1 = g_buf1 + offset;
+              p2 = g_buf2 + 3 * offset;
+
+              memset(p1, 'a', size - 1);
+              memset(p2, 'a', size - 1);
+              p1[size - 1] = '\0';
+              p2[size - 1] = '\0';
+
+              strbench_print(strbench_time(func->libc, p1, p2, size - 1));
+              strbench_print(strbench_time(func->bytewise, p1, p2,
+                                           size - 1));
+              printf(" ");
+            }
+
+          printf("\n");
+        }
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/****************************************************************************
+ * examples/timerjitter/timerjitter_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <arch/arch.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_TIMERJITTER_PERIOD
+#  define CONFIG_EXAMPLES_TIMERJITTER_PERIOD 5000
+#endif
+
+#ifndef CONFIG_EXAMPLES_TIMERJITTER_NSAMPLES
+#  define CONFIG_EXAMPLES_TIMERJITTER_NSAMPLES 200
+#endif
+
+#ifndef CONFIG_EXAMPLES_TIMERJITTER_IDLETIME
+#  define CONFIG_EXAMPLES_TIMERJITTER_IDLETIME 1000
+#endif
+
+#define PERIOD   CONFIG_EXAMPLES_TIMERJITTER_PERIOD
+#define NSAMPLES CONFIG_EXAMPLES_TIMERJITTER_NSAMPLES
+#define IDLETIME CONFIG_EXAMPLES_TIMERJITTER_IDLETIME
+
+#ifdef CONFIG_SCHED_TICKLESS
+#  define TIMER_MODE "tickless"
+#else
+#  define TIMER_MODE "periodic"
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Measured periods in microseconds */
+
+static uint32_t g_period[NSAMPLES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: host_usec
+ *
+ * Description:
+ *   Return the host's monotonic time in microseconds.  The OS clock cannot
+ *   be used to measure the timer that drives it.
+ *
+ ****************************************************************************/
+
+static inline uint64_t host_usec(void)
+{
+  return up_hostnsec() / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * timerjitter_main
+ ****************************************************************************/
+
+int timerjitter_main(int argc, char *argv[])
+{
+  unsigned long wakeups;
+  uint64_t start;
+  uint64_t last;
+  uint64_t now;
+  uint64_t total;
+  uint32_t min;
+  uint32_t max;
+  uint32_t mean;
+  uint32_t dev;
+  int i;
+
+  printf("timerjitter: %s timer, %d ticks per second\n",
+         TIMER_MODE, (int)CLK_TCK);
+#if !defined(CONFIG_SCHED_TICKLESS) && !defined(CONFIG_SIM_WALLTIME)
+  printf("timerjitter: WARNING: CONFIG_SIM_WALLTIME is not set; "
+         "the periodic timer does not follow the host clock\n");
+#endif
+  printf("timerjitter: %d periods of %d usec\n", NSAMPLES, PERIOD);
+
+  /* Synchronize with the timer before starting the measurement */
+
+  usleep(PERIOD);
+
+  wakeups = up_idlewakeups();
+  start   = host_usec();
+  last    = start;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      usleep(PERIOD);
+
+      now         = host_usec();
+      g_period[i] = (uint32_t)(now - last);
+      last        = now;
+    }
+
+  wakeups = up_idlewakeups() - wakeups;
+
+  /* Summarize the measured periods */
+
+  min   = UINT32_MAX;
+  max   = 0;
+  total = 0;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      if (g_period[i] < min)
+        {
+          min = g_period[i];
+        }
+
+      if (g_period[i] > max)
+        {
+          max = g_period[i];
+        }
+
+      total += g_period[i];
+    }
+
+  mean  = (uint32_t)(total / NSAMPLES);
+  total = 0;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      total += g_period[i] > mean ? g_period[i] - mean : mean - g_period[i];
+    }
+
+  dev = (uint32_t)(total / NSAMPLES);
+
+  printf("timerjitter: period usec: min %lu max %lu mean %lu (requested %d)\n",
+         (unsigned long)min, (unsigned long)max, (unsigned long)mean, PERIOD);
+  printf("timerjitter: jitter: mean absolute deviation %lu usec\n",
+         (unsigned long)dev);
+  printf("timerjitter: wakeups: %lu in %lu msec (%lu per period)\n",
+         wakeups, (unsigned long)((last - start) / 1000),
+         wakeups / NSAMPLES);
+
+  /* Now let the system idle and count the wakeups */
+
+  wakeups = up_idlewakeups();
+  start   = host_usec();
+
+  usleep(IDLETIME * 1000);
+
+  now     = host_usec();
+  wakeups = up_idlewakeups() - wakeups;
+
+  printf("timerjitter: idle: %lu wakeups in %lu msec\n",
+         wakeups, (unsigned long)((now - start) / 1000));
+  return 0;
+}
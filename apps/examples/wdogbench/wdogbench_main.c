@@ -0,0 +1,227 @@
+/****************************************************************************
+ * examples/wdogbench/wdogbench_main.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <wdog.h>
+
+#include <apps/benchtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS
+#  define CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS 512
+#endif
+
+#ifndef CONFIG_EXAMPLES_WDOGBENCH_NOPS
+#  define CONFIG_EXAMPLES_WDOGBENCH_NOPS 1000
+#endif
+
+#define MAXWDOGS CONFIG_EXAMPLES_WDOGBENCH_MAXWDOGS
+#define NOPS     CONFIG_EXAMPLES_WDOGBENCH_NOPS
+
+/* Watchdog delays are chosen so that no watchdog expires while the
+ * benchmark is running.
+ */
+
+#define MIN_DELAY 1000
+#define MAX_DELAY 100000
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+#  define QUEUE_NAME "timer wheel"
+#else
+#  define QUEUE_NAME "ordered list"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct wdogbench_stats_s
+{
+  uint32_t total;
+  uint32_t max;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static WDOG_ID  g_wdogs[MAXWDOGS];
+static uint32_t g_seed;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* A private pseudo-random number generator so that both queue
+ * implementations see exactly the same sequence of delays.
+ */
+
+static uint32_t wdogbench_random(void)
+{
+  g_seed = g_seed * 1103515245 + 12345;
+  return g_seed >> 8;
+}
+
+static int wdogbench_delay(void)
+{
+  return MIN_DELAY + (int)(wdogbench_random() % (MAX_DELAY - MIN_DELAY));
+}
+
+/* The watchdog function.  It should never run. */
+
+static void wdogbench_expired(int argc, uint32_t arg1, ...)
+{
+}
+
+static void wdogbench_sample(FAR struct wdogbench_stats_s *stats,
+                             uint32_t elapsed)
+{
+  stats->total += elapsed;
+  if (elapsed > stats->max)
+    {
+      stats->max = elapsed;
+    }
+}
+
+/****************************************************************************
+ * Name: wdogbench_run
+ *
+ * Description:
+ *   Start 'nwdogs' watchdogs, then repeatedly cancel and restart randomly
+ *   selected ones, timing each call.
+ *
+ ****************************************************************************/
+
+static void wdogbench_run(int nwdogs)
+{
+  struct wdogbench_stats_s start = {0, 0};
+  struct wdogbench_stats_s cancel = {0, 0};
+  uint32_t t0;
+  uint32_t t1;
+  uint32_t t2;
+  int i;
+
+  for (i = 0; i < nwdogs; i++)
+    {
+      (void)wd_start(g_wdogs[i], wdogbench_delay(),
+                     (wdentry_t)wdogbench_expired, 1, (uint32_t)i);
+    }
+
+  for (i = 0; i < NOPS; i++)
+    {
+      WDOG_ID wdog = g_wdogs[wdogbench_random() % nwdogs];
+      int delay = wdogbench_delay();
+
+      t0 = benchtime_now();
+      (void)wd_cancel(wdog);
+      t1 = benchtime_now();
+      (void)wd_start(wdog, delay, (wdentry_t)wdogbench_expired, 1,
+                     (uint32_t)i);
+      t2 = benchtime_now();
+
+      wdogbench_sample(&cancel, t1 - t0);
+      wdogbench_sample(&start, t2 - t1);
+    }
+
+  for (i = 0; i < nwdogs; i++)
+    {
+      (void)wd_cancel(g_wdogs[i]);
+    }
+
+  printf("  %6d  %8lu %8lu  %8lu %8lu\n", nwdogs,
+         (unsigned long)(start.total / NOPS), (unsigned long)start.max,
+         (unsigned long)(cancel.total / NOPS), (unsigned long)cancel.max);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * wdogbench_main
+ ****************************************************************************/
+
+int wdogbench_main(int argc, char *argv[])
+{
+  int nwdogs;
+  int ncreated;
+
+  benchtime_initialize();
+
+  for (ncreated = 0; ncreated < MAXWDOGS; ncreated++)
+    {
+      g_wdogs[ncreated] = wd_create();
+      if (!g_wdogs[ncreated])
+        {
+          break;
+        }
+    }
+
+  printf("\nWatchdog benchmark (%s), times in %s:\n",
+         QUEUE_NAME, BENCHTIME_UNITS);
+
+  if (ncreated < MAXWDOGS)
+    {
+      printf("  Only %d watchdogs available; increase "
+             "CONFIG_PREALLOC_WDOGS\n", ncreated);
+    }
+
+  printf("  %6s  %8s %8s  %8s %8s\n",
+         "wdogs", "start", "max", "cancel", "max");
+
+  g_seed = 1;
+  for (nwdogs = 16; nwdogs <= ncreated; nwdogs <<= 1)
+    {
+      wdogbench_run(nwdogs);
+    }
+
+  while (ncreated > 0)
+    {
+      (void)wd_delete(g_wdogs[--ncreated]);
+    }
+
+  return 0;
+}
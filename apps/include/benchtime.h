@@ -0,0 +1,133 @@
+/****************************************************************************
+ * apps/include/benchtime.h
+ * Time stamps for the benchmark examples
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __APPS_INCLUDE_BENCHTIME_H
+#define __APPS_INCLUDE_BENCHTIME_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/time.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* Time stamps come from a free-running cycle counter where one is known to
+ * exist:  the TSC on an x86 host running the simulation, or the DWT cycle
+ * counter on the Cortex-M3/M4.  Otherwise, they fall back to microseconds
+ * from gettimeofday() (which is probably too coarse to be useful).
+ *
+ * BENCHTIME_CYCLES is defined if the time stamps count cycles.
+ * BENCHTIME_UNITS and BENCHTIME_UNIT name the unit for printing.
+ */
+
+#if defined(CONFIG_ARCH_SIM) && (defined(__i386__) || defined(__x86_64__))
+#  define BENCHTIME_CYCLES 1
+#elif defined(CONFIG_ARCH_CORTEXM3) || defined(CONFIG_ARCH_CORTEXM4)
+#  define BENCHTIME_CYCLES 1
+#  define BENCHTIME_DWT    1
+
+#  define BENCHTIME_DEMCR      (*(volatile uint32_t *)0xe000edfc)
+#  define BENCHTIME_DWT_CTRL   (*(volatile uint32_t *)0xe0001000)
+#  define BENCHTIME_DWT_CYCCNT (*(volatile uint32_t *)0xe0001004)
+
+#  define DEMCR_TRCENA         (1 << 24)
+#  define DWT_CTRL_CYCCNTENA   (1 << 0)
+#endif
+
+#ifdef BENCHTIME_CYCLES
+#  define BENCHTIME_UNITS "cycles"
+#  define BENCHTIME_UNIT  "cycle"
+#else
+#  define BENCHTIME_UNITS "usec"
+#  define BENCHTIME_UNIT  "usec"
+#endif
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: benchtime_initialize
+ *
+ * Description:
+ *   Start the cycle counter, if it must be started.  Call this once before
+ *   taking the first time stamp.
+ *
+ ****************************************************************************/
+
+static inline void benchtime_initialize(void)
+{
+#ifdef BENCHTIME_DWT
+  BENCHTIME_DEMCR    |= DEMCR_TRCENA;
+  BENCHTIME_DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+/****************************************************************************
+ * Name: benchtime_now
+ *
+ * Description:
+ *   Return the current time stamp.  Only the difference between two time
+ *   stamps is meaningful;  the difference is correct across one wrap of
+ *   the 32-bit value.
+ *
+ ****************************************************************************/
+
+static inline uint32_t benchtime_now(void)
+{
+#if defined(CONFIG_ARCH_SIM) && (defined(__i386__) || defined(__x86_64__))
+  uint32_t lo;
+  uint32_t hi;
+
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return lo;
+#elif defined(BENCHTIME_DWT)
+  return BENCHTIME_DWT_CYCCNT;
+#else
+  struct timeval tv;
+
+  (void)gettimeofday(&tv, NULL);
+  return (uint32_t)tv.tv_sec * 1000000 + (uint32_t)tv.tv_usec;
+#endif
+}
+
+#endif /* __APPS_INCLUDE_BENCHTIME_H */
@@ -594,6 +594,13 @@ void nsh_usbtrace(void);
 #ifndef CONFIG_NSH_DISABLE_PS
   int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
+#if defined(CONFIG_SCHED_CPULOAD) && !defined(CONFIG_NSH_DISABLE_TOP)
+  int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
+#if defined(CONFIG_DEV_NOTE) && CONFIG_NFILE_DESCRIPTORS > 0 && \
+   !defined(CONFIG_NSH_DISABLE_TRACE)
+  int cmd_trace(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+#endif
 #ifndef CONFIG_NSH_DISABLE_XD
   int cmd_xd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
@@ -398,6 +398,15 @@ static const struct cmdmap_s g_cmdmap[] =
   { "test",     cmd_test,     3, CONFIG_NSH_MAXARGUMENTS, "<expression>" },
 #endif
 
+#if defined(CONFIG_SCHED_CPULOAD) && !defined(CONFIG_NSH_DISABLE_TOP)
+  { "top",      cmd_top,      1, 1, NULL },
+#endif
+
+#if defined(CONFIG_DEV_NOTE) && CONFIG_NFILE_DESCRIPTORS > 0 && \
+   !defined(CONFIG_NSH_DISABLE_TRACE)
+  { "trace",    cmd_trace,    1, 1, NULL },
+#endif
+
 #if !defined(CONFIG_DISABLE_MOUNTPOINT) && CONFIG_NFILE_DESCRIPTORS > 0 && defined(CONFIG_FS_READABLE)
 # ifndef CONFIG_NSH_DISABLE_UMOUNT
   { "umount",   cmd_umount,   2, 2, "<dir-path>" },
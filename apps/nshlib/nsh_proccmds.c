@@ -42,9 +42,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <fcntl.h>
 #include <sched.h>
 #include <errno.h>
 
+#include <nuttx/clock.h>
+#include <nuttx/sched_note.h>
+
 #include "nsh.h"
 #include "nsh_console.h"
 
@@ -169,6 +173,40 @@ static void ps_task(FAR struct tcb_s *tcb, FAR void *arg)
 }
 #endif
 
+/****************************************************************************
+ * Name: top_task
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_CPULOAD) && !defined(CONFIG_NSH_DISABLE_TOP)
+static void top_task(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  struct nsh_vtbl_s *vtbl = (struct nsh_vtbl_s*)arg;
+  struct cpuload_s cpuload;
+  uint32_t permille = 0;
+
+  /* Get the share of the recent CPU time used by this thread in units
+   * of 0.1%
+   */
+
+  if (clock_cpuload(tcb->pid, &cpuload) == OK && cpuload.total > 0)
+    {
+      permille = (1000 * cpuload.active) / cpuload.total;
+    }
+
+  nsh_output(vtbl, "%5d %3d %3d.%01d%% ",
+             tcb->pid, tcb->sched_priority,
+             (int)(permille / 10), (int)(permille % 10));
+
+  /* Show the task name */
+
+#if CONFIG_TASK_NAME_SIZE > 0
+  nsh_output(vtbl, "%s\n", tcb->name);
+#else
+  nsh_output(vtbl, "<noname>\n");
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -208,6 +246,106 @@ int cmd_ps(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 }
 #endif
 
+/****************************************************************************
+ * Name: cmd_top
+ ****************************************************************************/
+
+#if defined(CONFIG_SCHED_CPULOAD) && !defined(CONFIG_NSH_DISABLE_TOP)
+int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  nsh_output(vtbl, "PID   PRI   CPU  NAME\n");
+  sched_foreach(top_task, vtbl);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: cmd_trace
+ ****************************************************************************/
+
+#if defined(CONFIG_DEV_NOTE) && CONFIG_NFILE_DESCRIPTORS > 0 && \
+   !defined(CONFIG_NSH_DISABLE_TRACE)
+int cmd_trace(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+  FAR struct note_s *notes;
+  FAR struct note_s *note;
+  size_t bufsize = CONFIG_SCHED_NOTE_NENTRIES * sizeof(struct note_s);
+  ssize_t nbytes;
+  int fd;
+
+  /* Read all of the buffered notes before printing any of them.  The
+   * output itself adds new notes, so reading until /dev/note is empty
+   * might never end.
+   */
+
+  notes = (FAR struct note_s *)malloc(bufsize);
+  if (!notes)
+    {
+      nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+      return ERROR;
+    }
+
+  fd = open("/dev/note", O_RDONLY);
+  if (fd < 0)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, argv[0], "open", NSH_ERRNO);
+      free(notes);
+      return ERROR;
+    }
+
+  nbytes = read(fd, notes, bufsize);
+  close(fd);
+
+  if (nbytes < 0)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, argv[0], "read", NSH_ERRNO);
+      free(notes);
+      return ERROR;
+    }
+
+  /* Then show each note */
+
+  nsh_output(vtbl, "    TIME   PID PRI EVENT\n");
+  for (note = notes; nbytes >= sizeof(struct note_s); note++)
+    {
+      nsh_output(vtbl, "%8lu %5d %3d ", (unsigned long)note->nt_systime,
+                 note->nt_pid, note->nt_priority);
+
+      switch (note->nt_type)
+        {
+        case NOTE_START:
+          nsh_output(vtbl, "start\n");
+          break;
+
+        case NOTE_STOP:
+          nsh_output(vtbl, "stop\n");
+          break;
+
+        case NOTE_SWITCH:
+          nsh_output(vtbl, "switch from %d\n", (int)note->nt_arg);
+          break;
+
+        case NOTE_IRQHANDLER:
+          nsh_output(vtbl, "irq %d\n", (int)note->nt_arg);
+          break;
+
+        case NOTE_SEMBLOCK:
+          nsh_output(vtbl, "semblock %p\n", (FAR void *)note->nt_arg);
+          break;
+
+        default:
+          nsh_output(vtbl, "type %d\n", note->nt_type);
+          break;
+        }
+
+      nbytes -= sizeof(struct note_s);
+    }
+
+  free(notes);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: cmd_kill
  ****************************************************************************/
@@ -142,6 +142,10 @@ void up_initialize(void)
   devzero_register();   /* Standard /dev/zero */
 #endif
 
+#if defined(CONFIG_DEV_NOTE)
+  devnote_register();   /* Scheduler instrumentation /dev/note */
+#endif
+
 #endif /* CONFIG_NFILE_DESCRIPTORS */
 
   /* Initialize the serial device driver */
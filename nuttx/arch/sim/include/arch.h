@@ -44,6 +44,8 @@
  * Included Files
  ************************************************************/
 
+#include <stdint.h>
+
 /************************************************************
  * Definitions
  ************************************************************/
@@ -71,6 +73,18 @@ extern "C" {
 #define EXTERN extern
 #endif
 
+/* Return the value of the host's monotonic clock in nanoseconds (see
+ * arch/sim/src/up_hosttime.c).
+ */
+
+EXTERN uint64_t up_hostnsec(void);
+
+/* Return the number of times that the simulation was woken up from a
+ * host sleep in the IDLE loop (see arch/sim/src/up_idle.c).
+ */
+
+EXTERN unsigned long up_idlewakeups(void);
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -58,16 +58,19 @@
 static int g_x11refresh = 0;
 #endif
 
+/* The number of times that the simulation had to be woken up from a host
+ * sleep in the IDLE loop.
+ */
+
+static unsigned long g_nwakeups;
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
 
-#if defined(CONFIG_SIM_WALLTIME) || defined(CONFIG_SIM_X11FB)
-extern int up_hostusleep(unsigned int usec);
 #ifdef CONFIG_SIM_X11FB
 extern void up_x11update(void);
 #endif
-#endif
 
 /****************************************************************************
  * Private Functions
@@ -94,11 +97,22 @@ extern void up_x11update(void);
 
 void up_idle(void)
 {
+#ifdef CONFIG_SCHED_TICKLESS
+  /* In the tickless mode, sleep until the next interval timer expiration
+   * and then process it.
+   */
+
+  if (up_timer_wait())
+    {
+      g_nwakeups++;
+    }
+#else
   /* If the system is idle, then process "fake" timer interrupts.
    * Hopefully, something will wake up.
    */
 
   sched_process_timer();
+#endif
 
   /* Run the network if enabled */
 
@@ -106,6 +120,12 @@ void up_idle(void)
   uipdriver_loop();
 #endif
 
+  /* Complete simulated SPI DMA transfers */
+
+#ifdef CONFIG_SIM_SPI_DMA
+  up_spipoll();
+#endif
+
   /* Fake some power management stuff for testing purposes */
 
 #ifdef CONFIG_PM
@@ -129,7 +149,10 @@ void up_idle(void)
    */
 
 #if defined(CONFIG_SIM_WALLTIME) || defined(CONFIG_SIM_X11FB)
+#ifndef CONFIG_SCHED_TICKLESS
   (void)up_hostusleep(1000000 / CLK_TCK);
+  g_nwakeups++;
+#endif
 
   /* Handle X11-related events */
 
@@ -157,3 +180,18 @@ void up_idle(void)
 #endif
 }
 
+/****************************************************************************
+ * Name: up_idlewakeups
+ *
+ * Description:
+ *   Return the number of times that the IDLE loop has slept on the host
+ *   and had to be woken up again.  With a periodic timer (and
+ *   CONFIG_SIM_WALLTIME), this happens on every tick; in the tickless mode
+ *   only when a timer actually expires.
+ *
+ ****************************************************************************/
+
+unsigned long up_idlewakeups(void)
+{
+  return g_nwakeups;
+}
@@ -43,6 +43,9 @@
 #include <nuttx/config.h>
 #include <nuttx/compiler.h>
 #include <sys/types.h>
+#ifndef __ASSEMBLY__
+#  include <stdbool.h>
+#endif
 #include <nuttx/irq.h>
 
 /**************************************************************************
@@ -162,6 +165,22 @@ extern void up_registerblockdevice(void);
 
 extern char *up_deviceimage(void);
 
+/* up_hostusleep.c ********************************************************/
+
+extern int up_hostusleep(unsigned int usec);
+
+/* up_tickless.c **********************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+extern bool up_timer_wait(void);
+#endif
+
+/* up_spi.c ***************************************************************/
+
+#ifdef CONFIG_SIM_SPI_DMA
+extern void up_spipoll(void);
+#endif
+
 /* up_stdio.c *************************************************************/
 
 extern size_t up_hostread(void *buffer, size_t len);
@@ -204,10 +223,16 @@ extern int up_buttonevent(int x, int y, int buttons);
 extern void tapdev_init(void);
 extern unsigned int tapdev_read(unsigned char *buf, unsigned int buflen);
 extern void tapdev_send(unsigned char *buf, unsigned int buflen);
+extern unsigned int tapdev_readv(unsigned char **bufs, unsigned int *lens,
+                                 int nbufs);
+extern void tapdev_sendv(unsigned char **bufs, unsigned int *lens,
+                         int nbufs);
 
 #define netdev_init()           tapdev_init()
 #define netdev_read(buf,buflen) tapdev_read(buf,buflen)
 #define netdev_send(buf,buflen) tapdev_send(buf,buflen)
+#define netdev_readv(bufs,lens,nbufs) tapdev_readv(bufs,lens,nbufs)
+#define netdev_sendv(bufs,lens,nbufs) tapdev_sendv(bufs,lens,nbufs)
 #endif
 
 /* up_wpcap.c *************************************************************/
@@ -0,0 +1,618 @@
+/****************************************************************************
+ * arch/sim/src/up_spi.c
+ * A simulated SPI bus
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/spi.h>
+#include <arch/arch.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SIM_SPI
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Each device ID from 1 through SIM_SPI_NDEVICES-1 selects a simulated
+ * device with SIM_SPI_NREGS 8-bit registers.  The first word sent after the
+ * device is selected is a command:  bit 7 set for a read, clear for a
+ * write, and the register address in bits 0-6.  Each following word reads
+ * or writes one register, and the address then advances.
+ */
+
+#define SIM_SPI_NDEVICES     16
+#define SIM_SPI_NREGS        128
+#define SIM_SPI_CMD_READ     0x80
+#define SIM_SPI_CMD_ADDRMASK 0x7f
+
+#define SIM_SPI_MAXFREQUENCY 50000000
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct sim_spidev_s
+{
+  struct spi_dev_s spidev;   /* Externally visible part of the SPI interface */
+#ifndef CONFIG_SPI_OWNBUS
+  sem_t exclsem;             /* Held while the bus is locked */
+#endif
+  uint32_t frequency;        /* Current SPI frequency */
+  int      nbits;            /* Current number of bits per word */
+  enum spi_dev_e devid;      /* The selected device (or SPIDEV_NONE) */
+  int      regaddr;          /* Next register address (-1: expect command) */
+  bool     read;             /* True: the command was a read */
+#ifdef CONFIG_SIM_SPI_DMA
+  bool     busy;             /* True: a chain is in progress */
+  uint64_t deadline;         /* Host time when the chain completes */
+  spi_chaindone_t done;      /* Called when the chain completes */
+  FAR void *arg;             /* Argument for done() */
+#endif
+  uint8_t  regs[SIM_SPI_NDEVICES][SIM_SPI_NREGS];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* Helpers */
+
+static uint8_t  spi_devword(FAR struct sim_spidev_s *priv, uint8_t out);
+static uint64_t spi_wiretime(FAR struct sim_spidev_s *priv, size_t nwords);
+static void     spi_transfer(FAR struct sim_spidev_s *priv,
+                             FAR const void *txbuffer, FAR void *rxbuffer,
+                             size_t nwords);
+static void     spi_wait(uint64_t end);
+
+/* SPI methods */
+
+#ifndef CONFIG_SPI_OWNBUS
+static int      spi_lock(FAR struct spi_dev_s *dev, bool lock);
+#endif
+static void     spi_select(FAR struct spi_dev_s *dev, enum spi_dev_e devid,
+                           bool selected);
+static uint32_t spi_setfrequency(FAR struct spi_dev_s *dev,
+                                 uint32_t frequency);
+static void     spi_setmode(FAR struct spi_dev_s *dev, enum spi_mode_e mode);
+static void     spi_setbits(FAR struct spi_dev_s *dev, int nbits);
+static uint8_t  spi_status(FAR struct spi_dev_s *dev, enum spi_dev_e devid);
+#ifdef CONFIG_SPI_CMDDATA
+static int      spi_cmddata(FAR struct spi_dev_s *dev, enum spi_dev_e devid,
+                            bool cmd);
+#endif
+static uint16_t spi_send(FAR struct spi_dev_s *dev, uint16_t wd);
+#ifdef CONFIG_SPI_EXCHANGE
+static void     spi_exchange(FAR struct spi_dev_s *dev,
+                             FAR const void *txbuffer, FAR void *rxbuffer,
+                             size_t nwords);
+#else
+static void     spi_sndblock(FAR struct spi_dev_s *dev,
+                             FAR const void *buffer, size_t nwords);
+static void     spi_recvblock(FAR struct spi_dev_s *dev, FAR void *buffer,
+                              size_t nwords);
+#endif
+#ifdef CONFIG_SIM_SPI_DMA
+static int      spi_chain(FAR struct spi_dev_s *dev,
+                          FAR struct spi_trans_s *first,
+                          spi_chaindone_t done, FAR void *arg);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct spi_ops_s g_spiops =
+{
+#ifndef CONFIG_SPI_OWNBUS
+  spi_lock,          /* lock */
+#endif
+  spi_select,        /* select */
+  spi_setfrequency,  /* setfrequency */
+  spi_setmode,       /* setmode */
+  spi_setbits,       /* setbits */
+  spi_status,        /* status */
+#ifdef CONFIG_SPI_CMDDATA
+  spi_cmddata,       /* cmddata */
+#endif
+  spi_send,          /* send */
+#ifdef CONFIG_SPI_EXCHANGE
+  spi_exchange,      /* exchange */
+#else
+  spi_sndblock,      /* sndblock */
+  spi_recvblock,     /* recvblock */
+#endif
+  NULL,              /* registercallback */
+#ifdef CONFIG_SPI_QUEUE
+#ifdef CONFIG_SIM_SPI_DMA
+  spi_chain          /* chain */
+#else
+  NULL               /* chain */
+#endif
+#endif
+};
+
+static struct sim_spidev_s g_spidev;
+static bool g_spiinitialized;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spi_devword
+ *
+ * Description:
+ *   Pass one word to the selected simulated device and return its answer.
+ *
+ ****************************************************************************/
+
+static uint8_t spi_devword(FAR struct sim_spidev_s *priv, uint8_t out)
+{
+  FAR uint8_t *regs;
+  uint8_t in = 0;
+
+  if (priv->devid <= SPIDEV_NONE || priv->devid >= SIM_SPI_NDEVICES)
+    {
+      /* Nothing is driving MISO */
+
+      return 0xff;
+    }
+
+  if (priv->regaddr < 0)
+    {
+      priv->read    = (out & SIM_SPI_CMD_READ) != 0;
+      priv->regaddr = out & SIM_SPI_CMD_ADDRMASK;
+      return 0;
+    }
+
+  regs = priv->regs[priv->devid];
+  if (priv->read)
+    {
+      in = regs[priv->regaddr];
+    }
+  else
+    {
+      regs[priv->regaddr] = out;
+    }
+
+  priv->regaddr = (priv->regaddr + 1) % SIM_SPI_NREGS;
+  return in;
+}
+
+/****************************************************************************
+ * Name: spi_wiretime
+ *
+ * Description:
+ *   The time in nanoseconds that nwords words take on the wire at the
+ *   current frequency and word size.
+ *
+ ****************************************************************************/
+
+static uint64_t spi_wiretime(FAR struct sim_spidev_s *priv, size_t nwords)
+{
+  int nbits = priv->nbits < 0 ? -priv->nbits : priv->nbits;
+
+  return (uint64_t)nwords * nbits * 1000000000ull / priv->frequency;
+}
+
+/****************************************************************************
+ * Name: spi_transfer
+ *
+ * Description:
+ *   Exchange words with the selected device.  If txbuffer is NULL, all
+ *   ones are sent;  if rxbuffer is NULL, the received data is discarded.
+ *
+ ****************************************************************************/
+
+static void spi_transfer(FAR struct sim_spidev_s *priv,
+                         FAR const void *txbuffer, FAR void *rxbuffer,
+                         size_t nwords)
+{
+  uint16_t out;
+  uint16_t in;
+  size_t i;
+
+  for (i = 0; i < nwords; i++)
+    {
+      if (priv->nbits > 8 || priv->nbits < -8)
+        {
+          out = txbuffer ? ((FAR const uint16_t *)txbuffer)[i] : 0xffff;
+          in  = spi_devword(priv, (uint8_t)out);
+          if (rxbuffer)
+            {
+              ((FAR uint16_t *)rxbuffer)[i] = in;
+            }
+        }
+      else
+        {
+          out = txbuffer ? ((FAR const uint8_t *)txbuffer)[i] : 0xff;
+          in  = spi_devword(priv, (uint8_t)out);
+          if (rxbuffer)
+            {
+              ((FAR uint8_t *)rxbuffer)[i] = (uint8_t)in;
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: spi_wait
+ *
+ * Description:
+ *   Busy-wait until the host time 'end', as a polled SPI driver waits for
+ *   the data to be shifted out.
+ *
+ ****************************************************************************/
+
+static void spi_wait(uint64_t end)
+{
+  while (up_hostnsec() < end)
+    {
+    }
+}
+
+/****************************************************************************
+ * Name: spi_lock
+ *
+ * Description:
+ *   Lock or unlock the bus.  See include/nuttx/spi.h.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SPI_OWNBUS
+static int spi_lock(FAR struct spi_dev_s *dev, bool lock)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+
+  if (lock)
+    {
+      /* Take the semaphore (perhaps waiting) */
+
+      while (sem_wait(&priv->exclsem) != 0)
+        {
+          /* The only case that an error should occur here is if the wait
+           * was awakened by a signal.
+           */
+
+          ASSERT(errno == EINTR);
+        }
+    }
+  else
+    {
+      (void)sem_post(&priv->exclsem);
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: spi_select
+ *
+ * Description:
+ *   Select or de-select a simulated device.  Selecting a device starts a
+ *   new command.
+ *
+ ****************************************************************************/
+
+static void spi_select(FAR struct spi_dev_s *dev, enum spi_dev_e devid,
+                       bool selected)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+
+  priv->devid   = selected ? devid : SPIDEV_NONE;
+  priv->regaddr = -1;
+}
+
+/****************************************************************************
+ * Name: spi_setfrequency
+ *
+ * Description:
+ *   Set the frequency that the wire time is calculated from.
+ *
+ ****************************************************************************/
+
+static uint32_t spi_setfrequency(FAR struct spi_dev_s *dev,
+                                 uint32_t frequency)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+
+  if (frequency > SIM_SPI_MAXFREQUENCY)
+    {
+      frequency = SIM_SPI_MAXFREQUENCY;
+    }
+  else if (frequency == 0)
+    {
+      frequency = 1;
+    }
+
+  priv->frequency = frequency;
+  return frequency;
+}
+
+/****************************************************************************
+ * Name: spi_setmode
+ *
+ * Description:
+ *   The simulated devices accept all modes.
+ *
+ ****************************************************************************/
+
+static void spi_setmode(FAR struct spi_dev_s *dev, enum spi_mode_e mode)
+{
+}
+
+/****************************************************************************
+ * Name: spi_setbits
+ *
+ * Description:
+ *   Set the number of bits per word.
+ *
+ ****************************************************************************/
+
+static void spi_setbits(FAR struct spi_dev_s *dev, int nbits)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+
+  if (nbits != 0)
+    {
+      priv->nbits = nbits;
+    }
+}
+
+/****************************************************************************
+ * Name: spi_status
+ ****************************************************************************/
+
+static uint8_t spi_status(FAR struct spi_dev_s *dev, enum spi_dev_e devid)
+{
+  return SPI_STATUS_PRESENT;
+}
+
+/****************************************************************************
+ * Name: spi_cmddata
+ ****************************************************************************/
+
+#ifdef CONFIG_SPI_CMDDATA
+static int spi_cmddata(FAR struct spi_dev_s *dev, enum spi_dev_e devid,
+                       bool cmd)
+{
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: spi_send
+ *
+ * Description:
+ *   Exchange one word.
+ *
+ ****************************************************************************/
+
+static uint16_t spi_send(FAR struct spi_dev_s *dev, uint16_t wd)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+  uint64_t end = up_hostnsec() + spi_wiretime(priv, 1);
+  uint16_t ret;
+
+  ret = spi_devword(priv, (uint8_t)wd);
+  spi_wait(end);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: spi_exchange, spi_sndblock, and spi_recvblock
+ *
+ * Description:
+ *   Exchange a block of words.  Like a polled SPI driver, these keep the
+ *   CPU busy for the time that the data takes on the wire.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPI_EXCHANGE
+static void spi_exchange(FAR struct spi_dev_s *dev,
+                         FAR const void *txbuffer, FAR void *rxbuffer,
+                         size_t nwords)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+  uint64_t end = up_hostnsec() + spi_wiretime(priv, nwords);
+
+  spi_transfer(priv, txbuffer, rxbuffer, nwords);
+  spi_wait(end);
+}
+#else
+static void spi_sndblock(FAR struct spi_dev_s *dev,
+                         FAR const void *buffer, size_t nwords)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+  uint64_t end = up_hostnsec() + spi_wiretime(priv, nwords);
+
+  spi_transfer(priv, buffer, NULL, nwords);
+  spi_wait(end);
+}
+
+static void spi_recvblock(FAR struct spi_dev_s *dev, FAR void *buffer,
+                          size_t nwords)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+  uint64_t end = up_hostnsec() + spi_wiretime(priv, nwords);
+
+  spi_transfer(priv, NULL, buffer, nwords);
+  spi_wait(end);
+}
+#endif
+
+/****************************************************************************
+ * Name: spi_chain
+ *
+ * Description:
+ *   Start a chain of transactions, as a DMA-capable driver would.  The data
+ *   is exchanged at once, but the chain only completes when the wire time
+ *   of all of the transactions has passed;  until then, the CPU is free.
+ *   Completion is detected by up_spipoll() in the IDLE loop.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_SPI_DMA
+static int spi_chain(FAR struct spi_dev_s *dev, FAR struct spi_trans_s *first,
+                     spi_chaindone_t done, FAR void *arg)
+{
+  FAR struct sim_spidev_s *priv = (FAR struct sim_spidev_s *)dev;
+  FAR struct spi_trans_s *trans;
+  uint64_t wiretime = 0;
+  bool selected = false;
+
+  if (priv->busy)
+    {
+      return -EBUSY;
+    }
+
+  for (trans = first; trans; trans = trans->flink)
+    {
+      (void)spi_setfrequency(dev, trans->frequency);
+      spi_setbits(dev, trans->nbits);
+
+      if (!selected)
+        {
+          spi_select(dev, trans->devid, true);
+        }
+
+      spi_transfer(priv, trans->txbuffer, trans->rxbuffer, trans->nwords);
+      wiretime += spi_wiretime(priv, trans->nwords);
+
+      selected = (trans->flags & SPI_TRANSFLAG_KEEPCS) != 0;
+      if (!selected)
+        {
+          spi_select(dev, trans->devid, false);
+        }
+
+      trans->result = OK;
+    }
+
+  priv->done     = done;
+  priv->arg      = arg;
+  priv->deadline = up_hostnsec() + wiretime;
+  priv->busy     = true;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_spiinitialize
+ *
+ * Description:
+ *   Return the simulated SPI bus.  Only port 0 exists.  Register r of the
+ *   simulated device with device ID d initially holds (d << 4) + r.
+ *
+ ****************************************************************************/
+
+FAR struct spi_dev_s *up_spiinitialize(int port)
+{
+  FAR struct sim_spidev_s *priv = &g_spidev;
+  int devid;
+  int reg;
+
+  if (port != 0)
+    {
+      return NULL;
+    }
+
+  if (!g_spiinitialized)
+    {
+      priv->spidev.ops = &g_spiops;
+#ifndef CONFIG_SPI_OWNBUS
+      sem_init(&priv->exclsem, 0, 1);
+#endif
+      priv->frequency  = 1000000;
+      priv->nbits      = 8;
+      priv->devid      = SPIDEV_NONE;
+      priv->regaddr    = -1;
+
+      for (devid = 0; devid < SIM_SPI_NDEVICES; devid++)
+        {
+          for (reg = 0; reg < SIM_SPI_NREGS; reg++)
+            {
+              priv->regs[devid][reg] = (uint8_t)((devid << 4) + reg);
+            }
+        }
+
+      g_spiinitialized = true;
+    }
+
+  return &priv->spidev;
+}
+
+/****************************************************************************
+ * Name: up_spipoll
+ *
+ * Description:
+ *   Called from the IDLE loop.  Complete the chain in progress if its wire
+ *   time has passed, as the DMA interrupt handler of a real driver would.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SIM_SPI_DMA
+void up_spipoll(void)
+{
+  FAR struct sim_spidev_s *priv = &g_spidev;
+
+  if (priv->busy && up_hostnsec() >= priv->deadline)
+    {
+      priv->busy = false;
+      priv->done(&priv->spidev, priv->arg);
+    }
+}
+#endif
+
+#endif /* CONFIG_SIM_SPI */
@@ -72,6 +72,10 @@ extern int uipdriver_setmacaddr(unsigned char *macaddr);
 
 #define DEVTAP          "/dev/net/tun"
 
+/* The most buffers that one frame is read into or sent from */
+
+#define TAPDEV_NIOV     128
+
 #ifndef CONFIG_EXAMPLES_UIP_DHCPC
 #  define UIP_IPADDR0   192
 #  define UIP_IPADDR1   168
@@ -133,6 +137,47 @@ static inline void dump_ethhdr(const char *msg, unsigned char *buf, int buflen)
 #  define dump_ethhdr(m,b,l)
 #endif
 
+static int tapdev_wait(void)
+{
+  fd_set                fdset;
+  struct timeval        tv;
+
+  /* We can't do anything if we failed to open the tap device */
+
+  if (gtapdevfd < 0)
+    {
+      return 0;
+    }
+
+  /* Wait for data on the tap device (or a timeout) */
+
+  tv.tv_sec  = 0;
+  tv.tv_usec = 1000;
+
+  FD_ZERO(&fdset);
+  FD_SET(gtapdevfd, &fdset);
+
+  return select(gtapdevfd + 1, &fdset, NULL, NULL, &tv);
+}
+
+#ifdef TAPDEV_DEBUG
+static inline int tapdev_drop(unsigned int buflen)
+{
+  syslog("tapdev_send: sending %d bytes\n", buflen);
+
+  gdrop++;
+  if(gdrop % 8 == 7)
+    {
+      syslog("Dropped a packet!\n");
+      return 1;
+    }
+
+  return 0;
+}
+#else
+#  define tapdev_drop(l) (0)
+#endif
+
 static int up_setmacaddr(void)
 {
   int sockfd;
@@ -207,55 +252,67 @@ void tapdev_init(void)
 
 unsigned int tapdev_read(unsigned char *buf, unsigned int buflen)
 {
-  fd_set                fdset;
-  struct timeval        tv;
-  int                   ret;
+  int ret;
 
-  /* We can't do anything if we failed to open the tap device */
+  ret = tapdev_wait();
+  if(ret <= 0)
+    {
+      return 0;
+    }
 
-  if (gtapdevfd < 0)
+  ret = read(gtapdevfd, buf, buflen);
+  if (ret < 0)
     {
+      syslog("TAPDEV: read failed: %d\n", -ret);
       return 0;
     }
 
-  /* Wait for data on the tap device (or a timeout) */
+  dump_ethhdr("read", buf, ret);
+  return ret;
+}
 
-  tv.tv_sec  = 0;
-  tv.tv_usec = 1000;
+/* Read one frame into 'nbufs' buffers.  bufs[i] holds lens[i] bytes. */
 
-  FD_ZERO(&fdset);
-  FD_SET(gtapdevfd, &fdset);
+unsigned int tapdev_readv(unsigned char **bufs, unsigned int *lens, int nbufs)
+{
+  struct iovec iov[TAPDEV_NIOV];
+  int ret;
+  int i;
 
-  ret = select(gtapdevfd + 1, &fdset, NULL, NULL, &tv);
-  if(ret == 0)
+  if (nbufs > TAPDEV_NIOV || tapdev_wait() <= 0)
     {
       return 0;
     }
 
-  ret = read(gtapdevfd, buf, buflen);
+  for (i = 0; i < nbufs; i++)
+    {
+      iov[i].iov_base = bufs[i];
+      iov[i].iov_len  = lens[i];
+    }
+
+  ret = readv(gtapdevfd, iov, nbufs);
   if (ret < 0)
     {
       syslog("TAPDEV: read failed: %d\n", -ret);
       return 0;
     }
 
-  dump_ethhdr("read", buf, ret);
+  if (ret > 0)
+    {
+      dump_ethhdr("read", bufs[0], ret);
+    }
+
   return ret;
 }
 
 void tapdev_send(unsigned char *buf, unsigned int buflen)
 {
   int ret;
-#ifdef TAPDEV_DEBUG
-  syslog("tapdev_send: sending %d bytes\n", buflen);
 
-  gdrop++;
-  if(gdrop % 8 == 7)
+  if (tapdev_drop(buflen))
     {
-      syslog("Dropped a packet!\n");
       return;
     }
-#endif
 
   ret = write(gtapdevfd, buf, buflen);
   if (ret < 0)
@@ -266,6 +323,41 @@ void tapdev_send(unsigned char *buf, unsigned int buflen)
   dump_ethhdr("write", buf, buflen);
 }
 
-#endif /* !__CYGWIN__ */
+/* Send one frame that is held in 'nbufs' buffers */
+
+void tapdev_sendv(unsigned char **bufs, unsigned int *lens, int nbufs)
+{
+  struct iovec iov[TAPDEV_NIOV];
+  unsigned int buflen = 0;
+  int ret;
+  int i;
+
+  if (nbufs > TAPDEV_NIOV)
+    {
+      syslog("TAPDEV: too many buffers: %d\n", nbufs);
+      return;
+    }
 
+  for (i = 0; i < nbufs; i++)
+    {
+      iov[i].iov_base = bufs[i];
+      iov[i].iov_len  = lens[i];
+      buflen         += lens[i];
+    }
 
+  if (tapdev_drop(buflen))
+    {
+      return;
+    }
+
+  ret = writev(gtapdevfd, iov, nbufs);
+  if (ret < 0)
+    {
+      syslog("TAPDEV: write failed: %d", -ret);
+      exit(1);
+    }
+
+  dump_ethhdr("write", bufs[0], buflen);
+}
+
+#endif /* !__CYGWIN__ */
@@ -0,0 +1,219 @@
+/****************************************************************************
+ * arch/sim/src/up_tickless.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+
+#include "up_internal.h"
+
+#ifdef CONFIG_SCHED_TICKLESS
+
+/****************************************************************************
+ * Private Definitions
+ ****************************************************************************/
+
+/* The longest time that the IDLE loop will sleep.  The network, the X11
+ * display, and simulated SPI DMA must be polled periodically; otherwise
+ * there is no need to wake up until the interval timer expires.
+ */
+
+#if defined(CONFIG_NET) || defined(CONFIG_SIM_X11FB) || defined(CONFIG_SIM_SPI_DMA)
+#  define SIM_MAXWAIT_NSEC ((uint64_t)NSEC_PER_SEC / CLK_TCK)
+#else
+#  define SIM_MAXWAIT_NSEC ((uint64_t)NSEC_PER_SEC)
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint64_t g_timer_base;     /* Host time when the time base started */
+static uint64_t g_timer_deadline; /* Host time when the interval expires */
+static bool     g_timer_active;   /* True: The interval timer is running */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_nsec2timespec
+ ****************************************************************************/
+
+static void up_nsec2timespec(uint64_t nsec, FAR struct timespec *ts)
+{
+  ts->tv_sec  = (time_t)(nsec / NSEC_PER_SEC);
+  ts->tv_nsec = (long)(nsec % NSEC_PER_SEC);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_timer_initialize
+ *
+ * Description:
+ *   Start the simulated time base.  The time base and the interval timer
+ *   are both built on the host's monotonic clock.
+ *
+ ****************************************************************************/
+
+void up_timer_initialize(void)
+{
+  g_timer_base   = up_hostnsec();
+  g_timer_active = false;
+}
+
+/****************************************************************************
+ * Name: up_timer_gettime
+ *
+ * Description:
+ *   Return the elapsed time since up_timer_initialize() was called.
+ *
+ ****************************************************************************/
+
+int up_timer_gettime(FAR struct timespec *ts)
+{
+  up_nsec2timespec(up_hostnsec() - g_timer_base, ts);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_cancel
+ *
+ * Description:
+ *   Stop the interval timer and return the time remaining.
+ *
+ ****************************************************************************/
+
+int up_timer_cancel(FAR struct timespec *ts)
+{
+  uint64_t now;
+
+  if (ts)
+    {
+      now = up_hostnsec();
+      if (g_timer_active && g_timer_deadline > now)
+        {
+          up_nsec2timespec(g_timer_deadline - now, ts);
+        }
+      else
+        {
+          ts->tv_sec  = 0;
+          ts->tv_nsec = 0;
+        }
+    }
+
+  g_timer_active = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_start
+ *
+ * Description:
+ *   Start the interval timer.  The simulation has no real interrupts; the
+ *   expiration is detected and reported by up_timer_wait() in the IDLE
+ *   loop.
+ *
+ ****************************************************************************/
+
+int up_timer_start(FAR const struct timespec *ts)
+{
+  g_timer_deadline = up_hostnsec() +
+                     (uint64_t)ts->tv_sec * NSEC_PER_SEC + ts->tv_nsec;
+  g_timer_active   = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_timer_wait
+ *
+ * Description:
+ *   Called from the IDLE loop:  Sleep on the host until the interval timer
+ *   expires (or until the network or display need to be serviced) and
+ *   then report the expiration, if any, to the OS.
+ *
+ * Returned Value:
+ *   True if the host was asked to sleep (i.e., the simulation was idle
+ *   and had to be woken up again).
+ *
+ ****************************************************************************/
+
+bool up_timer_wait(void)
+{
+  uint64_t now  = up_hostnsec();
+  uint64_t wait = SIM_MAXWAIT_NSEC;
+  bool slept    = false;
+
+  if (g_timer_active)
+    {
+      if (g_timer_deadline <= now)
+        {
+          wait = 0;
+        }
+      else if (g_timer_deadline - now < wait)
+        {
+          wait = g_timer_deadline - now;
+        }
+    }
+
+  if (wait > 0)
+    {
+      (void)up_hostusleep((unsigned int)((wait + 999) / 1000));
+      now   = up_hostnsec();
+      slept = true;
+    }
+
+  if (g_timer_active && g_timer_deadline <= now)
+    {
+      g_timer_active = false;
+      sched_timer_expiration();
+    }
+
+  return slept;
+}
+
+#endif /* CONFIG_SCHED_TICKLESS */
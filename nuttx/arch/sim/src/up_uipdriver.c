@@ -65,6 +65,17 @@
 
 #define BUF ((struct ether_header*)g_sim_dev.d_buf)
 
+/* With CONFIG_NET_IOB, frames are read into chains of I/O buffers and sent
+ * from them if the host device supports it.  SIM_NIOBS is the most buffers
+ * that one frame takes.
+ */
+
+#if defined(CONFIG_NET_IOB) && defined(netdev_readv)
+#  define SIM_NETDEV_IOB 1
+#  define SIM_NIOBS \
+     ((CONFIG_NET_BUFSIZE + CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -115,6 +126,117 @@ static inline int up_comparemac(uint8_t *paddr1, struct ether_addr *paddr2)
 }
 #endif
 
+#ifdef SIM_NETDEV_IOB
+static unsigned int sim_readiob(void)
+{
+  FAR struct iob_s *iob = NULL;
+  FAR struct iob_s *last = NULL;
+  FAR struct iob_s *next;
+  unsigned char *bufs[SIM_NIOBS];
+  unsigned int lens[SIM_NIOBS];
+  unsigned int size = 0;
+  unsigned int len;
+  int i;
+
+  /* Read the frame into a chain of I/O buffers, so that TCP and UDP can
+   * keep its data without copying it again.  If the pool is too low, read
+   * it into d_buf instead.
+   */
+
+  for (i = 0; i < SIM_NIOBS; i++)
+    {
+      next = iob_alloc();
+      if (!next)
+        {
+          iob_free_chain(iob);
+          return netdev_read((unsigned char*)g_sim_dev.d_buf, CONFIG_NET_BUFSIZE);
+        }
+
+      if (last)
+        {
+          last->io_flink = next;
+        }
+      else
+        {
+          iob = next;
+        }
+
+      last = next;
+
+      next->io_len = CONFIG_NET_BUFSIZE - size;
+      if (next->io_len > CONFIG_IOB_BUFSIZE)
+        {
+          next->io_len = CONFIG_IOB_BUFSIZE;
+        }
+
+      bufs[i] = next->io_data;
+      lens[i] = next->io_len;
+      size   += next->io_len;
+    }
+
+  len = netdev_readv(bufs, lens, SIM_NIOBS);
+  if (len == 0)
+    {
+      iob_free_chain(iob);
+      return 0;
+    }
+
+  iob->io_pktlen = size;
+  iob = iob_trimtail(iob, size - len);
+
+  /* The frame fits in d_buf because no more than CONFIG_NET_BUFSIZE bytes
+   * were read.
+   */
+
+  (void)uip_iobreceive(&g_sim_dev, iob);
+  return g_sim_dev.d_len;
+}
+
+static void sim_txflush(void)
+{
+  FAR struct iob_s *iob;
+  FAR struct iob_s *next;
+  unsigned char *bufs[SIM_NIOBS];
+  unsigned int lens[SIM_NIOBS];
+  int nbufs;
+
+  /* Send the queued frames, each one from its own chain */
+
+  while ((iob = iob_remove_queue(&g_sim_dev.d_txq)) != NULL)
+    {
+      nbufs = 0;
+      for (next = iob; next && nbufs < SIM_NIOBS; next = next->io_flink)
+        {
+          bufs[nbufs] = &next->io_data[next->io_offset];
+          lens[nbufs] = next->io_len;
+          nbufs++;
+        }
+
+      netdev_sendv(bufs, lens, nbufs);
+      iob_free_chain(iob);
+    }
+}
+#endif
+
+static void sim_transmit(void)
+{
+#ifdef SIM_NETDEV_IOB
+  /* Queue the frame so that all of the frames of one pass through
+   * uipdriver_loop() are sent together at its end.  If there are no free
+   * I/O buffers, send the queued frames first so that they stay in order.
+   */
+
+  if (uip_iobtxqueue(&g_sim_dev) == OK)
+    {
+      return;
+    }
+
+  sim_txflush();
+#endif
+
+  netdev_send(g_sim_dev.d_buf, g_sim_dev.d_len);
+}
+
 static int sim_uiptxpoll(struct uip_driver_s *dev)
 {
   /* If the polling resulted in data that should be sent out on the network,
@@ -124,7 +246,7 @@ static int sim_uiptxpoll(struct uip_driver_s *dev)
   if (g_sim_dev.d_len > 0)
     {
       uip_arp_out(&g_sim_dev);
-      netdev_send(g_sim_dev.d_buf, g_sim_dev.d_len);
+      sim_transmit();
     }
 
   /* If zero is returned, the polling will continue until all connections have
@@ -142,7 +264,11 @@ void uipdriver_loop(void)
 {
   /* netdev_read will return 0 on a timeout event and >0 on a data received event */
 
+#ifdef SIM_NETDEV_IOB
+  g_sim_dev.d_len = sim_readiob();
+#else
   g_sim_dev.d_len = netdev_read((unsigned char*)g_sim_dev.d_buf, CONFIG_NET_BUFSIZE);
+#endif
 
   /* Disable preemption through to the following so that it behaves a little more
    * like an interrupt (otherwise, the following logic gets pre-empted an behaves
@@ -177,7 +303,7 @@ void uipdriver_loop(void)
               if (g_sim_dev.d_len > 0)
                 {
                   uip_arp_out(&g_sim_dev);
-                  netdev_send(g_sim_dev.d_buf, g_sim_dev.d_len);
+                  sim_transmit();
                 }
             }
           else if (BUF->ether_type == htons(UIP_ETHTYPE_ARP))
@@ -191,10 +317,16 @@ void uipdriver_loop(void)
 
               if (g_sim_dev.d_len > 0)
                 {
-                  netdev_send(g_sim_dev.d_buf, g_sim_dev.d_len);
+                  sim_transmit();
                 }
             }
         }
+
+#ifdef SIM_NETDEV_IOB
+      /* Free the received chain unless TCP or UDP kept its data */
+
+      uip_iobrelease(&g_sim_dev);
+#endif
     }
 
   /* Otherwise, it must be a timeout event */
@@ -204,6 +336,10 @@ void uipdriver_loop(void)
       timer_reset(&g_periodic_timer);
       uip_timer(&g_sim_dev, sim_uiptxpoll, 1);
     }
+
+#ifdef SIM_NETDEV_IOB
+  sim_txflush();
+#endif
   sched_unlock();
 }
 
@@ -52,6 +52,23 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_BCH_NSECTORS
+#  define CONFIG_BCH_NSECTORS 1
+#endif
+
+#ifndef CONFIG_BCH_READAHEAD
+#  define CONFIG_BCH_READAHEAD 0
+#endif
+
+/* The sector that caused the miss plus the read-ahead sectors must all fit
+ * in the cache.
+ */
+
+#if CONFIG_BCH_READAHEAD >= CONFIG_BCH_NSECTORS
+#  undef CONFIG_BCH_READAHEAD
+#  define CONFIG_BCH_READAHEAD (CONFIG_BCH_NSECTORS - 1)
+#endif
+
 #define bchlib_semgive(d) sem_post(&(d)->sem)  /* To match bchlib_semtake */
 #define MAX_OPENCNT     (255)                  /* Limit of uint8_t */
 
@@ -59,17 +76,28 @@
  * Public Types
  ****************************************************************************/
 
+/* One cached sector */
+
+struct bchlib_sector_s
+{
+  size_t   sector;     /* The sector in the buffer ((size_t)-1: none) */
+  uint32_t lastuse;    /* Value of bchlib_s::usecount at the last access */
+  bool  dirty;         /* Data has been written to the buffer */
+  FAR uint8_t *buffer; /* One sector buffer */
+};
+
 struct bchlib_s
 {
   struct inode *inode; /* I-node of the block driver */
   sem_t    sem;        /* For atomic accesses to this structure */
   size_t   nsectors;   /* Number of sectors supported by the device */
-  size_t   sector;     /* The current sector in the buffer */
+  size_t   lastsector; /* The last sector accessed through the cache */
+  uint32_t usecount;   /* Incremented on each access through the cache */
   uint16_t sectsize;   /* The size of one sector on the device */
   uint8_t  refs;       /* Number of references */
-  bool  dirty;         /* Data has been written to the buffer */
   bool  readonly;      /* true:  Only read operations are supported */
-  FAR uint8_t *buffer; /* One sector buffer */
+  FAR uint8_t *buffer; /* CONFIG_BCH_NSECTORS contiguous sector buffers */
+  struct bchlib_sector_s cache[CONFIG_BCH_NSECTORS];
 };
 
 /****************************************************************************
@@ -91,8 +119,12 @@ EXTERN const struct file_operations bch_fops;
  ****************************************************************************/
 
 EXTERN void bchlib_semtake(FAR struct bchlib_s *bch);
+EXTERN void bchlib_initcache(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_flushsector(FAR struct bchlib_s *bch);
-EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector,
+                              FAR struct bchlib_sector_s **cached);
+EXTERN void bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                              size_t nsectors);
 
 #undef EXTERN
 #if defined(__cplusplus)
@@ -235,7 +235,7 @@ static int bch_ioctl(FAR struct file *filp, int cmd, unsigned long arg)
       FAR struct bchlib_s **bchr = (FAR struct bchlib_s **)((uintptr_t)arg);
 
       bchlib_semtake(bch);
-      if (!bchr && bch->refs < 255)
+      if (!bchr || bch->refs >= MAX_OPENCNT)
         {
           ret = -EINVAL;
         }
@@ -243,6 +243,7 @@ static int bch_ioctl(FAR struct file *filp, int cmd, unsigned long arg)
         {
           bch->refs++;
           *bchr = bch;
+          ret = OK;
         }
       bchlib_semgive(bch);
     }
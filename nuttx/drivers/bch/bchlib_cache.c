@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <assert.h>
@@ -65,15 +66,142 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: bchlib_writeback
+ *
+ * Description:
+ *   Write one cached sector back to the device (if dirty)
+ *
+ ****************************************************************************/
+
+static int bchlib_writeback(FAR struct bchlib_s *bch,
+                            FAR struct bchlib_sector_s *cached)
+{
+  FAR struct inode *inode;
+  ssize_t ret = OK;
+
+  if (cached->dirty)
+    {
+      inode = bch->inode;
+      ret = inode->u.i_bops->write(inode, cached->buffer, cached->sector, 1);
+      if (ret < 0)
+        {
+          fdbg("Write failed: %d\n", ret);
+        }
+      cached->dirty = false;
+    }
+  return (int)ret;
+}
+
+/****************************************************************************
+ * Name: bchlib_findsector
+ *
+ * Description:
+ *   Return the cache entry holding 'sector' or NULL if it is not cached
+ *
+ ****************************************************************************/
+
+static FAR struct bchlib_sector_s *
+bchlib_findsector(FAR struct bchlib_s *bch, size_t sector)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_NSECTORS; i++)
+    {
+      if (bch->cache[i].sector == sector)
+        {
+          return &bch->cache[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: bchlib_victims
+ *
+ * Description:
+ *   Select 'count' cache entries with contiguous buffers to be replaced.
+ *   The run is chosen whose most recently used entry was used least
+ *   recently.  Unused entries are chosen before any others.  Returns the
+ *   index of the first entry of the run.
+ *
+ ****************************************************************************/
+
+static int bchlib_victims(FAR struct bchlib_s *bch, int count)
+{
+  uint32_t bestage = 0;
+  uint32_t minage;
+  uint32_t age;
+  int best = 0;
+  int i;
+  int j;
+
+  for (i = 0; i + count <= CONFIG_BCH_NSECTORS; i++)
+    {
+      /* Find the age of the most recently used entry in this run */
+
+      minage = UINT32_MAX;
+      for (j = i; j < i + count; j++)
+        {
+          if (bch->cache[j].sector == (size_t)-1)
+            {
+              age = UINT32_MAX;
+            }
+          else
+            {
+              age = bch->usecount - bch->cache[j].lastuse;
+            }
+
+          if (age < minage)
+            {
+              minage = age;
+            }
+        }
+
+      if (i == 0 || minage > bestage)
+        {
+          best    = i;
+          bestage = minage;
+        }
+    }
+
+  return best;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: bchlib_initcache
+ *
+ * Description:
+ *   Divide the sector buffer into CONFIG_BCH_NSECTORS empty cache entries
+ *
+ ****************************************************************************/
+
+void bchlib_initcache(FAR struct bchlib_s *bch)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_NSECTORS; i++)
+    {
+      bch->cache[i].sector  = (size_t)-1;
+      bch->cache[i].lastuse = 0;
+      bch->cache[i].dirty   = false;
+      bch->cache[i].buffer  = &bch->buffer[i * bch->sectsize];
+    }
+
+  bch->lastsector = (size_t)-1;
+  bch->usecount   = 0;
+}
+
 /****************************************************************************
  * Name: bchlib_flushsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Flush the current contents of all cached sectors (if dirty)
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -82,52 +210,139 @@
 
 int bchlib_flushsector(FAR struct bchlib_s *bch)
 {
-  FAR struct inode *inode;
-  ssize_t ret = OK;
+  int ret = OK;
+  int err;
+  int i;
 
-  if (bch->dirty)
+  for (i = 0; i < CONFIG_BCH_NSECTORS; i++)
     {
-      inode = bch->inode;
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
-      if (ret < 0)
+      err = bchlib_writeback(bch, &bch->cache[i]);
+      if (err < 0 && ret >= 0)
         {
-          fdbg("Write failed: %d\n");
+          ret = err;
         }
-      bch->dirty = false;
     }
-  return (int)ret;
+
+  return ret;
 }
 
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Get the cache entry holding 'sector', reading the sector from the
+ *   device if it is not already cached.  The least recently used entry is
+ *   replaced (after it is flushed, if dirty).  If the sector immediately
+ *   follows the last sector accessed, then up to CONFIG_BCH_READAHEAD
+ *   following sectors are read at the same time.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
  *
  ****************************************************************************/
 
-int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
+int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector,
+                      FAR struct bchlib_sector_s **cached)
 {
+  FAR struct bchlib_sector_s *entry;
   FAR struct inode *inode;
-  ssize_t ret = OK;
+  ssize_t ret;
+  size_t nread;
+  int first;
+  int i;
+
+  bch->usecount++;
 
-  if (bch->sector != sector)
+  entry = bchlib_findsector(bch, sector);
+  if (!entry)
     {
-      inode = bch->inode;
+      nread = 1;
 
-      (void)bchlib_flushsector(bch);
-      bch->sector = (size_t)-1;
+#if CONFIG_BCH_READAHEAD > 0
+      /* Read ahead if the access is sequential.  Stop short of the end of
+       * the device or of any sector that is already cached (which may be
+       * dirty).
+       */
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
-      if (ret < 0)
+      if (sector == bch->lastsector + 1)
+        {
+          nread = CONFIG_BCH_READAHEAD + 1;
+          if (sector + nread > bch->nsectors)
+            {
+              nread = bch->nsectors - sector;
+            }
+
+          for (i = 1; i < nread; i++)
+            {
+              if (bchlib_findsector(bch, sector + i))
+                {
+                  nread = i;
+                  break;
+                }
+            }
+        }
+#endif
+
+      /* Free the entries that will receive the sectors */
+
+      first = bchlib_victims(bch, (int)nread);
+      for (i = first; i < first + (int)nread; i++)
         {
-          fdbg("Read failed: %d\n");
+          (void)bchlib_writeback(bch, &bch->cache[i]);
+          bch->cache[i].sector = (size_t)-1;
         }
-      bch->sector = sector;
+
+      /* Then read all of the sectors with one request */
+
+      inode = bch->inode;
+      ret = inode->u.i_bops->read(inode, bch->cache[first].buffer, sector,
+                                  nread);
+      if (ret <= 0)
+        {
+          fdbg("Read failed: %d\n", ret);
+          return ret < 0 ? (int)ret : -EIO;
+        }
+
+      for (i = 0; i < (int)ret && i < (int)nread; i++)
+        {
+          bch->cache[first + i].sector  = sector + i;
+          bch->cache[first + i].lastuse = bch->usecount;
+        }
+
+      entry = &bch->cache[first];
     }
-  return (int)ret;
+
+  entry->lastuse  = bch->usecount;
+  bch->lastsector = sector;
+  *cached = entry;
+  return OK;
 }
 
+/****************************************************************************
+ * Name: bchlib_invalidate
+ *
+ * Description:
+ *   Discard any cached copies of the sectors in the range.  This is
+ *   called when the sectors are written to the device directly.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_invalidate(FAR struct bchlib_s *bch, size_t sector,
+                       size_t nsectors)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_NSECTORS; i++)
+    {
+      if (bch->cache[i].sector != (size_t)-1 &&
+          bch->cache[i].sector >= sector &&
+          bch->cache[i].sector <  sector + nsectors)
+        {
+          bch->cache[i].sector = (size_t)-1;
+          bch->cache[i].dirty  = false;
+        }
+    }
+}
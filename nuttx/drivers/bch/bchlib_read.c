@@ -82,6 +82,7 @@
 ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t len)
 {
   FAR struct bchlib_s *bch = (FAR struct bchlib_s *)handle;
+  FAR struct bchlib_sector_s *cached;
   size_t   nsectors;
   size_t   sector;
   uint16_t sectoffset;
@@ -113,9 +114,13 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
   bytesread = 0;
   if (sectoffset > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector, &cached);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector to the user buffer */
 
@@ -128,7 +133,7 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
           nbytes = len;
         }
 
-      memcpy(buffer, &bch->buffer[sectoffset], nbytes);
+      memcpy(buffer, &cached->buffer[sectoffset], nbytes);
 
       /* Adjust pointers and counts */
 
@@ -157,6 +162,16 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
           nsectors = bch->nsectors - sector;
         }
 
+#ifdef CONFIG_BCH_WRITEBACK
+      /* The device must be up to date before it is read directly */
+
+      ret = bchlib_flushsector(bch);
+      if (ret < 0)
+        {
+          return bytesread > 0 ? bytesread : ret;
+        }
+#endif
+
       ret = bch->inode->u.i_bops->read(bch->inode, (FAR uint8_t *)buffer,
                                        sector, nsectors);
       if (ret < 0)
@@ -186,13 +201,17 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
 
   if (len > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector, &cached);
+      if (ret < 0)
+        {
+          return bytesread > 0 ? bytesread : ret;
+        }
 
       /* Copy the head end of the sector to the user buffer */
 
-      memcpy(buffer, bch->buffer, len);
+      memcpy(buffer, cached->buffer, len);
 
       /* Adjust counts */
 
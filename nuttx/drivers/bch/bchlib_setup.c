@@ -137,12 +137,11 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
   sem_init(&bch->sem, 0, 1);
   bch->nsectors = geo.geo_nsectors;
   bch->sectsize = geo.geo_sectorsize;
-  bch->sector   = (size_t)-1;
   bch->readonly = readonly;
 
-  /* Allocate the sector I/O buffer */
+  /* Allocate the sector I/O buffers */
 
-  bch->buffer = (FAR uint8_t *)kmalloc(bch->sectsize);
+  bch->buffer = (FAR uint8_t *)kmalloc(bch->sectsize * CONFIG_BCH_NSECTORS);
   if (!bch->buffer)
     {
       fdbg("Failed to allocate sector buffer\n");
@@ -150,6 +149,8 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
       goto errout_with_bch;
     }
 
+  bchlib_initcache(bch);
+
   *handle = bch;
   return OK;
 
@@ -83,6 +83,7 @@
 ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, size_t len)
 {
   FAR struct bchlib_s *bch = (FAR struct bchlib_s *)handle;
+  FAR struct bchlib_sector_s *cached;
   size_t   nsectors;
   size_t   sector;
   uint16_t sectoffset;
@@ -112,9 +113,13 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
   byteswritten = 0;
   if (sectoffset > 0)
     {
-      /* Read the full sector into the sector buffer */
+      /* Read the full sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector, &cached);
+      if (ret < 0)
+        {
+          return ret;
+        }
 
       /* Copy the tail end of the sector from the user buffer */
 
@@ -127,8 +132,8 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
           nbytes = len;
         }
 
-      memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-      bch->dirty = true;
+      memcpy(&cached->buffer[sectoffset], buffer, nbytes);
+      cached->dirty = true;
 
       /* Adjust pointers and counts */
 
@@ -157,6 +162,10 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
           nsectors = bch->nsectors - sector;
         }
 
+      /* Any cached copies of these sectors are now stale */
+
+      bchlib_invalidate(bch, sector, nsectors);
+
       /* Write the contiguous sectors */
 
       ret = bch->inode->u.i_bops->write(bch->inode, (FAR uint8_t *)buffer,
@@ -188,28 +197,36 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
 
   if (len > 0)
     {
-      /* Read the sector into the sector buffer */
+      /* Read the sector into the sector cache */
 
-      bchlib_readsector(bch, sector);
+      ret = bchlib_readsector(bch, sector, &cached);
+      if (ret < 0)
+        {
+          return byteswritten > 0 ? byteswritten : ret;
+        }
 
       /* Copy the head end of the sector from the user buffer */
 
-      memcpy(bch->buffer, buffer, len);
-      bch->dirty = true;
+      memcpy(cached->buffer, buffer, len);
+      cached->dirty = true;
 
       /* Adjust counts */
 
       byteswritten += len;
     }
 
-  /* Finally, flush any cached writes to the device as well */
+  /* Finally, flush any cached writes to the device as well (unless they
+   * are deferred until the sectors are replaced or the driver is closed).
+   */
 
+#ifndef CONFIG_BCH_WRITEBACK
   ret = bchlib_flushsector(bch);
   if (ret < 0)
     {
       fdbg("Flush failed: %d\n", ret);
       return ret;
     }
+#endif
 
   return byteswritten;
 }
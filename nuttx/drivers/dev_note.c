@@ -0,0 +1,124 @@
+/****************************************************************************
+ * drivers/dev_note.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+#include <nuttx/sched_note.h>
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static ssize_t devnote_read(FAR struct file *, FAR char *, size_t);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct file_operations devnote_fops =
+{
+  0,             /* open */
+  0,             /* close */
+  devnote_read,  /* read */
+  0,             /* write */
+  0,             /* seek */
+  0              /* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+  , 0            /* poll */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: devnote_read
+ *
+ * Description:
+ *   Return as many whole notes (struct note_s) as will fit in the buffer.
+ *   The notes that are returned are removed from the circular buffer.
+ *   Zero (end-of-file) is returned if there are no notes.
+ *
+ ****************************************************************************/
+
+static ssize_t devnote_read(FAR struct file *filp, FAR char *buffer, size_t len)
+{
+  struct note_s note;
+  ssize_t nread = 0;
+
+  if (len < sizeof(struct note_s))
+    {
+      return -EINVAL;
+    }
+
+  /* The caller's buffer need not be aligned, so copy one note at a time */
+
+  while (len >= sizeof(struct note_s) && sched_note_read(&note, 1) > 0)
+    {
+      memcpy(buffer, &note, sizeof(struct note_s));
+      buffer += sizeof(struct note_s);
+      len    -= sizeof(struct note_s);
+      nread  += sizeof(struct note_s);
+    }
+
+  return nread;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: devnote_register
+ *
+ * Description:
+ *   Register /dev/note
+ *
+ ****************************************************************************/
+
+void devnote_register(void)
+{
+  (void)register_driver("/dev/note", &devnote_fops, 0444, NULL);
+}
@@ -46,10 +46,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <semaphore.h>
 #include <debug.h>
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd.h>
@@ -60,13 +63,57 @@
  ****************************************************************************/
 
 #if defined(CONFIG_FS_READAHEAD) || (defined(CONFIG_FS_WRITABLE) && defined(CONFIG_FS_WRITEBUFFER))
-#  defined CONFIG_FTL_RWBUFFER 1
+#  define CONFIG_FTL_RWBUFFER 1
+#endif
+
+/* The erase block write-back cache is only used if the FTL is writable */
+
+#ifndef CONFIG_FS_WRITABLE
+#  undef CONFIG_FTL_WRITEBACK
+#endif
+
+#ifdef CONFIG_FTL_WRITEBACK
+#  ifndef CONFIG_FTL_WRITEBACK_NBLOCKS
+#    define CONFIG_FTL_WRITEBACK_NBLOCKS 1
+#  endif
+
+#  if CONFIG_FTL_WRITEBACK_NBLOCKS < 1
+#    error "CONFIG_FTL_WRITEBACK_NBLOCKS must be at least one"
+#  endif
+
+/* The timed write-back requires the work queue */
+
+#  ifndef CONFIG_SCHED_WORKQUEUE
+#    undef CONFIG_FTL_WRITEBACK_DELAY
+#  endif
+
+#  ifndef CONFIG_FTL_WRITEBACK_DELAY
+#    define CONFIG_FTL_WRITEBACK_DELAY 0
+#  endif
+
+#  if CONFIG_FTL_WRITEBACK_DELAY > 0
+#    define FTL_WRITEBACK_TIMER 1
+#  endif
+
+#  define ftl_semgive(d) sem_post(&(d)->exclsem)
 #endif
 
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_FTL_WRITEBACK
+/* This structure describes one erase block held in the write-back cache */
+
+struct ftl_wbslot_s
+{
+  FAR uint8_t          *buffer;  /* In-memory image of the erase block */
+  off_t                 eblock;  /* Cached erase block number (-1: unused) */
+  uint32_t              age;     /* Time of last use (for LRU eviction) */
+  bool                  dirty;   /* True: Image differs from FLASH */
+};
+#endif
+
 struct ftl_struct_s
 {
   FAR struct mtd_dev_s *mtd;     /* Contained MTD interface */
@@ -78,6 +125,14 @@ struct ftl_struct_s
 #ifdef CONFIG_FS_WRITABLE
   FAR uint8_t          *eblock;  /* One, in-memory erase block */
 #endif
+#ifdef CONFIG_FTL_WRITEBACK
+  sem_t                 exclsem; /* Assures exclusive access to the cache */
+  uint32_t              wbclock; /* Incremented on each use of the cache */
+#ifdef FTL_WRITEBACK_TIMER
+  struct work_s         work;    /* Delayed write-back after write inactivity */
+#endif
+  struct ftl_wbslot_s   wbcache[CONFIG_FTL_WRITEBACK_NBLOCKS];
+#endif
 };
 
 /****************************************************************************
@@ -96,6 +151,21 @@ static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
 static ssize_t ftl_write(FAR struct inode *inode, const unsigned char *buffer,
                  size_t start_sector, unsigned int nsectors);
 #endif
+#ifdef CONFIG_FTL_WRITEBACK
+static void    ftl_semtake(FAR struct ftl_struct_s *dev);
+static int     ftl_wbwriteback(FAR struct ftl_struct_s *dev,
+                 FAR struct ftl_wbslot_s *slot);
+static int     ftl_wbflush(FAR struct ftl_struct_s *dev);
+static int     ftl_wbload(FAR struct ftl_struct_s *dev, off_t eblock,
+                 FAR struct ftl_wbslot_s **slotp);
+static void    ftl_wboverlay(FAR struct ftl_struct_s *dev, FAR uint8_t *buffer,
+                 off_t startblock, size_t nblocks);
+static ssize_t ftl_wbwrite(FAR void *priv, FAR const uint8_t *buffer,
+                 off_t startblock, size_t nblocks);
+#ifdef FTL_WRITEBACK_TIMER
+static void    ftl_wbtimeout(FAR void *arg);
+#endif
+#endif
 static int     ftl_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int     ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
 
@@ -143,8 +213,25 @@ static int ftl_open(FAR struct inode *inode)
 
 static int ftl_close(FAR struct inode *inode)
 {
+#ifdef CONFIG_FTL_WRITEBACK
+  FAR struct ftl_struct_s *dev;
+  int ret;
+
+  fvdbg("Entry\n");
+
+  /* Write back any modified erase blocks held in the cache */
+
+  DEBUGASSERT(inode && inode->i_private);
+  dev = (struct ftl_struct_s *)inode->i_private;
+
+  ftl_semtake(dev);
+  ret = ftl_wbflush(dev);
+  ftl_semgive(dev);
+  return ret;
+#else
   fvdbg("Entry\n");
   return OK;
+#endif
 }
 
 /****************************************************************************
@@ -162,12 +249,27 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
 
   /* Read the full erase block into the buffer */
 
+#ifdef CONFIG_FTL_WRITEBACK
+  ftl_semtake(dev);
+#endif
+
   nread   = MTD_BREAD(dev->mtd, startblock, nblocks, buffer);
   if (nread != nblocks)
     {
       fdbg("Read %d blocks starting at block %d failed: %d\n",
             nblocks, startblock, nread);
     }
+
+#ifdef CONFIG_FTL_WRITEBACK
+  /* FLASH may be stale where modified erase blocks are still cached */
+
+  else
+    {
+      ftl_wboverlay(dev, buffer, startblock, nblocks);
+    }
+
+  ftl_semgive(dev);
+#endif
   return nread;
 }
 
@@ -390,12 +492,369 @@ static ssize_t ftl_write(FAR struct inode *inode, const unsigned char *buffer,
   dev = (struct ftl_struct_s *)inode->i_private;
 #ifdef CONFIG_FS_WRITEBUFFER
   return rwb_write(&dev->rwb, start_sector, nsectors, buffer);
+#elif defined(CONFIG_FTL_WRITEBACK)
+  return ftl_wbwrite(dev, buffer, start_sector, nsectors);
 #else
   return ftl_flush(dev, buffer, start_sector, nsectors);
 #endif
 }
 #endif
 
+/****************************************************************************
+ * Name: ftl_semtake
+ *
+ * Description: Get exclusive access to the erase block write-back cache
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static void ftl_semtake(FAR struct ftl_struct_s *dev)
+{
+  /* Take the semaphore (perhaps waiting) */
+
+  while (sem_wait(&dev->exclsem) != 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      ASSERT(errno == EINTR);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wbwriteback
+ *
+ * Description:
+ *   Erase the FLASH erase block held in a cache slot and write the cached
+ *   image back to it, if the image has been modified.  The caller holds
+ *   the cache semaphore.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static int ftl_wbwriteback(FAR struct ftl_struct_s *dev,
+                           FAR struct ftl_wbslot_s *slot)
+{
+  off_t  rwblock;
+  size_t nxfrd;
+  int    ret;
+
+  if (slot->eblock < 0 || !slot->dirty)
+    {
+      return OK;
+    }
+
+  fvdbg("Write back erase block=%d\n", slot->eblock);
+
+  ret = MTD_ERASE(dev->mtd, slot->eblock, 1);
+  if (ret < 0)
+    {
+      fdbg("Erase block=%d failed: %d\n", slot->eblock, ret);
+      return ret;
+    }
+
+  rwblock = slot->eblock * dev->blkper;
+  nxfrd   = MTD_BWRITE(dev->mtd, rwblock, dev->blkper, slot->buffer);
+  if (nxfrd != dev->blkper)
+    {
+      fdbg("Write erase block %d failed: %d\n", rwblock, nxfrd);
+      return -EIO;
+    }
+
+  slot->dirty = false;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wbflush
+ *
+ * Description:
+ *   Write back every modified erase block in the cache.  The caller holds
+ *   the cache semaphore.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static int ftl_wbflush(FAR struct ftl_struct_s *dev)
+{
+  int result = OK;
+  int ret;
+  int i;
+
+#ifdef FTL_WRITEBACK_TIMER
+  /* Nothing will be left for the timer to do */
+
+  (void)work_cancel(LPWORK, &dev->work);
+#endif
+
+  /* Try every slot, even if one of them fails, and report the first
+   * failure.
+   */
+
+  for (i = 0; i < CONFIG_FTL_WRITEBACK_NBLOCKS; i++)
+    {
+      ret = ftl_wbwriteback(dev, &dev->wbcache[i]);
+      if (ret < 0 && result == OK)
+        {
+          result = ret;
+        }
+    }
+
+  return result;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wbload
+ *
+ * Description:
+ *   Return the cache slot that holds the erase block, loading it from FLASH
+ *   if it is not already cached.  The least recently used slot is written
+ *   back and re-used when the cache is full.  The caller holds the cache
+ *   semaphore.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static int ftl_wbload(FAR struct ftl_struct_s *dev, off_t eblock,
+                      FAR struct ftl_wbslot_s **slotp)
+{
+  FAR struct ftl_wbslot_s *slot;
+  FAR struct ftl_wbslot_s *victim = NULL;
+  size_t nxfrd;
+  int    ret;
+  int    i;
+
+  /* Is the erase block already in the cache?  If not, pick an unused slot
+   * or, failing that, the slot that was used least recently.
+   */
+
+  for (i = 0; i < CONFIG_FTL_WRITEBACK_NBLOCKS; i++)
+    {
+      slot = &dev->wbcache[i];
+      if (slot->eblock == eblock)
+        {
+          goto found;
+        }
+
+      if (!victim || (victim->eblock >= 0 &&
+          (slot->eblock < 0 || (int32_t)(slot->age - victim->age) < 0)))
+        {
+          victim = slot;
+        }
+    }
+
+  /* Write back the old content of the slot, then read the new erase block */
+
+  slot = victim;
+  ret  = ftl_wbwriteback(dev, slot);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  slot->eblock = -1;
+  nxfrd = MTD_BREAD(dev->mtd, eblock * dev->blkper, dev->blkper, slot->buffer);
+  if (nxfrd != dev->blkper)
+    {
+      fdbg("Read erase block %d failed: %d\n", eblock * dev->blkper, nxfrd);
+      return -EIO;
+    }
+
+  slot->eblock = eblock;
+  slot->dirty  = false;
+
+found:
+  slot->age = ++dev->wbclock;
+  *slotp    = slot;
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wboverlay
+ *
+ * Description:
+ *   Replace data just read from FLASH with the content of any modified
+ *   erase blocks in the cache.  The caller holds the cache semaphore.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static void ftl_wboverlay(FAR struct ftl_struct_s *dev, FAR uint8_t *buffer,
+                          off_t startblock, size_t nblocks)
+{
+  FAR struct ftl_wbslot_s *slot;
+  off_t first;
+  off_t last;
+  int   i;
+
+  for (i = 0; i < CONFIG_FTL_WRITEBACK_NBLOCKS; i++)
+    {
+      slot = &dev->wbcache[i];
+      if (slot->eblock < 0 || !slot->dirty)
+        {
+          continue;
+        }
+
+      /* Get the range of R/W blocks common to the read and the erase block */
+
+      first = slot->eblock * dev->blkper;
+      last  = first + dev->blkper;
+
+      if (first < startblock)
+        {
+          first = startblock;
+        }
+
+      if (last > startblock + (off_t)nblocks)
+        {
+          last = startblock + nblocks;
+        }
+
+      if (first < last)
+        {
+          memcpy(buffer + (first - startblock) * dev->geo.blocksize,
+                 slot->buffer +
+                 (first - slot->eblock * dev->blkper) * dev->geo.blocksize,
+                 (last - first) * dev->geo.blocksize);
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wbwrite
+ *
+ * Description:
+ *   Write the specified number of sectors through the erase block cache.
+ *   Writes of whole erase blocks go directly to FLASH; partial erase blocks
+ *   are merged into the cached image of the erase block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_WRITEBACK
+static ssize_t ftl_wbwrite(FAR void *priv, FAR const uint8_t *buffer,
+                           off_t startblock, size_t nblocks)
+{
+  struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
+  FAR struct ftl_wbslot_s *slot;
+  off_t   eblock;
+  off_t   offset;
+  size_t  remaining;
+  size_t  nxfr;
+  ssize_t nxfrd;
+#ifdef FTL_WRITEBACK_TIMER
+  bool    cached = false;
+#endif
+  int     ret;
+  int     i;
+
+  ftl_semtake(dev);
+
+  for (remaining = nblocks; remaining > 0; remaining -= nxfr)
+    {
+      /* How much of this erase block will be written? */
+
+      eblock = startblock / dev->blkper;
+      offset = startblock - eblock * dev->blkper;
+      nxfr   = dev->blkper - offset;
+      if (nxfr > remaining)
+        {
+          nxfr = remaining;
+        }
+
+      if (nxfr == dev->blkper)
+        {
+          /* The whole erase block is replaced.  Any cached image of it is
+           * obsolete and the new data can be written directly.
+           */
+
+          for (i = 0; i < CONFIG_FTL_WRITEBACK_NBLOCKS; i++)
+            {
+              if (dev->wbcache[i].eblock == eblock)
+                {
+                  dev->wbcache[i].eblock = -1;
+                  dev->wbcache[i].dirty  = false;
+                }
+            }
+
+          nxfrd = ftl_flush(dev, buffer, startblock, nxfr);
+          if (nxfrd != nxfr)
+            {
+              ret = nxfrd < 0 ? nxfrd : -EIO;
+              goto errout_with_semaphore;
+            }
+        }
+      else
+        {
+          /* Merge the data into the cached image of the erase block */
+
+          ret = ftl_wbload(dev, eblock, &slot);
+          if (ret < 0)
+            {
+              goto errout_with_semaphore;
+            }
+
+          fvdbg("Cache %d blocks in erase block=%d at block offset=%d\n",
+                nxfr, eblock, offset);
+
+          memcpy(slot->buffer + offset * dev->geo.blocksize, buffer,
+                 nxfr * dev->geo.blocksize);
+          slot->dirty = true;
+#ifdef FTL_WRITEBACK_TIMER
+          cached      = true;
+#endif
+        }
+
+      startblock += nxfr;
+      buffer     += nxfr * dev->geo.blocksize;
+    }
+
+#ifdef FTL_WRITEBACK_TIMER
+  /* (Re-)start the write-back timer */
+
+  if (cached)
+    {
+      (void)work_cancel(LPWORK, &dev->work);
+      (void)work_queue(LPWORK, &dev->work, ftl_wbtimeout, (FAR void *)dev,
+                       MSEC2TICK(CONFIG_FTL_WRITEBACK_DELAY));
+    }
+#endif
+
+  ftl_semgive(dev);
+  return nblocks;
+
+errout_with_semaphore:
+  ftl_semgive(dev);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: ftl_wbtimeout
+ *
+ * Description:
+ *   Runs on the worker thread when no write has been received for
+ *   CONFIG_FTL_WRITEBACK_DELAY milliseconds.
+ *
+ ****************************************************************************/
+
+#ifdef FTL_WRITEBACK_TIMER
+static void ftl_wbtimeout(FAR void *arg)
+{
+  FAR struct ftl_struct_s *dev = (FAR struct ftl_struct_s *)arg;
+  DEBUGASSERT(dev != NULL);
+
+  ftl_semtake(dev);
+  (void)ftl_wbflush(dev);
+  ftl_semgive(dev);
+}
+#endif
+
 /****************************************************************************
  * Name: ftl_geometry
  *
@@ -447,10 +906,40 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 
   fvdbg("Entry\n");
   DEBUGASSERT(inode && inode->i_private);
+  dev = (struct ftl_struct_s *)inode->i_private;
 
-  /* Only one block driver ioctl command is supported by this driver (and
-   * that command is just passed on to the MTD driver in a slightly
-   * different form).
+  /* BIOC_FLUSH first writes out any blocks held in the block write buffer
+   * (which may load them into the write-back cache), then writes back any
+   * erase blocks held in the write-back cache.  It succeeds trivially if
+   * there is no buffering.
+   */
+
+  if (cmd == BIOC_FLUSH)
+    {
+#if defined(CONFIG_FTL_RWBUFFER) && defined(CONFIG_FS_WRITEBUFFER)
+      /* Not under the FTL semaphore:  with the write-back cache, the
+       * write buffer's flush method (ftl_wbwrite) takes it itself.
+       */
+
+      ret = rwb_flush(&dev->rwb);
+      if (ret < 0)
+        {
+          return ret;
+        }
+#endif
+
+#ifdef CONFIG_FTL_WRITEBACK
+      ftl_semtake(dev);
+      ret = ftl_wbflush(dev);
+      ftl_semgive(dev);
+      return ret;
+#else
+      return OK;
+#endif
+    }
+
+  /* The only other block driver ioctl command supported by this driver is
+   * just passed on to the MTD driver in a slightly different form.
    */
 
   if (cmd == BIOC_XIPBASE)
@@ -478,7 +967,6 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
    * to the MTD driver (unchanged).
    */
 
-  dev = (struct ftl_struct_s *)inode->i_private;
   ret = MTD_IOCTL(dev->mtd, cmd, arg);
   if (ret < 0)
     {
@@ -510,6 +998,9 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
   struct ftl_struct_s *dev;
   char devname[16];
   int ret = -ENOMEM;
+#ifdef CONFIG_FTL_WRITEBACK
+  int i;
+#endif
 
   /* Sanity check */
 
@@ -544,7 +1035,39 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
 
       /* Allocate one, in-memory erase block buffer */
 
-#ifdef CONFIG_FS_WRITABLE
+#if defined(CONFIG_FTL_WRITEBACK)
+      /* With the write-back cache, ftl_flush() is only used to write whole,
+       * aligned erase blocks and needs no erase block buffer.  Instead,
+       * allocate the buffers for the cache.
+       */
+
+      dev->eblock = NULL;
+      dev->wbcache[0].buffer = (FAR uint8_t *)
+        kmalloc(CONFIG_FTL_WRITEBACK_NBLOCKS * dev->geo.erasesize);
+
+      if (!dev->wbcache[0].buffer)
+        {
+          fdbg("Failed to allocate the erase block cache\n");
+          kfree(dev);
+          return -ENOMEM;
+        }
+
+      for (i = 0; i < CONFIG_FTL_WRITEBACK_NBLOCKS; i++)
+        {
+          dev->wbcache[i].buffer = dev->wbcache[0].buffer +
+                                   i * dev->geo.erasesize;
+          dev->wbcache[i].eblock = -1;
+          dev->wbcache[i].age    = 0;
+          dev->wbcache[i].dirty  = false;
+        }
+
+      dev->wbclock = 0;
+#ifdef FTL_WRITEBACK_TIMER
+      memset(&dev->work, 0, sizeof(struct work_s));
+#endif
+      sem_init(&dev->exclsem, 0, 1);
+
+#elif defined(CONFIG_FS_WRITABLE)
       dev->eblock  = (FAR uint8_t *)kmalloc(dev->geo.erasesize);
       if (!dev->eblock)
         {
@@ -568,8 +1091,12 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
 
 #if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_FS_WRITEBUFFER)
       dev->rwb.wrmaxblocks = dev->blkper;
+#ifdef CONFIG_FTL_WRITEBACK
+      dev->rwb.wrflush     = ftl_wbwrite;
+#else
       dev->rwb.wrflush     = ftl_flush;
 #endif
+#endif
 
 #ifdef CONFIG_FS_READAHEAD
       dev->rwb.rhmaxblocks = dev->blkper;
@@ -579,8 +1106,8 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
       if (ret < 0)
         {
           fdbg("rwb_initialize failed: %d\n", ret);
-          kfree(dev);
-          return ret;
+          rwb_uninitialize(&dev->rwb);
+          goto errout_with_buffers;
         }
 #endif
 
@@ -594,8 +1121,22 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
       if (ret < 0)
         {
           fdbg("register_blockdriver failed: %d\n", -ret);
-          kfree(dev);
+#ifdef CONFIG_FTL_RWBUFFER
+          rwb_uninitialize(&dev->rwb);
+#endif
+          goto errout_with_buffers;
         }
     }
+
+  return ret;
+
+errout_with_buffers:
+#if defined(CONFIG_FTL_WRITEBACK)
+  sem_destroy(&dev->exclsem);
+  kfree(dev->wbcache[0].buffer);
+#elif defined(CONFIG_FS_WRITABLE)
+  kfree(dev->eblock);
+#endif
+  kfree(dev);
   return ret;
 }
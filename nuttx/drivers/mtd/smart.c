@@ -112,6 +112,16 @@
 #  define  CONFIG_MTD_SMART_SECTOR_SIZE 1024
 #endif
 
+#if defined(CONFIG_MTD_SMART_WEAR_LEVEL) && !defined(CONFIG_MTD_SMART_FREEMAP)
+#  error "CONFIG_MTD_SMART_WEAR_LEVEL requires CONFIG_MTD_SMART_FREEMAP"
+#endif
+
+#ifndef CONFIG_MTD_SMART_WEAR_THRESHOLD
+#  define CONFIG_MTD_SMART_WEAR_THRESHOLD 8
+#endif
+
+#define SMART_NOBLOCK             0xFFFF  /* No erase block */
+
 #ifndef offsetof
 #define offsetof(type, member) ( (size_t) &( ( (type *) 0)->member))
 #endif
@@ -120,6 +130,20 @@
  * Private Types
  ****************************************************************************/
 
+/* Erase blocks on doubly linked, circular lists; one list for each count of
+ * free (or released) sectors.  Blocks with a count of zero are on no list.
+ */
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+struct smart_bucket_s
+{
+  FAR uint16_t         *head;             /* First block on the list of each count */
+  FAR uint16_t         *next;             /* Next block on the same list */
+  FAR uint16_t         *prev;             /* Previous block on the same list */
+  uint16_t              maxcount;         /* No list above this count has blocks */
+};
+#endif
+
 struct smart_struct_s
 {
   FAR struct mtd_dev_s *mtd;              /* Contained MTD interface */
@@ -133,6 +157,19 @@ struct smart_struct_s
   FAR uint16_t         *sMap;             /* Virtual to physical sector map */
   FAR uint8_t          *releasecount;     /* Count of released sectors per erase block */
   FAR uint8_t          *freecount;        /* Count of free sectors per erase block */
+  uint16_t              releasesectors;   /* Total number of released sectors */
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  FAR uint8_t          *freemap;          /* Bitmap of erased physical sectors */
+  struct smart_bucket_s freelist;         /* Erase blocks by free sector count */
+  struct smart_bucket_s releaselist;      /* Erase blocks by released sector count */
+#endif
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  FAR uint32_t         *erasecount;       /* Count of erases per erase block */
+  uint32_t              minerase;         /* Erases of the least erased block */
+  uint32_t              maxerase;         /* Erases of the most erased block */
+  uint16_t              nminerase;        /* Number of blocks with minerase erases */
+  bool                  wearcheck;        /* A block was erased since the last check */
+#endif
   FAR char             *rwbuffer;         /* Our sector read/write buffer */
   const FAR char       *partname;         /* Optional partition name */
   uint8_t               formatversion;    /* Format version on the device */
@@ -460,6 +497,232 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry)
   return -EINVAL;
 }
 
+/****************************************************************************
+ * Name: smart_bucketadd
+ *
+ * Description: Adds an erase block to the end of the list for its count.
+ *              Appending rather than prepending makes blocks with the same
+ *              count take turns, which spreads the erases.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static void smart_bucketadd(FAR struct smart_bucket_s *list, uint16_t block,
+                            uint16_t count)
+{
+  uint16_t first;
+  uint16_t last;
+
+  if (count == 0)
+    {
+      return;
+    }
+
+  first = list->head[count];
+  if (first == SMART_NOBLOCK)
+    {
+      list->head[count] = block;
+      list->next[block] = block;
+      list->prev[block] = block;
+    }
+  else
+    {
+      last              = list->prev[first];
+      list->next[last]  = block;
+      list->prev[block] = last;
+      list->next[block] = first;
+      list->prev[first] = block;
+    }
+
+  if (count > list->maxcount)
+    {
+      list->maxcount = count;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bucketremove
+ *
+ * Description: Removes an erase block from the list for its count.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_MTD_SMART_FREEMAP) && defined(CONFIG_FS_WRITABLE)
+static void smart_bucketremove(FAR struct smart_bucket_s *list,
+                               uint16_t block, uint16_t count)
+{
+  if (count == 0)
+    {
+      return;
+    }
+
+  if (list->next[block] == block)
+    {
+      list->head[count] = SMART_NOBLOCK;
+    }
+  else
+    {
+      list->next[list->prev[block]] = list->next[block];
+      list->prev[list->next[block]] = list->prev[block];
+      if (list->head[count] == block)
+        {
+          list->head[count] = list->next[block];
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_bucketmax
+ *
+ * Description: Returns an erase block with the highest count or
+ *              SMART_NOBLOCK if all of the blocks have a count of zero.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static uint16_t smart_bucketmax(FAR struct smart_bucket_s *list)
+{
+  /* maxcount only decreases here, by at most the number of sectors in an
+   * erase block since it last increased.
+   */
+
+  while (list->maxcount > 0 && list->head[list->maxcount] == SMART_NOBLOCK)
+    {
+      list->maxcount--;
+    }
+
+  return list->maxcount > 0 ? list->head[list->maxcount] : SMART_NOBLOCK;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_setfreecount
+ *
+ * Description: Sets the count of free sectors in an erase block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static void smart_setfreecount(struct smart_struct_s *dev, uint16_t block,
+                               uint8_t count)
+{
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_bucketremove(&dev->freelist, block, dev->freecount[block]);
+  smart_bucketadd(&dev->freelist, block, count);
+#endif
+  dev->freecount[block] = count;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_setreleasecount
+ *
+ * Description: Sets the count of released sectors in an erase block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static void smart_setreleasecount(struct smart_struct_s *dev, uint16_t block,
+                                  uint8_t count)
+{
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_bucketremove(&dev->releaselist, block, dev->releasecount[block]);
+  smart_bucketadd(&dev->releaselist, block, count);
+#endif
+  dev->releasesectors += count;
+  dev->releasesectors -= dev->releasecount[block];
+  dev->releasecount[block] = count;
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_setfreemap
+ *
+ * Description: Marks a range of physical sectors as erased (or not) in the
+ *              free sector bitmap.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+static void smart_setfreemap(struct smart_struct_s *dev, uint16_t sector,
+                             uint16_t nsectors, bool erased)
+{
+  for (; nsectors > 0; sector++, nsectors--)
+    {
+      if (erased)
+        {
+          dev->freemap[sector >> 3] |= (1 << (sector & 7));
+        }
+      else
+        {
+          dev->freemap[sector >> 3] &= ~(1 << (sector & 7));
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smart_initindex
+ *
+ * Description: Rebuilds the erase block lists and the released sector count
+ *              from the freecount and releasecount arrays.
+ *
+ ****************************************************************************/
+
+static void smart_initindex(struct smart_struct_s *dev)
+{
+  uint16_t  block;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  uint16_t  count;
+#endif
+
+  dev->releasesectors = 0;
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  for (count = 0; count <= dev->sectorsPerBlk; count++)
+    {
+      dev->freelist.head[count] = SMART_NOBLOCK;
+      dev->releaselist.head[count] = SMART_NOBLOCK;
+    }
+
+  dev->freelist.maxcount = 0;
+  dev->releaselist.maxcount = 0;
+#endif
+
+  for (block = 0; block < dev->neraseblocks; block++)
+    {
+#ifdef CONFIG_MTD_SMART_FREEMAP
+      smart_bucketadd(&dev->freelist, block, dev->freecount[block]);
+      smart_bucketadd(&dev->releaselist, block, dev->releasecount[block]);
+#endif
+      dev->releasesectors += dev->releasecount[block];
+    }
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  dev->minerase  = 0;
+  dev->maxerase  = 0;
+  dev->nminerase = dev->neraseblocks;
+  dev->wearcheck = false;
+#endif
+}
+
+/****************************************************************************
+ * Name: smart_sectorerased
+ *
+ * Description: Tests if a sector header shows a free, never written sector.
+ *
+ ****************************************************************************/
+
+static inline bool smart_sectorerased(FAR struct smart_sect_header_s *header)
+{
+  return (*((uint16_t *) header->logicalsector) == 0xFFFF) &&
+         (*((uint16_t *) header->seq) == 0xFFFF) &&
+         ((header->status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED));
+}
+
 /****************************************************************************
  * Name: smart_setsectorsize
  *
@@ -472,6 +735,11 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
 {
   uint32_t  erasesize;
   uint32_t  totalsectors;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  uint32_t  mapsize;
+  uint16_t  nlists;
+  uint16_t *list;
+#endif
 
   /* Validate the size isn't zero so we don't divide by zero below */
 
@@ -508,6 +776,14 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
       kfree(dev->rwbuffer);
     }
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  if (dev->freemap != NULL)
+    {
+      kfree(dev->freemap);
+      dev->freemap = NULL;
+    }
+#endif
+
   /* Allocate a virtual to physical sector map buffer.  Also allocate
    * the storage space for releasecount and freecounts.
    */
@@ -538,6 +814,42 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
       return -EINVAL;
     }
 
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  /* Allocate the free sector bitmap (padded to 32 bits), then the erase
+   * counts (if wear leveling) and the erase block lists.  The lists are
+   * built by smart_initindex() once the sector counts are known.
+   */
+
+  mapsize = ((totalsectors + 31) >> 5) << 2;
+  nlists  = dev->sectorsPerBlk + 1;
+
+  dev->freemap = (uint8_t *) kzalloc(mapsize +
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+              dev->neraseblocks * sizeof(uint32_t) +
+#endif
+              2 * (nlists + 2 * dev->neraseblocks) * sizeof(uint16_t));
+  if (!dev->freemap)
+    {
+      fdbg("Error allocating SMART free sector map\n");
+      kfree(dev->rwbuffer);
+      kfree(dev->sMap);
+      kfree(dev);
+      return -EINVAL;
+    }
+
+  list = (uint16_t *) (dev->freemap + mapsize);
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  dev->erasecount = (uint32_t *) list;
+  list = (uint16_t *) (dev->erasecount + dev->neraseblocks);
+#endif
+  dev->freelist.head    = list;
+  dev->freelist.next    = list + nlists;
+  dev->freelist.prev    = dev->freelist.next + dev->neraseblocks;
+  dev->releaselist.head = dev->freelist.prev + dev->neraseblocks;
+  dev->releaselist.next = dev->releaselist.head + nlists;
+  dev->releaselist.prev = dev->releaselist.next + dev->neraseblocks;
+#endif
+
   return OK;
 }
 
@@ -609,6 +921,93 @@ errout:
   return ret;
 }
 
+/****************************************************************************
+ * Name: smart_eraseblock
+ *
+ * Description: Erases an erase block and updates the free and released
+ *              sector counts, the free sector bitmap and the erase counts.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static int smart_eraseblock(struct smart_struct_s *dev, uint16_t block)
+{
+  uint8_t   sectsize;
+  uint8_t   newstatus;
+  int       ret;
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  uint32_t  oldcount;
+  uint16_t  x;
+#endif
+
+  ret = MTD_ERASE(dev->mtd, block, 1);
+
+  dev->freesectors += dev->releasecount[block];
+  smart_setreleasecount(dev, block, 0);
+  smart_setfreecount(dev, block, dev->sectorsPerBlk);
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_setfreemap(dev, block * dev->sectorsPerBlk, dev->sectorsPerBlk, true);
+#endif
+
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+  /* Update the erase counts.  The least erased count only changes when the
+   * last block with that count is erased, so the rescan of all of the
+   * blocks happens about once for every neraseblocks erases.
+   */
+
+  oldcount = dev->erasecount[block]++;
+  if (dev->erasecount[block] > dev->maxerase)
+    {
+      dev->maxerase = dev->erasecount[block];
+    }
+
+  if (oldcount == dev->minerase && --dev->nminerase == 0)
+    {
+      dev->minerase = dev->maxerase;
+      for (x = 0; x < dev->neraseblocks; x++)
+        {
+          if (dev->erasecount[x] < dev->minerase)
+            {
+              dev->minerase  = dev->erasecount[x];
+              dev->nminerase = 1;
+            }
+          else if (dev->erasecount[x] == dev->minerase)
+            {
+              dev->nminerase++;
+            }
+        }
+    }
+
+  dev->wearcheck = true;
+#endif
+
+  /* If this is block zero, then be sure to write the sector size */
+
+  if (block == 0)
+    {
+      /* Set the sector size in the 1st header */
+
+      sectsize = dev->sectorsize >> 7;
+#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
+      newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
+#else
+      newstatus = (uint8_t) sectsize;
+#endif
+      /* Write the sector size to the device */
+
+      ret = smart_bytewrite(dev, offsetof(struct smart_sect_header_s, status),
+                            1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d setting sector 0 size\n", -ret);
+        }
+    }
+
+  return ret < 0 ? ret : OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
 /****************************************************************************
  * Name: smart_scan
  *
@@ -721,6 +1120,14 @@ static int smart_scan(struct smart_struct_s *dev)
       if ((header.status & SMART_STATUS_COMMITTED) ==
               (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
         {
+#ifdef CONFIG_MTD_SMART_FREEMAP
+          /* Remember the sector if it is still fully erased */
+
+          if (smart_sectorerased(&header))
+            {
+              smart_setfreemap(dev, sector, 1, true);
+            }
+#endif
           continue;
         }
 
@@ -917,6 +1324,10 @@ static int smart_scan(struct smart_struct_s *dev)
       dev->sMap[logicalsector] = sector;
     }
 
+  /* Build the free and released sector index from the counts */
+
+  smart_initindex(dev);
+
   fdbg("SMART Scan\n");
   fdbg("   Erase size:   %10d\n", dev->sectorsPerBlk * dev->sectorsize);
   fdbg("   Erase count:  %10d\n", dev->neraseblocks);
@@ -947,7 +1358,6 @@ static inline int smart_getformat(struct smart_struct_s *dev,
 #endif
 {
   int ret;
-  int x;
 
   fvdbg("Entry\n");
   DEBUGASSERT(fmt);
@@ -992,10 +1402,7 @@ static inline int smart_getformat(struct smart_struct_s *dev,
 
   /* Add the released sectors to the reported free sector count */
 
-  for (x = 0; x < dev->neraseblocks; x++)
-    {
-      fmt->nfreesectors += dev->releasecount[x];
-    }
+  fmt->nfreesectors += dev->releasesectors;
 
   /* Subtract the reserved sector count */
 
@@ -1122,6 +1529,13 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
       dev->sMap[x] = -1;
     }
 
+  /* Every physical sector but the format sector is erased */
+
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  smart_setfreemap(dev, 1, totalsectors - 1, true);
+#endif
+  smart_initindex(dev);
+
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
 
   /* Un-register any extra directory device entries */
@@ -1147,21 +1561,26 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
 
 static int smart_findfreephyssector(struct smart_struct_s *dev)
 {
-  uint16_t  allocfreecount;
   uint16_t  allocblock;
   uint16_t  physicalsector;
   uint16_t  x;
+#ifndef CONFIG_MTD_SMART_FREEMAP
+  uint16_t  allocfreecount;
   uint32_t  readaddr;
   struct    smart_sect_header_s header;
   int       ret;
+#endif
 
   /* Determine which erase block we should allocate the new
    * sector from. This is based on the number of free sectors
    * available in each erase block. */
 
+  physicalsector = 0xFFFF;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+  allocblock = smart_bucketmax(&dev->freelist);
+#else
   allocfreecount = 0;
   allocblock = 0xFFFF;
-  physicalsector = 0xFFFF;
   for (x = 0; x < dev->neraseblocks; x++)
     {
       /* Test if this block has more free blocks than the
@@ -1175,6 +1594,7 @@ static int smart_findfreephyssector(struct smart_struct_s *dev)
           allocfreecount = dev->freecount[x];
         }
     }
+#endif
 
   /* Check if we found an allocblock. */
 
@@ -1190,6 +1610,18 @@ static int smart_findfreephyssector(struct smart_struct_s *dev)
   for (x = allocblock * dev->sectorsPerBlk;
           x < (allocblock+1) * dev->sectorsPerBlk; x++)
     {
+#ifdef CONFIG_MTD_SMART_FREEMAP
+      /* Check the free sector bitmap.  The caller is about to write the
+       * sector, so it is not erased any longer.
+       */
+
+      if (dev->freemap[x >> 3] & (1 << (x & 7)))
+        {
+          smart_setfreemap(dev, x, 1, false);
+          physicalsector = x;
+          break;
+        }
+#else
       /* Check if this physical sector is available */
 
       readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
@@ -1201,19 +1633,203 @@ static int smart_findfreephyssector(struct smart_struct_s *dev)
           return -EIO;
         }
 
-      if ((*((uint16_t *) header.logicalsector) == 0xFFFF) &&
-          (*((uint16_t *) header.seq) == 0xFFFF) &&
-          ((header.status & SMART_STATUS_COMMITTED) ==
-           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)))
+      if (smart_sectorerased(&header))
         {
           physicalsector = x;
           break;
         }
+#endif
     }
 
   return physicalsector;
 }
 
+/****************************************************************************
+ * Name: smart_relocateblock
+ *
+ * Description:  Moves all of the live sectors out of an erase block, then
+ *               erases the block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static int smart_relocateblock(struct smart_struct_s *dev, uint16_t block)
+{
+  uint16_t  newsector;
+  uint16_t  newblock;
+  int       x;
+  int       ret;
+  size_t    offset;
+  struct    smart_sect_header_s *header;
+  uint8_t   newstatus;
+
+  /* First mark the block as having no free sectors so we don't try to
+   * move sectors into the block we are trying to erase.
+   */
+
+  smart_setfreecount(dev, block, 0);
+
+  /* Next move all live data in the block to a new home. */
+
+  for (x = block * dev->sectorsPerBlk; x <
+     (block + 1) * dev->sectorsPerBlk; x++)
+    {
+      /* Read the next sector from this erase block */
+
+      ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
+          dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+      if (ret != dev->mtdBlksPerSector)
+        {
+          fdbg("Error reading sector %d\n", x);
+          return -EIO;
+        }
+
+      /* Test if if the block is in use */
+
+      header = (struct smart_sect_header_s *) dev->rwbuffer;
+      if (((header->status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
+          ((header->status & SMART_STATUS_RELEASED) !=
+           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
+        {
+          /* This sector doesn't have live data (free or released).
+           * just continue to the next sector and don't move it.
+           */
+
+          continue;
+        }
+
+      /* Find a new sector where it can live, NOT in this erase block */
+
+      newsector = smart_findfreephyssector(dev);
+      if (newsector == 0xFFFF)
+        {
+          /* Unable to find a free sector!!! */
+
+          fdbg("Can't find a free sector for relocation\n");
+          return -EIO;
+        }
+
+      /* Increment the sequence number and clear the "commit" flag */
+
+      (*((uint16_t *) header->seq))++;
+      if (*((uint16_t *) header->seq) == 0xFFFF)
+        {
+          *((uint16_t *) header->seq) = 1;
+        }
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      header->status |= SMART_STATUS_COMMITTED;
+#else
+      header->status &= ~SMART_STATUS_COMMITTED;
+#endif
+
+      /* Write the data to the new physical sector location */
+
+      ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
+                       dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+
+      /* Commit the sector */
+
+      offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      newstatus = header->status & ~SMART_STATUS_COMMITTED;
+#else
+      newstatus = header->status | SMART_STATUS_COMMITTED;
+#endif
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d committing new sector %d\n", -ret, newsector);
+          return ret;
+        }
+
+      /* Release the old physical sector */
+
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      newstatus = header->status & ~SMART_STATUS_RELEASED;
+#else
+      newstatus = header->status | SMART_STATUS_RELEASED;
+#endif
+      offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d releasing old sector %d\n", -ret, x);
+          return ret;
+        }
+
+      /* Update the variables */
+
+      dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
+      newblock = newsector / dev->sectorsPerBlk;
+      smart_setfreecount(dev, newblock, dev->freecount[newblock] - 1);
+    }
+
+  /* Now erase the erase block */
+
+  return smart_eraseblock(dev, block);
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_wearlevel
+ *
+ * Description:  Moves the data out of the least erased block when the
+ *               erase counts have drifted too far apart.  Such a block
+ *               holds data that is rarely written; once it is erased, it
+ *               takes its share of the new writes.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_MTD_SMART_WEAR_LEVEL)
+static int smart_wearlevel(struct smart_struct_s *dev)
+{
+  uint16_t  block;
+  uint16_t  live;
+
+  if (dev->maxerase - dev->minerase <= CONFIG_MTD_SMART_WEAR_THRESHOLD)
+    {
+      return OK;
+    }
+
+  /* Find a least erased block with live data.  Least erased blocks with no
+   * live data will be used (or collected) soon in any case.
+   */
+
+  for (block = 0; block < dev->neraseblocks; block++)
+    {
+      if (dev->erasecount[block] != dev->minerase)
+        {
+          continue;
+        }
+
+      live = dev->sectorsPerBlk - dev->freecount[block] -
+             dev->releasecount[block];
+      if (live == 0)
+        {
+          continue;
+        }
+
+      /* Don't eat into the free sectors reserved for garbage collection */
+
+      if (dev->freesectors - dev->freecount[block] <=
+          live + dev->sectorsPerBlk + 4)
+        {
+          return OK;
+        }
+
+      fdbg("Wear leveling block %d, erases=%d max=%d\n",
+           block, dev->erasecount[block], dev->maxerase);
+
+      return smart_relocateblock(dev, block);
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: smart_garbagecollect
  *
@@ -1226,41 +1842,40 @@ static int smart_findfreephyssector(struct smart_struct_s *dev)
 #ifdef CONFIG_FS_WRITABLE
 static int smart_garbagecollect(struct smart_struct_s *dev)
 {
-  uint16_t  releasedsectors;
   uint16_t  collectblock;
-  uint16_t  releasemax;
-  uint16_t  newsector;
   bool      collect = TRUE;
-  int       x;
   int       ret;
-  size_t    offset;
-  struct    smart_sect_header_s *header;
-  uint8_t   newstatus;
+#ifndef CONFIG_MTD_SMART_FREEMAP
+  uint16_t  releasemax;
+  int       x;
+#endif
 
   while (collect)
     {
       collect = FALSE;
 
-      /* Calculate the number of released sectors on the device */
+      /* Find the block with the most released sectors */
 
-      releasedsectors = 0;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+      collectblock = smart_bucketmax(&dev->releaselist);
+#else
       collectblock = 0xFFFF;
       releasemax = 0;
       for (x = 0; x < dev->neraseblocks; x++)
         {
-          releasedsectors += dev->releasecount[x];
           if (dev->releasecount[x] > releasemax)
             {
               releasemax = dev->releasecount[x];
               collectblock = x;
             }
         }
+#endif
 
       /* Test if the released sectors count is greater than the
        * free sectors.  If it is, then we will do garbage collection.
        */
 
-      if (releasedsectors > dev->freesectors)
+      if (dev->releasesectors > dev->freesectors)
         collect = TRUE;
 
       /* Test if we have more reached our reserved free sector limit */
@@ -1284,154 +1899,33 @@ static int smart_garbagecollect(struct smart_struct_s *dev)
               collectblock, dev->freecount[collectblock],
               dev->releasecount[collectblock]);
 
-          if (dev->freecount[collectblock] == 6)
+          /* Perform collection on block with the most released sectors. */
+
+          ret = smart_relocateblock(dev, collectblock);
+          if (ret < 0)
             {
-              fdbg("here!\n");
+              goto errout;
             }
 
-          /* Perform collection on block with the most released sectors.
-           * First mark the block as having no free sectors so we don't
-           * try to move sectors into the block we are trying to erase.
+          /* Update the block aging information in the format signature sector */
+        }
+      else
+        {
+          /* Test for aging sectors and push them to a new location
+           * so we wear evenly.
            */
 
-          dev->freecount[collectblock] = 0;
-
-          /* Next move all live data in the block to a new home. */
-
-          for (x = collectblock * dev->sectorsPerBlk; x <
-             (collectblock + 1) * dev->sectorsPerBlk; x++)
+#ifdef CONFIG_MTD_SMART_WEAR_LEVEL
+          if (dev->wearcheck)
             {
-              /* Read the next sector from this erase block */
-
-              ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
-                  dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
-              if (ret != dev->mtdBlksPerSector)
-                {
-                  fdbg("Error reading sector %d\n", x);
-                  ret = -EIO;
-                  goto errout;
-                }
-
-              /* Test if if the block is in use */
-
-              header = (struct smart_sect_header_s *) dev->rwbuffer;
-              if (((header->status & SMART_STATUS_COMMITTED) ==
-                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
-                  ((header->status & SMART_STATUS_RELEASED) !=
-                   (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
-                {
-                  /* This sector doesn't have live data (free or released).
-                   * just continue to the next sector and don't move it.
-                   */
-
-                  continue;
-                }
-
-              /* Find a new sector where it can live, NOT in this erase block */
-
-              newsector = smart_findfreephyssector(dev);
-              if (newsector == 0xFFFF)
-                {
-                  /* Unable to find a free sector!!! */
-
-                  fdbg("Can't find a free sector for relocation\n");
-                  ret = -EIO;
-                  goto errout;
-                }
-
-              /* Increment the sequence number and clear the "commit" flag */
-
-              (*((uint16_t *) header->seq))++;
-              if (*((uint16_t *) header->seq) == 0xFFFF)
-                {
-                  *((uint16_t *) header->seq) = 1;
-                }
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              header->status |= SMART_STATUS_COMMITTED;
-#else
-              header->status &= ~SMART_STATUS_COMMITTED;
-#endif
-
-              /* Write the data to the new physical sector location */
-
-              ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
-                               dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
-
-              /* Commit the sector */
-
-              offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_COMMITTED;
-#else
-              newstatus = header->status | SMART_STATUS_COMMITTED;
-#endif
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
+              dev->wearcheck = false;
+              ret = smart_wearlevel(dev);
               if (ret < 0)
                 {
-                  fdbg("Error %d committing new sector %d\n" -ret, newsector);
                   goto errout;
                 }
-
-              /* Release the old physical sector */
-
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_RELEASED;
-#else
-              newstatus = header->status | SMART_STATUS_RELEASED;
-#endif
-              offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d releasing old sector %d\n" -ret, x);
-                  goto errout;
-                }
-
-              /* Update the variables */
-
-              dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
-              dev->freecount[newsector / dev->sectorsPerBlk]--;
             }
-
-          /* Now erase the erase block */
-
-          MTD_ERASE(dev->mtd, collectblock, 1);
-
-          dev->freesectors += dev->releasecount[collectblock];
-          dev->freecount[collectblock] = dev->sectorsPerBlk;
-          dev->releasecount[collectblock] = 0;
-
-          /* If this is block zero, then be sure to write the sector size */
-
-          if (collectblock == 0)
-            {
-              /* Set the sector size in the 1st header */
-
-              uint8_t sectsize = dev->sectorsize >> 7;
-#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
-              newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
-#else
-              newstatus = (uint8_t) sectsize;
 #endif
-              /* Write the sector size to the device */
-
-              offset = offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d setting sector 0 size\n", -ret);
-                }
-            }
-
-          /* Update the block aging information in the format signature sector */
-        }
-      else
-        {
-          /* Test for aging sectors and push them to a new location
-           * so we wear evenly.
-           */
         }
     }
 
@@ -1461,6 +1955,7 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
   bool      needsrelocate = FALSE;
   uint16_t  mtdblock;
   uint16_t  physsector;
+  uint16_t  block;
   struct    smart_read_write_s *req;
   struct    smart_sect_header_s *header;
   size_t    offset;
@@ -1597,8 +2092,10 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
       /* Update releasecount for released sector and freecount for the
        * newly allocated physical sector. */
 
-      dev->releasecount[dev->sMap[req->logsector] / dev->sectorsPerBlk]++;
-      dev->freecount[physsector / dev->sectorsPerBlk]--;
+      block = dev->sMap[req->logsector] / dev->sectorsPerBlk;
+      smart_setreleasecount(dev, block, dev->releasecount[block] + 1);
+      block = physsector / dev->sectorsPerBlk;
+      smart_setfreecount(dev, block, dev->freecount[block] - 1);
       dev->freesectors--;
 
       /* Update the sector map */
@@ -1725,7 +2222,7 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   int       ret;
   uint16_t  logsector = 0xFFFF; /* Logical sector number selected */
   uint16_t  physicalsector;     /* The selected physical sector */
-  uint16_t  releasecount;
+  uint16_t  block;
   struct    smart_sect_header_s  *header;
   uint8_t   sectsize;
 
@@ -1733,18 +2230,12 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
    * allocation.  We have to ensure we keep enough reserved sectors
    * on hand to do released sector garbage collection. */
 
-  releasecount = 0;
-  for (x = 0; x < dev->neraseblocks; x++)
-    {
-      releasecount += dev->releasecount[x];
-    }
-
   if (dev->freesectors <= (dev->sectorsPerBlk << 0) + 4)
     {
       /* We are at our free sector limit.  Test if we have
        * sectors we can release */
 
-      if (releasecount == 0)
+      if (dev->releasesectors == 0)
         {
           /* No space left!! */
 
@@ -1812,7 +2303,13 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   physicalsector = smart_findfreephyssector(dev);
   fvdbg("Alloc: log=%d, phys=%d, erase block=%d, free=%d, released=%d\n",
           logsector, physicalsector, physicalsector /
-          dev->sectorsPerBlk, dev->freesectors, releasecount);
+          dev->sectorsPerBlk, dev->freesectors, dev->releasesectors);
+
+  if (physicalsector == 0xFFFF)
+    {
+      fdbg("No free physical sector for logical sector %d\n", logsector);
+      return -EIO;
+    }
 
   /* Create a header to assign the logical sector */
 
@@ -1849,7 +2346,8 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   /* Map the sector and update the free sector counts */
 
   dev->sMap[logsector] = physicalsector;
-  dev->freecount[physicalsector / dev->sectorsPerBlk]--;
+  block = physicalsector / dev->sectorsPerBlk;
+  smart_setfreecount(dev, block, dev->freecount[block] - 1);
   dev->freesectors--;
 
   /* Return the logical sector number */
@@ -1935,7 +2433,7 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
   /* Update the erase block's release count */
 
   block = physsector / dev->sectorsPerBlk;
-  dev->releasecount[block]++;
+  smart_setreleasecount(dev, block, dev->releasecount[block] + 1);
 
   /* Unmap this logical sector */
 
@@ -1947,11 +2445,7 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
     {
       /* Erase the block */
 
-      MTD_ERASE(dev->mtd, block, 1);
-
-      dev->freesectors += dev->releasecount[block];
-      dev->releasecount[block] = 0;
-      dev->freecount[block] = dev->sectorsPerBlk;
+      smart_eraseblock(dev, block);
     }
 
   ret = OK;
@@ -2135,6 +2629,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
 
       dev->sMap = NULL;
       dev->rwbuffer = NULL;
+#ifdef CONFIG_MTD_SMART_FREEMAP
+      dev->freemap = NULL;
+#endif
       ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
       if (ret != OK)
         {
@@ -2181,6 +2678,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
           fdbg("register_blockdriver failed: %d\n", -ret);
           kfree(dev->sMap);
           kfree(dev->rwbuffer);
+#ifdef CONFIG_MTD_SMART_FREEMAP
+          kfree(dev->freemap);
+#endif
           kfree(dev);
           ret = -ENOMEM;
           goto errout;
@@ -2208,6 +2708,9 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
           fdbg("register_blockdriver failed: %d\n", -ret);
           kfree(dev->sMap);
           kfree(dev->rwbuffer);
+#ifdef CONFIG_MTD_SMART_FREEMAP
+          kfree(dev->freemap);
+#endif
           kfree(dev);
           goto errout;
         }
@@ -153,13 +153,12 @@ static inline void rwb_resetwrbuffer(struct rwbuffer_s *rwb)
  ****************************************************************************/
 
 #ifdef CONFIG_FS_WRITEBUFFER
-static void rwb_wrflush(struct rwbuffer_s *rwb)
+static int rwb_wrflush(struct rwbuffer_s *rwb)
 {
-  int ret;
+  int ret = OK;
+
+  /* We assume that the caller holds the wrsem */
 
-  fvdbg("Timeout!\n");
-  
-  rwb_semtake(&rwb->wrsem);
   if (rwb->wrnblocks)
     {
       fvdbg("Flushing: blockstart=0x%08lx nblocks=%d from buffer=%p\n",
@@ -174,12 +173,17 @@ static void rwb_wrflush(struct rwbuffer_s *rwb)
       if (ret != rwb->wrnblocks)
         {
           fdbg("ERROR: Error flushing write buffer: %d\n", ret);
+          ret = ret < 0 ? ret : -EIO;
+        }
+      else
+        {
+          ret = OK;
         }
-      
+
       rwb_resetwrbuffer(rwb);
     }
 
-  rwb_semgive(&rwb->wrsem);
+  return ret;
 }
 #endif
 
@@ -199,7 +203,11 @@ static void rwb_wrtimeout(FAR void *arg)
    * worker thread.
    */
 
-  rwb_wrflush(rwb);
+  fvdbg("Timeout!\n");
+
+  rwb_semtake(&rwb->wrsem);
+  (void)rwb_wrflush(rwb);
+  rwb_semgive(&rwb->wrsem);
 }
 
 /****************************************************************************
@@ -236,10 +244,13 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
 {
   int ret;
 
-  /* Write writebuffer Logic */
+  /* Write writebuffer Logic.  Hold the write buffer semaphore throughout so
+   * that the timeout worker cannot flush or reset the buffer underneath us.
+   */
 
+  rwb_semtake(&rwb->wrsem);
   rwb_wrcanceltimeout(rwb);
-  
+
   /* First: Should we flush out our cache? We would do that if (1) we already
    * buffering blocks and the next block writing is not in the same sequence,
    * or (2) the number of blocks would exceed our allocated buffer capacity
@@ -250,19 +261,18 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
     {
       fvdbg("writebuffer miss, expected: %08x, given: %08x\n",
             rwb->wrexpectedblock, startblock);
-    
+
       /* Flush the write buffer */
 
-      ret = rwb->wrflush(rwb, rwb->wrbuffer, rwb->wrblockstart, rwb->wrnblocks);
+      ret = rwb_wrflush(rwb);
       if (ret < 0)
         {
           fdbg("ERROR: Error writing multiple from cache: %d\n", -ret);
+          rwb_semgive(&rwb->wrsem);
           return ret;
         }
-
-      rwb_resetwrbuffer(rwb);
     }
-  
+
   /* writebuffer is empty? Then initialize it */
 
   if (!rwb->wrnblocks)
@@ -270,11 +280,11 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
       fvdbg("Fresh cache starting at block: 0x%08x\n", startblock);
       rwb->wrblockstart = startblock;
     }
-  
+
   /* Add data to cache */
 
   fvdbg("writebuffer: copying %d bytes from %p to %p\n",
-        nblocks * wrb->blocksize, wrbuffer,
+        nblocks * rwb->blocksize, wrbuffer,
         &rwb->wrbuffer[rwb->wrnblocks * rwb->blocksize]);
   memcpy(&rwb->wrbuffer[rwb->wrnblocks * rwb->blocksize],
          wrbuffer, nblocks * rwb->blocksize);
@@ -282,6 +292,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
   rwb->wrnblocks      += nblocks;
   rwb->wrexpectedblock = rwb->wrblockstart + rwb->wrnblocks;
   rwb_wrstarttimeout(rwb);
+  rwb_semgive(&rwb->wrsem);
   return nblocks;
 }
 #endif
@@ -417,6 +428,10 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
 
   sem_init(&rwb->wrsem, 0, 1);
 
+  /* No write timeout is pending yet */
+
+  memset(&rwb->work, 0, sizeof(struct work_s));
+
   /* Initialize write buffer parameters */
 
   rwb_resetwrbuffer(rwb);
@@ -430,7 +445,7 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
       rwb->wrbuffer = kmalloc(allocsize);
       if (!rwb->wrbuffer)
         {
-          fdbg("Write buffer kmalloc(%d) failed\n", allocsizee);
+          fdbg("Write buffer kmalloc(%d) failed\n", allocsize);
           return -ENOMEM;
         }
     }
@@ -520,7 +535,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
       rwb_semtake(&rwb->wrsem);
       if (rwb_overlap(rwb->wrblockstart, rwb->wrnblocks, startblock, nblocks))
         {
-          rwb_wrflush(rwb);
+          (void)rwb_wrflush(rwb);
         }
       rwb_semgive(&rwb->wrsem);
     }
@@ -536,7 +551,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
 
       if (rwb->rhnblocks > 0)
         {
-          off_t  startblock = startblock;
+          off_t  bufferstart = startblock;
           size_t nbufblocks = 0;
           off_t  bufferend;
 
@@ -562,7 +577,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
 
           /* Then read the data from the read-ahead buffer */
 
-          rwb_bufferread(rwb, startblock, nbufblocks, &rdbuffer);
+          rwb_bufferread(rwb, bufferstart, nbufblocks, &rdbuffer);
         }
 
       /* If we did not get all of the data from the buffer, then we have to refill
@@ -575,6 +590,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
           if (ret < 0)
             {
               fdbg("ERROR: Failed to fill the read-ahead buffer: %d\n", -ret);
+              rwb_semgive(&rwb->rhsem);
               return ret;
             }
         }
@@ -586,7 +602,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
    */
 
   rwb_semgive(&rwb->rhsem);
-  return 0;
+  return nblocks;
 #else
   return rwb->rhreload(rwb->dev, startblock, nblocks, rdbuffer);
 #endif
@@ -613,7 +629,7 @@ int rwb_write(FAR struct rwbuffer_s *rwb, off_t startblock,
     {
       rwb_resetrhbuffer(rwb);
     }
-  rwb_give(&rwb->rhsem);
+  rwb_semgive(&rwb->rhsem);
 #endif
 
 #ifdef CONFIG_FS_WRITEBUFFER
@@ -623,15 +639,23 @@ int rwb_write(FAR struct rwbuffer_s *rwb, off_t startblock,
      
   if (nblocks > rwb->wrmaxblocks)
     {
-      /* First flush the cache */
+      /* First flush the cache.  Keep the write buffer semaphore until the
+       * direct transfer is done so that the buffered data and the new data
+       * reach the media in order.
+       */
 
       rwb_semtake(&rwb->wrsem);
-      rwb_wrflush(rwb);
-      rwb_semgive(&rwb->wrsem);
+      rwb_wrcanceltimeout(rwb);
+      ret = rwb_wrflush(rwb);
 
       /* Then transfer the data directly to the media */
 
-      ret = rwb->wrflush(rwb->dev, startblock, nblocks, wrbuffer);
+      if (ret >= 0)
+        {
+          ret = rwb->wrflush(rwb->dev, wrbuffer, startblock, nblocks);
+        }
+
+      rwb_semgive(&rwb->wrsem);
     }
   else
     {
@@ -649,8 +673,33 @@ int rwb_write(FAR struct rwbuffer_s *rwb, off_t startblock,
 
 #else
 
-  return rwb->wrflush(rwb->dev, startblock, nblocks, wrbuffer);
+  return rwb->wrflush(rwb->dev, wrbuffer, startblock, nblocks);
+
+#endif
+}
+
+/****************************************************************************
+ * Name: rwb_flush
+ *
+ * Description:
+ *   Write any buffered write data to the media now rather than waiting for
+ *   the write delay to expire.  Returns OK on success or a negated errno
+ *   value from the flush method.
+ *
+ ****************************************************************************/
+
+int rwb_flush(FAR struct rwbuffer_s *rwb)
+{
+#ifdef CONFIG_FS_WRITEBUFFER
+  int ret;
 
+  rwb_semtake(&rwb->wrsem);
+  rwb_wrcanceltimeout(rwb);
+  ret = rwb_wrflush(rwb);
+  rwb_semgive(&rwb->wrsem);
+  return ret;
+#else
+  return OK;
 #endif
 }
 
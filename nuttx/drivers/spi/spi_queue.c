@@ -0,0 +1,420 @@
+/****************************************************************************
+ * drivers/spi/spi_queue.c
+ * Queued, asynchronous SPI transactions
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/spi.h>
+
+#ifdef CONFIG_SPI_QUEUE
+
+/****************************************************************************
+ * Preprocessor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SCHED_WORKQUEUE
+#  error "Worker thread support is required (CONFIG_SCHED_WORKQUEUE)"
+#endif
+
+/* The worker locks the bus and, without the chain method, carries out the
+ * exchanges itself.  Both may wait, so it must not run on the high
+ * priority work queue.
+ */
+
+#ifndef CONFIG_SCHED_LPWORK
+#  error "The low priority work queue is required (CONFIG_SCHED_LPWORK)"
+#endif
+
+#ifndef CONFIG_SPI_EXCHANGE
+#  error "The SPI exchange method is required (CONFIG_SPI_EXCHANGE)"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct spi_queue_s
+{
+  FAR struct spi_dev_s *dev;       /* The SPI bus */
+  FAR struct spi_trans_s *head;    /* Transactions waiting to be started */
+  FAR struct spi_trans_s *tail;
+  FAR struct spi_trans_s *active;  /* Transactions in progress */
+  volatile bool busy;              /* Work is queued or in progress */
+  struct work_s work;              /* For running on the work queue */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void spi_queue_chaindone(FAR struct spi_dev_s *dev, FAR void *arg);
+static void spi_queue_run(FAR struct spi_queue_s *queue,
+                          FAR struct spi_trans_s *trans);
+static void spi_queue_finish(FAR struct spi_queue_s *queue);
+static void spi_queue_worker(FAR void *arg);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spi_queue_chaindone
+ *
+ * Description:
+ *   Called by the SPI driver (probably from its interrupt handler) when a
+ *   chain of transactions has completed.  The bus is unlocked here, not on
+ *   the work queue:  Another item on the low priority work queue (or the
+ *   worker of another queue on the same bus) may be waiting for the bus,
+ *   and the callbacks could not run until it got it.  The callbacks are
+ *   run on the worker thread of the low priority work queue.
+ *
+ ****************************************************************************/
+
+static void spi_queue_chaindone(FAR struct spi_dev_s *dev, FAR void *arg)
+{
+  FAR struct spi_queue_s *queue = (FAR struct spi_queue_s *)arg;
+
+  DEBUGASSERT(queue && queue->dev == dev && queue->active);
+  (void)SPI_LOCK(dev, false);
+  (void)work_queue(LPWORK, &queue->work, spi_queue_worker, queue, 0);
+}
+
+/****************************************************************************
+ * Name: spi_queue_run
+ *
+ * Description:
+ *   Carry out a list of transactions with the blocking SPI methods.  The
+ *   bus is locked.  The frequency, mode, and word size are only set when
+ *   they differ from those of the previous transaction in the list.
+ *
+ ****************************************************************************/
+
+static void spi_queue_run(FAR struct spi_queue_s *queue,
+                          FAR struct spi_trans_s *trans)
+{
+  FAR struct spi_dev_s *dev = queue->dev;
+  FAR struct spi_trans_s *prev = NULL;
+  bool selected = false;
+
+  for (; trans; prev = trans, trans = trans->flink)
+    {
+      /* Configure the bus for this device.  Another client may have used
+       * the bus since it was last locked, so the first transaction always
+       * sets everything.
+       */
+
+      if (!prev || trans->frequency != prev->frequency)
+        {
+          (void)SPI_SETFREQUENCY(dev, trans->frequency);
+        }
+
+      if (!prev || trans->mode != prev->mode)
+        {
+          SPI_SETMODE(dev, trans->mode);
+        }
+
+      if (!prev || trans->nbits != prev->nbits)
+        {
+          SPI_SETBITS(dev, trans->nbits);
+        }
+
+      /* Select the device unless it was left selected by the previous
+       * transaction of the same chip select sequence.
+       */
+
+      if (!selected)
+        {
+          SPI_SELECT(dev, trans->devid, true);
+        }
+
+      SPI_EXCHANGE(dev, trans->txbuffer, trans->rxbuffer, trans->nwords);
+
+      selected = (trans->flags & SPI_TRANSFLAG_KEEPCS) != 0;
+      if (!selected)
+        {
+          SPI_SELECT(dev, trans->devid, false);
+        }
+
+      trans->result = OK;
+    }
+}
+
+/****************************************************************************
+ * Name: spi_queue_finish
+ *
+ * Description:
+ *   The active transactions have completed and the bus has been unlocked.
+ *   Call the callbacks.
+ *
+ ****************************************************************************/
+
+static void spi_queue_finish(FAR struct spi_queue_s *queue)
+{
+  FAR struct spi_trans_s *trans;
+  FAR struct spi_trans_s *next;
+
+  trans         = queue->active;
+  queue->active = NULL;
+
+  /* The callback may re-use the transaction, so get the next one first */
+
+  for (; trans; trans = next)
+    {
+      next = trans->flink;
+      if (trans->callback)
+        {
+          trans->callback(trans);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: spi_queue_worker
+ *
+ * Description:
+ *   Runs on the worker thread:  Complete the chain that the SPI driver has
+ *   finished, if any, then start the transactions that are waiting until
+ *   none are left or a chain has been handed to the SPI driver.
+ *
+ ****************************************************************************/
+
+static void spi_queue_worker(FAR void *arg)
+{
+  FAR struct spi_queue_s *queue = (FAR struct spi_queue_s *)arg;
+  FAR struct spi_dev_s *dev = queue->dev;
+  FAR struct spi_trans_s *trans;
+  FAR struct spi_trans_s *next;
+  irqstate_t flags;
+  int ret;
+
+  if (queue->active)
+    {
+      spi_queue_finish(queue);
+    }
+
+  for (;;)
+    {
+      /* Take all of the waiting transactions */
+
+      flags = irqsave();
+      trans = queue->head;
+      if (!trans)
+        {
+          queue->busy = false;
+          irqrestore(flags);
+          return;
+        }
+
+      queue->head = NULL;
+      queue->tail = NULL;
+      irqrestore(flags);
+
+      queue->active = trans;
+      (void)SPI_LOCK(dev, true);
+
+      /* Hand them to the SPI driver if it can run a chain by itself */
+
+      if (dev->ops->chain)
+        {
+          ret = SPI_CHAIN(dev, trans, spi_queue_chaindone, queue);
+          if (ret == OK)
+            {
+              /* spi_queue_chaindone() will unlock the bus and queue this
+               * work again.
+               */
+
+              return;
+            }
+
+          for (next = trans; next; next = next->flink)
+            {
+              next->result = ret;
+            }
+        }
+      else
+        {
+          spi_queue_run(queue, trans);
+        }
+
+      (void)SPI_LOCK(dev, false);
+      spi_queue_finish(queue);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: spi_queue_initialize
+ *
+ * Description:
+ *   Create a transaction queue for one SPI bus.  See include/nuttx/spi.h.
+ *
+ ****************************************************************************/
+
+FAR struct spi_queue_s *spi_queue_initialize(FAR struct spi_dev_s *dev)
+{
+  FAR struct spi_queue_s *queue;
+
+  DEBUGASSERT(dev);
+
+  queue = (FAR struct spi_queue_s *)kzalloc(sizeof(struct spi_queue_s));
+  if (queue)
+    {
+      queue->dev = dev;
+    }
+
+  return queue;
+}
+
+/****************************************************************************
+ * Name: spi_queue_submit
+ *
+ * Description:
+ *   Add a list of transactions to the end of the queue.  See
+ *   include/nuttx/spi.h.
+ *
+ ****************************************************************************/
+
+int spi_queue_submit(FAR struct spi_queue_s *queue,
+                     FAR struct spi_trans_s *first)
+{
+  FAR struct spi_trans_s *last;
+  irqstate_t flags;
+  bool start;
+
+  DEBUGASSERT(queue && first);
+
+  /* A chip select sequence must end within the list */
+
+  for (last = first; ; last = last->flink)
+    {
+      if ((last->flags & SPI_TRANSFLAG_KEEPCS) != 0 &&
+          (!last->flink || last->flink->devid != last->devid))
+        {
+          return -EINVAL;
+        }
+
+      last->result = -EINPROGRESS;
+      if (!last->flink)
+        {
+          break;
+        }
+    }
+
+  /* Add the list to the queue and start the worker if it is not running */
+
+  flags = irqsave();
+  if (queue->tail)
+    {
+      queue->tail->flink = first;
+    }
+  else
+    {
+      queue->head = first;
+    }
+
+  queue->tail = last;
+  start       = !queue->busy;
+  queue->busy = true;
+  irqrestore(flags);
+
+  if (start)
+    {
+      int ret = work_queue(LPWORK, &queue->work, spi_queue_worker, queue, 0);
+      if (ret < 0)
+        {
+          /* The queue was idle, so the list is at its head.  Take it back
+           * so that the queue is not left busy with nothing to run it.  Any
+           * lists added since then are started by the next submission.
+           */
+
+          flags       = irqsave();
+          queue->head = last->flink;
+          if (!queue->head)
+            {
+              queue->tail = NULL;
+            }
+
+          last->flink = NULL;
+          queue->busy = false;
+          irqrestore(flags);
+        }
+
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: spi_queue_uninitialize
+ *
+ * Description:
+ *   Free a transaction queue.  See include/nuttx/spi.h.
+ *
+ ****************************************************************************/
+
+int spi_queue_uninitialize(FAR struct spi_queue_s *queue)
+{
+  DEBUGASSERT(queue);
+
+  if (queue->busy)
+    {
+      return -EBUSY;
+    }
+
+  kfree(queue);
+  return OK;
+}
+
+#endif /* CONFIG_SPI_QUEUE */
@@ -1378,6 +1378,7 @@ int usbmsc_bindlun(FAR void *handle, FAR const char *drvrpath,
   FAR struct usbmsc_lun_s *lun;
   FAR struct inode *inode;
   struct geometry geo;
+  uint32_t iosize;
   int ret;
 
 #ifdef CONFIG_DEBUG
@@ -1453,26 +1454,34 @@ int usbmsc_bindlun(FAR void *handle, FAR const char *drvrpath,
 
   memset(lun, 0, sizeof(struct usbmsc_lun_s *));
 
-  /* Allocate an I/O buffer big enough to hold one hardware sector.  SCSI commands
-   * are processed one at a time so all LUNs may share a single I/O buffer.  The
-   * I/O buffer will be allocated so that is it as large as the largest block
-   * device sector size
+  /* Allocate an I/O buffer big enough to hold CONFIG_USBMSC_IOSECTORS
+   * hardware sectors (normally one).  SCSI commands are processed one at a
+   * time so all LUNs may share a single I/O buffer.  The I/O buffer will be
+   * allocated so that is it large enough for the largest block device
+   * sector size.
    */
 
+  iosize = CONFIG_USBMSC_IOSECTORS * geo.geo_sectorsize;
+  if (iosize > UINT16_MAX)
+    {
+      usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_ALLOCIOBUFFER), geo.geo_sectorsize);
+      return -EDOM;
+    }
+
   if (!priv->iobuffer)
     {
-      priv->iobuffer = (uint8_t*)kmalloc(geo.geo_sectorsize);
+      priv->iobuffer = (uint8_t*)kmalloc(iosize);
       if (!priv->iobuffer)
         {
           usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_ALLOCIOBUFFER), geo.geo_sectorsize);
           return -ENOMEM;
         }
-      priv->iosize = geo.geo_sectorsize;
+      priv->iosize = iosize;
     }
-  else if (priv->iosize < geo.geo_sectorsize)
+  else if (priv->iosize < iosize)
     {
       void *tmp;
-      tmp = (uint8_t*)krealloc(priv->iobuffer, geo.geo_sectorsize);
+      tmp = (uint8_t*)krealloc(priv->iobuffer, iosize);
       if (!tmp)
         {
           usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_REALLOCIOBUFFER), geo.geo_sectorsize);
@@ -1480,7 +1489,7 @@ int usbmsc_bindlun(FAR void *handle, FAR const char *drvrpath,
         }
 
       priv->iobuffer = (uint8_t*)tmp;
-      priv->iosize   = geo.geo_sectorsize;
+      priv->iosize   = iosize;
     }
 
   lun->inode       = inode;
@@ -96,6 +96,19 @@
 #  define CONFIG_USBMSC_NRDREQS 4
 #endif
 
+/* Number of sectors in the I/O buffer (and so the largest number of sectors
+ * transferred in one block driver call).
+ */
+
+#ifndef CONFIG_USBMSC_MULTISECTOR
+#  undef CONFIG_USBMSC_IOSECTORS
+#  define CONFIG_USBMSC_IOSECTORS 1
+#elif !defined(CONFIG_USBMSC_IOSECTORS)
+#  define CONFIG_USBMSC_IOSECTORS 8
+#elif CONFIG_USBMSC_IOSECTORS < 1
+#  error "CONFIG_USBMSC_IOSECTORS must be at least 1"
+#endif
+
 /* Logical endpoint numbers / max packet sizes */
 
 #ifndef CONFIG_USBMSC_EPBULKOUT
@@ -481,7 +494,7 @@ struct usbmsc_dev_s
   uint8_t           cbwlun;           /* LUN from the CBW */
   uint16_t          nsectbytes;       /* Bytes buffered in iobuffer[] */
   uint16_t          nreqbytes;        /* Bytes buffered in head write requests */
-  uint16_t          iosize;           /* Size of iobuffer[] */
+  uint16_t          iosize;           /* Size of iobuffer[] (CONFIG_USBMSC_IOSECTORS sectors) */
   uint32_t          cbwlen;           /* Length of data from CBW */
   uint32_t          cbwtag;           /* Tag from the CBW */
   union
@@ -777,6 +777,9 @@ static int inline usbmsc_cmdmodesense6(FAR struct usbmsc_dev_s *priv,
 
 static inline int usbmsc_cmdstartstopunit(FAR struct usbmsc_dev_s *priv)
 {
+#ifndef CONFIG_USBMSC_REMOVABLE
+  FAR struct usbmsc_lun_s *lun = priv->lun;
+#endif
   int ret;
 
   priv->u.alloclen = 0;
@@ -806,8 +809,8 @@ static inline int usbmsc_cmdpreventmediumremoval(FAR struct usbmsc_dev_s *priv)
 {
 #ifdef CONFIG_USBMSC_REMOVABLE
   FAR struct scsicmd_preventmediumremoval_s *pmr = (FAR struct scsicmd_preventmediumremoval_s *)priv->cdb;
-  FAR struct usbmsc_lun_s *lun = priv->lun;
 #endif
+  FAR struct usbmsc_lun_s *lun = priv->lun;
   int ret;
 
   priv->u.alloclen = 0;
@@ -1986,7 +1989,8 @@ static int usbmsc_cmdparsestate(FAR struct usbmsc_dev_s *priv)
  * State variables:
  *   xfrlen     - holds the number of sectors read to be read.
  *   sector     - holds the sector number of the next sector to be read
- *   nsectbytes - holds the number of bytes buffered for the current sector
+ *   nsectbytes - holds the number of bytes still buffered at the end of
+ *                iobuffer[]
  *   nreqbytes  - holds the number of bytes currently buffered in the request
  *                at the head of the wrreqlist.
  *
@@ -2001,6 +2005,8 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
   ssize_t nread;
   uint8_t *src;
   uint8_t *dest;
+  bool direct = false;
+  int nsectors;
   int nbytes;
   int ret;
 
@@ -2013,14 +2019,29 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
     {
       usbtrace(TRACE_CLASSSTATE(USBMSC_CLASSSTATE_CMDREAD), priv->u.xfrlen);
 
+#ifdef CONFIG_USBMSC_MULTISECTOR
+      /* If a write request holds at least as many sectors as the I/O buffer,
+       * then the sectors are read directly into the request at the head of
+       * the wrreqlist and there is nothing to copy.
+       */
+
+      direct = (priv->nsectbytes <= 0 && priv->nreqbytes == 0 &&
+                CONFIG_USBMSC_BULKINREQLEN / lun->sectorsize >=
+                CONFIG_USBMSC_IOSECTORS);
+#endif
+
       /* Is the I/O buffer empty? */
 
-      if (priv->nsectbytes <= 0)
+      if (!direct && priv->nsectbytes <= 0)
         {
-          /* Yes.. read the next sector */
+          /* Yes.. read the next sectors into the end of the I/O buffer */
+
+          nsectors = MIN(priv->u.xfrlen, CONFIG_USBMSC_IOSECTORS);
+          nbytes   = nsectors * lun->sectorsize;
 
-          nread = USBMSC_DRVR_READ(lun, priv->iobuffer, priv->sector, 1);
-          if (nread < 0)
+          nread = USBMSC_DRVR_READ(lun, &priv->iobuffer[priv->iosize - nbytes],
+                                   priv->sector, nsectors);
+          if (nread < nsectors)
             {
               usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL), -nread);
               lun->sd     = SCSI_KCQME_UNRRE1;
@@ -2028,9 +2049,9 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
               break;
             }
 
-          priv->nsectbytes = lun->sectorsize;
-          priv->u.xfrlen--;
-          priv->sector++;
+          priv->nsectbytes = nbytes;
+          priv->u.xfrlen  -= nsectors;
+          priv->sector    += nsectors;
         }
 
       /* Check if there is a request in the wrreqlist that we will be able to
@@ -2053,27 +2074,52 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
         }
       req = privreq->req;
 
-      /* Transfer all of the data that will (1) fit into the request buffer, OR (2)
-       * all of the data available in the sector buffer.
-       */
+#ifdef CONFIG_USBMSC_MULTISECTOR
+      if (direct)
+        {
+          /* Read as many sectors as will fit into the request buffer */
+
+          nsectors = MIN(priv->u.xfrlen,
+                         CONFIG_USBMSC_BULKINREQLEN / lun->sectorsize);
+
+          nread = USBMSC_DRVR_READ(lun, req->buf, priv->sector, nsectors);
+          if (nread < nsectors)
+            {
+              usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL), -nread);
+              lun->sd     = SCSI_KCQME_UNRRE1;
+              lun->sdinfo = priv->sector;
+              break;
+            }
+
+          priv->nreqbytes  = nsectors * lun->sectorsize;
+          priv->u.xfrlen  -= nsectors;
+          priv->sector    += nsectors;
+        }
+      else
+#endif
+        {
+          /* Transfer all of the data that will (1) fit into the request
+           * buffer, OR (2) all of the data available in the sector buffer.
+           */
 
-      src    = &priv->iobuffer[lun->sectorsize - priv->nsectbytes];
-      dest   = &req->buf[priv->nreqbytes];
+          src    = &priv->iobuffer[priv->iosize - priv->nsectbytes];
+          dest   = &req->buf[priv->nreqbytes];
 
-      nbytes = MIN(CONFIG_USBMSC_BULKINREQLEN - priv->nreqbytes, priv->nsectbytes);
+          nbytes = MIN(CONFIG_USBMSC_BULKINREQLEN - priv->nreqbytes, priv->nsectbytes);
 
-      /* Copy the data from the sector buffer to the USB request and update counts */
+          /* Copy the data from the sector buffer to the USB request and update counts */
 
-      memcpy(dest, src, nbytes);
-      priv->nreqbytes  += nbytes;
-      priv->nsectbytes -= nbytes;
+          memcpy(dest, src, nbytes);
+          priv->nreqbytes  += nbytes;
+          priv->nsectbytes -= nbytes;
+        }
 
       /* If (1) the request buffer is full OR (2) this is the final request full of data,
-       * then submit the request
+       * OR (3) the request was filled directly from the media, then submit the request
        */
 
       if (priv->nreqbytes >= CONFIG_USBMSC_BULKINREQLEN ||
-          (priv->u.xfrlen <= 0 && priv->nsectbytes <= 0))
+          (priv->u.xfrlen <= 0 && priv->nsectbytes <= 0) || direct)
         {
           /* Remove the request that we just filled from wrreqlist (we've already checked
            * that is it not NULL
@@ -2132,7 +2178,8 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
  * State variables:
  *   xfrlen     - holds the number of sectors read to be written.
  *   sector     - holds the sector number of the next sector to write
- *   nsectbytes - holds the number of bytes buffered for the current sector
+ *   nsectbytes - holds the number of bytes gathered in iobuffer[] for the
+ *                next write
  *   nreqbytes  - holds the number of untransferred bytes currently in the
  *                request at the head of the rdreqlist.
  *
@@ -2147,6 +2194,8 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
   uint16_t xfrd;
   uint8_t *src;
   uint8_t *dest;
+  int nsectors;
+  int iolen;
   int nbytes;
   int ret;
 
@@ -2188,12 +2237,19 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
 
       while (priv->nreqbytes > 0 && priv->u.xfrlen > 0)
         {
+          /* Data is gathered in the I/O buffer until it holds either
+           * CONFIG_USBMSC_IOSECTORS sectors or all of the sectors that remain.
+           */
+
+          nsectors = MIN(priv->u.xfrlen, CONFIG_USBMSC_IOSECTORS);
+          iolen    = nsectors * lun->sectorsize;
+
           /* Copy the data received in the read request into the sector I/O buffer */
 
           src  = &req->buf[xfrd - priv->nreqbytes];
           dest = &priv->iobuffer[priv->nsectbytes];
 
-          nbytes = MIN(lun->sectorsize - priv->nsectbytes, priv->nreqbytes);
+          nbytes = MIN(iolen - priv->nsectbytes, priv->nreqbytes);
 
           /* Copy the data from the sector buffer to the USB request and update counts */
 
@@ -2203,12 +2259,12 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
 
           /* Is the I/O buffer full? */
 
-          if (priv->nsectbytes >= lun->sectorsize)
+          if (priv->nsectbytes >= iolen)
             {
-              /* Yes.. Write the next sector */
+              /* Yes.. Write the buffered sectors */
 
-              nwritten = USBMSC_DRVR_WRITE(lun, priv->iobuffer, priv->sector, 1);
-              if (nwritten < 0)
+              nwritten = USBMSC_DRVR_WRITE(lun, priv->iobuffer, priv->sector, nsectors);
+              if (nwritten < nsectors)
                 {
                   usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDWRITEWRITEFAIL), -nwritten);
                   lun->sd     = SCSI_KCQME_WRITEFAULTAUTOREALLOCFAILED;
@@ -2217,9 +2273,9 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
                 }
 
               priv->nsectbytes = 0;
-              priv->residue   -= lun->sectorsize;
-              priv->u.xfrlen--;
-              priv->sector++;
+              priv->residue   -= iolen;
+              priv->u.xfrlen  -= nsectors;
+              priv->sector    += nsectors;
             }
         }
 
@@ -516,7 +516,7 @@ mkfatfs_tryfat16(FAR struct fat_format_s *fmt, FAR struct fat_var_s *var,
        *   maxnclusters = nfatsects * sectorsize / 2 - 2
        */
 
-      maxnclusters = config->fc_nfatsects << (var->fv_sectorsize - 1);
+      maxnclusters = config->fc_nfatsects << (var->fv_sectshift - 1);
       if (maxnclusters > FAT_MAXCLUST16)
         {
           maxnclusters = FAT_MAXCLUST16;
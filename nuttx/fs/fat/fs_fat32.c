@@ -62,6 +62,7 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/fat.h>
 #include <nuttx/fs/dirent.h>
+#include <nuttx/fs/ioctl.h>
 
 #include "fs_internal.h"
 #include "fs_fat32.h"
@@ -153,6 +154,246 @@ const struct mountpt_operations fat_operations =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: fat_reserve
+ *
+ * Description: Make sure that the cluster chain of the file is long enough
+ *   to hold 'length' bytes, adding contiguous clusters if possible.  This
+ *   is the FIOC_RESERVE ioctl.
+ *
+ ****************************************************************************/
+
+static int fat_reserve(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                       off_t length)
+{
+  uint32_t clustersize = fs->fs_hwsectorsize * fs->fs_fatsecperclus;
+  uint32_t needed;
+  uint32_t nclusters;
+  uint32_t cluster;
+  off_t    next;
+  int32_t  ret;
+
+  needed = (length + clustersize - 1) / clustersize;
+  if (needed == 0)
+    {
+      return OK;
+    }
+
+  /* Create the cluster chain if the file does not have one yet */
+
+  if (ff->ff_startcluster == 0)
+    {
+      ret = fat_createchain(fs);
+      if (ret < 0)
+        {
+          return ret;
+        }
+      else if (ret < 2)
+        {
+          return -ENOSPC;
+        }
+
+      ff->ff_startcluster     = ret;
+      ff->ff_currentcluster   = ret;
+      ff->ff_sectorsincluster = fs->fs_fatsecperclus;
+      ff->ff_bflags          |= (FFBUFF_MODIFIED|FFBUFF_RESERVED);
+    }
+
+  /* Find the end of the chain */
+
+  cluster   = ff->ff_startcluster;
+  nclusters = 1;
+  for (;;)
+    {
+      next = fat_getcluster(fs, cluster);
+      if (next < 0)
+        {
+          return next;
+        }
+      else if (next < 2 || next >= fs->fs_nclusters)
+        {
+          break;
+        }
+
+      cluster = next;
+      nclusters++;
+    }
+
+  if (nclusters >= needed)
+    {
+      return OK;
+    }
+
+  /* Then add the missing clusters */
+
+  ret = fat_reservechain(fs, cluster, needed - nclusters);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ff->ff_bflags |= FFBUFF_RESERVED;
+  return ret < needed - nclusters ? -ENOSPC : OK;
+}
+
+/****************************************************************************
+ * Name: fat_growreserve
+ *
+ * Description: Called by fat_write() when the current cluster is full.  If
+ *   the current cluster is the last one in the chain, add enough clusters
+ *   for the rest of the write (at least) in one contiguous run, so that the
+ *   write can be performed with multi-sector transfers.  With
+ *   CONFIG_FAT_PREALLOCATE, the number of clusters added ahead of the data
+ *   doubles each time that the file grows, up to that limit.
+ *
+ ****************************************************************************/
+
+static int fat_growreserve(struct fat_mountpt_s *fs, struct fat_file_s *ff,
+                           size_t buflen)
+{
+  uint32_t clustersize = fs->fs_hwsectorsize * fs->fs_fatsecperclus;
+  uint32_t nclusters;
+  off_t    next;
+  int32_t  ret;
+
+  next = fat_getcluster(fs, ff->ff_currentcluster);
+  if (next < 0)
+    {
+      return next;
+    }
+  else if (next >= 2 && next < fs->fs_nclusters)
+    {
+      /* The chain already continues */
+
+      return OK;
+    }
+
+  nclusters = (buflen + clustersize - 1) / clustersize;
+
+#if CONFIG_FAT_PREALLOCATE > 0
+  if (nclusters < ff->ff_nreserve)
+    {
+      nclusters = ff->ff_nreserve;
+    }
+
+  if (ff->ff_nreserve < CONFIG_FAT_PREALLOCATE)
+    {
+      ff->ff_nreserve = ff->ff_nreserve ? ff->ff_nreserve << 1 : 1;
+      if (ff->ff_nreserve > CONFIG_FAT_PREALLOCATE)
+        {
+          ff->ff_nreserve = CONFIG_FAT_PREALLOCATE;
+        }
+    }
+#endif
+
+  /* A single cluster is simply added by fat_extendchain() */
+
+  if (nclusters < 2)
+    {
+      return OK;
+    }
+
+  ret = fat_reservechain(fs, ff->ff_currentcluster, nclusters);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  ff->ff_bflags |= FFBUFF_RESERVED;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_freereserve
+ *
+ * Description: Free the clusters that follow the end of the file when the
+ *   file is closed.  If the file is still open through another file
+ *   structure, the reservation is handed over to that structure instead and
+ *   is freed when it is closed.
+ *
+ ****************************************************************************/
+
+static int fat_freereserve(struct fat_mountpt_s *fs, struct fat_file_s *ff)
+{
+  struct fat_file_s *other;
+  uint32_t clustersize = fs->fs_hwsectorsize * fs->fs_fatsecperclus;
+  uint32_t nclusters;
+  uint32_t cluster;
+  off_t    next;
+  int      ret;
+
+  for (other = fs->fs_head; other; other = other->ff_next)
+    {
+      if (other != ff && other->ff_dirsector == ff->ff_dirsector &&
+          other->ff_dirindex == ff->ff_dirindex)
+        {
+          /* The other structure does not know about data written through
+           * this one.  Make sure that it will not free those clusters.
+           */
+
+          if (other->ff_size < ff->ff_size)
+            {
+              other->ff_size = ff->ff_size;
+            }
+
+          other->ff_bflags |= FFBUFF_RESERVED;
+          ff->ff_bflags    &= ~FFBUFF_RESERVED;
+          return OK;
+        }
+    }
+
+  ff->ff_bflags &= ~FFBUFF_RESERVED;
+  if (ff->ff_startcluster == 0)
+    {
+      return OK;
+    }
+
+  /* An empty file has no clusters at all */
+
+  nclusters = (ff->ff_size + clustersize - 1) / clustersize;
+  if (nclusters == 0)
+    {
+      ret = fat_removechain(fs, ff->ff_startcluster);
+      ff->ff_startcluster = 0;
+      ff->ff_bflags      |= FFBUFF_MODIFIED;
+      return ret;
+    }
+
+  /* Find the last cluster that holds file data */
+
+  cluster = ff->ff_startcluster;
+  while (--nclusters > 0)
+    {
+      next = fat_getcluster(fs, cluster);
+      if (next < 2 || next >= fs->fs_nclusters)
+        {
+          return next < 0 ? next : OK;
+        }
+
+      cluster = next;
+    }
+
+  /* Terminate the chain there and free the rest */
+
+  next = fat_getcluster(fs, cluster);
+  if (next < 0)
+    {
+      return next;
+    }
+  else if (next >= 2 && next < fs->fs_nclusters)
+    {
+      ret = fat_putcluster(fs, cluster, 0x0fffffff);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      return fat_removechain(fs, next);
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: fat_open
  ****************************************************************************/
@@ -352,7 +593,7 @@ static int fat_open(FAR struct file *filep, const char *relpath,
    */
 
   ff->ff_next = fs->fs_head;
-  fs->fs_head = ff->ff_next;
+  fs->fs_head = ff;
 
   fat_semgive(fs);
  
@@ -390,7 +631,10 @@ static int fat_close(FAR struct file *filep)
 {
   struct inode         *inode;
   struct fat_file_s    *ff;
+  struct fat_file_s    *prev;
+  struct fat_file_s    *curr;
   struct fat_mountpt_s *fs;
+  int                   syncret;
   int                   ret = OK;
 
   /* Sanity checks */
@@ -407,9 +651,41 @@ static int fat_close(FAR struct file *filep)
    * the file even when there is healthy mount.
    */
 
+  /* Free any clusters reserved beyond the end of the file, then remove the
+   * file from the list of open files.
+   */
+
+  fat_semtake(fs);
+  if ((ff->ff_bflags & FFBUFF_RESERVED) != 0 && fat_checkmount(fs) == OK)
+    {
+      ret = fat_freereserve(fs, ff);
+    }
+
+  for (prev = NULL, curr = fs->fs_head;
+       curr && curr != ff;
+       prev = curr, curr = curr->ff_next);
+
+  if (curr)
+    {
+      if (prev)
+        {
+          prev->ff_next = ff->ff_next;
+        }
+      else
+        {
+          fs->fs_head = ff->ff_next;
+        }
+    }
+
+  fat_semgive(fs);
+
   /* Synchronize the file buffers and disk content; update times */
 
-  ret = fat_sync(filep);
+  syncret = fat_sync(filep);
+  if (ret == OK)
+    {
+      ret = syncret;
+    }
 
   /* Then deallocate the memory structures created when the open method
    * was called.
@@ -659,9 +935,11 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
   struct fat_mountpt_s *fs;
   struct fat_file_s    *ff;
   int32_t               cluster;
+  uint32_t              endcluster;
   unsigned int          byteswritten;
   unsigned int          writesize;
   unsigned int          nsectors;
+  unsigned int          runsectors;
   uint8_t              *userbuffer = (uint8_t*)buffer;
   int                   sectorindex;
   int                   ret;
@@ -758,6 +1036,16 @@ static ssize_t fat_write(FAR struct file *filep, const char *buffer,
 
       if (ff->ff_sectorsincluster < 1)
         {
+          /* If this is the last cluster of the file, first reserve
+           * clusters for the rest of the write.
+           */
+
+          ret = fat_growreserve(fs, ff, buflen);
+          if (ret < 0)
+            {
+              goto errout_with_semaphore;
+            }
+
           /* Extend the current cluster by one (unless lseek was used to
            * move the file position back from the end of the file)
            */
@@ -794,12 +1082,27 @@ fat_write_restart:
            *
            * Limit the number of sectors that we write on this time
            * through the loop to the remaining contiguous sectors
-           * in this cluster
+           * in this cluster and in the clusters that follow it
+           * consecutively in the chain.
            */
 
-          if (nsectors > ff->ff_sectorsincluster)
+          runsectors = ff->ff_sectorsincluster;
+          endcluster = ff->ff_currentcluster;
+          while (runsectors < nsectors)
             {
-              nsectors = ff->ff_sectorsincluster;
+              cluster = fat_getcluster(fs, endcluster);
+              if (cluster != endcluster + 1)
+                {
+                  break;
+                }
+
+              endcluster  = cluster;
+              runsectors += fs->fs_fatsecperclus;
+            }
+
+          if (nsectors > runsectors)
+            {
+              nsectors = runsectors;
             }
 
           /* We are not sure of the state of the sector cache so the
@@ -833,7 +1136,8 @@ fat_write_restart:
               goto errout_with_semaphore;
             }
 
-          ff->ff_sectorsincluster -= nsectors;
+          ff->ff_currentcluster    = endcluster;
+          ff->ff_sectorsincluster  = runsectors - nsectors;
           ff->ff_currentsector    += nsectors;
           writesize                = nsectors * fs->fs_hwsectorsize;
           ff->ff_bflags           |= FFBUFF_MODIFIED;
@@ -1195,6 +1499,25 @@ static int fat_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       return ret;
     }
 
+  /* Reserve clusters for the file to grow into */
+
+  if (cmd == FIOC_RESERVE)
+    {
+      struct fat_file_s *ff = filep->f_priv;
+
+      if ((ff->ff_oflags & O_WROK) == 0)
+        {
+          ret = -EACCES;
+        }
+      else
+        {
+          ret = fat_reserve(fs, ff, (off_t)arg);
+        }
+
+      fat_semgive(fs);
+      return ret;
+    }
+
   /* ioctl calls are just passed through to the contained block driver */
 
   fat_semgive(fs);
@@ -1292,6 +1615,23 @@ static int fat_sync(FAR struct file *filep)
 
       fs->fs_dirty = true;
       ret          = fat_updatefsinfo(fs);
+      if (ret < 0)
+        {
+          goto errout_with_semaphore;
+        }
+    }
+
+  /* Ask the block driver to write back anything that it has cached.  Block
+   * drivers that do not cache writes will not recognize the command.
+   */
+
+  if (fs->fs_blkdriver->u.i_bops->ioctl)
+    {
+      ret = fs->fs_blkdriver->u.i_bops->ioctl(fs->fs_blkdriver, BIOC_FLUSH, 0);
+      if (ret == -ENOTTY)
+        {
+          ret = OK;
+        }
     }
 
 errout_with_semaphore:
@@ -1400,7 +1740,7 @@ static int fat_dup(FAR const struct file *oldp, FAR struct file *newp)
    */
 
   newff->ff_next = fs->fs_head;
-  fs->fs_head = newff->ff_next;
+  fs->fs_head = newff;
 
   fat_semgive(fs);
   return OK;
@@ -1837,10 +2177,7 @@ static int fat_unbind(void *handle, FAR struct inode **blkdriver)
 
       /* Release the mountpoint private data */
 
-      if (fs->fs_buffer)
-        {
-          fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
-        }
+      fat_fscachefree(fs);
 
       kfree(fs);
     }
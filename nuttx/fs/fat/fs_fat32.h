@@ -276,6 +276,7 @@
 #define FFBUFF_VALID        1
 #define FFBUFF_DIRTY        2
 #define FFBUFF_MODIFIED     4
+#define FFBUFF_RESERVED     8  /* Clusters may be reserved beyond the end of file */
 
 /****************************************************************************
  * These offset describe the FSINFO sector
@@ -704,10 +705,45 @@
 #  define fat_io_free(m,s) kfree(m)
 #endif
 
+/****************************************************************************
+ * Name: FAT sector cache
+ *
+ * Description:
+ *   FAT and directory sectors are accessed through a cache of
+ *   CONFIG_FAT_CACHESECTORS sectors.  The sector most recently accessed with
+ *   fat_fscacheread() is available as fs_buffer;  fs_currentsector and
+ *   fs_dirty describe that sector.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_FAT_CACHESECTORS
+#  define CONFIG_FAT_CACHESECTORS 1
+#endif
+
+#ifndef CONFIG_FAT_PREALLOCATE
+#  define CONFIG_FAT_PREALLOCATE 0
+#endif
+
+/* The pre-allocation count doubles in a uint16_t */
+
+#if CONFIG_FAT_PREALLOCATE > 32768
+#  error CONFIG_FAT_PREALLOCATE may not exceed 32768
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* This structure describes one sector in the FAT sector cache */
+
+struct fat_cache_s
+{
+  off_t    fc_sector;              /* The sector number in fc_buffer (-1: none) */
+  uint32_t fc_lastuse;             /* fs_usecount when this sector was last used */
+  bool     fc_dirty;               /* true: fc_buffer must be written to disk */
+  uint8_t *fc_buffer;              /* One sector of the cache memory */
+};
+
 /* This structure represents the overall mountpoint state.  An instance of this
  * structure is retained as inode private data on each mountpoint that is
  * mounted with a fat32 filesystem.
@@ -742,6 +778,14 @@ struct fat_mountpt_s
   uint8_t  fs_fatsecperclus;       /* MBR: Sectors per allocation unit: 2**n, n=0..7 */
   uint8_t *fs_buffer;              /* This is an allocated buffer to hold one sector
                                     * from the device */
+  uint8_t  fs_cacheindex;          /* Index of the cache entry in fs_buffer */
+  uint32_t fs_usecount;            /* Counts accesses to the sector cache */
+  struct fat_cache_s fs_cache[CONFIG_FAT_CACHESECTORS];
+#ifdef CONFIG_FAT_FREEBITMAP
+  bool     fs_freemapvalid;        /* true: fs_freemap agrees with the FAT */
+  uint32_t *fs_freemap;            /* One bit per cluster, set if the cluster is
+                                    * free */
+#endif
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -762,6 +806,9 @@ struct fat_file_s
   off_t    ff_startcluster;        /* Start cluster of file on media */
   off_t    ff_currentsector;       /* Current sector being operated on */
   off_t    ff_cachesector;         /* Current sector in the file buffer */
+#if CONFIG_FAT_PREALLOCATE > 0
+  uint16_t ff_nreserve;            /* Clusters to reserve when the file grows */
+#endif
   uint8_t *ff_buffer;              /* File buffer (for partial sector accesses) */
 };
 
@@ -894,6 +941,8 @@ EXTERN int    fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno,
                              off_t startsector);
 EXTERN int    fat_removechain(struct fat_mountpt_s *fs, uint32_t cluster);
 EXTERN int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster);
+EXTERN int32_t fat_reservechain(struct fat_mountpt_s *fs, uint32_t cluster,
+                                uint32_t nclusters);
 
 #define fat_createchain(fs) fat_extendchain(fs, 0)
 
@@ -919,6 +968,7 @@ EXTERN int    fat_remove(struct fat_mountpt_s *fs, const char *relpath, bool dir
 
 EXTERN int    fat_fscacheflush(struct fat_mountpt_s *fs);
 EXTERN int    fat_fscacheread(struct fat_mountpt_s *fs, off_t sector);
+EXTERN void   fat_fscachefree(struct fat_mountpt_s *fs);
 EXTERN int    fat_ffcacheflush(struct fat_mountpt_s *fs, struct fat_file_s *ff);
 EXTERN int    fat_ffcacheread(struct fat_mountpt_s *fs, struct fat_file_s *ff, off_t sector);
 EXTERN int    fat_ffcacheinvalidate(struct fat_mountpt_s *fs, struct fat_file_s *ff);
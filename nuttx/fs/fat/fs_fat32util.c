@@ -87,6 +87,508 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: fat_fscachesync
+ *
+ * Desciption: Save the state of the sector in fs_buffer in its cache entry.
+ *   Callers may re-use fs_buffer to build a new sector by changing
+ *   fs_currentsector;  any other cached copy of that sector is then stale
+ *   and is discarded.
+ *
+ ****************************************************************************/
+
+static void fat_fscachesync(struct fat_mountpt_s *fs)
+{
+  struct fat_cache_s *entry = &fs->fs_cache[fs->fs_cacheindex];
+  int i;
+
+  if (entry->fc_sector != fs->fs_currentsector)
+    {
+      for (i = 0; i < CONFIG_FAT_CACHESECTORS; i++)
+        {
+          if (i != fs->fs_cacheindex &&
+              fs->fs_cache[i].fc_sector == fs->fs_currentsector)
+            {
+              fs->fs_cache[i].fc_sector = -1;
+              fs->fs_cache[i].fc_dirty  = false;
+            }
+        }
+
+      entry->fc_sector = fs->fs_currentsector;
+    }
+
+  entry->fc_dirty = fs->fs_dirty;
+}
+
+/****************************************************************************
+ * Name: fat_fscachewrite
+ *
+ * Desciption: Write one dirty cached sector to the device.  Sectors in the
+ *   FAT region are also written to each copy of the FAT.
+ *
+ ****************************************************************************/
+
+static int fat_fscachewrite(struct fat_mountpt_s *fs,
+                            struct fat_cache_s *entry)
+{
+  off_t sector = entry->fc_sector;
+  int   ret;
+
+  ret = fat_hwwrite(fs, entry->fc_buffer, sector, 1);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  /* Does the sector lie in the FAT region? */
+
+  if (sector >= fs->fs_fatbase && sector < fs->fs_fatbase + fs->fs_nfatsects)
+    {
+      /* Yes, then make the change in the FAT copy as well */
+
+      int i;
+
+      for (i = fs->fs_fatnumfats; i >= 2; i--)
+        {
+          sector += fs->fs_nfatsects;
+          ret = fat_hwwrite(fs, entry->fc_buffer, sector, 1);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  /* No longer dirty */
+
+  entry->fc_dirty = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fscachediscard
+ *
+ * Desciption: Discard any cached copies of the sectors in a cluster that
+ *   has been freed.  Their contents, dirty or not, are no longer needed and
+ *   must not be written over the next user of the cluster.
+ *
+ ****************************************************************************/
+
+static void fat_fscachediscard(struct fat_mountpt_s *fs, uint32_t cluster)
+{
+  off_t sector = fat_cluster2sector(fs, cluster);
+  int   i;
+
+  if (sector < 0)
+    {
+      return;
+    }
+
+  fat_fscachesync(fs);
+  for (i = 0; i < CONFIG_FAT_CACHESECTORS; i++)
+    {
+      if (fs->fs_cache[i].fc_sector >= sector &&
+          fs->fs_cache[i].fc_sector < sector + fs->fs_fatsecperclus)
+        {
+          fs->fs_cache[i].fc_sector = -1;
+          fs->fs_cache[i].fc_dirty  = false;
+        }
+    }
+
+  fs->fs_currentsector = fs->fs_cache[fs->fs_cacheindex].fc_sector;
+  fs->fs_dirty         = fs->fs_cache[fs->fs_cacheindex].fc_dirty;
+}
+
+#ifdef CONFIG_FAT_FREEBITMAP
+/****************************************************************************
+ * Name: fat_freemapset
+ *
+ * Desciption: Mark a cluster as free or in-use in the free cluster bitmap
+ *
+ ****************************************************************************/
+
+static inline void fat_freemapset(struct fat_mountpt_s *fs, uint32_t cluster,
+                                  bool isfree)
+{
+  if (isfree)
+    {
+      fs->fs_freemap[cluster >> 5] |= (uint32_t)1 << (cluster & 31);
+    }
+  else
+    {
+      fs->fs_freemap[cluster >> 5] &= ~((uint32_t)1 << (cluster & 31));
+    }
+}
+
+/****************************************************************************
+ * Name: fat_freemapsearch
+ *
+ * Desciption: Find the first free cluster in the range first..last-1 of the
+ *   free cluster bitmap, examining 32 clusters at a time.
+ *
+ * Return: 0: no free cluster, >=2: free cluster number
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemapsearch(struct fat_mountpt_s *fs, uint32_t first,
+                                  uint32_t last)
+{
+  uint32_t bits;
+
+  while (first < last)
+    {
+      bits = fs->fs_freemap[first >> 5] >> (first & 31);
+      if (bits != 0)
+        {
+          while ((bits & 1) == 0)
+            {
+              bits >>= 1;
+              first++;
+            }
+
+          return first < last ? first : 0;
+        }
+
+      first = (first | 31) + 1;
+    }
+
+  return 0;
+}
+
+/****************************************************************************
+ * Name: fat_freemaprun
+ *
+ * Desciption: Find the first run of nclusters free clusters in the free
+ *   cluster bitmap, starting at cluster 'first' and wrapping back to the
+ *   beginning of the FAT if necessary.
+ *
+ * Return: 0: no such run, >=2: first cluster of the run
+ *
+ ****************************************************************************/
+
+static uint32_t fat_freemaprun(struct fat_mountpt_s *fs, uint32_t first,
+                               uint32_t nclusters)
+{
+  uint32_t start;
+  uint32_t end;
+  uint32_t last;
+  int      pass;
+
+  last = fs->fs_nclusters;
+  for (pass = 0; pass < 2; pass++)
+    {
+      start = fat_freemapsearch(fs, first, last);
+      while (start != 0)
+        {
+          /* Find the end of this run of free clusters */
+
+          end = start + 1;
+          while (end < fs->fs_nclusters && end - start < nclusters &&
+                 (fs->fs_freemap[end >> 5] & ((uint32_t)1 << (end & 31))) != 0)
+            {
+              end++;
+            }
+
+          if (end - start >= nclusters)
+            {
+              return start;
+            }
+
+          start = fat_freemapsearch(fs, end + 1, last);
+        }
+
+      /* Then search from the beginning up to where we started */
+
+      last  = first;
+      first = 2;
+    }
+
+  return 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: fat_scanfat
+ *
+ * Desciption: Read the entire FAT and count the free clusters.  If
+ *   CONFIG_FAT_FREEBITMAP is selected, the free cluster bitmap is built at
+ *   the same time.
+ *
+ ****************************************************************************/
+
+static int fat_scanfat(struct fat_mountpt_s *fs)
+{
+  uint32_t nfreeclusters;
+  uint32_t cluster;
+  bool     isfree;
+
+  nfreeclusters = 0;
+  if (fs->fs_type == FSTYPE_FAT12)
+    {
+      /* Examine every cluster in the fat */
+
+      for (cluster = 2; cluster < fs->fs_nclusters; cluster++)
+        {
+          /* If the cluster is unassigned, then increment the count of free clusters */
+
+          isfree = ((uint16_t)fat_getcluster(fs, cluster) == 0);
+          if (isfree)
+            {
+              nfreeclusters++;
+            }
+
+#ifdef CONFIG_FAT_FREEBITMAP
+          if (fs->fs_freemap)
+            {
+              fat_freemapset(fs, cluster, isfree);
+            }
+#endif
+        }
+    }
+  else
+    {
+      off_t        fatsector;
+      unsigned int offset;
+      int          ret;
+
+      fatsector    = fs->fs_fatbase;
+      offset       = fs->fs_hwsectorsize;
+
+      /* Examine each cluster in the fat */
+
+      for (cluster = 0; cluster < fs->fs_nclusters; cluster++)
+        {
+          /* If we are starting a new sector, then read the new sector in fs_buffer */
+
+          if (offset >= fs->fs_hwsectorsize)
+            {
+              ret = fat_fscacheread(fs, fatsector);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+
+              /* Reset the offset to the next FAT entry.
+               * Increment the sector number to read next time around.
+               */
+
+              offset = 0;
+              fatsector++;
+            }
+
+          /* FAT16 and FAT32 differ only on the size of each cluster start
+           * sector number in the FAT.
+           */
+
+          if (fs->fs_type == FSTYPE_FAT16)
+            {
+              isfree = (FAT_GETFAT16(fs->fs_buffer, offset) == 0);
+              offset += 2;
+            }
+          else
+            {
+              isfree = ((FAT_GETFAT32(fs->fs_buffer, offset) & 0x0fffffff) == 0);
+              offset += 4;
+            }
+
+          /* The first two entries of the FAT do not describe clusters */
+
+          if (cluster >= 2)
+            {
+              if (isfree)
+                {
+                  nfreeclusters++;
+                }
+
+#ifdef CONFIG_FAT_FREEBITMAP
+              if (fs->fs_freemap)
+                {
+                  fat_freemapset(fs, cluster, isfree);
+                }
+#endif
+            }
+        }
+    }
+
+#ifdef CONFIG_FAT_FREEBITMAP
+  fs->fs_freemapvalid = (fs->fs_freemap != NULL);
+#endif
+
+  if (fs->fs_fsifreecount != nfreeclusters)
+    {
+      fs->fs_fsifreecount = nfreeclusters;
+      if (fs->fs_type == FSTYPE_FAT32)
+        {
+          fs->fs_fsidirty = true;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_searchfat
+ *
+ * Desciption: Search the FAT for a free cluster following startcluster,
+ *   wrapping back to the beginning of the FAT if necessary.
+ *
+ * Return: <0:error, 0: no free cluster, >=2: free cluster number
+ *
+ ****************************************************************************/
+
+static int32_t fat_searchfat(struct fat_mountpt_s *fs, uint32_t startcluster)
+{
+  off_t    startsector;
+  uint32_t newcluster;
+
+#ifdef CONFIG_FAT_FREEBITMAP
+  /* Build the free cluster bitmap the first time that it is needed */
+
+  if (fs->fs_freemap && !fs->fs_freemapvalid)
+    {
+      int ret = fat_scanfat(fs);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  if (fs->fs_freemapvalid)
+    {
+      newcluster = fat_freemapsearch(fs, startcluster + 1, fs->fs_nclusters);
+      if (newcluster == 0)
+        {
+          newcluster = fat_freemapsearch(fs, 2, startcluster + 1);
+        }
+
+      return newcluster;
+    }
+#endif
+
+  /* Loop until (1) we discover that there are not free clusters
+   * (return 0), an errors occurs (return -errno), or (3) we find
+   * the next cluster (return the new cluster number).
+   */
+
+  newcluster = startcluster;
+  for (;;)
+    {
+      /* Examine the next cluster in the FAT */
+
+      newcluster++;
+      if (newcluster >= fs->fs_nclusters)
+        {
+          /* If we hit the end of the available clusters, then
+           * wrap back to the beginning because we might have
+           * started at a non-optimal place.  But don't continue
+           * past the start cluster.
+           */
+
+          newcluster = 2;
+          if (newcluster > startcluster)
+            {
+              /* We are back past the starting cluster, then there
+               * is no free cluster.
+               */
+
+              return 0;
+            }
+        }
+
+      /* We have a candidate cluster.  Check if the cluster number is
+       * mapped to a group of sectors.
+       */
+
+      startsector = fat_getcluster(fs, newcluster);
+      if (startsector == 0)
+        {
+          /* Found have found a free cluster */
+
+          return newcluster;
+        }
+      else if (startsector < 0)
+        {
+          /* Some error occurred, return the error number */
+
+          return startsector;
+        }
+
+      /* We wrap all the back to the starting cluster?  If so, then
+       * there are no free clusters.
+       */
+
+      if (newcluster == startcluster)
+        {
+          return 0;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: fat_addcluster
+ *
+ * Desciption: Find a free cluster following startcluster and add it to the
+ *   end of the chain that ends with 'cluster' (if cluster is non-zero).
+ *
+ * Return: <0:error, 0: no free cluster, >=2: new cluster number
+ *
+ ****************************************************************************/
+
+static int32_t fat_addcluster(struct fat_mountpt_s *fs, uint32_t cluster,
+                              uint32_t startcluster)
+{
+  uint32_t newcluster;
+  int32_t  ret;
+
+  /* Find a free cluster */
+
+  ret = fat_searchfat(fs, startcluster);
+  if (ret <= 0)
+    {
+      /* An error occurred or there is no free cluster */
+
+      return ret;
+    }
+
+  newcluster = (uint32_t)ret;
+
+  /* Now mark that cluster as in-use. */
+
+  ret = fat_putcluster(fs, newcluster, 0x0fffffff);
+  if (ret < 0)
+    {
+      /* An error occurred */
+
+      return ret;
+    }
+
+  /* And link if to the start cluster (if any)*/
+
+  if (cluster)
+    {
+      /* There is a start cluster -- link it */
+
+      ret = fat_putcluster(fs, cluster, newcluster);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  /* And update the FINSINFO for the next time we have to search */
+
+  fs->fs_fsinextfree = newcluster;
+  if (fs->fs_fsifreecount != 0xffffffff)
+    {
+      fs->fs_fsifreecount--;
+      fs->fs_fsidirty = 1;
+    }
+
+  /* Return then number of the new cluster that was added to the chain */
+
+  return newcluster;
+}
+
 /****************************************************************************
  * Name: fat_checkfsinfo
  *
@@ -513,6 +1015,7 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   FAR struct inode *inode;
   struct geometry geo;
   int ret;
+  int i;
 
   /* Assume that the mount is successful */
 
@@ -541,15 +1044,33 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   fs->fs_hwsectorsize = geo.geo_sectorsize;
   fs->fs_hwnsectors   = geo.geo_nsectors;
 
-  /* Allocate a buffer to hold one hardware sector */
+  /* Allocate the sector cache.  One block of memory holds all of the
+   * cached sectors.
+   */
 
-  fs->fs_buffer = (uint8_t*)fat_io_alloc(fs->fs_hwsectorsize);
+  fs->fs_buffer = (uint8_t*)fat_io_alloc(fs->fs_hwsectorsize * CONFIG_FAT_CACHESECTORS);
   if (!fs->fs_buffer)
     {
       ret = -ENOMEM;
       goto errout;
     }
 
+  for (i = 0; i < CONFIG_FAT_CACHESECTORS; i++)
+    {
+      fs->fs_cache[i].fc_sector  = -1;
+      fs->fs_cache[i].fc_lastuse = 0;
+      fs->fs_cache[i].fc_dirty   = false;
+      fs->fs_cache[i].fc_buffer  = fs->fs_buffer + i * fs->fs_hwsectorsize;
+    }
+
+  /* fs_buffer is used below to read the boot record, but it does not hold
+   * any cached sector yet.
+   */
+
+  fs->fs_cacheindex    = 0;
+  fs->fs_currentsector = -1;
+  fs->fs_dirty         = false;
+
   /* Search FAT boot record on the drive.  First check at sector zero.  This
    * could be either the boot record or a partition that refers to the boot
    * record.
@@ -574,7 +1095,6 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
        * indexed by 16x the partition number.
        */
 
-       int i;
        for (i = 0; i < 4; i++)
          {
            /* Check if the partition exists and, if so, get the bootsector for that
@@ -647,6 +1167,16 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
       }
   }
 
+#ifdef CONFIG_FAT_FREEBITMAP
+  /* Allocate the free cluster bitmap.  It is built when it is first
+   * needed.  Without it, the FAT is searched instead.
+   */
+
+  fs->fs_freemapvalid = false;
+  fs->fs_freemap = (uint32_t *)kzalloc(((fs->fs_nclusters + 31) >> 5) *
+                                       sizeof(uint32_t));
+#endif
+
   /* We did it! */
 
   fdbg("FAT%d:\n", fs->fs_type == 0 ? 12 : fs->fs_type == 1  ? 16 : 32);
@@ -669,8 +1199,7 @@ int fat_mount(struct fat_mountpt_s *fs, bool writeable)
   return OK;
 
  errout_with_buffer:
-  fat_io_free(fs->fs_buffer, fs->fs_hwsectorsize);
-  fs->fs_buffer = 0;
+  fat_fscachefree(fs);
 
  errout:
   fs->fs_mounted = false;
@@ -1087,6 +1616,15 @@ int fat_putcluster(struct fat_mountpt_s *fs, uint32_t clusterno, off_t nextclust
       /* Mark the modified sector as "dirty" and return success */
 
       fs->fs_dirty = true;
+
+#ifdef CONFIG_FAT_FREEBITMAP
+      /* Keep the free cluster bitmap in agreement with the FAT */
+
+      if (fs->fs_freemapvalid && clusterno >= 2)
+        {
+          fat_freemapset(fs, clusterno, nextcluster == 0);
+        }
+#endif
       return OK;
     }
 
@@ -1126,6 +1664,10 @@ int fat_removechain(struct fat_mountpt_s *fs, uint32_t cluster)
           return ret;
         }
 
+      /* Forget any cached sectors of the cluster (e.g., of a directory) */
+
+      fat_fscachediscard(fs, cluster);
+
       /* Update FSINFINFO data */
 
       if (fs->fs_fsifreecount != 0xffffffff)
@@ -1155,9 +1697,7 @@ int fat_removechain(struct fat_mountpt_s *fs, uint32_t cluster)
 int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
 {
   off_t    startsector;
-  uint32_t newcluster;
   uint32_t startcluster;
-  int      ret;
 
   /* The special value 0 is used when the new chain should start */
 
@@ -1205,101 +1745,73 @@ int32_t fat_extendchain(struct fat_mountpt_s *fs, uint32_t cluster)
       startcluster = cluster;
     }
 
-  /* Loop until (1) we discover that there are not free clusters
-   * (return 0), an errors occurs (return -errno), or (3) we find
-   * the next cluster (return the new cluster number).
-   */
-
-  newcluster = startcluster;
-  for (;;)
-    {
-      /* Examine the next cluster in the FAT */
-
-      newcluster++;
-      if (newcluster >= fs->fs_nclusters)
-        {
-          /* If we hit the end of the available clusters, then
-           * wrap back to the beginning because we might have
-           * started at a non-optimal place.  But don't continue
-           * past the start cluster.
-           */
-
-          newcluster = 2;
-          if (newcluster > startcluster)
-            {
-              /* We are back past the starting cluster, then there
-               * is no free cluster.
-               */
-
-              return 0;
-            }
-        }
+  /* Find a free cluster and add it to the chain */
 
-      /* We have a candidate cluster.  Check if the cluster number is
-       * mapped to a group of sectors.
-       */
-
-      startsector = fat_getcluster(fs, newcluster);
-      if (startsector == 0)
-        {
-          /* Found have found a free cluster break out */
+  return fat_addcluster(fs, cluster, startcluster);
+}
 
-          break;
-        }
-      else if (startsector < 0)
-        {
-          /* Some error occurred, return the error number */
+/****************************************************************************
+ * Name: fat_reservechain
+ *
+ * Desciption: Add up to nclusters new clusters to the end of the chain that
+ *   ends with 'cluster'.  The new clusters are contiguous if there is a
+ *   long enough run of free clusters after 'cluster' or, if the free cluster
+ *   bitmap is available, anywhere on the volume.
+ *
+ * Return: <0:error, >=0: the number of clusters added
+ *
+ ****************************************************************************/
 
-          return startsector;
-        }
+int32_t fat_reservechain(struct fat_mountpt_s *fs, uint32_t cluster,
+                         uint32_t nclusters)
+{
+  uint32_t startcluster = cluster;
+  int32_t  newcluster;
+  int32_t  nadded;
 
-      /* We wrap all the back to the starting cluster?  If so, then
-       * there are no free clusters.
-       */
+#ifdef CONFIG_FAT_FREEBITMAP
+  /* Look for a long enough run of free clusters */
 
-      if (newcluster == startcluster)
+  if (fs->fs_freemap && !fs->fs_freemapvalid)
+    {
+      int ret = fat_scanfat(fs);
+      if (ret < 0)
         {
-          return 0;
+          return ret;
         }
     }
 
-  /* We get here only if we break out with an available cluster
-   * number in 'newcluster'  Now mark that cluster as in-use.
-   */
-
-  ret = fat_putcluster(fs, newcluster, 0x0fffffff);
-  if (ret < 0)
+  if (fs->fs_freemapvalid)
     {
-      /* An error occurred */
-
-      return ret;
+      newcluster = fat_freemaprun(fs, cluster + 1, nclusters);
+      if (newcluster >= 2)
+        {
+          startcluster = newcluster - 1;
+        }
     }
+#endif
 
-  /* And link if to the start cluster (if any)*/
+  /* Add the clusters one at a time, each following the previous one */
 
-  if (cluster)
+  for (nadded = 0; nadded < nclusters; nadded++)
     {
-      /* There is a start cluster -- link it */
-
-      ret = fat_putcluster(fs, cluster, newcluster);
-      if (ret < 0)
+      newcluster = fat_addcluster(fs, cluster, startcluster);
+      if (newcluster < 0)
         {
-          return ret;
+          return newcluster;
         }
-    }
+      else if (newcluster == 0)
+        {
+          /* The volume is full */
 
-  /* And update the FINSINFO for the next time we have to search */
+          break;
+        }
 
-  fs->fs_fsinextfree = newcluster;
-  if (fs->fs_fsifreecount != 0xffffffff)
-    {
-      fs->fs_fsifreecount--;
-      fs->fs_fsidirty = 1;
+      cluster      = newcluster;
+      startcluster = newcluster;
     }
 
-  /* Return then number of the new cluster that was added to the chain */
-
-  return newcluster;
+  return nadded;
 }
 
 /****************************************************************************
@@ -1464,97 +1976,168 @@ int  fat_dirtruncate(struct fat_mountpt_s *fs, struct fat_dirinfo_s *dirinfo)
 /****************************************************************************
  * Name: fat_fscacheflush
  *
- * Desciption: Flush any dirty sector if fs_buffer as necessary
+ * Desciption: Write all dirty sectors in the sector cache to the device
  *
  ****************************************************************************/
 
 int fat_fscacheflush(struct fat_mountpt_s *fs)
 {
   int ret;
+  int i;
 
-  /* Check if the fs_buffer is dirty.  In this case, we will write back the
-   * contents of fs_buffer.
-   */
-
-  if (fs->fs_dirty)
-    {
-      /* Write the dirty sector */
+  /* Make sure that the cache entry of fs_buffer is up to date */
 
-      ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
-      if (ret < 0)
-        {
-          return ret;
-        }
+  fat_fscachesync(fs);
 
-      /* Does the sector lie in the FAT region? */
+  /* Then write back each dirty sector */
 
-      if (fs->fs_currentsector >= fs->fs_fatbase &&
-          fs->fs_currentsector < fs->fs_fatbase + fs->fs_nfatsects)
+  for (i = 0; i < CONFIG_FAT_CACHESECTORS; i++)
+    {
+      if (fs->fs_cache[i].fc_dirty && fs->fs_cache[i].fc_sector >= 0)
         {
-          /* Yes, then make the change in the FAT copy as well */
-          int i;
-
-          for (i = fs->fs_fatnumfats; i >= 2; i--)
+          ret = fat_fscachewrite(fs, &fs->fs_cache[i]);
+          if (ret < 0)
             {
-              fs->fs_currentsector += fs->fs_nfatsects;
-              ret = fat_hwwrite(fs, fs->fs_buffer, fs->fs_currentsector, 1);
-              if (ret < 0)
-                {
-                  return ret;
-                }
+              return ret;
             }
         }
+    }
 
-      /* No longer dirty */
+  /* fs_buffer is no longer dirty */
 
-      fs->fs_dirty = false;
-    }
+  fs->fs_dirty = false;
   return OK;
 }
 
 /****************************************************************************
  * Name: fat_fscacheread
  *
- * Desciption: Read the specified sector into the sector cache, flushing any
- *   existing dirty sectors as necessary.
+ * Desciption: Make the specified sector available in fs_buffer.  If it is
+ *   not already in the sector cache, the least recently used sector is
+ *   replaced (and written back first if it is dirty).
  *
  ****************************************************************************/
 
 int fat_fscacheread(struct fat_mountpt_s *fs, off_t sector)
 {
+  struct fat_cache_s *entry;
+  uint32_t oldest;
+  uint32_t age;
+  int ndx;
   int ret;
+  int i;
 
   /* fs->fs_currentsector holds the current sector that is buffered in
    * fs->fs_buffer. If the requested sector is the same as this sector, then
-   * we do nothing. Otherwise, we will have to read the new sector.
+   * we do nothing. Otherwise, we will have to find or read the new sector.
    */
 
-    if (fs->fs_currentsector != sector)
-      {
-        /* We will need to read the new sector.  First, flush the cached
-         * sector if it is dirty.
-         */
+  if (fs->fs_currentsector != sector)
+    {
+      /* Save the state of the current sector and look for the requested
+       * sector in the cache.  If it is not there, pick an unused entry or
+       * else the least recently used one.
+       */
+
+      fat_fscachesync(fs);
+
+      ndx    = 0;
+      oldest = 0;
+      for (i = 0; i < CONFIG_FAT_CACHESECTORS; i++)
+        {
+          entry = &fs->fs_cache[i];
+          if (entry->fc_sector == sector)
+            {
+              ndx = i;
+              break;
+            }
+
+          age = entry->fc_sector < 0 ? UINT32_MAX :
+                fs->fs_usecount - entry->fc_lastuse;
+          if (age >= oldest)
+            {
+              oldest = age;
+              ndx    = i;
+            }
+        }
+
+      entry = &fs->fs_cache[ndx];
+      if (entry->fc_sector != sector)
+        {
+          /* A miss.  First, write back the replaced sector if it is dirty */
+
+          if (entry->fc_dirty && entry->fc_sector >= 0)
+            {
+              ret = fat_fscachewrite(fs, entry);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+
+          /* Then read the specified sector into the cache */
+
+          ret = fat_hwread(fs, entry->fc_buffer, sector, 1);
+          if (ret < 0)
+            {
+              /* The entry no longer holds any valid sector */
+
+              entry->fc_sector = -1;
+              entry->fc_dirty  = false;
+              if (ndx == fs->fs_cacheindex)
+                {
+                  fs->fs_currentsector = -1;
+                  fs->fs_dirty         = false;
+                }
 
-        ret = fat_fscacheflush(fs);
-        if (ret < 0)
-          {
               return ret;
-          }
+            }
+
+          entry->fc_sector = sector;
+          entry->fc_dirty  = false;
+        }
 
-        /* Then read the specified sector into the cache */
+      /* Make this the sector in fs_buffer */
+
+      fs->fs_cacheindex    = ndx;
+      fs->fs_buffer        = entry->fc_buffer;
+      fs->fs_currentsector = sector;
+      fs->fs_dirty         = entry->fc_dirty;
+    }
+
+  fs->fs_cache[fs->fs_cacheindex].fc_lastuse = ++fs->fs_usecount;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: fat_fscachefree
+ *
+ * Desciption: Free the memory used by the sector cache (and by the free
+ *   cluster bitmap) when the volume is unmounted.  Dirty sectors are not
+ *   written;  fat_updatefsinfo() must be called first if necessary.
+ *
+ ****************************************************************************/
 
-        ret = fat_hwread(fs, fs->fs_buffer, sector, 1);
-        if (ret < 0)
-          {
-            return ret;
-          }
+void fat_fscachefree(struct fat_mountpt_s *fs)
+{
+  if (fs->fs_cache[0].fc_buffer)
+    {
+      fat_io_free(fs->fs_cache[0].fc_buffer,
+                  fs->fs_hwsectorsize * CONFIG_FAT_CACHESECTORS);
+    }
 
-        /* Update the cached sector number */
+  fs->fs_cache[0].fc_buffer = NULL;
+  fs->fs_buffer             = NULL;
 
-        fs->fs_currentsector = sector;
+#ifdef CONFIG_FAT_FREEBITMAP
+  if (fs->fs_freemap)
+    {
+      kfree(fs->fs_freemap);
     }
 
-    return OK;
+  fs->fs_freemap      = NULL;
+  fs->fs_freemapvalid = false;
+#endif
 }
 
 /****************************************************************************
@@ -1727,100 +2310,23 @@ int fat_updatefsinfo(struct fat_mountpt_s *fs)
 
 int fat_nfreeclusters(struct fat_mountpt_s *fs, off_t *pfreeclusters)
 {
-  uint32_t nfreeclusters;
+  int ret;
 
   /* If number of the first free cluster is valid, then just return that value. */
 
-  if (fs->fs_fsifreecount <= fs->fs_nclusters - 2)
-    {
-      *pfreeclusters = fs->fs_fsifreecount;
-      return OK;
-    }
-
-  /* Otherwise, we will have to count the number of free clusters */
-
-  nfreeclusters = 0;
-  if (fs->fs_type == FSTYPE_FAT12)
-    {
-      off_t sector;
-
-      /* Examine every cluster in the fat */
-
-      for (sector = 2; sector < fs->fs_nclusters; sector++)
-        {
-
-          /* If the cluster is unassigned, then increment the count of free clusters */
-
-          if ((uint16_t)fat_getcluster(fs, sector) == 0)
-            {
-              nfreeclusters++;
-            }
-        }
-    }
-  else
+  if (fs->fs_fsifreecount > fs->fs_nclusters - 2)
     {
-      unsigned int cluster;
-      off_t        fatsector;
-      unsigned int offset;
-      int          ret;
-
-      fatsector    = fs->fs_fatbase;
-      offset       = fs->fs_hwsectorsize;
+      /* Otherwise, we will have to count the number of free clusters */
 
-      /* Examine each cluster in the fat */
-
-      for (cluster = fs->fs_nclusters; cluster > 0; cluster--)
+      ret = fat_scanfat(fs);
+      if (ret < 0)
         {
-          /* If we are starting a new sector, then read the new sector in fs_buffer */
-
-          if (offset >= fs->fs_hwsectorsize)
-            {
-              ret = fat_fscacheread(fs, fatsector++);
-              if (ret < 0)
-                {
-                  return ret;
-                }
-
-              /* Reset the offset to the next FAT entry.
-               * Increment the sector number to read next time around.
-               */
-
-              offset = 0;
-              fatsector++;
-            }
-
-          /* FAT16 and FAT32 differ only on the size of each cluster start
-           * sector number in the FAT.
-           */
-
-          if (fs->fs_type == FSTYPE_FAT16)
-            {
-              if (FAT_GETFAT16(fs->fs_buffer, offset) == 0)
-                {
-                  nfreeclusters++;
-                }
-              offset += 2;
-            }
-          else
-            {
-              if (FAT_GETFAT32(fs->fs_buffer, offset) == 0)
-                {
-                  nfreeclusters++;
-                }
-
-              offset += 4;
-            }
+          return ret;
         }
     }
 
-    fs->fs_fsifreecount = nfreeclusters;
-    if (fs->fs_type == FSTYPE_FAT32)
-      {
-        fs->fs_fsidirty = true;
-      }
-
-    *pfreeclusters = nfreeclusters;
-    return OK;
+  *pfreeclusters = fs->fs_fsifreecount;
+  return OK;
 }
 
 /****************************************************************************
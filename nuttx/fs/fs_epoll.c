@@ -0,0 +1,856 @@
+/****************************************************************************
+ * fs/fs_epoll.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <queue.h>
+#include <semaphore.h>
+#include <wdog.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/clock.h>
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+#  include <nuttx/net/net.h>
+#endif
+
+#include "fs_internal.h"
+
+#ifndef CONFIG_DISABLE_POLL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define epoll_semgive(sem) sem_post(sem)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One descriptor in an interest set.  The pollfd stays set up with the
+ * descriptor's driver from EPOLL_CTL_ADD until EPOLL_CTL_DEL or until the
+ * descriptor is closed.  The driver reports events by setting pfd.revents
+ * and posting the set's waitsem, just as it does for poll().
+ *
+ * The item refers to the struct file or struct socket behind the descriptor
+ * rather than to the descriptor number, so that it is always torn down with
+ * the driver that it was set up with.  epoll_release() removes the item
+ * before that structure is closed.
+ */
+
+struct epoll_item_s
+{
+  dq_entry_t        node;      /* Link in the interest list (must be first) */
+  FAR void         *handle;    /* The struct file or struct socket */
+  bool              socket;    /* handle is a struct socket */
+  struct pollfd     pfd;       /* Set up with the driver */
+  epoll_data_t      data;      /* Returned with the reported events */
+  uint32_t          events;    /* Events and mode flags from epoll_ctl() */
+  bool              armed;     /* pfd is set up with the driver */
+  bool              rearm;     /* Set pfd up again before the next check */
+};
+
+/* An interest set.  This is the private data of the set's inode. */
+
+struct epoll_set_s
+{
+  dq_entry_t        node;      /* Link in g_epoll_sets (must be first) */
+  sem_t             exclsem;   /* Serializes access to the set */
+  sem_t             waitsem;   /* Posted by the drivers and by the timer */
+  WDOG_ID           wdog;      /* Timer for the epoll_wait() timeout */
+  volatile bool     timedout;  /* The epoll_wait() timeout expired */
+  dq_queue_t        items;     /* The interest list */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int epoll_close(FAR struct file *filep);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* All interest sets, so that a closed descriptor can be removed from each
+ * of them.  g_epoll_sem is taken before the exclsem of any set.
+ */
+
+static dq_queue_t g_epoll_sets;
+static sem_t      g_epoll_sem = SEM_INITIALIZER(1);
+
+/* The interest set descriptor supports only close() */
+
+static const struct file_operations g_epoll_ops =
+{
+  0,             /* open */
+  epoll_close,   /* close */
+  0,             /* read */
+  0,             /* write */
+  0,             /* seek */
+  0              /* ioctl */
+#ifndef CONFIG_DISABLE_POLL
+  , 0            /* poll */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_semtake
+ ****************************************************************************/
+
+static void epoll_semtake(FAR sem_t *sem)
+{
+  /* Take the semaphore (perhaps waiting) */
+
+  while (sem_wait(sem) != 0)
+    {
+      /* The only case that an error should occur here is if
+       * the wait was awakened by a signal.
+       */
+
+      ASSERT(get_errno() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_timeout
+ *
+ * Description:
+ *   The wdog expired before any events were received.
+ *
+ ****************************************************************************/
+
+static void epoll_timeout(int argc, uint32_t iset, ...)
+{
+  FAR struct epoll_set_s *set = (FAR struct epoll_set_s *)iset;
+
+  set->timedout = true;
+  epoll_semgive(&set->waitsem);
+}
+
+/****************************************************************************
+ * Name: epoll_getset
+ *
+ * Description:
+ *   Return the interest set that the descriptor 'epfd' refers to.
+ *
+ ****************************************************************************/
+
+static int epoll_getset(int epfd, FAR struct epoll_set_s **set)
+{
+  FAR struct filelist *list;
+  FAR struct inode *inode;
+
+  if ((unsigned int)epfd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return -EBADF;
+    }
+
+  list = sched_getfiles();
+  if (!list)
+    {
+      return -EMFILE;
+    }
+
+  inode = list->fl_files[epfd].f_inode;
+  if (!inode)
+    {
+      return -EBADF;
+    }
+
+  if (inode->u.i_ops != &g_epoll_ops)
+    {
+      return -EINVAL;
+    }
+
+  *set = (FAR struct epoll_set_s *)inode->i_private;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_gethandle
+ *
+ * Description:
+ *   Return the struct file or struct socket that the descriptor 'fd'
+ *   refers to.
+ *
+ ****************************************************************************/
+
+static int epoll_gethandle(int fd, FAR void **handle, FAR bool *socket)
+{
+  FAR struct filelist *list;
+
+  if ((unsigned int)fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+      FAR struct socket *psock = sockfd_socket(fd);
+
+      if (psock && psock->s_crefs > 0)
+        {
+          *handle = psock;
+          *socket = true;
+          return OK;
+        }
+#endif
+
+      return -EBADF;
+    }
+
+  list = sched_getfiles();
+  if (!list)
+    {
+      return -EMFILE;
+    }
+
+  if (!list->fl_files[fd].f_inode)
+    {
+      return -EBADF;
+    }
+
+  *handle = &list->fl_files[fd];
+  *socket = false;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_find
+ ****************************************************************************/
+
+static FAR struct epoll_item_s *epoll_find(FAR struct epoll_set_s *set,
+                                           FAR void *handle)
+{
+  FAR struct epoll_item_s *item;
+
+  for (item = (FAR struct epoll_item_s *)set->items.head;
+       item;
+       item = (FAR struct epoll_item_s *)item->node.flink)
+    {
+      if (item->handle == handle)
+        {
+          return item;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: epoll_poll
+ *
+ * Description:
+ *   Set up or tear down the pollfd of an item with the driver of its file
+ *   or socket.
+ *
+ ****************************************************************************/
+
+static int epoll_poll(FAR struct epoll_item_s *item, bool setup)
+{
+  FAR struct file *filep;
+  FAR struct inode *inode;
+
+#if defined(CONFIG_NET) && CONFIG_NSOCKET_DESCRIPTORS > 0
+  if (item->socket)
+    {
+      return psock_poll((FAR struct socket *)item->handle, &item->pfd, setup);
+    }
+#endif
+
+  filep = (FAR struct file *)item->handle;
+  inode = filep->f_inode;
+
+  if (inode && inode->u.i_ops && inode->u.i_ops->poll)
+    {
+      return (int)inode->u.i_ops->poll(filep, &item->pfd, setup);
+    }
+
+  return -ENOSYS;
+}
+
+/****************************************************************************
+ * Name: epoll_arm
+ *
+ * Description:
+ *   Set up the descriptor with its driver.  The driver reports any event
+ *   that is already pending right away.
+ *
+ ****************************************************************************/
+
+static int epoll_arm(FAR struct epoll_set_s *set,
+                     FAR struct epoll_item_s *item)
+{
+  int ret;
+
+  /* Errors and hang-ups are always reported */
+
+  item->pfd.sem     = &set->waitsem;
+  item->pfd.events  = (pollevent_t)item->events | POLLERR | POLLHUP;
+  item->pfd.revents = 0;
+  item->pfd.priv    = NULL;
+  item->rearm       = false;
+
+  ret = epoll_poll(item, true);
+  item->armed = (ret >= 0);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: epoll_disarm
+ ****************************************************************************/
+
+static void epoll_disarm(FAR struct epoll_item_s *item)
+{
+  if (item->armed)
+    {
+      (void)epoll_poll(item, false);
+      item->armed = false;
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_check
+ *
+ * Description:
+ *   Collect up to 'maxevents' descriptors with events.  The revents fields
+ *   are checked without calling the drivers.  Only a descriptor that was
+ *   reported in level-triggered mode is set up again, so that its driver
+ *   reports it again if it is still ready.  Reported descriptors are moved
+ *   to the end of the interest list so that all ready descriptors are
+ *   reported in turn when there are more than 'maxevents' of them.
+ *
+ ****************************************************************************/
+
+static int epoll_check(FAR struct epoll_set_s *set,
+                       FAR struct epoll_event *events, int maxevents)
+{
+  FAR struct epoll_item_s *item;
+  FAR struct epoll_item_s *next;
+  dq_queue_t reported;
+  pollevent_t revents;
+  irqstate_t flags;
+  int nevents = 0;
+
+  dq_init(&reported);
+  for (item = (FAR struct epoll_item_s *)set->items.head;
+       item && nevents < maxevents;
+       item = next)
+    {
+      next = (FAR struct epoll_item_s *)item->node.flink;
+
+      if (item->rearm)
+        {
+          epoll_disarm(item);
+          (void)epoll_arm(set, item);
+        }
+
+      if (!item->armed)
+        {
+          continue;
+        }
+
+      /* The revents field may be set from an interrupt handler */
+
+      flags = irqsave();
+      revents = item->pfd.revents;
+      item->pfd.revents = 0;
+      irqrestore(flags);
+
+      if (revents == 0)
+        {
+          continue;
+        }
+
+      events[nevents].events = revents;
+      events[nevents].data   = item->data;
+      nevents++;
+
+      if ((item->events & EPOLLONESHOT) != 0)
+        {
+          epoll_disarm(item);
+        }
+      else if ((item->events & EPOLLET) == 0)
+        {
+          item->rearm = true;
+        }
+
+      dq_rem(&item->node, &set->items);
+      dq_addlast(&item->node, &reported);
+    }
+
+  while ((item = (FAR struct epoll_item_s *)dq_remfirst(&reported)) != NULL)
+    {
+      dq_addlast(&item->node, &set->items);
+    }
+
+  return nevents;
+}
+
+/****************************************************************************
+ * Name: epoll_close
+ *
+ * Description:
+ *   Destroy the interest set when its last descriptor is closed.
+ *
+ ****************************************************************************/
+
+static int epoll_close(FAR struct file *filep)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR struct epoll_set_s *set = (FAR struct epoll_set_s *)inode->i_private;
+  FAR struct epoll_item_s *item;
+
+  /* Is this the last reference to the set (the inode is released after
+   * this returns)?
+   */
+
+  if (inode->i_crefs > 1)
+    {
+      return OK;
+    }
+
+  epoll_semtake(&g_epoll_sem);
+  dq_rem(&set->node, &g_epoll_sets);
+  epoll_semgive(&g_epoll_sem);
+
+  while ((item = (FAR struct epoll_item_s *)dq_remfirst(&set->items)) != NULL)
+    {
+      epoll_disarm(item);
+      kfree(item);
+    }
+
+  wd_delete(set->wdog);
+  sem_destroy(&set->waitsem);
+  sem_destroy(&set->exclsem);
+  kfree(set);
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_create
+ *
+ * Description:
+ *   Create an epoll interest set.  The set is represented by an inode that
+ *   is not in the pseudo-file system; it is freed when its last descriptor
+ *   is closed.
+ *
+ * Inputs:
+ *   size - Ignored, but must be greater than zero
+ *
+ * Return:
+ *   A file descriptor that refers to the set.  On error, -1 is returned,
+ *   and errno is set appropriately:
+ *
+ *   EINVAL - size is not positive
+ *   EMFILE - There is no free file descriptor
+ *   ENOMEM - There is not enough memory for the set
+ *
+ ****************************************************************************/
+
+int epoll_create(int size)
+{
+  FAR struct epoll_set_s *set;
+  FAR struct inode *inode;
+  int err;
+  int fd;
+
+  if (size <= 0)
+    {
+      err = EINVAL;
+      goto errout;
+    }
+
+  set = (FAR struct epoll_set_s *)kzalloc(sizeof(struct epoll_set_s));
+  if (!set)
+    {
+      err = ENOMEM;
+      goto errout;
+    }
+
+  set->wdog = wd_create();
+  if (!set->wdog)
+    {
+      err = ENOMEM;
+      goto errout_with_set;
+    }
+
+  inode = (FAR struct inode *)kzalloc(sizeof(struct inode));
+  if (!inode)
+    {
+      err = ENOMEM;
+      goto errout_with_wdog;
+    }
+
+  sem_init(&set->exclsem, 0, 1);
+  sem_init(&set->waitsem, 0, 0);
+  dq_init(&set->items);
+
+  /* The inode is marked deleted so that inode_release() frees it when the
+   * last descriptor is closed.
+   */
+
+  inode->i_crefs    = 1;
+  inode->i_flags    = FSNODEFLAG_DELETED;
+  inode->u.i_ops    = &g_epoll_ops;
+  inode->i_private  = set;
+
+  fd = files_allocate(inode, O_RDWR, 0, 0);
+  if (fd < 0)
+    {
+      err = EMFILE;
+      goto errout_with_inode;
+    }
+
+  epoll_semtake(&g_epoll_sem);
+  dq_addlast(&set->node, &g_epoll_sets);
+  epoll_semgive(&g_epoll_sem);
+  return fd;
+
+errout_with_inode:
+  sem_destroy(&set->waitsem);
+  sem_destroy(&set->exclsem);
+  kfree(inode);
+errout_with_wdog:
+  wd_delete(set->wdog);
+errout_with_set:
+  kfree(set);
+errout:
+  set_errno(err);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: epoll_ctl
+ *
+ * Description:
+ *   Add a descriptor to an interest set, change its events, or remove it.
+ *   The descriptor is set up with its driver when it is added and torn
+ *   down when it is removed.  A descriptor is also removed from every set
+ *   when it is closed.
+ *
+ * Inputs:
+ *   epfd - The interest set descriptor returned by epoll_create()
+ *   op - EPOLL_CTL_ADD, EPOLL_CTL_MOD, or EPOLL_CTL_DEL
+ *   fd - The file or socket descriptor
+ *   ev - The events to wait for (EPOLLIN, EPOLLOUT), optionally with
+ *     EPOLLET or EPOLLONESHOT, and the data to return with them.  Not
+ *     used for EPOLL_CTL_DEL.
+ *
+ * Return:
+ *   Zero on success.  On error, -1 is returned, and errno is set
+ *   appropriately:
+ *
+ *   EBADF - epfd or fd is not a valid descriptor
+ *   EEXIST - EPOLL_CTL_ADD and fd is already in the set
+ *   EINVAL - epfd is not an interest set, fd is epfd, or op is invalid
+ *   ENOENT - EPOLL_CTL_MOD or EPOLL_CTL_DEL and fd is not in the set
+ *   ENOMEM - There is not enough memory for the descriptor
+ *   ENOSYS - The driver of fd does not support the poll method
+ *
+ ****************************************************************************/
+
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
+{
+  FAR struct epoll_set_s *set;
+  FAR struct epoll_item_s *item;
+  FAR void *handle;
+  bool socket;
+  int ret;
+
+  ret = epoll_getset(epfd, &set);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  if (fd == epfd || (op != EPOLL_CTL_DEL && !ev))
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  ret = epoll_gethandle(fd, &handle, &socket);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  epoll_semtake(&set->exclsem);
+  item = epoll_find(set, handle);
+
+  switch (op)
+    {
+      case EPOLL_CTL_ADD:
+        {
+          if (item)
+            {
+              ret = -EEXIST;
+              break;
+            }
+
+          item = (FAR struct epoll_item_s *)
+            kzalloc(sizeof(struct epoll_item_s));
+          if (!item)
+            {
+              ret = -ENOMEM;
+              break;
+            }
+
+          item->handle = handle;
+          item->socket = socket;
+          item->pfd.fd = fd;
+          item->events = ev->events;
+          item->data   = ev->data;
+
+          ret = epoll_arm(set, item);
+          if (ret < 0)
+            {
+              kfree(item);
+              break;
+            }
+
+          dq_addlast(&item->node, &set->items);
+        }
+        break;
+
+      case EPOLL_CTL_MOD:
+        {
+          if (!item)
+            {
+              ret = -ENOENT;
+              break;
+            }
+
+          epoll_disarm(item);
+          item->events = ev->events;
+          item->data   = ev->data;
+          ret = epoll_arm(set, item);
+        }
+        break;
+
+      case EPOLL_CTL_DEL:
+        {
+          if (!item)
+            {
+              ret = -ENOENT;
+              break;
+            }
+
+          epoll_disarm(item);
+          dq_rem(&item->node, &set->items);
+          kfree(item);
+        }
+        break;
+
+      default:
+        ret = -EINVAL;
+        break;
+    }
+
+  epoll_semgive(&set->exclsem);
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  return OK;
+
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: epoll_release
+ *
+ * Description:
+ *   Remove a file or socket from every interest set.  This is called when
+ *   the file or socket is closed, before its driver is closed, so that no
+ *   driver is left holding a pollfd of a freed item and no item is torn
+ *   down through a descriptor number that now refers to something else.
+ *
+ * Inputs:
+ *   handle - The struct file or struct socket being closed
+ *
+ ****************************************************************************/
+
+void epoll_release(FAR void *handle)
+{
+  FAR struct epoll_set_s *set;
+  FAR struct epoll_item_s *item;
+
+  /* Most closes happen with no interest sets at all */
+
+  if (dq_peek(&g_epoll_sets) == NULL)
+    {
+      return;
+    }
+
+  epoll_semtake(&g_epoll_sem);
+  for (set = (FAR struct epoll_set_s *)g_epoll_sets.head;
+       set;
+       set = (FAR struct epoll_set_s *)set->node.flink)
+    {
+      epoll_semtake(&set->exclsem);
+      item = epoll_find(set, handle);
+      if (item)
+        {
+          epoll_disarm(item);
+          dq_rem(&item->node, &set->items);
+          kfree(item);
+        }
+
+      epoll_semgive(&set->exclsem);
+    }
+
+  epoll_semgive(&g_epoll_sem);
+}
+
+/****************************************************************************
+ * Name: epoll_wait
+ *
+ * Description:
+ *   Wait for events on the descriptors of an interest set.  Unlike poll(),
+ *   the descriptors are not set up and torn down on each call and no
+ *   watchdog timer is created; the drivers report events through the
+ *   pollfd structures that were set up by epoll_ctl().  Only a descriptor
+ *   that was reported in level-triggered mode is set up again, to learn
+ *   whether it is still ready.
+ *
+ *   Only one task should wait on an interest set at a time.
+ *
+ * Inputs:
+ *   epfd - The interest set descriptor returned by epoll_create()
+ *   events - Receives the events and data of the ready descriptors
+ *   maxevents - The maximum number of descriptors to return
+ *   timeout - Specifies an upper limit on the time for which epoll_wait()
+ *     will block in milliseconds.  A negative value of timeout means an
+ *     infinite timeout.
+ *
+ * Return:
+ *   On success, the number of ready descriptors returned in 'events'.  A
+ *   value of 0 indicates that the call timed out and no descriptors were
+ *   ready.  On error, -1 is returned, and errno is set appropriately:
+ *
+ *   EBADF - epfd is not a valid descriptor
+ *   EINVAL - epfd is not an interest set or maxevents is not positive
+ *
+ ****************************************************************************/
+
+int epoll_wait(int epfd, FAR struct epoll_event *events, int maxevents,
+               int timeout)
+{
+  FAR struct epoll_set_s *set;
+  int nevents;
+  int ret;
+
+  ret = epoll_getset(epfd, &set);
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  if (!events || maxevents <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  epoll_semtake(&set->exclsem);
+
+  if (timeout > 0)
+    {
+      /* Note that the millisecond timeout has to be converted to system
+       * clock ticks for wd_start
+       */
+
+      set->timedout = false;
+      wd_start(set->wdog, MSEC2TICK(timeout), epoll_timeout, 1,
+               (uint32_t)set);
+    }
+
+  for (;;)
+    {
+      /* Discard the posts that have already been seen.  Any event reported
+       * after this will either be found below or will post the semaphore
+       * again.
+       */
+
+      while (sem_trywait(&set->waitsem) == 0);
+
+      nevents = epoll_check(set, events, maxevents);
+      if (nevents > 0 || timeout == 0 || (timeout > 0 && set->timedout))
+        {
+          break;
+        }
+
+      /* Wait for a driver or the timer.  Let epoll_ctl() run meanwhile. */
+
+      epoll_semgive(&set->exclsem);
+      epoll_semtake(&set->waitsem);
+      epoll_semtake(&set->exclsem);
+    }
+
+  if (timeout > 0)
+    {
+      wd_cancel(set->wdog);
+    }
+
+  epoll_semgive(&set->exclsem);
+  return nevents;
+}
+
+#endif /* CONFIG_DISABLE_POLL */
@@ -115,6 +115,10 @@ static int _files_close(FAR struct file *filep)
 
   if (inode)
     {
+      /* Remove the file from any epoll interest sets */
+
+      epoll_release(filep);
+
       /* Close the file, driver, or mountpoint. */
 
       if (inode->u.i_ops && inode->u.i_ops->close)
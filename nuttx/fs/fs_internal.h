@@ -292,6 +292,20 @@ EXTERN int  files_close(int filedes);
 
 EXTERN void files_release(int filedes);
 
+/* fs_poll.c ****************************************************************/
+/****************************************************************************
+ * Name: poll_fdsetup
+ *
+ * Description:
+ *   Configure (or unconfigure) one file/socket descriptor for the poll
+ *   operation.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_DISABLE_POLL
+EXTERN int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup);
+#endif
+
 /* fs_findblockdriver.c *****************************************************/
 /****************************************************************************
  * Name: find_blockdriver
@@ -91,10 +91,13 @@ static void poll_semtake(FAR sem_t *sem)
  *   operation.  If fds and sem are non-null, then the poll is being setup.
  *   if fds and sem are NULL, then the poll is being torn down.
  *
+ *   This function is also used by epoll_ctl() and epoll_wait() (see
+ *   fs_epoll.c) to keep descriptors set up across calls.
+ *
  ****************************************************************************/
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
-static int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup)
+int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup)
 {
   FAR struct filelist *list;
   FAR struct file     *this_file;
@@ -52,6 +52,10 @@
 #include <nuttx/mtd.h>
 #include <nuttx/fs/nxffs.h>
 
+#ifdef CONFIG_NXFFS_BGPACK
+#  include <nuttx/wqueue.h>
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -132,7 +136,9 @@
  *    open flag is not supported.
  * 6. The re-packing process occurs only during a write when the free FLASH
  *    memory at the end of the FLASH is exhausted.  Thus, occasionally, file
- *    writing may take a long time.
+ *    writing may take a long time.  Packing may also be performed a few
+ *    erase blocks at a time with the FIOC_PACKSTEP ioctl or, with
+ *    CONFIG_NXFFS_BGPACK, on the low priority work queue.
  * 7. Another limitation is that there can be only a single NXFFS volume
  *    mounted at any time.  This has to do with the fact that we bind to
  *    an MTD driver (instead of a block driver) and bypass all of the normal
@@ -255,6 +261,19 @@ struct nxffs_blkentry_s
   uint16_t                  foffset;  /* Offset to start of data */
 };
 
+/* This structure describes one slot in the in-memory inode index.  The index
+ * is an open addressing hash table.  It only caches the FLASH location of
+ * inode headers; every candidate is verified against FLASH when it is used.
+ */
+
+#ifdef CONFIG_NXFFS_INDEX
+struct nxffs_ientry_s
+{
+  uint32_t                  hash;      /* Hash of the inode name (0: unused) */
+  off_t                     hoffset;   /* FLASH offset to the inode header */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -295,12 +314,23 @@ struct nxffs_volume_s
   uint16_t                  iooffset;  /* Next offset in read/write access (in ioblock) */
   off_t                     inoffset;  /* Offset to the first valid inode header */
   off_t                     froffset;  /* Offset to the first free byte */
+  off_t                     packoffset; /* Where the next packing step resumes */
   off_t                     nblocks;   /* Number of R/W blocks on volume */
   off_t                     ioblock;   /* Current block number being accessed */
   off_t                     cblock;    /* Starting block number in cache */
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#ifdef CONFIG_NXFFS_INDEX
+  bool                      ivalid;    /* True: The inode index is complete */
+  uint32_t                  icount;    /* Number of inodes in the index */
+  uint32_t                  isize;     /* Number of slots in the index */
+  FAR struct nxffs_ientry_s *index;    /* Hash table of valid inode headers */
+#endif
+#ifdef CONFIG_NXFFS_BGPACK
+  bool                      packpend;  /* True: Packing may free some FLASH */
+  struct work_s             packwork;  /* Schedules background packing steps */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -591,6 +621,32 @@ extern int nxffs_getc(FAR struct nxffs_volume_s *volume, uint16_t reserve);
 
 extern void nxffs_freeentry(FAR struct nxffs_entry_s *entry);
 
+/****************************************************************************
+ * Name: nxffs_rdentry
+ *
+ * Description:
+ *   Read and verify the inode entry at this offset.  The block containing
+ *   the inode header must already be in the volume cache.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume.
+ *   offset - The byte offset from the beginning of FLASH where the inode
+ *     header is expected.
+ *   entry  - A memory location to return the expanded inode header
+ *     information.
+ *
+ * Returned Value:
+ *   Zero on success.  Otherwise, a negated errno value is returned
+ *   indicating the nature of the failure.  -ENOENT is returned if the
+ *   inode has been deleted.
+ *
+ * Defined in nxffs_inode.c
+ *
+ ****************************************************************************/
+
+extern int nxffs_rdentry(FAR struct nxffs_volume_s *volume, off_t offset,
+                         FAR struct nxffs_entry_s *entry);
+
 /****************************************************************************
  * Name: nxffs_nextentry
  *
@@ -666,6 +722,114 @@ extern int nxffs_findinode(FAR struct nxffs_volume_s *volume,
 extern off_t nxffs_inodeend(FAR struct nxffs_volume_s *volume,
                             FAR struct nxffs_entry_s *entry);
 
+/****************************************************************************
+ * Name: nxffs_ireset
+ *
+ * Description:
+ *   Empty the inode index and mark it as valid.  The index is then rebuilt
+ *   by adding every valid inode with nxffs_iadd().
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_INDEX
+extern void nxffs_ireset(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_iadd
+ *
+ * Description:
+ *   Add the inode header at 'hoffset' to the inode index.  If the index
+ *   cannot be enlarged, it is discarded and nxffs_findinode() falls back to
+ *   searching FLASH until the index is rebuilt.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - The FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+extern void nxffs_iadd(FAR struct nxffs_volume_s *volume,
+                       FAR const char *name, off_t hoffset);
+
+/****************************************************************************
+ * Name: nxffs_iremove
+ *
+ * Description:
+ *   Remove the inode header at 'hoffset' from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - The FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+extern void nxffs_iremove(FAR struct nxffs_volume_s *volume,
+                          FAR const char *name, off_t hoffset);
+
+/****************************************************************************
+ * Name: nxffs_ibuild
+ *
+ * Description:
+ *   Rebuild the inode index by searching FLASH for all valid inodes.  This
+ *   is necessary after the volume is packed.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None.  On failure, the index is discarded.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+extern void nxffs_ibuild(FAR struct nxffs_volume_s *volume);
+
+/****************************************************************************
+ * Name: nxffs_ifind
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  The
+ *   index must be valid.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success. Otherwise, a negated errno is returned
+ *   that indicates the nature of the failure.
+ *
+ * Defined in nxffs_index.c
+ *
+ ****************************************************************************/
+
+extern int nxffs_ifind(FAR struct nxffs_volume_s *volume,
+                       FAR const char *name,
+                       FAR struct nxffs_entry_s *entry);
+#endif
+
 /****************************************************************************
  * Name: nxffs_verifyblock
  *
@@ -1034,6 +1198,51 @@ extern int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name
 
 extern int nxffs_pack(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_packstep
+ *
+ * Description:
+ *   Perform one bounded step of packing the volume.  Packing stops at the
+ *   first inode boundary after 'maxblocks' erase blocks have been re-
+ *   written.  Each step resumes where the last one stopped.  A new pass
+ *   is started only when free FLASH falls below the packing watermark.
+ *   Between steps, the volume is consistent and may be used normally.  The
+ *   volume exclsem must be held and no file may be open for writing.
+ *
+ * Input Parameters:
+ *   volume    - The volume to be packed.
+ *   maxblocks - The number of erase blocks to re-write in this step.
+ *
+ * Returned Values:
+ *   Zero if there is nothing more to pack; one if more steps are needed.
+ *   Otherwise, a negated errno value is returned to indicate the nature of
+ *   the failure.
+ *
+ ****************************************************************************/
+
+extern int nxffs_packstep(FAR struct nxffs_volume_s *volume, int maxblocks);
+
+/****************************************************************************
+ * Name: nxffs_packcheck
+ *
+ * Description:
+ *   Start packing the volume on the low priority work queue if files have
+ *   been deleted and the free FLASH has fallen below
+ *   CONFIG_NXFFS_PACKWATERMARK erase blocks.  The volume exclsem must be
+ *   held.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+extern void nxffs_packcheck(FAR struct nxffs_volume_s *volume);
+#endif
+
 /****************************************************************************
  * Standard mountpoint operation methods
  *
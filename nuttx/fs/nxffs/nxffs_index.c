@@ -0,0 +1,408 @@
+/****************************************************************************
+ * fs/nxffs/nxffs_index.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <crc32.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+
+#include "nxffs.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The initial number of slots in the index.  This must be a power of two. */
+
+#define NXFFS_IMINSIZE 16
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ihash
+ *
+ * Description:
+ *   Return the hash of an inode name.  Zero is reserved to mark unused
+ *   slots.
+ *
+ ****************************************************************************/
+
+static uint32_t nxffs_ihash(FAR const char *name)
+{
+  uint32_t hash = crc32((FAR const uint8_t *)name, strlen(name));
+  return hash ? hash : 1;
+}
+
+/****************************************************************************
+ * Name: nxffs_idiscard
+ *
+ * Description:
+ *   Free the inode index.  nxffs_findinode() will search FLASH until the
+ *   index is rebuilt.
+ *
+ ****************************************************************************/
+
+static void nxffs_idiscard(FAR struct nxffs_volume_s *volume)
+{
+  if (volume->index)
+    {
+      kfree(volume->index);
+    }
+
+  volume->index  = NULL;
+  volume->isize  = 0;
+  volume->icount = 0;
+  volume->ivalid = false;
+}
+
+/****************************************************************************
+ * Name: nxffs_iinsert
+ *
+ * Description:
+ *   Insert one entry into a table with at least one unused slot.
+ *
+ ****************************************************************************/
+
+static void nxffs_iinsert(FAR struct nxffs_ientry_s *index, uint32_t isize,
+                          uint32_t hash, off_t hoffset)
+{
+  uint32_t mask = isize - 1;
+  uint32_t i;
+
+  for (i = hash & mask; index[i].hash != 0; i = (i + 1) & mask);
+
+  index[i].hash    = hash;
+  index[i].hoffset = hoffset;
+}
+
+/****************************************************************************
+ * Name: nxffs_igrow
+ *
+ * Description:
+ *   Double the number of slots in the index.
+ *
+ ****************************************************************************/
+
+static int nxffs_igrow(FAR struct nxffs_volume_s *volume)
+{
+  FAR struct nxffs_ientry_s *index;
+  uint32_t isize = volume->isize << 1;
+  uint32_t i;
+
+  index = (FAR struct nxffs_ientry_s *)
+    kzalloc(isize * sizeof(struct nxffs_ientry_s));
+
+  if (!index)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < volume->isize; i++)
+    {
+      if (volume->index[i].hash != 0)
+        {
+          nxffs_iinsert(index, isize, volume->index[i].hash,
+                        volume->index[i].hoffset);
+        }
+    }
+
+  kfree(volume->index);
+  volume->index = index;
+  volume->isize = isize;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_ireset
+ *
+ * Description:
+ *   Empty the inode index and mark it as valid.  The index is then rebuilt
+ *   by adding every valid inode with nxffs_iadd().
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_ireset(FAR struct nxffs_volume_s *volume)
+{
+  if (!volume->index)
+    {
+      volume->index = (FAR struct nxffs_ientry_s *)
+        kmalloc(NXFFS_IMINSIZE * sizeof(struct nxffs_ientry_s));
+
+      if (!volume->index)
+        {
+          fdbg("Failed to allocate the inode index\n");
+          nxffs_idiscard(volume);
+          return;
+        }
+
+      volume->isize = NXFFS_IMINSIZE;
+    }
+
+  memset(volume->index, 0, volume->isize * sizeof(struct nxffs_ientry_s));
+  volume->icount = 0;
+  volume->ivalid = true;
+}
+
+/****************************************************************************
+ * Name: nxffs_iadd
+ *
+ * Description:
+ *   Add the inode header at 'hoffset' to the inode index.  If the index
+ *   cannot be enlarged, it is discarded and nxffs_findinode() falls back to
+ *   searching FLASH until the index is rebuilt.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - The FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_iadd(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                off_t hoffset)
+{
+  if (!volume->ivalid)
+    {
+      return;
+    }
+
+  /* Keep the table no more than 3/4 full so that searches are short and
+   * always end at an unused slot.
+   */
+
+  if (4 * (volume->icount + 1) > 3 * volume->isize &&
+      nxffs_igrow(volume) < 0)
+    {
+      fdbg("Failed to grow the inode index, %d entries\n", volume->icount);
+      nxffs_idiscard(volume);
+      return;
+    }
+
+  nxffs_iinsert(volume->index, volume->isize, nxffs_ihash(name), hoffset);
+  volume->icount++;
+}
+
+/****************************************************************************
+ * Name: nxffs_iremove
+ *
+ * Description:
+ *   Remove the inode header at 'hoffset' from the inode index.
+ *
+ * Input Parameters:
+ *   volume  - Describes the NXFFS volume
+ *   name    - The name of the inode
+ *   hoffset - The FLASH offset to the inode header
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_iremove(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                   off_t hoffset)
+{
+  FAR struct nxffs_ientry_s *index = volume->index;
+  uint32_t mask;
+  uint32_t hash;
+  uint32_t home;
+  uint32_t i;
+  uint32_t j;
+
+  if (!volume->ivalid)
+    {
+      return;
+    }
+
+  mask = volume->isize - 1;
+  hash = nxffs_ihash(name);
+
+  for (i = hash & mask; index[i].hash != 0; i = (i + 1) & mask)
+    {
+      if (index[i].hash == hash && index[i].hoffset == hoffset)
+        {
+          break;
+        }
+    }
+
+  if (index[i].hash == 0)
+    {
+      return;
+    }
+
+  /* Remove the entry, then move any following entries of the same probe
+   * sequence back into the hole so that no search ends early.
+   */
+
+  index[i].hash = 0;
+  volume->icount--;
+
+  for (j = (i + 1) & mask; index[j].hash != 0; j = (j + 1) & mask)
+    {
+      home = index[j].hash & mask;
+      if (((j - home) & mask) >= ((j - i) & mask))
+        {
+          index[i]      = index[j];
+          index[j].hash = 0;
+          i             = j;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ibuild
+ *
+ * Description:
+ *   Rebuild the inode index by searching FLASH for all valid inodes.  This
+ *   is necessary after the volume is packed.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *
+ * Returned Value:
+ *   None.  On failure, the index is discarded.
+ *
+ ****************************************************************************/
+
+void nxffs_ibuild(FAR struct nxffs_volume_s *volume)
+{
+  struct nxffs_entry_s entry;
+  off_t offset;
+  int ret;
+
+  nxffs_ireset(volume);
+
+  offset = volume->inoffset;
+  while ((ret = nxffs_nextentry(volume, offset, &entry)) == OK)
+    {
+      nxffs_iadd(volume, entry.name, entry.hoffset);
+      offset = nxffs_inodeend(volume, &entry);
+      nxffs_freeentry(&entry);
+    }
+
+  if (ret != -ENOENT)
+    {
+      fdbg("Failed to build the inode index: %d\n", -ret);
+      nxffs_idiscard(volume);
+    }
+}
+
+/****************************************************************************
+ * Name: nxffs_ifind
+ *
+ * Description:
+ *   Use the inode index to find the inode with the provided name.  The
+ *   index must be valid.
+ *
+ * Input Parameters:
+ *   volume - Describes the NXFFS volume
+ *   name   - The name of the inode to find
+ *   entry  - The location to return information about the inode.
+ *
+ * Returned Value:
+ *   Zero is returned on success. Otherwise, a negated errno is returned
+ *   that indicates the nature of the failure.
+ *
+ ****************************************************************************/
+
+int nxffs_ifind(FAR struct nxffs_volume_s *volume, FAR const char *name,
+                FAR struct nxffs_entry_s *entry)
+{
+  FAR struct nxffs_ientry_s *index = volume->index;
+  uint32_t mask = volume->isize - 1;
+  uint32_t hash = nxffs_ihash(name);
+  uint32_t i;
+  int ret;
+
+  DEBUGASSERT(volume->ivalid);
+
+  for (i = hash & mask; index[i].hash != 0; i = (i + 1) & mask)
+    {
+      if (index[i].hash != hash)
+        {
+          continue;
+        }
+
+      /* The index only tells us where to look.  Verify that there really
+       * is a valid inode with this name at that position.
+       */
+
+      nxffs_ioseek(volume, index[i].hoffset);
+      ret = nxffs_rdcache(volume, volume->ioblock);
+      if (ret < 0)
+        {
+          fdbg("Failed to read inode block %d: %d\n", volume->ioblock, -ret);
+          return ret;
+        }
+
+      if (volume->iooffset + SIZEOF_NXFFS_INODE_HDR <= volume->geo.blocksize &&
+          memcmp(&volume->cache[volume->iooffset], g_inodemagic,
+                 NXFFS_MAGICSIZE) == 0 &&
+          nxffs_rdentry(volume, index[i].hoffset, entry) == OK)
+        {
+          if (strcmp(name, entry->name) == 0)
+            {
+              return OK;
+            }
+
+          nxffs_freeentry(entry);
+        }
+    }
+
+  return -ENOENT;
+}
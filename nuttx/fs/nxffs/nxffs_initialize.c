@@ -273,11 +273,23 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
   ret = nxffs_limits(volume);
   if (ret == OK)
     {
+#ifdef CONFIG_NXFFS_BGPACK
+      /* There may be deleted inodes on the FLASH */
+
+      volume->packpend = true;
+      nxffs_packcheck(volume);
+#endif
       return OK;
     }
   fdbg("Failed to calculate file system limits: %d\n", -ret);
 
 errout_with_buffer:
+#ifdef CONFIG_NXFFS_INDEX
+  if (volume->index)
+    {
+      kfree(volume->index);
+    }
+#endif
   kfree(volume->pack);
 errout_with_cache:
   kfree(volume->cache);
@@ -322,6 +334,12 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
   int nerased;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* The inode index is rebuilt as the inodes are found */
+
+  nxffs_ireset(volume);
+#endif
+
   /* Get the offset to the first valid block on the FLASH */
 
   block = 0;
@@ -365,6 +383,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
       volume->inoffset = entry.hoffset;
       fvdbg("First inode at offset %d\n", volume->inoffset);
 
+#ifdef CONFIG_NXFFS_INDEX
+      nxffs_iadd(volume, entry.name, entry.hoffset);
+#endif
+
       /* Discard this entry and set the next offset. */
 
       offset = nxffs_inodeend(volume, &entry);
@@ -377,6 +399,10 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
     {
       while ((ret = nxffs_nextentry(volume, offset, &entry)) == OK)
         {
+#ifdef CONFIG_NXFFS_INDEX
+          nxffs_iadd(volume, entry.name, entry.hoffset);
+#endif
+
           /* Discard the entry and guess the next offset. */
 
           offset = nxffs_inodeend(volume, &entry);
@@ -385,6 +411,32 @@ int nxffs_limits(FAR struct nxffs_volume_s *volume)
       fvdbg("Last inode before offset %d\n", offset);
     }
 
+  /* The search for inodes normally ends in the erased FLASH just after the
+   * last inode.  But a packing step may have left a deleted inode header
+   * that skips over FLASH that is not yet erased (see nxffs_pack.c).  In
+   * that case, the free FLASH region begins where the search ended.
+   */
+
+  if (ret == -ENOENT)
+    {
+      off_t erased;
+
+      if (volume->iooffset >= SIZEOF_NXFFS_BLOCK_HDR + NXFFS_NERASED)
+        {
+          erased = nxffs_iotell(volume) - NXFFS_NERASED;
+        }
+      else
+        {
+          erased = volume->ioblock * volume->geo.blocksize +
+                   SIZEOF_NXFFS_BLOCK_HDR;
+        }
+
+      if (erased > offset)
+        {
+          offset = erased;
+        }
+    }
+
   /* No inodes were found after this offset.  Now search for a block of
    * erased flash.
    */
@@ -517,6 +569,14 @@ int nxffs_unbind(FAR void *handle, FAR struct inode **blkdriver)
 #ifndef CONFIG_NXFFS_PREALLOCATED
 #  error "No design to support dynamic allocation of volumes"
 #else
-  return g_volume.ofiles ? -EBUSY : OK;
+  if (g_volume.ofiles)
+    {
+      return -EBUSY;
+    }
+
+#ifdef CONFIG_NXFFS_BGPACK
+  (void)work_cancel(LPWORK, &g_volume.packwork);
+#endif
+  return OK;
 #endif
 }
@@ -68,11 +68,16 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 /****************************************************************************
  * Name: nxffs_rdentry
  *
  * Description:
- *   Read the inode entry at this offset.  Called only from nxffs_nextentry().
+ *   Read the inode entry at this offset.  Called from nxffs_nextentry() and,
+ *   with the inode index, from nxffs_ifind().
  *
  * Input Parameters:
  *   volume - Describes the current volume.
@@ -89,8 +94,8 @@
  *
  ****************************************************************************/
 
-static int nxffs_rdentry(FAR struct nxffs_volume_s *volume, off_t offset,
-                         FAR struct nxffs_entry_s *entry)
+int nxffs_rdentry(FAR struct nxffs_volume_s *volume, off_t offset,
+                  FAR struct nxffs_entry_s *entry)
 {
   struct nxffs_inode_s inode;
   uint32_t ecrc;
@@ -211,10 +216,6 @@ errout:
   return ret;
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
 /****************************************************************************
  * Name: nxffs_freeentry
  *
@@ -392,6 +393,15 @@ int nxffs_findinode(FAR struct nxffs_volume_s *volume, FAR const char *name,
   off_t offset;
   int ret;
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* If the inode index is complete, then there is no need to search FLASH */
+
+  if (volume->ivalid)
+    {
+      return nxffs_ifind(volume, name, entry);
+    }
+#endif
+
   /* Start with the first valid inode that was discovered when the volume
    * was created (or modified after the last file system re-packing).
    */
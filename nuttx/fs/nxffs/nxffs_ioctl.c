@@ -108,7 +108,7 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       goto errout;
     }
 
-  /* Only a reformat and optimize commands are supported */
+  /* Only the reformat, optimize, and pack step commands are supported */
 
   if (cmd == FIOC_REFORMAT)
     {
@@ -136,6 +136,24 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       ret = nxffs_pack(volume);
     }
+
+  else if (cmd == FIOC_PACKSTEP)
+    {
+      fvdbg("Pack step command\n");
+
+      /* A packing step cannot move the file that is being written */
+
+      if (nxffs_findwriter(volume))
+        {
+          fdbg("File open for writing\n");
+          ret = -EBUSY;
+          goto errout_with_semaphore;
+        }
+
+      /* Pack the requested number of erase blocks */
+
+      ret = nxffs_packstep(volume, arg > 0 ? (int)arg : CONFIG_NXFFS_PACKSTEP);
+    }
   else
     {
       /* No other commands supported */
@@ -1175,6 +1175,9 @@ int nxffs_close(FAR struct file *filep)
       if ((ofile->oflags & O_WROK) != 0)
         {
           ret = nxffs_wrclose(volume, (FAR struct nxffs_wrfile_s *)ofile);
+#ifdef CONFIG_NXFFS_BGPACK
+          nxffs_packcheck(volume);
+#endif
         }
 
       /* Release all resouces held by the open file */
@@ -1276,11 +1279,16 @@ int nxffs_wrinode(FAR struct nxffs_volume_s *volume,
       fdbg("Failed to write inode header block %d: %d\n",
            volume->ioblock, -ret);
     }
+#ifdef CONFIG_NXFFS_INDEX
+  else
+    {
+      /* The inode can be found only after its header has been written */
 
-  /* The volume is now available for other writers */
+      nxffs_iadd(volume, entry->name, entry->hoffset);
+    }
+#endif
 
 errout:
-  sem_post(&volume->wrsem);
   return ret;
 }
 
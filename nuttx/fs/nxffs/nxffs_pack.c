@@ -42,6 +42,7 @@
 #include <nuttx/config.h>
 
 #include <string.h>
+#include <semaphore.h>
 #include <errno.h>
 #include <assert.h>
 #include <crc32.h>
@@ -86,6 +87,12 @@ struct nxffs_pack_s
   off_t                ioblock;    /* I/O block number */
   off_t                block0;     /* First I/O block number in the erase block */
   uint16_t             iooffset;   /* I/O block offset */
+
+  /* When packing one step at a time, this is set when the step has used up
+   * its erase blocks.  Packing then stops at the next inode boundary.
+   */
+
+  bool                 stop;
 };
 
 /****************************************************************************
@@ -701,11 +708,27 @@ static int nxffs_wrinodehdr(FAR struct nxffs_volume_s *volume,
 
       inode->state = INODE_STATE_FILE;
       nxffs_wrle32(inode->crc, crc);
+      ret = OK;
 
-      /* If any open files reference this inode, then update the open file
-       * state.
-       */
+#ifdef CONFIG_NXFFS_INDEX
+      /* nxffs_wrinode() adds the inode to the index in case 2 */
+
+      nxffs_iadd(volume, pack->dest.entry.name, pack->dest.entry.hoffset);
+#endif
+    }
 
+#ifdef CONFIG_NXFFS_INDEX
+  /* The inode has moved.  The source entry is still intact at this point. */
+
+  nxffs_iremove(volume, pack->dest.entry.name, pack->src.entry.hoffset);
+#endif
+
+  /* If any open files reference this inode, then update the open file
+   * state.
+   */
+
+  if (ret == OK)
+    {
       ret = nxffs_updateinode(volume, &pack->dest.entry);
       if (ret < 0)
         {
@@ -864,6 +887,96 @@ static int nxffs_endsrcblock(FAR struct nxffs_volume_s *volume,
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxffs_wrskip
+ *
+ * Description:
+ *   Format a deleted inode header with no name and no data whose data
+ *   offset is 'target'.  Like any other deleted inode, nxffs_nextentry()
+ *   will skip over it -- and over everything up to 'target'.  This is how
+ *   FLASH that has been copied but not yet erased is hidden when packing
+ *   is performed one step at a time.
+ *
+ * Input Parameters:
+ *   buffer  - The memory that will hold the inode header
+ *   hoffset - The FLASH offset to the inode header
+ *   target  - The FLASH offset where the search for inodes should resume
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+static void nxffs_wrskip(FAR uint8_t *buffer, off_t hoffset, off_t target)
+{
+  FAR struct nxffs_inode_s *inode = (FAR struct nxffs_inode_s *)buffer;
+  uint32_t crc;
+
+  memcpy(inode->magic, g_inodemagic, NXFFS_MAGICSIZE);
+  inode->state  = CONFIG_NXFFS_ERASEDSTATE;
+  inode->namlen = 0;
+
+  nxffs_wrle32(inode->noffs,  hoffset + SIZEOF_NXFFS_INODE_HDR);
+  nxffs_wrle32(inode->doffs,  target);
+  nxffs_wrle32(inode->utc,    0);
+  nxffs_wrle32(inode->crc,    0);
+  nxffs_wrle32(inode->datlen, 0);
+
+  crc = crc32(buffer, SIZEOF_NXFFS_INODE_HDR);
+
+  inode->state = INODE_STATE_DELETED;
+  nxffs_wrle32(inode->crc, crc);
+}
+
+/****************************************************************************
+ * Name: nxffs_packskip
+ *
+ * Description:
+ *   A packing step is ending at an inode boundary.  Everything from the
+ *   current destination position up to 'target' has either been copied
+ *   already or has been deleted.  Hide it behind a deleted inode header
+ *   so that the volume is consistent until the next step.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed
+ *   pack   - The volume packing state structure.
+ *   target - The FLASH offset to the next inode that has not been packed
+ *     or to the free FLASH region.
+ *
+ * Returned Values:
+ *   Zero on success; volume->packoffset then holds the position where the
+ *   next step resumes.  -ENOSPC is returned if the inode header will not
+ *   fit at the end of the current I/O block; packing cannot stop here.
+ *
+ ****************************************************************************/
+
+static int nxffs_packskip(FAR struct nxffs_volume_s *volume,
+                          FAR struct nxffs_pack_s *pack, off_t target)
+{
+  off_t offset = nxffs_packtell(volume, pack);
+
+  /* Nothing can hide in a gap smaller than an inode header */
+
+  DEBUGASSERT(target >= offset);
+  if (target - offset >= SIZEOF_NXFFS_INODE_HDR)
+    {
+      if (pack->iooffset + SIZEOF_NXFFS_INODE_HDR > volume->geo.blocksize)
+        {
+          return -ENOSPC;
+        }
+
+      /* The rest of the pack buffer still holds what is on FLASH */
+
+      nxffs_wrskip(&pack->iobuffer[pack->iooffset], offset, target);
+      pack->iooffset += SIZEOF_NXFFS_INODE_HDR;
+    }
+
+  /* The next step resumes here */
+
+  volume->packoffset = offset;
+  return OK;
+}
+
 /****************************************************************************
  * Name: nxffs_packblock
  *
@@ -969,6 +1082,17 @@ static inline int nxffs_packblock(FAR struct nxffs_volume_s *volume,
               return -ENOSPC;
             }
 
+          /* If this packing step has used up its erase blocks, then stop
+           * here if we can.  -EAGAIN tells the caller that the step ended
+           * with the next inode not yet packed.
+           */
+
+          if (pack->stop &&
+              nxffs_packskip(volume, pack, pack->src.entry.hoffset) == OK)
+            {
+              return -EAGAIN;
+            }
+
           /* Setup the new source stream */
 
           ret = nxffs_srcsetup(volume, pack, pack->src.entry.doffset);
@@ -1247,40 +1371,309 @@ static inline int nxffs_packwriter(FAR struct nxffs_volume_s *volume,
 }
 
 /****************************************************************************
- * Public Functions
+ * Name: nxffs_packerase
+ *
+ * Description:
+ *   Set the volume->pack buffer to the erased state from the byte offset
+ *   'pos' through the end of the erase block.  The I/O block headers after
+ *   'pos' are preserved.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed
+ *   pos    - Offset into the erase block.  This must not lie within an I/O
+ *     block header.
+ *
+ * Returned Values:
+ *   None
+ *
  ****************************************************************************/
 
+static void nxffs_packerase(FAR struct nxffs_volume_s *volume, size_t pos)
+{
+  FAR uint8_t *iobuffer;
+  size_t iooffset;
+
+  iooffset = pos % volume->geo.blocksize;
+  for (iobuffer = &volume->pack[pos - iooffset];
+       iobuffer < &volume->pack[volume->geo.erasesize];
+       iobuffer += volume->geo.blocksize)
+    {
+      memset(&iobuffer[iooffset], CONFIG_NXFFS_ERASEDSTATE,
+             volume->geo.blocksize - iooffset);
+      iooffset = SIZEOF_NXFFS_BLOCK_HDR;
+    }
+}
+
 /****************************************************************************
- * Name: nxffs_pack
+ * Name: nxffs_packerased
+ *
+ * Description:
+ *   Return true if everything but the I/O block headers in the volume->pack
+ *   buffer is in the erased state.
+ *
+ ****************************************************************************/
+
+static bool nxffs_packerased(FAR struct nxffs_volume_s *volume)
+{
+  size_t datlen = volume->geo.blocksize - SIZEOF_NXFFS_BLOCK_HDR;
+  FAR uint8_t *iobuffer;
+
+  for (iobuffer = volume->pack;
+       iobuffer < &volume->pack[volume->geo.erasesize];
+       iobuffer += volume->geo.blocksize)
+    {
+      if (nxffs_erased(&iobuffer[SIZEOF_NXFFS_BLOCK_HDR], datlen) < datlen)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: nxffs_packrewrite
+ *
+ * Description:
+ *   Erase one erase block and write the volume->pack buffer back to it.
+ *
+ ****************************************************************************/
+
+static int nxffs_packrewrite(FAR struct nxffs_volume_s *volume, off_t eblock)
+{
+  int ret;
+
+  ret = MTD_ERASE(volume->mtd, eblock, 1);
+  if (ret < 0)
+    {
+      fdbg("Failed to erase block %d: %d\n", eblock, -ret);
+      return ret;
+    }
+
+  ret = MTD_BWRITE(volume->mtd, eblock * volume->blkper, volume->blkper,
+                   volume->pack);
+  if (ret < 0)
+    {
+      fdbg("Failed to write erase block %d: %d\n", eblock, -ret);
+      return ret;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_packtail
+ *
+ * Description:
+ *   All of the valid inodes have been packed.  Only deleted inodes and old
+ *   copies of packed inodes lie between the end of the packed inodes and
+ *   the free FLASH region.  Erase that FLASH, at most 'maxblocks' erase
+ *   blocks at a time.
+ *
+ *   Until the last step, a deleted inode header at the end of the packed
+ *   inodes skips over the FLASH that is being erased.  The free FLASH
+ *   region does not move until the last step.
+ *
+ * Input Parameters:
+ *   volume    - The volume to be packed
+ *   offset    - The FLASH offset to the end of the packed inodes
+ *   maxblocks - The number of erase blocks that may be re-written
+ *
+ * Returned Values:
+ *   Zero if the tail has been erased; one if more steps are needed.
+ *   Otherwise, a negated errno value is returned to indicate the nature of
+ *   the failure.
+ *
+ ****************************************************************************/
+
+static int nxffs_packtail(FAR struct nxffs_volume_s *volume, off_t offset,
+                          int maxblocks)
+{
+  uint8_t skip[SIZEOF_NXFFS_INODE_HDR];
+  off_t eblock0;
+  off_t eblock1;
+  off_t eblock;
+  int nblocks = 0;
+  int ret;
+
+  /* These are the erase blocks holding the end of the packed inodes and
+   * the beginning of the free FLASH region.
+   */
+
+  eblock0 = offset / volume->geo.erasesize;
+  eblock1 = (volume->froffset - 1) / volume->geo.erasesize;
+
+  /* The next step resumes at the end of the packed inodes */
+
+  volume->packoffset = offset;
+
+  /* If there are erase blocks in between, make sure that they are skipped
+   * before erasing any of them.
+   */
+
+  if (eblock1 > eblock0)
+    {
+      nxffs_wrskip(skip, offset, volume->froffset);
+
+      nxffs_ioseek(volume, offset);
+      ret = nxffs_rdcache(volume, volume->ioblock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      if (memcmp(&volume->cache[volume->iooffset], skip,
+                 SIZEOF_NXFFS_INODE_HDR) != 0)
+        {
+          ret = MTD_BREAD(volume->mtd, eblock0 * volume->blkper,
+                          volume->blkper, volume->pack);
+          if (ret < 0)
+            {
+              fdbg("Failed to read erase block %d: %d\n", eblock0, -ret);
+              return ret;
+            }
+
+          memcpy(&volume->pack[offset - eblock0 * volume->geo.erasesize],
+                 skip, SIZEOF_NXFFS_INODE_HDR);
+
+          ret = nxffs_packrewrite(volume, eblock0);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          nblocks++;
+        }
+    }
+
+  /* Erase each of the skipped erase blocks that is not already erased */
+
+  for (eblock = eblock0 + 1; eblock <= eblock1; eblock++)
+    {
+      ret = MTD_BREAD(volume->mtd, eblock * volume->blkper, volume->blkper,
+                      volume->pack);
+      if (ret < 0)
+        {
+          fdbg("Failed to read erase block %d: %d\n", eblock, -ret);
+          return ret;
+        }
+
+      if (nxffs_packerased(volume))
+        {
+          continue;
+        }
+
+      if (nblocks >= maxblocks)
+        {
+          return 1;
+        }
+
+      nxffs_packerase(volume, SIZEOF_NXFFS_BLOCK_HDR);
+      ret = nxffs_packrewrite(volume, eblock);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      nblocks++;
+    }
+
+  /* Then erase the rest of the erase block holding the end of the packed
+   * inodes.  That is the new beginning of the free FLASH region.
+   */
+
+  if (nblocks >= maxblocks)
+    {
+      return 1;
+    }
+
+  ret = MTD_BREAD(volume->mtd, eblock0 * volume->blkper, volume->blkper,
+                  volume->pack);
+  if (ret < 0)
+    {
+      fdbg("Failed to read erase block %d: %d\n", eblock0, -ret);
+      return ret;
+    }
+
+  nxffs_packerase(volume, offset - eblock0 * volume->geo.erasesize);
+  ret = nxffs_packrewrite(volume, eblock0);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  volume->froffset = offset;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxffs_packlow
+ *
+ * Description:
+ *   Return true if fewer than CONFIG_NXFFS_PACKWATERMARK erase blocks of
+ *   free FLASH remain at the end of the volume.  A watermark that is not
+ *   well below the size of the volume would keep packing running all of
+ *   the time, so it is limited to half of the erase blocks.
+ *
+ ****************************************************************************/
+
+static inline bool nxffs_packlow(FAR struct nxffs_volume_s *volume)
+{
+  off_t avail = volume->nblocks * volume->geo.blocksize - volume->froffset;
+  off_t watermark = CONFIG_NXFFS_PACKWATERMARK;
+
+  if (watermark > (off_t)(volume->geo.neraseblocks / 2))
+    {
+      watermark = volume->geo.neraseblocks / 2;
+    }
+
+  return avail < watermark * volume->geo.erasesize;
+}
+
+/****************************************************************************
+ * Name: nxffs_dopack
  *
  * Description:
  *   Pack and re-write the filesystem in order to free up memory at the end
  *   of FLASH.
  *
  * Input Parameters:
- *   volume - The volume to be packed.
+ *   volume    - The volume to be packed.
+ *   maxblocks - Zero to pack the whole volume.  Otherwise, packing stops
+ *     at the first inode boundary after this many erase blocks have been
+ *     re-written, leaving the volume consistent.  No file may be open for
+ *     writing in this case.
  *
  * Returned Values:
- *   Zero on success; Otherwise, a negated errno value is returned to
- *   indicate the nature of the failure.
+ *   Zero if the volume is packed; one if more packing steps are needed.
+ *   Otherwise, a negated errno value is returned to indicate the nature of
+ *   the failure.
  *
  ****************************************************************************/
 
-int nxffs_pack(FAR struct nxffs_volume_s *volume)
+static int nxffs_dopack(FAR struct nxffs_volume_s *volume, int maxblocks)
 {
   struct nxffs_pack_s pack;
   FAR struct nxffs_wrfile_s *wrfile;
+  off_t froffset;
   off_t iooffset;
   off_t eblock;
+  off_t eend;
   off_t block;
   bool packed;
+  bool paused;
+  int nblocks;
   int i;
   int ret;
 
+  DEBUGASSERT(maxblocks == 0 || nxffs_findwriter(volume) == NULL);
+
   /* Get the offset to the first valid inode entry */
 
-  wrfile = NULL;
-  packed = false;
+  wrfile   = NULL;
+  packed   = false;
+  paused   = false;
+  froffset = volume->froffset;
 
   iooffset = nxffs_mediacheck(volume, &pack);
   if (iooffset == 0)
@@ -1338,10 +1731,34 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
     }
 
   /* There is a valid format and valid inodes on the media.. setup up to
-   * begin the packing operation.
+   * begin the packing operation.  A packing step resumes where the last
+   * step stopped; FLASH freed before that position is recovered by the
+   * next pass through the volume.
    */
 
-  ret = nxffs_startpos(volume, &pack, &iooffset);
+  if (maxblocks > 0 && volume->packoffset > iooffset &&
+      volume->packoffset < volume->froffset)
+    {
+      nxffs_freeentry(&pack.src.entry);
+      iooffset = volume->packoffset;
+
+      ret = nxffs_nextentry(volume, iooffset, &pack.src.entry);
+      if (ret == OK)
+        {
+          ret = nxffs_startpos(volume, &pack, &iooffset);
+        }
+      else if (ret == -ENOENT)
+        {
+          /* There are no valid inodes after the resume position */
+
+          ret = -ENOSPC;
+        }
+    }
+  else
+    {
+      ret = nxffs_startpos(volume, &pack, &iooffset);
+    }
+
   if (ret < 0)
     {
       /* This is a normal situation if the volume is full */
@@ -1358,6 +1775,16 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
 
           if (iooffset + CONFIG_NXFFS_TAILTHRESHOLD < volume->froffset)
             {
+               /* When packing one step at a time, the tail is erased over
+                * several steps.
+                */
+
+               if (maxblocks > 0)
+                 {
+                   ret = nxffs_packtail(volume, iooffset, maxblocks);
+                   goto errout_with_pack;
+                 }
+
                /* Setting 'packed' to true will supress normal inode packing
                 * operation.
                 */
@@ -1401,12 +1828,19 @@ start_pack:
   volume->froffset = iooffset;
 
   /* Then pack all erase blocks starting with the erase block that contains
-   * the ioblock and through the final erase block on the FLASH.
+   * the ioblock and through the final erase block on the FLASH.  A packing
+   * step need not go past the erase block that holds the free FLASH offset.
    */
 
-  for (eblock = pack.ioblock / volume->blkper;
-       eblock < volume->geo.neraseblocks;
-       eblock++)
+  eend = volume->geo.neraseblocks;
+  if (maxblocks > 0)
+    {
+      eend = MIN(froffset / volume->geo.erasesize + 1, eend);
+    }
+
+  for (eblock = pack.ioblock / volume->blkper, nblocks = 0;
+       eblock < eend && !paused;
+       eblock++, nblocks++)
     {
       /* Read the erase block into the pack buffer.  We need to do this even
        * if we are overwriting the entire block so that we skip over
@@ -1441,6 +1875,16 @@ start_pack:
 
                 pack.ioblock = block;
 
+                /* A packing step stops at the first inode boundary in or
+                 * after the last I/O block of its last erase block.
+                 */
+
+                if (maxblocks > 0)
+                  {
+                    pack.stop = (nblocks * volume->blkper + i + 1 >=
+                                 maxblocks * volume->blkper);
+                  }
+
                 /* If this is not a valid block or if we have already
                  * finished packing the valid inode entries, then just fall
                  * through, reset the FLASH memory to the erase state, and
@@ -1462,6 +1906,22 @@ start_pack:
                          ret = nxffs_packblock(volume, &pack);
                          if (ret < 0)
                            {
+                             /* The error -EAGAIN means that the packing step
+                              * stopped at an inode boundary.  If all inodes
+                              * have been packed in a step, the old FLASH up to
+                              * the free region is skipped and erased by later
+                              * steps.  In either case, the rest of this erase
+                              * block is left as it was.
+                              */
+
+                             if (ret == -EAGAIN ||
+                                 (ret == -ENOSPC && maxblocks > 0 &&
+                                  nxffs_packskip(volume, &pack, froffset) == OK))
+                               {
+                                 paused = true;
+                                 break;
+                               }
+
                              /* The error -ENOSPC is a special value that simply
                               * means that there is nothing further to be packed.
                               */
@@ -1565,8 +2025,193 @@ start_pack:
         }
     }
 
+  /* A packing step that stopped early leaves the free FLASH region where
+   * it was.
+   */
+
+  ret = OK;
+  if (paused)
+    {
+      volume->froffset = froffset;
+      ret = 1;
+    }
+
 errout_with_pack:
   nxffs_freeentry(&pack.src.entry);
   nxffs_freeentry(&pack.dest.entry);
+
+  /* The packed blocks were written directly to FLASH so the cached block
+   * may be stale.
+   */
+
+  volume->cblock = (off_t)-1;
+
+#ifdef CONFIG_NXFFS_INDEX
+  /* The index follows inodes as they are moved.  After packing the whole
+   * volume, or if the index was discarded, find all of the inodes again.
+   */
+
+  if (maxblocks == 0 || !volume->ivalid)
+    {
+      nxffs_ibuild(volume);
+    }
+#endif
   return ret;
 }
+
+/****************************************************************************
+ * Name: nxffs_packworker
+ *
+ * Description:
+ *   Perform one packing step on the low priority work queue and schedule
+ *   the next one until the volume is packed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+static void nxffs_packworker(FAR void *arg)
+{
+  FAR struct nxffs_volume_s *volume = (FAR struct nxffs_volume_s *)arg;
+  int ret;
+
+  ret = sem_wait(&volume->exclsem);
+  if (ret != OK)
+    {
+      fdbg("sem_wait failed: %d\n", errno);
+      return;
+    }
+
+  /* Writers have priority.  If a file is open for writing, packing resumes
+   * when it is closed.
+   */
+
+  if (nxffs_findwriter(volume) == NULL)
+    {
+      ret = nxffs_packstep(volume, CONFIG_NXFFS_PACKSTEP);
+      if (ret < 0)
+        {
+          fdbg("Packing step failed: %d\n", -ret);
+        }
+      else if (ret == 0)
+        {
+          volume->packpend = false;
+        }
+      else if (work_available(&volume->packwork))
+        {
+          (void)work_queue(LPWORK, &volume->packwork, nxffs_packworker,
+                           volume, 0);
+        }
+    }
+
+  sem_post(&volume->exclsem);
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxffs_pack
+ *
+ * Description:
+ *   Pack and re-write the filesystem in order to free up memory at the end
+ *   of FLASH.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Values:
+ *   Zero on success; Otherwise, a negated errno value is returned to
+ *   indicate the nature of the failure.
+ *
+ ****************************************************************************/
+
+int nxffs_pack(FAR struct nxffs_volume_s *volume)
+{
+  int ret = nxffs_dopack(volume, 0);
+
+  /* The next packing step starts a new pass through the volume */
+
+  volume->packoffset = 0;
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxffs_packstep
+ *
+ * Description:
+ *   Perform one bounded step of packing the volume.  Packing stops at the
+ *   first inode boundary after 'maxblocks' erase blocks have been re-
+ *   written (a single file larger than that is always moved in one step).
+ *   Between steps, the volume is consistent and may be used normally.
+ *   Each step resumes where the last one stopped.  A new pass through the
+ *   volume is started only when fewer than CONFIG_NXFFS_PACKWATERMARK
+ *   erase blocks of free FLASH remain.
+ *
+ *   The volume exclsem must be held and no file may be open for writing.
+ *
+ * Input Parameters:
+ *   volume    - The volume to be packed.
+ *   maxblocks - The number of erase blocks to re-write in this step.
+ *
+ * Returned Values:
+ *   Zero if there is nothing more to pack; one if more steps are needed.
+ *   Otherwise, a negated errno value is returned to indicate the nature of
+ *   the failure.
+ *
+ ****************************************************************************/
+
+int nxffs_packstep(FAR struct nxffs_volume_s *volume, int maxblocks)
+{
+  int ret;
+
+  DEBUGASSERT(maxblocks > 0);
+
+  /* Don't start a new pass while there is plenty of free FLASH */
+
+  if (volume->packoffset == 0 && !nxffs_packlow(volume))
+    {
+      return OK;
+    }
+
+  ret = nxffs_dopack(volume, maxblocks);
+
+  /* After the last step, the next one starts a new pass */
+
+  if (ret <= 0)
+    {
+      volume->packoffset = 0;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nxffs_packcheck
+ *
+ * Description:
+ *   Start packing the volume on the low priority work queue if files have
+ *   been deleted and the free FLASH has fallen below
+ *   CONFIG_NXFFS_PACKWATERMARK erase blocks.  The volume exclsem must be
+ *   held.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+void nxffs_packcheck(FAR struct nxffs_volume_s *volume)
+{
+  if (volume->packpend && work_available(&volume->packwork) &&
+      nxffs_packlow(volume))
+    {
+      (void)work_queue(LPWORK, &volume->packwork, nxffs_packworker,
+                       volume, 0);
+    }
+}
+#endif
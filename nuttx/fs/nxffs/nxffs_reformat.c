@@ -256,6 +256,13 @@ int nxffs_reformat(FAR struct nxffs_volume_s *volume)
       return ret;
     }
 
+  /* All of the inodes are gone */
+
+  volume->packoffset = 0;
+#ifdef CONFIG_NXFFS_INDEX
+  nxffs_ireset(volume);
+#endif
+
   /* Check for bad blocks */
 
   ret = nxffs_badblocks(volume);
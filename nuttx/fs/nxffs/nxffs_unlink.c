@@ -143,6 +143,19 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name)
     {
       fdbg("Failed to read data into cache: %d\n", ret);
     }
+#if defined(CONFIG_NXFFS_INDEX) || defined(CONFIG_NXFFS_BGPACK)
+  else
+    {
+#ifdef CONFIG_NXFFS_INDEX
+      nxffs_iremove(volume, name, entry.hoffset);
+#endif
+#ifdef CONFIG_NXFFS_BGPACK
+      /* Packing can now recover the FLASH used by this inode */
+
+      volume->packpend = true;
+#endif
+    }
+#endif
 
 errout_with_entry:
   nxffs_freeentry(&entry);
@@ -180,7 +193,13 @@ int nxffs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   /* Then remove the NXFFS inode */
 
   ret = nxffs_rminode(volume, relpath);
-  
+#ifdef CONFIG_NXFFS_BGPACK
+  if (ret == OK)
+    {
+      nxffs_packcheck(volume);
+    }
+#endif
+
   sem_post(&volume->exclsem);
 errout:
   return ret;
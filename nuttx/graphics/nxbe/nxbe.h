@@ -42,6 +42,7 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -62,6 +63,24 @@
 #  define CONFIG_NX_NCOLORS 256
 #endif
 
+#ifdef CONFIG_NX_DAMAGE
+#  ifndef CONFIG_NX_NDAMAGE
+#    define CONFIG_NX_NDAMAGE 8     /* Max number of damaged regions per plane */
+#  endif
+#  ifndef CONFIG_NX_FRAMEPERIOD
+#    define CONFIG_NX_FRAMEPERIOD 20 /* Longest time (msec) between updates */
+#  endif
+#  ifndef CONFIG_NX_MULTIUSER
+#    error "Damage tracking requires the multi-user NX server"
+#  endif
+#  ifdef CONFIG_NX_MQZEROCOPY
+#    error "Damage tracking cannot be used with CONFIG_NX_MQZEROCOPY"
+#  endif
+#  if defined(CONFIG_NX_LCDDRIVER) && CONFIG_NX_NPLANES > 1
+#    error "Damage tracking supports only one LCD color plane"
+#  endif
+#endif
+
 /* NXBE Definitions *********************************************************/
 /* These are the values for the clipping order provided to nx_clipper */
 
@@ -83,6 +102,30 @@
  * Public Types
  ****************************************************************************/
 
+/* Damage tracking **********************************************************/
+
+/* With CONFIG_NX_DAMAGE, the rasterizers draw into a RAM shadow copy of each
+ * color plane instead of into the device.  The bounding boxes of everything
+ * drawn are collected in a short list of damaged regions and only those
+ * regions are copied to the device when the display is flushed.
+ */
+
+#ifdef CONFIG_NX_DAMAGE
+struct nxbe_damage_s
+{
+  FAR uint8_t *fbmem;               /* RAM shadow of the color plane */
+  size_t stride;                    /* Length of one shadow row in bytes */
+#ifdef CONFIG_NX_LCDDRIVER
+  int (*putrun)(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buffer,
+                size_t npixels);    /* The LCD driver's putrun method */
+#else
+  FAR uint8_t *devmem;              /* The real framebuffer memory */
+#endif
+  uint8_t ndamaged;                 /* Number of entries in damaged[] */
+  struct nxgl_rect_s damaged[CONFIG_NX_NDAMAGE];
+};
+#endif
+
 /* Rasterization ************************************************************/
 
 /* A tiny vtable of raster operation function pointers.  The types of the
@@ -118,6 +161,12 @@ struct nxbe_plane_s
   /* Framebuffer plane info describing destination video plane */
 
   NX_PLANEINFOTYPE pinfo;
+
+#ifdef CONFIG_NX_DAMAGE
+  /* The shadow plane and the regions not yet copied to the device */
+
+  struct nxbe_damage_s damage;
+#endif
 };
 
 /* Clipping *****************************************************************/
@@ -248,6 +297,66 @@ EXTERN int nxbe_colormap(FAR NX_DRIVERTYPE *dev);
 EXTERN int nxbe_configure(FAR NX_DRIVERTYPE *dev,
                           FAR struct nxbe_state_s *be);
 
+/****************************************************************************
+ * Name: nxbe_damageinit
+ *
+ * Description:
+ *   Allocate the RAM shadow of each color plane and redirect the
+ *   rasterizers to it.  Called by nxbe_configure().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_DAMAGE
+EXTERN int nxbe_damageinit(FAR struct nxbe_state_s *be);
+
+/****************************************************************************
+ * Name: nxbe_damageuninit
+ *
+ * Description:
+ *   Free the RAM shadow planes allocated by nxbe_damageinit().
+ *
+ ****************************************************************************/
+
+EXTERN void nxbe_damageuninit(FAR struct nxbe_state_s *be);
+
+/****************************************************************************
+ * Name: nxbe_damage
+ *
+ * Description:
+ *   Add a rectangle that was drawn into the shadow plane to the list of
+ *   regions to be copied to the device on the next nxbe_flush().
+ *
+ * Input Parameters:
+ *   plane - The color plane that was drawn
+ *   rect  - The region drawn (in absolute display coordinates)
+ *
+ ****************************************************************************/
+
+EXTERN void nxbe_damage(FAR struct nxbe_plane_s *plane,
+                        FAR const struct nxgl_rect_s *rect);
+
+/****************************************************************************
+ * Name: nxbe_damaged
+ *
+ * Description:
+ *   Return true if there are damaged regions waiting for nxbe_flush().
+ *
+ ****************************************************************************/
+
+EXTERN bool nxbe_damaged(FAR struct nxbe_state_s *be);
+
+/****************************************************************************
+ * Name: nxbe_flush
+ *
+ * Description:
+ *   Copy all damaged regions from the shadow planes to the device and
+ *   empty the list of damaged regions.
+ *
+ ****************************************************************************/
+
+EXTERN void nxbe_flush(FAR struct nxbe_state_s *be);
+#endif
+
 /****************************************************************************
  * Name: nxbe_closewindow
  *
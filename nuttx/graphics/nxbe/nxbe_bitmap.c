@@ -89,6 +89,9 @@ static void nxs_clipcopy(FAR struct nxbe_clipops_s *cops,
   struct nx_bitmap_s *bminfo = (struct nx_bitmap_s *)cops;
   plane->copyrectangle(&plane->pinfo, rect, bminfo->src,
                        &bminfo->origin, bminfo->stride);
+#ifdef CONFIG_NX_DAMAGE
+  nxbe_damage(plane, rect);
+#endif
 }
 
 /****************************************************************************
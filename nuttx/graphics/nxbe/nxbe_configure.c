@@ -215,5 +215,12 @@ int nxbe_configure(FAR NX_DRIVERTYPE *dev, FAR struct nxbe_state_s *be)
           return -ENOSYS;
         }
     }
+
+#ifdef CONFIG_NX_DAMAGE
+  /* Draw into RAM shadow planes and update the device from those */
+
+  return nxbe_damageinit(be);
+#else
   return OK;
+#endif
 }
@@ -0,0 +1,405 @@
+/****************************************************************************
+ * graphics/nxbe/nxbe_damage.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/nx/nxglib.h>
+
+#include "nxbe.h"
+
+#ifdef CONFIG_NX_DAMAGE
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* The shadow run and flush logic copies whole bytes */
+
+#if !defined(CONFIG_NX_DISABLE_1BPP) || !defined(CONFIG_NX_DISABLE_2BPP) || \
+    !defined(CONFIG_NX_DISABLE_4BPP)
+#  error "Damage tracking requires 8 or more bits per pixel"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The LCD run methods do not identify the device, so the shadow run methods
+ * can serve only one color plane of one display.
+ */
+
+#ifdef CONFIG_NX_LCDDRIVER
+static FAR struct nxbe_plane_s *g_lcdplane;
+#endif
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_putrun
+ *
+ * Description:
+ *   The LCD putrun method used by the rasterizers when damage tracking is
+ *   enabled.  The run is written to the RAM shadow plane only.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_LCDDRIVER
+static int nxbe_putrun(fb_coord_t row, fb_coord_t col,
+                       FAR const uint8_t *buffer, size_t npixels)
+{
+  FAR struct nxbe_plane_s *plane = g_lcdplane;
+  unsigned int bytespp = plane->pinfo.bpp >> 3;
+
+  memcpy(plane->damage.fbmem + row * plane->damage.stride + col * bytespp,
+         buffer, npixels * bytespp);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbe_getrun
+ *
+ * Description:
+ *   The LCD getrun method used by the rasterizers when damage tracking is
+ *   enabled.  The run is read from the RAM shadow plane so this works even
+ *   with write-only LCDs.
+ *
+ ****************************************************************************/
+
+static int nxbe_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
+                       size_t npixels)
+{
+  FAR struct nxbe_plane_s *plane = g_lcdplane;
+  unsigned int bytespp = plane->pinfo.bpp >> 3;
+
+  memcpy(buffer,
+         plane->damage.fbmem + row * plane->damage.stride + col * bytespp,
+         npixels * bytespp);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: nxbe_rectarea
+ ****************************************************************************/
+
+static inline uint32_t nxbe_rectarea(FAR const struct nxgl_rect_s *rect)
+{
+  return (uint32_t)(rect->pt2.x - rect->pt1.x + 1) *
+         (uint32_t)(rect->pt2.y - rect->pt1.y + 1);
+}
+
+/****************************************************************************
+ * Name: nxbe_flushrect
+ *
+ * Description:
+ *   Copy one damaged region from the shadow plane to the device
+ *
+ ****************************************************************************/
+
+static void nxbe_flushrect(FAR struct nxbe_plane_s *plane,
+                           FAR const struct nxgl_rect_s *rect)
+{
+  FAR struct nxbe_damage_s *damage = &plane->damage;
+  unsigned int bytespp = plane->pinfo.bpp >> 3;
+  unsigned int ncols   = rect->pt2.x - rect->pt1.x + 1;
+  size_t offset        = rect->pt1.y * damage->stride + rect->pt1.x * bytespp;
+  nxgl_coord_t row;
+
+  for (row = rect->pt1.y; row <= rect->pt2.y; row++)
+    {
+#ifdef CONFIG_NX_LCDDRIVER
+      (void)damage->putrun(row, rect->pt1.x, damage->fbmem + offset, ncols);
+#else
+      memcpy(damage->devmem + offset, damage->fbmem + offset,
+             ncols * bytespp);
+#endif
+      offset += damage->stride;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_damageinit
+ *
+ * Description:
+ *   Allocate the RAM shadow of each color plane and redirect the
+ *   rasterizers to it.  Called by nxbe_configure().
+ *
+ ****************************************************************************/
+
+int nxbe_damageinit(FAR struct nxbe_state_s *be)
+{
+  FAR struct nxbe_plane_s *plane;
+  size_t stride;
+  int i;
+
+  for (i = 0; i < be->vinfo.nplanes; i++)
+    {
+      plane  = &be->plane[i];
+#ifdef CONFIG_NX_LCDDRIVER
+      stride = (be->vinfo.xres * plane->pinfo.bpp + 7) >> 3;
+#else
+      stride = plane->pinfo.stride;
+#endif
+
+      /* Start from a cleared shadow.  The server paints the background
+       * over the whole display before anything else is drawn.
+       */
+
+      plane->damage.fbmem = (FAR uint8_t *)kzalloc(stride * be->vinfo.yres);
+      if (!plane->damage.fbmem)
+        {
+          gdbg("Failed to allocate the shadow of plane %d\n", i);
+          nxbe_damageuninit(be);
+          return -ENOMEM;
+        }
+
+      plane->damage.ndamaged = 0;
+
+#ifdef CONFIG_NX_LCDDRIVER
+      /* Route the LCD runs to the shadow.  The driver's own putrun is kept
+       * for nxbe_flush().
+       */
+
+      plane->damage.stride = stride;
+      plane->damage.putrun = plane->pinfo.putrun;
+      plane->pinfo.putrun  = nxbe_putrun;
+      plane->pinfo.getrun  = nxbe_getrun;
+      g_lcdplane           = plane;
+#else
+      /* The shadow uses the framebuffer stride so that the same offset
+       * addresses a pixel in both.
+       */
+
+      plane->damage.stride = stride;
+      plane->damage.devmem = (FAR uint8_t *)plane->pinfo.fbmem;
+      plane->pinfo.fbmem   = plane->damage.fbmem;
+#endif
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbe_damageuninit
+ *
+ * Description:
+ *   Free the RAM shadow planes allocated by nxbe_damageinit().  Nothing may
+ *   be drawn after this; it is called only when the server shuts down.
+ *
+ ****************************************************************************/
+
+void nxbe_damageuninit(FAR struct nxbe_state_s *be)
+{
+  FAR struct nxbe_plane_s *plane;
+  int i;
+
+  for (i = 0; i < be->vinfo.nplanes; i++)
+    {
+      plane = &be->plane[i];
+      if (plane->damage.fbmem)
+        {
+          kfree(plane->damage.fbmem);
+          plane->damage.fbmem = NULL;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxbe_damage
+ *
+ * Description:
+ *   Add a rectangle that was drawn into the shadow plane to the list of
+ *   regions to be copied to the device on the next nxbe_flush().
+ *
+ *   Two regions are combined whenever their bounding box is no larger than
+ *   the two regions together, so repeated drawing of the same area and
+ *   adjacent strips (text, borders) collapse into one region.  When the
+ *   list is full, the new region is combined with the region whose
+ *   bounding box grows least.
+ *
+ * Input Parameters:
+ *   plane - The color plane that was drawn
+ *   rect  - The region drawn (in absolute display coordinates)
+ *
+ ****************************************************************************/
+
+void nxbe_damage(FAR struct nxbe_plane_s *plane,
+                 FAR const struct nxgl_rect_s *rect)
+{
+  FAR struct nxbe_damage_s *damage = &plane->damage;
+  struct nxgl_rect_s region;
+  struct nxgl_rect_s bbox;
+  uint32_t area;
+  uint32_t growth;
+  uint32_t best;
+  int bestndx;
+  int i;
+
+  nxgl_rectcopy(&region, rect);
+  area = nxbe_rectarea(&region);
+
+  for (;;)
+    {
+      /* Absorb every region that the new region can be combined with.
+       * Combining makes the new region larger, so start over each time.
+       */
+
+      for (i = 0; i < damage->ndamaged; i++)
+        {
+          nxgl_rectunion(&bbox, &region, &damage->damaged[i]);
+          if (nxbe_rectarea(&bbox) <=
+              area + nxbe_rectarea(&damage->damaged[i]))
+            {
+              nxgl_rectcopy(&region, &bbox);
+              area = nxbe_rectarea(&region);
+
+              damage->ndamaged--;
+              nxgl_rectcopy(&damage->damaged[i],
+                            &damage->damaged[damage->ndamaged]);
+              i = -1;
+            }
+        }
+
+      if (damage->ndamaged < CONFIG_NX_NDAMAGE)
+        {
+          break;
+        }
+
+      /* The list is full.  Combine with the region that grows least and
+       * then see if the result absorbs any others.
+       */
+
+      best    = UINT32_MAX;
+      bestndx = 0;
+
+      for (i = 0; i < damage->ndamaged; i++)
+        {
+          nxgl_rectunion(&bbox, &region, &damage->damaged[i]);
+          growth = nxbe_rectarea(&bbox) - nxbe_rectarea(&damage->damaged[i]);
+          if (growth < best)
+            {
+              best    = growth;
+              bestndx = i;
+            }
+        }
+
+      nxgl_rectunion(&region, &region, &damage->damaged[bestndx]);
+      area = nxbe_rectarea(&region);
+
+      damage->ndamaged--;
+      nxgl_rectcopy(&damage->damaged[bestndx],
+                    &damage->damaged[damage->ndamaged]);
+    }
+
+  nxgl_rectcopy(&damage->damaged[damage->ndamaged], &region);
+  damage->ndamaged++;
+}
+
+/****************************************************************************
+ * Name: nxbe_damaged
+ *
+ * Description:
+ *   Return true if there are damaged regions waiting for nxbe_flush().
+ *
+ ****************************************************************************/
+
+bool nxbe_damaged(FAR struct nxbe_state_s *be)
+{
+  int i;
+
+  for (i = 0; i < be->vinfo.nplanes; i++)
+    {
+      if (be->plane[i].damage.ndamaged > 0)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: nxbe_flush
+ *
+ * Description:
+ *   Copy all damaged regions from the shadow planes to the device and
+ *   empty the list of damaged regions.
+ *
+ ****************************************************************************/
+
+void nxbe_flush(FAR struct nxbe_state_s *be)
+{
+  FAR struct nxbe_plane_s *plane;
+  int i;
+  int j;
+
+  for (i = 0; i < be->vinfo.nplanes; i++)
+    {
+      plane = &be->plane[i];
+      for (j = 0; j < plane->damage.ndamaged; j++)
+        {
+          nxbe_flushrect(plane, &plane->damage.damaged[j]);
+        }
+
+      plane->damage.ndamaged = 0;
+    }
+}
+
+#endif /* CONFIG_NX_DAMAGE */
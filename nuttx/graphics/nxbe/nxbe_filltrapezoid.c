@@ -86,6 +86,9 @@ static void nxbe_clipfilltrapezoid(FAR struct nxbe_clipops_s *cops,
 {
   struct nxbe_filltrap_s *fillinfo = (struct nxbe_filltrap_s *)cops;
   plane->filltrapezoid(&plane->pinfo, &fillinfo->trap, rect, fillinfo->color);
+#ifdef CONFIG_NX_DAMAGE
+  nxbe_damage(plane, rect);
+#endif
 }
 
 /****************************************************************************
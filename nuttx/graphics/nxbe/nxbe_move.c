@@ -90,6 +90,9 @@ static void nxbe_clipmovesrc(FAR struct nxbe_clipops_s *cops,
 {
   struct nxbe_move_s *info = (struct nxbe_move_s *)cops;
   struct nxgl_point_s offset;
+#ifdef CONFIG_NX_DAMAGE
+  struct nxgl_rect_s dest;
+#endif
 
   if (info->offset.x != 0 || info->offset.y != 0)
     {
@@ -99,6 +102,13 @@ static void nxbe_clipmovesrc(FAR struct nxbe_clipops_s *cops,
       offset.y = rect->pt1.y + info->offset.y;
 
       plane->moverectangle(&plane->pinfo, rect, &offset);
+
+#ifdef CONFIG_NX_DAMAGE
+      /* Only the destination region changed */
+
+      nxgl_rectoffset(&dest, rect, info->offset.x, info->offset.y);
+      nxbe_damage(plane, &dest);
+#endif
     }
 }
 
@@ -84,6 +84,9 @@ static void nxbe_clipfill(FAR struct nxbe_clipops_s *cops,
 {
   struct nxbe_setpixel_s *fillinfo = (struct nxbe_setpixel_s *)cops;
   plane->setpixel(&plane->pinfo, &rect->pt1, fillinfo->color);
+#ifdef CONFIG_NX_DAMAGE
+  nxbe_damage(plane, rect);
+#endif
 }
 
 /****************************************************************************
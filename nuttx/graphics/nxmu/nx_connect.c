@@ -168,7 +168,7 @@ NXHANDLE nx_connectinstance(FAR const char *svrmqname)
 
   attr.mq_maxmsg  = CONFIG_NX_MXSERVERMSGS;
   attr.mq_msgsize = NX_MXSVRMSGLEN;
-  attr.mq_flags   = 0;
+  attr.mq_flags   = NX_SVRMQ_FLAGS;
 
   conn->cwrmq = mq_open(svrmqname, O_WRONLY|O_CREAT, 0666, &attr);
   if (conn->cwrmq == (mqd_t)-1)
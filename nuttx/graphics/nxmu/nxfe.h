@@ -78,6 +78,14 @@
 #define NX_MXEVENTLEN        (64) /* Maximum size of an event */
 #define NX_MXCLIMSGLEN       (64) /* Maximum size of a server->client message */
 
+/* mq_flags used to create the server message queue */
+
+#ifdef CONFIG_NX_MQZEROCOPY
+#  define NX_SVRMQ_FLAGS     MQ_ZEROCOPY
+#else
+#  define NX_SVRMQ_FLAGS     0
+#endif
+
 /* Handy macros */
 
 #define nxmu_semgive(sem)    sem_post(sem) /* To match nxmu_semtake() */
@@ -171,6 +179,7 @@ enum nxmsg_e
   NX_SVRMSG_SETBGCOLOR,       /* Set the color of the background */
   NX_SVRMSG_MOUSEIN,          /* New mouse report from mouse client */
   NX_SVRMSG_KBDIN,            /* New keyboard report from keyboard client */
+  NX_SVRMSG_FLUSH,            /* Copy damaged regions to the device now */
 };
 
 /* Message priorities -- they must all be at the same priority to assure
@@ -437,6 +446,15 @@ struct nxsvrmsg_setbgcolor_s
   nxgl_mxpixel_t color[CONFIG_NX_NPLANES]; /* Color to use in the background */
 };
 
+/* Copy the damaged regions of the display to the device */
+
+#ifdef CONFIG_NX_DAMAGE
+struct nxsvrmsg_flush_s
+{
+  uint32_t  msgid;                 /* NX_SVRMSG_FLUSH */
+};
+#endif
+
 /* This message reports a new mouse event from a hardware controller attached to
  * the server as a regular client (this message may have even been sent from an
  * interrupt handler).
@@ -42,12 +42,14 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <semaphore.h>
 #include <mqueue.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/nx/nx.h>
 #include "nxfe.h"
 
@@ -55,6 +57,14 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+/* The number of clock ticks between updates of the display from the RAM
+ * shadow planes.
+ */
+
+#ifdef CONFIG_NX_DAMAGE
+#  define NX_FRAMETICKS MSEC2TICK(CONFIG_NX_FRAMEPERIOD)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -148,6 +158,12 @@ static inline void nxmu_shutdown(FAR struct nxfe_state_s *fe)
     {
        (void)nxmu_disconnect(wnd->conn);
     }
+
+#ifdef CONFIG_NX_DAMAGE
+  /* Release the RAM shadow planes */
+
+  nxbe_damageuninit(&fe->be);
+#endif
 }
 
 /****************************************************************************
@@ -212,7 +228,7 @@ static inline int nxmu_setup(FAR const char *mqname, FAR NX_DRIVERTYPE *dev,
 
   attr.mq_maxmsg  = CONFIG_NX_MXSERVERMSGS;
   attr.mq_msgsize = NX_MXSVRMSGLEN;
-  attr.mq_flags   = 0;
+  attr.mq_flags   = NX_SVRMQ_FLAGS;
 
   fe->conn.crdmq = mq_open(mqname, O_RDONLY|O_CREAT, 0666, &attr);
   if (fe->conn.crdmq == (mqd_t)-1)
@@ -293,9 +309,20 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
 {
   struct nxfe_state_s     fe;
   FAR struct nxsvrmsg_s *msg;
+#ifdef CONFIG_NX_MQZEROCOPY
+  FAR void              *buffer;
+#else
   uint8_t                buffer[NX_MXSVRMSGLEN];
+#endif
   int                    nbytes;
   int                    ret;
+#ifdef CONFIG_NX_DAMAGE
+  struct timespec        abstime;
+  uint32_t               frame = 0;
+  uint32_t               elapsed;
+  uint32_t               remaining;
+  bool                   pending = false;
+#endif
 
   /* Initialization *********************************************************/
 
@@ -327,12 +354,68 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
 
   for (;;)
     {
-       /* Receive the next server message */
+#ifdef CONFIG_NX_DAMAGE
+       /* Drawing goes to the RAM shadow planes.  The damaged regions are
+        * copied to the device NX_FRAMETICKS after the first change so that
+        * everything drawn in that time reaches the device in one update.
+        */
+
+       if (!nxbe_damaged(&fe.be))
+         {
+           pending = false;
+         }
+       else if (!pending)
+         {
+           frame   = clock_systimer();
+           pending = true;
+         }
+
+       if (pending)
+         {
+           elapsed = clock_systimer() - frame;
+           if (elapsed >= NX_FRAMETICKS)
+             {
+               nxbe_flush(&fe.be);
+               pending = false;
+               continue;
+             }
+
+           /* Wait for the next message only until the end of the frame */
+
+           remaining = TICK2USEC(NX_FRAMETICKS - elapsed);
+
+           (void)clock_gettime(CLOCK_REALTIME, &abstime);
+           abstime.tv_sec  += remaining / USEC_PER_SEC;
+           abstime.tv_nsec += (remaining % USEC_PER_SEC) * NSEC_PER_USEC;
+           if (abstime.tv_nsec >= NSEC_PER_SEC)
+             {
+               abstime.tv_sec++;
+               abstime.tv_nsec -= NSEC_PER_SEC;
+             }
+
+           nbytes = mq_timedreceive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0,
+                                    &abstime);
+         }
+       else
+#endif
+         {
+           /* Receive the next server message.  With CONFIG_NX_MQZEROCOPY,
+            * the message is processed in place and released after it is
+            * dispatched.
+            */
+
+#ifdef CONFIG_NX_MQZEROCOPY
+           nbytes = mq_receivebuffer(fe.conn.crdmq, &buffer, 0);
+#else
+           nbytes = mq_receive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0);
+#endif
+         }
 
-       nbytes = mq_receive(fe.conn.crdmq, buffer, NX_MXSVRMSGLEN, 0);
        if (nbytes < 0)
          {
-           if (errno != EINTR)
+           /* EINTR and, at the end of a frame, ETIMEDOUT are not errors */
+
+           if (errno != EINTR && errno != ETIMEDOUT)
              {
                gdbg("mq_receive failed: %d\n", errno);
                goto errout; /* mq_receive sets errno */
@@ -509,6 +592,14 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
            break;
 #endif
 
+#ifdef CONFIG_NX_DAMAGE
+         case NX_SVRMSG_FLUSH: /* Copy damaged regions to the device now */
+           {
+             nxbe_flush(&fe.be);
+           }
+           break;
+#endif
+
          /* Messages sent to the backgound window ***************************/
 
          case NX_CLIMSG_REDRAW: /* Re-draw the background window */
@@ -532,6 +623,12 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
            gdbg("Unrecognized command: %d\n", msg->msgid);
            break;
          }
+
+#ifdef CONFIG_NX_MQZEROCOPY
+       /* Return the message to the server message queue's pool */
+
+       (void)mq_releasebuffer(fe.conn.crdmq, buffer);
+#endif
     }
 
 errout:
@@ -40,6 +40,8 @@
  * Included Files
  ********************************************************************************/
 
+#include <nuttx/config.h>
+
 #include <sys/types.h>
 #include <signal.h>
 #include "queue.h"
@@ -54,6 +56,12 @@
 
 #define MQ_NONBLOCK O_NONBLOCK
 
+/* Non-standard mq_flags value:  Create the message queue with its own pool of
+ * message buffers for use with mq_getbuffer() and mq_receivebuffer().
+ */
+
+#define MQ_ZEROCOPY (1 << 15)
+
 /********************************************************************************
  * Global Type Declarations
  ********************************************************************************/
@@ -101,6 +109,21 @@ EXTERN int     mq_setattr(mqd_t mqdes, const struct mq_attr *mq_stat,
                   struct mq_attr *oldstat);
 EXTERN int     mq_getattr(mqd_t mqdes, struct mq_attr *mq_stat);
 
+/* Non-standard zero-copy interfaces.  The sender gets a buffer with
+ * mq_getbuffer(), fills it in place, and queues it with mq_sendbuffer().
+ * The receiver gets a pointer to the message with mq_receivebuffer() and
+ * must return it with mq_releasebuffer() before the message queue is
+ * closed.
+ */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+EXTERN FAR void *mq_getbuffer(mqd_t mqdes);
+EXTERN int     mq_sendbuffer(mqd_t mqdes, FAR void *buffer, size_t msglen,
+                             int prio);
+EXTERN ssize_t mq_receivebuffer(mqd_t mqdes, FAR void **buffer, int *prio);
+EXTERN int     mq_releasebuffer(mqd_t mqdes, FAR void *buffer);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
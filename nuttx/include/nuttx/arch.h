@@ -46,6 +46,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sched.h>
+#include <time.h>
 
 #include <arch/arch.h>
 
@@ -955,6 +956,93 @@ void up_udelay(useconds_t microseconds);
 void up_cxxinitialize(void);
 #endif
 
+/****************************************************************************
+ * Tickless OS Support.
+ *
+ * When CONFIG_SCHED_TICKLESS is enabled, there is no periodic system timer
+ * interrupt and sched_process_timer() is not called.  Instead, the
+ * platform-specific logic must provide a free-running time base and a
+ * one-shot interval timer with the following interfaces.  When the
+ * interval timer expires, the platform-specific logic must call
+ * sched_timer_expiration().
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_timer_initialize
+ *
+ * Description:
+ *   Initialize the time base and the interval timer.  This function is
+ *   called by the OS early in the boot sequence (from clock_initialize()).
+ *   The time base starts at zero and the interval timer is not running.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void up_timer_initialize(void);
+#endif
+
+/****************************************************************************
+ * Name: up_timer_gettime
+ *
+ * Description:
+ *   Return the elapsed time since up_timer_initialize() was called.  This
+ *   time is the basis of clock_systimer() in the tickless mode.
+ *
+ * Input Parameters:
+ *   ts - Location to return the elapsed time
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_gettime(FAR struct timespec *ts);
+#endif
+
+/****************************************************************************
+ * Name: up_timer_cancel
+ *
+ * Description:
+ *   Stop the interval timer (if it is running) and return the time that
+ *   was remaining until it would have expired.  sched_timer_expiration()
+ *   will not be called until up_timer_start() is called again.
+ *
+ * Input Parameters:
+ *   ts - Location to return the remaining time.  Zero is returned if the
+ *        timer was not running.  May be NULL.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_cancel(FAR struct timespec *ts);
+#endif
+
+/****************************************************************************
+ * Name: up_timer_start
+ *
+ * Description:
+ *   (Re-)start the interval timer.  sched_timer_expiration() will be
+ *   called once when the interval expires unless the timer is cancelled or
+ *   restarted first.  A zero interval requests an expiration as soon as
+ *   possible.
+ *
+ * Input Parameters:
+ *   ts - The interval until expiration
+ *
+ * Returned Value:
+ *   Zero (OK) on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+int up_timer_start(FAR const struct timespec *ts);
+#endif
+
 /****************************************************************************
  * These are standard interfaces that are exported by the OS
  * for use by the architecture specific logic
@@ -972,7 +1060,24 @@ void up_cxxinitialize(void);
  *
  ****************************************************************************/
 
+#ifndef CONFIG_SCHED_TICKLESS
 void sched_process_timer(void);
+#endif
+
+/****************************************************************************
+ * Name: sched_timer_expiration
+ *
+ * Description:
+ *   In the tickless mode, this function must be called by the platform-
+ *   specific logic when the interval timer started by up_timer_start()
+ *   expires.  Expired watchdogs and timeslices are then processed and the
+ *   interval timer is restarted for the next deadline (if any).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_TICKLESS
+void sched_timer_expiration(void);
+#endif
 
 /****************************************************************************
  * Name: irq_dispatch
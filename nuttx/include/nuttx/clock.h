@@ -121,6 +121,20 @@
 #define TICK2DSEC(tick)       (((tick)+(TICK_PER_DSEC/2))/TICK_PER_DSEC) /* Rounds */
 #define TICK2SEC(tick)        (((tick)+(TICK_PER_SEC/2))/TICK_PER_SEC)   /* Rounds */
 
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* This structure is used to report CPU usage for a particular thread */
+
+#ifdef CONFIG_SCHED_CPULOAD
+struct cpuload_s
+{
+  volatile uint32_t total;   /* Total number of clock ticks */
+  volatile uint32_t active;  /* Number of ticks while this thread was active */
+};
+#endif
+
 /****************************************************************************
  * Global Data
  ****************************************************************************/
@@ -131,10 +145,12 @@
 /* Direct access to the system timer/counter is supported only if (1) the
  * system timer counter is available (i.e., we are not configured to use
  * a hardware periodic timer), and (2) the execution environment has direct
- * access to kernel global data
+ * access to kernel global data.  In the tickless mode, the system timer
+ * counter is not incremented; the current tick count is derived from the
+ * platform time base instead.
  */
 
-#if __HAVE_KERNEL_GLOBALS
+#if __HAVE_KERNEL_GLOBALS && !defined(CONFIG_SCHED_TICKLESS)
 #  ifdef CONFIG_SYSTEM_TIME64
 
 extern volatile uint64_t g_system_timer;
@@ -211,7 +227,7 @@ EXTERN void clock_synchronize(void);
  *
  ****************************************************************************/
 
-#if !__HAVE_KERNEL_GLOBALS
+#if !__HAVE_KERNEL_GLOBALS || defined(CONFIG_SCHED_TICKLESS)
 #  ifdef CONFIG_SYSTEM_TIME64
 #    define clock_systimer()  (uint32_t)(clock_systimer64() & 0x00000000ffffffff)
 #  else
@@ -238,10 +254,35 @@ EXTERN uint32_t clock_systimer(void);
  *
  ****************************************************************************/
 
-#if !__HAVE_KERNEL_GLOBALS && defined(CONFIG_SYSTEM_TIME64)
+#if (!__HAVE_KERNEL_GLOBALS || defined(CONFIG_SCHED_TICKLESS)) && \
+    defined(CONFIG_SYSTEM_TIME64)
 EXTERN uint64_t clock_systimer64(void);
 #endif
 
+/****************************************************************************
+ * Function:  clock_cpuload
+ *
+ * Description:
+ *   Return load measurement data for the selected PID.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE
+ *         thread.
+ *   cpuload - The location to return the CPU load
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only reason
+ *   that this function can fail is if 'pid' no longer refers to a valid
+ *   thread (-ESRCH).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_CPULOAD
+EXTERN int clock_cpuload(int pid, FAR struct cpuload_s *cpuload);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -528,6 +528,23 @@ int file_dup2(int fd1, int fd2);
 #endif
 #endif
 
+/* fs_epoll.c ***************************************************************/
+/****************************************************************************
+ * Name: epoll_release
+ *
+ * Description:
+ *   Remove a file or socket from every epoll interest set.  Called when the
+ *   struct file or struct socket 'handle' is closed, before its driver is
+ *   closed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_EPOLL
+void epoll_release(FAR void *handle);
+#else
+#  define epoll_release(h)
+#endif
+
 /* fs_openblockdriver.c *****************************************************/
 /****************************************************************************
  * Name: open_blockdriver
@@ -630,6 +647,19 @@ void devnull_register(void);
 
 void devzero_register(void);
 
+/* drivers/dev_note.c *******************************************************/
+/****************************************************************************
+ * Name: devnote_register
+ *
+ * Description:
+ *   Register /dev/note
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DEV_NOTE
+void devnote_register(void);
+#endif
+
 /* drivers/loop.c ***********************************************************/
 /****************************************************************************
  * Name: losetup
@@ -122,6 +122,16 @@
 * OUT: Bytes writable to this fd
 */
 
+#define FIOC_RESERVE    _FIOC(0x0006)     /* IN:  File size (off_t) for which space
+                                           *      should be reserved
+                                           * OUT: None
+                                           */
+#define FIOC_PACKSTEP   _FIOC(0x0007)     /* IN:  Number of erase blocks to re-write
+                                           *      (int), zero for the default
+                                           * OUT: Returns one if more packing
+                                           *      steps are needed, zero if not
+                                           */
+
 /* NuttX file system ioctl definitions **************************************/
 
 #define _DIOCVALID(c)   (_IOC_TYPE(c)==_DIOCBASE)
@@ -186,6 +196,11 @@
                                            *      buffer address
                                            * OUT: None (ioctl return value provides
                                            *      success/failure indication). */
+#define BIOC_FLUSH      _BIOC(0x000a)     /* Write any data cached by the block
+                                           * driver back to the media
+                                           * IN:  None
+                                           * OUT: None (ioctl return value provides
+                                           *      success/failure indication). */
 
 /* NuttX MTD driver ioctl definitions ***************************************/
 
@@ -85,6 +85,36 @@
 #  define CONFIG_NXFFS_TAILTHRESHOLD (8*1024)
 #endif
 
+/* The volume may also be packed a step at a time.  A step re-writes about
+ * this number of erase blocks (see the FIOC_PACKSTEP ioctl).  A new pass
+ * through the volume is started only when fewer than
+ * CONFIG_NXFFS_PACKWATERMARK erase blocks remain free.
+ */
+
+#ifndef CONFIG_NXFFS_PACKSTEP
+#  define CONFIG_NXFFS_PACKSTEP 1
+#endif
+
+#ifndef CONFIG_NXFFS_PACKWATERMARK
+#  define CONFIG_NXFFS_PACKWATERMARK 4
+#endif
+
+#if CONFIG_NXFFS_PACKSTEP < 1
+#  error "CONFIG_NXFFS_PACKSTEP must be at least 1"
+#endif
+
+#if CONFIG_NXFFS_PACKWATERMARK < 1
+#  error "CONFIG_NXFFS_PACKWATERMARK must be at least 1"
+#endif
+
+/* With CONFIG_NXFFS_BGPACK, packing steps are performed on the low priority
+ * work queue.
+ */
+
+#if defined(CONFIG_NXFFS_BGPACK) && !defined(CONFIG_SCHED_LPWORK)
+#  error "CONFIG_NXFFS_BGPACK requires CONFIG_SCHED_LPWORK"
+#endif
+
 /* At present, only a single pre-allocated NXFFS volume is supported.  This
  * is because here can be only a single NXFFS volume mounted at any time.
  * This has to do with the fact that we bind to an MTD driver (instead of a
@@ -88,6 +88,7 @@ extern "C"
 #define kumm_addregion(h,s)      umm_addregion(h,s)
 #define kumm_trysemaphore()      umm_trysemaphore()
 #define kumm_givesemaphore()     umm_givesemaphore()
+#define kumm_cacheflush(c,n)     umm_cacheflush(c,n)
 
 #ifndef CONFIG_NUTTX_KERNEL
 /* In the flat build, the following are declared in stdlib.h and are
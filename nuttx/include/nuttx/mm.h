@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdbool.h>
 #include <semaphore.h>
 
 /****************************************************************************
@@ -113,6 +114,59 @@
 #define MM_IS_ALLOCATED(n) \
   ((int)((struct mm_allocnode_s*)(n)->preceding) < 0))
 
+/* Two-level segregated fit (TLSF) size classes.  Free chunks are binned
+ * first by the power of two of their size (the first level) and then by
+ * the next MM_SL_SHIFT bits of the size (the second level).  Chunks smaller
+ * than MM_SMALL_CHUNK are binned linearly in units of MM_MIN_CHUNK in the
+ * first level-zero bins.  Everything of size MM_MAX_CHUNK and above goes
+ * into the single, final first level bin.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#  ifndef CONFIG_MM_TLSF_SLBITS
+#    define CONFIG_MM_TLSF_SLBITS 3
+#  endif
+
+#  define MM_SL_SHIFT    CONFIG_MM_TLSF_SLBITS
+#  define MM_SL_COUNT    (1 << MM_SL_SHIFT)
+#  define MM_FL_SHIFT    (MM_SL_SHIFT + MM_MIN_SHIFT)
+#  define MM_FL_COUNT    (MM_MAX_SHIFT - MM_FL_SHIFT + 2)
+#  define MM_SMALL_CHUNK (1 << MM_FL_SHIFT)
+
+#  if MM_SL_SHIFT < 1 || MM_SL_SHIFT > 5
+#    error CONFIG_MM_TLSF_SLBITS must be in the range 1-5
+#  endif
+#endif
+
+/* Per-thread small allocation caches.  Chunks of up to
+ * CONFIG_MM_TASKCACHE_MAXSIZE bytes (including the chunk header) are cached
+ * in one class per MM_MIN_CHUNK multiple.
+ */
+
+#ifdef CONFIG_MM_TASKCACHE
+#  ifndef CONFIG_MM_TASKCACHE_MAXSIZE
+#    define CONFIG_MM_TASKCACHE_MAXSIZE 128
+#  endif
+
+#  ifndef CONFIG_MM_TASKCACHE_DEPTH
+#    define CONFIG_MM_TASKCACHE_DEPTH 16
+#  endif
+
+#  ifndef CONFIG_MM_TASKCACHE_BATCH
+#    define CONFIG_MM_TASKCACHE_BATCH 8
+#  endif
+
+#  if CONFIG_MM_TASKCACHE_BATCH > CONFIG_MM_TASKCACHE_DEPTH
+#    error CONFIG_MM_TASKCACHE_BATCH may not exceed CONFIG_MM_TASKCACHE_DEPTH
+#  endif
+
+#  if CONFIG_MM_TASKCACHE_MAXSIZE < MM_MIN_CHUNK
+#    error CONFIG_MM_TASKCACHE_MAXSIZE must be at least MM_MIN_CHUNK
+#  endif
+
+#  define MM_TASKCACHE_NCLASSES (CONFIG_MM_TASKCACHE_MAXSIZE / MM_MIN_CHUNK)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -199,13 +253,38 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_TLSF
+  /* Free nodes are kept in one doubly linked list per size class.  A bit
+   * is set in mm_flbitmap for each first level class with a non-empty
+   * second level class, and a bit is set in mm_slbitmap[fl] for each
+   * non-empty list in mm_freelist[fl][].
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_FL_COUNT];
+  FAR struct mm_freenode_s *mm_freelist[MM_FL_COUNT][MM_SL_COUNT];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+};
+
+/* This is the small allocation cache that is held in each TCB.  Each
+ * class is a stack of allocated chunks (all of the same size) that are
+ * linked through their first word.
+ */
+
+#ifdef CONFIG_MM_TASKCACHE
+struct mm_taskcache_s
+{
+  FAR void *tc_head[MM_TASKCACHE_NCLASSES];  /* Top of each stack */
+  uint8_t   tc_count[MM_TASKCACHE_NCLASSES]; /* Number of chunks in each */
 };
+#endif
 
 /****************************************************************************
  * Public Data
@@ -266,13 +345,13 @@ void umm_givesemaphore(void);
 
 /* Functions contained in mm_malloc.c ***************************************/
 
-#ifdef CONFIG_MM_MULTIHEAP
+#if defined(CONFIG_MM_MULTIHEAP) || defined(CONFIG_MM_TASKCACHE)
 FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size);
 #endif
 
 /* Functions contained in mm_free.c *****************************************/
 
-#ifdef CONFIG_MM_MULTIHEAP
+#if defined(CONFIG_MM_MULTIHEAP) || defined(CONFIG_MM_TASKCACHE)
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem);
 #endif
 
@@ -308,19 +387,47 @@ FAR void *mm_memalign(FAR struct mm_heap_s *heap, size_t alignment,
 int  mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info);
 #endif
 
+/* Functions contained in mm_taskcache.c ************************************/
+
+#ifdef CONFIG_MM_TASKCACHE
+FAR void *mm_cachealloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_cachefree(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_cacheflush(FAR struct mm_heap_s *heap,
+                   FAR struct mm_taskcache_s *cache, bool nonblocking);
+#endif
+
+/* Functions contained in mm_user.c *****************************************/
+
+#if defined(CONFIG_MM_TASKCACHE) && \
+   (!defined(CONFIG_NUTTX_KERNEL) || !defined(__KERNEL__))
+void umm_cacheflush(FAR struct mm_taskcache_s *cache, bool nonblocking);
+#endif
+
 /* Functions contained in mm_shrinkchunk.c **********************************/
 
 void mm_shrinkchunk(FAR struct mm_heap_s *heap,
                     FAR struct mm_allocnode_s *node, size_t size);
 
-/* Functions contained in mm_addfreechunk.c *********************************/
+/* Functions contained in mm_addfreechunk.c (or mm_tlsf.c) *****************/
 
 void mm_addfreechunk(FAR struct mm_heap_s *heap,
                      FAR struct mm_freenode_s *node);
 
+/* Functions contained in mm_remfreechunk.c (or mm_tlsf.c) *****************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap,
+                     FAR struct mm_freenode_s *node);
+
+#ifdef CONFIG_MM_TLSF
+/* Functions contained in mm_tlsf.c *****************************************/
+
+FAR struct mm_freenode_s *mm_findchunk(FAR struct mm_heap_s *heap,
+                                       size_t size);
+#else
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
 int mm_size2ndx(size_t size);
+#endif
 
 #undef EXTERN
 #ifdef __cplusplus
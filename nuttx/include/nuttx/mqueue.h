@@ -49,6 +49,7 @@
 #include <mqueue.h>
 #include <queue.h>
 #include <signal.h>
+#include <semaphore.h>
 
 #if CONFIG_MQ_MAXMSGSIZE > 0
 
@@ -73,8 +74,17 @@ struct msgq_s
   int16_t      nconnect;      /* Number of connections to message queue */
   int16_t      nwaitnotfull;  /* Number tasks waiting for not full */
   int16_t      nwaitnotempty; /* Number tasks waiting for not empty */
+#ifdef CONFIG_MQ_ZEROCOPY
+  uint16_t     maxmsgsize;    /* Max size of message in message queue */
+#else
   uint8_t      maxmsgsize;    /* Max size of message in message queue */
+#endif
   bool         unlinked;      /* true if the msg queue has been unlinked */
+#ifdef CONFIG_MQ_ZEROCOPY
+  FAR void    *pool;          /* Per-queue message buffers (NULL if none) */
+  sq_queue_t   poolfree;      /* List of free per-queue message buffers */
+  sem_t        poolsem;       /* Counts the free per-queue message buffers */
+#endif
 #ifndef CONFIG_DISABLE_SIGNALS
   FAR struct mq_des *ntmqdes; /* Notification: Owning mqdes (NULL if none) */
   pid_t        ntpid;         /* Notification: Receiving Task's PID */
@@ -0,0 +1,242 @@
+/****************************************************************************
+ * include/nuttx/net/iob.h
+ * Network I/O buffer (IOB) support
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_NET_IOB_H
+#define __INCLUDE_NUTTX_NET_IOB_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#ifdef CONFIG_NET_IOB
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_IOB_NBUFFERS
+#  define CONFIG_IOB_NBUFFERS 24
+#endif
+
+#ifndef CONFIG_IOB_BUFSIZE
+#  define CONFIG_IOB_BUFSIZE 196
+#endif
+
+/* The length of a chain is held in 16 bits (io_pktlen).  No chain can be
+ * longer than the whole pool.
+ */
+
+#if CONFIG_IOB_NBUFFERS * CONFIG_IOB_BUFSIZE > 65535
+#  error "CONFIG_IOB_NBUFFERS * CONFIG_IOB_BUFSIZE must be less than 64 KiB"
+#endif
+
+/* Queue helpers */
+
+#define IOB_QINIT(q)   do { (q)->qh_head = NULL; (q)->qh_tail = NULL; } while (0)
+#define IOB_QEMPTY(q)  ((q)->qh_head == NULL)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One I/O buffer.  Data that does not fit in one buffer is held in a chain
+ * of buffers linked through io_flink.  The valid data in each buffer is
+ * the io_len bytes beginning at io_data[io_offset].  Data is removed from
+ * the front of a chain by advancing io_offset, not by moving the data that
+ * remains.  Only the last buffer of a chain can grow;  the others may be
+ * partly empty (for example, when a received frame is trimmed to its
+ * payload or when chains are joined by iob_concat()).
+ *
+ * io_pktlen and io_qlink are meaningful only in the first buffer of a
+ * chain.
+ */
+
+struct iob_s
+{
+  FAR struct iob_s *io_flink;  /* Next buffer in this chain */
+  FAR struct iob_s *io_qlink;  /* Next chain in an I/O buffer queue */
+  uint16_t io_len;             /* Number of valid bytes in this buffer */
+  uint16_t io_offset;          /* Offset to the first valid byte */
+  uint16_t io_pktlen;          /* Number of valid bytes in the chain */
+  uint8_t  io_data[CONFIG_IOB_BUFSIZE];
+};
+
+/* A FIFO of I/O buffer chains */
+
+struct iob_queue_s
+{
+  FAR struct iob_s *qh_head;   /* First chain in the queue */
+  FAR struct iob_s *qh_tail;   /* Last chain in the queue */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: iob_initialize
+ *
+ * Description:
+ *   Set up the pool of I/O buffers.  Called once from uip_initialize().
+ *
+ ****************************************************************************/
+
+EXTERN void iob_initialize(void);
+
+/****************************************************************************
+ * Name: iob_alloc
+ *
+ * Description:
+ *   Take one empty I/O buffer from the pool.  Returns NULL if the pool is
+ *   exhausted; this function never waits and may be called from interrupt
+ *   handlers.
+ *
+ ****************************************************************************/
+
+EXTERN FAR struct iob_s *iob_alloc(void);
+
+/****************************************************************************
+ * Name: iob_free and iob_free_chain
+ *
+ * Description:
+ *   Return one I/O buffer to the pool and return the next buffer in its
+ *   chain, or return every buffer in a chain to the pool.
+ *
+ ****************************************************************************/
+
+EXTERN FAR struct iob_s *iob_free(FAR struct iob_s *iob);
+EXTERN void iob_free_chain(FAR struct iob_s *iob);
+
+/****************************************************************************
+ * Name: iob_copyin
+ *
+ * Description:
+ *   Copy 'len' bytes from 'src' into the chain beginning with 'iob',
+ *   starting 'offset' bytes into the data.  'offset' may be no larger than
+ *   the length of the data in the chain, and the chain is extended with
+ *   buffers from the pool as needed.
+ *
+ * Returned Value:
+ *   OK on success.  -ENOMEM if there were not enough free buffers; in that
+ *   case, the chain is not changed.
+ *
+ ****************************************************************************/
+
+EXTERN int iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
+                      unsigned int len, unsigned int offset);
+
+/****************************************************************************
+ * Name: iob_copyout
+ *
+ * Description:
+ *   Copy up to 'len' bytes of data beginning 'offset' bytes into the chain
+ *   to 'dest'.  Returns the number of bytes copied.
+ *
+ ****************************************************************************/
+
+EXTERN unsigned int iob_copyout(FAR uint8_t *dest, FAR const struct iob_s *iob,
+                                unsigned int len, unsigned int offset);
+
+/****************************************************************************
+ * Name: iob_trimhead
+ *
+ * Description:
+ *   Remove 'trimlen' bytes from the beginning of the chain, freeing the
+ *   buffers that become empty.  Returns the new first buffer of the chain,
+ *   or NULL if no data remains.
+ *
+ ****************************************************************************/
+
+EXTERN FAR struct iob_s *iob_trimhead(FAR struct iob_s *iob,
+                                      unsigned int trimlen);
+
+/****************************************************************************
+ * Name: iob_trimtail
+ *
+ * Description:
+ *   Remove 'trimlen' bytes from the end of the chain, freeing the buffers
+ *   that become empty.  Returns the first buffer of the chain, or NULL if
+ *   no data remains.
+ *
+ ****************************************************************************/
+
+EXTERN FAR struct iob_s *iob_trimtail(FAR struct iob_s *iob,
+                                      unsigned int trimlen);
+
+/****************************************************************************
+ * Name: iob_concat
+ *
+ * Description:
+ *   Append the chain 'iob2' to the end of the chain 'iob1' without copying
+ *   any data.
+ *
+ ****************************************************************************/
+
+EXTERN void iob_concat(FAR struct iob_s *iob1, FAR struct iob_s *iob2);
+
+/****************************************************************************
+ * Name: iob_add_queue, iob_remove_queue, and iob_free_queue
+ *
+ * Description:
+ *   Add a chain to the end of a queue, remove the chain at the head of a
+ *   queue (NULL if the queue is empty), or free every chain in a queue.
+ *
+ ****************************************************************************/
+
+EXTERN void iob_add_queue(FAR struct iob_s *iob, FAR struct iob_queue_s *qh);
+EXTERN FAR struct iob_s *iob_remove_queue(FAR struct iob_queue_s *qh);
+EXTERN void iob_free_queue(FAR struct iob_queue_s *qh);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_NET_IOB */
+#endif /* __INCLUDE_NUTTX_NET_IOB_H */
@@ -58,6 +58,7 @@
 #endif
 
 #include <nuttx/net/uip/uipopt.h>
+#include <nuttx/net/iob.h>
 #include <net/ethernet.h>
 
 /****************************************************************************
@@ -169,6 +170,29 @@ struct uip_driver_s
 
   uint16_t d_sndlen;
 
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+  /* The checksum of the d_sndlen bytes at d_snddata, calculated by
+   * uip_send() while it copied them in.  Zero if there is none.
+   */
+
+  uint16_t d_sndsum;
+#endif
+
+#ifdef CONFIG_NET_IOB
+  /* d_iob holds the received frame while a driver that receives into I/O
+   * buffers passes it to uIP (see uip_iobreceive()).  TCP and UDP may keep
+   * the data of the frame by taking the chain, leaving d_iob NULL.
+   */
+
+  FAR struct iob_s *d_iob;
+
+  /* Outgoing frames queued by uip_iobtxqueue() for drivers that can send
+   * several frames at a time.
+   */
+
+  struct iob_queue_s d_txq;
+#endif
+
   /* IGMP group list */
 
 #ifdef CONFIG_NET_IGMP
@@ -251,6 +275,42 @@ struct uip_driver_s
 
 extern void uip_input(struct uip_driver_s *dev);
 
+/* Receive into and send from chains of I/O buffers
+ *
+ * A driver may receive a frame into a chain of I/O buffers instead of
+ * into d_buf.  uip_iobreceive() copies the frame into d_buf, where uIP
+ * parses it and builds any reply, and attaches the chain to the device as
+ * d_iob.  The driver then processes d_buf as usual (uip_arp_ipin(),
+ * uip_input(), ...) and finally calls uip_iobrelease().  Data that TCP or
+ * UDP keeps for a socket that is not reading is then taken from the chain
+ * by reference instead of being copied again.  uip_iobreceive() returns
+ * -E2BIG, and does not take the chain, if the frame is larger than d_buf.
+ *
+ * uip_iobtxqueue() copies the outgoing packet in d_buf (d_len bytes) into
+ * a new chain and adds it to d_txq, so that a driver can keep polling
+ * for more packets and send the queued frames later, taking them from the
+ * queue with iob_remove_queue().  It returns -ENOMEM if there are not
+ * enough free I/O buffers;  the driver must then send the queued frames
+ * and d_buf itself.
+ *
+ *   iob = <frame received into a chain>;
+ *   if (uip_iobreceive(dev, iob) == OK)
+ *     {
+ *       uip_input(dev);
+ *       if (dev->d_len > 0 && uip_iobtxqueue(dev) < 0)
+ *         {
+ *           <send d_txq and d_buf>;
+ *         }
+ *       uip_iobrelease(dev);
+ *     }
+ */
+
+#ifdef CONFIG_NET_IOB
+extern int uip_iobreceive(FAR struct uip_driver_s *dev, FAR struct iob_s *iob);
+extern void uip_iobrelease(FAR struct uip_driver_s *dev);
+extern int uip_iobtxqueue(FAR struct uip_driver_s *dev);
+#endif
+
 /* Polling of connections
  *
  * These functions will traverse each active uIP connection structure and
@@ -341,6 +401,20 @@ extern void uip_incr32(uint8_t *op32, uint16_t op16);
 
 extern uint16_t uip_chksum(uint16_t *buf, uint16_t len);
 
+/* Copy a buffer and calculate its checksum in the same pass.
+ *
+ * dest and src - The buffers to copy to and from.  They must not overlap.
+ *
+ * len - The number of bytes to copy.
+ *
+ * Return:  The one's complement sum of the 16-bit big-endian words in the
+ * buffer in host byte order.  This is not complemented and, unlike
+ * uip_chksum(), not converted to network byte order.
+ */
+
+extern uint16_t uip_copychksum(FAR uint8_t *dest, FAR const uint8_t *src,
+                               uint16_t len);
+
 /* Calculate the IP header checksum of the packet header in d_buf.
  *
  * The IP header checksum is the Internet checksum of the 20 bytes of
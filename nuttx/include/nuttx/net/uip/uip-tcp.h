@@ -120,10 +120,15 @@
 struct uip_driver_s;      /* Forward reference */
 struct uip_callback_s;    /* Forward reference */
 struct uip_backlog_s;     /* Forward reference */
+struct iob_s;             /* Forward reference */
 
 struct uip_conn
 {
   dq_entry_t node;        /* Implements a doubly linked list */
+#ifdef CONFIG_NET_HASHCONN
+  struct uip_conn *hnext; /* Next in the active connection hash chain */
+  struct uip_conn *pnext; /* Next in the local port hash chain */
+#endif
   uip_ipaddr_t ripaddr;   /* The IP address of the remote host */
   uint16_t lport;         /* The local TCP port, in network byte order */
   uint16_t rport;         /* The remoteTCP port, in network byte order */
@@ -149,12 +154,35 @@ struct uip_conn
   /* Read-ahead buffering.
    *
    * readahead - A singly linked list of type struct uip_readahead_s
-   *   where the TCP/IP read-ahead data is retained.
+   *   where the TCP/IP read-ahead data is retained.  With CONFIG_NET_IOB,
+   *   a chain of I/O buffers that holds the read-ahead data instead.
    */
 
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#ifdef CONFIG_NET_IOB
+  struct iob_s *readahead; /* Read-ahead buffering */
+#else
   sq_queue_t readahead;   /* Read-ahead buffering */
 #endif
+#endif
+
+  /* Write buffering
+   *
+   * write_q - A singly linked list of type struct uip_wrbuffer_s that
+   *   holds buffered, outgoing TCP/IP data in sequence number order.
+   *   Buffers are retained in this list until all of their data has
+   *   been acknowledged by the peer.
+   * winsize - The window size most recently advertised by the peer.
+   * sndcb - The callback that sends from write_q.  It belongs to the
+   *   connection, not to a socket, so that buffered data is still sent
+   *   after one of several sockets sharing the connection is closed.
+   */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  sq_queue_t write_q;     /* Write buffering for segments not yet ACKed */
+  uint16_t winsize;       /* Current peer receive window size */
+  FAR struct uip_callback_s *sndcb; /* Write buffer send callback */
+#endif
 
   /* Listen backlog support
    *
@@ -214,7 +242,7 @@ struct uip_conn
  * buffers so that no data is lost.
  */
 
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
 struct uip_readahead_s
 {
   sq_entry_t rh_node;      /* Supports a singly linked list */
@@ -223,6 +251,22 @@ struct uip_readahead_s
 };
 #endif
 
+/* The following structure is used to handle write buffering for TCP
+ * connections.  Outgoing data is copied into these buffers by send() and
+ * is retained until it has been acknowledged by the peer so that it may
+ * be retransmitted if necessary.
+ */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+struct uip_wrbuffer_s
+{
+  sq_entry_t wb_node;      /* Supports a singly linked list */
+  uint32_t wb_seqno;       /* Sequence number of the first byte in the buffer */
+  uint16_t wb_nbytes;      /* Number of bytes available in this buffer */
+  uint8_t  wb_buffer[CONFIG_NET_TCP_WRITE_BUFSIZE];
+};
+#endif
+
 /* Support for listen backlog:
  *
  *   struct uip_blcontainer_s describes one backlogged connection
@@ -381,10 +425,17 @@ extern int uip_unlisten(struct uip_conn *conn);
 
 /* Access to TCP read-ahead buffers */
 
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
 extern struct uip_readahead_s *uip_tcpreadaheadalloc(void);
 extern void uip_tcpreadaheadrelease(struct uip_readahead_s *buf);
-#endif /* CONFIG_NET_NTCP_READAHEAD_BUFFERS */
+#endif /* CONFIG_NET_NTCP_READAHEAD_BUFFERS && !CONFIG_NET_IOB */
+
+/* Access to TCP write buffers */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+extern FAR struct uip_wrbuffer_s *uip_tcpwrbufferalloc(void);
+extern void uip_tcpwrbufferrelease(FAR struct uip_wrbuffer_s *wrb);
+#endif /* CONFIG_NET_TCP_WRITE_BUFFERS */
 
 /* Backlog support */
 
@@ -53,6 +53,7 @@
 
 #include <stdint.h>
 #include <nuttx/net/uip/uipopt.h>
+#include <nuttx/net/iob.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -74,12 +75,31 @@ struct uip_callback_s;    /* Forward reference */
 struct uip_udp_conn
 {
   dq_entry_t node;        /* Supports a doubly linked list */
+#ifdef CONFIG_NET_HASHCONN
+  struct uip_udp_conn *hnext; /* Next in the active connection hash chain */
+  struct uip_udp_conn *pnext; /* Next in the local port hash chain */
+#endif
   uip_ipaddr_t ripaddr;   /* The IP address of the remote peer */
   uint16_t lport;         /* The local port number in network byte order */
   uint16_t rport;         /* The remote port number in network byte order */
   uint8_t  ttl;           /* Default time-to-live */
   uint8_t  crefs;         /* Reference counts on this instance */
 
+  /* Read-ahead buffering.
+   *
+   * readahead - A queue of I/O buffer chains, each holding one datagram
+   *   that arrived when no receiver was waiting for it.
+   * nreadahead - The number of datagrams in readahead.
+   * nenabled - The number of uip_udpenable() calls not yet undone by
+   *   uip_udpdisable().  The connection is active while this is non-zero.
+   */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  struct iob_queue_s readahead;
+  uint8_t  nreadahead;
+  uint8_t  nenabled;
+#endif
+
   /* Defines the list of UDP callbacks */
 
   struct uip_callback_s *list;
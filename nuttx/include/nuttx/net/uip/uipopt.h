@@ -170,6 +170,14 @@
 
 #define UIP_UDP_MSS (CONFIG_NET_BUFSIZE - UIP_LLH_LEN - UIP_IPUDPH_LEN)
 
+/* The maximum number of datagrams held for each UDP socket while no one is
+ * receiving (CONFIG_NET_UDP_READAHEAD only)
+ */
+
+#ifndef CONFIG_NET_UDP_NREADAHEAD
+#  define CONFIG_NET_UDP_NREADAHEAD 4
+#endif
+
 /* TCP configuration options */
 
 /* The maximum number of simultaneously open TCP connections.
@@ -205,6 +213,19 @@
 # define CONFIG_NET_NACTIVESOCKETS (CONFIG_NET_TCP_CONNS + CONFIG_NET_UDP_CONNS)
 #endif
 
+/* The number of buckets in each connection hash table (must be a power
+ * of two).
+ */
+
+#ifdef CONFIG_NET_HASHCONN
+# ifndef CONFIG_NET_HASHCONN_SIZE
+#  define CONFIG_NET_HASHCONN_SIZE 16
+# endif
+# if (CONFIG_NET_HASHCONN_SIZE & (CONFIG_NET_HASHCONN_SIZE - 1)) != 0
+#  error CONFIG_NET_HASHCONN_SIZE must be a power of two
+# endif
+#endif
+
 /* The initial retransmission timeout counted in timer pulses.
  *
  * This should not be changed.
@@ -303,6 +324,26 @@
 #  endif
 #endif
 
+/* The most I/O buffers that the read-ahead data of one TCP connection may
+ * hold (CONFIG_NET_IOB only)
+ */
+
+#ifndef CONFIG_NET_TCP_READAHEAD_NIOBS
+#  define CONFIG_NET_TCP_READAHEAD_NIOBS 16
+#endif
+
+/* Number and size of TCP write buffers */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+#  ifndef CONFIG_NET_NTCP_WRITE_BUFFERS
+#    define CONFIG_NET_NTCP_WRITE_BUFFERS 8
+#  endif
+
+#  ifndef CONFIG_NET_TCP_WRITE_BUFSIZE
+#    define CONFIG_NET_TCP_WRITE_BUFSIZE UIP_TCP_MSS
+#  endif
+#endif
+
 /* Delay after receive to catch a following packet.  No delay should be
  * required if TCP/IP read-ahead buffering is enabled.
  */
@@ -866,6 +866,28 @@ EXTERN int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
                      FAR const struct nxgl_point_s *origin,
                      unsigned int stride);
 
+/****************************************************************************
+ * Name: nx_flush
+ *
+ * Description:
+ *   With CONFIG_NX_DAMAGE, the server draws into a RAM shadow of the
+ *   display and copies the changed regions to the device once per
+ *   CONFIG_NX_FRAMEPERIOD milliseconds.  A client that draws in frames may
+ *   call nx_flush() at the end of each frame to have the device updated
+ *   right away.
+ *
+ * Input Parameters:
+ *   handle - The connection handle
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_DAMAGE
+EXTERN int nx_flush(NXHANDLE handle);
+#endif
+
 /****************************************************************************
  * Name: nx_kbdin
  *
@@ -181,6 +181,7 @@ EXTERN ssize_t rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock,
 EXTERN ssize_t rwb_write(FAR struct rwbuffer_s *rwb,
                          off_t startblock, size_t blockcount,
                          FAR const uint8_t *wrbuffer);
+EXTERN int rwb_flush(FAR struct rwbuffer_s *rwb);
 EXTERN int rwb_mediaremoved(FAR struct rwbuffer_s *rwb);
 
 #undef EXTERN
@@ -52,6 +52,7 @@
 #include <time.h>
 
 #include <nuttx/irq.h>
+#include <nuttx/mm.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/net/net.h>
 
@@ -461,6 +462,9 @@ struct tcb_s
 
 #if CONFIG_RR_INTERVAL > 0
   int      timeslice;                    /* RR timeslice interval remaining     */
+#endif
+#ifdef CONFIG_SCHED_CPULOAD
+  uint32_t ticks;                        /* Number of ticks on this thread      */
 #endif
   FAR struct wdog_s *waitdog;            /* All timed waits used this wdog      */
 
@@ -507,6 +511,10 @@ struct tcb_s
 
   int pterrno;                           /* Current per-thread errno            */
 
+#ifdef CONFIG_MM_TASKCACHE
+  struct mm_taskcache_s mmcache;         /* Cache of small, free heap chunks    */
+#endif
+
   /* State save areas ***********************************************************/
   /* The form and content of these fields are processor-specific.               */
 
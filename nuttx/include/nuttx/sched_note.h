@@ -0,0 +1,140 @@
+/****************************************************************************
+ * include/nuttx/sched_note.h
+ * Scheduler instrumentation notes
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_SCHED_NOTE_H
+#define __INCLUDE_NUTTX_SCHED_NOTE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_BUFFER
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+/* CONFIG_SCHED_INSTRUMENTATION_BUFFER - The OS provides the scheduler
+ *   instrumentation functions and saves each event in a circular buffer.
+ * CONFIG_SCHED_NOTE_NENTRIES - The number of notes in the circular buffer.
+ *   Default: 256
+ */
+
+#ifndef CONFIG_SCHED_NOTE_NENTRIES
+#  define CONFIG_SCHED_NOTE_NENTRIES 256
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* This type identifies the event described by a note */
+
+enum note_type_e
+{
+  NOTE_START = 0,                 /* A task or thread was started */
+  NOTE_STOP,                      /* A task or thread was stopped */
+  NOTE_SWITCH,                    /* Another thread is now running */
+  NOTE_IRQHANDLER,                /* An interrupt handler was entered */
+  NOTE_SEMBLOCK                   /* A thread blocked on a semaphore */
+};
+
+/* This is the form of one note.  nt_pid and nt_priority describe the thread
+ * that the note is about:  The thread that was started or stopped, the new
+ * running thread (NOTE_SWITCH), the interrupted thread (NOTE_IRQHANDLER),
+ * or the thread that blocked (NOTE_SEMBLOCK).  nt_arg holds the ID of the
+ * thread that was running before (NOTE_SWITCH), the IRQ number
+ * (NOTE_IRQHANDLER), or the address of the semaphore (NOTE_SEMBLOCK).
+ */
+
+struct note_s
+{
+  uint8_t   nt_type;              /* See enum note_type_e */
+  uint8_t   nt_priority;          /* Priority of the thread */
+  pid_t     nt_pid;               /* ID of the thread */
+  uint32_t  nt_systime;           /* Time of the event (system timer ticks) */
+  uintptr_t nt_arg;               /* Depends on nt_type (see above) */
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_note_read
+ *
+ * Description:
+ *   Remove the oldest notes from the circular buffer and copy them to the
+ *   caller's buffer.  This function does not wait for notes;  it returns
+ *   zero if the buffer is empty.
+ *
+ * Input Parameters:
+ *   buffer - The location to return the notes
+ *   nnotes - The maximum number of notes to return
+ *
+ * Returned Value:
+ *   The number of notes returned.
+ *
+ ****************************************************************************/
+
+EXTERN size_t sched_note_read(FAR struct note_s *buffer, size_t nnotes);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ASSEMBLY__ */
+#endif /* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
+#endif /* __INCLUDE_NUTTX_SCHED_NOTE_H */
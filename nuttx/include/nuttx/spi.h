@@ -59,6 +59,9 @@
  *   to distinguish command transfers from data transfers.  Such devices
  *   will often support either 9-bit SPI (yech) or 8-bit SPI and a GPIO
  *   output that selects between command and data.
+ * CONFIG_SPI_QUEUE - Build the SPI transaction queue (drivers/spi/
+ *   spi_queue.c).  Requires CONFIG_SPI_EXCHANGE, CONFIG_SCHED_WORKQUEUE, and
+ *   CONFIG_SCHED_LPWORK.
  */
 
 /* Access macros ************************************************************/
@@ -335,10 +338,45 @@
 #define SPI_REGISTERCALLBACK(d,c,a) \
   ((d)->ops->registercallback ? (d)->ops->registercallback(d,c,a) : -ENOSYS)
 
+/****************************************************************************
+ * Name: SPI_CHAIN
+ *
+ * Description:
+ *   Start a chain of transactions and return without waiting.  Optional;
+ *   this method is only used by the SPI transaction queue, and is meant for
+ *   drivers that can carry out the whole chain with DMA.  For each
+ *   transaction in turn, the driver selects the device (unless the
+ *   previous transaction left it selected), sets the mode, word size, and
+ *   frequency, exchanges the data, sets the result field, and de-selects
+ *   the device unless SPI_TRANSFLAG_KEEPCS is set.  When the last
+ *   transaction has completed, the driver calls done(dev, arg), normally
+ *   from its interrupt handler.  The driver does not call the callbacks of
+ *   the transactions.  The bus is locked until done() is called;  done()
+ *   unlocks it, so the lock method must not wait when unlocking.
+ *
+ * Input Parameters:
+ *   dev   - Device-specific state data
+ *   first - The first transaction;  the rest are linked through flink
+ *   done  - The function to call when the chain has completed
+ *   arg   - The argument to pass to done()
+ *
+ * Returned Value:
+ *   OK if the chain was started; a negated errno value if not (done() is
+ *   then not called).  -ENOSYS if the driver does not support chains.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SPI_QUEUE
+#  define SPI_CHAIN(d,f,c,a) \
+  ((d)->ops->chain ? (d)->ops->chain(d,f,c,a) : -ENOSYS)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+struct spi_dev_s;
+
 /* The type of the media change callback function */
 
 typedef void (*spi_mediachange_t)(FAR void *arg);
@@ -372,9 +410,50 @@ enum spi_mode_e
   SPIDEV_MODE3        /* CPOL=1 CHPHA=1 */
 };
 
+#ifdef CONFIG_SPI_QUEUE
+/* One SPI transaction for the SPI transaction queue.  The device is
+ * selected, the bus is configured with the given mode, word size, and
+ * frequency, nwords words are exchanged, and the device is de-selected.
+ *
+ * If SPI_TRANSFLAG_KEEPCS is set, the device is left selected and the next
+ * transaction (which must be for the same device and must be submitted in
+ * the same call to spi_queue_submit()) continues the same chip select
+ * sequence.  This is how, for example, a register address and the register
+ * data are sent as two transactions.
+ */
+
+#define SPI_TRANSFLAG_KEEPCS (1 << 0) /* Leave the device selected */
+
+struct spi_trans_s;
+typedef void (*spi_transcallback_t)(FAR struct spi_trans_s *trans);
+
+struct spi_trans_s
+{
+  FAR struct spi_trans_s *flink; /* Next transaction in the list */
+  enum spi_dev_e devid;          /* The device to select */
+  enum spi_mode_e mode;          /* The SPI mode (see SPI_SETMODE) */
+  int8_t   nbits;                /* Bits per word (see SPI_SETBITS) */
+  uint8_t  flags;                /* See SPI_TRANSFLAG_* definitions */
+  uint32_t frequency;            /* The SPI frequency */
+  FAR const void *txbuffer;      /* Data to send (see SPI_EXCHANGE) */
+  FAR void *rxbuffer;            /* Buffer for received data (or NULL) */
+  size_t   nwords;               /* Number of words to exchange */
+  spi_transcallback_t callback;  /* Called when the transaction completes */
+  FAR void *arg;                 /* For use by the callback */
+  int      result;               /* OK or a negated errno value */
+};
+
+/* Called by the SPI driver when it has completed a chain of transactions */
+
+typedef void (*spi_chaindone_t)(FAR struct spi_dev_s *dev, FAR void *arg);
+
+/* The transaction queue (see spi_queue_initialize()) */
+
+struct spi_queue_s;
+#endif
+
 /* The SPI vtable */
 
-struct spi_dev_s;
 struct spi_ops_s
 {
 #ifndef CONFIG_SPI_OWNBUS
@@ -401,6 +480,10 @@ struct spi_ops_s
 #endif
   int     (*registercallback)(FAR struct spi_dev_s *dev, spi_mediachange_t callback,
                               void *arg);
+#ifdef CONFIG_SPI_QUEUE
+  int     (*chain)(FAR struct spi_dev_s *dev, FAR struct spi_trans_s *first,
+                   spi_chaindone_t done, FAR void *arg);
+#endif
 };
 
 /* SPI private data.  This structure only defines the initial fields of the
@@ -462,6 +545,71 @@ extern "C"
 
 FAR struct spi_dev_s *up_spiinitialize(int port);
 
+#ifdef CONFIG_SPI_QUEUE
+/****************************************************************************
+ * Name: spi_queue_initialize
+ *
+ * Description:
+ *   Create a transaction queue for one SPI bus (drivers/spi/spi_queue.c).
+ *   Transactions submitted to the queue are carried out in order.  If the
+ *   SPI driver provides the chain method, each group of transactions
+ *   waiting in the queue is handed to the driver at once and the driver
+ *   reports when the last one has completed (for example, from a DMA
+ *   interrupt).  Otherwise the transactions are carried out with the
+ *   blocking SPI methods on the low priority work queue.  The bus is
+ *   locked while transactions are in progress, so the bus may also be used
+ *   directly by other drivers and by other queues.  The worker waits for
+ *   the bus on the low priority work queue, so other work on that queue
+ *   must not keep the bus locked when it returns.
+ *
+ * Input Parameter:
+ *   dev - The SPI bus
+ *
+ * Returned Value:
+ *   A handle for the queue on success; NULL on failure
+ *
+ ****************************************************************************/
+
+FAR struct spi_queue_s *spi_queue_initialize(FAR struct spi_dev_s *dev);
+
+/****************************************************************************
+ * Name: spi_queue_submit
+ *
+ * Description:
+ *   Add a list of transactions, linked through their flink fields, to the
+ *   end of the queue.  This function does not wait.  When each transaction
+ *   has completed, its result field is set and its callback (if not NULL)
+ *   is called on the worker thread of the low priority work queue;  the
+ *   callback may submit more transactions but it must not wait.  The
+ *   transactions must not be changed until their callbacks have been
+ *   called.
+ *
+ * Input Parameters:
+ *   queue - The queue returned by spi_queue_initialize()
+ *   first - The first transaction in the list
+ *
+ * Returned Value:
+ *   OK on success; a negated errno value on failure.  -EINVAL means that
+ *   a chip select sequence (see SPI_TRANSFLAG_KEEPCS) does not end within
+ *   the list.
+ *
+ ****************************************************************************/
+
+int spi_queue_submit(FAR struct spi_queue_s *queue,
+                     FAR struct spi_trans_s *first);
+
+/****************************************************************************
+ * Name: spi_queue_uninitialize
+ *
+ * Description:
+ *   Free a transaction queue.  Returns -EBUSY if transactions are still
+ *   waiting or in progress.
+ *
+ ****************************************************************************/
+
+int spi_queue_uninitialize(FAR struct spi_queue_s *queue);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
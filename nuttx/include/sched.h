@@ -147,7 +147,8 @@ int    sched_unlock(void);
 int    sched_lockcount(void);
 
 /* If instrumentation of the scheduler is enabled, then some outboard logic
- * must provide the following interfaces.
+ * must provide the following interfaces (unless they are provided by the
+ * OS because CONFIG_SCHED_INSTRUMENTATION_BUFFER is selected).
  */
 
 #ifdef CONFIG_SCHED_INSTRUMENTATION
@@ -163,6 +164,18 @@ void   sched_note_switch(FAR struct tcb_s *pFromTcb,
 # define sched_note_switch(t1, t2)
 #endif /* CONFIG_SCHED_INSTRUMENTATION */
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void   sched_note_irqhandler(int irq);
+#else
+# define sched_note_irqhandler(i)
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SEMAPHORE
+void   sched_note_semblock(FAR struct tcb_s *tcb, FAR sem_t *sem);
+#else
+# define sched_note_semblock(t, s)
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -0,0 +1,163 @@
+/****************************************************************************
+ * include/sys/epoll.h
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_EPOLL_H
+#define __INCLUDE_SYS_EPOLL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <poll.h>
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* epoll_ctl() operations */
+
+#define EPOLL_CTL_ADD  1     /* Add a descriptor to the set */
+#define EPOLL_CTL_DEL  2     /* Remove a descriptor from the set */
+#define EPOLL_CTL_MOD  3     /* Change the events of a descriptor */
+
+/* Event flags.  The event bits are the same as the poll() event bits. */
+
+#define EPOLLIN        POLLIN
+#define EPOLLPRI       POLLPRI
+#define EPOLLOUT       POLLOUT
+#define EPOLLRDNORM    POLLRDNORM
+#define EPOLLRDBAND    POLLRDBAND
+#define EPOLLWRNORM    POLLWRNORM
+#define EPOLLWRBAND    POLLWRBAND
+#define EPOLLERR       POLLERR
+#define EPOLLHUP       POLLHUP
+
+/* Mode flags (not reported in epoll_wait() events):
+ *
+ *   EPOLLONESHOT
+ *     Report the descriptor once, then ignore it until it is re-enabled
+ *     with EPOLL_CTL_MOD.
+ *   EPOLLET
+ *     Edge-triggered.  Report the descriptor when the driver reports a
+ *     new event rather than for as long as the descriptor is ready.
+ */
+
+#define EPOLLONESHOT   (1ul << 30)
+#define EPOLLET        (1ul << 31)
+
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+typedef union epoll_data
+{
+  FAR void *ptr;
+  int       fd;
+  uint32_t  u32;
+#ifdef __INT64_DEFINED
+  uint64_t  u64;
+#endif
+} epoll_data_t;
+
+struct epoll_event
+{
+  uint32_t     events;  /* Requested events, or reported events */
+  epoll_data_t data;    /* Returned unchanged with reported events */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: epoll_create
+ *
+ * Description:
+ *   Create an epoll interest set and return a file descriptor that refers
+ *   to it.  'size' is ignored but must be greater than zero.  The set is
+ *   destroyed when the descriptor is closed.
+ *
+ ****************************************************************************/
+
+EXTERN int epoll_create(int size);
+
+/****************************************************************************
+ * Name: epoll_ctl
+ *
+ * Description:
+ *   Add (EPOLL_CTL_ADD), modify (EPOLL_CTL_MOD), or remove (EPOLL_CTL_DEL)
+ *   the descriptor 'fd' in the interest set 'epfd'.  The descriptor is set
+ *   up with its driver's poll method once, when it is added, and stays set
+ *   up until it is removed.
+ *
+ *   NOTE:  A descriptor must be removed from every set with EPOLL_CTL_DEL
+ *   before it is closed.
+ *
+ ****************************************************************************/
+
+EXTERN int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev);
+
+/****************************************************************************
+ * Name: epoll_wait
+ *
+ * Description:
+ *   Wait for events on the descriptors in the interest set 'epfd'.  Up to
+ *   'maxevents' ready descriptors are returned in 'events'.  'timeout' is
+ *   in milliseconds; zero returns immediately and a negative value waits
+ *   forever.  Returns the number of ready descriptors, zero on timeout, or
+ *   -1 with errno set on failure.
+ *
+ ****************************************************************************/
+
+EXTERN int epoll_wait(int epfd, FAR struct epoll_event *events,
+                      int maxevents, int timeout);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __INCLUDE_SYS_EPOLL_H */
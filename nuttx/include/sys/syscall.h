@@ -258,9 +258,18 @@
 #    define SYS_rmdir                  (__SYS_mountpoint+4)
 #    define SYS_umount                 (__SYS_mountpoint+5)
 #    define SYS_unlink                 (__SYS_mountpoint+6)
-#    define __SYS_pthread              (__SYS_mountpoint+7)
+#    define __SYS_epoll                (__SYS_mountpoint+7)
 #  else
-#    define __SYS_pthread              __SYS_mountpoint
+#    define __SYS_epoll                __SYS_mountpoint
+#  endif
+
+#  ifdef CONFIG_FS_EPOLL
+#    define SYS_epoll_create           (__SYS_epoll+0)
+#    define SYS_epoll_ctl              (__SYS_epoll+1)
+#    define SYS_epoll_wait             (__SYS_epoll+2)
+#    define __SYS_pthread              (__SYS_epoll+3)
+#  else
+#    define __SYS_pthread              __SYS_epoll
 #  endif
 
 #else
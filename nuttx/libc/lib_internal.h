@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <limits.h>
@@ -96,10 +97,63 @@
 
 #define LIB_BUFLEN_UNKNOWN INT_MAX
 
+/* Word-at-a-time support for the CONFIG_STRING_OPTSPEED versions of the
+ * string and memory functions.  These operate on naturally aligned words of
+ * LIB_WORDSIZE bytes (type lib_word_t).
+ *
+ *   LIB_ALIGNED(p)     - True if the address p is word aligned
+ *   LIB_REPEAT(c)      - A word with the byte c in every byte position
+ *   LIB_HASZERO(w)     - Non-zero if any byte of the word w is zero.  Only
+ *                        the result as a whole is meaningful; the bits set
+ *                        do not identify which byte was zero.
+ *   LIB_MERGE(w0,w1,s) - Bytes s/8 through LIB_WORDSIZE-1 of the word w0
+ *                        followed by the first s/8 bytes of the next word
+ *                        w1, in memory order.  0 < s < 8*LIB_WORDSIZE.
+ *
+ * Can't support CONFIG_STRING_64BIT if the platform does not have 64-bit
+ * integer types.
+ */
+
+#ifndef CONFIG_HAVE_LONG_LONG
+#  undef CONFIG_STRING_64BIT
+#endif
+
+#ifdef CONFIG_STRING_OPTSPEED
+#  ifdef CONFIG_STRING_64BIT
+#    define LIB_WORDSIZE     8
+#    define LIB_ONES         0x0101010101010101ull
+#  else
+#    define LIB_WORDSIZE     4
+#    define LIB_ONES         0x01010101ul
+#  endif
+
+#  define LIB_WORDMASK       (LIB_WORDSIZE - 1)
+#  define LIB_HIGHS          (LIB_ONES << 7)
+#  define LIB_ALIGNED(p)     (((uintptr_t)(p) & LIB_WORDMASK) == 0)
+#  define LIB_REPEAT(c)      ((lib_word_t)(unsigned char)(c) * LIB_ONES)
+#  define LIB_HASZERO(w)     (((w) - LIB_ONES) & ~(w) & LIB_HIGHS)
+
+#  ifdef CONFIG_ENDIAN_BIG
+#    define LIB_MERGE(w0,w1,s) \
+       (((w0) << (s)) | ((w1) >> (8 * LIB_WORDSIZE - (s))))
+#  else
+#    define LIB_MERGE(w0,w1,s) \
+       (((w0) >> (s)) | ((w1) << (8 * LIB_WORDSIZE - (s))))
+#  endif
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+#ifdef CONFIG_STRING_OPTSPEED
+#  ifdef CONFIG_STRING_64BIT
+typedef uint64_t lib_word_t;
+#  else
+typedef uint32_t lib_word_t;
+#  endif
+#endif
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
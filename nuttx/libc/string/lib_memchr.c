@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -65,6 +68,35 @@ FAR void *memchr(FAR const void *s, int c, size_t n)
 
   if (s)
     {
+#ifdef CONFIG_STRING_OPTSPEED
+      /* Check bytes until p is word aligned, then skip over the words that
+       * do not hold the byte:  The XOR of such a word with the byte in every
+       * position has no zero byte.
+       */
+
+      for (; n > 0 && !LIB_ALIGNED(p); p++, n--)
+        {
+          if (*p == (unsigned char)c)
+            {
+              return (FAR void *)p;
+            }
+        }
+
+      if (n >= LIB_WORDSIZE)
+        {
+          FAR const lib_word_t *wp = (FAR const lib_word_t *)p;
+          lib_word_t mask = LIB_REPEAT(c);
+
+          while (n >= LIB_WORDSIZE && !LIB_HASZERO(*wp ^ mask))
+            {
+              wp++;
+              n -= LIB_WORDSIZE;
+            }
+
+          p = (FAR const unsigned char *)wp;
+        }
+
+#endif
       while (n--)
         {
           if (*p == (unsigned char)c)
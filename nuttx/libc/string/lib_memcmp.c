@@ -43,8 +43,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /************************************************************
  * Global Functions
  ************************************************************/
@@ -55,6 +58,75 @@ int memcmp(FAR const void *s1, FAR const void *s2, size_t n)
   unsigned char *p1 = (unsigned char *)s1;
   unsigned char *p2 = (unsigned char *)s2;
 
+#ifdef CONFIG_STRING_OPTSPEED
+  /* Skip over the equal words in the middle once the first object is word
+   * aligned, merging pairs of aligned words of the second object if it is
+   * not also aligned.  The bytes of the first unequal word (or of the tail)
+   * are then compared one at a time below.
+   */
+
+  if (n >= 2 * LIB_WORDSIZE)
+    {
+      FAR const lib_word_t *w1;
+      FAR const lib_word_t *w2;
+      unsigned int shift;
+
+      for (; !LIB_ALIGNED(p1); p1++, p2++, n--)
+        {
+          if (*p1 != *p2)
+            {
+              return *p1 < *p2 ? -1 : 1;
+            }
+        }
+
+      w1    = (FAR const lib_word_t *)p1;
+      shift = 8 * ((uintptr_t)p2 & LIB_WORDMASK);
+
+      if (shift == 0)
+        {
+          w2 = (FAR const lib_word_t *)p2;
+          while (n >= LIB_WORDSIZE && *w1 == *w2)
+            {
+              w1++;
+              w2++;
+              n -= LIB_WORDSIZE;
+            }
+
+          p2 = (unsigned char *)w2;
+        }
+      else
+        {
+          lib_word_t v0;
+          lib_word_t v1;
+
+          /* As in memcpy(), no aligned word is read that does not hold at
+           * least one byte of the second object.
+           */
+
+          w2 = (FAR const lib_word_t *)(p2 - shift / 8);
+          v0 = *w2++;
+
+          while (n >= LIB_WORDSIZE)
+            {
+              v1 = *w2;
+              if (*w1 != LIB_MERGE(v0, v1, shift))
+                {
+                  break;
+                }
+
+              w1++;
+              w2++;
+              v0 = v1;
+              n -= LIB_WORDSIZE;
+            }
+
+          p2 = (unsigned char *)w2 - LIB_WORDSIZE + shift / 8;
+        }
+
+      p1 = (unsigned char *)w1;
+    }
+#endif
+
   while (n-- > 0)
     {
       if (*p1 < *p2)
@@ -43,8 +43,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -56,9 +59,96 @@
 #ifndef CONFIG_ARCH_MEMCPY
 FAR void *memcpy(FAR void *dest, FAR const void *src, size_t n)
 {
+#ifdef CONFIG_STRING_OPTSPEED
+  /* This version is optimized for speed.  It copies a word at a time once
+   * the destination is word aligned, shifting together pairs of aligned
+   * source words if the source is not also aligned.
+   */
+
+  FAR unsigned char *pout = (FAR unsigned char*)dest;
+  FAR const unsigned char *pin = (FAR const unsigned char*)src;
+
+  if (n >= 2 * LIB_WORDSIZE)
+    {
+      FAR lib_word_t *wout;
+      FAR const lib_word_t *win;
+      unsigned int shift;
+
+      /* Copy bytes until the destination is word aligned */
+
+      while (!LIB_ALIGNED(pout))
+        {
+          *pout++ = *pin++;
+          n--;
+        }
+
+      wout  = (FAR lib_word_t *)pout;
+      shift = 8 * ((uintptr_t)pin & LIB_WORDMASK);
+
+      if (shift == 0)
+        {
+          /* Both are aligned.  Copy four words at a time, then the rest of
+           * the whole words.
+           */
+
+          win = (FAR const lib_word_t *)pin;
+          while (n >= 4 * LIB_WORDSIZE)
+            {
+              wout[0] = win[0];
+              wout[1] = win[1];
+              wout[2] = win[2];
+              wout[3] = win[3];
+              wout   += 4;
+              win    += 4;
+              n      -= 4 * LIB_WORDSIZE;
+            }
+
+          while (n >= LIB_WORDSIZE)
+            {
+              *wout++ = *win++;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pin = (FAR const unsigned char *)win;
+        }
+      else
+        {
+          lib_word_t w0;
+          lib_word_t w1;
+
+          /* Read the aligned words that hold the source bytes and merge
+           * each pair into one destination word.  No aligned word is read
+           * that does not hold at least one source byte.
+           */
+
+          win = (FAR const lib_word_t *)(pin - shift / 8);
+          w0  = *win++;
+
+          while (n >= LIB_WORDSIZE)
+            {
+              w1      = *win++;
+              *wout++ = LIB_MERGE(w0, w1, shift);
+              w0      = w1;
+              n      -= LIB_WORDSIZE;
+            }
+
+          pin = (FAR const unsigned char *)win - LIB_WORDSIZE + shift / 8;
+        }
+
+      pout = (FAR unsigned char *)wout;
+    }
+
+  /* Copy the remaining bytes */
+
+  while (n-- > 0) *pout++ = *pin++;
+  return dest;
+#else
+  /* This version is optimized for size */
+
   FAR unsigned char *pout = (FAR unsigned char*)dest;
   FAR unsigned char *pin  = (FAR unsigned char*)src;
   while (n-- > 0) *pout++ = *pin++;
   return dest;
+#endif
 }
 #endif
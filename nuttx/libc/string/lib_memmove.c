@@ -43,8 +43,12 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /************************************************************
  * Global Functions
  ************************************************************/
@@ -52,6 +56,94 @@
 #ifndef CONFIG_ARCH_MEMMOVE
 FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
 {
+#ifdef CONFIG_STRING_OPTSPEED
+  /* This version is optimized for speed.  Regions that do not overlap are
+   * copied by memcpy().  Otherwise, it copies a word at a time when the
+   * source and destination have the same alignment.  Then the overlap is
+   * at least a whole word away and copying words in the right direction is
+   * safe.
+   */
+
+  FAR unsigned char *pout = (FAR unsigned char *)dest;
+  FAR const unsigned char *pin = (FAR const unsigned char *)src;
+  bool words;
+
+  if (pout + count <= pin || pin + count <= pout)
+    {
+      return memcpy(dest, src, count);
+    }
+
+  words = count >= 2 * LIB_WORDSIZE &&
+          (((uintptr_t)pout ^ (uintptr_t)pin) & LIB_WORDMASK) == 0;
+
+  if (pout <= pin)
+    {
+      /* Copy forward */
+
+      if (words)
+        {
+          FAR lib_word_t *wout;
+          FAR const lib_word_t *win;
+
+          while (!LIB_ALIGNED(pout))
+            {
+              *pout++ = *pin++;
+              count--;
+            }
+
+          wout = (FAR lib_word_t *)pout;
+          win  = (FAR const lib_word_t *)pin;
+          while (count >= LIB_WORDSIZE)
+            {
+              *wout++ = *win++;
+              count  -= LIB_WORDSIZE;
+            }
+
+          pout = (FAR unsigned char *)wout;
+          pin  = (FAR const unsigned char *)win;
+        }
+
+      while (count--)
+        {
+          *pout++ = *pin++;
+        }
+    }
+  else
+    {
+      /* Copy backward from the end */
+
+      pout += count;
+      pin  += count;
+
+      if (words)
+        {
+          FAR lib_word_t *wout;
+          FAR const lib_word_t *win;
+
+          while (!LIB_ALIGNED(pout))
+            {
+              *--pout = *--pin;
+              count--;
+            }
+
+          wout = (FAR lib_word_t *)pout;
+          win  = (FAR const lib_word_t *)pin;
+          while (count >= LIB_WORDSIZE)
+            {
+              *--wout = *--win;
+              count  -= LIB_WORDSIZE;
+            }
+
+          pout = (FAR unsigned char *)wout;
+          pin  = (FAR const unsigned char *)win;
+        }
+
+      while (count--)
+        {
+          *--pout = *--pin;
+        }
+    }
+#else
   char *tmp, *s;
   if (dest <= src)
     {
@@ -71,6 +163,7 @@ FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
 	  *--tmp = *--s;
         }
     }
+#endif
 
   return dest;
 }
@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -64,6 +67,36 @@ FAR char *strchr(FAR const char *s, int c)
 {
   if (s)
     {
+#ifdef CONFIG_STRING_OPTSPEED
+      /* Check bytes until s is word aligned, then skip over the words that
+       * hold neither the terminating null byte nor 'c'.
+       */
+
+      FAR const lib_word_t *wp;
+      lib_word_t mask;
+
+      for (; !LIB_ALIGNED(s); s++)
+        {
+          if (*s == (char)c)
+            {
+              return (FAR char *)s;
+            }
+
+          if (!*s)
+            {
+              return NULL;
+            }
+        }
+
+      mask = LIB_REPEAT(c);
+      for (wp = (FAR const lib_word_t *)s;
+           !LIB_HASZERO(*wp) && !LIB_HASZERO(*wp ^ mask);
+           wp++);
+
+      s = (FAR const char *)wp;
+      c = (char)c;
+
+#endif
       for (; ; s++)
         {
           if (*s == c)
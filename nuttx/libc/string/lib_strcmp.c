@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /****************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -48,12 +51,48 @@
 #ifndef CONFIG_ARCH_STRCMP
 int strcmp(const char *cs, const char *ct)
 {
-  register signed char result;
-  for (;;)
+  /* The bytes are compared as unsigned char */
+
+  const unsigned char *p1 = (const unsigned char *)cs;
+  const unsigned char *p2 = (const unsigned char *)ct;
+
+#ifdef CONFIG_STRING_OPTSPEED
+  /* If the two strings have the same alignment, skip over the equal words
+   * before the first difference or terminating null byte.
+   */
+
+  if ((((uintptr_t)p1 ^ (uintptr_t)p2) & LIB_WORDMASK) == 0)
+    {
+      const lib_word_t *w1;
+      const lib_word_t *w2;
+
+      for (; !LIB_ALIGNED(p1); p1++, p2++)
+        {
+          if (*p1 != *p2 || *p1 == '\0')
+            {
+              return *p1 - *p2;
+            }
+        }
+
+      w1 = (const lib_word_t *)p1;
+      w2 = (const lib_word_t *)p2;
+      while (*w1 == *w2 && !LIB_HASZERO(*w1))
+        {
+          w1++;
+          w2++;
+        }
+
+      p1 = (const unsigned char *)w1;
+      p2 = (const unsigned char *)w2;
+    }
+#endif
+
+  while (*p1 == *p2 && *p1 != '\0')
     {
-      if ((result = *cs - *ct++) != 0 || !*cs++)
-	break;
+      p1++;
+      p2++;
     }
-  return result;
+
+  return *p1 - *p2;
 }
 #endif
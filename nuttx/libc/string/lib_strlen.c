@@ -39,8 +39,11 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+#include "lib_internal.h"
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -49,7 +52,30 @@
 size_t strlen(const char *s)
 {
   const char *sc;
-  for (sc = s; *sc != '\0'; ++sc);
+
+#ifdef CONFIG_STRING_OPTSPEED
+  /* Check bytes until sc is word aligned, then skip over the words that
+   * have no zero byte.  An aligned word never extends past the end of the
+   * memory that holds its first byte.
+   */
+
+  const lib_word_t *wp;
+
+  for (sc = s; !LIB_ALIGNED(sc); ++sc)
+    {
+      if (*sc == '\0')
+        {
+          return sc - s;
+        }
+    }
+
+  for (wp = (const lib_word_t *)sc; !LIB_HASZERO(*wp); ++wp);
+  sc = (const char *)wp;
+#else
+  sc = s;
+#endif
+
+  for (; *sc != '\0'; ++sc);
   return sc - s;
 }
 #endif
@@ -62,7 +62,7 @@
  *
  ****************************************************************************/
 
-#ifndef CONFIG_MM_MULTIHEAP
+#if !defined(CONFIG_MM_MULTIHEAP) && !defined(CONFIG_MM_TASKCACHE)
 static inline
 #endif
 void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
@@ -105,16 +105,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
       andbeyond = (FAR struct mm_allocnode_s*)((char*)next + next->size);
 
-      /* Remove the next node.  There must be a predecessor,
-       * but there may not be a successor node.
-       */
+      /* Remove the next node from the free list */
 
-      DEBUGASSERT(next->blink);
-      next->blink->flink = next->flink;
-      if (next->flink)
-        {
-          next->flink->blink = next->blink;
-        }
+      mm_remfreechunk(heap, next);
 
       /* Then merge the two chunks */
 
@@ -130,16 +123,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
   prev = (FAR struct mm_freenode_s *)((char*)node - node->preceding);
   if ((prev->preceding & MM_ALLOC_BIT) == 0)
     {
-      /* Remove the node.  There must be a predecessor, but there may
-       * not be a successor node.
-       */
+      /* Remove the preceding node from the free list */
 
-      DEBUGASSERT(prev->blink);
-      prev->blink->flink = prev->flink;
-      if (prev->flink)
-        {
-          prev->flink->blink = prev->blink;
-        }
+      mm_remfreechunk(heap, prev);
 
       /* Then merge the two chunks */
 
@@ -170,6 +156,13 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 #if !defined(CONFIG_NUTTX_KERNEL) || !defined(__KERNEL__)
 void free(FAR void *mem)
 {
+#ifdef CONFIG_MM_TASKCACHE
+  if (mm_cachefree(&g_mmheap, mem))
+    {
+      return;
+    }
+
+#endif
   mm_free(&g_mmheap, mem);
 }
 #endif
@@ -80,14 +80,16 @@
  *
  ****************************************************************************/
 
-#ifndef CONFIG_MM_MULTIHEAP
+#if !defined(CONFIG_MM_MULTIHEAP) && !defined(CONFIG_MM_TASKCACHE)
 static inline
 #endif
 FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   void *ret = NULL;
+#ifndef CONFIG_MM_TLSF
   int ndx;
+#endif
 
   /* Handle bad sizes */
 
@@ -106,6 +108,13 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   mm_takesemaphore(heap);
 
+#ifdef CONFIG_MM_TLSF
+  /* Get the head of the first non-empty size class that is guaranteed to
+   * hold a large enough chunk.
+   */
+
+  node = mm_findchunk(heap, size);
+#else
   /* Get the location in the node list to start the search. Special case
    * really big allocations
    */
@@ -129,10 +138,11 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   for (node = heap->mm_nodelist[ndx].flink;
        node && node->size < size;
        node = node->flink);
+#endif
 
   /* If we found a node with non-zero size, then this is one to use. Since
    * the list is ordered, we know that is must be best fitting chunk
-   * available.
+   * available (or, for TLSF, a good fit within one size class).
    */
 
   if (node)
@@ -141,16 +151,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from the free list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_remfreechunk(heap, node);
 
       /* Check if we have to split the free node into one of the allocated
        * size and another smaller freenode.  In some cases, the remaining
@@ -231,6 +234,14 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 #if !defined(CONFIG_NUTTX_KERNEL) || !defined(__KERNEL__)
 FAR void *malloc(size_t size)
 {
+#ifdef CONFIG_MM_TASKCACHE
+  FAR void *ret = mm_cachealloc(&g_mmheap, size);
+  if (ret)
+    {
+      return ret;
+    }
+
+#endif
   return mm_malloc(&g_mmheap, size);
 }
 #endif
@@ -0,0 +1,359 @@
+/****************************************************************************
+ * mm/mm_taskcache.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <sched.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_TASKCACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Map a chunk size (including the chunk header) to a cache class */
+
+#define MM_CACHE_NDX(s) ((s) / MM_MIN_CHUNK - 1)
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_mycache
+ *
+ * Description:
+ *   Return the cache of the calling thread or NULL if the cache may not be
+ *   used in this context.  The cache may not be used from interrupt
+ *   handlers or by a thread that has already completed its exit
+ *   processing (and, hence, has already flushed its cache).
+ *
+ ****************************************************************************/
+
+static inline FAR struct mm_taskcache_s *mm_mycache(void)
+{
+  FAR struct tcb_s *tcb;
+
+  if (up_interrupt_context())
+    {
+      return NULL;
+    }
+
+  tcb = sched_self();
+  if ((tcb->flags & TCB_FLAG_EXIT_PROCESSING) != 0)
+    {
+      return NULL;
+    }
+
+  return &tcb->mmcache;
+}
+
+/****************************************************************************
+ * Name: mm_cachedetach
+ *
+ * Description:
+ *   Remove up to 'count' chunks from the top of one cache class and return
+ *   them as a list linked through the first word of each chunk.
+ *
+ ****************************************************************************/
+
+static FAR void *mm_cachedetach(FAR struct mm_taskcache_s *cache, int ndx,
+                                int count)
+{
+  FAR void *head;
+  FAR void *tail;
+  irqstate_t flags;
+
+  flags = irqsave();
+  head  = cache->tc_head[ndx];
+  tail  = head;
+
+  if (count > cache->tc_count[ndx])
+    {
+      count = cache->tc_count[ndx];
+    }
+
+  cache->tc_count[ndx] -= count;
+  while (--count > 0)
+    {
+      tail = *(FAR void **)tail;
+    }
+
+  if (tail)
+    {
+      cache->tc_head[ndx] = *(FAR void **)tail;
+      *(FAR void **)tail  = NULL;
+    }
+
+  irqrestore(flags);
+  return head;
+}
+
+/****************************************************************************
+ * Name: mm_cacherelease
+ *
+ * Description:
+ *   Return a list of chunks obtained from mm_cachedetach() to the heap,
+ *   taking the heap semaphore only once for the whole list.
+ *
+ ****************************************************************************/
+
+static void mm_cacherelease(FAR struct mm_heap_s *heap, FAR void *list)
+{
+  FAR void *next;
+
+  mm_takesemaphore(heap);
+  for (; list; list = next)
+    {
+      next = *(FAR void **)list;
+      mm_free(heap, list);
+    }
+
+  mm_givesemaphore(heap);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_cachealloc
+ *
+ * Description:
+ *   Try to satisfy an allocation from the cache of the calling thread.  If
+ *   the cache class is empty, it is first refilled with up to
+ *   CONFIG_MM_TASKCACHE_BATCH chunks from the heap.
+ *
+ * Return Value:
+ *   The allocated memory or NULL if the request is too large to be cached,
+ *   if the cache cannot be used in this context, or if the heap is
+ *   exhausted.  In all of these cases, the caller should fall back to
+ *   mm_malloc().
+ *
+ ****************************************************************************/
+
+FAR void *mm_cachealloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_taskcache_s *cache;
+  FAR void *ret;
+  irqstate_t flags;
+  size_t chunksize;
+  int ndx;
+  int i;
+
+  /* Is this a request that could be cached? */
+
+  chunksize = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
+  if (size == 0 || chunksize > CONFIG_MM_TASKCACHE_MAXSIZE)
+    {
+      return NULL;
+    }
+
+  cache = mm_mycache();
+  if (!cache)
+    {
+      return NULL;
+    }
+
+  ndx = MM_CACHE_NDX(chunksize);
+
+  /* Refill the cache class if it is empty.  Only this thread touches
+   * its own cache so there is no need to keep interrupts disabled
+   * while the heap is accessed.
+   */
+
+  if (cache->tc_count[ndx] == 0)
+    {
+      mm_takesemaphore(heap);
+      for (i = 0; i < CONFIG_MM_TASKCACHE_BATCH; i++)
+        {
+          ret = mm_malloc(heap, chunksize - SIZEOF_MM_ALLOCNODE);
+          if (!ret)
+            {
+              break;
+            }
+
+          flags = irqsave();
+          *(FAR void **)ret   = cache->tc_head[ndx];
+          cache->tc_head[ndx] = ret;
+          cache->tc_count[ndx]++;
+          irqrestore(flags);
+        }
+
+      mm_givesemaphore(heap);
+    }
+
+  /* Then take the chunk at the top of the cache class */
+
+  flags = irqsave();
+  ret   = cache->tc_head[ndx];
+  if (ret)
+    {
+      cache->tc_head[ndx] = *(FAR void **)ret;
+      cache->tc_count[ndx]--;
+    }
+
+  irqrestore(flags);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: mm_cachefree
+ *
+ * Description:
+ *   Try to return a chunk to the cache of the calling thread.  If the cache
+ *   class is full, CONFIG_MM_TASKCACHE_BATCH chunks are first returned to
+ *   the heap.
+ *
+ * Return Value:
+ *   true if the chunk was cached; false if the caller must return the
+ *   chunk to the heap with mm_free().
+ *
+ ****************************************************************************/
+
+bool mm_cachefree(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_taskcache_s *cache;
+  FAR struct mm_allocnode_s *node;
+  irqstate_t flags;
+  size_t chunksize;
+  int ndx;
+
+  if (!mem)
+    {
+      return false;
+    }
+
+  /* Is this chunk small enough to be cached? */
+
+  node      = (FAR struct mm_allocnode_s *)
+              ((FAR char*)mem - SIZEOF_MM_ALLOCNODE);
+  chunksize = node->size;
+  DEBUGASSERT((node->preceding & MM_ALLOC_BIT) != 0);
+
+  if (chunksize > CONFIG_MM_TASKCACHE_MAXSIZE)
+    {
+      return false;
+    }
+
+  cache = mm_mycache();
+  if (!cache)
+    {
+      return false;
+    }
+
+  ndx = MM_CACHE_NDX(chunksize);
+
+  /* Drain part of the cache class to the heap if it is full */
+
+  if (cache->tc_count[ndx] >= CONFIG_MM_TASKCACHE_DEPTH)
+    {
+      mm_cacherelease(heap,
+                      mm_cachedetach(cache, ndx, CONFIG_MM_TASKCACHE_BATCH));
+    }
+
+  /* Then push the chunk onto the top of the cache class */
+
+  flags = irqsave();
+  *(FAR void **)mem   = cache->tc_head[ndx];
+  cache->tc_head[ndx] = mem;
+  cache->tc_count[ndx]++;
+  irqrestore(flags);
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_cacheflush
+ *
+ * Description:
+ *   Return every chunk held in a thread's cache to the heap.  This is
+ *   called from task_exithook().  The cache may belong to a thread other
+ *   than the caller.
+ *
+ *   If nonblocking is true, then this function must not wait for the heap
+ *   semaphore.  In that case, the chunks are freed with sched_ufree() if
+ *   the heap is not immediately available.
+ *
+ ****************************************************************************/
+
+void mm_cacheflush(FAR struct mm_heap_s *heap,
+                   FAR struct mm_taskcache_s *cache, bool nonblocking)
+{
+  FAR void *list;
+  FAR void *next;
+  int ndx;
+
+  for (ndx = 0; ndx < MM_TASKCACHE_NCLASSES; ndx++)
+    {
+      list = mm_cachedetach(cache, ndx, CONFIG_MM_TASKCACHE_DEPTH);
+      if (!list)
+        {
+          continue;
+        }
+
+      if (!nonblocking)
+        {
+          mm_cacherelease(heap, list);
+        }
+      else if (mm_trysemaphore(heap) == OK)
+        {
+          mm_cacherelease(heap, list);
+          mm_givesemaphore(heap);
+        }
+      else
+        {
+          for (; list; list = next)
+            {
+              next = *(FAR void **)list;
+              sched_ufree(list);
+            }
+        }
+    }
+}
+
+#endif /* CONFIG_MM_TASKCACHE */
@@ -0,0 +1,302 @@
+/****************************************************************************
+ * mm/mm_tlsf.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <nuttx/mm.h>
+
+#ifdef CONFIG_MM_TLSF
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#if MM_FL_COUNT > 32
+#  error "Too many first level size classes for a 32-bit bitmap"
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fls
+ *
+ * Description:
+ *   Return the bit number of the most significant bit set in a non-zero
+ *   value.
+ *
+ ****************************************************************************/
+
+static inline int mm_fls(size_t value)
+{
+#ifdef __GNUC__
+  return (int)(8 * sizeof(unsigned long)) - 1 -
+         __builtin_clzl((unsigned long)value);
+#else
+  int bit = 0;
+
+  while (value > 1)
+    {
+      value >>= 1;
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_ffs
+ *
+ * Description:
+ *   Return the bit number of the least significant bit set in a non-zero
+ *   bitmap.
+ *
+ ****************************************************************************/
+
+static inline int mm_ffs(uint32_t bitmap)
+{
+#ifdef __GNUC__
+  return __builtin_ctzl((unsigned long)bitmap);
+#else
+  int bit = 0;
+
+  while ((bitmap & 1) == 0)
+    {
+      bitmap >>= 1;
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/****************************************************************************
+ * Name: mm_mapping
+ *
+ * Description:
+ *   Map a chunk size to its first and second level size class indices.
+ *
+ ****************************************************************************/
+
+static void mm_mapping(size_t size, FAR int *fl, FAR int *sl)
+{
+  if (size < MM_SMALL_CHUNK)
+    {
+      /* Small chunks are binned linearly in units of MM_MIN_CHUNK */
+
+      *fl = 0;
+      *sl = (int)(size >> MM_MIN_SHIFT);
+    }
+  else if (size >= MM_MAX_CHUNK)
+    {
+      /* Really big chunks all share the last class */
+
+      *fl = MM_FL_COUNT - 1;
+      *sl = 0;
+    }
+  else
+    {
+      int bit = mm_fls(size);
+
+      *fl = bit - MM_FL_SHIFT + 1;
+      *sl = (int)(size >> (bit - MM_SL_SHIFT)) - MM_SL_COUNT;
+    }
+}
+
+/****************************************************************************
+ * Global Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_addfreechunk
+ *
+ * Description:
+ *   Add a free chunk to the head of the free list for its size class.  It
+ *   is assumed that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s *head;
+  int fl;
+  int sl;
+
+  mm_mapping(node->size, &fl, &sl);
+
+  head        = heap->mm_freelist[fl][sl];
+  node->blink = NULL;
+  node->flink = head;
+
+  if (head)
+    {
+      head->blink = node;
+    }
+
+  heap->mm_freelist[fl][sl] = node;
+  heap->mm_flbitmap        |= (uint32_t)1 << fl;
+  heap->mm_slbitmap[fl]    |= (uint32_t)1 << sl;
+}
+
+/****************************************************************************
+ * Name: mm_remfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the free list for its size class, clearing the
+ *   bitmap bits if the list becomes empty.  The chunk size must not have
+ *   been modified since the chunk was added.  It is assumed that the caller
+ *   holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  if (node->blink)
+    {
+      node->blink->flink = node->flink;
+    }
+  else
+    {
+      int fl;
+      int sl;
+
+      /* This is the head of the list.  Find the list it heads */
+
+      mm_mapping(node->size, &fl, &sl);
+      DEBUGASSERT(heap->mm_freelist[fl][sl] == node);
+
+      heap->mm_freelist[fl][sl] = node->flink;
+      if (!node->flink)
+        {
+          heap->mm_slbitmap[fl] &= ~((uint32_t)1 << sl);
+          if (heap->mm_slbitmap[fl] == 0)
+            {
+              heap->mm_flbitmap &= ~((uint32_t)1 << fl);
+            }
+        }
+    }
+
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+}
+
+/****************************************************************************
+ * Name: mm_findchunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes without removing it from
+ *   its free list.  The request is rounded up to the next size class
+ *   boundary so that the head of any non-empty class at or above that
+ *   class is large enough; that class is then found in constant time with
+ *   two bitmap searches.
+ *
+ *   Only if that fails (a nearly exhausted heap or a request of at least
+ *   MM_MAX_CHUNK bytes) is a single size class searched linearly for a
+ *   first fit.  It is assumed that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findchunk(FAR struct mm_heap_s *heap,
+                                       size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  uint32_t slmap = 0;
+  uint32_t flmap;
+  size_t rounded = size;
+  int fl;
+  int sl;
+
+  /* Round the request up to the next size class boundary */
+
+  if (size >= MM_SMALL_CHUNK && size < MM_MAX_CHUNK)
+    {
+      rounded += ((size_t)1 << (mm_fls(size) - MM_SL_SHIFT)) - 1;
+    }
+
+  mm_mapping(rounded, &fl, &sl);
+
+  if (fl < MM_FL_COUNT - 1)
+    {
+      /* Look for a non-empty class in this first level class, then in any
+       * larger first level class.
+       */
+
+      slmap = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+      if (slmap == 0)
+        {
+          flmap = heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1));
+          if (flmap != 0)
+            {
+              fl    = mm_ffs(flmap);
+              slmap = heap->mm_slbitmap[fl];
+            }
+        }
+    }
+  else if (size < MM_MAX_CHUNK)
+    {
+      /* Rounding moved the request into the last class; every chunk there
+       * is larger than the request.
+       */
+
+      slmap = heap->mm_slbitmap[fl];
+    }
+
+  if (slmap != 0)
+    {
+      return heap->mm_freelist[fl][mm_ffs(slmap)];
+    }
+
+  /* Fall back to a first fit search in the request's own size class */
+
+  mm_mapping(size, &fl, &sl);
+  for (node = heap->mm_freelist[fl][sl];
+       node && node->size < size;
+       node = node->flink);
+
+  return node;
+}
+
+#endif /* CONFIG_MM_TLSF */
@@ -153,4 +153,28 @@ void umm_givesemaphore(void)
   mm_givesemaphore(&g_mmheap);
 }
 
+/************************************************************************
+ * Name: umm_cacheflush
+ *
+ * Description:
+ *   This is a simple wrapper for the mm_cacheflush() function.  It is
+ *   called by the kernel to return the small allocation cache of an
+ *   exiting thread to the user-mode heap.
+ *
+ * Parameters:
+ *   cache       - The cache to be flushed
+ *   nonblocking - True if this function must not wait for the heap
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_MM_TASKCACHE
+void umm_cacheflush(FAR struct mm_taskcache_s *cache, bool nonblocking)
+{
+  mm_cacheflush(&g_mmheap, cache, nonblocking);
+}
+#endif
+
 #endif /* !CONFIG_NUTTX_KERNEL || !__KERNEL__ */
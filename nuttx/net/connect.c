@@ -134,9 +134,13 @@ static inline void tcp_teardown_callbacks(struct tcp_connect_s *pstate,
 {
   FAR struct uip_conn *conn = pstate->tc_conn;
 
-  /* Make sure that no further interrupts are processed */
+  /* Make sure that no further interrupts are processed.  This is called
+   * both from the interrupt handler and again after the wait, so the
+   * callback must be freed only once.
+   */
 
   uip_tcpcallbackfree(conn, pstate->tc_cb);
+  pstate->tc_cb = NULL;
 
   /* If we successfully connected, we will continue to monitor the connection
    * state via callbacks.
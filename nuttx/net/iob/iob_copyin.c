@@ -0,0 +1,178 @@
+/****************************************************************************
+ * net/iob/iob_copyin.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET_IOB
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/net/iob.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_space
+ *
+ * Description:
+ *   Return the number of bytes that may be written to a buffer, counting
+ *   from its first valid byte.  Only the last buffer of a chain may grow.
+ *
+ ****************************************************************************/
+
+static inline unsigned int iob_space(FAR struct iob_s *iob)
+{
+  return iob->io_flink ? iob->io_len : CONFIG_IOB_BUFSIZE - iob->io_offset;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_copyin
+ *
+ * Description:
+ *   Copy 'len' bytes from 'src' into the chain beginning with 'iob',
+ *   starting 'offset' bytes into the data.  'offset' may be no larger than
+ *   the length of the data in the chain, and the chain is extended with
+ *   buffers from the pool as needed.
+ *
+ * Returned Value:
+ *   OK on success.  -ENOMEM if there were not enough free buffers; in that
+ *   case, the chain is not changed.
+ *
+ ****************************************************************************/
+
+int iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
+               unsigned int len, unsigned int offset)
+{
+  FAR struct iob_s *head    = iob;
+  FAR struct iob_s *newbufs = NULL;
+  FAR struct iob_s *next;
+  unsigned int end = offset + len;
+  unsigned int avail;
+  unsigned int ncopy;
+
+  DEBUGASSERT(iob && offset <= iob->io_pktlen);
+
+  /* Skip to the buffer that holds the first byte to be written */
+
+  while (offset >= iob->io_len && iob->io_flink)
+    {
+      offset -= iob->io_len;
+      iob     = iob->io_flink;
+    }
+
+  /* Allocate any buffers that will be needed before anything is changed so
+   * that the chain is left as it was if there are not enough.
+   */
+
+  avail = 0;
+  for (next = iob; next; next = next->io_flink)
+    {
+      avail += iob_space(next);
+    }
+
+  avail -= offset;
+  while (avail < len)
+    {
+      next = iob_alloc();
+      if (!next)
+        {
+          iob_free_chain(newbufs);
+          return -ENOMEM;
+        }
+
+      next->io_flink = newbufs;
+      newbufs        = next;
+      avail         += CONFIG_IOB_BUFSIZE;
+    }
+
+  /* Now copy the data, appending the new buffers as the chain fills */
+
+  while (len > 0)
+    {
+      avail = iob_space(iob) - offset;
+      if (avail == 0)
+        {
+          next           = newbufs;
+          newbufs        = next->io_flink;
+          next->io_flink = NULL;
+          iob->io_flink  = next;
+          iob            = next;
+          offset         = 0;
+          continue;
+        }
+
+      ncopy = len < avail ? len : avail;
+      memcpy(&iob->io_data[iob->io_offset + offset], src, ncopy);
+
+      offset += ncopy;
+      if (offset > iob->io_len)
+        {
+          iob->io_len = offset;
+        }
+
+      src += ncopy;
+      len -= ncopy;
+
+      if (len > 0 && iob->io_flink)
+        {
+          iob    = iob->io_flink;
+          offset = 0;
+        }
+    }
+
+  DEBUGASSERT(newbufs == NULL);
+
+  if (end > head->io_pktlen)
+    {
+      head->io_pktlen = end;
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_NET_IOB */
@@ -0,0 +1,95 @@
+/****************************************************************************
+ * net/iob/iob_copyout.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET_IOB
+
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/net/iob.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_copyout
+ *
+ * Description:
+ *   Copy up to 'len' bytes of data beginning 'offset' bytes into the chain
+ *   to 'dest'.  Returns the number of bytes copied, which is less than
+ *   'len' only if the chain holds less data.
+ *
+ ****************************************************************************/
+
+unsigned int iob_copyout(FAR uint8_t *dest, FAR const struct iob_s *iob,
+                         unsigned int len, unsigned int offset)
+{
+  unsigned int remaining = len;
+  unsigned int ncopy;
+
+  /* Skip to the buffer that holds the first byte to be copied */
+
+  while (iob && offset >= iob->io_len)
+    {
+      offset -= iob->io_len;
+      iob     = iob->io_flink;
+    }
+
+  while (iob && remaining > 0)
+    {
+      ncopy = iob->io_len - offset;
+      if (ncopy > remaining)
+        {
+          ncopy = remaining;
+        }
+
+      memcpy(dest, &iob->io_data[iob->io_offset + offset], ncopy);
+
+      dest      += ncopy;
+      remaining -= ncopy;
+      offset     = 0;
+      iob        = iob->io_flink;
+    }
+
+  return len - remaining;
+}
+
+#endif /* CONFIG_NET_IOB */
@@ -0,0 +1,161 @@
+/****************************************************************************
+ * net/iob/iob_pool.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET_IOB
+
+#include <stdlib.h>
+
+#include <arch/irq.h>
+#include <nuttx/net/iob.h>
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* These are the pre-allocated I/O buffers */
+
+static struct iob_s g_iobpool[CONFIG_IOB_NBUFFERS];
+
+/* This is the list of free I/O buffers, linked through io_flink */
+
+static FAR struct iob_s *g_iobfreelist;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_initialize
+ *
+ * Description:
+ *   Set up the pool of I/O buffers.  Called once from uip_initialize().
+ *
+ ****************************************************************************/
+
+void iob_initialize(void)
+{
+  int i;
+
+  g_iobfreelist = NULL;
+  for (i = 0; i < CONFIG_IOB_NBUFFERS; i++)
+    {
+      g_iobpool[i].io_flink = g_iobfreelist;
+      g_iobfreelist         = &g_iobpool[i];
+    }
+}
+
+/****************************************************************************
+ * Name: iob_alloc
+ *
+ * Description:
+ *   Take one empty I/O buffer from the pool.  Returns NULL if the pool is
+ *   exhausted.
+ *
+ * Assumptions:
+ *   May be called from interrupt handlers.  The pool is shared by every
+ *   user so interrupts are always disabled while it is accessed, even in
+ *   the CONFIG_NET_NOINTS configuration.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc(void)
+{
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+
+  flags = irqsave();
+  iob = g_iobfreelist;
+  if (iob)
+    {
+      g_iobfreelist = iob->io_flink;
+    }
+  irqrestore(flags);
+
+  if (iob)
+    {
+      iob->io_flink  = NULL;
+      iob->io_qlink  = NULL;
+      iob->io_len    = 0;
+      iob->io_offset = 0;
+      iob->io_pktlen = 0;
+    }
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_free
+ *
+ * Description:
+ *   Return one I/O buffer to the pool and return the buffer that followed
+ *   it in its chain.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_free(FAR struct iob_s *iob)
+{
+  FAR struct iob_s *next = iob->io_flink;
+  irqstate_t flags;
+
+  flags = irqsave();
+  iob->io_flink = g_iobfreelist;
+  g_iobfreelist = iob;
+  irqrestore(flags);
+
+  return next;
+}
+
+/****************************************************************************
+ * Name: iob_free_chain
+ *
+ * Description:
+ *   Return every buffer in a chain to the pool.
+ *
+ ****************************************************************************/
+
+void iob_free_chain(FAR struct iob_s *iob)
+{
+  while (iob)
+    {
+      iob = iob_free(iob);
+    }
+}
+
+#endif /* CONFIG_NET_IOB */
@@ -0,0 +1,128 @@
+/****************************************************************************
+ * net/iob/iob_queue.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#ifdef CONFIG_NET_IOB
+
+#include <stdlib.h>
+
+#include <nuttx/net/iob.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_add_queue
+ *
+ * Description:
+ *   Add a chain to the end of a queue.
+ *
+ * Assumptions:
+ *   The caller serializes access to the queue.
+ *
+ ****************************************************************************/
+
+void iob_add_queue(FAR struct iob_s *iob, FAR struct iob_queue_s *qh)
+{
+  iob->io_qlink = NULL;
+  if (qh->qh_tail)
+    {
+      qh->qh_tail->io_qlink = iob;
+    }
+  else
+    {
+      qh->qh_head = iob;
+    }
+
+  qh->qh_tail = iob;
+}
+
+/****************************************************************************
+ * Name: iob_remove_queue
+ *
+ * Description:
+ *   Remove the chain at the head of a queue.  Returns NULL if the queue is
+ *   empty.
+ *
+ * Assumptions:
+ *   The caller serializes access to the queue.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_remove_queue(FAR struct iob_queue_s *qh)
+{
+  FAR struct iob_s *iob = qh->qh_head;
+
+  if (iob)
+    {
+      qh->qh_head = iob->io_qlink;
+      if (!qh->qh_head)
+        {
+          qh->qh_tail = NULL;
+        }
+
+      iob->io_qlink = NULL;
+    }
+
+  return iob;
+}
+
+/****************************************************************************
+ * Name: iob_free_queue
+ *
+ * Description:
+ *   Free every chain in a queue and leave the queue empty.
+ *
+ * Assumptions:
+ *   The caller serializes access to the queue.
+ *
+ ****************************************************************************/
+
+void iob_free_queue(FAR struct iob_queue_s *qh)
+{
+  FAR struct iob_s *iob;
+
+  while ((iob = iob_remove_queue(qh)) != NULL)
+    {
+      iob_free_chain(iob);
+    }
+}
+
+#endif /* CONFIG_NET_IOB */
@@ -0,0 +1,95 @@
+/****************************************************************************
+ * net/iob/iob_trimtail.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <nuttx/config.h>
+#ifdef CONFIG_NET_IOB
+
+#include <stdlib.h>
+
+#include <nuttx/net/iob.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: iob_trimtail
+ *
+ * Description:
+ *   Remove 'trimlen' bytes from the end of the chain, freeing the buffers
+ *   that become empty.
+ *
+ * Returned Value:
+ *   The first buffer of the chain, or NULL if no data remains.
+ *
+ * Assumptions:
+ *   The chain is not in a queue.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_trimtail(FAR struct iob_s *iob, unsigned int trimlen)
+{
+  FAR struct iob_s *last;
+  unsigned int keep;
+
+  if (trimlen >= iob->io_pktlen)
+    {
+      iob_free_chain(iob);
+      return NULL;
+    }
+
+  /* Find the buffer that holds the last byte to keep */
+
+  keep           = iob->io_pktlen - trimlen;
+  iob->io_pktlen = keep;
+
+  for (last = iob; keep > last->io_len; last = last->io_flink)
+    {
+      keep -= last->io_len;
+    }
+
+  /* Shorten it and free every buffer after it */
+
+  last->io_len = keep;
+  iob_free_chain(last->io_flink);
+  last->io_flink = NULL;
+
+  return iob;
+}
+
+#endif /* CONFIG_NET_IOB */
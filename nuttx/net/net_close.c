@@ -47,6 +47,7 @@
 #include <debug.h>
 
 #include <arch/irq.h>
+#include <nuttx/fs/fs.h>
 #include <nuttx/net/uip/uip-arch.h>
 
 #include "net_internal.h"
@@ -91,16 +92,20 @@ static uint16_t netclose_interrupt(struct uip_driver_s *dev, void *pvconn,
                                    void *pvpriv, uint16_t flags)
 {
   struct tcp_close_s *pstate = (struct tcp_close_s *)pvpriv;
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  struct uip_conn *conn = (struct uip_conn *)pvconn;
+#endif
 
   nllvdbg("flags: %04x\n", flags);
 
   if (pstate)
     {
-      /* UIP_CLOSE: The remote host has closed the connection
-       * UIP_ABORT: The remote host has aborted the connection
+      /* UIP_CLOSE:    The remote host has closed the connection
+       * UIP_ABORT:    The remote host has aborted the connection
+       * UIP_TIMEDOUT: The connection timed out
        */
 
-      if ((flags & (UIP_CLOSE|UIP_ABORT)) != 0)
+      if ((flags & (UIP_CLOSE|UIP_ABORT|UIP_TIMEDOUT)) != 0)
         {
           /* The disconnection is complete */
 
@@ -110,6 +115,23 @@ static uint16_t netclose_interrupt(struct uip_driver_s *dev, void *pvconn,
           sem_post(&pstate->cl_sem);
           nllvdbg("Resuming\n");
         }
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+      /* Check if there is still buffered, outgoing data.  If so, we must
+       * wait for the write buffers to drain before closing the connection.
+       */
+
+      else if (!sq_empty(&conn->write_q))
+        {
+          /* Drop data received in this state but allow the write buffer
+           * logic to continue sending.
+           */
+
+          dev->d_len = 0;
+          return flags & ~UIP_NEWDATA;
+        }
+#endif
+
       else
         {
           /* Drop data received in this state and make sure that UIP_CLOSE
@@ -170,7 +192,7 @@ static inline void netclose_disconnect(FAR struct socket *psock)
                state.cl_psock       = psock;
                sem_init(&state.cl_sem, 0, 0);
 
-               state.cl_cb->flags   = UIP_NEWDATA|UIP_POLL|UIP_CLOSE|UIP_ABORT;
+               state.cl_cb->flags   = UIP_NEWDATA|UIP_POLL|UIP_CLOSE|UIP_ABORT|UIP_TIMEDOUT;
                state.cl_cb->priv    = (void*)&state;
                state.cl_cb->event   = netclose_interrupt;
 
@@ -194,6 +216,37 @@ static inline void netclose_disconnect(FAR struct socket *psock)
 }
 #endif
 
+/****************************************************************************
+ * Function: tcp_freesndcb
+ *
+ * Description:
+ *   Release the callback used by the TCP write buffering logic.  This must
+ *   be done only when the last socket referring to the connection is
+ *   closed and after netclose_disconnect() has waited for the buffered data
+ *   to drain.
+ *
+ * Parameters:
+ *   conn - The TCP connection being freed
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called from normal user-level logic
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_WRITE_BUFFERS)
+static inline void tcp_freesndcb(FAR struct uip_conn *conn)
+{
+  if (conn->sndcb)
+    {
+      uip_tcpcallbackfree(conn, conn->sndcb);
+      conn->sndcb = NULL;
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -226,6 +279,10 @@ int psock_close(FAR struct socket *psock)
       goto errout;
     }
 
+  /* Remove the socket from any epoll interest sets */
+
+  epoll_release(psock);
+
   /* We perform the uIP close operation only if this is the last count on the socket.
    * (actually, I think the socket crefs only takes the values 0 and 1 right now).
    */
@@ -251,6 +308,9 @@ int psock_close(FAR struct socket *psock)
 
                   uip_unlisten(conn);          /* No longer accepting connections */
                   netclose_disconnect(psock);  /* Break any current connections */
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+                  tcp_freesndcb(conn);         /* Free the write buffer callback */
+#endif
                   conn->crefs = 0;             /* No more references on the connection */
                   uip_tcpfree(conn);           /* Free uIP resources */
                 }
@@ -74,6 +74,14 @@
 #  undef HAVE_NETPOLL
 #endif
 
+/* Check for TCP/IP read-ahead data */
+
+#ifdef CONFIG_NET_IOB
+#  define net_readahead_available(c) ((c)->readahead != NULL)
+#else
+#  define net_readahead_available(c) (!sq_empty(&(c)->readahead))
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -243,11 +251,11 @@ static inline int net_pollsetup(FAR struct socket *psock,
 #ifdef CONFIG_NET_TCPBACKLOG
   /* Check for read data or backlogged connection availability now */
 
-  if (!sq_empty(&conn->readahead) || uip_backlogavailable(conn))
+  if (net_readahead_available(conn) || uip_backlogavailable(conn))
 #else
   /* Check for read data availability now */
 
-  if (!sq_empty(&conn->readahead))
+  if (net_readahead_available(conn))
 #endif
     {
       /* Normal data may be read without blocking. */
@@ -402,9 +410,12 @@ static inline int net_pollteardown(FAR struct socket *psock,
  *
  ****************************************************************************/
 
-#if !defined(CONFIG_DISABLE_POLL) && defined(HAVE_NETPOLL)
+#ifndef CONFIG_DISABLE_POLL
 int psock_poll(FAR struct socket *psock, FAR struct pollfd *fds, bool setup)
 {
+#ifndef HAVE_NETPOLL
+  return -ENOSYS;
+#else
   int ret;
 
 #ifdef CONFIG_NET_UDP
@@ -432,6 +443,7 @@ int psock_poll(FAR struct socket *psock, FAR struct pollfd *fds, bool setup)
     }
 
   return ret;
+#endif /* HAVE_NETPOLL */
 }
 #endif
 
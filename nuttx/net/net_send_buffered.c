@@ -0,0 +1,569 @@
+/****************************************************************************
+ * net/net_send_buffered.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_WRITE_BUFFERS)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/net/uip/uip-arch.h>
+
+#include "net_internal.h"
+#include "uip/uip_internal.h"
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/* Sequence number comparisons that account for 32-bit wrap-around */
+
+#define SEQ_LT(a,b)  ((int32_t)((a) - (b)) < 0)
+#define SEQ_LE(a,b)  ((int32_t)((a) - (b)) <= 0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: send_ackbuffers
+ *
+ * Description:
+ *   Release all write buffers whose data has been completely acknowledged
+ *   by the peer.  If the oldest remaining buffer was only partially
+ *   acknowledged, then the acknowledged data is removed from the front of
+ *   that buffer so that the sequence number of the first byte in the write
+ *   queue is always the oldest, unacknowledged sequence number.
+ *
+ * Parameters:
+ *   conn     The connection structure associated with the socket
+ *   ackno    The acknowledged sequence number
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static inline void send_ackbuffers(FAR struct uip_conn *conn, uint32_t ackno)
+{
+  FAR struct uip_wrbuffer_s *wrb;
+
+  while ((wrb = (FAR struct uip_wrbuffer_s *)sq_peek(&conn->write_q)) != NULL)
+    {
+      uint32_t lastseq = wrb->wb_seqno + wrb->wb_nbytes;
+
+      if (SEQ_LE(lastseq, ackno))
+        {
+          /* The whole buffer has been ACKed.  Return it to the free list */
+
+          nllvdbg("ACK: seqno=%08x nbytes=%d\n", wrb->wb_seqno, wrb->wb_nbytes);
+
+          (void)sq_remfirst(&conn->write_q);
+          uip_tcpwrbufferrelease(wrb);
+        }
+      else
+        {
+          /* Was part of this buffer acknowledged? */
+
+          if (SEQ_LT(wrb->wb_seqno, ackno))
+            {
+              uint16_t nacked = (uint16_t)(ackno - wrb->wb_seqno);
+
+              nllvdbg("Partial ACK: seqno=%08x nacked=%d of %d\n",
+                      wrb->wb_seqno, nacked, wrb->wb_nbytes);
+
+              wrb->wb_nbytes -= nacked;
+              memmove(wrb->wb_buffer, &wrb->wb_buffer[nacked], wrb->wb_nbytes);
+              wrb->wb_seqno   = ackno;
+            }
+
+          break;
+        }
+    }
+}
+
+/****************************************************************************
+ * Function: send_freebuffers
+ *
+ * Description:
+ *   Release all of the write buffers attached to the connection.  This is
+ *   done when the connection has been lost.
+ *
+ * Parameters:
+ *   conn     The connection structure associated with the socket
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static inline void send_freebuffers(FAR struct uip_conn *conn)
+{
+  FAR struct uip_wrbuffer_s *wrb;
+
+  while ((wrb = (FAR struct uip_wrbuffer_s *)sq_remfirst(&conn->write_q)) != NULL)
+    {
+      uip_tcpwrbufferrelease(wrb);
+    }
+}
+
+/****************************************************************************
+ * Function: send_interrupt
+ *
+ * Description:
+ *   This function is called from the interrupt level to perform the actual
+ *   send operation when polled by the uIP layer.  Data is sent from the
+ *   write buffers attached to the connection.  Several segments may be in
+ *   flight at the same time, limited by the window advertised by the peer.
+ *
+ *   The logic maintains the following relationship between the connection
+ *   fields:  sndseq + unacked is always the sequence number of the next,
+ *   new byte to be sent.  The sequence number of the first byte in the
+ *   write queue is always the oldest, unacknowledged sequence number.
+ *
+ * Parameters:
+ *   dev      The sructure of the network driver that caused the interrupt
+ *   conn     The connection structure associated with the socket
+ *   flags    Set of events describing why the callback was invoked
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t send_interrupt(FAR struct uip_driver_s *dev, FAR void *pvconn,
+                               FAR void *pvpriv, uint16_t flags)
+{
+  FAR struct uip_conn *conn = (FAR struct uip_conn*)pvconn;
+  FAR struct uip_wrbuffer_s *wrb;
+
+  nllvdbg("flags: %04x unacked: %d\n", flags, conn->unacked);
+
+  /* If this packet contains an acknowledgement, then release all of the
+   * write buffers that have been completely acknowledged.  NOTE:  uIP
+   * updates sndseq on receipt of an ACK *before* this function is called.
+   * In that case sndseq holds the acknowledged sequence number.
+   */
+
+  if ((flags & UIP_ACKDATA) != 0)
+    {
+      send_ackbuffers(conn, uip_tcpgetsequence(conn->sndseq));
+    }
+
+  /* Check for a loss of connection */
+
+  else if ((flags & (UIP_CLOSE|UIP_ABORT|UIP_TIMEDOUT)) != 0)
+    {
+      /* Discard all buffered data.  The connection monitor reports the
+       * loss of connection to the socket.
+       */
+
+      nllvdbg("Lost connection\n");
+      send_freebuffers(conn);
+      return flags;
+    }
+
+  /* We get here if (1) an ACK was received, (2) we have been asked to
+   * retransmit data, or (3) we are being polled.  We are free to send
+   * more data to receiver -- UNLESS the buffer contains unprocessed
+   * incoming data or the outgoing packet has already been claimed (which
+   * could happen if the socket was dup'ed).  In that event, we will have
+   * to wait for the next polling cycle.
+   */
+
+  wrb = (FAR struct uip_wrbuffer_s *)sq_peek(&conn->write_q);
+  if ((flags & UIP_NEWDATA) == 0 && dev->d_sndlen == 0 && wrb != NULL)
+    {
+      uint32_t unaseq;
+      uint32_t nxtseq;
+      uint32_t inflight;
+      uint32_t winsize;
+
+      /* The first buffer holds the oldest, unacknowledged byte */
+
+      unaseq = wrb->wb_seqno;
+
+      /* If we are asked to retransmit, then go back and resend all data
+       * starting with the oldest, unacknowledged byte.  Otherwise, continue
+       * with the next byte that has not yet been sent.
+       */
+
+      if ((flags & UIP_REXMIT) != 0)
+        {
+          nxtseq = unaseq;
+        }
+      else
+        {
+          nxtseq = uip_tcpgetsequence(conn->sndseq) + conn->unacked;
+        }
+
+      /* Get the number of bytes in flight and the size of the window that
+       * the peer has advertised.  Nothing new is sent into a zero window.
+       * The data already in flight will time out and the first segment of
+       * it will be retransmitted;  that retransmission serves as the window
+       * probe.  Otherwise, the polls will resume sending when an ACK opens
+       * the window again.
+       */
+
+      inflight = nxtseq - unaseq;
+      winsize  = conn->winsize;
+
+      if (winsize == 0 && (flags & UIP_REXMIT) != 0)
+        {
+          winsize = uip_mss(conn);
+        }
+
+      /* Find the write buffer that holds the next byte to send */
+
+      while (wrb != NULL &&
+             !SEQ_LT(nxtseq, wrb->wb_seqno + wrb->wb_nbytes))
+        {
+          wrb = (FAR struct uip_wrbuffer_s *)sq_next(&wrb->wb_node);
+        }
+
+      if (wrb != NULL && inflight < winsize)
+        {
+          uint32_t offset = nxtseq - wrb->wb_seqno;
+          uint32_t sndlen = wrb->wb_nbytes - offset;
+
+          /* Limit the size of the segment to the MSS and to the space
+           * remaining in the peer's window.
+           */
+
+          if (sndlen > uip_mss(conn))
+            {
+              sndlen = uip_mss(conn);
+            }
+
+          if (sndlen > winsize - inflight)
+            {
+              sndlen = winsize - inflight;
+            }
+
+          /* Set the sequence number for this packet.  We overwrite the value
+           * of sndseq here before the packet is sent.
+           */
+
+          nllvdbg("SEND: seqno %08x sndlen %d inflight %d\n",
+                  nxtseq, sndlen, inflight);
+          uip_tcpsetsequence(conn->sndseq, nxtseq);
+
+          /* Then set-up to send that amount of data. (this won't actually
+           * happen until the polling cycle completes).
+           */
+
+          uip_send(dev, &wrb->wb_buffer[offset], sndlen);
+
+          /* Set the number of unacknowledged bytes so that sndseq + unacked
+           * will be the sequence number of the next byte to send.  On a
+           * retransmission, the count will be used as is; otherwise
+           * uip_tcpappsend() will add the count of bytes in this packet.
+           */
+
+          if ((flags & UIP_REXMIT) != 0)
+            {
+              conn->unacked = sndlen;
+            }
+          else
+            {
+              conn->unacked = 0;
+            }
+        }
+    }
+
+  return flags;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_send
+ *
+ * Description:
+ *   The send() call may be used only when the socket is in a connected state
+ *   (so that the intended recipient is known). The only difference between
+ *   send() and write() is the presence of flags. With zero flags parameter,
+ *   send() is equivalent to write(). Also, send(sockfd,buf,len,flags) is
+ *   equivalent to sendto(sockfd,buf,len,flags,NULL,0).
+ *
+ *   This version of psock_send() supports TCP write buffering:  The user
+ *   data is copied into write buffers and this function returns without
+ *   waiting for the data to be acknowledged.  This function will block
+ *   only if all write buffers are in use.
+ *
+ * Parameters:
+ *   psock    An instance of the internal socket structure.
+ *   buf      Data to send
+ *   len      Length of data to send
+ *   flags    Send flags
+ *
+ * Returned Value:
+ *   On success, returns the number of characters sent.  On  error,
+ *   -1 is returned, and errno is set appropriately:
+ *
+ *   EBADF
+ *     An invalid descriptor was specified.
+ *   EINTR
+ *      A signal occurred before any data was transmitted.
+ *   ENOMEM
+ *     No memory available.
+ *   ENOTCONN
+ *     The socket is not connected, and no target has been given.
+ *
+ *   See send() for the complete list of possible error values.
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t psock_send(FAR struct socket *psock, FAR const void *buf, size_t len,
+                   int flags)
+{
+  FAR const uint8_t *src = (FAR const uint8_t *)buf;
+  FAR struct uip_conn *conn;
+  FAR struct uip_wrbuffer_s *wrb;
+  uip_lock_t save;
+  size_t nsent = 0;
+  size_t chunk;
+  int err;
+
+  /* Verify that the sockfd corresponds to valid, allocated socket */
+
+  if (!psock || psock->s_crefs <= 0)
+    {
+      err = EBADF;
+      goto errout;
+    }
+
+  /* If this is an un-connected socket, then return ENOTCONN */
+
+  if (psock->s_type != SOCK_STREAM || !_SS_ISCONNECTED(psock->s_flags))
+    {
+      err = ENOTCONN;
+      goto errout;
+    }
+
+  /* Set the socket state to sending */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
+  conn = (FAR struct uip_conn *)psock->s_conn;
+
+  /* Allocate resources to receive a callback.  The callback instance is
+   * retained in the connection structure until the last socket referring
+   * to the connection is closed because buffered data may be sent long
+   * after this function returns.
+   */
+
+  save = uip_lock();
+  if (!conn->sndcb)
+    {
+      conn->sndcb = uip_tcpcallbackalloc(conn);
+      if (!conn->sndcb)
+        {
+          uip_unlock(save);
+          err = ENOMEM;
+          goto errout_with_state;
+        }
+
+      /* Set up the callback in the connection */
+
+      conn->sndcb->flags = UIP_ACKDATA|UIP_REXMIT|UIP_POLL|UIP_CLOSE|UIP_ABORT|UIP_TIMEDOUT;
+      conn->sndcb->priv  = NULL;
+      conn->sndcb->event = send_interrupt;
+    }
+
+  uip_unlock(save);
+
+  /* Copy all of the user data into write buffers */
+
+  while (nsent < len)
+    {
+      save = uip_lock();
+
+      /* The connection may have been lost while we were waiting for a
+       * buffer.
+       */
+
+      if (!_SS_ISCONNECTED(psock->s_flags))
+        {
+          uip_unlock(save);
+          err = ENOTCONN;
+          goto errout_with_partial;
+        }
+
+      /* Is there space remaining in the last buffer in the write queue?
+       * Any data appended to the last buffer has not yet been sent, even if
+       * part of the buffer has already been sent.
+       */
+
+      wrb = (FAR struct uip_wrbuffer_s *)conn->write_q.tail;
+      if (wrb && wrb->wb_nbytes < CONFIG_NET_TCP_WRITE_BUFSIZE)
+        {
+          chunk = CONFIG_NET_TCP_WRITE_BUFSIZE - wrb->wb_nbytes;
+          if (chunk > len - nsent)
+            {
+              chunk = len - nsent;
+            }
+
+          memcpy(&wrb->wb_buffer[wrb->wb_nbytes], &src[nsent], chunk);
+          wrb->wb_nbytes += chunk;
+          nsent          += chunk;
+
+          uip_unlock(save);
+          continue;
+        }
+
+      uip_unlock(save);
+
+      /* Allocate a new write buffer.  This may block until the peer
+       * acknowledges data in a buffer that is already in use.
+       */
+
+      wrb = uip_tcpwrbufferalloc();
+      if (!wrb)
+        {
+          /* We were awakened by a signal */
+
+          err = EINTR;
+          goto errout_with_partial;
+        }
+
+      save = uip_lock();
+      if (!_SS_ISCONNECTED(psock->s_flags))
+        {
+          uip_tcpwrbufferrelease(wrb);
+          uip_unlock(save);
+          err = ENOTCONN;
+          goto errout_with_partial;
+        }
+
+      /* Fill the buffer with as much data as it will hold */
+
+      chunk = len - nsent;
+      if (chunk > CONFIG_NET_TCP_WRITE_BUFSIZE)
+        {
+          chunk = CONFIG_NET_TCP_WRITE_BUFSIZE;
+        }
+
+      memcpy(wrb->wb_buffer, &src[nsent], chunk);
+      wrb->wb_nbytes = chunk;
+      nsent         += chunk;
+
+      /* Assign the sequence number of the first byte in the buffer.  If the
+       * write queue is empty, then all previously sent data has been ACKed
+       * and sndseq holds the next sequence number to use.
+       */
+
+      if (conn->write_q.tail)
+        {
+          FAR struct uip_wrbuffer_s *last =
+            (FAR struct uip_wrbuffer_s *)conn->write_q.tail;
+
+          wrb->wb_seqno = last->wb_seqno + last->wb_nbytes;
+        }
+      else
+        {
+          wrb->wb_seqno = uip_tcpgetsequence(conn->sndseq);
+        }
+
+      sq_addlast(&wrb->wb_node, &conn->write_q);
+      uip_unlock(save);
+
+      /* Notify the device driver of the availaibilty of TX data */
+
+      netdev_txnotify(&conn->ripaddr);
+    }
+
+  /* Notify the device driver in case data was only appended to an
+   * existing write buffer.
+   */
+
+  netdev_txnotify(&conn->ripaddr);
+
+  /* Set the socket state to idle */
+
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+  /* Return the number of bytes actually buffered */
+
+  return nsent;
+
+errout_with_partial:
+  /* If some data was already buffered, then return the partial count */
+
+  if (nsent > 0)
+    {
+      netdev_txnotify(&conn->ripaddr);
+      psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+      return nsent;
+    }
+
+errout_with_state:
+  psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_IDLE);
+
+errout:
+  set_errno(err);
+  return ERROR;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_WRITE_BUFFERS */
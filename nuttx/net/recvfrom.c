@@ -44,6 +44,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <errno.h>
 #include <debug.h>
@@ -179,7 +180,7 @@ static inline void recvfrom_newtcpdata(FAR struct uip_driver_s *dev,
       uint16_t             buflen = dev->d_len - recvlen;
       uint16_t             nsaved;
 
-      nsaved = uip_datahandler(conn, buffer, buflen);
+      nsaved = uip_datahandler(dev, conn, buffer, buflen);
 
       /* There are complicated buffering issues that are not addressed fully
        * here.  For example, what if up_datahandler() cannot buffer the
@@ -260,6 +261,41 @@ static inline void recvfrom_newudpdata(FAR struct uip_driver_s *dev,
  ****************************************************************************/
 
 #if defined(CONFIG_NET_TCP) && CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#ifdef CONFIG_NET_IOB
+static inline void recvfrom_readahead(struct recvfrom_s *pstate)
+{
+  FAR struct uip_conn *conn = (FAR struct uip_conn *)pstate->rf_sock->s_conn;
+  FAR struct iob_s    *iob  = conn->readahead;
+  size_t               recvlen;
+
+  /* Check there is any TCP data already buffered in the read-ahead I/O
+   * buffer chain.
+   */
+
+  if (iob && pstate->rf_buflen > 0)
+    {
+      /* Copy as much of the read-ahead data as will fit into the user
+       * buffer.
+       */
+
+      recvlen = iob_copyout((FAR uint8_t *)pstate->rf_buffer, iob,
+                            pstate->rf_buflen, 0);
+      nllvdbg("Received %d bytes (of %d)\n", recvlen, iob->io_pktlen);
+
+      /* Update the accumulated size of the data read */
+
+      pstate->rf_recvlen += recvlen;
+      pstate->rf_buffer  += recvlen;
+      pstate->rf_buflen  -= recvlen;
+
+      /* Remove the data that was read from the front of the chain.  Any data
+       * that remains stays where it is.
+       */
+
+      conn->readahead = iob_trimhead(iob, recvlen);
+    }
+}
+#else
 static inline void recvfrom_readahead(struct recvfrom_s *pstate)
 {
   FAR struct uip_conn        *conn = (FAR struct uip_conn *)pstate->rf_sock->s_conn;
@@ -326,7 +362,79 @@ static inline void recvfrom_readahead(struct recvfrom_s *pstate)
     }
   while (readahead && pstate->rf_buflen > 0);
 }
-#endif /* CONFIG_NET_UDP || CONFIG_NET_TCP */
+#endif /* CONFIG_NET_IOB */
+#endif /* CONFIG_NET_TCP && CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 */
+
+/****************************************************************************
+ * Function: recvfrom_udpreadahead
+ *
+ * Description:
+ *   Take the oldest datagram from the UDP read-ahead queue
+ *
+ * Parameters:
+ *   pstate   recvfrom state structure
+ *
+ * Returned Value:
+ *   true if a datagram was received from the queue.
+ *
+ * Assumptions:
+ *   Called with the network locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+static inline bool recvfrom_udpreadahead(struct recvfrom_s *pstate)
+{
+  FAR struct uip_udp_conn *conn = (FAR struct uip_udp_conn *)pstate->rf_sock->s_conn;
+#ifdef CONFIG_NET_IPv6
+  FAR struct sockaddr_in6 *infrom = pstate->rf_from;
+#else
+  FAR struct sockaddr_in  *infrom = pstate->rf_from;
+#endif
+  struct uip_udpsender_s   sender;
+  FAR struct iob_s        *iob;
+  size_t                   recvlen;
+
+  iob = iob_remove_queue(&conn->readahead);
+  if (!iob)
+    {
+      return false;
+    }
+
+  conn->nreadahead--;
+
+  /* The chain holds the address of the sender followed by the datagram.  As
+   * for a datagram that is received directly, any data that does not fit in
+   * the user buffer is discarded.
+   */
+
+  if (infrom)
+    {
+      (void)iob_copyout((FAR uint8_t *)&sender, iob,
+                        sizeof(struct uip_udpsender_s), 0);
+
+      infrom->sin_family = AF_INET;
+      infrom->sin_port   = sender.us_port;
+#ifdef CONFIG_NET_IPv6
+      uip_ipaddr_copy(infrom->sin6_addr.s6_addr, sender.us_addr);
+#else
+      uip_ipaddr_copy(infrom->sin_addr.s_addr, sender.us_addr);
+#endif
+    }
+
+  recvlen = iob_copyout((FAR uint8_t *)pstate->rf_buffer, iob,
+                        pstate->rf_buflen, sizeof(struct uip_udpsender_s));
+  nllvdbg("Received %d bytes (of %d)\n",
+          recvlen, iob->io_pktlen - sizeof(struct uip_udpsender_s));
+
+  pstate->rf_recvlen += recvlen;
+  pstate->rf_buffer  += recvlen;
+  pstate->rf_buflen  -= recvlen;
+
+  iob_free_chain(iob);
+  return true;
+}
+#endif /* CONFIG_NET_UDP_READAHEAD */
 
 /****************************************************************************
  * Function: recvfrom_timeout
@@ -938,6 +1046,18 @@ static ssize_t udp_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
       goto errout_with_state;
     }
 
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* Return the oldest datagram that arrived while no one was receiving, if
+   * there is one.
+   */
+
+  if (recvfrom_udpreadahead(&state))
+    {
+      ret = state.rf_recvlen;
+      goto errout_with_state;
+    }
+#endif
+
   /* Set up the callback in the connection */
 
   state.rf_cb = uip_udpcallbackalloc(conn);
@@ -64,6 +64,12 @@
  * Definitions
  ****************************************************************************/
 
+/* If TCP write buffering is enabled, then psock_send() is provided by
+ * net_send_buffered.c.  Only the send() wrapper is provided here.
+ */
+
+#ifndef CONFIG_NET_TCP_WRITE_BUFFERS
+
 #if defined(CONFIG_NET_TCP_SPLIT) && !defined(CONFIG_NET_TCP_SPLIT_SIZE)
 #  define CONFIG_NET_TCP_SPLIT_SIZE 40
 #endif
@@ -627,6 +633,8 @@ errout:
   return ERROR;
 }
 
+#endif /* !CONFIG_NET_TCP_WRITE_BUFFERS */
+
 /****************************************************************************
  * Function: send
  *
@@ -41,6 +41,8 @@
 #ifdef CONFIG_NET
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #include <debug.h>
 
 #include <nuttx/net/uip/uipopt.h>
@@ -65,6 +67,217 @@
  ****************************************************************************/
 
 #if !UIP_ARCH_CHKSUM
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+
+/****************************************************************************
+ * Name: chksum_fold
+ *
+ * Description:
+ *   Fold a 64-bit sum of 16- and 32-bit words into a 16-bit one's
+ *   complement sum.
+ *
+ ****************************************************************************/
+
+static inline uint16_t chksum_fold(uint64_t acc)
+{
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffffffff) + (acc >> 32);
+  acc = (acc & 0xffff) + (acc >> 16);
+  acc = (acc & 0xffff) + (acc >> 16);
+  return (uint16_t)acc;
+}
+
+/****************************************************************************
+ * Name: chksum_words and chksum_copywords
+ *
+ * Description:
+ *   Add 'len' bytes at the 16-bit aligned address 'src' to 'acc' as 16-bit
+ *   words in host byte order.  Because 0x10000 is 1 in one's complement
+ *   arithmetic, the aligned part of the buffer can be added a 32-bit word
+ *   at a time.  The 64-bit sum cannot overflow, so the carries are folded
+ *   in only once by chksum_fold().  chksum_copywords() also copies the
+ *   bytes to 'dest', which must have the same 32-bit alignment as 'src'.
+ *
+ ****************************************************************************/
+
+static uint64_t chksum_words(uint64_t acc, FAR const uint8_t *src,
+                             uint16_t len)
+{
+  FAR const uint32_t *wsrc;
+  uint16_t tmp;
+
+  if (((uintptr_t)src & 2) != 0 && len >= 2)
+    {
+      acc += *(FAR const uint16_t *)src;
+      src += 2;
+      len -= 2;
+    }
+
+  for (wsrc = (FAR const uint32_t *)src; len >= 16; wsrc += 4, len -= 16)
+    {
+      acc += wsrc[0];
+      acc += wsrc[1];
+      acc += wsrc[2];
+      acc += wsrc[3];
+    }
+
+  for (; len >= 4; wsrc++, len -= 4)
+    {
+      acc += *wsrc;
+    }
+
+  src = (FAR const uint8_t *)wsrc;
+  if (len >= 2)
+    {
+      acc += *(FAR const uint16_t *)src;
+      src += 2;
+      len -= 2;
+    }
+
+  /* A final odd byte is the first byte of a word padded with zero */
+
+  if (len > 0)
+    {
+      tmp = 0;
+      *(FAR uint8_t *)&tmp = *src;
+      acc += tmp;
+    }
+
+  return acc;
+}
+
+static uint64_t chksum_copywords(uint64_t acc, FAR uint8_t *dest,
+                                 FAR const uint8_t *src, uint16_t len)
+{
+  FAR const uint32_t *wsrc;
+  FAR uint32_t *wdest;
+  uint32_t w0;
+  uint32_t w1;
+  uint32_t w2;
+  uint32_t w3;
+  uint16_t tmp;
+
+  if (((uintptr_t)src & 2) != 0 && len >= 2)
+    {
+      tmp = *(FAR const uint16_t *)src;
+      *(FAR uint16_t *)dest = tmp;
+      acc  += tmp;
+      src  += 2;
+      dest += 2;
+      len  -= 2;
+    }
+
+  wsrc  = (FAR const uint32_t *)src;
+  wdest = (FAR uint32_t *)dest;
+
+  for (; len >= 16; wsrc += 4, wdest += 4, len -= 16)
+    {
+      w0 = wsrc[0];
+      w1 = wsrc[1];
+      w2 = wsrc[2];
+      w3 = wsrc[3];
+
+      wdest[0] = w0;
+      wdest[1] = w1;
+      wdest[2] = w2;
+      wdest[3] = w3;
+
+      acc += w0;
+      acc += w1;
+      acc += w2;
+      acc += w3;
+    }
+
+  for (; len >= 4; wsrc++, wdest++, len -= 4)
+    {
+      w0 = *wsrc;
+      *wdest = w0;
+      acc += w0;
+    }
+
+  src  = (FAR const uint8_t *)wsrc;
+  dest = (FAR uint8_t *)wdest;
+  if (len >= 2)
+    {
+      tmp = *(FAR const uint16_t *)src;
+      *(FAR uint16_t *)dest = tmp;
+      acc  += tmp;
+      src  += 2;
+      dest += 2;
+      len  -= 2;
+    }
+
+  if (len > 0)
+    {
+      tmp = 0;
+      *(FAR uint8_t *)&tmp = *src;
+      *dest = *src;
+      acc += tmp;
+    }
+
+  return acc;
+}
+
+/****************************************************************************
+ * Name: chksum_finish
+ *
+ * Description:
+ *   Fold the host byte order sum 'acc' and add it to 'sum' (a sum of
+ *   big-endian words).  A little-endian sum has its bytes swapped.  So
+ *   does the sum of a buffer that started at an odd address:  its first
+ *   byte was added as the second byte of a word, so every byte was added
+ *   in the wrong half of its word.
+ *
+ ****************************************************************************/
+
+static uint16_t chksum_finish(uint16_t sum, uint64_t acc, bool odd)
+{
+  uint16_t t = chksum_fold(acc);
+
+#ifndef CONFIG_ENDIAN_BIG
+  odd = !odd;
+#endif
+
+  if (odd)
+    {
+      t = (t << 8) | (t >> 8);
+    }
+
+  sum += t;
+  if (sum < t)
+    {
+      sum++; /* carry */
+    }
+
+  return sum;
+}
+
+static uint16_t chksum(uint16_t sum, FAR const uint8_t *data, uint16_t len)
+{
+  uint64_t acc = 0;
+  bool odd = false;
+  uint16_t tmp;
+
+  /* Make the rest of the buffer 16-bit aligned */
+
+  if (((uintptr_t)data & 1) != 0 && len > 0)
+    {
+      tmp = 0;
+      ((FAR uint8_t *)&tmp)[1] = *data++;
+      acc = tmp;
+      len--;
+      odd = true;
+    }
+
+  acc = chksum_words(acc, data, len);
+
+  /* Return sum in host byte order. */
+
+  return chksum_finish(sum, acc, odd);
+}
+
+#else /* CONFIG_NET_CHKSUM_OPTSPEED */
+
 static uint16_t chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 {
   uint16_t t;
@@ -101,12 +314,17 @@ static uint16_t chksum(uint16_t sum, const uint8_t *data, uint16_t len)
 
   return sum;
 }
+#endif /* CONFIG_NET_CHKSUM_OPTSPEED */
 
 static uint16_t upper_layer_chksum(struct uip_driver_s *dev, uint8_t proto)
 {
   struct uip_ip_hdr *pbuf = BUF;
+  uint8_t *upper = &dev->d_buf[UIP_IPH_LEN + UIP_LLH_LEN];
   uint16_t upper_layer_len;
   uint16_t sum;
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+  int hdrlen;
+#endif
 
 #ifdef CONFIG_NET_IPv6
   upper_layer_len = (((uint16_t)(pbuf->len[0]) << 8) + pbuf->len[1]);
@@ -124,9 +342,31 @@ static uint16_t upper_layer_chksum(struct uip_driver_s *dev, uint8_t proto)
 
   sum = chksum(sum, (uint8_t *)&pbuf->srcipaddr, 2 * sizeof(uip_ipaddr_t));
 
-  /* Sum TCP header and data. */
+  /* Sum TCP header and data.  If uip_send() summed the data of an outgoing
+   * TCP or UDP packet while it copied it in, only the header is left.  The
+   * data starts at an even offset, so the two sums can simply be added.
+   */
 
-  sum = chksum(sum, &dev->d_buf[UIP_IPH_LEN + UIP_LLH_LEN], upper_layer_len);
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+  hdrlen = dev->d_snddata - upper;
+  if (dev->d_sndsum != 0 && proto != UIP_PROTO_ICMP6 &&
+      dev->d_sndlen > 0 && hdrlen > 0 && (hdrlen & 1) == 0 &&
+      hdrlen + dev->d_sndlen == upper_layer_len)
+    {
+      sum = chksum(sum, upper, hdrlen);
+      sum += dev->d_sndsum;
+      if (sum < dev->d_sndsum)
+        {
+          sum++; /* carry */
+        }
+
+      dev->d_sndsum = 0;
+    }
+  else
+#endif
+    {
+      sum = chksum(sum, upper, upper_layer_len);
+    }
 
   return (sum == 0) ? 0xffff : htons(sum);
 }
@@ -187,6 +427,44 @@ uint16_t uip_chksum(uint16_t *data, uint16_t len)
   return htons(chksum(0, (uint8_t *)data, len));
 }
 
+/* Copy a buffer and calculate its checksum in the same pass. */
+
+uint16_t uip_copychksum(FAR uint8_t *dest, FAR const uint8_t *src,
+                        uint16_t len)
+{
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+  uint64_t acc = 0;
+  bool odd = false;
+  uint16_t tmp;
+
+  /* The words can be copied and summed together only if the buffers have
+   * the same alignment.
+   */
+
+  if ((((uintptr_t)dest ^ (uintptr_t)src) & 3) != 0)
+    {
+      memcpy(dest, src, len);
+      return chksum(0, dest, len);
+    }
+
+  if (((uintptr_t)src & 1) != 0 && len > 0)
+    {
+      tmp = 0;
+      ((FAR uint8_t *)&tmp)[1] = *src;
+      *dest++ = *src++;
+      acc = tmp;
+      len--;
+      odd = true;
+    }
+
+  acc = chksum_copywords(acc, dest, src, len);
+  return chksum_finish(0, acc, odd);
+#else
+  memcpy(dest, src, len);
+  return chksum(0, dest, len);
+#endif
+}
+
 /* Calculate the IP header checksum of the packet header in d_buf. */
 
 #ifndef UIP_ARCH_IPCHKSUM
@@ -123,6 +123,12 @@ void uip_initialize(void)
 
   uip_callbackinit();
 
+  /* Initialize the pool of I/O buffers */
+
+#ifdef CONFIG_NET_IOB
+  iob_initialize();
+#endif
+
   /* Initialize the listening port structures */
 
 #ifdef CONFIG_NET_TCP
@@ -134,9 +140,15 @@ void uip_initialize(void)
 
   /* Initialize the TCP/IP read-ahead buffering */
 
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
   uip_tcpreadaheadinit();
 #endif
+
+  /* Initialize the TCP/IP write buffering */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  uip_tcpwrbufferinit();
+#endif
 #endif /* CONFIG_NET_TCP */
 
   /* Initialize the UDP connection structures */
@@ -306,6 +306,14 @@ void uip_input(struct uip_driver_s *dev)
   uip_stat.ip.recv++;
 #endif
 
+#ifdef CONFIG_NET_CHKSUM_OPTSPEED
+  /* The checksum that uip_send() saved for data that was never sent does
+   * not belong to the incoming packet.
+   */
+
+  dev->d_sndsum = 0;
+#endif
+
   /* Start of IP input header processing code. */
 
 #ifdef CONFIG_NET_IPv6
@@ -380,6 +388,12 @@ void uip_input(struct uip_driver_s *dev)
         {
           goto drop;
         }
+
+#ifdef CONFIG_NET_IOB
+      /* d_buf now holds the reassembled packet, not the received frame */
+
+      uip_iobrelease(dev);
+#endif
 #else /* UIP_REASSEMBLY */
 #ifdef CONFIG_NET_STATISTICS
       uip_stat.ip.drop++;
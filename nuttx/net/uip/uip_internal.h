@@ -51,15 +51,38 @@
 #include <errno.h>
 #include <arch/irq.h>
 #include <nuttx/net/uip/uip.h>
+#include <nuttx/net/iob.h>
 
 /****************************************************************************
  * Public Macro Definitions
  ****************************************************************************/
 
+/* Connection hash tables.  Port numbers are hashed in network order by
+ * folding the two bytes together so that consecutive port numbers fall
+ * in different buckets.
+ */
+
+#ifdef CONFIG_NET_HASHCONN
+#  define UIP_HASHCONN_MASK  (CONFIG_NET_HASHCONN_SIZE - 1)
+#  define UIP_PORTHASH(p)    (((p) ^ ((p) >> 8)) & UIP_HASHCONN_MASK)
+#endif
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
 
+/* Each datagram in a UDP read-ahead queue is held in one I/O buffer chain
+ * that begins with the address of its sender.
+ */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+struct uip_udpsender_s
+{
+  uint16_t     us_port;   /* Source port, in network byte order */
+  uip_ipaddr_t us_addr;   /* Source IP address */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -102,6 +125,15 @@ EXTERN void uip_callbackfree(FAR struct uip_callback_s *cb, struct uip_callback_
 EXTERN uint16_t uip_callbackexecute(FAR struct uip_driver_s *dev, void *pvconn,
                                   uint16_t flags, FAR struct uip_callback_s *list);
 
+/* Defined in uip_iob.c *****************************************************/
+
+#ifdef CONFIG_NET_IOB
+EXTERN FAR struct iob_s *uip_iobtake(FAR struct uip_driver_s *dev,
+                                     FAR const uint8_t *buffer,
+                                     uint16_t buflen, uint16_t headroom,
+                                     unsigned int maxiobs);
+#endif
+
 #ifdef CONFIG_NET_TCP
 /* Defined in uip_tcpconn.c *************************************************/
 
@@ -157,17 +189,26 @@ EXTERN void uip_tcpinput(struct uip_driver_s *dev);
 EXTERN uint16_t uip_tcpcallback(FAR struct uip_driver_s *dev,
                                 FAR struct uip_conn *conn, uint16_t flags);
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
-EXTERN uint16_t uip_datahandler(FAR struct uip_conn *conn,
+EXTERN uint16_t uip_datahandler(FAR struct uip_driver_s *dev,
+                                FAR struct uip_conn *conn,
                                 FAR uint8_t *buffer, uint16_t nbytes);
 #endif
 
 /* Defined in uip_tcpreadahead.c ********************************************/
 
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
 EXTERN void uip_tcpreadaheadinit(void);
 EXTERN struct uip_readahead_s *uip_tcpreadaheadalloc(void);
 EXTERN void uip_tcpreadaheadrelease(struct uip_readahead_s *buf);
-#endif /* CONFIG_NET_NTCP_READAHEAD_BUFFERS */
+#endif /* CONFIG_NET_NTCP_READAHEAD_BUFFERS && !CONFIG_NET_IOB */
+
+/* Defined in uip_tcpwrbuffer.c *********************************************/
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+EXTERN void uip_tcpwrbufferinit(void);
+EXTERN FAR struct uip_wrbuffer_s *uip_tcpwrbufferalloc(void);
+EXTERN void uip_tcpwrbufferrelease(FAR struct uip_wrbuffer_s *wrb);
+#endif /* CONFIG_NET_TCP_WRITE_BUFFERS */
 
 #endif /* CONFIG_NET_TCP */
 
@@ -0,0 +1,216 @@
+/****************************************************************************
+ * net/uip/uip_iob.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_IOB)
+
+#include <stdint.h>
+#include <errno.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/net/iob.h>
+#include <nuttx/net/uip/uipopt.h>
+#include <nuttx/net/uip/uip.h>
+#include <nuttx/net/uip/uip-arch.h>
+
+#include "uip_internal.h"
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: uip_iobreceive
+ *
+ * Description:
+ *   Load a frame that the driver received into a chain of I/O buffers into
+ *   d_buf and attach the chain to the device.  See uip-arch.h.
+ *
+ * Returned Value:
+ *   OK on success; -E2BIG if the frame does not fit in d_buf.  The chain
+ *   then still belongs to the caller.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+int uip_iobreceive(FAR struct uip_driver_s *dev, FAR struct iob_s *iob)
+{
+  DEBUGASSERT(dev && iob && dev->d_iob == NULL);
+
+  if (iob->io_pktlen > CONFIG_NET_BUFSIZE)
+    {
+      nlldbg("Frame too large: %d\n", iob->io_pktlen);
+      return -E2BIG;
+    }
+
+  dev->d_len = iob_copyout(dev->d_buf, iob, iob->io_pktlen, 0);
+  dev->d_iob = iob;
+  return OK;
+}
+
+/****************************************************************************
+ * Function: uip_iobrelease
+ *
+ * Description:
+ *   Free the received chain attached to the device unless TCP or UDP took
+ *   it.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+void uip_iobrelease(FAR struct uip_driver_s *dev)
+{
+  if (dev->d_iob)
+    {
+      iob_free_chain(dev->d_iob);
+      dev->d_iob = NULL;
+    }
+}
+
+/****************************************************************************
+ * Function: uip_iobtxqueue
+ *
+ * Description:
+ *   Copy the outgoing packet in d_buf into a new chain and add it to the
+ *   transmit queue of the device.  d_len is not changed.
+ *
+ * Returned Value:
+ *   OK on success; -ENOMEM if there are not enough free I/O buffers.
+ *
+ * Assumptions:
+ *   The caller serializes access to d_txq.
+ *
+ ****************************************************************************/
+
+int uip_iobtxqueue(FAR struct uip_driver_s *dev)
+{
+  FAR struct iob_s *iob;
+
+  DEBUGASSERT(dev && dev->d_len > 0);
+
+  iob = iob_alloc();
+  if (!iob)
+    {
+      return -ENOMEM;
+    }
+
+  if (iob_copyin(iob, dev->d_buf, dev->d_len, 0) < 0)
+    {
+      (void)iob_free(iob);
+      return -ENOMEM;
+    }
+
+  iob_add_queue(iob, &dev->d_txq);
+  return OK;
+}
+
+/****************************************************************************
+ * Function: uip_iobtake
+ *
+ * Description:
+ *   Take the received chain from the device, trimmed to the 'buflen' bytes
+ *   at 'buffer' plus 'headroom' bytes in front of them, so that the data
+ *   can be kept by reference instead of being copied.  'buffer' points into
+ *   d_buf, which holds a copy of the frame in the chain.  The headroom
+ *   still holds the packet headers;  the caller may overwrite it.
+ *
+ * Returned Value:
+ *   The trimmed chain, or NULL if there is no received chain or if keeping
+ *   it would take more than 'maxiobs' I/O buffers.  The caller should then
+ *   copy the data.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *uip_iobtake(FAR struct uip_driver_s *dev,
+                              FAR const uint8_t *buffer, uint16_t buflen,
+                              uint16_t headroom, unsigned int maxiobs)
+{
+  FAR struct iob_s *iob = dev->d_iob;
+  FAR struct iob_s *next;
+  unsigned int start;
+  unsigned int end;
+  unsigned int pos;
+  unsigned int niobs;
+
+  if (!iob || buflen == 0 || buffer < dev->d_buf + headroom)
+    {
+      return NULL;
+    }
+
+  start = buffer - dev->d_buf - headroom;
+  end   = buffer - dev->d_buf + buflen;
+  if (end > iob->io_pktlen)
+    {
+      return NULL;
+    }
+
+  /* Count the buffers that hold the bytes to be kept */
+
+  niobs = 0;
+  for (pos = 0, next = iob; next && pos < end; next = next->io_flink)
+    {
+      if (pos + next->io_len > start)
+        {
+          niobs++;
+        }
+
+      pos += next->io_len;
+    }
+
+  if (niobs > maxiobs)
+    {
+      return NULL;
+    }
+
+  /* Take the chain and free everything outside of the bytes to be kept */
+
+  dev->d_iob = NULL;
+  iob = iob_trimtail(iob, iob->io_pktlen - end);
+  return iob_trimhead(iob, start);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_IOB */
@@ -100,7 +100,15 @@ void uip_send(struct uip_driver_s *dev, const void *buf, int len)
 
   if (dev && len > 0 && len < CONFIG_NET_BUFSIZE)
     {
+#if defined(CONFIG_NET_CHKSUM_OPTSPEED) && !UIP_ARCH_CHKSUM
+      /* Sum the data as it is copied so that the TCP or UDP checksum
+       * does not have to read it again.
+       */
+
+      dev->d_sndsum = uip_copychksum(dev->d_snddata, buf, len);
+#else
       memcpy(dev->d_snddata, buf, len);
+#endif
       dev->d_sndlen = len;
    }
 }
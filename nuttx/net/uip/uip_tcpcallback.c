@@ -70,7 +70,7 @@
  *
  ****************************************************************************/
 
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
 static int uip_readahead(struct uip_readahead_s *readahead, uint8_t *buf,
                          int len)
 {
@@ -142,7 +142,7 @@ uip_dataevent(FAR struct uip_driver_s *dev, FAR struct uip_conn *conn,
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
       /* Save as much data as possible in the read-ahead buffers */
 
-      recvlen = uip_datahandler(conn, buffer, buflen);
+      recvlen = uip_datahandler(dev, conn, buffer, buflen);
 
       /* There are several complicated buffering issues that are not addressed
        * properly here.  For example, what if we cannot buffer the entire
@@ -262,6 +262,9 @@ uint16_t uip_tcpcallback(struct uip_driver_s *dev, struct uip_conn *conn,
  *   receive the data.
  *
  * Input Parmeters:
+ *   dev - The device that received the data.  With CONFIG_NET_IOB, the
+ *     data may be taken by reference from the chain that it was received
+ *     into (see uip_iobtake()).
  *   conn - A pointer to the TCP connection structure
  *   buffer - A pointer to the buffer to be copied to the read-ahead
  *     buffers
@@ -279,7 +282,97 @@ uint16_t uip_tcpcallback(struct uip_driver_s *dev, struct uip_conn *conn,
  ****************************************************************************/
 
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
-uint16_t uip_datahandler(FAR struct uip_conn *conn, FAR uint8_t *buffer,
+#ifdef CONFIG_NET_IOB
+uint16_t uip_datahandler(FAR struct uip_driver_s *dev,
+                         FAR struct uip_conn *conn, FAR uint8_t *buffer,
+                         uint16_t buflen)
+{
+  FAR struct iob_s *iob = conn->readahead;
+  FAR struct iob_s *next;
+  unsigned int niobs = 0;
+  unsigned int space = 0;
+  unsigned int ncopy = 0;
+
+  /* Count the I/O buffers that the connection already holds and the space
+   * left in the last one.  From that, get the number of new buffers that
+   * copying the data would take.
+   */
+
+  for (next = iob; next; next = next->io_flink)
+    {
+      niobs++;
+      if (!next->io_flink)
+        {
+          space = CONFIG_IOB_BUFSIZE - next->io_offset - next->io_len;
+        }
+    }
+
+  if (buflen > space)
+    {
+      ncopy = (buflen - space + CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE;
+    }
+
+  /* Do not let one connection that is not being read take the whole pool
+   * from the other connections and from UDP read-ahead.
+   */
+
+  if (iob && niobs + ncopy > CONFIG_NET_TCP_READAHEAD_NIOBS)
+    {
+      nllvdbg("Read-ahead limit reached: %d I/O buffers\n", niobs);
+      return 0;
+    }
+
+  /* Keep the I/O buffers that the driver received the data into, if that
+   * takes no more buffers than copying would.  Otherwise append a copy of
+   * the data to the chain attached to the connection, starting a new chain
+   * if there is none.  Either all of the data is buffered or none of it is.
+   */
+
+  next = uip_iobtake(dev, buffer, buflen, 0, ncopy);
+  if (next)
+    {
+      if (iob)
+        {
+          iob_concat(iob, next);
+        }
+      else
+        {
+          conn->readahead = next;
+        }
+
+      nllvdbg("Kept %d bytes\n", buflen);
+      return buflen;
+    }
+
+  if (!iob)
+    {
+      iob = iob_alloc();
+      if (!iob)
+        {
+          nllvdbg("No I/O buffer\n");
+          return 0;
+        }
+    }
+
+  if (iob_copyin(iob, buffer, buflen, iob->io_pktlen) < 0)
+    {
+      if (!conn->readahead)
+        {
+          (void)iob_free(iob);
+        }
+
+      nllvdbg("Too few I/O buffers for %d bytes\n", buflen);
+      return 0;
+    }
+
+  conn->readahead = iob;
+
+  nllvdbg("Buffered %d bytes\n", buflen);
+  return buflen;
+}
+#else
+uint16_t uip_datahandler(FAR struct uip_driver_s *dev,
+                         FAR struct uip_conn *conn, FAR uint8_t *buffer,
                          uint16_t buflen)
 {
   FAR struct uip_readahead_s *readahead1;
@@ -334,6 +427,7 @@ uint16_t uip_datahandler(FAR struct uip_conn *conn, FAR uint8_t *buffer,
   nllvdbg("Buffered %d bytes (of %d)\n", recvlen, buflen);
   return recvlen;
 }
+#endif /* CONFIG_NET_IOB */
 #endif /* CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 */
 
 #endif /* CONFIG_NET && CONFIG_NET_TCP */
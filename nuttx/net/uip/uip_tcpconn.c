@@ -85,10 +85,130 @@ static dq_queue_t g_active_tcp_connections;
 
 static uint16_t g_last_tcp_port;
 
+/* Hash table of the active TCP connections (indexed by local port, remote
+ * port and remote IP address) and hash table of the TCP connections that
+ * have been bound to a local port (indexed by local port).
+ */
+
+#ifdef CONFIG_NET_HASHCONN
+static struct uip_conn *g_tcp_hash[CONFIG_NET_HASHCONN_SIZE];
+static struct uip_conn *g_tcp_porthash[CONFIG_NET_HASHCONN_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: uip_tcphash()
+ *
+ * Description:
+ *   Return the active connection hash table index for the given local
+ *   port, remote port and remote IP address (all in network order).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_HASHCONN
+static inline unsigned int uip_tcphash(uint16_t lport, uint16_t rport,
+                                       in_addr_t ripaddr)
+{
+  uint32_t hash = ((uint32_t)lport << 16 | rport) ^ ripaddr;
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return hash & UIP_HASHCONN_MASK;
+}
+
+#ifdef CONFIG_NET_IPv6
+#  define uip_tcpconnhash(c) uip_tcphash((c)->lport, (c)->rport, 0)
+#else
+#  define uip_tcpconnhash(c) uip_tcphash((c)->lport, (c)->rport, (c)->ripaddr)
+#endif
+#endif
+
+/****************************************************************************
+ * Name: uip_tcpaddhash() and uip_tcpremhash()
+ *
+ * Description:
+ *   Add a connection to or remove a connection from the active connection
+ *   hash table.  The ports and remote address must not change while the
+ *   connection is in the table.
+ *
+ * Assumptions:
+ *   Interrupts are disabled
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_HASHCONN
+static void uip_tcpaddhash(FAR struct uip_conn *conn)
+{
+  unsigned int ndx = uip_tcpconnhash(conn);
+
+  conn->hnext     = g_tcp_hash[ndx];
+  g_tcp_hash[ndx] = conn;
+}
+
+static void uip_tcpremhash(FAR struct uip_conn *conn)
+{
+  FAR struct uip_conn **prev = &g_tcp_hash[uip_tcpconnhash(conn)];
+
+  while (*prev && *prev != conn)
+    {
+      prev = &(*prev)->hnext;
+    }
+
+  if (*prev)
+    {
+      *prev = conn->hnext;
+    }
+}
+#else
+#  define uip_tcpaddhash(c)
+#  define uip_tcpremhash(c)
+#endif
+
+/****************************************************************************
+ * Name: uip_tcpsetport() and uip_tcpremport()
+ *
+ * Description:
+ *   Bind a connection to a local port (in network order) and add it to the
+ *   local port hash table, or remove it from the local port hash table.
+ *
+ * Assumptions:
+ *   Interrupts are disabled
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_HASHCONN
+static void uip_tcpremport(FAR struct uip_conn *conn)
+{
+  FAR struct uip_conn **prev = &g_tcp_porthash[UIP_PORTHASH(conn->lport)];
+
+  while (*prev && *prev != conn)
+    {
+      prev = &(*prev)->pnext;
+    }
+
+  if (*prev)
+    {
+      *prev = conn->pnext;
+    }
+}
+
+static void uip_tcpsetport(FAR struct uip_conn *conn, uint16_t portno)
+{
+  unsigned int ndx = UIP_PORTHASH(portno);
+
+  uip_tcpremport(conn);
+  conn->lport         = portno;
+  conn->pnext         = g_tcp_porthash[ndx];
+  g_tcp_porthash[ndx] = conn;
+}
+#else
+#  define uip_tcpremport(c)
+#  define uip_tcpsetport(c,p) do { (c)->lport = (p); } while (0)
+#endif
+
 /****************************************************************************
  * Name: uip_selectport()
  *
@@ -281,8 +401,11 @@ struct uip_conn *uip_tcpalloc(void)
 
 void uip_tcpfree(struct uip_conn *conn)
 {
-#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0 && !defined(CONFIG_NET_IOB)
   struct uip_readahead_s *readahead;
+#endif
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  struct uip_wrbuffer_s *wrb;
 #endif
   uip_lock_t flags;
 
@@ -303,16 +426,35 @@ void uip_tcpfree(struct uip_conn *conn)
       /* Remove the connection from the active list */
 
       dq_rem(&conn->node, &g_active_tcp_connections);
+      uip_tcpremhash(conn);
     }
 
+  /* Release the local port */
+
+  uip_tcpremport(conn);
+
   /* Release any read-ahead buffers attached to the connection */
 
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#ifdef CONFIG_NET_IOB
+  iob_free_chain(conn->readahead);
+  conn->readahead = NULL;
+#else
   while ((readahead = (struct uip_readahead_s *)sq_remfirst(&conn->readahead)) != NULL)
     {
       uip_tcpreadaheadrelease(readahead);
     }
 #endif
+#endif
+
+  /* Release any write buffers attached to the connection */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  while ((wrb = (struct uip_wrbuffer_s *)sq_remfirst(&conn->write_q)) != NULL)
+    {
+      uip_tcpwrbufferrelease(wrb);
+    }
+#endif
 
   /* Remove any backlog attached to this connection */
 
@@ -353,8 +495,20 @@ void uip_tcpfree(struct uip_conn *conn)
 
 struct uip_conn *uip_tcpactive(struct uip_tcpip_hdr *buf)
 {
-  struct uip_conn *conn      = (struct uip_conn *)g_active_tcp_connections.head;
-  in_addr_t        srcipaddr = uip_ip4addr_conv(buf->srcipaddr);  
+  struct uip_conn *conn;
+  in_addr_t        srcipaddr = uip_ip4addr_conv(buf->srcipaddr);
+
+  /* Only the connections in the matching hash chain need to be checked */
+
+#ifdef CONFIG_NET_HASHCONN
+#ifdef CONFIG_NET_IPv6
+  conn = g_tcp_hash[uip_tcphash(buf->destport, buf->srcport, 0)];
+#else
+  conn = g_tcp_hash[uip_tcphash(buf->destport, buf->srcport, srcipaddr)];
+#endif
+#else
+  conn = (struct uip_conn *)g_active_tcp_connections.head;
+#endif
 
   while (conn)
     {
@@ -373,7 +527,11 @@ struct uip_conn *uip_tcpactive(struct uip_tcpip_hdr *buf)
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_HASHCONN
+      conn = conn->hnext;
+#else
       conn = (struct uip_conn *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -418,13 +576,20 @@ struct uip_conn *uip_nexttcpconn(struct uip_conn *conn)
 struct uip_conn *uip_tcplistener(uint16_t portno)
 {
   struct uip_conn *conn;
+#ifndef CONFIG_NET_HASHCONN
   int i;
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
- 
+
+#ifdef CONFIG_NET_HASHCONN
+  for (conn = g_tcp_porthash[UIP_PORTHASH(portno)]; conn; conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_TCP_CONNS; i++)
     {
       conn = &g_tcp_connections[i];
+#endif
       if (conn->tcpstateflags != UIP_CLOSED && conn->lport == portno)
         {
           /* The portnumber is in use, return the connection */
@@ -460,8 +625,8 @@ struct uip_conn *uip_tcpaccept(struct uip_tcpip_hdr *buf)
       conn->sa            = 0;
       conn->sv            = 4;
       conn->nrtx          = 0;
-      conn->lport         = buf->destport;
       conn->rport         = buf->srcport;
+      uip_tcpsetport(conn, buf->destport);
       uip_ipaddr_copy(conn->ripaddr, uip_ip4addr_conv(buf->srcipaddr));
       conn->tcpstateflags = UIP_SYN_RCVD;
 
@@ -475,14 +640,27 @@ struct uip_conn *uip_tcpaccept(struct uip_tcpip_hdr *buf)
       /* Initialize the list of TCP read-ahead buffers */
 
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#ifdef CONFIG_NET_IOB
+      conn->readahead = NULL;
+#else
       sq_init(&conn->readahead);
 #endif
+#endif
+
+      /* Initialize the write buffer lists */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+      sq_init(&conn->write_q);
+      conn->winsize = 0;
+      conn->sndcb   = NULL;
+#endif
 
       /* And, finally, put the connection structure into the active list.
        * Interrupts should already be disabled in this context.
        */
 
       dq_addlast(&conn->node, &g_active_tcp_connections);
+      uip_tcpaddhash(conn);
     }
   return conn;
 }
@@ -515,10 +693,9 @@ int uip_tcpbind(struct uip_conn *conn, const struct sockaddr_in *addr)
 
   flags = uip_lock();
   port = uip_selectport(ntohs(addr->sin_port));
-  uip_unlock(flags);
-
   if (port < 0)
     {
+      uip_unlock(flags);
       return port;
     }
 
@@ -527,7 +704,8 @@ int uip_tcpbind(struct uip_conn *conn, const struct sockaddr_in *addr)
    * interface is supported, the IP address is not of importance.
    */
 
-  conn->lport = addr->sin_port;
+  uip_tcpsetport(conn, addr->sin_port);
+  uip_unlock(flags);
 
 #if 0 /* Not used */
 #ifdef CONFIG_NET_IPv6
@@ -585,14 +763,18 @@ int uip_tcpconnect(struct uip_conn *conn, const struct sockaddr_in *addr)
 
   flags = uip_lock();
   port = uip_selectport(ntohs(conn->lport));
-  uip_unlock(flags);
-
   if (port < 0)
     {
+      uip_unlock(flags);
       return port;
     }
 
-  /* Initialize and return the connection structure, bind it to the port number */
+  /* Bind the connection to the port number */
+
+  uip_tcpsetport(conn, htons((uint16_t)port));
+  uip_unlock(flags);
+
+  /* Initialize and return the connection structure */
 
   conn->tcpstateflags = UIP_SYN_SENT;
   uip_tcpinitsequence(conn->sndseq);
@@ -604,7 +786,6 @@ int uip_tcpconnect(struct uip_conn *conn, const struct sockaddr_in *addr)
   conn->rto        = UIP_RTO;
   conn->sa         = 0;
   conn->sv         = 16;   /* Initial value of the RTT variance. */
-  conn->lport      = htons((uint16_t)port);
 
   /* The sockaddr port is 16 bits and already in network order */
 
@@ -617,8 +798,20 @@ int uip_tcpconnect(struct uip_conn *conn, const struct sockaddr_in *addr)
   /* Initialize the list of TCP read-ahead buffers */
 
 #if CONFIG_NET_NTCP_READAHEAD_BUFFERS > 0
+#ifdef CONFIG_NET_IOB
+  conn->readahead = NULL;
+#else
   sq_init(&conn->readahead);
 #endif
+#endif
+
+  /* Initialize the TCP write buffer list */
+
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+  sq_init(&conn->write_q);
+  conn->winsize = 0;
+  conn->sndcb   = NULL;
+#endif
 
   /* And, finally, put the connection structure into the active
    * list. Because g_active_tcp_connections is accessed from user level and
@@ -628,6 +821,7 @@ int uip_tcpconnect(struct uip_conn *conn, const struct sockaddr_in *addr)
 
   flags = uip_lock();
   dq_addlast(&conn->node, &g_active_tcp_connections);
+  uip_tcpaddhash(conn);
   uip_unlock(flags);
 
   return OK;
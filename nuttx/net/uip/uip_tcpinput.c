@@ -457,6 +457,10 @@ found:
           {
             conn->tcpstateflags = UIP_ESTABLISHED;
             conn->unacked       = 0;
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+            conn->winsize       = ((uint16_t)pbuf->wnd[0] << 8) +
+                                  (uint16_t)pbuf->wnd[1];
+#endif
             nllvdbg("TCP state: UIP_ESTABLISHED\n");
 
             flags               = UIP_CONNECTED;
@@ -551,6 +555,10 @@ found:
 
             uip_incr32(conn->rcvseq, 1);
             conn->unacked       = 0;
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+            conn->winsize       = ((uint16_t)pbuf->wnd[0] << 8) +
+                                  (uint16_t)pbuf->wnd[1];
+#endif
             dev->d_len          = 0;
             dev->d_sndlen       = 0;
             result = uip_tcpcallback(dev, conn, UIP_CONNECTED | UIP_NEWDATA);
@@ -673,6 +681,13 @@ found:
          */
 
         tmp16 = ((uint16_t)pbuf->wnd[0] << 8) + (uint16_t)pbuf->wnd[1];
+#ifdef CONFIG_NET_TCP_WRITE_BUFFERS
+        /* Remember the full window size for the write buffering logic.
+         * That logic may have several segments in flight, up to this size.
+         */
+
+        conn->winsize = tmp16;
+#endif
         if (tmp16 > conn->initialmss || tmp16 == 0)
           {
             tmp16 = conn->initialmss;
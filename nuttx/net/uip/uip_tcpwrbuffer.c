@@ -0,0 +1,184 @@
+/****************************************************************************
+ * net/uip/uip_tcpwrbuffer.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/net/uip/uipopt.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_WRITE_BUFFERS)
+
+#include <semaphore.h>
+#include <queue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/net/uip/uip.h>
+
+#include "uip_internal.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Package all globals used by this logic into a structure */
+
+struct wrbuffer_s
+{
+  /* The semaphore counts the number of free buffers.  It is used to wait
+   * for a buffer to become available.
+   */
+
+  sem_t sem;
+
+  /* This is the list of available write buffers */
+
+  sq_queue_t freebuffers;
+
+  /* These are the pre-allocated write buffers */
+
+  struct uip_wrbuffer_s buffers[CONFIG_NET_NTCP_WRITE_BUFFERS];
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* This is the state of the global write buffer resource */
+
+static struct wrbuffer_s g_wrbuffer;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: uip_tcpwrbufferinit
+ *
+ * Description:
+ *   Initialize the list of free write buffers
+ *
+ * Assumptions:
+ *   Called once early initialization.
+ *
+ ****************************************************************************/
+
+void uip_tcpwrbufferinit(void)
+{
+  int i;
+
+  sq_init(&g_wrbuffer.freebuffers);
+  for (i = 0; i < CONFIG_NET_NTCP_WRITE_BUFFERS; i++)
+    {
+      sq_addfirst(&g_wrbuffer.buffers[i].wb_node, &g_wrbuffer.freebuffers);
+    }
+
+  sem_init(&g_wrbuffer.sem, 0, CONFIG_NET_NTCP_WRITE_BUFFERS);
+}
+
+/****************************************************************************
+ * Function: uip_tcpwrbufferalloc
+ *
+ * Description:
+ *   Allocate a TCP write buffer by taking a pre-allocated buffer from
+ *   the free list.  This function is called from TCP logic when a buffer
+ *   of TCP data is about to be sent.  If no buffer is available, this
+ *   function will wait until one is released by the TCP ACK logic.
+ *
+ * Returned Value:
+ *   A reference to the allocated write buffer.  NULL is returned if the
+ *   wait for a free buffer was interrupted by a signal; in that case the
+ *   errno value will have been set by sem_wait().
+ *
+ * Assumptions:
+ *   Called from user logic with interrupts enabled.
+ *
+ ****************************************************************************/
+
+FAR struct uip_wrbuffer_s *uip_tcpwrbufferalloc(void)
+{
+  FAR struct uip_wrbuffer_s *wrb;
+  uip_lock_t flags;
+
+  /* We need to allocate two things:  (1) A write buffer count from the
+   * semaphore, and (2) the write buffer itself.  Once we have the count,
+   * the free list is guaranteed to contain a buffer.
+   */
+
+  if (sem_wait(&g_wrbuffer.sem) < 0)
+    {
+      DEBUGASSERT(errno == EINTR);
+      return NULL;
+    }
+
+  /* Now, we are guaranteed to have a write buffer just for us */
+
+  flags = uip_lock();
+  wrb   = (FAR struct uip_wrbuffer_s *)sq_remfirst(&g_wrbuffer.freebuffers);
+  uip_unlock(flags);
+
+  DEBUGASSERT(wrb);
+  wrb->wb_nbytes = 0;
+  return wrb;
+}
+
+/****************************************************************************
+ * Function: uip_tcpwrbufferrelease
+ *
+ * Description:
+ *   Release a TCP write buffer by returning the buffer to the free list.
+ *   This function is called from the TCP logic once all of the data in the
+ *   buffer has been acknowledged (or the connection has been lost).
+ *
+ * Assumptions:
+ *   Called from interrupt level or from user logic with interrupts
+ *   disabled.
+ *
+ ****************************************************************************/
+
+void uip_tcpwrbufferrelease(FAR struct uip_wrbuffer_s *wrb)
+{
+  DEBUGASSERT(wrb);
+
+  sq_addlast(&wrb->wb_node, &g_wrbuffer.freebuffers);
+  sem_post(&g_wrbuffer.sem);
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_WRITE_BUFFERS */
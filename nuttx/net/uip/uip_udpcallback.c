@@ -49,6 +49,12 @@
 
 #include "uip_internal.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define UDPBUF ((struct uip_udpip_hdr *)&dev->d_buf[UIP_LLH_LEN])
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -57,6 +63,89 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: uip_udpreadahead
+ *
+ * Description:
+ *   Queue a datagram that was not taken by any receiver.  It is dropped if
+ *   the socket already has CONFIG_NET_UDP_NREADAHEAD datagrams queued or
+ *   if there are not enough free I/O buffers.
+ *
+ * Assumptions:
+ *   This function is called at the interrupt level with interrupts disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+static void uip_udpreadahead(FAR struct uip_driver_s *dev,
+                             FAR struct uip_udp_conn *conn)
+{
+  FAR struct uip_udpip_hdr *pbuf = UDPBUF;
+  struct uip_udpsender_s sender;
+  FAR struct iob_s *iob;
+  unsigned int ncopy;
+
+  if (conn->nreadahead >= CONFIG_NET_UDP_NREADAHEAD)
+    {
+      goto drop;
+    }
+
+  /* Save the address of the sender in front of the data */
+
+  sender.us_port = pbuf->srcport;
+#ifdef CONFIG_NET_IPv6
+  uip_ipaddr_copy(sender.us_addr, pbuf->srcipaddr);
+#else
+  uip_ipaddr_copy(sender.us_addr, uip_ip4addr_conv(pbuf->srcipaddr));
+#endif
+
+  /* Keep the I/O buffers that the driver received the datagram into, if
+   * that takes no more buffers than copying would.  The sender address
+   * then replaces the end of the headers in front of the data.
+   */
+
+  ncopy = (sizeof(struct uip_udpsender_s) + dev->d_len +
+           CONFIG_IOB_BUFSIZE - 1) / CONFIG_IOB_BUFSIZE;
+
+  iob = uip_iobtake(dev, dev->d_appdata, dev->d_len,
+                    sizeof(struct uip_udpsender_s), ncopy);
+  if (iob)
+    {
+      (void)iob_copyin(iob, (FAR const uint8_t *)&sender,
+                       sizeof(struct uip_udpsender_s), 0);
+      iob_add_queue(iob, &conn->readahead);
+      conn->nreadahead++;
+
+      nllvdbg("Kept %d bytes\n", dev->d_len);
+      return;
+    }
+
+  iob = iob_alloc();
+  if (iob)
+    {
+      if (iob_copyin(iob, (FAR const uint8_t *)&sender,
+                     sizeof(struct uip_udpsender_s), 0) == OK &&
+          iob_copyin(iob, dev->d_appdata, dev->d_len,
+                     sizeof(struct uip_udpsender_s)) == OK)
+        {
+          iob_add_queue(iob, &conn->readahead);
+          conn->nreadahead++;
+
+          nllvdbg("Queued %d bytes\n", dev->d_len);
+          return;
+        }
+
+      iob_free_chain(iob);
+    }
+
+drop:
+  nllvdbg("Dropped %d bytes\n", dev->d_len);
+#ifdef CONFIG_NET_STATISTICS
+  uip_stat.udp.drop++;
+#endif
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -84,6 +173,16 @@ void uip_udpcallback(struct uip_driver_s *dev, struct uip_udp_conn *conn,
       /* Perform the callback */
 
       flags = uip_callbackexecute(dev, conn, flags, conn->list);
+
+      /* If no receiver took the new data, then keep it for the next one */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+      if ((flags & UIP_NEWDATA) != 0)
+        {
+          uip_udpreadahead(dev, conn);
+          dev->d_len = 0;
+        }
+#endif
     }
 }
 
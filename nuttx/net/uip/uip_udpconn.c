@@ -48,6 +48,7 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_UDP)
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <semaphore.h>
 #include <assert.h>
@@ -83,6 +84,16 @@ static dq_queue_t g_active_udp_connections;
 
 static uint16_t g_last_udp_port;
 
+/* Hash table of the active UDP connections and hash table of the UDP
+ * connections that have been bound to a local port (both indexed by local
+ * port).
+ */
+
+#ifdef CONFIG_NET_HASHCONN
+static struct uip_udp_conn *g_udp_hash[CONFIG_NET_HASHCONN_SIZE];
+static struct uip_udp_conn *g_udp_porthash[CONFIG_NET_HASHCONN_SIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -122,6 +133,19 @@ static inline void _uip_semtake(sem_t *sem)
 
 static struct uip_udp_conn *uip_find_conn(uint16_t portno)
 {
+#ifdef CONFIG_NET_HASHCONN
+  struct uip_udp_conn *conn;
+
+  /* Only the connections in the matching hash chain need to be checked */
+
+  for (conn = g_udp_porthash[UIP_PORTHASH(portno)]; conn; conn = conn->pnext)
+    {
+      if (conn->lport == portno)
+        {
+          return conn;
+        }
+    }
+#else
   int i;
 
   /* Now search each connection structure.*/
@@ -133,10 +157,112 @@ static struct uip_udp_conn *uip_find_conn(uint16_t portno)
           return &g_udp_connections[ i ];
         }
     }
+#endif
 
   return NULL;
 }
 
+/****************************************************************************
+ * Name: uip_udpaddhash() and uip_udpremhash()
+ *
+ * Description:
+ *   Add a connection to or remove a connection from the active connection
+ *   hash table.  uip_udpremhash() returns true if the connection was in the
+ *   table.
+ *
+ * Assumptions:
+ *   Interrupts are disabled
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_HASHCONN
+static void uip_udpaddhash(struct uip_udp_conn *conn)
+{
+  unsigned int ndx = UIP_PORTHASH(conn->lport);
+
+  conn->hnext     = g_udp_hash[ndx];
+  g_udp_hash[ndx] = conn;
+}
+
+static bool uip_udpremhash(struct uip_udp_conn *conn)
+{
+  struct uip_udp_conn **prev = &g_udp_hash[UIP_PORTHASH(conn->lport)];
+
+  while (*prev && *prev != conn)
+    {
+      prev = &(*prev)->hnext;
+    }
+
+  if (*prev)
+    {
+      *prev = conn->hnext;
+      return true;
+    }
+
+  return false;
+}
+#else
+#  define uip_udpaddhash(c)
+#  define uip_udpremhash(c) false
+#endif
+
+/****************************************************************************
+ * Name: uip_udpsetport() and uip_udpremport()
+ *
+ * Description:
+ *   Bind a connection to a local port (in network order) and add it to the
+ *   local port hash table, or remove it from the local port hash table and
+ *   mark it unbound.
+ *
+ * Assumptions:
+ *   Interrupts are disabled
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_HASHCONN
+static void uip_udpremport(struct uip_udp_conn *conn)
+{
+  struct uip_udp_conn **prev = &g_udp_porthash[UIP_PORTHASH(conn->lport)];
+
+  while (*prev && *prev != conn)
+    {
+      prev = &(*prev)->pnext;
+    }
+
+  if (*prev)
+    {
+      *prev = conn->pnext;
+    }
+
+  conn->lport = 0;
+}
+
+static void uip_udpsetport(struct uip_udp_conn *conn, uint16_t portno)
+{
+  unsigned int ndx = UIP_PORTHASH(portno);
+  bool active;
+
+  /* If the connection is active, then it must also move to the active hash
+   * chain for the new port.
+   */
+
+  active = uip_udpremhash(conn);
+  uip_udpremport(conn);
+
+  conn->lport         = portno;
+  conn->pnext         = g_udp_porthash[ndx];
+  g_udp_porthash[ndx] = conn;
+
+  if (active)
+    {
+      uip_udpaddhash(conn);
+    }
+}
+#else
+#  define uip_udpremport(c)   do { (c)->lport = 0; } while (0)
+#  define uip_udpsetport(c,p) do { (c)->lport = (p); } while (0)
+#endif
+
 /****************************************************************************
  * Name: uip_selectport()
  *
@@ -250,6 +376,11 @@ struct uip_udp_conn *uip_udpalloc(void)
       /* Make sure that the connection is marked as uninitialized */
 
       conn->lport = 0;
+#ifdef CONFIG_NET_UDP_READAHEAD
+      IOB_QINIT(&conn->readahead);
+      conn->nreadahead = 0;
+      conn->nenabled   = 0;
+#endif
     }
   _uip_semgive(&g_free_sem);
   return conn;
@@ -267,14 +398,40 @@ struct uip_udp_conn *uip_udpalloc(void)
 
 void uip_udpfree(struct uip_udp_conn *conn)
 {
+  uip_lock_t flags;
+
   /* The free list is only accessed from user, non-interrupt level and
    * is protected by a semaphore (that behaves like a mutex).
    */
 
   DEBUGASSERT(conn->crefs == 0);
 
+#ifdef CONFIG_NET_UDP_READAHEAD
+  /* A bound connection is still active with read-ahead.  Undo the
+   * uip_udpenable() that was done when it was bound.
+   */
+
+  if (conn->lport != 0)
+    {
+      uip_udpdisable(conn);
+    }
+
+  DEBUGASSERT(conn->nenabled == 0);
+#endif
+
   _uip_semtake(&g_free_sem);
-  conn->lport = 0;
+
+  flags = uip_lock();
+  uip_udpremport(conn);
+
+  /* Discard any datagrams that were never read */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  iob_free_queue(&conn->readahead);
+  conn->nreadahead = 0;
+#endif
+  uip_unlock(flags);
+
   dq_addlast(&conn->node, &g_free_udp_connections);
   _uip_semgive(&g_free_sem);
 }
@@ -293,7 +450,15 @@ void uip_udpfree(struct uip_udp_conn *conn)
 
 struct uip_udp_conn *uip_udpactive(struct uip_udpip_hdr *buf)
 {
-  struct uip_udp_conn *conn = (struct uip_udp_conn *)g_active_udp_connections.head;
+  struct uip_udp_conn *conn;
+
+  /* Only the connections in the matching hash chain need to be checked */
+
+#ifdef CONFIG_NET_HASHCONN
+  conn = g_udp_hash[UIP_PORTHASH(buf->destport)];
+#else
+  conn = (struct uip_udp_conn *)g_active_udp_connections.head;
+#endif
 
   while (conn)
     {
@@ -319,7 +484,11 @@ struct uip_udp_conn *uip_udpactive(struct uip_udpip_hdr *buf)
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_HASHCONN
+      conn = conn->hnext;
+#else
       conn = (struct uip_udp_conn *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -369,6 +538,16 @@ int uip_udpbind(struct uip_udp_conn *conn, const struct sockaddr_in *addr)
 {
   int ret = -EADDRINUSE;
   uip_lock_t flags;
+#ifdef CONFIG_NET_UDP_READAHEAD
+  bool bound;
+#endif
+
+  /* Interrupts must be disabled while access the UDP connection list */
+
+  flags = uip_lock();
+#ifdef CONFIG_NET_UDP_READAHEAD
+  bound = (conn->lport != 0);
+#endif
 
   /* Is the user requesting to bind to any port? */
 
@@ -376,27 +555,33 @@ int uip_udpbind(struct uip_udp_conn *conn, const struct sockaddr_in *addr)
     {
       /* Yes.. Find an unused local port number */
 
-      conn->lport = htons(uip_selectport());
-      ret         = OK;
+      uip_udpsetport(conn, htons(uip_selectport()));
+      ret = OK;
     }
-  else
-    {
-      /* Interrupts must be disabled while access the UDP connection list */
 
-      flags = uip_lock();
+  /* Is any other UDP connection bound to this port? */
 
-      /* Is any other UDP connection bound to this port? */
+  else if (!uip_find_conn(addr->sin_port))
+    {
+      /* No.. then bind the socket to the port */
 
-      if (!uip_find_conn(addr->sin_port))
-        {
-          /* No.. then bind the socket to the port */
+      uip_udpsetport(conn, addr->sin_port);
+      ret = OK;
+    }
 
-          conn->lport = addr->sin_port;
-          ret         = OK;
-        }
+  uip_unlock(flags);
 
-      uip_unlock(flags);
+  /* With read-ahead, the connection receives from the time that it is
+   * first bound to a local port until it is freed.
+   */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+  if (ret == OK && !bound)
+    {
+      uip_udpenable(conn);
     }
+#endif
+
   return ret;
 }
 
@@ -426,6 +611,8 @@ int uip_udpconnect(struct uip_udp_conn *conn, const struct sockaddr_in6 *addr)
 int uip_udpconnect(struct uip_udp_conn *conn, const struct sockaddr_in *addr)
 #endif
 {
+  uip_lock_t flags;
+
   /* Has this address already been bound to a local port (lport)? */
 
   if (!conn->lport)
@@ -434,7 +621,15 @@ int uip_udpconnect(struct uip_udp_conn *conn, const struct sockaddr_in *addr)
        * connection structure.
        */
 
-      conn->lport = htons(uip_selectport());
+      flags = uip_lock();
+      uip_udpsetport(conn, htons(uip_selectport()));
+      uip_unlock(flags);
+
+      /* With read-ahead, the connection now receives until it is freed */
+
+#ifdef CONFIG_NET_UDP_READAHEAD
+      uip_udpenable(conn);
+#endif
     }
 
   /* Is there a remote port (rport) */
@@ -458,7 +653,10 @@ int uip_udpconnect(struct uip_udp_conn *conn, const struct sockaddr_in *addr)
  * Name: uip_udpenable() uip_udpdisable.
  *
  * Description:
- *   Enable/disable callbacks for the specified connection
+ *   Enable/disable callbacks for the specified connection.  With
+ *   CONFIG_NET_UDP_READAHEAD, the calls nest and the connection stays
+ *   active until each uip_udpenable() has been matched by a
+ *   uip_udpdisable().
  *
  * Assumptions:
  *   This function is called user code.  Interrupts may be enabled.
@@ -473,7 +671,13 @@ void uip_udpenable(struct uip_udp_conn *conn)
    */
 
   uip_lock_t flags = uip_lock();
-  dq_addlast(&conn->node, &g_active_udp_connections);
+#ifdef CONFIG_NET_UDP_READAHEAD
+  if (conn->nenabled++ == 0)
+#endif
+    {
+      dq_addlast(&conn->node, &g_active_udp_connections);
+      uip_udpaddhash(conn);
+    }
   uip_unlock(flags);
 }
 
@@ -485,7 +689,13 @@ void uip_udpdisable(struct uip_udp_conn *conn)
    */
 
   uip_lock_t flags = uip_lock();
-  dq_rem(&conn->node, &g_active_udp_connections);
+#ifdef CONFIG_NET_UDP_READAHEAD
+  if (--conn->nenabled == 0)
+#endif
+    {
+      dq_rem(&conn->node, &g_active_udp_connections);
+      (void)uip_udpremhash(conn);
+    }
   uip_unlock(flags);
 }
 
@@ -49,6 +49,7 @@
 #  include <arch/irq.h>
 #endif
 
+#include <nuttx/arch.h>
 #include <nuttx/clock.h>
 #include <nuttx/time.h>
 #include <nuttx/rtc.h>
@@ -206,6 +207,12 @@ void clock_initialize(void)
   up_rtcinitialize();
 #endif
 
+  /* In the tickless mode, start the platform time base */
+
+#ifdef CONFIG_SCHED_TICKLESS
+  up_timer_initialize();
+#endif
+
   /* Initialize the time value to match the RTC */
 
   clock_inittime();
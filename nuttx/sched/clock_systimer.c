@@ -40,7 +40,9 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <time.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/clock.h>
 
 #include "clock_internal.h"
@@ -76,7 +78,17 @@
 #if !defined(clock_systimer) /* See nuttx/clock.h */
 uint32_t clock_systimer(void)
 {
-#ifdef CONFIG_SYSTEM_TIME64
+#if defined(CONFIG_SCHED_TICKLESS)
+  struct timespec ts;
+
+  /* Convert the elapsed time from the platform time base into ticks.  The
+   * result wraps just like a 32-bit tick counter would.
+   */
+
+  (void)up_timer_gettime(&ts);
+  return (uint32_t)ts.tv_sec * TICK_PER_SEC +
+         (uint32_t)ts.tv_nsec / NSEC_PER_TICK;
+#elif defined(CONFIG_SYSTEM_TIME64)
   return (uint32_t)(g_system_timer & 0x00000000ffffffff);
 #else
   return g_system_timer;
@@ -100,11 +112,19 @@ uint32_t clock_systimer(void)
  *
  ****************************************************************************/
 
-#if !defined(clock_systimer) /* See nuttx/clock.h */
+#if !defined(clock_systimer64) /* See nuttx/clock.h */
 #ifdef CONFIG_SYSTEM_TIME64
 uint64_t clock_systimer64(void)
 {
+#ifdef CONFIG_SCHED_TICKLESS
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint64_t)ts.tv_sec * TICK_PER_SEC +
+         (uint64_t)ts.tv_nsec / NSEC_PER_TICK;
+#else
   return g_system_timer;
+#endif
 }
 #endif
 #endif
@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 
+#include <sched.h>
 #include <debug.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
@@ -98,6 +99,10 @@ void irq_dispatch(int irq, FAR void *context)
   vector = irq_unexpected_isr;
 #endif
 
+  /* Inform the instrumentation layer that the handler is entered */
+
+  sched_note_irqhandler(irq);
+
   /* Then dispatch to the interrupt handler */
 
   vector(irq, context);
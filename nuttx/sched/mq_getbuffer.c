@@ -0,0 +1,158 @@
+/****************************************************************************
+ * sched/mq_getbuffer.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_getbuffer
+ *
+ * Description:
+ *   This non-standard function gets a message buffer that the caller fills
+ *   in place and then sends with mq_sendbuffer() (or returns unused with
+ *   mq_releasebuffer()).  If the message queue was created with the
+ *   MQ_ZEROCOPY flag, the buffer comes from the queue's own pool and this
+ *   function waits for a buffer to be released if all are in use (unless
+ *   O_NONBLOCK is set).  Otherwise, the buffer is one of the common
+ *   pre-allocated message structures.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *
+ * Return Value:
+ *   A buffer of at least mq_msgsize bytes on success.  On failure, NULL is
+ *   returned with errno set appropriately:
+ *
+ *   EINVAL   mqdes is NULL.
+ *   EPERM    Message queue opened not opened for writing.
+ *   EAGAIN   No buffer is free and O_NONBLOCK was set for the message
+ *            queue description referred to by mqdes, or no message is
+ *            free when called from an interrupt handler.
+ *   EINTR    The call was interrupted by a signal handler.
+ *
+ * Assumptions/restrictions:
+ *
+ ****************************************************************************/
+
+FAR void *mq_getbuffer(mqd_t mqdes)
+{
+  FAR mqmsg_t *mqmsg;
+
+  /* Verify the input parameters */
+
+  if (!mqdes)
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+
+  if ((mqdes->oflags & O_WROK) == 0)
+    {
+      set_errno(EPERM);
+      return NULL;
+    }
+
+  /* Get a message structure from the pool of the message queue or from
+   * the common message free lists.
+   */
+
+  if (mqdes->msgq->pool)
+    {
+      mqmsg = mq_poolalloc(mqdes, NULL);
+      if (!mqmsg)
+        {
+          return NULL;
+        }
+    }
+  else
+    {
+      /* mq_msgalloc() fails only when called from an interrupt handler
+       * and the messages reserved for interrupt handlers are all in use.
+       */
+
+      mqmsg = mq_msgalloc();
+      if (!mqmsg)
+        {
+          set_errno(EAGAIN);
+          return NULL;
+        }
+    }
+
+  /* Give the caller the message data */
+
+  return (FAR void *)mqmsg->mail;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
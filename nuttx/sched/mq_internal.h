@@ -50,6 +50,7 @@
 #include <mqueue.h>
 #include <sched.h>
 #include <signal.h>
+#include <time.h>
 
 #include <nuttx/mqueue.h>
 
@@ -83,7 +84,8 @@ enum mqalloc_e
 {
   MQ_ALLOC_FIXED = 0,  /* pre-allocated; never freed */
   MQ_ALLOC_DYN,        /* dynamically allocated; free when unused */
-  MQ_ALLOC_IRQ         /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_IRQ,        /* Preallocated, reserved for interrupt handling */
+  MQ_ALLOC_POOL        /* Allocated from the message queue's own pool */
 };
 
 typedef enum mqalloc_e mqalloc_t;
@@ -95,7 +97,7 @@ struct mqmsg
   FAR struct mqmsg  *next;    /* Forward link to next message */
   uint8_t      type;          /* (Used to manage allocations) */
   uint8_t      priority;      /* priority of message          */
-#if MQ_MAX_BYTES < 256
+#if MQ_MAX_BYTES < 256 && !defined(CONFIG_MQ_ZEROCOPY)
   uint8_t      msglen;        /* Message data length          */
 #else
   uint16_t     msglen;        /* Message data length          */
@@ -105,6 +107,22 @@ struct mqmsg
 
 typedef struct mqmsg mqmsg_t;
 
+/* The size of the message header and the size of one message in the pool of
+ * a zero-copy message queue.  Messages in the pool have only 'n' bytes of
+ * mail[] and are aligned to the size of a pointer.
+ */
+
+#define SIZEOF_MQ_MSGHEADER \
+  ((size_t)((FAR uint8_t*)((FAR mqmsg_t*)NULL)->mail - (FAR uint8_t*)NULL))
+#define SIZEOF_MQ_POOLMSG(n) \
+  ((SIZEOF_MQ_MSGHEADER + (n) + sizeof(FAR void*) - 1) & ~(sizeof(FAR void*) - 1))
+
+/* Get the message structure from the message data returned by
+ * mq_getbuffer() or mq_receivebuffer().
+ */
+
+#define MQ_BUFFER2MSG(b) ((FAR mqmsg_t*)((FAR uint8_t*)(b) - SIZEOF_MQ_MSGHEADER))
+
 /****************************************************************************
  * Global Variables
  ****************************************************************************/
@@ -172,6 +190,15 @@ int mq_waitsend(mqd_t mqdes);
 int mq_dosend(mqd_t mqdes, FAR mqmsg_t *mqmsg, const void *msg,
               size_t msglen, int prio);
 
+/* mq_msgpool.c ************************************************************/
+
+#ifdef CONFIG_MQ_ZEROCOPY
+int mq_poolcreate(FAR msgq_t *msgq);
+void mq_pooldestroy(FAR msgq_t *msgq);
+FAR mqmsg_t *mq_poolalloc(mqd_t mqdes, FAR const struct timespec *abstime);
+void mq_poolfree(FAR msgq_t *msgq, FAR mqmsg_t *mqmsg);
+#endif
+
 /* mq_release.c ************************************************************/
 
 struct task_group_s; /* Forward reference */
@@ -0,0 +1,255 @@
+/************************************************************************
+ * sched/mq_msgpool.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/************************************************************************
+ * Global Variables
+ ************************************************************************/
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: mq_poolcreate
+ *
+ * Description:
+ *   Allocate the pool of messages of a message queue created with the
+ *   MQ_ZEROCOPY flag.  The pool holds maxmsgs messages with maxmsgsize
+ *   bytes of message data each.  Since every message in the queue comes
+ *   from the pool, a task that holds a message from the pool will never
+ *   find the message queue full.
+ *
+ * Inputs:
+ *   msgq - The new message queue.  maxmsgs and maxmsgsize must be set.
+ *
+ * Return Value:
+ *   0 (OK) on success; -ENOMEM if the pool could not be allocated.
+ *
+ ************************************************************************/
+
+int mq_poolcreate(FAR msgq_t *msgq)
+{
+  FAR uint8_t *msgptr;
+  size_t msgsize;
+  int i;
+
+  msgsize = SIZEOF_MQ_POOLMSG(msgq->maxmsgsize);
+  msgq->pool = kmalloc(msgsize * msgq->maxmsgs);
+  if (!msgq->pool)
+    {
+      return -ENOMEM;
+    }
+
+  sq_init(&msgq->poolfree);
+  for (i = 0, msgptr = (FAR uint8_t *)msgq->pool;
+       i < msgq->maxmsgs;
+       i++, msgptr += msgsize)
+    {
+      ((FAR mqmsg_t *)msgptr)->type = MQ_ALLOC_POOL;
+      sq_addlast((FAR sq_entry_t *)msgptr, &msgq->poolfree);
+    }
+
+  /* The semaphore counts the free messages in the pool */
+
+  sem_init(&msgq->poolsem, 0, msgq->maxmsgs);
+  return OK;
+}
+
+/************************************************************************
+ * Name: mq_pooldestroy
+ *
+ * Description:
+ *   Free the pool of messages of a message queue (if it has one).
+ *   Messages in the pool that are still in use by a task become invalid.
+ *
+ * Inputs:
+ *   msgq - The message queue being deallocated
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+void mq_pooldestroy(FAR msgq_t *msgq)
+{
+  if (msgq->pool)
+    {
+      sem_destroy(&msgq->poolsem);
+      sched_kfree(msgq->pool);
+      msgq->pool = NULL;
+    }
+}
+
+/************************************************************************
+ * Name: mq_poolalloc
+ *
+ * Description:
+ *   Get a message from the pool of a message queue, waiting until one is
+ *   released if the pool is empty and O_NONBLOCK is not set.  From an
+ *   interrupt handler, this never waits.
+ *
+ * Inputs:
+ *   mqdes   - Message queue descriptor of a queue with a pool
+ *   abstime - The time at which to stop waiting (NULL: wait forever)
+ *
+ * Return Value:
+ *   The message on success.  NULL on failure with errno set to EAGAIN
+ *   (the pool is empty and we may not wait), EINTR, or ETIMEDOUT.
+ *
+ ************************************************************************/
+
+FAR mqmsg_t *mq_poolalloc(mqd_t mqdes, FAR const struct timespec *abstime)
+{
+  FAR msgq_t *msgq = mqdes->msgq;
+  FAR mqmsg_t *mqmsg;
+  irqstate_t saved_state;
+  int ret;
+
+  DEBUGASSERT(msgq->pool);
+
+  if (up_interrupt_context())
+    {
+      /* sem_trywait() may not be called from an interrupt handler.  Take
+       * the count in the same critical section as the message.
+       */
+
+      saved_state = irqsave();
+      if (msgq->poolsem.semcount <= 0)
+        {
+          irqrestore(saved_state);
+          set_errno(EAGAIN);
+          return NULL;
+        }
+
+      msgq->poolsem.semcount--;
+      mqmsg = (FAR mqmsg_t *)sq_remfirst(&msgq->poolfree);
+      irqrestore(saved_state);
+      return mqmsg;
+    }
+
+  if ((mqdes->oflags & O_NONBLOCK) != 0)
+    {
+      ret = sem_trywait(&msgq->poolsem);
+    }
+  else if (abstime)
+    {
+      ret = sem_timedwait(&msgq->poolsem, abstime);
+    }
+  else
+    {
+      ret = sem_wait(&msgq->poolsem);
+    }
+
+  if (ret < 0)
+    {
+      return NULL;
+    }
+
+  /* There is now a free message reserved for us in the pool */
+
+  saved_state = irqsave();
+  mqmsg = (FAR mqmsg_t *)sq_remfirst(&msgq->poolfree);
+  irqrestore(saved_state);
+
+  DEBUGASSERT(mqmsg);
+  return mqmsg;
+}
+
+/************************************************************************
+ * Name: mq_poolfree
+ *
+ * Description:
+ *   Return a message to the pool of its message queue and wake up a task
+ *   waiting for a message from the pool.
+ *
+ * Inputs:
+ *   msgq  - The message queue that owns the pool
+ *   mqmsg - A message from the pool
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+void mq_poolfree(FAR msgq_t *msgq, FAR mqmsg_t *mqmsg)
+{
+  irqstate_t saved_state;
+
+  DEBUGASSERT(mqmsg->type == MQ_ALLOC_POOL);
+
+  saved_state = irqsave();
+  sq_addlast((FAR sq_entry_t *)mqmsg, &msgq->poolfree);
+  irqrestore(saved_state);
+
+  sem_post(&msgq->poolsem);
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
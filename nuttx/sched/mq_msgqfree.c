@@ -98,10 +98,22 @@ void mq_msgqfree(FAR msgq_t *msgq)
       /* Deallocate the message structure. */
 
       next = curr->next;
-      mq_msgfree(curr);
+#ifdef CONFIG_MQ_ZEROCOPY
+      if (curr->type != MQ_ALLOC_POOL)
+#endif
+        {
+          mq_msgfree(curr);
+        }
+
       curr = next;
     }
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* Deallocate the message queue's own pool of messages */
+
+  mq_pooldestroy(msgq);
+#endif
+
   /* Then deallocate the message queue itself */
 
   sched_kfree(msgq);
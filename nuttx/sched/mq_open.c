@@ -99,6 +99,9 @@
  *        is used at the time that the message queue is
  *        created to determine the maximum number of
  *        messages that may be placed in the message queue.
+ *        If CONFIG_MQ_ZEROCOPY is enabled and MQ_ZEROCOPY is set in
+ *        mq_flags, the message queue gets its own pool of mq_maxmsg
+ *        messages of mq_msgsize bytes.
  *
  * Return Value:
  *   A message queue descriptor or -1 (ERROR)
@@ -159,40 +162,75 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
               msgq = (FAR msgq_t*)kzalloc(SIZEOF_MQ_HEADER + namelen + 1);
               if (msgq)
                 {
-                  /* Create a message queue descriptor for the TCB */
-
-                  mqdes = mq_descreate(rtcb, msgq, oflags);
-                  if (mqdes)
-                    {
-                      /* Set up to get the optional arguments needed to create
-                       * a message queue.
-                       */
+                  /* Set up to get the optional arguments needed to create
+                   * a message queue.
+                   */
 
-                      va_start(arg, oflags);
-                      (void)va_arg(arg, mode_t); /* MQ creation mode parameter (ignored) */
-                      attr = va_arg(arg, struct mq_attr*);
+                  va_start(arg, oflags);
+                  (void)va_arg(arg, mode_t); /* MQ creation mode parameter (ignored) */
+                  attr = va_arg(arg, struct mq_attr*);
 
-                      /* Initialize the new named message queue */
+                  /* Initialize the new named message queue */
 
-                      sq_init(&msgq->msglist);
-                      if (attr)
+                  sq_init(&msgq->msglist);
+                  if (attr)
+                    {
+                      msgq->maxmsgs = (int16_t)attr->mq_maxmsg;
+#ifdef CONFIG_MQ_ZEROCOPY
+                      if ((attr->mq_flags & MQ_ZEROCOPY) != 0)
                         {
-                          msgq->maxmsgs = (int16_t)attr->mq_maxmsg;
-                          if (attr->mq_msgsize <= MQ_MAX_BYTES)
+                          /* Messages in the queue's own pool are not
+                           * limited to MQ_MAX_BYTES.
+                           */
+
+                          if (attr->mq_msgsize <= UINT16_MAX)
                             {
-                              msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
+                              msgq->maxmsgsize = (uint16_t)attr->mq_msgsize;
                             }
                           else
                             {
-                              msgq->maxmsgsize = MQ_MAX_BYTES;
+                              msgq->maxmsgsize = UINT16_MAX;
                             }
                         }
                       else
+#endif
+                      if (attr->mq_msgsize <= MQ_MAX_BYTES)
+                        {
+                          msgq->maxmsgsize = (int16_t)attr->mq_msgsize;
+                        }
+                      else
                         {
-                          msgq->maxmsgs = MQ_MAX_MSGS;
                           msgq->maxmsgsize = MQ_MAX_BYTES;
                         }
+                    }
+                  else
+                    {
+                      msgq->maxmsgs = MQ_MAX_MSGS;
+                      msgq->maxmsgsize = MQ_MAX_BYTES;
+                    }
 
+                  /* Clean-up variable argument stuff */
+
+                  va_end(arg);
+
+#ifdef CONFIG_MQ_ZEROCOPY
+                  /* Allocate the message queue's own pool of messages */
+
+                  if (attr && (attr->mq_flags & MQ_ZEROCOPY) != 0 &&
+                      mq_poolcreate(msgq) < 0)
+                    {
+                      sched_kfree(msgq);
+                      sched_unlock();
+                      set_errno(ENOMEM);
+                      return (mqd_t)ERROR;
+                    }
+#endif
+
+                  /* Create a message queue descriptor for the TCB */
+
+                  mqdes = mq_descreate(rtcb, msgq, oflags);
+                  if (mqdes)
+                    {
                       msgq->nconnect = 1;
 #ifndef CONFIG_DISABLE_SIGNALS
                       msgq->ntpid    = INVALID_PROCESS_ID;
@@ -204,10 +242,6 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
                        */
 
                       sq_addlast((FAR sq_entry_t*)msgq, &g_msgqueues);
-
-                      /* Clean-up variable argument stuff */
-
-                      va_end(arg);
                     }
                   else
                     {
@@ -215,6 +249,9 @@ mqd_t mq_open(const char *mq_name, int oflags, ...)
                        * uninitialized, mq_deallocate() is not used.
                        */
 
+#ifdef CONFIG_MQ_ZEROCOPY
+                      mq_pooldestroy(msgq);
+#endif
                       sched_kfree(msgq);
                     }
                 }
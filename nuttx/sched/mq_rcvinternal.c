@@ -231,6 +231,8 @@ FAR mqmsg_t *mq_waitreceive(mqd_t mqdes)
  *   mqdes - Message queue descriptor
  *   mqmsg   - The message obtained by mq_waitmsg()
  *   ubuffer - The address of the user provided buffer to receive the message
+ *             or NULL.  If NULL, the message is neither copied nor freed;
+ *             the caller keeps it (see mq_receivebuffer()).
  *   prio    - The user-provided location to return the message priority.
  *
  * Return Value:
@@ -256,24 +258,36 @@ ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio)
 
   rcvmsglen = mqmsg->msglen;
 
-  /* Copy the message into the caller's buffer */
-
-  memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
-
-  /* Copy the message priority as well (if a buffer is provided) */
+  /* Copy the message priority (if a buffer is provided) */
 
   if (prio)
     {
       *prio = mqmsg->priority;
     }
 
-  /* We are done with the message.  Deallocate it now. */
+  msgq = mqdes->msgq;
+  if (ubuffer)
+    {
+      /* Copy the message into the caller's buffer */
 
-  mq_msgfree(mqmsg);
+      memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
+
+      /* We are done with the message.  Deallocate it now. */
+
+#ifdef CONFIG_MQ_ZEROCOPY
+      if (mqmsg->type == MQ_ALLOC_POOL)
+        {
+          mq_poolfree(msgq, mqmsg);
+        }
+      else
+#endif
+        {
+          mq_msgfree(mqmsg);
+        }
+    }
 
   /* Check if any tasks are waiting for the MQ not full event. */
 
-  msgq = mqdes->msgq;
   if (msgq->nwaitnotfull > 0)
     {
       /* Find the highest priority task that is waiting for
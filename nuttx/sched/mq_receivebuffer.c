@@ -0,0 +1,158 @@
+/****************************************************************************
+ * sched/mq_receivebuffer.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_receivebuffer
+ *
+ * Description:
+ *   This non-standard function removes the oldest message with the highest
+ *   priority from the message queue, just as mq_receive() does, but
+ *   instead of copying the message it returns a pointer to the message
+ *   buffer.  The caller must return the buffer with mq_releasebuffer()
+ *   when it is done with the message and before the message queue is
+ *   closed.  While the caller holds the buffer, it is not available to
+ *   senders to a message queue created with MQ_ZEROCOPY.
+ *
+ *   If the message queue is empty and O_NONBLOCK was not set,
+ *   mq_receivebuffer() will block until a message is added to the message
+ *   queue.
+ *
+ * Parameters:
+ *   mqdes - Message Queue Descriptor
+ *   buffer - Location to return the address of the message buffer
+ *   prio - If not NULL, the location to store message priority.
+ *
+ * Return Value:
+ *   One success, the length of the selected message in bytes is returned.
+ *   On failure, -1 (ERROR) is returned and the errno is set appropriately:
+ *
+ *   EAGAIN   The queue was empty, and the O_NONBLOCK flag was set
+ *            for the message queue description referred to by 'mqdes'.
+ *   EPERM    Message queue opened not opened for reading.
+ *   EINTR    The wait was interrupted by a signal.
+ *   EINVAL   Invalid 'buffer' or 'mqdes'
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+ssize_t mq_receivebuffer(mqd_t mqdes, FAR void **buffer, int *prio)
+{
+  FAR mqmsg_t *mqmsg;
+  irqstate_t   saved_state;
+  ssize_t      ret = ERROR;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  /* Verify the input parameters */
+
+  if (!buffer || !mqdes)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if ((mqdes->oflags & O_RDOK) == 0)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+
+  /* Get the next message from the message queue.  mq_waitreceive()
+   * expects to have interrupts disabled because messages can be sent from
+   * interrupt level.
+   */
+
+  sched_lock();
+  saved_state = irqsave();
+  mqmsg = mq_waitreceive(mqdes);
+  irqrestore(saved_state);
+
+  /* Hand the message to the caller without copying or freeing it */
+
+  if (mqmsg)
+    {
+      *buffer = (FAR void *)mqmsg->mail;
+      ret = mq_doreceive(mqdes, mqmsg, NULL, prio);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -0,0 +1,136 @@
+/****************************************************************************
+ * sched/mq_releasebuffer.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_releasebuffer
+ *
+ * Description:
+ *   This non-standard function returns a message buffer obtained with
+ *   mq_receivebuffer() or an unsent buffer obtained with mq_getbuffer().
+ *   If the message queue was created with MQ_ZEROCOPY, the buffer goes
+ *   back to the queue's pool and a task waiting in mq_getbuffer() or
+ *   mq_send() is awakened.  The buffer may not be used after it has been
+ *   released.
+ *
+ * Parameters:
+ *   mqdes - Descriptor of the message queue that the buffer came from
+ *   buffer - The buffer to release
+ *
+ * Return Value:
+ *   0 (OK) on success.  On failure, -1 (ERROR) is returned with errno set
+ *   to EINVAL (buffer or mqdes is NULL).
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+int mq_releasebuffer(mqd_t mqdes, FAR void *buffer)
+{
+  FAR msgq_t  *msgq;
+  FAR mqmsg_t *mqmsg;
+
+  /* Verify the input parameters */
+
+  if (!buffer || !mqdes)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  msgq  = mqdes->msgq;
+  mqmsg = MQ_BUFFER2MSG(buffer);
+
+  if (mqmsg->type == MQ_ALLOC_POOL)
+    {
+      /* Return the buffer to the pool that it came from */
+
+      DEBUGASSERT(msgq->pool && (FAR void *)mqmsg >= msgq->pool &&
+                  (FAR uint8_t *)mqmsg < (FAR uint8_t *)msgq->pool +
+                  msgq->maxmsgs * SIZEOF_MQ_POOLMSG(msgq->maxmsgsize));
+
+      mq_poolfree(msgq, mqmsg);
+    }
+  else
+    {
+      mq_msgfree(mqmsg);
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
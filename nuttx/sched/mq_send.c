@@ -137,6 +137,24 @@ int mq_send(mqd_t mqdes, const void *msg, size_t msglen, int prio)
   sched_lock();
   msgq = mqdes->msgq;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* If the message queue has its own pool of messages, then wait for a
+   * message from the pool.  The queue cannot be full while we hold one.
+   */
+
+  if (msgq->pool)
+    {
+      mqmsg = mq_poolalloc(mqdes, NULL);
+      if (mqmsg)
+        {
+          ret = mq_dosend(mqdes, mqmsg, msg, msglen, prio);
+        }
+
+      sched_unlock();
+      return ret;
+    }
+#endif
+
   /* Allocate a message structure:
    * - Immediately if we are called from an interrupt handler.
    * - Immediately if the message queue is not full, or
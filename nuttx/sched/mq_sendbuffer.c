@@ -0,0 +1,167 @@
+/****************************************************************************
+ * sched/mq_sendbuffer.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "os_internal.h"
+#include "mq_internal.h"
+
+#ifdef CONFIG_MQ_ZEROCOPY
+
+/****************************************************************************
+ * Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Type Declarations
+ ****************************************************************************/
+
+/****************************************************************************
+ * Global Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_sendbuffer
+ *
+ * Description:
+ *   This non-standard function adds a message buffer obtained with
+ *   mq_getbuffer() to the message queue without copying it.  The buffer
+ *   then belongs to the message queue.  If the function fails, the buffer
+ *   still belongs to the caller who may send it again or return it with
+ *   mq_releasebuffer().
+ *
+ *   If the message queue is full (which can only happen if it has no pool
+ *   of its own) and O_NONBLOCK is not set, mq_sendbuffer() blocks until
+ *   space becomes available, just as mq_send() does.
+ *
+ * Parameters:
+ *   mqdes - Message queue descriptor
+ *   buffer - Buffer from mq_getbuffer() containing the message
+ *   msglen - The length of the message in bytes
+ *   prio - The priority of the message
+ *
+ * Return Value:
+ *   On success, mq_sendbuffer() returns 0 (OK); on error, -1 (ERROR) is
+ *   returned, with errno set to indicate the error:
+ *
+ *   EAGAIN   The queue was full and the O_NONBLOCK flag was set for the
+ *            message queue description referred to by mqdes.
+ *   EINVAL   Either buffer or mqdes is NULL or the value of prio is invalid.
+ *   EPERM    Message queue opened not opened for writing.
+ *   EMSGSIZE 'msglen' was greater than the maxmsgsize attribute of the
+ *            message queue.
+ *   EINTR    The call was interrupted by a signal handler.
+ *
+ * Assumptions/restrictions:
+ *
+ ****************************************************************************/
+
+int mq_sendbuffer(mqd_t mqdes, FAR void *buffer, size_t msglen, int prio)
+{
+  FAR msgq_t  *msgq;
+  FAR mqmsg_t *mqmsg;
+  irqstate_t   saved_state;
+  int          ret = ERROR;
+
+  /* Verify the input parameters -- setting errno appropriately
+   * on any failures to verify.
+   */
+
+  if (mq_verifysend(mqdes, buffer, msglen, prio) != OK)
+    {
+      return ERROR;
+    }
+
+  msgq  = mqdes->msgq;
+  mqmsg = MQ_BUFFER2MSG(buffer);
+
+  /* A buffer from the pool of a message queue can only be sent to that
+   * message queue.
+   */
+
+  DEBUGASSERT((mqmsg->type == MQ_ALLOC_POOL) == (msgq->pool != NULL));
+
+  /* Queue the message:
+   * - Immediately if we are called from an interrupt handler.
+   * - Immediately if the message queue is not full, or
+   * - After successfully waiting for the message queue to become
+   *   non-FULL.  This would fail with EAGAIN or EINTR.
+   */
+
+  sched_lock();
+  saved_state = irqsave();
+  if (up_interrupt_context()      || /* In an interrupt handler */
+      msgq->nmsgs < msgq->maxmsgs || /* OR Message queue not full */
+      mq_waitsend(mqdes) == OK)      /* OR Successfully waited for mq not full */
+    {
+      /* Perform the message send without copying the message */
+
+      irqrestore(saved_state);
+      ret = mq_dosend(mqdes, mqmsg, NULL, msglen, prio);
+    }
+  else
+    {
+      irqrestore(saved_state);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MQ_ZEROCOPY */
@@ -313,7 +313,8 @@ int mq_waitsend(mqd_t mqdes)
  * 
  * Parameters:
  *   mqdes - Message queue descriptor
- *   msg - Message to send
+ *   mqmsg - The message structure to add to the queue
+ *   msg - Message to send (NULL if the message data is already in mqmsg)
  *   msglen - The length of the message in bytes
  *   prio - The priority of the message
  *
@@ -342,9 +343,14 @@ int mq_dosend(mqd_t mqdes, FAR mqmsg_t *mqmsg, const void *msg, size_t msglen, i
   mqmsg->priority = prio;
   mqmsg->msglen   = msglen;
 
-  /* Copy the message data into the message */
+  /* Copy the message data into the message (unless the sender has filled
+   * in the message in place)
+   */
 
-  memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+  if (msg)
+    {
+      memcpy((void*)mqmsg->mail, (const void*)msg, msglen);
+    }
 
   /* Insert the new message in the message queue */
 
@@ -209,6 +209,26 @@ int mq_timedsend(mqd_t mqdes, const char *msg, size_t msglen, int prio,
 
   msgq = mqdes->msgq;
 
+#ifdef CONFIG_MQ_ZEROCOPY
+  /* If the message queue has its own pool of messages, then wait (with
+   * the timeout) for a message from the pool.  The queue cannot be full
+   * while we hold one so the watchdog below is not needed.
+   */
+
+  if (msgq->pool)
+    {
+      mqmsg = mq_poolalloc(mqdes, abstime);
+      if (mqmsg)
+        {
+          sched_lock();
+          ret = mq_dosend(mqdes, mqmsg, msg, msglen, prio);
+          sched_unlock();
+        }
+
+      return ret;
+    }
+#endif
+
   /* Create a watchdog.  We will not actually need this watchdog
    * unless the queue is full, but we will reserve it up front
    * before we enter the following critical section.
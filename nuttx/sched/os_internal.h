@@ -249,6 +249,14 @@ int  kernel_thread(FAR const char *name, int priority, main_t entry,
 bool sched_addreadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_removereadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_addprioritized(FAR struct tcb_s *newTcb, DSEG dq_queue_t *list);
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+FAR struct tcb_s *sched_prioindex_next(FAR struct tcb_s *tcb,
+                                       DSEG dq_queue_t *list);
+void sched_removeprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list);
+#else
+#  define sched_removeprioritized(tcb,list) \
+     dq_rem((FAR dq_entry_t*)(tcb), (list))
+#endif
 bool sched_mergepending(void);
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
@@ -263,4 +271,13 @@ bool sched_verifytcb(FAR struct tcb_s *tcb);
 
 int  sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
 
+#ifdef CONFIG_SCHED_TICKLESS
+void sched_timer_update(void);
+void sched_timer_reassess(void);
+#endif
+
+#ifdef CONFIG_SCHED_CPULOAD
+void sched_process_cpuload(void);
+#endif
+
 #endif /* __SCHED_OS_INTERNAL_H */
@@ -249,7 +249,12 @@ static inline bool pg_dequeue(void)
     {
       /* Remove the TCB from the head of the list (if any) */
 
-      g_pftcb = (FAR struct tcb_s *)dq_remfirst((dq_queue_t*)&g_waitingforfill);
+      g_pftcb = (FAR struct tcb_s *)g_waitingforfill.head;
+      if (g_pftcb != NULL)
+        {
+          sched_removeprioritized(g_pftcb, (dq_queue_t*)&g_waitingforfill);
+        }
+
       pgllvdbg("g_pftcb: %p\n", g_pftcb);
       if (g_pftcb != NULL)
         {
@@ -106,6 +106,13 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
 
   ASSERT(sched_priority >= SCHED_PRIORITY_MIN);
 
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+  /* Look up the location to insert the new TCB in the list's priority
+   * index.
+   */
+
+  next = sched_prioindex_next(tcb, list);
+#else
   /* Search the list to find the location to insert the new Tcb.
    * Each is list is maintained in ascending sched_priority order.
    */
@@ -113,6 +120,7 @@ bool sched_addprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
   for (next = (FAR struct tcb_s*)list->head;
       (next && sched_priority <= next->sched_priority);
       next = next->flink);
+#endif
 
   /* Add the tcb to the spot found in the list.  Check if the tcb
    * goes at the end of the list. NOTE:  This could only happen if list
@@ -145,5 +145,17 @@ bool sched_addreadytorun(FAR struct tcb_s *btcb)
       ret = false;
     }
 
+  /* In the tickless mode, the interval timer must be reprogrammed when the
+   * running task changes so that the round robin timeslice of the new task
+   * is enforced.
+   */
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  if (ret)
+    {
+      sched_timer_reassess();
+    }
+#endif
+
   return ret;
 }
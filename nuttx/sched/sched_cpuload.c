@@ -0,0 +1,189 @@
+/************************************************************************
+ * sched/sched_cpuload.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sched.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/clock.h>
+#include <arch/irq.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_CPULOAD
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/* When the total number of ticks reaches this value, all of the counts
+ * are halved.
+ */
+
+#define CPULOAD_TIMECONSTANT \
+  (CONFIG_SCHED_CPULOAD_TIMECONSTANT * MSEC_PER_SEC / MSEC_PER_TICK)
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/************************************************************************
+ * Global Variables
+ ************************************************************************/
+
+/* This is the total number of clock ticks counted since the last time
+ * that the counts were halved.  It is the sum of the ticks counts of
+ * all of the threads (including the threads that have since exited).
+ */
+
+volatile uint32_t g_cpuload_total;
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_process_cpuload
+ *
+ * Description:
+ *   Collect data that can be used for CPU load measurements.  This is
+ *   called from sched_process_timer() on each system timer tick, so it
+ *   is executed from the timer interrupt handler.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+void sched_process_cpuload(void)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+  int hash_index;
+
+  /* Increment the count on the currently executing thread and the
+   * total.
+   */
+
+  rtcb->ticks++;
+  g_cpuload_total++;
+
+  /* If the total exceeds the time constant, then divide all of the
+   * counts by two so that older activity ages out.  The total is then
+   * recalculated from the counts of the threads that are still alive.
+   */
+
+  if (g_cpuload_total > CPULOAD_TIMECONSTANT)
+    {
+      uint32_t total = 0;
+
+      for (hash_index = 0; hash_index < CONFIG_MAX_TASKS; hash_index++)
+        {
+          FAR struct tcb_s *tcb = g_pidhash[hash_index].tcb;
+          if (tcb)
+            {
+              tcb->ticks >>= 1;
+              total += tcb->ticks;
+            }
+        }
+
+      g_cpuload_total = total;
+    }
+}
+
+/************************************************************************
+ * Name: clock_cpuload
+ *
+ * Description:
+ *   Return load measurement data for the selected PID.
+ *
+ * Parameters:
+ *   pid - The task ID of the thread of interest.  pid == 0 is the IDLE
+ *         thread.
+ *   cpuload - The location to return the CPU load
+ *
+ * Return Value:
+ *   OK (0) on success; a negated errno value on failure.  The only
+ *   reason that this function can fail is if 'pid' no longer refers to
+ *   a valid thread (-ESRCH).
+ *
+ ************************************************************************/
+
+int clock_cpuload(int pid, FAR struct cpuload_s *cpuload)
+{
+  irqstate_t flags;
+  int hash_index = PIDHASH(pid);
+  int ret = -ESRCH;
+
+  DEBUGASSERT(cpuload);
+
+  /* Momentarily disable interrupts so that the total and the count of
+   * the thread are consistent with each other.
+   */
+
+  flags = irqsave();
+
+  /* Make sure that the entry is valid.  The pid hash table entry could
+   * be reused by another thread with a different ID.
+   */
+
+  if (g_pidhash[hash_index].tcb && g_pidhash[hash_index].pid == pid)
+    {
+      cpuload->total  = g_cpuload_total;
+      cpuload->active = g_pidhash[hash_index].tcb->ticks;
+      ret = OK;
+    }
+
+  irqrestore(flags);
+  return ret;
+}
+
+#endif /* CONFIG_SCHED_CPULOAD */
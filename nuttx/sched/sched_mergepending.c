@@ -95,11 +95,43 @@
 bool sched_mergepending(void)
 {
   FAR struct tcb_s *pndtcb;
+#ifndef CONFIG_SCHED_PRIORITY_BITMAP
   FAR struct tcb_s *pndnext;
-  FAR struct tcb_s *rtrtcb;
   FAR struct tcb_s *rtrprev;
+#endif
+  FAR struct tcb_s *rtrtcb;
   bool ret = false;
 
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+  /* Move each TCB from the head of the g_pendingtasks list into the
+   * g_readytorun list.  The priority indices of both lists locate the
+   * position of each TCB without a search.
+   */
+
+  rtrtcb = (FAR struct tcb_s*)g_readytorun.head;
+  while ((pndtcb = (FAR struct tcb_s*)g_pendingtasks.head) != NULL)
+    {
+      sched_removeprioritized(pndtcb, (FAR dq_queue_t*)&g_pendingtasks);
+      if (sched_addprioritized(pndtcb, (FAR dq_queue_t*)&g_readytorun))
+        {
+          /* Inform the instrumentation layer that we are switching tasks */
+
+          sched_note_switch(rtrtcb, pndtcb);
+
+          /* The pndtcb is now the head of the list */
+
+          rtrtcb->task_state = TSTATE_TASK_READYTORUN;
+          pndtcb->task_state = TSTATE_TASK_RUNNING;
+          rtrtcb             = pndtcb;
+          ret                = true;
+        }
+      else
+        {
+          pndtcb->task_state = TSTATE_TASK_READYTORUN;
+        }
+    }
+
+#else
   /* Initialize the inner search loop */
 
   rtrtcb = (FAR struct tcb_s*)g_readytorun.head;
@@ -167,6 +199,19 @@ bool sched_mergepending(void)
 
   g_pendingtasks.head = NULL;
   g_pendingtasks.tail = NULL;
+#endif
+
+  /* In the tickless mode, the interval timer must be reprogrammed when the
+   * running task changes so that the round robin timeslice of the new task
+   * is enforced.
+   */
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  if (ret)
+    {
+      sched_timer_reassess();
+    }
+#endif
 
   return ret;
 }
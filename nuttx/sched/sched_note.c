@@ -0,0 +1,230 @@
+/************************************************************************
+ * sched/sched_note.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sched.h>
+#include <stdint.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/sched_note.h>
+#include <arch/irq.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_BUFFER
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/* The circular buffer of notes.  One entry is always left unused so that
+ * a full buffer can be distinguished from an empty one.
+ */
+
+struct note_info_s
+{
+  volatile unsigned int ni_head;  /* Index of the next note to write */
+  volatile unsigned int ni_tail;  /* Index of the oldest note */
+  struct note_s ni_buffer[CONFIG_SCHED_NOTE_NENTRIES];
+};
+
+/************************************************************************
+ * Global Variables
+ ************************************************************************/
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+static struct note_info_s g_note_info;
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: note_next
+ *
+ * Description:
+ *   Return the index of the entry after 'ndx' in the circular buffer.
+ *
+ ************************************************************************/
+
+static inline unsigned int note_next(unsigned int ndx)
+{
+  if (++ndx >= CONFIG_SCHED_NOTE_NENTRIES)
+    {
+      ndx = 0;
+    }
+
+  return ndx;
+}
+
+/************************************************************************
+ * Name: note_add
+ *
+ * Description:
+ *   Add one note to the circular buffer.  If the buffer is full, then the
+ *   oldest note is discarded.  This may be called from interrupt
+ *   handlers.
+ *
+ ************************************************************************/
+
+static void note_add(uint8_t type, FAR struct tcb_s *tcb, uintptr_t arg)
+{
+  FAR struct note_s *note;
+  irqstate_t flags;
+  unsigned int head;
+  unsigned int next;
+
+  flags = irqsave();
+
+  head = g_note_info.ni_head;
+  next = note_next(head);
+  if (next == g_note_info.ni_tail)
+    {
+      /* The buffer is full.  Discard the oldest note */
+
+      g_note_info.ni_tail = note_next(next);
+    }
+
+  note              = &g_note_info.ni_buffer[head];
+  note->nt_type     = type;
+  note->nt_priority = tcb->sched_priority;
+  note->nt_pid      = tcb->pid;
+  note->nt_systime  = clock_systimer();
+  note->nt_arg      = arg;
+
+  g_note_info.ni_head = next;
+  irqrestore(flags);
+}
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_note_start, sched_note_stop, sched_note_switch,
+ *       sched_note_irqhandler, sched_note_semblock
+ *
+ * Description:
+ *   The instrumentation hooks called by the scheduler (see
+ *   include/sched.h).  Each adds one note to the circular buffer.
+ *
+ ************************************************************************/
+
+void sched_note_start(FAR struct tcb_s *tcb)
+{
+  note_add(NOTE_START, tcb, 0);
+}
+
+void sched_note_stop(FAR struct tcb_s *tcb)
+{
+  note_add(NOTE_STOP, tcb, 0);
+}
+
+void sched_note_switch(FAR struct tcb_s *pFromTcb, FAR struct tcb_s *pToTcb)
+{
+  note_add(NOTE_SWITCH, pToTcb, (uintptr_t)pFromTcb->pid);
+}
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_IRQHANDLER
+void sched_note_irqhandler(int irq)
+{
+  note_add(NOTE_IRQHANDLER, (FAR struct tcb_s*)g_readytorun.head,
+           (uintptr_t)irq);
+}
+#endif
+
+#ifdef CONFIG_SCHED_INSTRUMENTATION_SEMAPHORE
+void sched_note_semblock(FAR struct tcb_s *tcb, FAR sem_t *sem)
+{
+  note_add(NOTE_SEMBLOCK, tcb, (uintptr_t)sem);
+}
+#endif
+
+/************************************************************************
+ * Name: sched_note_read
+ *
+ * Description:
+ *   Remove the oldest notes from the circular buffer and copy them to
+ *   the caller's buffer.  This function does not wait for notes;  it
+ *   returns zero if the buffer is empty.
+ *
+ * Inputs:
+ *   buffer - The location to return the notes
+ *   nnotes - The maximum number of notes to return
+ *
+ * Return Value:
+ *   The number of notes returned.
+ *
+ ************************************************************************/
+
+size_t sched_note_read(FAR struct note_s *buffer, size_t nnotes)
+{
+  irqstate_t flags;
+  size_t nread;
+
+  for (nread = 0; nread < nnotes; nread++)
+    {
+      /* Interrupts are disabled only while one note is copied so that
+       * reading a large buffer does not add to the interrupt latency.
+       */
+
+      flags = irqsave();
+      if (g_note_info.ni_tail == g_note_info.ni_head)
+        {
+          irqrestore(flags);
+          break;
+        }
+
+      buffer[nread]       = g_note_info.ni_buffer[g_note_info.ni_tail];
+      g_note_info.ni_tail = note_next(g_note_info.ni_tail);
+      irqrestore(flags);
+    }
+
+  return nread;
+}
+
+#endif /* CONFIG_SCHED_INSTRUMENTATION_BUFFER */
@@ -0,0 +1,292 @@
+/************************************************************************
+ * sched/sched_prioindex.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "os_internal.h"
+
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/* One bit per priority level in words of 32 bits, and one summary bit
+ * per word.
+ */
+
+#define PRIO_NLEVELS  (SCHED_PRIORITY_MAX + 1)
+#define PRIO_NWORDS   ((PRIO_NLEVELS + 31) >> 5)
+
+#if PRIO_NWORDS > 32
+#  error "Too many priority levels for the summary word"
+#endif
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/* The index of one prioritized task list.  The TCBs of each priority are
+ * contiguous in the list; head[] points to the first of them and the
+ * bitmap tells which priorities are present.
+ */
+
+struct prioindex_s
+{
+  uint32_t summary;                         /* Bit n: map[n] != 0 */
+  uint32_t map[PRIO_NWORDS];                /* Bit set: priority present */
+  FAR struct tcb_s *head[PRIO_NLEVELS];     /* First TCB of each priority */
+};
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+static struct prioindex_s g_readytorunndx;
+static struct prioindex_s g_pendingndx;
+static struct prioindex_s g_semwaitndx;
+#ifndef CONFIG_DISABLE_MQUEUE
+static struct prioindex_s g_mqnotemptyndx;
+static struct prioindex_s g_mqnotfullndx;
+#endif
+#ifdef CONFIG_PAGING
+static struct prioindex_s g_pagefillndx;
+#endif
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_fls
+ *
+ * Description:
+ *   Return the bit number of the most significant bit set in a non-zero
+ *   value.
+ *
+ ************************************************************************/
+
+static inline int sched_fls(uint32_t value)
+{
+#ifdef __GNUC__
+  return 31 - __builtin_clz(value);
+#else
+  int bit = 0;
+
+  while (value > 1)
+    {
+      value >>= 1;
+      bit++;
+    }
+
+  return bit;
+#endif
+}
+
+/************************************************************************
+ * Name: sched_findindex
+ *
+ * Description:
+ *   Return the index of a prioritized task list.
+ *
+ ************************************************************************/
+
+static FAR struct prioindex_s *sched_findindex(DSEG dq_queue_t *list)
+{
+  if (list == (FAR dq_queue_t*)&g_readytorun)
+    {
+      return &g_readytorunndx;
+    }
+  else if (list == (FAR dq_queue_t*)&g_pendingtasks)
+    {
+      return &g_pendingndx;
+    }
+  else if (list == (FAR dq_queue_t*)&g_waitingforsemaphore)
+    {
+      return &g_semwaitndx;
+    }
+#ifndef CONFIG_DISABLE_MQUEUE
+  else if (list == (FAR dq_queue_t*)&g_waitingformqnotempty)
+    {
+      return &g_mqnotemptyndx;
+    }
+  else if (list == (FAR dq_queue_t*)&g_waitingformqnotfull)
+    {
+      return &g_mqnotfullndx;
+    }
+#endif
+#ifdef CONFIG_PAGING
+  else if (list == (FAR dq_queue_t*)&g_waitingforfill)
+    {
+      return &g_pagefillndx;
+    }
+#endif
+
+  /* Not a prioritized list */
+
+  PANIC();
+  return NULL;
+}
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: sched_prioindex_next
+ *
+ * Description:
+ *   Find the TCB that a new TCB must be inserted in front of in a
+ *   prioritized list and record the new TCB in the index.  That is the
+ *   first TCB of the highest priority lower than the new TCB's
+ *   priority, so that the new TCB follows any TCBs of equal priority.
+ *
+ * Inputs:
+ *   tcb - The TCB about to be added to the list
+ *   list - The prioritized list
+ *
+ * Return Value:
+ *   The TCB that the new TCB goes just before, or NULL if the new TCB
+ *   goes at the end of the list.
+ *
+ * Assumptions:
+ *   The caller has disabled interrupts and inserts the TCB as returned.
+ *
+ ************************************************************************/
+
+FAR struct tcb_s *sched_prioindex_next(FAR struct tcb_s *tcb,
+                                       DSEG dq_queue_t *list)
+{
+  FAR struct prioindex_s *ndx = sched_findindex(list);
+  int priority = tcb->sched_priority;
+  int word     = priority >> 5;
+  uint32_t bit = (uint32_t)1 << (priority & 31);
+  uint32_t bits;
+  uint32_t words;
+  FAR struct tcb_s *next = NULL;
+
+  /* Look for a lower priority in the same word of the bitmap, then in the
+   * lower words.
+   */
+
+  bits = ndx->map[word] & (bit - 1);
+  if (bits != 0)
+    {
+      next = ndx->head[(word << 5) + sched_fls(bits)];
+    }
+  else
+    {
+      words = ndx->summary & (((uint32_t)1 << word) - 1);
+      if (words != 0)
+        {
+          int lower = sched_fls(words);
+          next = ndx->head[(lower << 5) + sched_fls(ndx->map[lower])];
+        }
+    }
+
+  /* If this is the first TCB of this priority, it becomes the head of its
+   * priority.
+   */
+
+  if ((ndx->map[word] & bit) == 0)
+    {
+      ndx->map[word]      |= bit;
+      ndx->summary        |= (uint32_t)1 << word;
+      ndx->head[priority]  = tcb;
+    }
+
+  return next;
+}
+
+/************************************************************************
+ * Name: sched_removeprioritized
+ *
+ * Description:
+ *   Remove a TCB from a prioritized list and from the list's index.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to remove
+ *   list - The prioritized list that holds the TCB
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *   The caller has disabled interrupts.
+ *
+ ************************************************************************/
+
+void sched_removeprioritized(FAR struct tcb_s *tcb, DSEG dq_queue_t *list)
+{
+  FAR struct prioindex_s *ndx = sched_findindex(list);
+  FAR struct tcb_s *next = tcb->flink;
+  int priority = tcb->sched_priority;
+  int word;
+
+  /* If the TCB heads its priority, the next TCB takes over if it has the
+   * same priority.  Otherwise, the priority is no longer present.
+   */
+
+  if (ndx->head[priority] == tcb)
+    {
+      if (next && next->sched_priority == priority)
+        {
+          ndx->head[priority] = next;
+        }
+      else
+        {
+          word = priority >> 5;
+          ndx->head[priority] = NULL;
+          ndx->map[word] &= ~((uint32_t)1 << (priority & 31));
+          if (ndx->map[word] == 0)
+            {
+              ndx->summary &= ~((uint32_t)1 << word);
+            }
+        }
+    }
+
+  dq_rem((FAR dq_entry_t*)tcb, list);
+}
+
+#endif /* CONFIG_SCHED_PRIORITY_BITMAP */
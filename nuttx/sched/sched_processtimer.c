@@ -173,6 +173,16 @@ void sched_process_timer(void)
     }
 #endif
 
+  /* Charge this tick to the task that was executing when it occurred.
+   * This must be done before the watchdogs and the timeslice logic run
+   * because either may change the task at the head of the ready-to-run
+   * list.
+   */
+
+#ifdef CONFIG_SCHED_CPULOAD
+  sched_process_cpuload();
+#endif
+
   /* Process watchdogs (if in the link) */
 
 #ifdef CONFIG_HAVE_WEAKFUNCTIONS
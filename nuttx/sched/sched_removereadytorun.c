@@ -114,8 +114,21 @@ bool sched_removereadytorun(FAR struct tcb_s *rtcb)
 
   /* Remove the TCB from the ready-to-run list */
 
-  dq_rem((FAR dq_entry_t*)rtcb, (dq_queue_t*)&g_readytorun);
+  sched_removeprioritized(rtcb, (dq_queue_t*)&g_readytorun);
 
   rtcb->task_state = TSTATE_TASK_INVALID;
+
+  /* In the tickless mode, the interval timer must be reprogrammed when the
+   * running task changes so that the round robin timeslice of the new task
+   * is enforced.
+   */
+
+#if defined(CONFIG_SCHED_TICKLESS) && CONFIG_RR_INTERVAL > 0
+  if (ret)
+    {
+      sched_timer_reassess();
+    }
+#endif
+
   return ret;
 }
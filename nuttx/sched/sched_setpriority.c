@@ -149,9 +149,19 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
 
         else
           {
+#ifdef CONFIG_SCHED_PRIORITY_BITMAP
+            /* The task stays at the head of the ready-to-run list but it
+             * must be moved in the list's priority index.
+             */
+
+            sched_removeprioritized(tcb, (FAR dq_queue_t*)&g_readytorun);
+            tcb->sched_priority = (uint8_t)sched_priority;
+            (void)sched_addprioritized(tcb, (FAR dq_queue_t*)&g_readytorun);
+#else
             /* Change the task priority */
 
             tcb->sched_priority = (uint8_t)sched_priority;
+#endif
           }
         break;
 
@@ -204,7 +214,7 @@ int sched_setpriority(FAR struct tcb_s *tcb, int sched_priority)
           {
             /* Remove the TCB from the prioritized task list */
 
-            dq_rem((FAR dq_entry_t*)tcb, (FAR dq_queue_t*)g_tasklisttable[task_state].list);
+            sched_removeprioritized(tcb, (FAR dq_queue_t*)g_tasklisttable[task_state].list);
 
             /* Change the task priority */
 
@@ -0,0 +1,338 @@
+/************************************************************************
+ * sched/sched_timerexpiration.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+
+#include "os_internal.h"
+#include "wd_internal.h"
+
+#ifdef CONFIG_SCHED_TICKLESS
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/************************************************************************
+ * Global Variables
+ ************************************************************************/
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+/* This is the value of clock_systimer() when the watchdog lags and the
+ * round robin timeslice were last brought up to date.
+ */
+
+static uint32_t g_timer_ticks;
+
+/* This is true while sched_timer_expiration() is running.  The interval
+ * timer is reprogrammed once when it completes.
+ */
+
+static bool g_timer_busy;
+
+#if CONFIG_RR_INTERVAL > 0
+/* This is the task that has been running since the last update.  It is
+ * charged with the elapsed time.
+ */
+
+static FAR struct tcb_s *g_timer_rtcb;
+#endif
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name:  sched_timer_timeslice
+ *
+ * Description:
+ *   Check if the round robin timeslice of the currently executing task
+ *   has been exhausted and, if so, give any other task at the same
+ *   priority a shot.
+ *
+ ************************************************************************/
+
+#if CONFIG_RR_INTERVAL > 0
+static void sched_timer_timeslice(void)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+
+  if ((rtcb->flags & TCB_FLAG_ROUND_ROBIN) != 0 && rtcb->timeslice <= 0)
+    {
+      /* If the task has pre-emption disabled, then check again on the
+       * next tick.
+       */
+
+      if (rtcb->lockcount)
+        {
+          rtcb->timeslice = 1;
+        }
+      else
+        {
+          /* Reset the timeslice and relinquish the CPU if there is
+           * another task at the same priority.
+           */
+
+          rtcb->timeslice = CONFIG_RR_INTERVAL / MSEC_PER_TICK;
+          if (rtcb->flink &&
+              rtcb->flink->sched_priority >= rtcb->sched_priority)
+            {
+              up_reprioritize_rtr(rtcb, rtcb->sched_priority);
+            }
+        }
+    }
+}
+#else
+#  define sched_timer_timeslice()
+#endif
+
+/************************************************************************
+ * Name:  sched_timer_start
+ *
+ * Description:
+ *   Program the interval timer for the earlier of the expiration of the
+ *   watchdog at the head of the timer queue and the end of the timeslice
+ *   of the currently executing task.  The timer is stopped if there is
+ *   neither.
+ *
+ ************************************************************************/
+
+static void sched_timer_start(void)
+{
+  struct timespec ts;
+  uint32_t elapsed;
+  uint32_t frac;
+  uint32_t delay = 0;
+  bool due = false;
+#if CONFIG_RR_INTERVAL > 0
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+#endif
+
+  /* Get the number of ticks (from g_timer_ticks) to the next deadline */
+
+  if (g_wdactivelist.head)
+    {
+      int lag = ((FAR wdog_t*)g_wdactivelist.head)->lag;
+
+      delay = lag > 0 ? (uint32_t)lag : 0;
+      due   = true;
+    }
+
+#if CONFIG_RR_INTERVAL > 0
+  if ((rtcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
+    {
+      uint32_t slice = rtcb->timeslice > 0 ? (uint32_t)rtcb->timeslice : 0;
+
+      if (!due || slice < delay)
+        {
+          delay = slice;
+        }
+
+      due = true;
+    }
+#endif
+
+  if (!due)
+    {
+      (void)up_timer_cancel(NULL);
+      return;
+    }
+
+  /* Deadlines fall on tick boundaries.  Subtract the time that has
+   * already passed since g_timer_ticks to get the interval.
+   */
+
+  (void)up_timer_gettime(&ts);
+  elapsed = (uint32_t)ts.tv_sec * TICK_PER_SEC +
+            (uint32_t)ts.tv_nsec / NSEC_PER_TICK - g_timer_ticks;
+  frac    = (uint32_t)ts.tv_nsec % NSEC_PER_TICK;
+
+  if (elapsed >= delay)
+    {
+      ts.tv_sec  = 0;
+      ts.tv_nsec = 0;
+    }
+  else
+    {
+      delay     -= elapsed;
+      ts.tv_sec  = delay / TICK_PER_SEC;
+      ts.tv_nsec = (delay % TICK_PER_SEC) * NSEC_PER_TICK;
+
+      if ((uint32_t)ts.tv_nsec < frac)
+        {
+          ts.tv_sec--;
+          ts.tv_nsec += NSEC_PER_SEC;
+        }
+
+      ts.tv_nsec -= frac;
+    }
+
+  (void)up_timer_start(&ts);
+}
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name:  sched_timer_update
+ *
+ * Description:
+ *   Account for the time that has elapsed since the last update:  The
+ *   elapsed ticks are subtracted from the lag of the watchdog at the
+ *   head of the timer queue and from the timeslice of the task that was
+ *   running.  No watchdogs are run and no context switch is performed.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ************************************************************************/
+
+void sched_timer_update(void)
+{
+  uint32_t now = clock_systimer();
+  uint32_t elapsed = now - g_timer_ticks;
+
+  g_timer_ticks = now;
+
+  if (elapsed > 0 && g_wdactivelist.head)
+    {
+      ((FAR wdog_t*)g_wdactivelist.head)->lag -= (int)elapsed;
+    }
+
+#if CONFIG_RR_INTERVAL > 0
+  if (g_timer_rtcb && (g_timer_rtcb->flags & TCB_FLAG_ROUND_ROBIN) != 0)
+    {
+      g_timer_rtcb->timeslice -= (int)elapsed;
+    }
+
+  g_timer_rtcb = (FAR struct tcb_s*)g_readytorun.head;
+#endif
+}
+
+/************************************************************************
+ * Name:  sched_timer_reassess
+ *
+ * Description:
+ *   Bring the timer state up to date and reprogram the interval timer.
+ *   This must be called whenever the next deadline may have changed:
+ *   When the watchdog at the head of the timer queue changes or, if
+ *   round robin scheduling is enabled, when the running task changes.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ************************************************************************/
+
+void sched_timer_reassess(void)
+{
+  sched_timer_update();
+
+  /* If we are called from a watchdog function or because of a context
+   * switch in sched_timer_expiration(), then the interval timer will be
+   * reprogrammed when the expiration processing completes.
+   */
+
+  if (!g_timer_busy)
+    {
+      sched_timer_start();
+    }
+}
+
+/************************************************************************
+ * Name:  sched_timer_expiration
+ *
+ * Description:
+ *   This function handles the expiration of the interval timer in the
+ *   tickless mode.  It takes the place of sched_process_timer():  The
+ *   platform-specific logic calls it (normally from the timer interrupt
+ *   handler) when the interval programmed by up_timer_start() expires.
+ *
+ * Inputs:
+ *   None
+ *
+ * Return Value:
+ *   None
+ *
+ ************************************************************************/
+
+void sched_timer_expiration(void)
+{
+  g_timer_busy = true;
+
+  /* Account for the elapsed time */
+
+  sched_timer_update();
+
+  /* Process expired watchdogs (if in the link) */
+
+#ifdef CONFIG_HAVE_WEAKFUNCTIONS
+  if (wd_timer != NULL)
+#endif
+    {
+      wd_timer();
+    }
+
+  /* Check if the currently executing task has exceeded its
+   * timeslice.
+   */
+
+  sched_timer_timeslice();
+
+  /* And set up the next expiration */
+
+  g_timer_busy = false;
+  sched_timer_start();
+}
+
+#endif /* CONFIG_SCHED_TICKLESS */
@@ -41,6 +41,7 @@
 
 #include <stdbool.h>
 #include <semaphore.h>
+#include <sched.h>
 #include <errno.h>
 #include <assert.h>
 #include <nuttx/arch.h>
@@ -166,6 +167,10 @@ int sem_wait(FAR sem_t *sem)
 
           sem_boostpriority(sem);
 #endif
+          /* Inform the instrumentation layer that we are about to block */
+
+          sched_note_semblock(rtcb, sem);
+
           /* Add the TCB to the prioritized semaphore wait queue */
 
           errno = 0;
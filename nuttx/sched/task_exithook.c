@@ -46,6 +46,7 @@
 #include <errno.h>
 
 #include <nuttx/sched.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 
 #include "os_internal.h"
@@ -681,6 +682,15 @@ void task_exithook(FAR struct tcb_s *tcb, int status, bool nonblocking)
   sig_cleanup(tcb); /* Deallocate Signal lists */
 #endif
 
+  /* Return any memory held in the thread's small allocation cache to the
+   * heap.  This must be done last:  The logic above may have freed memory
+   * into the cache.
+   */
+
+#ifdef CONFIG_MM_TASKCACHE
+  kumm_cacheflush(&tcb->mmcache, nonblocking);
+#endif
+
   /* This function can be re-entered in certain cases.  Set a flag
    * bit in the TCB to not that we have already completed this exit
    * processing.
@@ -103,6 +103,7 @@ int task_restart(pid_t pid)
 {
   FAR struct tcb_s *rtcb;
   FAR struct task_tcb_s *tcb;
+  FAR dq_queue_t *list;
   irqstate_t state;
   int status;
 
@@ -159,8 +160,16 @@ int task_restart(pid_t pid)
        */
 
       state = irqsave();
-      dq_rem((FAR dq_entry_t*)tcb,
-             (dq_queue_t*)g_tasklisttable[tcb->cmn.task_state].list);
+      list  = (FAR dq_queue_t*)g_tasklisttable[tcb->cmn.task_state].list;
+      if (g_tasklisttable[tcb->cmn.task_state].prioritized)
+        {
+          sched_removeprioritized((FAR struct tcb_s *)tcb, list);
+        }
+      else
+        {
+          dq_rem((FAR dq_entry_t*)tcb, list);
+        }
+
       tcb->cmn.task_state = TSTATE_TASK_INVALID;
       irqrestore(state);
 
@@ -122,6 +122,7 @@
 int task_terminate(pid_t pid, bool nonblocking)
 {
   FAR struct tcb_s *dtcb;
+  FAR dq_queue_t *list;
   irqstate_t saved_state;
   int ret = ERROR;
 
@@ -167,7 +168,16 @@ int task_terminate(pid_t pid, bool nonblocking)
   /* Remove the task from the OS's tasks lists. */
 
   saved_state = irqsave();
-  dq_rem((FAR dq_entry_t*)dtcb, (dq_queue_t*)g_tasklisttable[dtcb->task_state].list);
+  list = (FAR dq_queue_t*)g_tasklisttable[dtcb->task_state].list;
+  if (g_tasklisttable[dtcb->task_state].prioritized)
+    {
+      sched_removeprioritized(dtcb, list);
+    }
+  else
+    {
+      dq_rem((FAR dq_entry_t*)dtcb, list);
+    }
+
   dtcb->task_state = TSTATE_TASK_INVALID;
   irqrestore(saved_state);
 
@@ -90,8 +90,10 @@
 
 int wd_cancel (WDOG_ID wdid)
 {
+#ifndef CONFIG_WDOG_TIMERWHEEL
   wdog_t    *curr;
   wdog_t    *prev;
+#endif
   irqstate_t saved_state;
   int        ret = ERROR;
 
@@ -105,6 +107,11 @@ int wd_cancel (WDOG_ID wdid)
 
   if (wdid && wdid->active)
     {
+#ifdef CONFIG_WDOG_TIMERWHEEL
+      /* Remove the watchdog from its slot in the timer wheel */
+
+      wd_wheel_remove(wdid);
+#else
       /* Search the g_wdactivelist for the target FCB.  We can't use sq_rem
        * to do this because there are additional operations that need to be
        * done.
@@ -143,9 +150,18 @@ int wd_cancel (WDOG_ID wdid)
       else
         {
           (void)sq_remfirst(&g_wdactivelist);
+
+          /* In the tickless mode, the interval timer was programmed for
+           * this watchdog.  Reprogram it for the next one (if any).
+           */
+
+#ifdef CONFIG_SCHED_TICKLESS
+          sched_timer_reassess();
+#endif
         }
 
       wdid->next = NULL;
+#endif
 
       /* Return success */
 
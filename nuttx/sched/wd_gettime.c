@@ -95,6 +95,14 @@ int wd_gettime(WDOG_ID wdog)
   flags = irqsave();
   if (wdog && wdog->active)
     {
+#ifdef CONFIG_WDOG_TIMERWHEEL
+      /* The watchdog knows its own expiration time */
+
+      int delay = (int)(wdog->expire - g_wdclock);
+
+      irqrestore(flags);
+      return delay;
+#else
       /* Traverse the watchdog list accumulating lag times until we find the wdog
        * that we are looking for
        */
@@ -111,6 +119,7 @@ int wd_gettime(WDOG_ID wdog)
               return delay;
             }
         }
+#endif
     }
 
   irqrestore(flags);
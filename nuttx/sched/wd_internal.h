@@ -44,6 +44,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <queue.h>
 #include <wdog.h>
 
 #include <nuttx/compiler.h>
@@ -52,6 +53,14 @@
  * Pre-processor Definitions
  ************************************************************************/
 
+/* The timer wheel does not know when the next watchdog will expire and so
+ * it cannot be used to program the interval timer in the tickless mode.
+ */
+
+#if defined(CONFIG_WDOG_TIMERWHEEL) && defined(CONFIG_SCHED_TICKLESS)
+#  error CONFIG_WDOG_TIMERWHEEL cannot be used with CONFIG_SCHED_TICKLESS
+#endif
+
 /************************************************************************
  * Public Type Declarations
  ************************************************************************/
@@ -63,11 +72,19 @@
 struct wdog_s
 {
   FAR struct wdog_s *next;       /* Support for singly linked lists. */
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  FAR struct wdog_s *blink;      /* Support for doubly linked lists. */
+  FAR dq_queue_t    *slot;       /* The timer wheel slot holding the wdog */
+#endif
   wdentry_t          func;       /* Function to execute when delay expires */
 #ifdef CONFIG_PIC
   FAR void          *picbase;    /* PIC base address */
 #endif
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  uint32_t           expire;     /* Value of g_wdclock at expiration */
+#else
   int                lag;        /* Timer associated with the delay */
+#endif
   bool               active;     /* true if the watchdog is actively timing */
   uint8_t            argc;       /* The number of parameters to pass */
   uint32_t           parm[CONFIG_MAX_WDOGPARMS];
@@ -90,12 +107,20 @@ extern sq_queue_t g_wdfreelist;
 
 extern FAR wdog_t *g_wdpool;
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+/* If the timer wheel is used, g_wdclock counts the calls to wd_timer().
+ * Active watchdogs are held in the slots of the wheel (see wd_wheel.c).
+ */
+
+extern uint32_t g_wdclock;
+#else
 /* The g_wdactivelist data structure is a singly linked list ordered by
  * watchdog expiration time. When watchdog timers expire,the functions on
  * this linked list are removed and the function is called.
  */
 
 extern sq_queue_t g_wdactivelist;
+#endif
 
 /************************************************************************
  * Public Function Prototypes
@@ -111,6 +136,13 @@ extern "C" {
 EXTERN void weak_function wd_initialize(void);
 EXTERN void weak_function wd_timer(void);
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+EXTERN void wd_wheel_initialize(void);
+EXTERN void wd_wheel_insert(FAR wdog_t *wdog, int delay);
+EXTERN void wd_wheel_remove(FAR wdog_t *wdog);
+EXTERN FAR dq_queue_t *wd_wheel_advance(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
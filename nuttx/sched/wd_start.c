@@ -88,6 +88,55 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: wd_expiration
+ *
+ * Description:
+ *   Execute the function of an expired watchdog.
+ *
+ ****************************************************************************/
+
+static inline void wd_expiration(FAR wdog_t *wdog)
+{
+  up_setpicbase(wdog->picbase);
+  switch (wdog->argc)
+    {
+      default:
+#ifdef CONFIG_DEBUG
+        PANIC();
+#endif
+      case 0:
+        (*((wdentry0_t)(wdog->func)))(0);
+        break;
+
+#if CONFIG_MAX_WDOGPARMS > 0
+      case 1:
+        (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 1
+      case 2:
+        (*((wdentry2_t)(wdog->func)))(2,
+                        wdog->parm[0], wdog->parm[1]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 2
+      case 3:
+        (*((wdentry3_t)(wdog->func)))(3,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 3
+      case 4:
+        (*((wdentry4_t)(wdog->func)))(4,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2] ,wdog->parm[3]);
+        break;
+#endif
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -128,10 +177,12 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
 int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
 {
   va_list    ap;
+#ifndef CONFIG_WDOG_TIMERWHEEL
   FAR wdog_t *curr;
   FAR wdog_t *prev;
   FAR wdog_t *next;
   int32_t    now;
+#endif
   irqstate_t saved_state;
   int        i;
 
@@ -155,6 +206,15 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
       wd_cancel(wdog);
     }
 
+  /* In the tickless mode, the lags in the timer queue are relative to the
+   * last time that the timer state was updated.  Bring them up to date so
+   * that the new delay is relative to now.
+   */
+
+#ifdef CONFIG_SCHED_TICKLESS
+  sched_timer_update();
+#endif
+
   /* Save the data in the watchdog structure */
 
   wdog->func = wdentry;         /* Function to execute when delay expires */
@@ -185,6 +245,14 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
       delay--;
     }
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  /* Add the watchdog to the timer wheel.  This takes the same time
+   * regardless of the number of active watchdogs.
+   */
+
+  wd_wheel_insert(wdog, delay);
+
+#else
   /* Do the easy case first -- when the watchdog timer queue is empty. */
 
   if (g_wdactivelist.head == NULL)
@@ -263,11 +331,26 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
         }
     }
 
-  /* Put the lag into the watchdog structure and mark it as active. */
+  /* Put the lag into the watchdog structure */
 
   wdog->lag = delay;
+#endif
+
+  /* Mark the watchdog as active */
+
   wdog->active = true;
 
+  /* If the new watchdog is now the first to expire, then the interval timer
+   * must be reprogrammed.
+   */
+
+#ifdef CONFIG_SCHED_TICKLESS
+  if (g_wdactivelist.head == (FAR sq_entry_t*)wdog)
+    {
+      sched_timer_reassess();
+    }
+#endif
+
   irqrestore(saved_state);
   return OK;
 }
@@ -294,13 +377,44 @@ void wd_timer(void)
 {
   FAR wdog_t *wdog;
 
+#ifdef CONFIG_WDOG_TIMERWHEEL
+  FAR dq_queue_t *expired;
+
+  /* Advance the timer wheel and get the slot holding the watchdogs that
+   * expire on this tick.
+   */
+
+  expired = wd_wheel_advance();
+
+  /* Process each of them.  A watchdog function may cancel any of the
+   * others; a watchdog that it starts cannot land in this slot.
+   */
+
+  while ((wdog = (FAR wdog_t*)expired->head) != NULL)
+    {
+      wd_wheel_remove(wdog);
+
+      /* Indicate that the watchdog is no longer active. */
+
+      wdog->active = false;
+
+      /* Execute the watchdog function */
+
+      wd_expiration(wdog);
+    }
+
+#else
   /* Check if there are any active watchdogs to process */
 
   if (g_wdactivelist.head)
     {
-      /* There are.  Decrement the lag counter */
+      /* There are.  Decrement the lag counter.  In the tickless mode, the
+       * elapsed time has already been subtracted by sched_timer_update().
+       */
 
+#ifndef CONFIG_SCHED_TICKLESS
       --(((FAR wdog_t*)g_wdactivelist.head)->lag);
+#endif
 
       /* Check if the watchdog at the head of the list is ready to run */
 
@@ -332,44 +446,9 @@ void wd_timer(void)
 
               /* Execute the watchdog function */
 
-              up_setpicbase(wdog->picbase);
-              switch (wdog->argc)
-                {
-                  default:
-#ifdef CONFIG_DEBUG
-                    PANIC();
-#endif
-                  case 0:
-                    (*((wdentry0_t)(wdog->func)))(0);
-                    break;
-
-#if CONFIG_MAX_WDOGPARMS > 0
-                  case 1:
-                    (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 1
-                  case 2:
-                    (*((wdentry2_t)(wdog->func)))(2,
-                                    wdog->parm[0], wdog->parm[1]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 2
-                  case 3:
-                    (*((wdentry3_t)(wdog->func)))(3,
-                                    wdog->parm[0], wdog->parm[1],
-                                    wdog->parm[2]);
-                    break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 3
-                  case 4:
-                    (*((wdentry4_t)(wdog->func)))(4,
-                                    wdog->parm[0], wdog->parm[1],
-                                    wdog->parm[2] ,wdog->parm[3]);
-                    break;
-#endif
-                }
+              wd_expiration(wdog);
             }
         }
     }
+#endif
 }
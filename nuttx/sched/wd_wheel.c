@@ -0,0 +1,265 @@
+/************************************************************************
+ * sched/wd_wheel.c
+ *
+ *   Copyright (C) 2013 Gregory Nutt. All rights reserved.
+ *   Author: Gregory Nutt <gnutt@nuttx.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ************************************************************************/
+
+
+/************************************************************************
+ * Included Files
+ ************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+#include <assert.h>
+
+#include "wd_internal.h"
+
+#ifdef CONFIG_WDOG_TIMERWHEEL
+
+/************************************************************************
+ * Definitions
+ ************************************************************************/
+
+/* The root wheel has one slot per tick.  Each slot of the first upper
+ * wheel spans one revolution of the root wheel, each slot of the second
+ * upper wheel one revolution of the first, and so on.  Enough upper
+ * wheels are provided to hold a delay of INT_MAX ticks.
+ */
+
+#define WHEEL_ROOTBITS   CONFIG_WDOG_WHEEL_ROOTBITS
+#define WHEEL_ROOTSIZE   (1 << WHEEL_ROOTBITS)
+#define WHEEL_ROOTMASK   (WHEEL_ROOTSIZE - 1)
+
+#define WHEEL_LEVELBITS  CONFIG_WDOG_WHEEL_LEVELBITS
+#define WHEEL_LEVELSIZE  (1 << WHEEL_LEVELBITS)
+#define WHEEL_LEVELMASK  (WHEEL_LEVELSIZE - 1)
+
+#define WHEEL_NLEVELS \
+  ((31 - WHEEL_ROOTBITS + WHEEL_LEVELBITS - 1) / WHEEL_LEVELBITS)
+
+/* The shift that gives the slot index of upper wheel 'n' */
+
+#define WHEEL_SHIFT(n)   (WHEEL_ROOTBITS + (n) * WHEEL_LEVELBITS)
+
+/************************************************************************
+ * Private Type Declarations
+ ************************************************************************/
+
+/************************************************************************
+ * Global Variables
+ ************************************************************************/
+
+/* The number of times that wd_timer() has been called */
+
+uint32_t g_wdclock;
+
+/************************************************************************
+ * Private Variables
+ ************************************************************************/
+
+static dq_queue_t g_wdroot[WHEEL_ROOTSIZE];
+static dq_queue_t g_wdlevel[WHEEL_NLEVELS][WHEEL_LEVELSIZE];
+
+/************************************************************************
+ * Private Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: wd_wheel_add
+ *
+ * Description:
+ *   Add a watchdog to the slot that will be reached (by g_wdclock or by
+ *   a cascade) no later than its expiration time.
+ *
+ ************************************************************************/
+
+static void wd_wheel_add(FAR wdog_t *wdog)
+{
+  uint32_t delta = wdog->expire - g_wdclock;
+  FAR dq_queue_t *slot;
+  int level;
+
+  if (delta < WHEEL_ROOTSIZE)
+    {
+      slot = &g_wdroot[wdog->expire & WHEEL_ROOTMASK];
+    }
+  else
+    {
+      for (level = 0; level < WHEEL_NLEVELS - 1; level++)
+        {
+          if (delta < ((uint32_t)1 << WHEEL_SHIFT(level + 1)))
+            {
+              break;
+            }
+        }
+
+      slot = &g_wdlevel[level]
+                       [(wdog->expire >> WHEEL_SHIFT(level)) & WHEEL_LEVELMASK];
+    }
+
+  dq_addlast((FAR dq_entry_t*)wdog, slot);
+  wdog->slot = slot;
+}
+
+/************************************************************************
+ * Name: wd_wheel_cascade
+ *
+ * Description:
+ *   Move all of the watchdogs in one slot of an upper wheel down to the
+ *   wheels below.  Returns the index of the slot.
+ *
+ ************************************************************************/
+
+static int wd_wheel_cascade(int level)
+{
+  int index = (g_wdclock >> WHEEL_SHIFT(level)) & WHEEL_LEVELMASK;
+  FAR dq_queue_t *slot = &g_wdlevel[level][index];
+  FAR wdog_t *wdog;
+
+  while ((wdog = (FAR wdog_t*)dq_remfirst(slot)) != NULL)
+    {
+      wd_wheel_add(wdog);
+    }
+
+  return index;
+}
+
+/************************************************************************
+ * Public Functions
+ ************************************************************************/
+
+/************************************************************************
+ * Name: wd_wheel_initialize
+ *
+ * Description:
+ *   Empty all of the slots of the timer wheel.
+ *
+ ************************************************************************/
+
+void wd_wheel_initialize(void)
+{
+  int level;
+  int i;
+
+  g_wdclock = 0;
+
+  for (i = 0; i < WHEEL_ROOTSIZE; i++)
+    {
+      dq_init(&g_wdroot[i]);
+    }
+
+  for (level = 0; level < WHEEL_NLEVELS; level++)
+    {
+      for (i = 0; i < WHEEL_LEVELSIZE; i++)
+        {
+          dq_init(&g_wdlevel[level][i]);
+        }
+    }
+}
+
+/************************************************************************
+ * Name: wd_wheel_insert
+ *
+ * Description:
+ *   Add a watchdog to the timer wheel so that it expires on the 'delay'th
+ *   following call to wd_timer().
+ *
+ * Assumptions:
+ *   Interrupts are disabled and delay > 0.
+ *
+ ************************************************************************/
+
+void wd_wheel_insert(FAR wdog_t *wdog, int delay)
+{
+  wdog->expire = g_wdclock + (uint32_t)delay;
+  wd_wheel_add(wdog);
+}
+
+/************************************************************************
+ * Name: wd_wheel_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the timer wheel.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ************************************************************************/
+
+void wd_wheel_remove(FAR wdog_t *wdog)
+{
+  ASSERT(wdog->slot);
+
+  dq_rem((FAR dq_entry_t*)wdog, wdog->slot);
+  wdog->slot = NULL;
+}
+
+/************************************************************************
+ * Name: wd_wheel_advance
+ *
+ * Description:
+ *   Advance g_wdclock by one tick, moving watchdogs down from the upper
+ *   wheels as each wheel below completes a revolution.  Returns the
+ *   root wheel slot that holds the watchdogs that expire on this tick.
+ *   The caller removes and runs them.
+ *
+ * Assumptions:
+ *   Called from wd_timer() with interrupts disabled.
+ *
+ ************************************************************************/
+
+FAR dq_queue_t *wd_wheel_advance(void)
+{
+  int index;
+  int level;
+
+  g_wdclock++;
+  index = g_wdclock & WHEEL_ROOTMASK;
+
+  if (index == 0)
+    {
+      for (level = 0; level < WHEEL_NLEVELS; level++)
+        {
+          if (wd_wheel_cascade(level) != 0)
+            {
+              break;
+            }
+        }
+    }
+
+  return &g_wdroot[index];
+}
+
+#endif /* CONFIG_WDOG_TIMERWHEEL */
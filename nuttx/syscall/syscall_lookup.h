@@ -193,6 +193,12 @@ SYSCALL_LOOKUP(up_assert,                 2, STUB_up_assert)
   SYSCALL_LOOKUP(umount,                  1, STUB_umount)
   SYSCALL_LOOKUP(unlink,                  1, STUB_unlink)
 #  endif
+
+#  ifdef CONFIG_FS_EPOLL
+  SYSCALL_LOOKUP(epoll_create,            1, STUB_epoll_create)
+  SYSCALL_LOOKUP(epoll_ctl,               4, STUB_epoll_ctl)
+  SYSCALL_LOOKUP(epoll_wait,              4, STUB_epoll_wait)
+#  endif
 #endif
 
 /* The following are defined if pthreads are enabled */